@@ -28,39 +28,180 @@
  * @}
  */
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #ifdef _WIN32
 #define VC_EXTRALEAN
 #include <ola/win/CleanWindows.h>
 #include <io.h>
 #else
+#include <pthread.h>
+#include <signal.h>
 #include <syslog.h>
 #endif
 
 #include <unistd.h>
 
+#include <algorithm>
 #include <iostream>
+#include <memory>
 #include <string>
+#include "ola/Clock.h"
 #include "ola/Logging.h"
 #include "ola/base/Flags.h"
+#include "ola/thread/MPSCQueue.h"
+#include "ola/thread/Mutex.h"
+#include "ola/thread/Thread.h"
 
 /**@private*/
 DEFINE_s_int8(log_level, l, ola::OLA_LOG_WARN, "Set the logging level 0 .. 4.");
 /**@private*/
 DEFINE_default_bool(syslog, false, "Send to syslog rather than stderr.");
+/**@private*/
+DEFINE_default_bool(async_logging, false,
+                    "Write the logs from a background thread.");
+/**@private*/
+DEFINE_uint16(log_rate_limit, 0,
+              "The maximum number of lines each logging statement can write "
+              "per second, 0 means no limit.");
 
 namespace ola {
 
+using ola::thread::MutexLocker;
 using std::ostringstream;
 using std::string;
 
 /**
  * @cond HIDDEN_SYMBOLS
+ * @brief Limits the number of lines each logging statement writes per second.
+ *
+ * Logging statements are identified by their file & line. The state for each
+ * is kept in a fixed size, open addressed table so the check doesn't need a
+ * lock. Entries are never removed, if the table fills up the remaining
+ * statements aren't limited.
+ */
+class LogRateLimiter {
+ public:
+  LogRateLimiter(unsigned int lines_per_second, const Clock *clock)
+      : m_lines_per_second(lines_per_second),
+        m_clock(clock ? clock : &m_system_clock) {
+    memset(m_call_sites, 0, sizeof(m_call_sites));
+  }
+
+  /*
+   * Returns false if the line should be suppressed.
+   */
+  bool Allow(const char *file, int line);
+
+  /*
+   * Returns the number of lines suppressed from this statement since the last
+   * line was written, and resets the count.
+   */
+  unsigned int TakeSuppressed(const char *file, int line);
+
+ private:
+  struct CallSite {
+    uint64_t key;
+    uint32_t second;
+    uint32_t count;
+    uint32_t suppressed;
+  };
+
+  static const unsigned int TABLE_SIZE = 1024;
+  static const unsigned int MAX_PROBES = 8;
+
+  const unsigned int m_lines_per_second;
+  Clock m_system_clock;
+  const Clock *m_clock;
+  CallSite m_call_sites[TABLE_SIZE];
+
+  CallSite *FindCallSite(const char *file, int line);
+
+  DISALLOW_COPY_AND_ASSIGN(LogRateLimiter);
+};
+
+bool LogRateLimiter::Allow(const char *file, int line) {
+  CallSite *site = FindCallSite(file, line);
+  if (!site) {
+    return true;
+  }
+
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  const uint32_t second = static_cast<uint32_t>(now.Seconds());
+  uint32_t last_second = __atomic_load_n(&site->second, __ATOMIC_RELAXED);
+  if (last_second != second &&
+      __atomic_compare_exchange_n(&site->second, &last_second, second, false,
+                                  __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    __atomic_store_n(&site->count, 0, __ATOMIC_RELAXED);
+  }
+
+  if (__atomic_add_fetch(&site->count, 1, __ATOMIC_RELAXED) >
+      m_lines_per_second) {
+    __atomic_add_fetch(&site->suppressed, 1, __ATOMIC_RELAXED);
+    return false;
+  }
+  return true;
+}
+
+unsigned int LogRateLimiter::TakeSuppressed(const char *file, int line) {
+  CallSite *site = FindCallSite(file, line);
+  return site ? __atomic_exchange_n(&site->suppressed, 0, __ATOMIC_RELAXED) :
+                0;
+}
+
+LogRateLimiter::CallSite *LogRateLimiter::FindCallSite(const char *file,
+                                                       int line) {
+  // __FILE__ is a string literal so the pointer identifies the file.
+  const uint64_t key = (static_cast<uint64_t>(
+      reinterpret_cast<uintptr_t>(file)) << 16) | (line & 0xffff);
+  const unsigned int start = static_cast<unsigned int>(
+      (key * 0x9e3779b97f4a7c15ull) >> 54);
+  for (unsigned int i = 0; i < MAX_PROBES; i++) {
+    CallSite *site = &m_call_sites[(start + i) % TABLE_SIZE];
+    uint64_t site_key = __atomic_load_n(&site->key, __ATOMIC_ACQUIRE);
+    if (site_key == 0) {
+      uint64_t empty = 0;
+      if (__atomic_compare_exchange_n(&site->key, &empty, key, false,
+                                      __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return site;
+      }
+      // another thread claimed the entry
+      site_key = empty;
+    }
+    if (site_key == key) {
+      return site;
+    }
+  }
+  return NULL;
+}
+
+/**
  * @brief pointer to a log target
  */
 LogDestination *log_target = NULL;
 
 log_level logging_level = OLA_LOG_WARN;
+
+bool log_rate_limited = false;
+
+LogRateLimiter *rate_limiter = NULL;
+
+uint64_t suppressed_lines = 0;
+
+namespace {
+AsyncLogDestination *async_target = NULL;
+
+/*
+ * Write out any queued lines when the program exits.
+ */
+void FlushAsyncLogging() {
+  if (async_target) {
+    async_target->Flush();
+  }
+}
+}  // namespace
 /**@endcond*/
 
 /**
@@ -110,7 +251,21 @@ bool InitLoggingFromFlags() {
       break;
   }
 
-  return InitLogging(log_level, output);
+  SetLogRateLimit(FLAGS_log_rate_limit);
+  if (!InitLogging(log_level, output)) {
+    return false;
+  }
+
+  if (FLAGS_async_logging && log_target) {
+    static bool registered_flush = false;
+    async_target = new AsyncLogDestination(log_target);
+    log_target = async_target;
+    if (!registered_flush) {
+      atexit(FlushAsyncLogging);
+      registered_flush = true;
+    }
+  }
+  return true;
 }
 
 
@@ -143,6 +298,20 @@ void InitLogging(log_level level, LogDestination *destination) {
     delete log_target;
   }
   log_target = destination;
+  async_target = NULL;
+}
+
+
+void SetLogRateLimit(unsigned int lines_per_second, const Clock *clock) {
+  delete rate_limiter;
+  rate_limiter = lines_per_second ?
+      new LogRateLimiter(lines_per_second, clock) : NULL;
+  log_rate_limited = rate_limiter != NULL;
+}
+
+
+uint64_t SuppressedLogLines() {
+  return __atomic_load_n(&suppressed_lines, __ATOMIC_RELAXED);
 }
 
 /**@}*/
@@ -150,12 +319,22 @@ void InitLogging(log_level level, LogDestination *destination) {
 LogLine::LogLine(const char *file,
                  int line,
                  log_level level):
+  m_file(file),
+  m_line(line),
   m_level(level),
   m_stream(ostringstream::out) {
     m_stream << file << ":" << line << ": ";
     m_prefix_length = m_stream.str().length();
 }
 
+bool LogLine::RateLimitAllows(const char *file, int line) {
+  if (rate_limiter && !rate_limiter->Allow(file, line)) {
+    __atomic_add_fetch(&suppressed_lines, 1, __ATOMIC_RELAXED);
+    return false;
+  }
+  return true;
+}
+
 LogLine::~LogLine() {
   Write();
 }
@@ -167,11 +346,20 @@ void LogLine::Write() {
   if (m_level > logging_level)
     return;
 
+  const unsigned int suppressed = rate_limiter ?
+      rate_limiter->TakeSuppressed(m_file, m_line) : 0;
+
   string line = m_stream.str();
 
   if (line.at(line.length() - 1) != '\n')
     line.append("\n");
 
+  if (suppressed) {
+    ostringstream note;
+    note << " (suppressed " << suppressed << " similar lines)\n";
+    line.replace(line.length() - 1, 1, note.str());
+  }
+
   if (log_target)
     log_target->Write(m_level, line);
 }
@@ -187,6 +375,317 @@ void StdErrorLogDestination::Write(log_level level, const string &log_line) {
   (void) level;
 }
 
+/**@cond HIDDEN_SYMBOLS*/
+const unsigned int AsyncLogDestination::DEFAULT_QUEUE_SIZE;
+const unsigned int AsyncLogDestination::MAX_LINE_LENGTH;
+
+namespace {
+struct LogRecord {
+  log_level level;
+  unsigned int length;
+  char line[AsyncLogDestination::MAX_LINE_LENGTH];
+};
+
+/*
+ * Incremented in the child after a fork(). A writer thread started in an
+ * earlier generation only exists in the parent.
+ */
+unsigned int fork_generation = 1;
+
+// Held while a writer thread is started.
+ola::thread::Mutex writer_start_mutex;
+
+#ifndef _WIN32
+pthread_once_t fork_handler_once = PTHREAD_ONCE_INIT;
+
+void IncrementForkGeneration() {
+  __atomic_add_fetch(&fork_generation, 1, __ATOMIC_SEQ_CST);
+}
+
+void InstallForkHandler() {
+  pthread_atfork(NULL, NULL, IncrementForkGeneration);
+}
+#endif  // _WIN32
+}  // namespace
+
+/*
+ * Drains the queue and writes the lines to the real destination.
+ */
+class AsyncLogDestination::WriterThread: public ola::thread::Thread {
+ public:
+  WriterThread(LogDestination *destination, unsigned int queue_size)
+      : Thread(Options("ola-logging")),
+        m_destination(destination),
+        m_queue(queue_size),
+        m_generation(0),
+        m_running(false),
+        m_stopping(false),
+        m_sleeping(0),
+        m_queued(0),
+        m_written(0),
+        m_dropped(0),
+        m_reported_dropped(0),
+        m_drain_passes(0),
+        m_finished_passes(0) {
+  }
+
+  /*
+   * Lines written while the thread is starting go straight to the
+   * destination.
+   */
+  bool Start() {
+    __atomic_store_n(&m_generation,
+                     __atomic_load_n(&fork_generation, __ATOMIC_SEQ_CST),
+                     __ATOMIC_SEQ_CST);
+    bool running = Thread::Start();
+    __atomic_store_n(&m_running, running, __ATOMIC_SEQ_CST);
+    return running;
+  }
+
+  // True if Start() has been called in some process.
+  bool HasStarted() const {
+    return __atomic_load_n(&m_generation, __ATOMIC_SEQ_CST) != 0;
+  }
+
+  // True if Start() has been called in this process.
+  bool StartedInThisProcess() const {
+    return (__atomic_load_n(&m_generation, __ATOMIC_SEQ_CST) ==
+            __atomic_load_n(&fork_generation, __ATOMIC_SEQ_CST));
+  }
+
+  LogDestination *ReleaseDestination() {
+    return m_destination.release();
+  }
+
+  void Stop();
+  void Write(log_level level, const string &log_line);
+  void Flush();
+
+  uint64_t DroppedLines() const {
+    return __atomic_load_n(&m_dropped, __ATOMIC_RELAXED);
+  }
+
+ protected:
+  void *Run();
+
+ private:
+  // The longest the thread sleeps for, this bounds the delay if a wake up is
+  // missed.
+  static const unsigned int MAX_SLEEP_US = 100000;
+
+  std::auto_ptr<LogDestination> m_destination;
+  ola::thread::MPSCQueue<LogRecord> m_queue;
+  Clock m_clock;
+  ola::thread::Mutex m_mutex;
+  ola::thread::ConditionVariable m_wake_up;
+  ola::thread::ConditionVariable m_drained;
+  unsigned int m_generation;
+  bool m_running;
+  bool m_stopping;  // protected by m_mutex
+  int m_sleeping;
+  uint64_t m_queued;
+  uint64_t m_written;
+  uint64_t m_dropped;
+  uint64_t m_reported_dropped;
+  uint64_t m_drain_passes;
+  uint64_t m_finished_passes;  // protected by m_mutex
+
+  bool Running() const {
+    return (__atomic_load_n(&m_running, __ATOMIC_SEQ_CST) &&
+            StartedInThisProcess());
+  }
+
+  void Drain();
+  void WaitForLines();
+
+  DISALLOW_COPY_AND_ASSIGN(WriterThread);
+};
+
+void AsyncLogDestination::WriterThread::Stop() {
+  if (!Running()) {
+    return;
+  }
+  {
+    MutexLocker locker(&m_mutex);
+    m_stopping = true;
+    m_wake_up.Signal();
+  }
+  Join();
+  __atomic_store_n(&m_running, false, __ATOMIC_SEQ_CST);
+}
+
+void AsyncLogDestination::WriterThread::Write(log_level level,
+                                              const string &log_line) {
+  if (!__atomic_load_n(&m_running, __ATOMIC_SEQ_CST)) {
+    m_destination->Write(level, log_line);
+    return;
+  }
+
+  LogRecord record;
+  record.level = level;
+  record.length = std::min(static_cast<unsigned int>(log_line.size()),
+                           MAX_LINE_LENGTH);
+  memcpy(record.line, log_line.data(), record.length);
+  if (record.length < log_line.size()) {
+    record.line[record.length - 1] = '\n';
+  }
+
+  if (!m_queue.Push(record)) {
+    __atomic_add_fetch(&m_dropped, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  __atomic_add_fetch(&m_queued, 1, __ATOMIC_SEQ_CST);
+
+  // Only take the lock if the writer thread is waiting.
+  if (__atomic_load_n(&m_sleeping, __ATOMIC_SEQ_CST) &&
+      __atomic_exchange_n(&m_sleeping, 0, __ATOMIC_SEQ_CST)) {
+    MutexLocker locker(&m_mutex);
+    m_wake_up.Signal();
+  }
+}
+
+void AsyncLogDestination::WriterThread::Flush() {
+  if (!Running()) {
+    return;
+  }
+
+  // Wait for a Drain() that starts after this point, so the report of any
+  // lines dropped so far is written as well.
+  const uint64_t pass = __atomic_load_n(&m_drain_passes, __ATOMIC_SEQ_CST) + 1;
+  const uint64_t queued = __atomic_load_n(&m_queued, __ATOMIC_SEQ_CST);
+  MutexLocker locker(&m_mutex);
+  while (!m_stopping &&
+         (m_finished_passes < pass ||
+          __atomic_load_n(&m_written, __ATOMIC_SEQ_CST) < queued)) {
+    m_wake_up.Signal();
+    TimeStamp wake_up_time;
+    m_clock.CurrentTime(&wake_up_time);
+    m_drained.TimedWait(&m_mutex,
+                        wake_up_time + TimeInterval(0, MAX_SLEEP_US));
+  }
+}
+
+void *AsyncLogDestination::WriterThread::Run() {
+#ifndef _WIN32
+  // Signals are handled by the other threads.
+  sigset_t signals;
+  sigfillset(&signals);
+  pthread_sigmask(SIG_BLOCK, &signals, NULL);
+#endif  // _WIN32
+
+  while (true) {
+    const uint64_t pass = __atomic_add_fetch(&m_drain_passes, 1,
+                                             __ATOMIC_SEQ_CST);
+    Drain();
+
+    MutexLocker locker(&m_mutex);
+    m_finished_passes = pass;
+    m_drained.Broadcast();
+    if (m_stopping) {
+      break;
+    }
+    WaitForLines();
+  }
+  // Write anything logged while we were stopping.
+  Drain();
+  return NULL;
+}
+
+/*
+ * Wait until a line is queued, called with m_mutex held.
+ */
+void AsyncLogDestination::WriterThread::WaitForLines() {
+  __atomic_store_n(&m_sleeping, 1, __ATOMIC_SEQ_CST);
+  if (m_queue.Empty()) {
+    TimeStamp wake_up_time;
+    m_clock.CurrentTime(&wake_up_time);
+    m_wake_up.TimedWait(&m_mutex,
+                        wake_up_time + TimeInterval(0, MAX_SLEEP_US));
+  }
+  __atomic_store_n(&m_sleeping, 0, __ATOMIC_SEQ_CST);
+}
+
+void AsyncLogDestination::WriterThread::Drain() {
+  LogRecord record;
+  while (m_queue.Pop(&record)) {
+    m_destination->Write(record.level, string(record.line, record.length));
+    __atomic_add_fetch(&m_written, 1, __ATOMIC_SEQ_CST);
+  }
+
+  const uint64_t dropped = __atomic_load_n(&m_dropped, __ATOMIC_RELAXED);
+  if (dropped != m_reported_dropped) {
+    ostringstream str;
+    str << "Logging queue full, dropped " << dropped - m_reported_dropped
+        << " lines\n";
+    m_destination->Write(OLA_LOG_WARN, str.str());
+    m_reported_dropped = dropped;
+  }
+}
+/**@endcond*/
+
+AsyncLogDestination::AsyncLogDestination(LogDestination *destination,
+                                         unsigned int queue_size)
+    : m_queue_size(queue_size),
+      m_writer(new WriterThread(destination, queue_size)) {
+#ifndef _WIN32
+  pthread_once(&fork_handler_once, InstallForkHandler);
+#endif  // _WIN32
+}
+
+AsyncLogDestination::~AsyncLogDestination() {
+  if (m_writer->HasStarted() && !m_writer->StartedInThisProcess()) {
+    // The writer's thread is in the parent, see StartWriter().
+    delete m_writer->ReleaseDestination();
+    return;
+  }
+  m_writer->Stop();
+  delete m_writer;
+}
+
+void AsyncLogDestination::Write(log_level level, const string &log_line) {
+  WriterThread *writer = __atomic_load_n(&m_writer, __ATOMIC_SEQ_CST);
+  if (!writer->StartedInThisProcess()) {
+    StartWriter();
+    writer = __atomic_load_n(&m_writer, __ATOMIC_SEQ_CST);
+  }
+  writer->Write(level, log_line);
+}
+
+void AsyncLogDestination::Flush() {
+  __atomic_load_n(&m_writer, __ATOMIC_SEQ_CST)->Flush();
+}
+
+uint64_t AsyncLogDestination::DroppedLines() const {
+  return __atomic_load_n(&m_writer, __ATOMIC_SEQ_CST)->DroppedLines();
+}
+
+/*
+ * Start the writer thread in this process.
+ */
+void AsyncLogDestination::StartWriter() {
+  MutexLocker locker(&writer_start_mutex);
+  if (m_writer->StartedInThisProcess()) {
+    return;
+  }
+
+  if (m_writer->HasStarted()) {
+    // The writer was started before a fork(), its thread only exists in the
+    // parent and the queue may have been part way through an update. Leave
+    // the old writer alone and start again with a new one.
+    __atomic_store_n(
+        &m_writer,
+        new WriterThread(m_writer->ReleaseDestination(), m_queue_size),
+        __ATOMIC_SEQ_CST);
+  }
+
+  if (!m_writer->Start()) {
+    // Lines are written by the caller instead.
+    m_writer->Write(OLA_LOG_WARN,
+                    "Failed to start the logging thread, logging "
+                    "synchronously\n");
+  }
+}
+
 #ifdef _WIN32
 bool WindowsSyslogDestination::Init() {
   m_eventlog = RegisterEventSourceA(NULL, "OLA");
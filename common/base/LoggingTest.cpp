@@ -19,30 +19,53 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif  // _WIN32
+#include <unistd.h>
 #include <deque>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "ola/Clock.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
+#include "ola/stl/STLUtils.h"
 #include "ola/testing/TestUtils.h"
+#include "ola/thread/Mutex.h"
+#include "ola/thread/Thread.h"
 
 
 using std::deque;
 using std::vector;
 using std::string;
+using ola::AsyncLogDestination;
 using ola::IncrementLogLevel;
 using ola::log_level;
+using ola::thread::Mutex;
+using ola::thread::MutexLocker;
+using ola::thread::Thread;
 
 
 class LoggingTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(LoggingTest);
   CPPUNIT_TEST(testLogging);
+  CPPUNIT_TEST(testRateLimit);
+  CPPUNIT_TEST(testAsyncLogging);
+  CPPUNIT_TEST(testAsyncLogFlood);
+#ifndef _WIN32
+  CPPUNIT_TEST(testAsyncLoggingAfterFork);
+#endif  // _WIN32
   CPPUNIT_TEST_SUITE_END();
 
  public:
+    void tearDown();
     void testLogging();
+    void testRateLimit();
+    void testAsyncLogging();
+    void testAsyncLogFlood();
+    void testAsyncLoggingAfterFork();
 };
 
 
@@ -56,6 +79,121 @@ class MockLogDestination: public ola::LogDestination {
 };
 
 
+/*
+ * Counts the lines written, optionally sleeping on each one to simulate a slow
+ * destination.
+ */
+class CountingLogDestination: public ola::LogDestination {
+ public:
+    explicit CountingLogDestination(unsigned int delay_us = 0)
+        : m_delay_us(delay_us),
+          m_lines(0),
+          m_dropped_reports(0) {
+    }
+
+    void Write(log_level, const string &log_line) {
+      if (m_delay_us) {
+        usleep(m_delay_us);
+      }
+      MutexLocker locker(&m_mutex);
+      if (log_line.find("dropped") != string::npos) {
+        m_dropped_reports++;
+      } else {
+        m_lines++;
+      }
+      m_last_line = log_line;
+    }
+
+    unsigned int Lines() {
+      MutexLocker locker(&m_mutex);
+      return m_lines;
+    }
+
+    unsigned int DroppedReports() {
+      MutexLocker locker(&m_mutex);
+      return m_dropped_reports;
+    }
+
+    string LastLine() {
+      MutexLocker locker(&m_mutex);
+      return m_last_line;
+    }
+
+ private:
+    const unsigned int m_delay_us;
+    Mutex m_mutex;
+    unsigned int m_lines;
+    unsigned int m_dropped_reports;
+    string m_last_line;
+};
+
+
+/*
+ * Logs the same message over and over.
+ */
+class FloodThread: public Thread {
+ public:
+    explicit FloodThread(unsigned int count)
+        : Thread(Options("FloodThread")),
+          m_count(count) {
+    }
+
+    void *Run() {
+      for (unsigned int i = 0; i < m_count; i++) {
+        OLA_WARN << "short ACN frame " << i;
+      }
+      return NULL;
+    }
+
+ private:
+    const unsigned int m_count;
+};
+
+
+/*
+ * A Clock that only moves when the test advances it.
+ */
+class FakeClock: public ola::Clock {
+ public:
+    FakeClock() {
+      struct timeval tv = {1000, 0};
+      m_now = tv;
+    }
+
+    void AdvanceTime(int32_t sec, int32_t usec) {
+      m_now += ola::TimeInterval(sec, usec);
+    }
+
+    void CurrentTime(ola::TimeStamp *timestamp) const {
+      *timestamp = m_now;
+    }
+
+ private:
+    ola::TimeStamp m_now;
+};
+
+
+unsigned int formatted_lines = 0;
+
+/*
+ * Count the lines that are formatted.
+ */
+unsigned int Formatted(unsigned int i) {
+  formatted_lines++;
+  return i;
+}
+
+
+/*
+ * Log count lines from the same statement.
+ */
+void Flood(unsigned int count) {
+  for (unsigned int i = 0; i < count; i++) {
+    OLA_WARN << "flood " << Formatted(i);
+  }
+}
+
+
 CPPUNIT_TEST_SUITE_REGISTRATION(LoggingTest);
 
 
@@ -125,3 +263,156 @@ void LoggingTest::testLogging() {
   OLA_FATAL << "fatal";
   OLA_ASSERT_EQ(destination->LinesRemaining(), 0);
 }
+
+
+void LoggingTest::tearDown() {
+  ola::SetLogRateLimit(0);
+  ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+}
+
+
+/*
+ * Check each logging statement is limited separately.
+ */
+void LoggingTest::testRateLimit() {
+  FakeClock clock;
+  CountingLogDestination *destination = new CountingLogDestination();
+  InitLogging(ola::OLA_LOG_WARN, destination);
+  ola::SetLogRateLimit(5, &clock);
+  const uint64_t suppressed = ola::SuppressedLogLines();
+  formatted_lines = 0;
+
+  Flood(20);
+  OLA_ASSERT_EQ(5u, destination->Lines());
+  OLA_ASSERT_EQ(suppressed + 15, ola::SuppressedLogLines());
+  // The suppressed lines aren't formatted.
+  OLA_ASSERT_EQ(5u, formatted_lines);
+
+  // a different statement isn't affected
+  OLA_WARN << "other";
+  OLA_ASSERT_EQ(6u, destination->Lines());
+
+  // Once the second has passed, the next line notes what was suppressed.
+  clock.AdvanceTime(1, 0);
+  Flood(1);
+  OLA_ASSERT_TRUE(ola::StringEndsWith(
+      destination->LastLine(), " flood 0 (suppressed 15 similar lines)\n"));
+  Flood(19);
+  OLA_ASSERT_EQ(11u, destination->Lines());
+  OLA_ASSERT_EQ(suppressed + 30, ola::SuppressedLogLines());
+
+  OLA_ASSERT_EQ(10u, formatted_lines);
+
+  // remove the limit
+  ola::SetLogRateLimit(0);
+  Flood(20);
+  OLA_ASSERT_EQ(31u, destination->Lines());
+  OLA_ASSERT_EQ(30u, formatted_lines);
+}
+
+
+/*
+ * Check lines are passed through to the real destination.
+ */
+void LoggingTest::testAsyncLogging() {
+  MockLogDestination *mock_destination = new MockLogDestination();
+  AsyncLogDestination *destination = new AsyncLogDestination(mock_destination);
+  // The first line starts the thread, which logs at INFO when it runs. Keep
+  // that out of the MockLogDestination.
+  InitLogging(ola::OLA_LOG_WARN, destination);
+  mock_destination->AddExpected(ola::OLA_LOG_WARN, " start\n");
+  OLA_WARN << "start";
+  ola::SetLogLevel(ola::OLA_LOG_DEBUG);
+
+  mock_destination->AddExpected(ola::OLA_LOG_DEBUG, " debug\n");
+  mock_destination->AddExpected(ola::OLA_LOG_INFO, " info\n");
+  mock_destination->AddExpected(ola::OLA_LOG_WARN, " warn\n");
+  OLA_DEBUG << "debug";
+  OLA_INFO << "info";
+  OLA_WARN << "warn";
+  destination->Flush();
+  OLA_ASSERT_EQ(mock_destination->LinesRemaining(), 0);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), destination->DroppedLines());
+
+  // long lines are truncated.
+  ola::SetLogLevel(ola::OLA_LOG_WARN);
+  CountingLogDestination *counting_destination = new CountingLogDestination();
+  destination = new AsyncLogDestination(counting_destination);
+  InitLogging(ola::OLA_LOG_WARN, destination);
+  OLA_WARN << string(AsyncLogDestination::MAX_LINE_LENGTH * 2, 'x');
+  destination->Flush();
+  OLA_ASSERT_EQ(1u, counting_destination->Lines());
+  string line = counting_destination->LastLine();
+  OLA_ASSERT_EQ(static_cast<size_t>(AsyncLogDestination::MAX_LINE_LENGTH),
+                line.size());
+  OLA_ASSERT_EQ('\n', line[line.size() - 1]);
+}
+
+
+/*
+ * Flood a slow destination from several threads. Logging mustn't block, so
+ * lines that don't fit in the queue are dropped and reported.
+ */
+void LoggingTest::testAsyncLogFlood() {
+  const unsigned int THREADS = 4;
+  const unsigned int LINES_PER_THREAD = 2000;
+
+  CountingLogDestination *counting_destination = new CountingLogDestination(
+      10);
+  AsyncLogDestination *destination = new AsyncLogDestination(
+      counting_destination, 64);
+  InitLogging(ola::OLA_LOG_WARN, destination);
+
+  vector<FloodThread*> threads;
+  for (unsigned int i = 0; i < THREADS; i++) {
+    threads.push_back(new FloodThread(LINES_PER_THREAD));
+    OLA_ASSERT_TRUE(threads.back()->Start());
+  }
+  for (unsigned int i = 0; i < THREADS; i++) {
+    OLA_ASSERT_TRUE(threads[i]->Join());
+  }
+  ola::STLDeleteElements(&threads);
+  destination->Flush();
+
+  OLA_ASSERT_GT(destination->DroppedLines(), 0);
+  OLA_ASSERT_EQ(
+      static_cast<uint64_t>(THREADS * LINES_PER_THREAD),
+      counting_destination->Lines() + destination->DroppedLines());
+  OLA_ASSERT_GT(counting_destination->DroppedReports(), 0);
+}
+
+
+#ifndef _WIN32
+/*
+ * Check a child process starts its own writer thread, like olad does when it
+ * daemonises.
+ */
+void LoggingTest::testAsyncLoggingAfterFork() {
+  CountingLogDestination *counting_destination = new CountingLogDestination();
+  AsyncLogDestination *destination = new AsyncLogDestination(
+      counting_destination);
+  InitLogging(ola::OLA_LOG_WARN, destination);
+  OLA_WARN << "before fork";
+  destination->Flush();
+  OLA_ASSERT_EQ(1u, counting_destination->Lines());
+
+  pid_t pid = fork();
+  OLA_ASSERT_NE(-1, pid);
+  if (pid == 0) {
+    // The parent's thread doesn't exist here, so this mustn't wait for it.
+    destination->Flush();
+    OLA_WARN << "child";
+    destination->Flush();
+    _exit(counting_destination->Lines() == 2 ? 0 : 1);
+  }
+
+  int status = 0;
+  OLA_ASSERT_EQ(pid, waitpid(pid, &status, 0));
+  OLA_ASSERT_TRUE(WIFEXITED(status));
+  OLA_ASSERT_EQ(0, WEXITSTATUS(status));
+
+  OLA_WARN << "parent";
+  destination->Flush();
+  OLA_ASSERT_EQ(2u, counting_destination->Lines());
+}
+#endif  // _WIN32
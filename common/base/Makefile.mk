@@ -9,6 +9,13 @@ common_libolacommon_la_SOURCES += \
     common/base/SysExits.cpp \
     common/base/Version.cpp
 
+# PROGRAMS
+##################################################
+noinst_PROGRAMS += common/base/log_flood_benchmark
+common_base_log_flood_benchmark_SOURCES = \
+    common/base/log_flood_benchmark.cpp
+common_base_log_flood_benchmark_LDADD = common/libolacommon.la
+
 # TESTS
 ##################################################
 
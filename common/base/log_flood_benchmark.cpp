@@ -0,0 +1,116 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * log_flood_benchmark.cpp
+ * Measure what logging costs the caller when the destination is slow, with
+ * and without the AsyncLogDestination.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <unistd.h>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+
+using ola::AsyncLogDestination;
+using ola::Clock;
+using ola::LogDestination;
+using ola::TimeStamp;
+using std::cout;
+using std::endl;
+using std::string;
+
+DEFINE_s_uint32(lines, n, 20000, "The number of lines to log");
+DEFINE_s_uint32(delay, d, 20,
+                "The time the destination takes to write a line, in us");
+DEFINE_uint32(queue_size, AsyncLogDestination::DEFAULT_QUEUE_SIZE,
+              "The number of lines the async queue holds");
+
+/*
+ * A destination that sleeps on each line, like stderr to a slow terminal.
+ */
+class SlowLogDestination: public LogDestination {
+ public:
+  explicit SlowLogDestination(unsigned int delay_us)
+      : m_delay_us(delay_us),
+        m_lines(0) {
+  }
+
+  void Write(ola::log_level, const string&) {
+    usleep(m_delay_us);
+    m_lines++;
+  }
+
+  unsigned int Lines() const { return m_lines; }
+
+ private:
+  const unsigned int m_delay_us;
+  unsigned int m_lines;
+};
+
+/*
+ * Log FLAGS_lines lines and return the time per line in us.
+ */
+double Flood() {
+  Clock clock;
+  TimeStamp start, end;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < FLAGS_lines; i++) {
+    OLA_WARN << "short ACN frame " << i;
+  }
+  clock.CurrentTime(&end);
+  return static_cast<double>((end - start).AsInt()) / FLAGS_lines;
+}
+
+void PrintResult(const string &description, double us_per_line,
+                 unsigned int written, uint64_t dropped) {
+  cout << std::left << std::setw(8) << description << std::right
+       << std::setw(10) << std::fixed << std::setprecision(2) << us_per_line
+       << " us/line, " << written << " written, " << dropped << " dropped"
+       << endl;
+}
+
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Time logging a flood of lines to a slow destination.");
+
+  cout << FLAGS_lines << " lines, " << FLAGS_delay << " us per write" << endl;
+
+  // The log target owns the destination, so look at it before replacing it.
+  SlowLogDestination *slow_destination = new SlowLogDestination(FLAGS_delay);
+  ola::InitLogging(ola::OLA_LOG_WARN, slow_destination);
+  double us_per_line = Flood();
+  PrintResult("sync", us_per_line, slow_destination->Lines(), 0);
+
+  slow_destination = new SlowLogDestination(FLAGS_delay);
+  AsyncLogDestination *async_destination = new AsyncLogDestination(
+      slow_destination, FLAGS_queue_size);
+  ola::InitLogging(ola::OLA_LOG_WARN, async_destination);
+  us_per_line = Flood();
+  async_destination->Flush();
+  uint64_t dropped = async_destination->DroppedLines();
+  // Don't count the report of the dropped lines.
+  PrintResult("async", us_per_line,
+              slow_destination->Lines() - (dropped ? 1 : 0), dropped);
+
+  ola::InitLogging(ola::OLA_LOG_WARN, ola::OLA_LOG_NULL);
+  return 0;
+}
@@ -0,0 +1,202 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * HTPMerge.cpp
+ * Byte-wise HTP (max) merge kernels with runtime CPU dispatch.
+ * Copyright (C) 2026 Simon Newton
+ *
+ * Each kernel walks the output once, loading a block of slots, taking the
+ * max with the same block from every input, and storing the result. This
+ * keeps the output in a register rather than re-reading it for every source.
+ *
+ * The x86 kernels are compiled with function-level target attributes so the
+ * rest of the library doesn't need -msse2 / -mavx2, the CPU is checked at
+ * runtime before they're used.
+ */
+
+#include <stdint.h>
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define OLA_HTP_MERGE_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define OLA_HTP_MERGE_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include "common/dmx/HTPMerge.h"
+
+namespace ola {
+namespace dmx {
+
+namespace {
+
+/*
+ * Merge slots [start, end). This is used by all the kernels for the slots that
+ * don't fill a complete vector.
+ */
+void ScalarHTPMergeRange(uint8_t *output,
+                         const uint8_t *const *inputs,
+                         unsigned int input_count,
+                         unsigned int start,
+                         unsigned int end) {
+  for (unsigned int i = start; i < end; i++) {
+    uint8_t value = output[i];
+    for (unsigned int j = 0; j < input_count; j++) {
+      value = std::max(value, inputs[j][i]);
+    }
+    output[i] = value;
+  }
+}
+
+void ScalarHTPMerge(uint8_t *output,
+                    const uint8_t *const *inputs,
+                    unsigned int input_count,
+                    unsigned int length) {
+  ScalarHTPMergeRange(output, inputs, input_count, 0, length);
+}
+
+#ifdef OLA_HTP_MERGE_X86
+__attribute__((target("sse2")))
+void SSE2HTPMerge(uint8_t *output,
+                  const uint8_t *const *inputs,
+                  unsigned int input_count,
+                  unsigned int length) {
+  unsigned int i = 0;
+  for (; i + sizeof(__m128i) <= length; i += sizeof(__m128i)) {
+    __m128i value = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(output + i));
+    for (unsigned int j = 0; j < input_count; j++) {
+      value = _mm_max_epu8(
+          value,
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(inputs[j] + i)));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), value);
+  }
+  ScalarHTPMergeRange(output, inputs, input_count, i, length);
+}
+
+__attribute__((target("avx2")))
+void AVX2HTPMerge(uint8_t *output,
+                  const uint8_t *const *inputs,
+                  unsigned int input_count,
+                  unsigned int length) {
+  unsigned int i = 0;
+  for (; i + sizeof(__m256i) <= length; i += sizeof(__m256i)) {
+    __m256i value = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(output + i));
+    for (unsigned int j = 0; j < input_count; j++) {
+      value = _mm256_max_epu8(
+          value,
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(inputs[j] + i)));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), value);
+  }
+  ScalarHTPMergeRange(output, inputs, input_count, i, length);
+}
+#endif  // OLA_HTP_MERGE_X86
+
+#ifdef OLA_HTP_MERGE_NEON
+void NEONHTPMerge(uint8_t *output,
+                  const uint8_t *const *inputs,
+                  unsigned int input_count,
+                  unsigned int length) {
+  unsigned int i = 0;
+  for (; i + sizeof(uint8x16_t) <= length; i += sizeof(uint8x16_t)) {
+    uint8x16_t value = vld1q_u8(output + i);
+    for (unsigned int j = 0; j < input_count; j++) {
+      value = vmaxq_u8(value, vld1q_u8(inputs[j] + i));
+    }
+    vst1q_u8(output + i, value);
+  }
+  ScalarHTPMergeRange(output, inputs, input_count, i, length);
+}
+#endif  // OLA_HTP_MERGE_NEON
+}  // namespace
+
+
+HTPMergeImplementation BestHTPMergeImplementation() {
+#ifdef OLA_HTP_MERGE_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return HTP_MERGE_AVX2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return HTP_MERGE_SSE2;
+  }
+#endif  // OLA_HTP_MERGE_X86
+#ifdef OLA_HTP_MERGE_NEON
+  return HTP_MERGE_NEON;
+#endif  // OLA_HTP_MERGE_NEON
+  return HTP_MERGE_SCALAR;
+}
+
+
+HTPMergeFunction GetHTPMergeFunction() {
+  // If two threads race they both probe the CPU and store the same value,
+  // the atomics make sure neither sees a torn pointer.
+  static HTPMergeFunction merge_function = NULL;
+  HTPMergeFunction function = __atomic_load_n(&merge_function,
+                                              __ATOMIC_ACQUIRE);
+  if (!function) {
+    function = GetHTPMergeFunction(BestHTPMergeImplementation());
+    __atomic_store_n(&merge_function, function, __ATOMIC_RELEASE);
+  }
+  return function;
+}
+
+
+HTPMergeFunction GetHTPMergeFunction(HTPMergeImplementation implementation) {
+  switch (implementation) {
+    case HTP_MERGE_SCALAR:
+      return ScalarHTPMerge;
+#ifdef OLA_HTP_MERGE_X86
+    case HTP_MERGE_SSE2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("sse2") ? SSE2HTPMerge : NULL;
+    case HTP_MERGE_AVX2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2") ? AVX2HTPMerge : NULL;
+#endif  // OLA_HTP_MERGE_X86
+#ifdef OLA_HTP_MERGE_NEON
+    case HTP_MERGE_NEON:
+      return NEONHTPMerge;
+#endif  // OLA_HTP_MERGE_NEON
+    default:
+      return NULL;
+  }
+}
+
+
+const char *HTPMergeImplementationName(
+    HTPMergeImplementation implementation) {
+  switch (implementation) {
+    case HTP_MERGE_SCALAR:
+      return "scalar";
+    case HTP_MERGE_SSE2:
+      return "sse2";
+    case HTP_MERGE_AVX2:
+      return "avx2";
+    case HTP_MERGE_NEON:
+      return "neon";
+    default:
+      return "unknown";
+  }
+}
+}  // namespace dmx
+}  // namespace ola
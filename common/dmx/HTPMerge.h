@@ -0,0 +1,81 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * HTPMerge.h
+ * Byte-wise HTP (max) merge kernels with runtime CPU dispatch.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef COMMON_DMX_HTPMERGE_H_
+#define COMMON_DMX_HTPMERGE_H_
+
+#include <stdint.h>
+
+namespace ola {
+namespace dmx {
+
+/**
+ * @brief The HTP merge kernels that may be available.
+ */
+typedef enum {
+  HTP_MERGE_SCALAR,  /**< Portable C++ implementation, always available */
+  HTP_MERGE_SSE2,  /**< x86 SSE2, 16 slots at a time */
+  HTP_MERGE_AVX2,  /**< x86 AVX2, 32 slots at a time */
+  HTP_MERGE_NEON  /**< ARM NEON, 16 slots at a time */
+} HTPMergeImplementation;
+
+/**
+ * @brief An N-way HTP merge kernel.
+ * @param output the data to merge into, this is read and written.
+ * @param inputs an array of input_count pointers to the data to merge.
+ * @param input_count the number of pointers in inputs.
+ * @param length the number of slots to merge. Each input must have at least
+ *   this many slots.
+ *
+ * On return, output[i] = max(output[i], inputs[0][i], ... inputs[n-1][i]) for
+ * all i < length.
+ */
+typedef void (*HTPMergeFunction)(uint8_t *output,
+                                 const uint8_t *const *inputs,
+                                 unsigned int input_count,
+                                 unsigned int length);
+
+/**
+ * @brief Return which HTP merge kernel is the fastest one this CPU supports.
+ */
+HTPMergeImplementation BestHTPMergeImplementation();
+
+/**
+ * @brief Return the fastest HTP merge kernel supported by this CPU.
+ *
+ * The CPU is probed on the first call and the result cached.
+ */
+HTPMergeFunction GetHTPMergeFunction();
+
+/**
+ * @brief Return a specific HTP merge kernel.
+ * @param implementation the kernel to return.
+ * @returns the kernel, or NULL if this build or CPU doesn't support it.
+ */
+HTPMergeFunction GetHTPMergeFunction(HTPMergeImplementation implementation);
+
+/**
+ * @brief Return the name of a HTP merge kernel, for logging.
+ */
+const char *HTPMergeImplementationName(
+    HTPMergeImplementation implementation);
+}  // namespace dmx
+}  // namespace ola
+#endif  // COMMON_DMX_HTPMERGE_H_
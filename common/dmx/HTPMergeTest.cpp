@@ -0,0 +1,149 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * HTPMergeTest.cpp
+ * Test fixture for the HTP merge kernels
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+#include "common/dmx/HTPMerge.h"
+#include "ola/Constants.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::dmx::GetHTPMergeFunction;
+using ola::dmx::HTPMergeFunction;
+using ola::dmx::HTPMergeImplementation;
+
+class HTPMergeTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(HTPMergeTest);
+  CPPUNIT_TEST(testScalar);
+  CPPUNIT_TEST(testKernelsMatchScalar);
+  CPPUNIT_TEST(testBestKernel);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testScalar();
+    void testKernelsMatchScalar();
+    void testBestKernel();
+
+ private:
+    static const unsigned int MAX_INPUTS = 9;
+
+    void FillData(uint8_t *data, unsigned int length, unsigned int seed);
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(HTPMergeTest);
+
+
+/*
+ * Fill a buffer with repeatable, pseudo-random data.
+ */
+void HTPMergeTest::FillData(uint8_t *data, unsigned int length,
+                            unsigned int seed) {
+  uint32_t state = seed * 2654435761u + 1;
+  for (unsigned int i = 0; i < length; i++) {
+    state = state * 1103515245u + 12345u;
+    data[i] = static_cast<uint8_t>(state >> 16);
+  }
+}
+
+
+/*
+ * Check the scalar kernel.
+ */
+void HTPMergeTest::testScalar() {
+  HTPMergeFunction merge = GetHTPMergeFunction(ola::dmx::HTP_MERGE_SCALAR);
+  OLA_ASSERT_NOT_NULL(merge);
+
+  const uint8_t input1[] = {0, 10, 255, 3, 128, 0};
+  const uint8_t input2[] = {1, 9, 0, 200, 128, 0};
+  const uint8_t expected[] = {5, 10, 255, 200, 128, 99};
+  uint8_t output[] = {5, 0, 0, 0, 127, 99};
+  const uint8_t *inputs[] = {input1, input2};
+
+  merge(output, inputs, 2, 5);
+  OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected), output, sizeof(output));
+
+  // a zero length merge is a no-op
+  merge(output, inputs, 2, 0);
+  OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected), output, sizeof(output));
+}
+
+
+/*
+ * Check that every kernel this CPU supports is bit-exact with the scalar one,
+ * for all input counts and lengths that exercise the vector tails.
+ */
+void HTPMergeTest::testKernelsMatchScalar() {
+  const HTPMergeImplementation implementations[] = {
+    ola::dmx::HTP_MERGE_SSE2,
+    ola::dmx::HTP_MERGE_AVX2,
+    ola::dmx::HTP_MERGE_NEON,
+  };
+
+  HTPMergeFunction scalar = GetHTPMergeFunction(ola::dmx::HTP_MERGE_SCALAR);
+
+  uint8_t input_data[MAX_INPUTS][ola::DMX_UNIVERSE_SIZE];
+  const uint8_t *inputs[MAX_INPUTS];
+  for (unsigned int i = 0; i < MAX_INPUTS; i++) {
+    FillData(input_data[i], ola::DMX_UNIVERSE_SIZE, i + 1);
+    inputs[i] = input_data[i];
+  }
+
+  uint8_t initial[ola::DMX_UNIVERSE_SIZE];
+  FillData(initial, ola::DMX_UNIVERSE_SIZE, 0);
+
+  for (unsigned int i = 0;
+       i < sizeof(implementations) / sizeof(implementations[0]); i++) {
+    HTPMergeFunction merge = GetHTPMergeFunction(implementations[i]);
+    if (!merge) {
+      continue;
+    }
+
+    for (unsigned int input_count = 0; input_count <= MAX_INPUTS;
+         input_count++) {
+      for (unsigned int length = 0; length <= ola::DMX_UNIVERSE_SIZE;
+           length++) {
+        uint8_t expected[ola::DMX_UNIVERSE_SIZE];
+        uint8_t output[ola::DMX_UNIVERSE_SIZE];
+        memcpy(expected, initial, sizeof(expected));
+        memcpy(output, initial, sizeof(output));
+
+        scalar(expected, inputs, input_count, length);
+        merge(output, inputs, input_count, length);
+        OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected),
+                               output, sizeof(output));
+      }
+    }
+  }
+}
+
+
+/*
+ * Check the dispatcher returns a usable kernel.
+ */
+void HTPMergeTest::testBestKernel() {
+  HTPMergeImplementation best = ola::dmx::BestHTPMergeImplementation();
+  OLA_ASSERT_NOT_NULL(GetHTPMergeFunction(best));
+  OLA_ASSERT_TRUE(GetHTPMergeFunction(best) == GetHTPMergeFunction());
+  OLA_ASSERT_NE(std::string("unknown"),
+                std::string(ola::dmx::HTPMergeImplementationName(best)));
+}
@@ -0,0 +1,256 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * PriorityMerge.cpp
+ * Per-slot priority merge kernels with runtime CPU dispatch.
+ * Copyright (C) 2026 Simon Newton
+ *
+ * The vector kernels compute the same result as the scalar one without
+ * branching: the per-slot comparisons produce byte masks which are used to
+ * select between the input and output values.
+ */
+
+#include <stdint.h>
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define OLA_PRIORITY_MERGE_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define OLA_PRIORITY_MERGE_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include "common/dmx/PriorityMerge.h"
+
+namespace ola {
+namespace dmx {
+
+namespace {
+
+/*
+ * Merge slots [start, end). This is used by all the kernels for the slots that
+ * don't fill a complete vector.
+ */
+template <bool htp_ties>
+void ScalarPriorityMergeRange(uint8_t *output,
+                              uint8_t *output_priorities,
+                              const uint8_t *input,
+                              const uint8_t *input_priorities,
+                              unsigned int start,
+                              unsigned int end) {
+  for (unsigned int i = start; i < end; i++) {
+    uint8_t priority = input_priorities[i];
+    if (priority == 0) {
+      continue;
+    }
+    if (priority > output_priorities[i]) {
+      output_priorities[i] = priority;
+      output[i] = input[i];
+    } else if (priority == output_priorities[i]) {
+      output[i] = htp_ties ? std::max(output[i], input[i]) : input[i];
+    }
+  }
+}
+
+template <bool htp_ties>
+void ScalarPriorityMerge(uint8_t *output,
+                         uint8_t *output_priorities,
+                         const uint8_t *input,
+                         const uint8_t *input_priorities,
+                         unsigned int length) {
+  ScalarPriorityMergeRange<htp_ties>(output, output_priorities, input,
+                                     input_priorities, 0, length);
+}
+
+#ifdef OLA_PRIORITY_MERGE_X86
+__attribute__((target("sse2")))
+inline __m128i SSE2Select(__m128i mask, __m128i if_set, __m128i if_clear) {
+  return _mm_or_si128(_mm_and_si128(mask, if_set),
+                      _mm_andnot_si128(mask, if_clear));
+}
+
+template <bool htp_ties>
+__attribute__((target("sse2")))
+void SSE2PriorityMerge(uint8_t *output,
+                       uint8_t *output_priorities,
+                       const uint8_t *input,
+                       const uint8_t *input_priorities,
+                       unsigned int length) {
+  const __m128i zero = _mm_setzero_si128();
+  unsigned int i = 0;
+  for (; i + sizeof(__m128i) <= length; i += sizeof(__m128i)) {
+    __m128i out_priority = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(output_priorities + i));
+    __m128i out_value = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(output + i));
+    __m128i in_priority = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(input_priorities + i));
+    __m128i in_value = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(input + i));
+
+    __m128i max_priority = _mm_max_epu8(out_priority, in_priority);
+    __m128i in_ge = _mm_cmpeq_epi8(max_priority, in_priority);
+    __m128i unsourced = _mm_cmpeq_epi8(in_priority, zero);
+    __m128i result;
+    if (htp_ties) {
+      __m128i out_ge = _mm_cmpeq_epi8(max_priority, out_priority);
+      __m128i tie = _mm_andnot_si128(unsourced, _mm_and_si128(in_ge, out_ge));
+      result = SSE2Select(tie, _mm_max_epu8(out_value, in_value), out_value);
+      result = SSE2Select(out_ge, result, in_value);
+    } else {
+      result = SSE2Select(_mm_andnot_si128(unsourced, in_ge), in_value,
+                          out_value);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), result);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output_priorities + i),
+                     max_priority);
+  }
+  ScalarPriorityMergeRange<htp_ties>(output, output_priorities, input,
+                                     input_priorities, i, length);
+}
+
+template <bool htp_ties>
+__attribute__((target("avx2")))
+void AVX2PriorityMerge(uint8_t *output,
+                       uint8_t *output_priorities,
+                       const uint8_t *input,
+                       const uint8_t *input_priorities,
+                       unsigned int length) {
+  const __m256i zero = _mm256_setzero_si256();
+  unsigned int i = 0;
+  for (; i + sizeof(__m256i) <= length; i += sizeof(__m256i)) {
+    __m256i out_priority = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(output_priorities + i));
+    __m256i out_value = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(output + i));
+    __m256i in_priority = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(input_priorities + i));
+    __m256i in_value = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(input + i));
+
+    __m256i max_priority = _mm256_max_epu8(out_priority, in_priority);
+    __m256i in_ge = _mm256_cmpeq_epi8(max_priority, in_priority);
+    __m256i unsourced = _mm256_cmpeq_epi8(in_priority, zero);
+    __m256i result;
+    if (htp_ties) {
+      __m256i out_ge = _mm256_cmpeq_epi8(max_priority, out_priority);
+      __m256i tie = _mm256_andnot_si256(unsourced,
+                                        _mm256_and_si256(in_ge, out_ge));
+      result = _mm256_blendv_epi8(out_value,
+                                  _mm256_max_epu8(out_value, in_value), tie);
+      result = _mm256_blendv_epi8(in_value, result, out_ge);
+    } else {
+      result = _mm256_blendv_epi8(out_value, in_value,
+                                  _mm256_andnot_si256(unsourced, in_ge));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), result);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output_priorities + i),
+                        max_priority);
+  }
+  ScalarPriorityMergeRange<htp_ties>(output, output_priorities, input,
+                                     input_priorities, i, length);
+}
+#endif  // OLA_PRIORITY_MERGE_X86
+
+#ifdef OLA_PRIORITY_MERGE_NEON
+template <bool htp_ties>
+void NEONPriorityMerge(uint8_t *output,
+                       uint8_t *output_priorities,
+                       const uint8_t *input,
+                       const uint8_t *input_priorities,
+                       unsigned int length) {
+  const uint8x16_t zero = vdupq_n_u8(0);
+  unsigned int i = 0;
+  for (; i + sizeof(uint8x16_t) <= length; i += sizeof(uint8x16_t)) {
+    uint8x16_t out_priority = vld1q_u8(output_priorities + i);
+    uint8x16_t out_value = vld1q_u8(output + i);
+    uint8x16_t in_priority = vld1q_u8(input_priorities + i);
+    uint8x16_t in_value = vld1q_u8(input + i);
+
+    uint8x16_t in_ge = vcgeq_u8(in_priority, out_priority);
+    uint8x16_t sourced = vcgtq_u8(in_priority, zero);
+    uint8x16_t result;
+    if (htp_ties) {
+      uint8x16_t out_ge = vcgeq_u8(out_priority, in_priority);
+      uint8x16_t tie = vandq_u8(sourced, vandq_u8(in_ge, out_ge));
+      result = vbslq_u8(tie, vmaxq_u8(out_value, in_value), out_value);
+      result = vbslq_u8(out_ge, result, in_value);
+    } else {
+      result = vbslq_u8(vandq_u8(sourced, in_ge), in_value, out_value);
+    }
+    vst1q_u8(output + i, result);
+    vst1q_u8(output_priorities + i, vmaxq_u8(out_priority, in_priority));
+  }
+  ScalarPriorityMergeRange<htp_ties>(output, output_priorities, input,
+                                     input_priorities, i, length);
+}
+#endif  // OLA_PRIORITY_MERGE_NEON
+}  // namespace
+
+
+PriorityMergeFunction GetPriorityMergeFunction(PriorityTieBreak tie_break) {
+  // See the note in GetHTPMergeFunction() about thread safety.
+  static PriorityMergeFunction htp_function = NULL;
+  static PriorityMergeFunction latest_function = NULL;
+  PriorityMergeFunction *cached = (
+      tie_break == PRIORITY_TIE_HTP ? &htp_function : &latest_function);
+  PriorityMergeFunction function = __atomic_load_n(cached, __ATOMIC_ACQUIRE);
+  if (!function) {
+    function = GetPriorityMergeFunction(BestHTPMergeImplementation(),
+                                        tie_break);
+    __atomic_store_n(cached, function, __ATOMIC_RELEASE);
+  }
+  return function;
+}
+
+
+PriorityMergeFunction GetPriorityMergeFunction(
+    HTPMergeImplementation implementation,
+    PriorityTieBreak tie_break) {
+  bool htp_ties = tie_break == PRIORITY_TIE_HTP;
+  switch (implementation) {
+    case HTP_MERGE_SCALAR:
+      return htp_ties ? &ScalarPriorityMerge<true> :
+                        &ScalarPriorityMerge<false>;
+#ifdef OLA_PRIORITY_MERGE_X86
+    case HTP_MERGE_SSE2:
+      __builtin_cpu_init();
+      if (!__builtin_cpu_supports("sse2")) {
+        return NULL;
+      }
+      return htp_ties ? &SSE2PriorityMerge<true> :
+                        &SSE2PriorityMerge<false>;
+    case HTP_MERGE_AVX2:
+      __builtin_cpu_init();
+      if (!__builtin_cpu_supports("avx2")) {
+        return NULL;
+      }
+      return htp_ties ? &AVX2PriorityMerge<true> :
+                        &AVX2PriorityMerge<false>;
+#endif  // OLA_PRIORITY_MERGE_X86
+#ifdef OLA_PRIORITY_MERGE_NEON
+    case HTP_MERGE_NEON:
+      return htp_ties ? &NEONPriorityMerge<true> :
+                        &NEONPriorityMerge<false>;
+#endif  // OLA_PRIORITY_MERGE_NEON
+    default:
+      return NULL;
+  }
+}
+}  // namespace dmx
+}  // namespace ola
@@ -0,0 +1,78 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * PriorityMerge.h
+ * Per-slot priority merge kernels with runtime CPU dispatch.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef COMMON_DMX_PRIORITYMERGE_H_
+#define COMMON_DMX_PRIORITYMERGE_H_
+
+#include <stdint.h>
+#include "common/dmx/HTPMerge.h"
+
+namespace ola {
+namespace dmx {
+
+/**
+ * @brief How to resolve slots where two sources have the same priority.
+ */
+typedef enum {
+  PRIORITY_TIE_HTP,  /**< The highest value wins */
+  PRIORITY_TIE_LATEST  /**< The source merged last wins */
+} PriorityTieBreak;
+
+/**
+ * @brief Merge one source into the output, slot by slot.
+ * @param output the data to merge into, this is read and written.
+ * @param output_priorities the priority of each slot in output, this is read
+ *   and written. Start with all zeros.
+ * @param input the data to merge.
+ * @param input_priorities the priority of each slot in input. A priority of 0
+ *   means the source isn't sending that slot.
+ * @param length the number of slots to merge.
+ *
+ * For each slot, if the input priority is higher than the output priority, the
+ * input value and priority replace the output. If they are equal (and
+ * non-zero), the tie is resolved according to the PriorityTieBreak the kernel
+ * was selected with.
+ */
+typedef void (*PriorityMergeFunction)(uint8_t *output,
+                                      uint8_t *output_priorities,
+                                      const uint8_t *input,
+                                      const uint8_t *input_priorities,
+                                      unsigned int length);
+
+/**
+ * @brief Return the fastest per-slot priority merge kernel for this CPU.
+ * @param tie_break how to resolve slots at the same priority.
+ *
+ * This uses the same CPU detection as GetHTPMergeFunction().
+ */
+PriorityMergeFunction GetPriorityMergeFunction(PriorityTieBreak tie_break);
+
+/**
+ * @brief Return a specific per-slot priority merge kernel.
+ * @param implementation the instruction set to use.
+ * @param tie_break how to resolve slots at the same priority.
+ * @returns the kernel, or NULL if this build or CPU doesn't support it.
+ */
+PriorityMergeFunction GetPriorityMergeFunction(
+    HTPMergeImplementation implementation,
+    PriorityTieBreak tie_break);
+}  // namespace dmx
+}  // namespace ola
+#endif  // COMMON_DMX_PRIORITYMERGE_H_
@@ -0,0 +1,198 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * PriorityMergeTest.cpp
+ * Test fixture for the per-slot priority merge kernels
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "common/dmx/PriorityMerge.h"
+#include "ola/Constants.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::dmx::GetPriorityMergeFunction;
+using ola::dmx::HTPMergeImplementation;
+using ola::dmx::PriorityMergeFunction;
+using ola::dmx::PriorityTieBreak;
+
+class PriorityMergeTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PriorityMergeTest);
+  CPPUNIT_TEST(testScalarHTP);
+  CPPUNIT_TEST(testScalarLatest);
+  CPPUNIT_TEST(testKernelsMatchScalar);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void testScalarHTP();
+    void testScalarLatest();
+    void testKernelsMatchScalar();
+
+ private:
+    static const unsigned int INPUT_COUNT = 4;
+
+    void FillData(uint8_t *data, unsigned int length, unsigned int seed,
+                  uint8_t modulus);
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PriorityMergeTest);
+
+
+/*
+ * Fill a buffer with repeatable, pseudo-random data in [0, modulus).
+ */
+void PriorityMergeTest::FillData(uint8_t *data, unsigned int length,
+                                 unsigned int seed, uint8_t modulus) {
+  uint32_t state = seed * 2654435761u + 1;
+  for (unsigned int i = 0; i < length; i++) {
+    state = state * 1103515245u + 12345u;
+    data[i] = static_cast<uint8_t>((state >> 16) % modulus);
+  }
+}
+
+
+/*
+ * Check the scalar kernel with HTP ties.
+ */
+void PriorityMergeTest::testScalarHTP() {
+  PriorityMergeFunction merge = GetPriorityMergeFunction(
+      ola::dmx::HTP_MERGE_SCALAR, ola::dmx::PRIORITY_TIE_HTP);
+  OLA_ASSERT_NOT_NULL(merge);
+
+  uint8_t output[] = {0, 0, 0, 0, 0, 0};
+  uint8_t output_priorities[] = {0, 0, 0, 0, 0, 0};
+
+  const uint8_t input1[] = {10, 20, 30, 40, 50, 60};
+  const uint8_t priorities1[] = {100, 100, 100, 0, 50, 0};
+  merge(output, output_priorities, input1, priorities1, 6);
+
+  const uint8_t expected1[] = {10, 20, 30, 0, 50, 0};
+  OLA_ASSERT_DATA_EQUALS(expected1, sizeof(expected1),
+                         output, sizeof(output));
+  OLA_ASSERT_DATA_EQUALS(priorities1, sizeof(priorities1),
+                         output_priorities, sizeof(output_priorities));
+
+  const uint8_t input2[] = {5, 25, 35, 45, 55, 65};
+  const uint8_t priorities2[] = {100, 100, 99, 1, 0, 0};
+  merge(output, output_priorities, input2, priorities2, 6);
+
+  const uint8_t expected2[] = {10, 25, 30, 45, 50, 0};
+  const uint8_t expected_priorities2[] = {100, 100, 100, 1, 50, 0};
+  OLA_ASSERT_DATA_EQUALS(expected2, sizeof(expected2),
+                         output, sizeof(output));
+  OLA_ASSERT_DATA_EQUALS(expected_priorities2, sizeof(expected_priorities2),
+                         output_priorities, sizeof(output_priorities));
+}
+
+
+/*
+ * Check the scalar kernel with the latest source winning ties.
+ */
+void PriorityMergeTest::testScalarLatest() {
+  PriorityMergeFunction merge = GetPriorityMergeFunction(
+      ola::dmx::HTP_MERGE_SCALAR, ola::dmx::PRIORITY_TIE_LATEST);
+  OLA_ASSERT_NOT_NULL(merge);
+
+  uint8_t output[] = {0, 0, 0, 0};
+  uint8_t output_priorities[] = {0, 0, 0, 0};
+
+  const uint8_t input1[] = {10, 20, 30, 40};
+  const uint8_t priorities1[] = {100, 100, 100, 100};
+  merge(output, output_priorities, input1, priorities1, 4);
+
+  const uint8_t input2[] = {5, 25, 35, 45};
+  const uint8_t priorities2[] = {100, 99, 0, 101};
+  merge(output, output_priorities, input2, priorities2, 4);
+
+  const uint8_t expected[] = {5, 20, 30, 45};
+  const uint8_t expected_priorities[] = {100, 100, 100, 101};
+  OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected),
+                         output, sizeof(output));
+  OLA_ASSERT_DATA_EQUALS(expected_priorities, sizeof(expected_priorities),
+                         output_priorities, sizeof(output_priorities));
+}
+
+
+/*
+ * Check that every kernel this CPU supports is bit-exact with the scalar one,
+ * for all lengths that exercise the vector tails.
+ */
+void PriorityMergeTest::testKernelsMatchScalar() {
+  const HTPMergeImplementation implementations[] = {
+    ola::dmx::HTP_MERGE_SSE2,
+    ola::dmx::HTP_MERGE_AVX2,
+    ola::dmx::HTP_MERGE_NEON,
+  };
+  const PriorityTieBreak tie_breaks[] = {
+    ola::dmx::PRIORITY_TIE_HTP,
+    ola::dmx::PRIORITY_TIE_LATEST,
+  };
+
+  // Use a small range of priorities so there are plenty of ties and
+  // unsourced slots.
+  uint8_t input_data[INPUT_COUNT][ola::DMX_UNIVERSE_SIZE];
+  uint8_t input_priorities[INPUT_COUNT][ola::DMX_UNIVERSE_SIZE];
+  for (unsigned int i = 0; i < INPUT_COUNT; i++) {
+    FillData(input_data[i], ola::DMX_UNIVERSE_SIZE, i + 1, 255);
+    FillData(input_priorities[i], ola::DMX_UNIVERSE_SIZE, i + 100, 4);
+  }
+
+  for (unsigned int t = 0; t < sizeof(tie_breaks) / sizeof(tie_breaks[0]);
+       t++) {
+    PriorityMergeFunction scalar = GetPriorityMergeFunction(
+        ola::dmx::HTP_MERGE_SCALAR, tie_breaks[t]);
+
+    for (unsigned int i = 0;
+         i < sizeof(implementations) / sizeof(implementations[0]); i++) {
+      PriorityMergeFunction merge = GetPriorityMergeFunction(
+          implementations[i], tie_breaks[t]);
+      if (!merge) {
+        continue;
+      }
+
+      for (unsigned int length = 0; length <= ola::DMX_UNIVERSE_SIZE;
+           length++) {
+        uint8_t expected[ola::DMX_UNIVERSE_SIZE];
+        uint8_t expected_priorities[ola::DMX_UNIVERSE_SIZE];
+        uint8_t output[ola::DMX_UNIVERSE_SIZE];
+        uint8_t output_priorities[ola::DMX_UNIVERSE_SIZE];
+        memset(expected, 0, sizeof(expected));
+        memset(expected_priorities, 0, sizeof(expected_priorities));
+        memset(output, 0, sizeof(output));
+        memset(output_priorities, 0, sizeof(output_priorities));
+
+        for (unsigned int j = 0; j < INPUT_COUNT; j++) {
+          scalar(expected, expected_priorities, input_data[j],
+                 input_priorities[j], length);
+          merge(output, output_priorities, input_data[j],
+                input_priorities[j], length);
+        }
+        OLA_ASSERT_DATA_EQUALS(expected, sizeof(expected),
+                               output, sizeof(output));
+        OLA_ASSERT_DATA_EQUALS(expected_priorities,
+                               sizeof(expected_priorities),
+                               output_priorities, sizeof(output_priorities));
+      }
+    }
+  }
+
+  OLA_ASSERT_NOT_NULL(GetPriorityMergeFunction(ola::dmx::PRIORITY_TIE_HTP));
+  OLA_ASSERT_NOT_NULL(
+      GetPriorityMergeFunction(ola::dmx::PRIORITY_TIE_LATEST));
+}
@@ -0,0 +1,251 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SharedDmxRegion.cpp
+ * DMX frames in POSIX shared memory.
+ * Copyright (C) 2026 Simon Newton
+ *
+ * The region starts with a RegionHeader, followed by slot_count Slots. Each
+ * slot has a sequence number which is odd while the slot is being written.
+ * Readers check the sequence number before and after copying the data, and
+ * discard the copy if it changed.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef HAVE_SHM_OPEN
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include <algorithm>
+#include <string>
+
+#include "common/dmx/SharedDmxRegion.h"
+#include "ola/Constants.h"
+#include "ola/Logging.h"
+
+namespace ola {
+namespace dmx {
+
+using std::string;
+
+namespace {
+
+struct RegionHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slot_count;
+  uint32_t slot_size;
+};
+
+// Each slot is padded to a multiple of the cache line size so writers to
+// different slots don't contend.
+struct Slot {
+  volatile uint32_t sequence;
+  uint16_t length;
+  uint8_t priority;
+  uint8_t padding;
+  uint8_t data[DMX_UNIVERSE_SIZE];
+  uint8_t alignment[56];
+};
+
+const uint32_t REGION_MAGIC = 0x4f4c4153;  // OLAS
+const uint32_t REGION_VERSION = 1;
+const size_t HEADER_SIZE = 64;
+
+Slot *GetSlot(uint8_t *memory, unsigned int slot) {
+  return reinterpret_cast<Slot*>(memory + HEADER_SIZE + slot * sizeof(Slot));
+}
+
+size_t RegionSize(unsigned int slot_count) {
+  return HEADER_SIZE + slot_count * sizeof(Slot);
+}
+}  // namespace
+
+
+SharedDmxRegion::SharedDmxRegion(const string &name, bool owner,
+                                 uint8_t *memory, size_t size,
+                                 unsigned int slot_count)
+    : m_name(name),
+      m_owner(owner),
+      m_memory(memory),
+      m_size(size),
+      m_slot_count(slot_count) {
+}
+
+
+SharedDmxRegion::~SharedDmxRegion() {
+#ifdef HAVE_SHM_OPEN
+  munmap(m_memory, m_size);
+  if (m_owner) {
+    shm_unlink(m_name.c_str());
+  }
+#endif  // HAVE_SHM_OPEN
+}
+
+
+SharedDmxRegion *SharedDmxRegion::Create(const string &name,
+                                         unsigned int slot_count) {
+#ifdef HAVE_SHM_OPEN
+  if (slot_count == 0 || slot_count > MAX_SLOTS) {
+    OLA_WARN << "Invalid slot count for " << name << ": " << slot_count;
+    return NULL;
+  }
+
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL,
+                    S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    OLA_WARN << "shm_open(" << name << ") failed: " << strerror(errno);
+    return NULL;
+  }
+
+  size_t size = RegionSize(slot_count);
+  if (ftruncate(fd, size) < 0) {
+    OLA_WARN << "ftruncate(" << name << ") failed: " << strerror(errno);
+    close(fd);
+    shm_unlink(name.c_str());
+    return NULL;
+  }
+
+  void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    OLA_WARN << "mmap(" << name << ") failed: " << strerror(errno);
+    shm_unlink(name.c_str());
+    return NULL;
+  }
+
+  // ftruncate zero fills, so all that's left is the header.
+  RegionHeader *header = reinterpret_cast<RegionHeader*>(memory);
+  header->magic = REGION_MAGIC;
+  header->version = REGION_VERSION;
+  header->slot_count = slot_count;
+  header->slot_size = sizeof(Slot);
+  return new SharedDmxRegion(name, true, reinterpret_cast<uint8_t*>(memory),
+                             size, slot_count);
+#else
+  OLA_WARN << "Shared memory isn't supported on this platform, can't create "
+           << name << " with " << slot_count << " slots";
+  return NULL;
+#endif  // HAVE_SHM_OPEN
+}
+
+
+SharedDmxRegion *SharedDmxRegion::Open(const string &name) {
+#ifdef HAVE_SHM_OPEN
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    OLA_WARN << "shm_open(" << name << ") failed: " << strerror(errno);
+    return NULL;
+  }
+
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) < 0 ||
+      static_cast<size_t>(stat_buf.st_size) < HEADER_SIZE) {
+    OLA_WARN << "Shared memory region " << name << " is too small";
+    close(fd);
+    return NULL;
+  }
+
+  size_t size = stat_buf.st_size;
+  void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    OLA_WARN << "mmap(" << name << ") failed: " << strerror(errno);
+    return NULL;
+  }
+
+  const RegionHeader *header = reinterpret_cast<RegionHeader*>(memory);
+  if (header->magic != REGION_MAGIC || header->version != REGION_VERSION ||
+      header->slot_size != sizeof(Slot) ||
+      header->slot_count == 0 || header->slot_count > MAX_SLOTS ||
+      RegionSize(header->slot_count) > size) {
+    OLA_WARN << "Shared memory region " << name << " has an invalid header";
+    munmap(memory, size);
+    return NULL;
+  }
+  return new SharedDmxRegion(name, false, reinterpret_cast<uint8_t*>(memory),
+                             size, header->slot_count);
+#else
+  OLA_WARN << "Shared memory isn't supported on this platform, can't open "
+           << name;
+  return NULL;
+#endif  // HAVE_SHM_OPEN
+}
+
+
+bool SharedDmxRegion::Write(unsigned int slot_index, uint8_t priority,
+                            const DmxBuffer &data) {
+  if (slot_index >= m_slot_count) {
+    return false;
+  }
+
+  Slot *slot = GetSlot(m_memory, slot_index);
+  uint32_t sequence = slot->sequence;
+  slot->sequence = sequence + 1;
+  __sync_synchronize();
+  unsigned int length = DMX_UNIVERSE_SIZE;
+  data.Get(slot->data, &length);
+  slot->length = static_cast<uint16_t>(length);
+  slot->priority = priority;
+  __sync_synchronize();
+  // Skip 0 on wrap around, since that's what readers start with.
+  slot->sequence = sequence + 2 ? sequence + 2 : 2;
+  return true;
+}
+
+
+bool SharedDmxRegion::Read(unsigned int slot_index, uint32_t *sequence,
+                           uint8_t *priority, DmxBuffer *data) const {
+  if (slot_index >= m_slot_count) {
+    return false;
+  }
+
+  const Slot *slot = GetSlot(m_memory, slot_index);
+  for (unsigned int attempt = 0; attempt < READ_ATTEMPTS; attempt++) {
+    uint32_t start = slot->sequence;
+    if (start == *sequence) {
+      return false;
+    }
+    if (start & 1) {
+      // The writer is mid-update.
+      continue;
+    }
+    __sync_synchronize();
+    unsigned int length = std::min(static_cast<unsigned int>(slot->length),
+                                   static_cast<unsigned int>(
+                                       DMX_UNIVERSE_SIZE));
+    uint8_t frame_priority = slot->priority;
+    data->Set(slot->data, length);
+    __sync_synchronize();
+    if (slot->sequence == start) {
+      *sequence = start;
+      *priority = frame_priority;
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace dmx
+}  // namespace ola
@@ -0,0 +1,118 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SharedDmxRegion.h
+ * DMX frames in POSIX shared memory, used to pass data between olad and
+ * clients on the same host.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef COMMON_DMX_SHAREDDMXREGION_H_
+#define COMMON_DMX_SHAREDDMXREGION_H_
+
+#include <stdint.h>
+#include <ola/DmxBuffer.h>
+#include <ola/base/Macro.h>
+#include <string>
+
+namespace ola {
+namespace dmx {
+
+/**
+ * @brief A shared memory region holding one DMX frame per slot.
+ *
+ * Each slot is protected by a seqlock: there must be at most one writer per
+ * slot, but any number of readers. Readers never block the writer; if a frame
+ * is modified while it's being read, the read is retried.
+ *
+ * The region doesn't provide any notification that a slot has changed, that's
+ * up to the caller.
+ */
+class SharedDmxRegion {
+ public:
+  ~SharedDmxRegion();
+
+  /**
+   * @brief Create a new region.
+   * @param name the name of the region, this should start with a /.
+   * @param slot_count the number of frames the region can hold.
+   * @returns a new SharedDmxRegion or NULL if the region couldn't be created.
+   *
+   * The region is removed when the returned object is deleted.
+   */
+  static SharedDmxRegion *Create(const std::string &name,
+                                 unsigned int slot_count);
+
+  /**
+   * @brief Open a region that was created with Create().
+   * @param name the name of the region.
+   * @returns a new SharedDmxRegion or NULL if the region couldn't be opened.
+   */
+  static SharedDmxRegion *Open(const std::string &name);
+
+  /**
+   * @brief The name of the region.
+   */
+  const std::string &Name() const { return m_name; }
+
+  /**
+   * @brief The number of frames this region can hold.
+   */
+  unsigned int SlotCount() const { return m_slot_count; }
+
+  /**
+   * @brief Write a frame.
+   * @param slot the slot to write to.
+   * @param priority the priority of the frame.
+   * @param data the DMX data.
+   * @returns false if the slot is out of range.
+   */
+  bool Write(unsigned int slot, uint8_t priority, const DmxBuffer &data);
+
+  /**
+   * @brief Read a frame if it has changed.
+   * @param slot the slot to read.
+   * @param[in,out] sequence the sequence number of the last frame read from
+   *   this slot, start with 0. This is updated if a new frame is read.
+   * @param[out] priority the priority of the frame.
+   * @param[out] data the DMX data.
+   * @returns true if a new frame was read, false if the slot hasn't changed,
+   *   or is being written to.
+   */
+  bool Read(unsigned int slot, uint32_t *sequence, uint8_t *priority,
+            DmxBuffer *data) const;
+
+  /**
+   * @brief The maximum number of slots in a region.
+   */
+  static const unsigned int MAX_SLOTS = 1024;
+
+ private:
+  const std::string m_name;
+  const bool m_owner;
+  uint8_t *m_memory;
+  size_t m_size;
+  unsigned int m_slot_count;
+
+  SharedDmxRegion(const std::string &name, bool owner, uint8_t *memory,
+                  size_t size, unsigned int slot_count);
+
+  static const unsigned int READ_ATTEMPTS = 4;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedDmxRegion);
+};
+}  // namespace dmx
+}  // namespace ola
+#endif  // COMMON_DMX_SHAREDDMXREGION_H_
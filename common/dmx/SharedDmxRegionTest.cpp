@@ -0,0 +1,136 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SharedDmxRegionTest.cpp
+ * Test fixture for the SharedDmxRegion class
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "common/dmx/SharedDmxRegion.h"
+#include "ola/DmxBuffer.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxBuffer;
+using ola::dmx::SharedDmxRegion;
+using std::auto_ptr;
+using std::string;
+
+class SharedDmxRegionTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(SharedDmxRegionTest);
+  CPPUNIT_TEST(testReadWrite);
+  CPPUNIT_TEST(testOpen);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    void setUp();
+    void testReadWrite();
+    void testOpen();
+
+ private:
+    string m_name;
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SharedDmxRegionTest);
+
+
+void SharedDmxRegionTest::setUp() {
+  std::ostringstream str;
+  str << "/ola-test-" << getpid();
+  m_name = str.str();
+}
+
+
+/*
+ * Check that frames can be written and read back.
+ */
+void SharedDmxRegionTest::testReadWrite() {
+  auto_ptr<SharedDmxRegion> region(SharedDmxRegion::Create(m_name, 2));
+  if (!region.get()) {
+    // No shared memory support on this platform.
+    return;
+  }
+  OLA_ASSERT_EQ(2u, region->SlotCount());
+
+  uint32_t sequence = 0;
+  uint8_t priority = 0;
+  DmxBuffer data;
+  OLA_ASSERT_FALSE(region->Read(0, &sequence, &priority, &data));
+  OLA_ASSERT_FALSE(region->Read(2, &sequence, &priority, &data));
+
+  DmxBuffer frame;
+  frame.SetFromString("1,2,3,4");
+  OLA_ASSERT_TRUE(region->Write(0, 150, frame));
+  OLA_ASSERT_FALSE(region->Write(2, 150, frame));
+
+  OLA_ASSERT_TRUE(region->Read(0, &sequence, &priority, &data));
+  OLA_ASSERT_EQ(frame, data);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(150), priority);
+  OLA_ASSERT_NE(0u, sequence);
+
+  // Nothing has changed.
+  OLA_ASSERT_FALSE(region->Read(0, &sequence, &priority, &data));
+
+  // The other slot is independent.
+  uint32_t other_sequence = 0;
+  OLA_ASSERT_FALSE(region->Read(1, &other_sequence, &priority, &data));
+
+  frame.SetFromString("5,6");
+  OLA_ASSERT_TRUE(region->Write(0, 100, frame));
+  OLA_ASSERT_TRUE(region->Read(0, &sequence, &priority, &data));
+  OLA_ASSERT_EQ(frame, data);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(100), priority);
+}
+
+
+/*
+ * Check a second mapping sees the writes from the first.
+ */
+void SharedDmxRegionTest::testOpen() {
+  OLA_ASSERT_NULL(SharedDmxRegion::Open(m_name));
+
+  auto_ptr<SharedDmxRegion> region(SharedDmxRegion::Create(m_name, 4));
+  if (!region.get()) {
+    return;
+  }
+  // The name is already in use.
+  OLA_ASSERT_NULL(SharedDmxRegion::Create(m_name, 4));
+
+  auto_ptr<SharedDmxRegion> client(SharedDmxRegion::Open(m_name));
+  OLA_ASSERT_NOT_NULL(client.get());
+  OLA_ASSERT_EQ(4u, client->SlotCount());
+
+  DmxBuffer frame;
+  frame.SetFromString("10,20,30");
+  OLA_ASSERT_TRUE(client->Write(3, 200, frame));
+
+  uint32_t sequence = 0;
+  uint8_t priority = 0;
+  DmxBuffer data;
+  OLA_ASSERT_TRUE(region->Read(3, &sequence, &priority, &data));
+  OLA_ASSERT_EQ(frame, data);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(200), priority);
+
+  // Deleting the owner removes the name.
+  region.reset();
+  OLA_ASSERT_NULL(SharedDmxRegion::Open(m_name));
+}
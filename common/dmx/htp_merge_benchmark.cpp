@@ -0,0 +1,190 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * htp_merge_benchmark.cpp
+ * Compare the HTP merge kernels, and pairwise vs N-way merging, and the
+ * per-slot priority merge kernels.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "common/dmx/HTPMerge.h"
+#include "common/dmx/PriorityMerge.h"
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+
+using ola::Clock;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::dmx::GetHTPMergeFunction;
+using ola::dmx::GetPriorityMergeFunction;
+using ola::dmx::HTPMergeFunction;
+using ola::dmx::HTPMergeImplementation;
+using ola::dmx::PriorityMergeFunction;
+using std::cout;
+using std::endl;
+using std::string;
+
+DEFINE_s_uint32(sources, s, 4, "The number of sources to merge [1 - 32]");
+DEFINE_s_uint32(iterations, i, 1000000, "The number of merges to run");
+
+static const unsigned int MAX_SOURCES = 32;
+
+/*
+ * Merge each source in turn, this is how Universe::HTPMergeSources used to
+ * work.
+ */
+void PairwiseMerge(HTPMergeFunction merge, uint8_t *output,
+                   const uint8_t *const *inputs, unsigned int input_count) {
+  memcpy(output, inputs[0], ola::DMX_UNIVERSE_SIZE);
+  for (unsigned int i = 1; i < input_count; i++) {
+    merge(output, &inputs[i], 1, ola::DMX_UNIVERSE_SIZE);
+  }
+}
+
+/*
+ * Merge all sources in one pass.
+ */
+void NWayMerge(HTPMergeFunction merge, uint8_t *output,
+               const uint8_t *const *inputs, unsigned int input_count) {
+  memset(output, 0, ola::DMX_UNIVERSE_SIZE);
+  merge(output, inputs, input_count, ola::DMX_UNIVERSE_SIZE);
+}
+
+/*
+ * Print the results of a benchmark.
+ */
+void PrintResult(const string &description, const TimeInterval &duration,
+                 unsigned int iterations, uint8_t checksum) {
+  double ns_per_merge = duration.AsInt() * 1000.0 / iterations;
+  cout << std::left << std::setw(20) << description << std::right
+       << std::setw(10) << std::fixed << std::setprecision(1) << ns_per_merge
+       << " ns/merge (checksum " << static_cast<int>(checksum) << ")" << endl;
+}
+
+/*
+ * Time a merge strategy & print the results.
+ */
+void RunBenchmark(const string &description,
+                  void (*strategy)(HTPMergeFunction, uint8_t*,
+                                   const uint8_t *const *, unsigned int),
+                  HTPMergeFunction merge,
+                  const uint8_t *const *inputs,
+                  unsigned int input_count,
+                  unsigned int iterations) {
+  Clock clock;
+  uint8_t output[ola::DMX_UNIVERSE_SIZE];
+  uint8_t checksum = 0;
+
+  TimeStamp start, end;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < iterations; i++) {
+    strategy(merge, output, inputs, input_count);
+    checksum ^= output[i % ola::DMX_UNIVERSE_SIZE];
+  }
+  clock.CurrentTime(&end);
+
+  PrintResult(description, end - start, iterations, checksum);
+}
+
+/*
+ * Time a per-slot priority merge of all sources & print the results.
+ */
+void RunPriorityBenchmark(const string &description,
+                          PriorityMergeFunction merge,
+                          const uint8_t *const *inputs,
+                          const uint8_t *const *priorities,
+                          unsigned int input_count,
+                          unsigned int iterations) {
+  Clock clock;
+  uint8_t output[ola::DMX_UNIVERSE_SIZE];
+  uint8_t output_priorities[ola::DMX_UNIVERSE_SIZE];
+  uint8_t checksum = 0;
+
+  TimeStamp start, end;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < iterations; i++) {
+    memset(output, 0, sizeof(output));
+    memset(output_priorities, 0, sizeof(output_priorities));
+    for (unsigned int j = 0; j < input_count; j++) {
+      merge(output, output_priorities, inputs[j], priorities[j],
+            ola::DMX_UNIVERSE_SIZE);
+    }
+    checksum ^= output[i % ola::DMX_UNIVERSE_SIZE];
+  }
+  clock.CurrentTime(&end);
+  PrintResult(description, end - start, iterations, checksum);
+}
+
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Benchmark the HTP merge kernels on this CPU.");
+
+  unsigned int input_count = FLAGS_sources;
+  if (input_count == 0 || input_count > MAX_SOURCES) {
+    ola::DisplayUsageAndExit();
+  }
+
+  uint8_t input_data[MAX_SOURCES][ola::DMX_UNIVERSE_SIZE];
+  uint8_t priority_data[MAX_SOURCES][ola::DMX_UNIVERSE_SIZE];
+  const uint8_t *inputs[MAX_SOURCES];
+  const uint8_t *priorities[MAX_SOURCES];
+  for (unsigned int i = 0; i < input_count; i++) {
+    for (unsigned int j = 0; j < ola::DMX_UNIVERSE_SIZE; j++) {
+      input_data[i][j] = static_cast<uint8_t>(j * (i + 1) + i);
+      priority_data[i][j] = static_cast<uint8_t>(100 + (i + j) % 3);
+    }
+    inputs[i] = input_data[i];
+    priorities[i] = priority_data[i];
+  }
+
+  cout << input_count << " sources, " << FLAGS_iterations
+       << " iterations, best kernel is "
+       << ola::dmx::HTPMergeImplementationName(
+              ola::dmx::BestHTPMergeImplementation()) << endl;
+
+  const HTPMergeImplementation implementations[] = {
+    ola::dmx::HTP_MERGE_SCALAR,
+    ola::dmx::HTP_MERGE_SSE2,
+    ola::dmx::HTP_MERGE_AVX2,
+    ola::dmx::HTP_MERGE_NEON,
+  };
+
+  for (unsigned int i = 0;
+       i < sizeof(implementations) / sizeof(implementations[0]); i++) {
+    HTPMergeFunction merge = GetHTPMergeFunction(implementations[i]);
+    if (!merge) {
+      continue;
+    }
+    string name = ola::dmx::HTPMergeImplementationName(implementations[i]);
+    RunBenchmark(name + " pairwise", PairwiseMerge, merge, inputs,
+                 input_count, FLAGS_iterations);
+    RunBenchmark(name + " n-way", NWayMerge, merge, inputs, input_count,
+                 FLAGS_iterations);
+    RunPriorityBenchmark(
+        name + " per-slot",
+        GetPriorityMergeFunction(implementations[i],
+                                 ola::dmx::PRIORITY_TIE_HTP),
+        inputs, priorities, input_count, FLAGS_iterations);
+  }
+  return 0;
+}
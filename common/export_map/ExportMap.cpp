@@ -25,6 +25,7 @@
 #include <iostream>
 #include "ola/ExportMap.h"
 #include "ola/StringUtils.h"
+#include "ola/strings/Format.h"
 #include "ola/stl/STLUtils.h"
 
 namespace ola {
@@ -94,6 +95,43 @@ UIntMap *ExportMap::GetUIntMapVar(const string &name, const string &label) {
 }
 
 
+Counter ExportMap::GetCounter(const string &name) {
+  return GetCounterVar(name)->Handle();
+}
+
+Counter ExportMap::GetCounter(const string &name, const string &key) {
+  return GetUIntMapVar(name)->GetCounter(key);
+}
+
+Gauge ExportMap::GetGauge(const string &name, const string &key) {
+  return GetUIntMapVar(name)->GetGauge(key);
+}
+
+Histogram ExportMap::GetHistogram(const string &name,
+                                  const string &key,
+                                  const unsigned int bounds[],
+                                  unsigned int bound_count) {
+  UIntMap *var = GetUIntMapVar(name);
+  vector<Counter> buckets;
+  buckets.reserve(bound_count + 1);
+  for (unsigned int i = 0; i <= bound_count; i++) {
+    buckets.push_back(
+        var->GetCounter(BucketKey(key, bounds, bound_count, i)));
+  }
+  return Histogram(bounds, bound_count, buckets);
+}
+
+void ExportMap::RemoveHistogram(const string &name,
+                                const string &key,
+                                const unsigned int bounds[],
+                                unsigned int bound_count) {
+  UIntMap *var = GetUIntMapVar(name);
+  for (unsigned int i = 0; i <= bound_count; i++) {
+    var->Remove(BucketKey(key, bounds, bound_count, i));
+  }
+}
+
+
 /*
  * Return a list of all variables.
  * @return a vector of all variables.
@@ -141,4 +179,13 @@ Type *ExportMap::GetMapVar(map<string, Type*> *var_map,
   }
   return iter->second;
 }
+
+
+string ExportMap::BucketKey(const string &key,
+                            const unsigned int bounds[],
+                            unsigned int bound_count,
+                            unsigned int bucket) {
+  return key + ":" + (bucket < bound_count ?
+      ola::strings::IntToString(bounds[bucket]) : string("inf"));
+}
 }  // namespace ola
@@ -23,16 +23,21 @@
 #include <vector>
 
 #include "ola/ExportMap.h"
+#include "ola/strings/Format.h"
 #include "ola/testing/TestUtils.h"
 
 using ola::BaseVariable;
 using ola::BoolVariable;
+using ola::Counter;
 using ola::CounterVariable;
 using ola::ExportMap;
+using ola::Gauge;
+using ola::Histogram;
 using ola::IntMap;
 using ola::IntegerVariable;
 using ola::StringMap;
 using ola::StringVariable;
+using ola::UIntMap;
 using std::string;
 using std::vector;
 
@@ -46,6 +51,8 @@ class ExportMapTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testStringMapVariable);
   CPPUNIT_TEST(testIntMapVariable);
   CPPUNIT_TEST(testExportMap);
+  CPPUNIT_TEST(testHandles);
+  CPPUNIT_TEST(testHistogram);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -56,6 +63,8 @@ class ExportMapTest: public CppUnit::TestFixture {
     void testStringMapVariable();
     void testIntMapVariable();
     void testExportMap();
+    void testHandles();
+    void testHistogram();
 };
 
 
@@ -241,3 +250,82 @@ void ExportMapTest::testExportMap() {
   vector<BaseVariable*> variables = map.AllVariables();
   OLA_ASSERT_EQ(variables.size(), (size_t) 4);
 }
+
+
+/*
+ * Check the Counter and Gauge handles work.
+ */
+void ExportMapTest::testHandles() {
+  // Handles that aren't attached to a variable do nothing.
+  Counter null_counter;
+  OLA_ASSERT_FALSE(null_counter.IsValid());
+  null_counter++;
+  OLA_ASSERT_EQ(0u, null_counter.Get());
+  Gauge null_gauge;
+  null_gauge.Set(4);
+  OLA_ASSERT_EQ(0u, null_gauge.Get());
+
+  ExportMap map;
+  Counter counter = map.GetCounter("counter");
+  OLA_ASSERT_TRUE(counter.IsValid());
+  counter++;
+  counter.Increment(2);
+  OLA_ASSERT_EQ(3u, counter.Get());
+  OLA_ASSERT_EQ(3u, map.GetCounterVar("counter")->Get());
+  OLA_ASSERT_EQ(string("3"), map.GetCounterVar("counter")->Value());
+
+  UIntMap *frames = map.GetUIntMapVar("frames", "universe");
+  Counter frames1 = map.GetCounter("frames", "1");
+  Counter frames2 = map.GetCounter("frames", "2");
+  frames1++;
+  frames1++;
+  frames2++;
+  OLA_ASSERT_EQ(2u, (*frames)["1"]);
+  OLA_ASSERT_EQ(string("map:universe 1:2 2:1"), frames->Value());
+
+  // Adding other keys doesn't invalidate the handles.
+  for (unsigned int i = 10; i < 100; i++) {
+    frames->Increment(ola::strings::IntToString(i));
+  }
+  frames1++;
+  OLA_ASSERT_EQ(3u, (*frames)["1"]);
+
+  Gauge clients = map.GetGauge("clients", "1");
+  clients.Increment();
+  clients.Increment();
+  clients.Decrement();
+  OLA_ASSERT_EQ(1u, clients.Get());
+  clients.Set(7);
+  OLA_ASSERT_EQ(7u, (*map.GetUIntMapVar("clients"))["1"]);
+}
+
+
+/*
+ * Check the Histogram handle works.
+ */
+void ExportMapTest::testHistogram() {
+  const unsigned int bounds[] = {1, 10, 100};
+
+  Histogram null_histogram;
+  OLA_ASSERT_FALSE(null_histogram.IsValid());
+  null_histogram.Observe(5);
+
+  ExportMap map;
+  map.GetUIntMapVar("latency", "port:ms");
+  Histogram histogram = map.GetHistogram("latency", "1-1", bounds, 3);
+  OLA_ASSERT_TRUE(histogram.IsValid());
+  OLA_ASSERT_EQ(string("map:port:ms 1-1:1:0 1-1:10:0 1-1:100:0 1-1:inf:0"),
+                map.GetUIntMapVar("latency")->Value());
+
+  histogram.Observe(0);
+  histogram.Observe(1);
+  histogram.Observe(2);
+  histogram.Observe(100);
+  histogram.Observe(101);
+  histogram.Observe(5000);
+  OLA_ASSERT_EQ(string("map:port:ms 1-1:1:2 1-1:10:1 1-1:100:1 1-1:inf:2"),
+                map.GetUIntMapVar("latency")->Value());
+
+  map.RemoveHistogram("latency", "1-1", bounds, 3);
+  OLA_ASSERT_EQ(string("map:port:ms"), map.GetUIntMapVar("latency")->Value());
+}
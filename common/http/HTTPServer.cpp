@@ -23,18 +23,24 @@
 #endif
 
 #include <stdio.h>
+#include <string.h>
 #include <ola/Logging.h>
+#include <ola/StringUtils.h>
+#include <ola/base/Array.h>
 #include <ola/base/Macro.h>
 #include <ola/file/Util.h>
 #include <ola/http/HTTPServer.h>
 #include <ola/io/Descriptor.h>
+#include <ola/stl/STLUtils.h>
 #include <ola/web/Json.h>
 #include <ola/web/JsonWriter.h>
+#include "common/http/HTTPUtils.h"
 
 #ifdef _WIN32
 #include <ola/win/CleanWinSock2.h>
 #endif
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <map>
@@ -68,9 +74,16 @@ using std::set;
 using std::string;
 using std::vector;
 using ola::io::UnmanagedFileDescriptor;
+using ola::thread::MutexLocker;
 using ola::web::JsonValue;
 using ola::web::JsonWriter;
 
+// MHD_USE_SUSPEND_RESUME, which streaming and the thread pool rely on, and
+// the current names of the threading flags, were added in 0.9.54.
+#if defined(MHD_VERSION) && MHD_VERSION >= 0x00095400
+#define OLA_HTTP_STREAMING 1
+#endif
+
 const char HTTPServer::CONTENT_TYPE_PLAIN[] = "text/plain";
 const char HTTPServer::CONTENT_TYPE_HTML[] = "text/html";
 const char HTTPServer::CONTENT_TYPE_GIF[] = "image/gif";
@@ -157,13 +170,13 @@ static int HandleRequest(void *http_server_ptr,
   request = static_cast<HTTPRequest*>(*ptr);
 
   if (request->InFlight())
-    // don't dispatch more than once
-    return MHD_YES;
+    // don't dispatch more than once, but queue the response if it was
+    // handled on another thread.
+    return request->QueuePendingResponse();
 
   if (request->Method() == MHD_HTTP_METHOD_GET) {
-    HTTPResponse *response = new HTTPResponse(connection);
     request->SetInFlight();
-    return http_server->DispatchRequest(request, response);
+    return http_server->StartRequest(request);
 
   } else if (request->Method() == MHD_HTTP_METHOD_POST) {
     if (*upload_data_size != 0) {
@@ -172,8 +185,7 @@ static int HandleRequest(void *http_server_ptr,
       return MHD_YES;
     }
     request->SetInFlight();
-    HTTPResponse *response = new HTTPResponse(connection);
-    return http_server->DispatchRequest(request, response);
+    return http_server->StartRequest(request);
   }
   return MHD_NO;
 }
@@ -196,6 +208,27 @@ void RequestCompleted(void*,
 }
 
 
+#ifdef OLA_HTTP_STREAMING
+/**
+ * @brief Called by libmicrohttpd to fetch the body of a streamed response.
+ * @param stream_ptr a pointer to the HTTPStream.
+ */
+static ssize_t ReadStream(void *stream_ptr, OLA_UNUSED uint64_t pos,
+                          char *buf, size_t max) {
+  return static_cast<HTTPStream*>(stream_ptr)->Read(buf, max);
+}
+
+
+/**
+ * @brief Called by libmicrohttpd once a streamed response is complete.
+ * @param stream_ptr a pointer to the HTTPStream.
+ */
+static void FreeStream(void *stream_ptr) {
+  static_cast<HTTPStream*>(stream_ptr)->Closed();
+}
+#endif
+
+
 /*
  * HTTPRequest object
  * Setup the header callback and the post processor if needed.
@@ -209,7 +242,10 @@ HTTPRequest::HTTPRequest(const string &url,
   m_version(version),
   m_connection(connection),
   m_processor(NULL),
-  m_in_flight(false) {
+  m_in_flight(false),
+  m_failed(false),
+  m_pending_status_code(MHD_HTTP_OK),
+  m_pending_response(NULL) {
 }
 
 
@@ -237,6 +273,53 @@ bool HTTPRequest::Init() {
 HTTPRequest::~HTTPRequest() {
   if (m_processor)
     MHD_destroy_post_processor(m_processor);
+  if (m_pending_response)
+    MHD_destroy_response(m_pending_response);
+}
+
+
+/**
+ * @brief Store the response for a suspended request, and resume it.
+ * @param status_code the HTTP status code.
+ * @param response the response, ownership is transferred.
+ */
+void HTTPRequest::SetPendingResponse(unsigned int status_code,
+                                     struct MHD_Response *response) {
+  m_pending_status_code = status_code;
+  m_pending_response = response;
+#ifdef OLA_HTTP_STREAMING
+  MHD_resume_connection(m_connection);
+#endif
+}
+
+
+/**
+ * @brief Resume a suspended request, closing the connection.
+ */
+void HTTPRequest::SetFailed() {
+  m_failed = true;
+#ifdef OLA_HTTP_STREAMING
+  MHD_resume_connection(m_connection);
+#endif
+}
+
+
+/**
+ * @brief Queue the response passed to SetPendingResponse(), if there is one.
+ * @return MHD_NO if the request failed, MHD_YES or the result of queuing the
+ *   response otherwise.
+ */
+int HTTPRequest::QueuePendingResponse() {
+  if (m_failed)
+    return MHD_NO;
+  if (!m_pending_response)
+    return MHD_YES;
+
+  int ret = MHD_queue_response(m_connection, m_pending_status_code,
+                               m_pending_response);
+  MHD_destroy_response(m_pending_response);
+  m_pending_response = NULL;
+  return ret;
 }
 
 
@@ -347,11 +430,11 @@ const string HTTPRequest::GetPostParameter(const string &key) const {
 
 
 /**
- * @brief Set the content-type header
+ * @brief Set the content-type header, replacing any existing one.
  * @param type the content type
- * @return true if the header was set correctly, false otherwise
  */
 void HTTPResponse::SetContentType(const string &type) {
+  m_headers.erase(MHD_HTTP_HEADER_CONTENT_TYPE);
   SetHeader(MHD_HTTP_HEADER_CONTENT_TYPE, type);
 }
 
@@ -385,14 +468,7 @@ int HTTPResponse::SendJson(const JsonValue &json) {
   struct MHD_Response *response = HTTPServer::BuildResponse(
       static_cast<void*>(const_cast<char*>(output.data())),
       output.length());
-  HeadersMultiMap::const_iterator iter;
-  for (iter = m_headers.begin(); iter != m_headers.end(); ++iter)
-    MHD_add_response_header(response,
-                            iter->first.c_str(),
-                            iter->second.c_str());
-  int ret = MHD_queue_response(m_connection, m_status_code, response);
-  MHD_destroy_response(response);
-  return ret;
+  return QueueResponse(response);
 }
 
 
@@ -401,20 +477,175 @@ int HTTPResponse::SendJson(const JsonValue &json) {
  * @return true on success, false on error
  */
 int HTTPResponse::Send() {
-  HeadersMultiMap::const_iterator iter;
   struct MHD_Response *response = HTTPServer::BuildResponse(
       static_cast<void*>(const_cast<char*>(m_data.data())),
       m_data.length());
+  return QueueResponse(response);
+}
+
+
+/**
+ * @brief Send a streaming response.
+ *
+ * This sends the status and headers, the body is provided by the stream.
+ * @return true on success, false on error
+ */
+int HTTPResponse::SendStream(HTTPStream *stream) {
+#ifdef OLA_HTTP_STREAMING
+  struct MHD_Response *response = MHD_create_response_from_callback(
+      MHD_SIZE_UNKNOWN, K_STREAM_BLOCK_SIZE, ReadStream, stream, FreeStream);
+  if (!response) {
+    return MHD_NO;
+  }
+  return QueueResponse(response);
+#else
+  (void) stream;
+  return MHD_NO;
+#endif
+}
+
+
+/**
+ * @brief Add the headers and queue a response.
+ *
+ * If the request is being handled on a different thread to libmicrohttpd,
+ * the response is passed to the request, to be queued from the libmicrohttpd
+ * thread.
+ * @param response the response, ownership is transferred.
+ */
+int HTTPResponse::QueueResponse(struct MHD_Response *response) {
+  HeadersMultiMap::const_iterator iter;
   for (iter = m_headers.begin(); iter != m_headers.end(); ++iter)
     MHD_add_response_header(response,
                             iter->first.c_str(),
                             iter->second.c_str());
+
+  if (m_request) {
+    m_request->SetPendingResponse(m_status_code, response);
+    return MHD_YES;
+  }
   int ret = MHD_queue_response(m_connection, m_status_code, response);
   MHD_destroy_response(response);
   return ret;
 }
 
 
+/*
+ * HTTPStream object
+ */
+HTTPStream::HTTPStream(HTTPServer *server, struct MHD_Connection *connection)
+    : m_server(server),
+      m_connection(connection),
+      m_offset(0),
+      m_suspended(false),
+      m_closed(false),
+      m_detached(false),
+      m_on_close(NULL) {
+}
+
+
+HTTPStream::~HTTPStream() {
+  delete m_on_close;
+}
+
+
+void HTTPStream::Send(const string &data) {
+  MutexLocker locker(&m_mutex);
+  if (m_closed) {
+    return;
+  }
+  m_buffer.append(data);
+  Resume();
+}
+
+
+void HTTPStream::Close() {
+  MutexLocker locker(&m_mutex);
+  m_closed = true;
+  Resume();
+}
+
+
+size_t HTTPStream::QueuedBytes() const {
+  MutexLocker locker(&m_mutex);
+  return m_buffer.size() - m_offset;
+}
+
+
+void HTTPStream::SetOnClose(ola::SingleUseCallback0<void> *on_close) {
+  delete m_on_close;
+  m_on_close = on_close;
+}
+
+
+/**
+ * @brief Copy queued data into libmicrohttpd's buffer.
+ *
+ * If there's nothing queued the connection is suspended until the next call
+ * to Send() or Close().
+ */
+ssize_t HTTPStream::Read(char *data, size_t size) {
+#ifdef OLA_HTTP_STREAMING
+  MutexLocker locker(&m_mutex);
+  if (m_offset == m_buffer.size()) {
+    if (m_closed) {
+      return MHD_CONTENT_READER_END_OF_STREAM;
+    }
+    MHD_suspend_connection(m_connection);
+    m_suspended = true;
+    return 0;
+  }
+
+  size = std::min(size, m_buffer.size() - m_offset);
+  memcpy(data, m_buffer.data() + m_offset, size);
+  m_offset += size;
+  if (m_offset == m_buffer.size()) {
+    m_buffer.clear();
+    m_offset = 0;
+  }
+  return size;
+#else
+  (void) data;
+  (void) size;
+  return -1;
+#endif
+}
+
+
+/**
+ * @brief Stop using the connection, and tell the server.
+ */
+void HTTPStream::Closed() {
+  {
+    MutexLocker locker(&m_mutex);
+    m_detached = true;
+  }
+  m_server->StreamClosed(this);
+}
+
+
+void HTTPStream::RunOnClose() {
+  if (m_on_close) {
+    ola::SingleUseCallback0<void> *on_close = m_on_close;
+    m_on_close = NULL;
+    on_close->Run();
+  }
+}
+
+
+/*
+ * Must be called with the lock held.
+ */
+void HTTPStream::Resume() {
+#ifdef OLA_HTTP_STREAMING
+  if (m_suspended && !m_detached) {
+    m_suspended = false;
+    MHD_resume_connection(m_connection);
+  }
+#endif
+}
+
+
 /**
  * @brief Setup the HTTP server.
  * @param options the configuration options for the server
@@ -424,7 +655,9 @@ HTTPServer::HTTPServer(const HTTPServerOptions &options)
       m_httpd(NULL),
       m_default_handler(NULL),
       m_port(options.port),
-      m_data_dir(options.data_dir) {
+      m_data_dir(options.data_dir),
+      m_thread_pool_size(options.thread_pool_size),
+      m_stopping(false) {
   ola::io::SelectServer::Options ss_options;
   // See issue #761. epoll/kqueue can't be used with the current
   // implementation.
@@ -438,10 +671,46 @@ HTTPServer::HTTPServer(const HTTPServerOptions &options)
  */
 HTTPServer::~HTTPServer() {
   Stop();
+  {
+    MutexLocker locker(&m_stopping_lock);
+    m_stopping = true;
+  }
+
+  // libmicrohttpd requires all suspended connections to be resumed before
+  // the daemon is stopped. Stopping the daemon then runs FreeStream() which
+  // deletes the streams.
+  set<HTTPStream*>::iterator stream_iter = m_streams.begin();
+  for (; stream_iter != m_streams.end(); ++stream_iter) {
+    (*stream_iter)->SetOnClose(NULL);
+    (*stream_iter)->Close();
+  }
+
+  if (m_thread_pool_size) {
+    // Requests the pool threads passed to us are still suspended, this fails
+    // them, which resumes the connections.
+    m_select_server->RunOnce(TimeInterval(0, 0));
+  }
 
   if (m_httpd)
     MHD_stop_daemon(m_httpd);
 
+  if (m_thread_pool_size) {
+    // Release the streams the pool threads closed while stopping.
+    m_select_server->RunOnce(TimeInterval(0, 0));
+  }
+
+  // In case the daemon didn't free them.
+  STLDeleteElements(&m_streams);
+
+  FileCache::iterator cache_iter = m_file_cache.begin();
+  for (; cache_iter != m_file_cache.end(); ++cache_iter) {
+    FreeVariant(&cache_iter->second->identity);
+    FreeVariant(&cache_iter->second->gzip);
+    FreeVariant(&cache_iter->second->brotli);
+    delete cache_iter->second;
+  }
+  m_file_cache.clear();
+
   map<string, BaseHTTPCallback*>::const_iterator iter;
   for (iter = m_handlers.begin(); iter != m_handlers.end(); ++iter)
     delete iter->second;
@@ -465,7 +734,42 @@ bool HTTPServer::Init() {
     return false;
   }
 
-  m_httpd = MHD_start_daemon(MHD_NO_FLAG,
+  LoadFileCache();
+
+#ifdef OLA_HTTP_STREAMING
+  if (m_thread_pool_size) {
+    unsigned int flags = (MHD_USE_SUSPEND_RESUME |
+                          MHD_USE_INTERNAL_POLLING_THREAD);
+    if (MHD_is_feature_supported(MHD_FEATURE_EPOLL) == MHD_YES) {
+      flags |= MHD_USE_EPOLL;
+    }
+    m_httpd = MHD_start_daemon(flags,
+                               m_port,
+                               NULL,
+                               NULL,
+                               &HandleRequest,
+                               this,
+                               MHD_OPTION_NOTIFY_COMPLETED,
+                               RequestCompleted,
+                               NULL,
+                               MHD_OPTION_THREAD_POOL_SIZE,
+                               m_thread_pool_size,
+                               MHD_OPTION_END);
+    if (m_httpd) {
+      OLA_INFO << "HTTP server using " << m_thread_pool_size << " threads";
+    }
+    return m_httpd ? true : false;
+  }
+  const unsigned int flags = MHD_USE_SUSPEND_RESUME;
+#else
+  if (m_thread_pool_size) {
+    OLA_WARN << "This version of libmicrohttpd doesn't support suspending "
+             << "connections, not using a thread pool";
+    m_thread_pool_size = 0;
+  }
+  const unsigned int flags = MHD_NO_FLAG;
+#endif
+  m_httpd = MHD_start_daemon(flags,
                              m_port,
                              NULL,
                              NULL,
@@ -609,6 +913,40 @@ void HTTPServer::UpdateSockets() {
 }
 
 
+/**
+ * @brief Handle a new request.
+ *
+ * This is called by libmicrohttpd, either from the HTTP server thread or, if
+ * there's a thread pool, from one of the pool threads.
+ */
+int HTTPServer::StartRequest(HTTPRequest *request) {
+  if (!m_thread_pool_size) {
+    return DispatchRequest(request, new HTTPResponse(request->Connection()));
+  }
+
+#ifdef OLA_HTTP_STREAMING
+  // The file cache is read-only once the daemon has started, so files can be
+  // served from this thread. Everything else is passed to the HTTP server
+  // thread, and the connection suspended until the response is ready.
+  const CachedFile *file = STLFindOrNull(m_file_cache, request->Url());
+  if (file) {
+    return ServeCachedFile(request, file);
+  }
+
+  MutexLocker locker(&m_stopping_lock);
+  if (m_stopping) {
+    return MHD_NO;
+  }
+  MHD_suspend_connection(request->Connection());
+  m_select_server->Execute(
+      NewSingleCallback(this, &HTTPServer::DispatchDeferred, request));
+  return MHD_YES;
+#else
+  return MHD_NO;
+#endif
+}
+
+
 /**
  * @brief Call the appropriate handler.
  */
@@ -620,6 +958,12 @@ int HTTPServer::DispatchRequest(const HTTPRequest *request,
   if (iter != m_handlers.end())
     return iter->second->Run(request, response);
 
+  const CachedFile *file = STLFindOrNull(m_file_cache, request->Url());
+  if (file) {
+    delete response;
+    return ServeCachedFile(request, file);
+  }
+
   map<string, static_file_info>::iterator file_iter =
     m_static_content.find(request->Url());
 
@@ -782,43 +1126,261 @@ int HTTPServer::ServeStaticContent(const std::string &path,
  */
 int HTTPServer::ServeStaticContent(static_file_info *file_info,
                                    HTTPResponse *response) {
-  char *data;
-  unsigned int length;
+  string data;
+  if (!ReadFile(file_info->file_path, &data)) {
+    OLA_WARN << "Missing file: " << m_data_dir << ola::file::PATH_SEPARATOR
+             << file_info->file_path;
+    return ServeNotFound(response);
+  }
+
+  if (!file_info->content_type.empty())
+    response->SetContentType(file_info->content_type);
+  response->Append(data);
+  int ret = response->Send();
+  delete response;
+  return ret;
+}
+
+/**
+ * @brief Start a streaming response.
+ */
+HTTPStream *HTTPServer::StartStream(HTTPResponse *response) {
+#ifdef OLA_HTTP_STREAMING
+  HTTPStream *stream = new HTTPStream(this, response->Connection());
+  m_streams.insert(stream);
+  if (response->SendStream(stream) != MHD_YES) {
+    // If the response was created, destroying it has already freed the
+    // stream.
+    if (STLRemove(&m_streams, stream)) {
+      delete stream;
+    }
+    return NULL;
+  }
+  return stream;
+#else
+  (void) response;
+  return NULL;
+#endif
+}
+
+
+/**
+ * @brief Called when a stream's connection has closed.
+ */
+void HTTPServer::StreamClosed(HTTPStream *stream) {
+  if (m_thread_pool_size) {
+    // We're on one of the libmicrohttpd threads.
+    m_select_server->Execute(
+        NewSingleCallback(this, &HTTPServer::ReleaseStream, stream));
+  } else {
+    ReleaseStream(stream);
+  }
+}
+
+
+/**
+ * @brief Run a request that was started on a libmicrohttpd thread.
+ */
+void HTTPServer::DispatchDeferred(HTTPRequest *request) {
+  if (m_stopping) {
+    // The connection is suspended, so the request is still valid.
+    request->SetFailed();
+    return;
+  }
+
+  HTTPResponse *response = new HTTPResponse(request->Connection(), request);
+  if (DispatchRequest(request, response) != MHD_YES) {
+    request->SetFailed();
+  }
+}
+
+
+void HTTPServer::ReleaseStream(HTTPStream *stream) {
+  stream->RunOnClose();
+  m_streams.erase(stream);
+  delete stream;
+}
+
+
+/**
+ * @brief Read a file from the data directory.
+ * @param file the path to the file, relative to the data directory.
+ * @param data the string to store the contents in.
+ * @returns true if the file was read, false otherwise.
+ */
+bool HTTPServer::ReadFile(const string &file, string *data) const {
   string file_path = m_data_dir;
   file_path.push_back(ola::file::PATH_SEPARATOR);
-  file_path.append(file_info->file_path);
+  file_path.append(file);
   ifstream i_stream(file_path.c_str(), ifstream::binary);
 
   if (!i_stream.is_open()) {
-    OLA_WARN << "Missing file: " << file_path;
-    return ServeNotFound(response);
+    return false;
   }
 
   i_stream.seekg(0, std::ios::end);
-  length = i_stream.tellg();
+  std::streamoff length = i_stream.tellg();
   i_stream.seekg(0, std::ios::beg);
+  if (length < 0) {
+    return false;
+  }
+
+  data->resize(length);
+  if (length) {
+    i_stream.read(&(*data)[0], length);
+  }
+  return i_stream.good();
+}
 
-  data = static_cast<char*>(malloc(length));
 
-  i_stream.read(data, length);
-  i_stream.close();
+/**
+ * @brief Load the registered files into memory.
+ *
+ * Each file gets a set of responses which are reused for every request. If
+ * the data directory contains foo.js.gz or foo.js.br alongside foo.js, they're
+ * sent to clients that accept that encoding.
+ */
+void HTTPServer::LoadFileCache() {
+  uint64_t total_size = 0;
+  map<string, static_file_info>::const_iterator iter =
+      m_static_content.begin();
+  for (; iter != m_static_content.end(); ++iter) {
+    // Handlers take priority over files.
+    if (STLContains(m_handlers, iter->first) ||
+        STLContains(m_file_cache, iter->first)) {
+      continue;
+    }
 
-  struct MHD_Response *mhd_response = BuildResponse(static_cast<void*>(data),
-                                                    length);
+    const string &file = iter->second.file_path;
+    string data;
+    if (!ReadFile(file, &data)) {
+      // This is served from disk, and will warn if it's still missing.
+      continue;
+    }
 
-  if (!file_info->content_type.empty())
-    MHD_add_response_header(mhd_response,
-                            MHD_HTTP_HEADER_CONTENT_TYPE,
-                            file_info->content_type.c_str());
-
-  int ret = MHD_queue_response(response->Connection(),
-                               MHD_HTTP_OK,
-                               mhd_response);
-  MHD_destroy_response(mhd_response);
-  delete response;
-  return ret;
+    string brotli_data, gzip_data;
+    if (!ReadFile(file + ".br", &brotli_data) ||
+        brotli_data.size() >= data.size()) {
+      brotli_data.clear();
+    }
+    if (!ReadFile(file + ".gz", &gzip_data) ||
+        gzip_data.size() >= data.size()) {
+      gzip_data.clear();
+    }
+    const bool vary = !(brotli_data.empty() && gzip_data.empty());
+
+    const string etag = ContentHash(data);
+    const string &content_type = iter->second.content_type;
+    CachedFile *cached_file = new CachedFile();
+    bool ok = LoadVariant(data, content_type, "\"" + etag + "\"", "",
+                          vary, &cached_file->identity);
+    if (ok && !brotli_data.empty()) {
+      ok = LoadVariant(brotli_data, content_type, "\"" + etag + "-br\"",
+                       "br", vary, &cached_file->brotli);
+    }
+    if (ok && !gzip_data.empty()) {
+      ok = LoadVariant(gzip_data, content_type, "\"" + etag + "-gzip\"",
+                       "gzip", vary, &cached_file->gzip);
+    }
+
+    if (!ok) {
+      FreeVariant(&cached_file->identity);
+      FreeVariant(&cached_file->brotli);
+      FreeVariant(&cached_file->gzip);
+      delete cached_file;
+      continue;
+    }
+    m_file_cache[iter->first] = cached_file;
+    total_size += data.size() + brotli_data.size() + gzip_data.size();
+  }
+  OLA_INFO << "Cached " << m_file_cache.size() << " files, " << total_size
+           << " bytes";
 }
 
+
+/**
+ * @brief Build the responses for one encoding of a file.
+ */
+bool HTTPServer::LoadVariant(const string &data,
+                             const string &content_type,
+                             const string &etag,
+                             const string &encoding,
+                             bool vary,
+                             CachedVariant *variant) {
+  variant->etag = etag;
+  variant->response = BuildResponse(
+      static_cast<void*>(const_cast<char*>(data.data())), data.size());
+  variant->not_modified = BuildResponse(NULL, 0);
+  if (!(variant->response && variant->not_modified)) {
+    return false;
+  }
+
+  if (!content_type.empty()) {
+    MHD_add_response_header(variant->response, MHD_HTTP_HEADER_CONTENT_TYPE,
+                            content_type.c_str());
+  }
+  if (!encoding.empty()) {
+    MHD_add_response_header(variant->response,
+                            MHD_HTTP_HEADER_CONTENT_ENCODING,
+                            encoding.c_str());
+  }
+
+  struct MHD_Response *responses[] = {variant->response,
+                                      variant->not_modified};
+  for (unsigned int i = 0; i < arraysize(responses); i++) {
+    MHD_add_response_header(responses[i], MHD_HTTP_HEADER_ETAG, etag.c_str());
+    if (vary) {
+      MHD_add_response_header(responses[i], MHD_HTTP_HEADER_VARY,
+                              MHD_HTTP_HEADER_ACCEPT_ENCODING);
+    }
+  }
+  return true;
+}
+
+
+void HTTPServer::FreeVariant(CachedVariant *variant) {
+  if (variant->response) {
+    MHD_destroy_response(variant->response);
+    variant->response = NULL;
+  }
+  if (variant->not_modified) {
+    MHD_destroy_response(variant->not_modified);
+    variant->not_modified = NULL;
+  }
+}
+
+
+/**
+ * @brief Serve a file from the cache.
+ *
+ * This may be called from one of the libmicrohttpd threads.
+ */
+int HTTPServer::ServeCachedFile(const HTTPRequest *request,
+                                const CachedFile *file) {
+  struct MHD_Connection *connection = request->Connection();
+  const CachedVariant *variant = &file->identity;
+
+  const char *accept_encoding = MHD_lookup_connection_value(
+      connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_ACCEPT_ENCODING);
+  if (accept_encoding) {
+    if (file->brotli.response && AcceptsEncoding(accept_encoding, "br")) {
+      variant = &file->brotli;
+    } else if (file->gzip.response &&
+               AcceptsEncoding(accept_encoding, "gzip")) {
+      variant = &file->gzip;
+    }
+  }
+
+  const char *if_none_match = MHD_lookup_connection_value(
+      connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_IF_NONE_MATCH);
+  if (if_none_match && ETagMatches(if_none_match, variant->etag)) {
+    return MHD_queue_response(connection, MHD_HTTP_NOT_MODIFIED,
+                              variant->not_modified);
+  }
+  return MHD_queue_response(connection, MHD_HTTP_OK, variant->response);
+}
+
+
 void HTTPServer::InsertSocket(bool is_readable, bool is_writeable, int fd) {
 #ifdef _WIN32
   UnmanagedSocketDescriptor *socket = new UnmanagedSocketDescriptor(fd);
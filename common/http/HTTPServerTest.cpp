@@ -0,0 +1,553 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * HTTPServerTest.cpp
+ * Test fixture for the HTTPServer, with and without a thread pool.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <arpa/inet.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/base/Macro.h"
+#include "ola/http/HTTPServer.h"
+#include "ola/testing/TestUtils.h"
+#include "ola/thread/Mutex.h"
+#include "ola/thread/Thread.h"
+
+using ola::NewCallback;
+using ola::NewSingleCallback;
+using ola::http::HTTPRequest;
+using ola::http::HTTPResponse;
+using ola::http::HTTPServer;
+using ola::http::HTTPStream;
+using ola::thread::MutexLocker;
+using ola::thread::Thread;
+using ola::thread::ThreadId;
+using std::auto_ptr;
+using std::string;
+using std::vector;
+
+class HTTPServerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(HTTPServerTest);
+  CPPUNIT_TEST(testHandler);
+  CPPUNIT_TEST(testHandlerWithThreadPool);
+  CPPUNIT_TEST(testConcurrentHandlers);
+  CPPUNIT_TEST(testConcurrentClients);
+  CPPUNIT_TEST(testDestroyWithSuspendedRequests);
+  CPPUNIT_TEST(testCachedFile);
+  CPPUNIT_TEST(testCachedFileWithThreadPool);
+  CPPUNIT_TEST(testStream);
+  CPPUNIT_TEST(testStreamWithThreadPool);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  HTTPServerTest() : m_port(0), m_stream(NULL) {}
+
+  void setUp();
+  void tearDown();
+
+  void testHandler();
+  void testHandlerWithThreadPool();
+  void testConcurrentHandlers();
+  void testConcurrentClients();
+  void testDestroyWithSuspendedRequests();
+  void testCachedFile();
+  void testCachedFileWithThreadPool();
+  void testStream();
+  void testStreamWithThreadPool();
+
+  int HandleRequest(const HTTPRequest *request, HTTPResponse *response);
+  int HandleStream(const HTTPRequest *request, HTTPResponse *response);
+  string Get(const string &path, const string &headers = "");
+
+ private:
+  uint16_t m_port;
+  auto_ptr<HTTPServer> m_server;
+  ola::thread::Mutex m_mutex;
+  vector<ThreadId> m_handler_threads;
+  HTTPStream *m_stream;
+
+  void StartServer(unsigned int thread_pool_size);
+  void CheckHandler();
+  void CheckCachedFile();
+  void CheckStream();
+  void FinishStream();
+  int Connect();
+  string ReadResponse(int fd);
+  static string StatusLine(const string &response);
+  static string Header(const string &response, const string &name);
+  static string Body(const string &response);
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(HTTPServerTest);
+
+
+/*
+ * Makes requests from another thread, recording any that fail.
+ */
+class ClientThread : public Thread {
+ public:
+  ClientThread(HTTPServerTest *test, unsigned int id, unsigned int requests)
+      : Thread(Thread::Options("client")),
+        m_test(test),
+        m_id(id),
+        m_requests(requests),
+        m_failures(0) {
+  }
+
+  unsigned int Failures() const { return m_failures; }
+
+ protected:
+  void *Run() {
+    for (unsigned int i = 0; i < m_requests; i++) {
+      std::ostringstream name;
+      name << m_id << "-" << i;
+      try {
+        const string response = m_test->Get("/handler?name=" + name.str());
+        if (response.find("\r\n\r\nhello " + name.str()) == string::npos) {
+          m_failures++;
+        }
+        if (m_test->Get("/HTTPUtils.h").find(" 200 ") == string::npos) {
+          m_failures++;
+        }
+      } catch (...) {
+        m_failures++;
+      }
+    }
+    return NULL;
+  }
+
+ private:
+  HTTPServerTest *m_test;
+  const unsigned int m_id;
+  const unsigned int m_requests;
+  unsigned int m_failures;
+};
+
+
+
+void HTTPServerTest::setUp() {
+  ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+
+  // Find a free port.
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  OLA_ASSERT_TRUE(fd >= 0);
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  OLA_ASSERT_EQ(0, bind(fd, reinterpret_cast<struct sockaddr*>(&address),
+                        sizeof(address)));
+  socklen_t length = sizeof(address);
+  OLA_ASSERT_EQ(0, getsockname(
+      fd, reinterpret_cast<struct sockaddr*>(&address), &length));
+  m_port = ntohs(address.sin_port);
+  close(fd);
+}
+
+
+void HTTPServerTest::tearDown() {
+  m_server.reset();
+}
+
+
+int HTTPServerTest::HandleRequest(const HTTPRequest *request,
+                                  HTTPResponse *response) {
+  {
+    MutexLocker locker(&m_mutex);
+    m_handler_threads.push_back(Thread::Self());
+  }
+  response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
+  response->Append("hello " + request->GetParameter("name"));
+  int r = response->Send();
+  delete response;
+  return r;
+}
+
+
+int HTTPServerTest::HandleStream(OLA_UNUSED const HTTPRequest *request,
+                                 HTTPResponse *response) {
+  response->SetContentType("text/event-stream");
+  HTTPStream *stream = m_server->StartStream(response);
+  delete response;
+  if (!stream) {
+    return MHD_NO;
+  }
+  stream->Send("one\n");
+  MutexLocker locker(&m_mutex);
+  m_stream = stream;
+  return MHD_YES;
+}
+
+
+/*
+ * Check handlers run on the HTTP server thread, without a thread pool.
+ */
+void HTTPServerTest::testHandler() {
+  StartServer(0);
+  CheckHandler();
+}
+
+
+/*
+ * Check that with a thread pool, the requests are passed to the HTTP server
+ * thread and the connection is resumed once the response is ready.
+ */
+void HTTPServerTest::testHandlerWithThreadPool() {
+  StartServer(2);
+  CheckHandler();
+}
+
+
+/*
+ * Check several requests can be suspended at once.
+ */
+void HTTPServerTest::testConcurrentHandlers() {
+  StartServer(2);
+  const unsigned int CLIENTS = 4;
+
+  vector<int> fds;
+  for (unsigned int i = 0; i < CLIENTS; i++) {
+    int fd = Connect();
+    std::ostringstream request;
+    request << "GET /handler?name=" << i << " HTTP/1.0\r\n\r\n";
+    const string data = request.str();
+    OLA_ASSERT_EQ(static_cast<ssize_t>(data.size()),
+                  send(fd, data.c_str(), data.size(), 0));
+    fds.push_back(fd);
+  }
+
+  for (unsigned int i = 0; i < CLIENTS; i++) {
+    const string response = ReadResponse(fds[i]);
+    close(fds[i]);
+    std::ostringstream expected;
+    expected << "hello " << i;
+    OLA_ASSERT_EQ(string("200"), StatusLine(response));
+    OLA_ASSERT_EQ(expected.str(), Body(response));
+  }
+
+  MutexLocker locker(&m_mutex);
+  OLA_ASSERT_EQ(static_cast<size_t>(CLIENTS), m_handler_threads.size());
+  for (unsigned int i = 0; i < CLIENTS; i++) {
+    OLA_ASSERT_TRUE(pthread_equal(m_server->Id(), m_handler_threads[i]));
+  }
+}
+
+
+/*
+ * Check handlers and cached files from several client threads at once.
+ */
+void HTTPServerTest::testConcurrentClients() {
+  StartServer(4);
+  const unsigned int CLIENTS = 8;
+  const unsigned int REQUESTS = 25;
+
+  vector<ClientThread*> clients;
+  for (unsigned int i = 0; i < CLIENTS; i++) {
+    clients.push_back(new ClientThread(this, i, REQUESTS));
+    OLA_ASSERT_TRUE(clients.back()->Start());
+  }
+
+  unsigned int failures = 0;
+  for (unsigned int i = 0; i < CLIENTS; i++) {
+    clients[i]->Join();
+    failures += clients[i]->Failures();
+    delete clients[i];
+  }
+  OLA_ASSERT_EQ(0u, failures);
+
+  MutexLocker locker(&m_mutex);
+  OLA_ASSERT_EQ(static_cast<size_t>(CLIENTS * REQUESTS),
+                m_handler_threads.size());
+}
+
+
+/*
+ * Check requests the thread pool has suspended, but the HTTP server thread
+ * hasn't run, are closed when the server is destroyed.
+ */
+void HTTPServerTest::testDestroyWithSuspendedRequests() {
+  HTTPServer::HTTPServerOptions options;
+  options.port = m_port;
+  options.data_dir = TEST_SRC_DIR "/common/http";
+  options.thread_pool_size = 1;
+  m_server.reset(new HTTPServer(options));
+  OLA_ASSERT_TRUE(m_server->RegisterHandler(
+      "/handler", NewCallback(this, &HTTPServerTest::HandleRequest)));
+  OLA_ASSERT_TRUE(m_server->RegisterFile("/HTTPUtils.h",
+                                         HTTPServer::CONTENT_TYPE_PLAIN));
+  OLA_ASSERT_TRUE(m_server->Init());
+  // Don't start the HTTP server thread, so the requests stay suspended.
+
+  const unsigned int CLIENTS = 3;
+  vector<int> fds;
+  for (unsigned int i = 0; i < CLIENTS; i++) {
+    int fd = Connect();
+    const string request = "GET /handler?name=world HTTP/1.0\r\n\r\n";
+    OLA_ASSERT_EQ(static_cast<ssize_t>(request.size()),
+                  send(fd, request.c_str(), request.size(), 0));
+    fds.push_back(fd);
+  }
+  // Files are still served by the pool, which means it's seen the requests.
+  OLA_ASSERT_EQ(string("200"), StatusLine(Get("/HTTPUtils.h")));
+
+  m_server.reset();
+  for (unsigned int i = 0; i < CLIENTS; i++) {
+    OLA_ASSERT_EQ(string(""), ReadResponse(fds[i]));
+    close(fds[i]);
+  }
+
+  MutexLocker locker(&m_mutex);
+  OLA_ASSERT_TRUE(m_handler_threads.empty());
+}
+
+
+/*
+ * Check a stream is sent as it's written to, without a thread pool.
+ */
+void HTTPServerTest::testStream() {
+  StartServer(0);
+  CheckStream();
+}
+
+
+/*
+ * Check a stream is sent as it's written to, with a thread pool.
+ */
+void HTTPServerTest::testStreamWithThreadPool() {
+  StartServer(2);
+  CheckStream();
+}
+
+
+/*
+ * Check registered files are served from memory, with an ETag.
+ */
+void HTTPServerTest::testCachedFile() {
+  StartServer(0);
+  CheckCachedFile();
+}
+
+
+/*
+ * Check registered files are served by the thread pool.
+ */
+void HTTPServerTest::testCachedFileWithThreadPool() {
+  StartServer(2);
+  CheckCachedFile();
+}
+
+
+void HTTPServerTest::StartServer(unsigned int thread_pool_size) {
+  HTTPServer::HTTPServerOptions options;
+  options.port = m_port;
+  options.data_dir = TEST_SRC_DIR "/common/http";
+  options.thread_pool_size = thread_pool_size;
+  m_server.reset(new HTTPServer(options));
+  OLA_ASSERT_TRUE(m_server->RegisterHandler(
+      "/handler", NewCallback(this, &HTTPServerTest::HandleRequest)));
+  OLA_ASSERT_TRUE(m_server->RegisterHandler(
+      "/stream", NewCallback(this, &HTTPServerTest::HandleStream)));
+  OLA_ASSERT_TRUE(m_server->RegisterFile("/HTTPUtils.h",
+                                         HTTPServer::CONTENT_TYPE_PLAIN));
+  OLA_ASSERT_TRUE(m_server->Init());
+  OLA_ASSERT_TRUE(m_server->Start());
+}
+
+
+void HTTPServerTest::CheckHandler() {
+  for (unsigned int i = 0; i < 3; i++) {
+    const string response = Get("/handler?name=world");
+    OLA_ASSERT_EQ(string("200"), StatusLine(response));
+    OLA_ASSERT_EQ(string("text/plain"), Header(response, "Content-Type"));
+    OLA_ASSERT_EQ(string("hello world"), Body(response));
+  }
+
+  OLA_ASSERT_EQ(string("404"), StatusLine(Get("/missing")));
+
+  MutexLocker locker(&m_mutex);
+  OLA_ASSERT_EQ(static_cast<size_t>(3), m_handler_threads.size());
+  vector<ThreadId>::const_iterator iter = m_handler_threads.begin();
+  for (; iter != m_handler_threads.end(); ++iter) {
+    OLA_ASSERT_TRUE(pthread_equal(m_server->Id(), *iter));
+  }
+}
+
+
+void HTTPServerTest::CheckCachedFile() {
+  const string response = Get("/HTTPUtils.h");
+  OLA_ASSERT_EQ(string("200"), StatusLine(response));
+  OLA_ASSERT_EQ(string("text/plain"), Header(response, "Content-Type"));
+  OLA_ASSERT_NE(string::npos, Body(response).find("COMMON_HTTP_HTTPUTILS_H_"));
+
+  const string etag = Header(response, "ETag");
+  OLA_ASSERT_EQ(static_cast<size_t>(18), etag.size());
+
+  // The client already has it.
+  string cached = Get("/HTTPUtils.h", "If-None-Match: " + etag + "\r\n");
+  OLA_ASSERT_EQ(string("304"), StatusLine(cached));
+  OLA_ASSERT_EQ(string(""), Body(cached));
+
+  cached = Get("/HTTPUtils.h", "If-None-Match: \"0000000000000000\"\r\n");
+  OLA_ASSERT_EQ(string("200"), StatusLine(cached));
+
+  // There's no .gz version, so the identity encoding is used.
+  cached = Get("/HTTPUtils.h", "Accept-Encoding: gzip, br\r\n");
+  OLA_ASSERT_EQ(string("200"), StatusLine(cached));
+  OLA_ASSERT_EQ(string(""), Header(cached, "Content-Encoding"));
+  OLA_ASSERT_EQ(Body(response), Body(cached));
+
+  // Files don't go through the handlers.
+  MutexLocker locker(&m_mutex);
+  OLA_ASSERT_TRUE(m_handler_threads.empty());
+}
+
+
+/*
+ * The first part of the stream is sent straight away, the connection is then
+ * suspended until the rest is written.
+ */
+void HTTPServerTest::CheckStream() {
+  int fd = Connect();
+  const string request = "GET /stream HTTP/1.0\r\n\r\n";
+  OLA_ASSERT_EQ(static_cast<ssize_t>(request.size()),
+                send(fd, request.c_str(), request.size(), 0));
+
+  string response;
+  char buffer[1024];
+  while (response.find("\r\n\r\none\n") == string::npos) {
+    ssize_t r = recv(fd, buffer, sizeof(buffer), 0);
+    OLA_ASSERT_TRUE(r > 0);
+    response.append(buffer, r);
+  }
+
+  m_server->SelectServer()->Execute(
+      NewSingleCallback(this, &HTTPServerTest::FinishStream));
+  response.append(ReadResponse(fd));
+  close(fd);
+
+  OLA_ASSERT_EQ(string("200"), StatusLine(response));
+  OLA_ASSERT_EQ(string("text/event-stream"),
+                Header(response, "Content-Type"));
+  OLA_ASSERT_EQ(string("one\ntwo\n"), Body(response));
+}
+
+
+/*
+ * Run on the HTTP server thread.
+ */
+void HTTPServerTest::FinishStream() {
+  MutexLocker locker(&m_mutex);
+  m_stream->Send("two\n");
+  m_stream->Close();
+  m_stream = NULL;
+}
+
+
+int HTTPServerTest::Connect() {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  OLA_ASSERT_TRUE(fd >= 0);
+
+  // Don't hang the test if the server never replies.
+  struct timeval timeout;
+  timeout.tv_sec = 5;
+  timeout.tv_usec = 0;
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(m_port);
+  OLA_ASSERT_EQ(0, connect(fd, reinterpret_cast<struct sockaddr*>(&address),
+                           sizeof(address)));
+  return fd;
+}
+
+
+/*
+ * Make a HTTP/1.0 request, so the server closes the connection once it's
+ * sent the response.
+ */
+string HTTPServerTest::Get(const string &path, const string &headers) {
+  int fd = Connect();
+  const string request = "GET " + path + " HTTP/1.0\r\n" + headers + "\r\n";
+  OLA_ASSERT_EQ(static_cast<ssize_t>(request.size()),
+                send(fd, request.c_str(), request.size(), 0));
+  const string response = ReadResponse(fd);
+  close(fd);
+  return response;
+}
+
+
+string HTTPServerTest::ReadResponse(int fd) {
+  string response;
+  char buffer[1024];
+  ssize_t r;
+  while ((r = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+    response.append(buffer, r);
+  }
+  OLA_ASSERT_EQ(static_cast<ssize_t>(0), r);
+  return response;
+}
+
+
+/*
+ * Return the status code from a response.
+ */
+string HTTPServerTest::StatusLine(const string &response) {
+  const string::size_type start = response.find(' ');
+  if (start == string::npos) {
+    return "";
+  }
+  return response.substr(start + 1, 3);
+}
+
+
+/*
+ * Return the value of a header, or the empty string if it isn't present.
+ */
+string HTTPServerTest::Header(const string &response, const string &name) {
+  const string headers = response.substr(0, response.find("\r\n\r\n"));
+  const string key = "\r\n" + name + ": ";
+  const string::size_type start = headers.find(key);
+  if (start == string::npos) {
+    return "";
+  }
+  const string::size_type end = headers.find("\r\n", start + key.size());
+  return headers.substr(start + key.size(),
+                        end == string::npos ? string::npos :
+                                              end - start - key.size());
+}
+
+
+string HTTPServerTest::Body(const string &response) {
+  const string::size_type start = response.find("\r\n\r\n");
+  return start == string::npos ? "" : response.substr(start + 4);
+}
@@ -0,0 +1,98 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * HTTPUtils.cpp
+ * Helpers for the HTTP caching & content negotiation headers.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common/http/HTTPUtils.h"
+#include "ola/StringUtils.h"
+
+namespace ola {
+namespace http {
+
+using std::string;
+using std::vector;
+
+string ContentHash(const string &data) {
+  // FNV-1a
+  uint64_t hash = 14695981039346656037ULL;
+  for (string::const_iterator iter = data.begin(); iter != data.end();
+       ++iter) {
+    hash ^= static_cast<uint8_t>(*iter);
+    hash *= 1099511628211ULL;
+  }
+  std::ostringstream str;
+  str << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return str.str();
+}
+
+
+bool AcceptsEncoding(const string &header, const string &encoding) {
+  vector<string> codings;
+  StringSplit(header, &codings, ",");
+  vector<string>::iterator iter = codings.begin();
+  for (; iter != codings.end(); ++iter) {
+    string coding = *iter;
+    string parameters;
+    const string::size_type separator = coding.find(';');
+    if (separator != string::npos) {
+      parameters = coding.substr(separator + 1);
+      coding.erase(separator);
+    }
+    StringTrim(&coding);
+    ToLower(&coding);
+    if (coding != encoding) {
+      continue;
+    }
+
+    // A q value of 0 means not acceptable.
+    StringTrim(&parameters);
+    if (parameters.compare(0, 2, "q=") == 0 &&
+        strtod(parameters.c_str() + 2, NULL) == 0) {
+      return false;
+    }
+    return true;
+  }
+  return false;
+}
+
+
+bool ETagMatches(const string &header, const string &etag) {
+  vector<string> tags;
+  StringSplit(header, &tags, ",");
+  vector<string>::iterator iter = tags.begin();
+  for (; iter != tags.end(); ++iter) {
+    string tag = *iter;
+    StringTrim(&tag);
+    if (tag.compare(0, 2, "W/") == 0) {
+      tag.erase(0, 2);
+    }
+    if (tag == "*" || tag == etag) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace http
+}  // namespace ola
@@ -0,0 +1,53 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * HTTPUtils.h
+ * Helpers for the HTTP caching & content negotiation headers.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef COMMON_HTTP_HTTPUTILS_H_
+#define COMMON_HTTP_HTTPUTILS_H_
+
+#include <string>
+
+namespace ola {
+namespace http {
+
+/**
+ * @brief Return a hash of some data, for use in an ETag.
+ * @param data the data to hash.
+ * @returns the 64 bit FNV-1a hash, as 16 hex digits.
+ */
+std::string ContentHash(const std::string &data);
+
+/**
+ * @brief Check if an Accept-Encoding header allows an encoding.
+ * @param header the value of the Accept-Encoding header.
+ * @param encoding the encoding to check for, in lower case.
+ * @returns true if the encoding is listed without a q value of 0.
+ */
+bool AcceptsEncoding(const std::string &header, const std::string &encoding);
+
+/**
+ * @brief Check if an If-None-Match header matches an ETag.
+ * @param header the value of the If-None-Match header.
+ * @param etag the quoted ETag of the content.
+ * @returns true if the header lists the ETag, or is *.
+ */
+bool ETagMatches(const std::string &header, const std::string &etag);
+}  // namespace http
+}  // namespace ola
+#endif  // COMMON_HTTP_HTTPUTILS_H_
@@ -0,0 +1,109 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * HTTPUtilsTest.cpp
+ * Test fixture for the HTTP header helpers.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+#include "common/http/HTTPUtils.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::http::AcceptsEncoding;
+using ola::http::ContentHash;
+using ola::http::ETagMatches;
+using std::string;
+
+class HTTPUtilsTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(HTTPUtilsTest);
+  CPPUNIT_TEST(testContentHash);
+  CPPUNIT_TEST(testAcceptsEncoding);
+  CPPUNIT_TEST(testETagMatches);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testContentHash();
+  void testAcceptsEncoding();
+  void testETagMatches();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(HTTPUtilsTest);
+
+
+/*
+ * Check the hash matches the FNV-1a test vectors.
+ */
+void HTTPUtilsTest::testContentHash() {
+  OLA_ASSERT_EQ(string("cbf29ce484222325"), ContentHash(""));
+  OLA_ASSERT_EQ(string("af63dc4c8601ec8c"), ContentHash("a"));
+  OLA_ASSERT_EQ(string("85944171f73967e8"), ContentHash("foobar"));
+
+  // Binary data is hashed byte by byte.
+  const string binary("\x00\xff", 2);
+  OLA_ASSERT_EQ(static_cast<size_t>(16), ContentHash(binary).size());
+  OLA_ASSERT_NE(ContentHash(binary), ContentHash(string("\xff\x00", 2)));
+}
+
+
+/*
+ * Check Accept-Encoding parsing.
+ */
+void HTTPUtilsTest::testAcceptsEncoding() {
+  OLA_ASSERT_FALSE(AcceptsEncoding("", "gzip"));
+  OLA_ASSERT_TRUE(AcceptsEncoding("gzip", "gzip"));
+  OLA_ASSERT_TRUE(AcceptsEncoding("gzip, deflate, br", "gzip"));
+  OLA_ASSERT_TRUE(AcceptsEncoding("gzip, deflate, br", "br"));
+  OLA_ASSERT_FALSE(AcceptsEncoding("gzip, deflate", "br"));
+  OLA_ASSERT_TRUE(AcceptsEncoding("deflate,GZip", "gzip"));
+
+  // Only whole codings match.
+  OLA_ASSERT_FALSE(AcceptsEncoding("x-gzip", "gzip"));
+  OLA_ASSERT_FALSE(AcceptsEncoding("brotli", "br"));
+
+  // q values
+  OLA_ASSERT_TRUE(AcceptsEncoding("gzip;q=0.5", "gzip"));
+  OLA_ASSERT_TRUE(AcceptsEncoding("br;q=1.0, gzip;q=0.8", "br"));
+  OLA_ASSERT_FALSE(AcceptsEncoding("gzip;q=0", "gzip"));
+  OLA_ASSERT_FALSE(AcceptsEncoding("br, gzip ; q=0.000", "gzip"));
+  OLA_ASSERT_TRUE(AcceptsEncoding("br, gzip ; q=0.000", "br"));
+}
+
+
+/*
+ * Check If-None-Match parsing.
+ */
+void HTTPUtilsTest::testETagMatches() {
+  const string etag = "\"85944171f73967e8\"";
+  OLA_ASSERT_FALSE(ETagMatches("", etag));
+  OLA_ASSERT_TRUE(ETagMatches(etag, etag));
+  OLA_ASSERT_TRUE(ETagMatches(" " + etag + " ", etag));
+  OLA_ASSERT_TRUE(ETagMatches("*", etag));
+
+  // Weak validators match for a GET.
+  OLA_ASSERT_TRUE(ETagMatches("W/" + etag, etag));
+
+  // Lists
+  OLA_ASSERT_TRUE(ETagMatches("\"abc\", " + etag, etag));
+  OLA_ASSERT_TRUE(ETagMatches(etag + ",\"abc\"", etag));
+  OLA_ASSERT_FALSE(ETagMatches("\"abc\", \"def\"", etag));
+
+  // The quotes are part of the tag.
+  OLA_ASSERT_FALSE(ETagMatches("85944171f73967e8", etag));
+  OLA_ASSERT_FALSE(ETagMatches("\"85944171f73967e8-gzip\"", etag));
+}
@@ -4,6 +4,21 @@ if HAVE_LIBMICROHTTPD
 noinst_LTLIBRARIES += common/http/libolahttp.la
 common_http_libolahttp_la_SOURCES = \
     common/http/HTTPServer.cpp \
+    common/http/HTTPUtils.cpp \
+    common/http/HTTPUtils.h \
     common/http/OlaHTTPServer.cpp
 common_http_libolahttp_la_LIBADD = $(libmicrohttpd_LIBS)
 endif
+
+# TESTS
+##################################################
+if HAVE_LIBMICROHTTPD
+test_programs += common/http/HTTPTester
+
+common_http_HTTPTester_SOURCES = \
+    common/http/HTTPServerTest.cpp \
+    common/http/HTTPUtilsTest.cpp
+common_http_HTTPTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_http_HTTPTester_LDADD = common/http/libolahttp.la \
+                               $(COMMON_TESTING_LIBS)
+endif
@@ -18,19 +18,27 @@
  * Copyright (C) 2013 Simon Newton
  */
 
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif
+
 #include "common/io/EPoller.h"
 
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include <sys/epoll.h>
+#include <time.h>
 
 #include <algorithm>
 #include <queue>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "ola/Clock.h"
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "ola/base/Macro.h"
 #include "ola/io/Descriptor.h"
 #include "ola/stl/STLUtils.h"
@@ -39,6 +47,7 @@ namespace ola {
 namespace io {
 
 using std::pair;
+using std::string;
 
 /*
  * Represents a FD
@@ -46,7 +55,8 @@ using std::pair;
 class EPollData {
  public:
   EPollData()
-      : events(0),
+      : fd(INVALID_DESCRIPTOR),
+        events(0),
         read_descriptor(NULL),
         write_descriptor(NULL),
         connected_descriptor(NULL),
@@ -54,6 +64,7 @@ class EPollData {
   }
 
   void Reset() {
+    fd = INVALID_DESCRIPTOR;
     events = 0;
     read_descriptor = NULL;
     write_descriptor = NULL;
@@ -61,6 +72,7 @@ class EPollData {
     delete_connected_on_close = false;
   }
 
+  int fd;
   uint32_t events;
   ReadFileDescriptor *read_descriptor;
   WriteFileDescriptor *write_descriptor;
@@ -124,9 +136,9 @@ bool RemoveEvent(int epoll_fd, int fd) {
 }  // namespace
 
 /**
- * @brief The maximum number of events to return in one epoll cycle
+ * @brief The default maximum number of events to return in one epoll cycle
  */
-const int EPoller::MAX_EVENTS = 10;
+const unsigned int EPoller::DEFAULT_MAX_EVENTS = 64;
 
 
 /**
@@ -139,15 +151,44 @@ const int EPoller::READ_FLAGS = EPOLLIN | EPOLLRDHUP;
  */
 const unsigned int EPoller::MAX_FREE_DESCRIPTORS = 10;
 
-EPoller::EPoller(ExportMap *export_map, Clock* clock)
+/**
+ * @brief The number of events handled for each descriptor.
+ */
+const char EPoller::K_DESCRIPTOR_EVENTS_VAR[] = "ss-descriptor-events";
+
+/**
+ * @brief The time in microseconds spent in the callbacks for each descriptor.
+ */
+const char EPoller::K_DESCRIPTOR_TIME_VAR[] = "ss-descriptor-time";
+
+/**
+ * @brief The longest time in microseconds spent handling a single event for
+ * each descriptor.
+ */
+const char EPoller::K_DESCRIPTOR_MAX_TIME_VAR[] = "ss-descriptor-max-time";
+
+EPoller::EPoller(ExportMap *export_map, Clock* clock, const Options &options)
     : m_export_map(export_map),
       m_loop_iterations(NULL),
       m_loop_time(NULL),
+      m_descriptor_events(NULL),
+      m_descriptor_time(NULL),
+      m_descriptor_max_time(NULL),
       m_epoll_fd(INVALID_DESCRIPTOR),
-      m_clock(clock) {
+      m_clock(clock),
+      m_events(std::max(options.max_events, 1u)),
+      m_use_pwait2(true) {
   if (m_export_map) {
     m_loop_time = m_export_map->GetCounterVar(K_LOOP_TIME);
     m_loop_iterations = m_export_map->GetCounterVar(K_LOOP_COUNT);
+    if (options.descriptor_stats) {
+      m_descriptor_events = m_export_map->GetUIntMapVar(
+          K_DESCRIPTOR_EVENTS_VAR, "fd");
+      m_descriptor_time = m_export_map->GetUIntMapVar(
+          K_DESCRIPTOR_TIME_VAR, "fd");
+      m_descriptor_max_time = m_export_map->GetUIntMapVar(
+          K_DESCRIPTOR_MAX_TIME_VAR, "fd");
+    }
   }
 
   m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
@@ -162,12 +203,12 @@ EPoller::~EPoller() {
   }
 
   {
-    DescriptorMap::iterator iter = m_descriptor_map.begin();
-    for (; iter != m_descriptor_map.end(); ++iter) {
-      if (iter->second->delete_connected_on_close) {
-        delete iter->second->connected_descriptor;
+    DescriptorList::iterator iter = m_descriptors.begin();
+    for (; iter != m_descriptors.end(); ++iter) {
+      if (*iter && (*iter)->delete_connected_on_close) {
+        delete (*iter)->connected_descriptor;
       }
-      delete iter->second;
+      delete *iter;
     }
   }
 
@@ -290,7 +331,6 @@ bool EPoller::Poll(TimeoutManager *timeout_manager,
     return false;
   }
 
-  epoll_event events[MAX_EVENTS];
   TimeInterval sleep_interval = poll_interval;
   TimeStamp now;
   m_clock->CurrentTime(&now);
@@ -310,9 +350,7 @@ bool EPoller::Poll(TimeoutManager *timeout_manager,
       (*m_loop_iterations)++;
   }
 
-  int ms_to_sleep = sleep_interval.InMilliSeconds();
-  int ready = epoll_wait(m_epoll_fd, reinterpret_cast<epoll_event*>(&events),
-                         MAX_EVENTS, ms_to_sleep ? ms_to_sleep : 1);
+  int ready = Wait(sleep_interval);
 
   if (ready == 0) {
     m_clock->CurrentTime(&m_wake_up_time);
@@ -329,8 +367,12 @@ bool EPoller::Poll(TimeoutManager *timeout_manager,
 
   for (int i = 0; i < ready; i++) {
     EPollData *descriptor = reinterpret_cast<EPollData*>(
-        events[i].data.ptr);
-    CheckDescriptor(&events[i], descriptor);
+        m_events[i].data.ptr);
+    if (m_descriptor_events) {
+      TimeDescriptor(&m_events[i], descriptor);
+    } else {
+      CheckDescriptor(&m_events[i], descriptor);
+    }
   }
 
   // Now that we're out of the callback phase, clean up descriptors that were
@@ -351,6 +393,59 @@ bool EPoller::Poll(TimeoutManager *timeout_manager,
   return true;
 }
 
+/*
+ * Wait for events, for at most sleep_interval.
+ */
+int EPoller::Wait(const TimeInterval &sleep_interval) {
+  const int max_events = static_cast<int>(m_events.size());
+#ifdef HAVE_EPOLL_PWAIT2
+  if (m_use_pwait2) {
+    struct timespec timeout;
+    timeout.tv_sec = sleep_interval.Seconds();
+    timeout.tv_nsec = sleep_interval.MicroSeconds() * ONE_THOUSAND;
+    int ready = epoll_pwait2(m_epoll_fd, &m_events[0], max_events, &timeout,
+                             NULL);
+    if (ready != -1 || errno != ENOSYS) {
+      return ready;
+    }
+    // Built against a newer libc than the kernel supports.
+    OLA_INFO << "epoll_pwait2() isn't supported, using epoll_wait()";
+    m_use_pwait2 = false;
+  }
+#endif
+
+  // Round up, otherwise we'd spin until a sub-millisecond timeout is due.
+  int64_t ms_to_sleep = (sleep_interval.AsInt() + ONE_THOUSAND - 1) /
+                        ONE_THOUSAND;
+  return epoll_wait(m_epoll_fd, &m_events[0], max_events,
+                    static_cast<int>(std::min(ms_to_sleep,
+                                              static_cast<int64_t>(INT_MAX))));
+}
+
+/*
+ * Check a descriptor and record how long the callbacks took.
+ */
+void EPoller::TimeDescriptor(struct epoll_event *event,
+                             EPollData *epoll_data) {
+  TimeStamp start, end;
+  m_clock->CurrentTime(&start);
+  CheckDescriptor(event, epoll_data);
+  m_clock->CurrentTime(&end);
+
+  // Skip descriptors which were removed by their own callbacks, the fd may
+  // have been reused.
+  if (epoll_data->events == 0) {
+    return;
+  }
+
+  const string key = IntToString(epoll_data->fd);
+  const unsigned int elapsed = static_cast<unsigned int>(
+      (end - start).AsInt());
+  (*m_descriptor_events)[key]++;
+  (*m_descriptor_time)[key] += elapsed;
+  unsigned int &max_time = (*m_descriptor_max_time)[key];
+  max_time = std::max(max_time, elapsed);
+}
 
 /*
  * Check all the registered descriptors:
@@ -408,19 +503,23 @@ void EPoller::CheckDescriptor(struct epoll_event *event,
 }
 
 std::pair<EPollData*, bool> EPoller::LookupOrCreateDescriptor(int fd) {
-  pair<DescriptorMap::iterator, bool> result = m_descriptor_map.insert(
-      DescriptorMap::value_type(fd, NULL));
-  bool new_descriptor = result.second;
+  if (static_cast<unsigned int>(fd) >= m_descriptors.size()) {
+    m_descriptors.resize(fd + 1, NULL);
+  }
+
+  EPollData *&epoll_data = m_descriptors[fd];
+  bool new_descriptor = epoll_data == NULL;
 
   if (new_descriptor) {
     if (m_free_descriptors.empty()) {
-      result.first->second = new EPollData();
+      epoll_data = new EPollData();
     } else {
-      result.first->second = m_free_descriptors.back();
+      epoll_data = m_free_descriptors.back();
       m_free_descriptors.pop_back();
     }
+    epoll_data->fd = fd;
   }
-  return std::make_pair(result.first->second, new_descriptor);
+  return std::make_pair(epoll_data, new_descriptor);
 }
 
 bool EPoller::RemoveDescriptor(int fd, int event, bool warn_on_missing) {
@@ -429,7 +528,10 @@ bool EPoller::RemoveDescriptor(int fd, int event, bool warn_on_missing) {
     return false;
   }
 
-  EPollData *epoll_data = STLFindOrNull(m_descriptor_map, fd);
+  EPollData *epoll_data = NULL;
+  if (static_cast<unsigned int>(fd) < m_descriptors.size()) {
+    epoll_data = m_descriptors[fd];
+  }
   if (!epoll_data) {
     if (warn_on_missing) {
       OLA_WARN << "Couldn't find EPollData for " << fd;
@@ -448,8 +550,14 @@ bool EPoller::RemoveDescriptor(int fd, int event, bool warn_on_missing) {
 
   if (epoll_data->events == 0) {
     RemoveEvent(m_epoll_fd, fd);
-    m_orphaned_descriptors.push_back(
-        STLLookupAndRemovePtr(&m_descriptor_map, fd));
+    m_orphaned_descriptors.push_back(epoll_data);
+    m_descriptors[fd] = NULL;
+    if (m_descriptor_events) {
+      const string key = IntToString(fd);
+      m_descriptor_events->Remove(key);
+      m_descriptor_time->Remove(key);
+      m_descriptor_max_time->Remove(key);
+    }
   } else {
     return UpdateEvent(m_epoll_fd, fd, epoll_data);
   }
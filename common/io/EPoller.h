@@ -27,7 +27,6 @@
 #include <ola/io/Descriptor.h>
 #include <sys/epoll.h>
 
-#include <map>
 #include <set>
 #include <string>
 #include <utility>
@@ -47,15 +46,46 @@ class EPollData;
  *
  * epoll() is more efficient than select() but only newer Linux systems support
  * it.
+ *
+ * The per-descriptor state is kept in a table indexed by file descriptor, and
+ * up to Options::max_events ready descriptors are handled per call to
+ * epoll_wait(). If epoll_pwait2() is available, timeouts have microsecond
+ * resolution, otherwise they are rounded up to the next millisecond.
  */
 class EPoller : public PollerInterface {
  public :
+  /**
+   * @brief Options for the EPoller.
+   */
+  struct Options {
+   public:
+    Options()
+        : max_events(DEFAULT_MAX_EVENTS),
+          descriptor_stats(false) {
+    }
+
+    /**
+     * @brief The maximum number of events to handle per call to epoll_wait().
+     */
+    unsigned int max_events;
+
+    /**
+     * @brief Export the number of callbacks, and the time spent in them, for
+     * each descriptor.
+     *
+     * This requires two clock reads per event, so it's off by default.
+     */
+    bool descriptor_stats;
+  };
+
   /**
    * @brief Create a new EPoller.
    * @param export_map the ExportMap to use
    * @param clock the Clock to use
+   * @param options the Options to use
    */
-  EPoller(ExportMap *export_map, Clock *clock);
+  EPoller(ExportMap *export_map, Clock *clock,
+          const Options &options = Options());
 
   ~EPoller();
 
@@ -73,11 +103,17 @@ class EPoller : public PollerInterface {
   bool Poll(TimeoutManager *timeout_manager,
             const TimeInterval &poll_interval);
 
+  static const unsigned int DEFAULT_MAX_EVENTS;
+
+  static const char K_DESCRIPTOR_EVENTS_VAR[];
+  static const char K_DESCRIPTOR_TIME_VAR[];
+  static const char K_DESCRIPTOR_MAX_TIME_VAR[];
+
  private:
-  typedef std::map<int, EPollData*> DescriptorMap;
   typedef std::vector<EPollData*> DescriptorList;
 
-  DescriptorMap m_descriptor_map;
+  // Indexed by file descriptor, NULL if the descriptor isn't registered.
+  DescriptorList m_descriptors;
 
   // EPoller is re-enterant. Remove may be called while we hold a pointer to an
   // EPollData. To avoid deleting data out from underneath ourselves, we
@@ -89,16 +125,22 @@ class EPoller : public PollerInterface {
   ExportMap *m_export_map;
   CounterVariable *m_loop_iterations;
   CounterVariable *m_loop_time;
+  UIntMap *m_descriptor_events;
+  UIntMap *m_descriptor_time;
+  UIntMap *m_descriptor_max_time;
   int m_epoll_fd;
   Clock *m_clock;
   TimeStamp m_wake_up_time;
+  std::vector<epoll_event> m_events;
+  bool m_use_pwait2;
 
   std::pair<EPollData*, bool> LookupOrCreateDescriptor(int fd);
 
   bool RemoveDescriptor(int fd, int event, bool warn_on_missing);
+  int Wait(const TimeInterval &sleep_interval);
   void CheckDescriptor(struct epoll_event *event, EPollData *descriptor);
+  void TimeDescriptor(struct epoll_event *event, EPollData *descriptor);
 
-  static const int MAX_EVENTS;
   static const int READ_FLAGS;
   static const unsigned int MAX_FREE_DESCRIPTORS;
 
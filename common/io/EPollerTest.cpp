@@ -0,0 +1,238 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * EPollerTest.cpp
+ * Test fixture for the EPoller.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include "common/io/EPoller.h"
+#include "common/io/TimeoutManager.h"
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/StringUtils.h"
+#include "ola/base/Array.h"
+#include "ola/io/Descriptor.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::Clock;
+using ola::ExportMap;
+using ola::IntToString;
+using ola::MockClock;
+using ola::NewCallback;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::UIntMap;
+using ola::io::ConnectedDescriptor;
+using ola::io::EPoller;
+using ola::io::LoopbackDescriptor;
+using ola::io::TimeoutManager;
+using ola::io::UnmanagedFileDescriptor;
+using std::auto_ptr;
+using std::string;
+
+class EPollerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(EPollerTest);
+  CPPUNIT_TEST(testMaxEvents);
+  CPPUNIT_TEST(testLargeDescriptor);
+  CPPUNIT_TEST(testZeroTimeout);
+  CPPUNIT_TEST(testDescriptorStats);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  EPollerTest() : m_read_count(0) {}
+
+  void setUp() { m_read_count = 0; }
+
+  void testMaxEvents();
+  void testLargeDescriptor();
+  void testZeroTimeout();
+  void testDescriptorStats();
+
+ private:
+  unsigned int m_read_count;
+  MockClock m_clock;
+
+  void ReadData(ConnectedDescriptor *descriptor) {
+    uint8_t data[10];
+    unsigned int size;
+    descriptor->Receive(data, arraysize(data), size);
+    m_read_count++;
+  }
+
+  void ReadUnmanaged(UnmanagedFileDescriptor *descriptor) {
+    uint8_t data[10];
+    OLA_ASSERT_LT(0, read(descriptor->ReadDescriptor(), data, sizeof(data)));
+    m_read_count++;
+  }
+
+  void ReadDataAndAdvance(ConnectedDescriptor *descriptor,
+                          unsigned int usec) {
+    ReadData(descriptor);
+    m_clock.AdvanceTime(0, usec);
+  }
+
+  LoopbackDescriptor *NewLoopback();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(EPollerTest);
+
+LoopbackDescriptor *EPollerTest::NewLoopback() {
+  LoopbackDescriptor *descriptor = new LoopbackDescriptor();
+  descriptor->Init();
+  descriptor->SetOnData(
+      NewCallback(this, &EPollerTest::ReadData,
+                  static_cast<ConnectedDescriptor*>(descriptor)));
+  return descriptor;
+}
+
+/*
+ * Check that when more descriptors are ready than max_events, they're handled
+ * over multiple calls to Poll().
+ */
+void EPollerTest::testMaxEvents() {
+  TimeoutManager timeout_manager(NULL, &m_clock);
+  EPoller::Options options;
+  options.max_events = 2;
+  EPoller poller(NULL, &m_clock, options);
+
+  auto_ptr<LoopbackDescriptor> loopbacks[5];
+  const uint8_t data[] = {1, 2, 3};
+  for (unsigned int i = 0; i < arraysize(loopbacks); i++) {
+    loopbacks[i].reset(NewLoopback());
+    OLA_ASSERT_TRUE(poller.AddReadDescriptor(loopbacks[i].get(), false));
+    loopbacks[i]->Send(data, arraysize(data));
+  }
+
+  OLA_ASSERT_TRUE(poller.Poll(&timeout_manager, TimeInterval(0, 0)));
+  OLA_ASSERT_EQ(2u, m_read_count);
+  OLA_ASSERT_TRUE(poller.Poll(&timeout_manager, TimeInterval(0, 0)));
+  OLA_ASSERT_EQ(4u, m_read_count);
+  OLA_ASSERT_TRUE(poller.Poll(&timeout_manager, TimeInterval(0, 0)));
+  OLA_ASSERT_EQ(5u, m_read_count);
+
+  for (unsigned int i = 0; i < arraysize(loopbacks); i++) {
+    OLA_ASSERT_TRUE(poller.RemoveReadDescriptor(loopbacks[i].get()));
+  }
+}
+
+/*
+ * Check that descriptors with large values work.
+ */
+void EPollerTest::testLargeDescriptor() {
+  TimeoutManager timeout_manager(NULL, &m_clock);
+  EPoller poller(NULL, &m_clock);
+
+  LoopbackDescriptor loopback;
+  OLA_ASSERT_TRUE(loopback.Init());
+  const int fd = 900;
+  OLA_ASSERT_EQ(fd, dup2(loopback.ReadDescriptor(), fd));
+
+  UnmanagedFileDescriptor descriptor(fd);
+  descriptor.SetOnData(
+      NewCallback(this, &EPollerTest::ReadUnmanaged, &descriptor));
+  OLA_ASSERT_TRUE(poller.AddReadDescriptor(&descriptor));
+  // Adding the descriptor a second time fails.
+  OLA_ASSERT_FALSE(poller.AddReadDescriptor(&descriptor));
+
+  const uint8_t data[] = {1, 2, 3};
+  loopback.Send(data, arraysize(data));
+  OLA_ASSERT_TRUE(poller.Poll(&timeout_manager, TimeInterval(0, 0)));
+  OLA_ASSERT_EQ(1u, m_read_count);
+
+  OLA_ASSERT_TRUE(poller.RemoveReadDescriptor(&descriptor));
+  OLA_ASSERT_FALSE(poller.RemoveReadDescriptor(&descriptor));
+  close(fd);
+}
+
+/*
+ * Check that a zero poll interval doesn't block.
+ */
+void EPollerTest::testZeroTimeout() {
+  Clock clock;
+  TimeoutManager timeout_manager(NULL, &clock);
+  EPoller poller(NULL, &clock);
+
+  LoopbackDescriptor loopback;
+  loopback.Init();
+  OLA_ASSERT_TRUE(poller.AddReadDescriptor(&loopback, false));
+
+  // Previously each call blocked for at least 1ms.
+  TimeStamp start, end;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < 200; i++) {
+    OLA_ASSERT_TRUE(poller.Poll(&timeout_manager, TimeInterval(0, 0)));
+  }
+  clock.CurrentTime(&end);
+  OLA_ASSERT_LT(end - start, TimeInterval(0, 100000));
+  OLA_ASSERT_TRUE(poller.RemoveReadDescriptor(&loopback));
+}
+
+/*
+ * Check the per-descriptor statistics.
+ */
+void EPollerTest::testDescriptorStats() {
+  ExportMap export_map;
+  TimeoutManager timeout_manager(NULL, &m_clock);
+  EPoller::Options options;
+  options.descriptor_stats = true;
+  EPoller poller(&export_map, &m_clock, options);
+
+  LoopbackDescriptor loopback;
+  loopback.Init();
+  loopback.SetOnData(
+      NewCallback(this, &EPollerTest::ReadDataAndAdvance,
+                  static_cast<ConnectedDescriptor*>(&loopback), 1500u));
+  OLA_ASSERT_TRUE(poller.AddReadDescriptor(&loopback, false));
+
+  const uint8_t data[] = {1, 2, 3};
+  loopback.Send(data, arraysize(data));
+  OLA_ASSERT_TRUE(poller.Poll(&timeout_manager, TimeInterval(0, 0)));
+  OLA_ASSERT_EQ(1u, m_read_count);
+
+  loopback.SetOnData(
+      NewCallback(this, &EPollerTest::ReadDataAndAdvance,
+                  static_cast<ConnectedDescriptor*>(&loopback), 500u));
+  loopback.Send(data, arraysize(data));
+  OLA_ASSERT_TRUE(poller.Poll(&timeout_manager, TimeInterval(0, 0)));
+  OLA_ASSERT_EQ(2u, m_read_count);
+
+  UIntMap *events = export_map.GetUIntMapVar(
+      EPoller::K_DESCRIPTOR_EVENTS_VAR);
+  UIntMap *time = export_map.GetUIntMapVar(EPoller::K_DESCRIPTOR_TIME_VAR);
+  UIntMap *max_time = export_map.GetUIntMapVar(
+      EPoller::K_DESCRIPTOR_MAX_TIME_VAR);
+  const string key = IntToString(loopback.ReadDescriptor());
+  OLA_ASSERT_EQ(2u, (*events)[key]);
+  // MockClock includes the real time, so allow for the time the callbacks
+  // take to run.
+  OLA_ASSERT_LTE(2000u, (*time)[key]);
+  OLA_ASSERT_GT(2100u, (*time)[key]);
+  OLA_ASSERT_LTE(1500u, (*max_time)[key]);
+  OLA_ASSERT_GT(1600u, (*max_time)[key]);
+
+  // The stats are removed along with the descriptor.
+  OLA_ASSERT_TRUE(poller.RemoveReadDescriptor(&loopback));
+  OLA_ASSERT_EQ(string("map:fd"), events->Value());
+  OLA_ASSERT_EQ(string("map:fd"), time->Value());
+  OLA_ASSERT_EQ(string("map:fd"), max_time->Value());
+}
@@ -0,0 +1,1032 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * IOUringPoller.cpp
+ * A Poller which uses io_uring.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "common/io/IOUringPoller.h"
+
+#include <endian.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/base/Macro.h"
+#include "ola/io/Descriptor.h"
+
+namespace ola {
+namespace io {
+
+using std::pair;
+using std::vector;
+
+/*
+ * A request on the ring, the user_data of each request points to one of
+ * these.
+ */
+class IOUringRequest {
+ public:
+  explicit IOUringRequest(bool is_receive)
+      : is_receive(is_receive),
+        generation(0),
+        in_flight(0) {
+  }
+
+  // True if this is an IOUringReceiver, otherwise it's an IOUringData.
+  const bool is_receive;
+  // Identifies the current request.
+  unsigned int generation;
+  // The number of requests which haven't completed yet.
+  unsigned int in_flight;
+};
+
+/*
+ * Represents a FD
+ */
+class IOUringData : public IOUringRequest {
+ public:
+  IOUringData()
+      : IOUringRequest(false),
+        fd(INVALID_DESCRIPTOR),
+        events(0),
+        armed_events(0),
+        changed(false),
+        read_descriptor(NULL),
+        write_descriptor(NULL),
+        connected_descriptor(NULL),
+        delete_connected_on_close(false),
+        receiver(NULL) {
+  }
+
+  int fd;
+  // The events we want.
+  uint32_t events;
+  // The events of the current poll request, 0 if there isn't one.
+  uint32_t armed_events;
+  // True if this is in m_changed_descriptors.
+  bool changed;
+  ReadFileDescriptor *read_descriptor;
+  WriteFileDescriptor *write_descriptor;
+  ConnectedDescriptor *connected_descriptor;
+  bool delete_connected_on_close;
+  // Receives the datagrams for read_descriptor, if it accepts them.
+  IOUringReceiver *receiver;
+};
+
+/*
+ * The multishot receive for a descriptor which accepts received datagrams.
+ */
+class IOUringReceiver : public IOUringRequest {
+ public:
+  IOUringReceiver(IOUringData *data, ReadFileDescriptor *descriptor)
+      : IOUringRequest(true),
+        data(data),
+        descriptor(descriptor),
+        armed(false),
+        disabled(false),
+        ready(false) {
+    // This describes the layout of each buffer, so it must outlive the
+    // request.
+    memset(&header, 0, sizeof(header));
+    header.msg_namelen = sizeof(struct sockaddr_storage);
+    header.msg_controllen = CMSG_SPACE(sizeof(uint32_t));
+  }
+
+  // Both are NULL once the descriptor has been removed.
+  IOUringData *data;
+  ReadFileDescriptor *descriptor;
+  // True while the receive is running.
+  bool armed;
+  // True if the kernel can't do the receive, so the descriptor is polled.
+  bool disabled;
+  // True if this is in m_ready_receivers.
+  bool ready;
+  struct msghdr header;
+  // The datagrams received during this loop iteration, and their buffers.
+  vector<ReceivedDatagram> datagrams;
+  vector<uint16_t> buffer_ids;
+};
+
+namespace {
+
+/*
+ * The user_data for a request is the IOUringRequest pointer, with the low
+ * bits holding the generation. This lets us ignore completions for requests
+ * we've since cancelled.
+ */
+const uint64_t GENERATION_MASK = 7;
+
+/*
+ * The user_data for cancel requests, their completions are ignored.
+ */
+const uint64_t CANCEL_USER_DATA = 0;
+
+uint64_t UserData(const IOUringRequest *request) {
+  return reinterpret_cast<uintptr_t>(request) |
+      (request->generation & GENERATION_MASK);
+}
+
+IOUringRequest *RequestFromUserData(uint64_t user_data) {
+  return reinterpret_cast<IOUringRequest*>(
+      static_cast<uintptr_t>(user_data & ~GENERATION_MASK));
+}
+}  // namespace
+
+/**
+ * @brief The number of submission queue entries to request.
+ */
+const unsigned int IOUringPoller::RING_SIZE = 256;
+
+/**
+ * @brief The number of buffers provided for receives, this must be a power of
+ * two.
+ */
+const unsigned int IOUringPoller::BUFFER_COUNT = 256;
+
+/**
+ * @brief The size of each receive buffer.
+ *
+ * This holds the source address & ancillary data as well as the datagram,
+ * which leaves room for ~1800 bytes. Larger datagrams are truncated, as they
+ * would be if read into a short buffer.
+ */
+const unsigned int IOUringPoller::BUFFER_SIZE = 2048;
+
+/**
+ * @brief The buffer group id for the receive buffers.
+ */
+const uint16_t IOUringPoller::BUFFER_GROUP = 0;
+
+/**
+ * @brief The poll flags used for read descriptors.
+ */
+const uint32_t IOUringPoller::READ_FLAGS = POLLIN | POLLRDHUP;
+
+/**
+ * @brief The poll flags used for write descriptors.
+ */
+const uint32_t IOUringPoller::WRITE_FLAGS = POLLOUT;
+
+IOUringPoller::IOUringPoller(ExportMap *export_map, Clock* clock)
+    : m_export_map(export_map),
+      m_loop_iterations(NULL),
+      m_loop_time(NULL),
+      m_clock(clock),
+      m_ring_fd(INVALID_DESCRIPTOR),
+      m_ring(NULL),
+      m_ring_size(0),
+      m_sqes(NULL),
+      m_sqes_size(0),
+      m_sq_entries(0),
+      m_sq_head(NULL),
+      m_sq_tail(NULL),
+      m_sq_mask(0),
+      m_cq_head(NULL),
+      m_cq_tail(NULL),
+      m_cq_mask(0),
+      m_cqes(NULL),
+      m_buffer_ring(NULL),
+      m_buffers(NULL),
+      m_buffers_size(0),
+      m_buffer_tail(0) {
+  if (m_export_map) {
+    m_loop_time = m_export_map->GetCounterVar(K_LOOP_TIME);
+    m_loop_iterations = m_export_map->GetCounterVar(K_LOOP_COUNT);
+  }
+}
+
+IOUringPoller::~IOUringPoller() {
+  // Closing the ring cancels any outstanding requests.
+  if (m_ring_fd != INVALID_DESCRIPTOR) {
+    munmap(m_sqes, m_sqes_size);
+    munmap(m_ring, m_ring_size);
+    close(m_ring_fd);
+  }
+  if (m_buffer_ring) {
+    munmap(m_buffer_ring, m_buffers_size);
+  }
+
+  DescriptorList::iterator iter = m_descriptors.begin();
+  for (; iter != m_descriptors.end(); ++iter) {
+    if (*iter && (*iter)->delete_connected_on_close) {
+      delete (*iter)->connected_descriptor;
+    }
+    if (*iter) {
+      delete (*iter)->receiver;
+    }
+    delete *iter;
+  }
+
+  iter = m_orphaned_descriptors.begin();
+  for (; iter != m_orphaned_descriptors.end(); ++iter) {
+    if ((*iter)->delete_connected_on_close) {
+      delete (*iter)->connected_descriptor;
+    }
+    delete *iter;
+  }
+
+  ReceiverList::iterator receiver_iter = m_orphaned_receivers.begin();
+  for (; receiver_iter != m_orphaned_receivers.end(); ++receiver_iter) {
+    delete *receiver_iter;
+  }
+}
+
+bool IOUringPoller::Init() {
+  if (m_ring_fd != INVALID_DESCRIPTOR) {
+    return true;
+  }
+
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_CLAMP;
+  int fd = static_cast<int>(syscall(__NR_io_uring_setup, RING_SIZE, &params));
+  if (fd < 0) {
+    OLA_INFO << "io_uring_setup() failed: " << strerror(errno);
+    return false;
+  }
+
+  const uint32_t required_features = (
+      IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG);
+  if ((params.features & required_features) != required_features) {
+    OLA_INFO << "io_uring is missing required features, found 0x" << std::hex
+             << params.features;
+    close(fd);
+    return false;
+  }
+
+  const size_t sq_size = (params.sq_off.array +
+                          params.sq_entries * sizeof(unsigned int));
+  const size_t cq_size = (params.cq_off.cqes +
+                          params.cq_entries * sizeof(struct io_uring_cqe));
+  const size_t ring_size = std::max(sq_size, cq_size);
+  void *ring = mmap(NULL, ring_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (ring == MAP_FAILED) {
+    OLA_WARN << "Failed to map the io_uring: " << strerror(errno);
+    close(fd);
+    return false;
+  }
+
+  const size_t sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  void *sqes = mmap(NULL, sqes_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    OLA_WARN << "Failed to map the io_uring SQEs: " << strerror(errno);
+    munmap(ring, ring_size);
+    close(fd);
+    return false;
+  }
+
+  uint8_t *base = static_cast<uint8_t*>(ring);
+  m_sq_head = reinterpret_cast<unsigned int*>(base + params.sq_off.head);
+  m_sq_tail = reinterpret_cast<unsigned int*>(base + params.sq_off.tail);
+  m_sq_mask = *reinterpret_cast<unsigned int*>(base + params.sq_off.ring_mask);
+  m_cq_head = reinterpret_cast<unsigned int*>(base + params.cq_off.head);
+  m_cq_tail = reinterpret_cast<unsigned int*>(base + params.cq_off.tail);
+  m_cq_mask = *reinterpret_cast<unsigned int*>(base + params.cq_off.ring_mask);
+  m_cqes = reinterpret_cast<struct io_uring_cqe*>(base + params.cq_off.cqes);
+
+  // We always use the SQEs in order.
+  unsigned int *sq_array = reinterpret_cast<unsigned int*>(
+      base + params.sq_off.array);
+  for (unsigned int i = 0; i < params.sq_entries; i++) {
+    sq_array[i] = i;
+  }
+
+  m_ring_fd = fd;
+  m_ring = ring;
+  m_ring_size = ring_size;
+  m_sqes = static_cast<struct io_uring_sqe*>(sqes);
+  m_sqes_size = sqes_size;
+  m_sq_entries = params.sq_entries;
+  m_completions.reserve(params.cq_entries);
+
+  // Without the provided buffers, the UDP sockets are polled like every other
+  // descriptor.
+  SetupBuffers();
+  return true;
+}
+
+bool IOUringPoller::AddReadDescriptor(ReadFileDescriptor *descriptor) {
+  if (m_ring_fd == INVALID_DESCRIPTOR) {
+    return false;
+  }
+
+  if (!descriptor->ValidReadDescriptor()) {
+    OLA_WARN << "AddReadDescriptor called with invalid descriptor";
+    return false;
+  }
+
+  IOUringData *data = LookupOrCreateDescriptor(
+      descriptor->ReadDescriptor()).first;
+  if (data->events & READ_FLAGS) {
+    OLA_WARN << "Descriptor " << descriptor->ReadDescriptor()
+             << " already in read set";
+    return false;
+  }
+
+  data->events |= READ_FLAGS;
+  data->read_descriptor = descriptor;
+  if (m_buffer_ring && descriptor->AcceptsReceivedDatagrams()) {
+    data->receiver = new IOUringReceiver(data, descriptor);
+  }
+  DescriptorChanged(data);
+  return true;
+}
+
+bool IOUringPoller::AddReadDescriptor(ConnectedDescriptor *descriptor,
+                                      bool delete_on_close) {
+  if (m_ring_fd == INVALID_DESCRIPTOR) {
+    return false;
+  }
+
+  if (!descriptor->ValidReadDescriptor()) {
+    OLA_WARN << "AddReadDescriptor called with invalid descriptor";
+    return false;
+  }
+
+  IOUringData *data = LookupOrCreateDescriptor(
+      descriptor->ReadDescriptor()).first;
+  if (data->events & READ_FLAGS) {
+    OLA_WARN << "Descriptor " << descriptor->ReadDescriptor()
+             << " already in read set";
+    return false;
+  }
+
+  data->events |= READ_FLAGS;
+  data->connected_descriptor = descriptor;
+  data->delete_connected_on_close = delete_on_close;
+  DescriptorChanged(data);
+  return true;
+}
+
+bool IOUringPoller::RemoveReadDescriptor(ReadFileDescriptor *descriptor) {
+  return RemoveDescriptor(descriptor->ReadDescriptor(), READ_FLAGS, true);
+}
+
+bool IOUringPoller::RemoveReadDescriptor(ConnectedDescriptor *descriptor) {
+  return RemoveDescriptor(descriptor->ReadDescriptor(), READ_FLAGS, true);
+}
+
+bool IOUringPoller::AddWriteDescriptor(WriteFileDescriptor *descriptor) {
+  if (m_ring_fd == INVALID_DESCRIPTOR) {
+    return false;
+  }
+
+  if (!descriptor->ValidWriteDescriptor()) {
+    OLA_WARN << "AddWriteDescriptor called with invalid descriptor";
+    return false;
+  }
+
+  IOUringData *data = LookupOrCreateDescriptor(
+      descriptor->WriteDescriptor()).first;
+  if (data->events & WRITE_FLAGS) {
+    OLA_WARN << "Descriptor " << descriptor->WriteDescriptor()
+             << " already in write set";
+    return false;
+  }
+
+  data->events |= WRITE_FLAGS;
+  data->write_descriptor = descriptor;
+  DescriptorChanged(data);
+  return true;
+}
+
+bool IOUringPoller::RemoveWriteDescriptor(WriteFileDescriptor *descriptor) {
+  return RemoveDescriptor(descriptor->WriteDescriptor(), WRITE_FLAGS, true);
+}
+
+bool IOUringPoller::Poll(TimeoutManager *timeout_manager,
+                         const TimeInterval &poll_interval) {
+  if (m_ring_fd == INVALID_DESCRIPTOR) {
+    return false;
+  }
+
+  TimeInterval sleep_interval = poll_interval;
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+
+  TimeInterval next_event_in = timeout_manager->ExecuteTimeouts(&now);
+  if (!next_event_in.IsZero()) {
+    sleep_interval = std::min(next_event_in, sleep_interval);
+  }
+
+  // take care of stats accounting
+  if (m_wake_up_time.IsSet()) {
+    TimeInterval loop_time = now - m_wake_up_time;
+    OLA_DEBUG << "ss process time was " << loop_time.ToString();
+    if (m_loop_time)
+      (*m_loop_time) += loop_time.AsInt();
+    if (m_loop_iterations)
+      (*m_loop_iterations)++;
+  }
+
+  // This must be the last thing we do, since the timeouts above may have
+  // changed the descriptors.
+  ApplyChanges();
+  CleanupOrphans();
+
+  struct __kernel_timespec timeout;
+  timeout.tv_sec = sleep_interval.Seconds();
+  timeout.tv_nsec = sleep_interval.MicroSeconds() * ONE_THOUSAND;
+
+  struct io_uring_getevents_arg arg;
+  memset(&arg, 0, sizeof(arg));
+  arg.sigmask_sz = _NSIG / 8;
+  arg.ts = reinterpret_cast<uintptr_t>(&timeout);
+
+  if (Enter(1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg,
+            sizeof(arg)) < 0) {
+    if (errno != ETIME && errno != EINTR && errno != EBUSY &&
+        errno != EAGAIN) {
+      OLA_WARN << "io_uring_enter() error, " << strerror(errno);
+      return false;
+    }
+  }
+
+  m_clock->CurrentTime(&m_wake_up_time);
+
+  ReapCompletions();
+  vector<struct io_uring_cqe>::const_iterator iter = m_completions.begin();
+  for (; iter != m_completions.end(); ++iter) {
+    HandleCompletion(*iter);
+  }
+
+  if (!m_ready_receivers.empty()) {
+    ReceiverList ready;
+    ready.swap(m_ready_receivers);
+    ReceiverList::iterator receiver_iter = ready.begin();
+    for (; receiver_iter != ready.end(); ++receiver_iter) {
+      DispatchDatagrams(*receiver_iter);
+    }
+    PublishBuffers();
+  }
+
+  m_clock->CurrentTime(&m_wake_up_time);
+  timeout_manager->ExecuteTimeouts(&m_wake_up_time);
+  return true;
+}
+
+std::pair<IOUringData*, bool> IOUringPoller::LookupOrCreateDescriptor(
+    int fd) {
+  if (static_cast<unsigned int>(fd) >= m_descriptors.size()) {
+    m_descriptors.resize(fd + 1, NULL);
+  }
+
+  IOUringData *&data = m_descriptors[fd];
+  bool new_descriptor = data == NULL;
+  if (new_descriptor) {
+    data = new IOUringData();
+    data->fd = fd;
+  }
+  return std::make_pair(data, new_descriptor);
+}
+
+bool IOUringPoller::RemoveDescriptor(int fd, int event,
+                                     bool warn_on_missing) {
+  if (fd == INVALID_DESCRIPTOR) {
+    OLA_WARN << "Attempt to remove an invalid file descriptor";
+    return false;
+  }
+
+  IOUringData *data = NULL;
+  if (static_cast<unsigned int>(fd) < m_descriptors.size()) {
+    data = m_descriptors[fd];
+  }
+  if (!data) {
+    if (warn_on_missing) {
+      OLA_WARN << "Couldn't find IOUringData for " << fd;
+    }
+    return false;
+  }
+
+  data->events &= (~event);
+
+  if (event & WRITE_FLAGS) {
+    data->write_descriptor = NULL;
+  } else if (event & READ_FLAGS) {
+    if (data->receiver) {
+      RemoveReceiver(data);
+    }
+    data->read_descriptor = NULL;
+    data->connected_descriptor = NULL;
+  }
+
+  DescriptorChanged(data);
+  if (data->events == 0) {
+    // The data can't be deleted until the poll request has been cancelled,
+    // and we may be within a callback for it.
+    m_descriptors[fd] = NULL;
+    m_orphaned_descriptors.push_back(data);
+  }
+  return true;
+}
+
+void IOUringPoller::DescriptorChanged(IOUringData *data) {
+  if (!data->changed) {
+    data->changed = true;
+    m_changed_descriptors.push_back(data);
+  }
+}
+
+/*
+ * Detach the receiver from a descriptor. The receiver is deleted by
+ * CleanupOrphans() once the kernel is done with it.
+ */
+void IOUringPoller::RemoveReceiver(IOUringData *data) {
+  IOUringReceiver *receiver = data->receiver;
+  data->receiver = NULL;
+  // Submit the cancel now, otherwise datagrams which arrive before the next
+  // iteration are taken off the socket and dropped.
+  if (receiver->armed && Cancel(receiver)) {
+    receiver->armed = false;
+    Enter(0, 0, NULL, 0);
+  }
+  // We may be within PerformRead() for this descriptor.
+  receiver->descriptor->SetReceivedDatagrams(NULL, 0);
+  receiver->descriptor = NULL;
+  receiver->data = NULL;
+  m_orphaned_receivers.push_back(receiver);
+}
+
+/*
+ * Queue the requests for the descriptors which have changed.
+ */
+void IOUringPoller::ApplyChanges() {
+  DescriptorList changed;
+  changed.swap(m_changed_descriptors);
+
+  DescriptorList::iterator iter = changed.begin();
+  for (; iter != changed.end(); ++iter) {
+    IOUringData *data = *iter;
+    data->changed = false;
+    if (!UpdateReceive(data) || !UpdatePoll(data)) {
+      // The submission queue is full, try again on the next iteration.
+      DescriptorChanged(data);
+    }
+  }
+}
+
+/*
+ * Replace the poll request if the events have changed.
+ */
+bool IOUringPoller::UpdatePoll(IOUringData *data) {
+  uint32_t events = data->events;
+  if (data->receiver && !data->receiver->disabled) {
+    events &= ~READ_FLAGS;
+  }
+
+  if (data->armed_events == events) {
+    return true;
+  }
+
+  if (data->armed_events) {
+    if (!Cancel(data)) {
+      return false;
+    }
+    data->armed_events = 0;
+  }
+
+  if (events) {
+    struct io_uring_sqe *sqe = NextSubmission();
+    if (!sqe) {
+      return false;
+    }
+    data->generation++;
+    uint32_t poll_events = events;
+#if __BYTE_ORDER == __BIG_ENDIAN
+    // poll32_events is word swapped on big endian systems.
+    poll_events = (poll_events << 16) | (poll_events >> 16);
+#endif
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = data->fd;
+    sqe->poll32_events = poll_events;
+    sqe->user_data = UserData(data);
+    QueueSubmission();
+    data->armed_events = events;
+    data->in_flight++;
+  }
+  return true;
+}
+
+/*
+ * Start the multishot receive if it isn't running.
+ */
+bool IOUringPoller::UpdateReceive(IOUringData *data) {
+  IOUringReceiver *receiver = data->receiver;
+  if (!receiver || receiver->disabled || receiver->armed) {
+    return true;
+  }
+
+  struct io_uring_sqe *sqe = NextSubmission();
+  if (!sqe) {
+    return false;
+  }
+  receiver->generation++;
+  sqe->opcode = IORING_OP_RECVMSG;
+  sqe->fd = data->fd;
+  sqe->addr = reinterpret_cast<uintptr_t>(&receiver->header);
+  sqe->len = 1;
+  sqe->flags = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = BUFFER_GROUP;
+  sqe->ioprio = IORING_RECV_MULTISHOT;
+  sqe->user_data = UserData(receiver);
+  QueueSubmission();
+  receiver->armed = true;
+  receiver->in_flight++;
+  return true;
+}
+
+/*
+ * Cancel the current request, the completion is ignored since the request is
+ * no longer armed.
+ */
+bool IOUringPoller::Cancel(const IOUringRequest *request) {
+  struct io_uring_sqe *sqe = NextSubmission();
+  if (!sqe) {
+    return false;
+  }
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->fd = -1;
+  sqe->addr = UserData(request);
+  sqe->user_data = CANCEL_USER_DATA;
+  QueueSubmission();
+  return true;
+}
+
+/*
+ * Delete the removed descriptors & receivers which have no requests in
+ * flight.
+ */
+void IOUringPoller::CleanupOrphans() {
+  DescriptorList::iterator iter = m_orphaned_descriptors.begin();
+  while (iter != m_orphaned_descriptors.end()) {
+    if ((*iter)->in_flight || (*iter)->changed) {
+      ++iter;
+    } else {
+      delete *iter;
+      iter = m_orphaned_descriptors.erase(iter);
+    }
+  }
+
+  ReceiverList::iterator receiver_iter = m_orphaned_receivers.begin();
+  while (receiver_iter != m_orphaned_receivers.end()) {
+    IOUringReceiver *receiver = *receiver_iter;
+    if (receiver->armed && Cancel(receiver)) {
+      receiver->armed = false;
+    }
+
+    if (receiver->in_flight || receiver->ready) {
+      ++receiver_iter;
+    } else {
+      delete receiver;
+      receiver_iter = m_orphaned_receivers.erase(receiver_iter);
+    }
+  }
+}
+
+/*
+ * Return the next free SQE, or NULL if the submission queue is full.
+ */
+struct io_uring_sqe *IOUringPoller::NextSubmission() {
+  const unsigned int tail = *m_sq_tail;
+  if (tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) == m_sq_entries) {
+    // Submit what we have to make space.
+    Enter(0, 0, NULL, 0);
+    if (tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) == m_sq_entries) {
+      OLA_WARN << "io_uring submission queue is full";
+      return NULL;
+    }
+  }
+
+  struct io_uring_sqe *sqe = &m_sqes[tail & m_sq_mask];
+  memset(sqe, 0, sizeof(*sqe));
+  return sqe;
+}
+
+/*
+ * Make the SQE returned by NextSubmission() visible to the kernel.
+ */
+void IOUringPoller::QueueSubmission() {
+  __atomic_store_n(m_sq_tail, *m_sq_tail + 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * Submit the queued requests, and optionally wait for completions.
+ */
+int IOUringPoller::Enter(unsigned int min_complete, unsigned int flags,
+                         const void *arg, size_t arg_size) {
+  const unsigned int to_submit = (
+      *m_sq_tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE));
+  return static_cast<int>(syscall(__NR_io_uring_enter, m_ring_fd, to_submit,
+                                  min_complete, flags, arg, arg_size));
+}
+
+/*
+ * Copy the completions out of the ring, so the callbacks are free to queue
+ * more requests.
+ */
+void IOUringPoller::ReapCompletions() {
+  m_completions.clear();
+  unsigned int head = *m_cq_head;
+  const unsigned int tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+  for (; head != tail; head++) {
+    m_completions.push_back(m_cqes[head & m_cq_mask]);
+  }
+  __atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+}
+
+void IOUringPoller::HandleCompletion(const struct io_uring_cqe &cqe) {
+  if (cqe.user_data == CANCEL_USER_DATA) {
+    return;
+  }
+
+  IOUringRequest *request = RequestFromUserData(cqe.user_data);
+  if (request->is_receive) {
+    HandleReceive(cqe, static_cast<IOUringReceiver*>(request));
+    return;
+  }
+
+  IOUringData *data = static_cast<IOUringData*>(request);
+  data->in_flight--;
+  if (!data->armed_events ||
+      (cqe.user_data & GENERATION_MASK) !=
+      (data->generation & GENERATION_MASK)) {
+    // This request was cancelled.
+    return;
+  }
+
+  data->armed_events = 0;
+  if (cqe.res < 0) {
+    // Don't re-arm, otherwise we'd spin.
+    OLA_WARN << "Poll for descriptor " << data->fd << " failed: "
+             << strerror(-cqe.res);
+    return;
+  }
+
+  // Re-arm the request on the next iteration. This happens before the
+  // callbacks so that they can remove the descriptor.
+  DescriptorChanged(data);
+  CheckDescriptor(cqe.res, data);
+}
+
+/*
+ * Handle a completion for a multishot receive. Each one carries a datagram,
+ * which is queued until all the completions have been handled.
+ */
+void IOUringPoller::HandleReceive(const struct io_uring_cqe &cqe,
+                                  IOUringReceiver *receiver) {
+  const bool current = (
+      receiver->data && receiver->armed &&
+      (cqe.user_data & GENERATION_MASK) ==
+      (receiver->generation & GENERATION_MASK));
+  const bool has_buffer = cqe.flags & IORING_CQE_F_BUFFER;
+  const uint16_t buffer_id = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+
+  if (!(cqe.flags & IORING_CQE_F_MORE)) {
+    // The receive has stopped, it's restarted on the next iteration.
+    receiver->in_flight--;
+    if (current) {
+      receiver->armed = false;
+      DescriptorChanged(receiver->data);
+    }
+  }
+
+  if (!current) {
+    if (has_buffer) {
+      ReturnBuffer(buffer_id);
+    }
+    return;
+  }
+
+  if (cqe.res < 0) {
+    switch (-cqe.res) {
+      case ENOBUFS:
+        // All the buffers are in use, the datagrams stay queued on the socket
+        // until they're returned.
+        OLA_DEBUG << "Out of receive buffers for " << receiver->data->fd;
+        break;
+      case EINVAL:
+      case EOPNOTSUPP:
+        OLA_INFO << "Multishot receive isn't supported, polling "
+                 << receiver->data->fd << " instead";
+        receiver->disabled = true;
+        break;
+      default:
+        OLA_WARN << "Receive for descriptor " << receiver->data->fd
+                 << " failed: " << strerror(-cqe.res);
+    }
+    return;
+  }
+
+  if (!has_buffer) {
+    return;
+  }
+
+  uint8_t *buffer = m_buffers + buffer_id * BUFFER_SIZE;
+  const struct io_uring_recvmsg_out *out = (
+      reinterpret_cast<const struct io_uring_recvmsg_out*>(buffer));
+  const unsigned int name_offset = sizeof(*out);
+  const unsigned int control_offset = (
+      name_offset + receiver->header.msg_namelen);
+  const unsigned int payload_offset = (
+      control_offset + receiver->header.msg_controllen);
+  if (static_cast<unsigned int>(cqe.res) < payload_offset) {
+    OLA_WARN << "Short receive for descriptor " << receiver->data->fd;
+    ReturnBuffer(buffer_id);
+    return;
+  }
+
+  ReceivedDatagram datagram;
+  datagram.data = buffer + payload_offset;
+  datagram.size = std::min(out->payloadlen, cqe.res - payload_offset);
+  datagram.source = reinterpret_cast<const struct sockaddr*>(
+      buffer + name_offset);
+  datagram.source_size = std::min(out->namelen,
+                                  receiver->header.msg_namelen);
+  datagram.control = out->controllen ? buffer + control_offset : NULL;
+  datagram.control_size = std::min(
+      out->controllen,
+      static_cast<unsigned int>(receiver->header.msg_controllen));
+  receiver->datagrams.push_back(datagram);
+  receiver->buffer_ids.push_back(buffer_id);
+
+  if (!receiver->ready) {
+    receiver->ready = true;
+    m_ready_receivers.push_back(receiver);
+  }
+}
+
+/*
+ * Hand the datagrams to the descriptor, and then return the buffers.
+ */
+void IOUringPoller::DispatchDatagrams(IOUringReceiver *receiver) {
+  receiver->ready = false;
+  ReadFileDescriptor *descriptor = receiver->descriptor;
+  if (descriptor) {
+    descriptor->SetReceivedDatagrams(&receiver->datagrams[0],
+                                     receiver->datagrams.size());
+    unsigned int unread = receiver->datagrams.size();
+    while (true) {
+      descriptor->PerformRead();
+      if (!receiver->descriptor) {
+        // The callback removed the descriptor.
+        break;
+      }
+      const unsigned int remaining = descriptor->UnreadDatagrams();
+      if (remaining == 0 || remaining == unread) {
+        // If the callback stopped reading, the rest are dropped, since
+        // they're no longer queued on the socket.
+        break;
+      }
+      unread = remaining;
+    }
+    if (receiver->descriptor) {
+      descriptor->SetReceivedDatagrams(NULL, 0);
+    }
+  }
+
+  vector<uint16_t>::const_iterator iter = receiver->buffer_ids.begin();
+  for (; iter != receiver->buffer_ids.end(); ++iter) {
+    ReturnBuffer(*iter);
+  }
+  receiver->datagrams.clear();
+  receiver->buffer_ids.clear();
+}
+
+/*
+ * Setup the ring of buffers the kernel receives into.
+ */
+bool IOUringPoller::SetupBuffers() {
+  const size_t ring_size = BUFFER_COUNT * sizeof(struct io_uring_buf);
+  const size_t size = ring_size + BUFFER_COUNT * BUFFER_SIZE;
+  void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) {
+    OLA_WARN << "Failed to map the receive buffers: " << strerror(errno);
+    return false;
+  }
+
+  struct io_uring_buf_reg registration;
+  memset(&registration, 0, sizeof(registration));
+  registration.ring_addr = reinterpret_cast<uintptr_t>(memory);
+  registration.ring_entries = BUFFER_COUNT;
+  registration.bgid = BUFFER_GROUP;
+  if (syscall(__NR_io_uring_register, m_ring_fd, IORING_REGISTER_PBUF_RING,
+              &registration, 1) < 0) {
+    OLA_INFO << "io_uring provided buffers aren't available, UDP sockets "
+             << "will be polled: " << strerror(errno);
+    munmap(memory, size);
+    return false;
+  }
+
+  m_buffer_ring = static_cast<struct io_uring_buf_ring*>(memory);
+  m_buffers = static_cast<uint8_t*>(memory) + ring_size;
+  m_buffers_size = size;
+  for (unsigned int i = 0; i < BUFFER_COUNT; i++) {
+    ReturnBuffer(i);
+  }
+  PublishBuffers();
+  return true;
+}
+
+/*
+ * Add a buffer back to the ring, this takes effect once PublishBuffers() is
+ * called.
+ */
+void IOUringPoller::ReturnBuffer(uint16_t buffer_id) {
+  // The ring is an array of io_uring_buf, with the tail overlaying the first
+  // entry. We don't use the bufs member since the flexible array in the
+  // kernel header isn't at offset 0 when compiled as C++.
+  struct io_uring_buf *buffer = (
+      reinterpret_cast<struct io_uring_buf*>(m_buffer_ring) +
+      (m_buffer_tail & (BUFFER_COUNT - 1)));
+  buffer->addr = reinterpret_cast<uintptr_t>(
+      m_buffers + buffer_id * BUFFER_SIZE);
+  buffer->len = BUFFER_SIZE;
+  buffer->bid = buffer_id;
+  m_buffer_tail++;
+}
+
+void IOUringPoller::PublishBuffers() {
+  __atomic_store_n(&m_buffer_ring->tail, m_buffer_tail, __ATOMIC_RELEASE);
+}
+
+/*
+ * Run the callbacks for a descriptor:
+ *  - Execute the callback for descriptors with data
+ *  - Excute OnClose if a remote end closed the connection
+ */
+void IOUringPoller::CheckDescriptor(uint32_t revents, IOUringData *data) {
+  if (revents & (POLLHUP | POLLRDHUP)) {
+    if (data->read_descriptor) {
+      data->read_descriptor->PerformRead();
+    } else if (data->write_descriptor) {
+      data->write_descriptor->PerformWrite();
+    } else if (data->connected_descriptor) {
+      ConnectedDescriptor::OnCloseCallback *on_close =
+          data->connected_descriptor->TransferOnClose();
+      if (on_close)
+        on_close->Run();
+
+      // At this point the descriptor may be sitting in the orphan list if the
+      // OnClose handler called into RemoveReadDescriptor()
+      if (data->delete_connected_on_close && data->connected_descriptor) {
+        bool removed = RemoveDescriptor(
+            data->connected_descriptor->ReadDescriptor(), READ_FLAGS, false);
+        if (removed && m_export_map) {
+          (*m_export_map->GetIntegerVar(K_CONNECTED_DESCRIPTORS_VAR))--;
+        }
+        delete data->connected_descriptor;
+        data->connected_descriptor = NULL;
+      }
+    } else if (data->events) {
+      OLA_FATAL << "HUP event for " << data
+                << " but no write or connected descriptor found!";
+    }
+    return;
+  }
+
+  if (revents & POLLIN) {
+    if (data->read_descriptor) {
+      data->read_descriptor->PerformRead();
+    } else if (data->connected_descriptor) {
+      data->connected_descriptor->PerformRead();
+    }
+  }
+
+  if (revents & POLLOUT) {
+    // data->write_descriptor may be null here if this descriptor was
+    // removed by the read callback.
+    if (data->write_descriptor) {
+      data->write_descriptor->PerformWrite();
+    }
+  }
+}
+}  // namespace io
+}  // namespace ola
@@ -0,0 +1,184 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * IOUringPoller.h
+ * A Poller which uses io_uring.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef COMMON_IO_IOURINGPOLLER_H_
+#define COMMON_IO_IOURINGPOLLER_H_
+
+#include <ola/base/Macro.h>
+#include <ola/Clock.h>
+#include <ola/ExportMap.h>
+#include <ola/io/Descriptor.h>
+#include <linux/io_uring.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <utility>
+#include <vector>
+
+#include "common/io/PollerInterface.h"
+#include "common/io/TimeoutManager.h"
+
+namespace ola {
+namespace io {
+
+class IOUringData;
+class IOUringReceiver;
+class IOUringRequest;
+
+/**
+ * @class IOUringPoller
+ * @brief An implementation of PollerInterface that uses io_uring.
+ *
+ * Descriptors which accept received datagrams, i.e. UDP sockets, have a
+ * multishot recvmsg request on the ring. The kernel receives each datagram
+ * into a buffer from a ring of provided buffers, so there's no system call
+ * per datagram. The datagrams which arrive in a loop iteration are handed to
+ * the descriptor with ReadFileDescriptor::SetReceivedDatagrams() before
+ * PerformRead() runs, and the descriptor's reads then copy them out.
+ * PerformRead() is called until they've all been read, or a call reads none,
+ * in which case the rest are dropped since they're no longer on the socket.
+ *
+ * Every other descriptor has a poll request queued on the ring. These are
+ * one-shot and are re-armed after the callbacks run, which gives the same
+ * level-triggered behaviour as the other pollers.
+ *
+ * Changes to the requests are batched, and submitted with the same
+ * io_uring_enter() call that waits for completions, so a loop iteration
+ * costs a single system call no matter how many datagrams arrived, or how
+ * many descriptors became ready or were added & removed.
+ *
+ * Sends still go through the descriptors, since the callers expect the result
+ * straight away.
+ *
+ * io_uring needs Linux 5.11 or later, and may be disabled by seccomp
+ * policies, so Init() must be called to check it's usable. If the kernel
+ * can't do multishot receives (Linux 6.0), the UDP sockets are polled
+ * instead.
+ */
+class IOUringPoller : public PollerInterface {
+ public :
+  /**
+   * @brief Create a new IOUringPoller.
+   * @param export_map the ExportMap to use
+   * @param clock the Clock to use
+   */
+  IOUringPoller(ExportMap *export_map, Clock *clock);
+
+  ~IOUringPoller();
+
+  /**
+   * @brief Setup the ring.
+   * @returns true if io_uring is available, false otherwise.
+   */
+  bool Init();
+
+  bool AddReadDescriptor(class ReadFileDescriptor *descriptor);
+  bool AddReadDescriptor(class ConnectedDescriptor *descriptor,
+                         bool delete_on_close);
+  bool RemoveReadDescriptor(class ReadFileDescriptor *descriptor);
+  bool RemoveReadDescriptor(class ConnectedDescriptor *descriptor);
+
+  bool AddWriteDescriptor(class WriteFileDescriptor *descriptor);
+  bool RemoveWriteDescriptor(class WriteFileDescriptor *descriptor);
+
+  const TimeStamp *WakeUpTime() const { return &m_wake_up_time; }
+
+  bool Poll(TimeoutManager *timeout_manager,
+            const TimeInterval &poll_interval);
+
+ private:
+  typedef std::vector<IOUringData*> DescriptorList;
+  typedef std::vector<IOUringReceiver*> ReceiverList;
+
+  // Indexed by file descriptor, NULL if the descriptor isn't registered.
+  DescriptorList m_descriptors;
+  // Descriptors whose poll request needs to be updated.
+  DescriptorList m_changed_descriptors;
+  // Removed descriptors, which are deleted once there are no poll requests
+  // for them in flight.
+  DescriptorList m_orphaned_descriptors;
+  // Receivers with datagrams waiting to be handed to the descriptor.
+  ReceiverList m_ready_receivers;
+  // Removed receivers, which are deleted once their request has completed.
+  ReceiverList m_orphaned_receivers;
+
+  ExportMap *m_export_map;
+  CounterVariable *m_loop_iterations;
+  CounterVariable *m_loop_time;
+  Clock *m_clock;
+  TimeStamp m_wake_up_time;
+
+  int m_ring_fd;
+  void *m_ring;
+  size_t m_ring_size;
+  struct io_uring_sqe *m_sqes;
+  size_t m_sqes_size;
+  unsigned int m_sq_entries;
+  unsigned int *m_sq_head;
+  unsigned int *m_sq_tail;
+  unsigned int m_sq_mask;
+  unsigned int *m_cq_head;
+  unsigned int *m_cq_tail;
+  unsigned int m_cq_mask;
+  struct io_uring_cqe *m_cqes;
+  std::vector<struct io_uring_cqe> m_completions;
+
+  // The provided buffers for the receives, NULL if they aren't supported.
+  struct io_uring_buf_ring *m_buffer_ring;
+  uint8_t *m_buffers;
+  size_t m_buffers_size;
+  uint16_t m_buffer_tail;
+
+  bool SetupBuffers();
+  std::pair<IOUringData*, bool> LookupOrCreateDescriptor(int fd);
+  bool RemoveDescriptor(int fd, int event, bool warn_on_missing);
+  void DescriptorChanged(IOUringData *data);
+  void RemoveReceiver(IOUringData *data);
+
+  void ApplyChanges();
+  bool UpdatePoll(IOUringData *data);
+  bool UpdateReceive(IOUringData *data);
+  bool Cancel(const IOUringRequest *request);
+  void CleanupOrphans();
+  struct io_uring_sqe *NextSubmission();
+  void QueueSubmission();
+  int Enter(unsigned int min_complete, unsigned int flags, const void *arg,
+            size_t arg_size);
+  void ReapCompletions();
+  void HandleCompletion(const struct io_uring_cqe &cqe);
+  void HandleReceive(const struct io_uring_cqe &cqe,
+                     IOUringReceiver *receiver);
+  void DispatchDatagrams(IOUringReceiver *receiver);
+  void ReturnBuffer(uint16_t buffer_id);
+  void PublishBuffers();
+  void CheckDescriptor(uint32_t revents, IOUringData *data);
+
+  static const unsigned int RING_SIZE;
+  static const unsigned int BUFFER_COUNT;
+  static const unsigned int BUFFER_SIZE;
+  static const uint16_t BUFFER_GROUP;
+  static const uint32_t READ_FLAGS;
+  static const uint32_t WRITE_FLAGS;
+
+  DISALLOW_COPY_AND_ASSIGN(IOUringPoller);
+};
+}  // namespace io
+}  // namespace ola
+#endif  // COMMON_IO_IOURINGPOLLER_H_
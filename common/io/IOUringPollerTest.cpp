@@ -0,0 +1,526 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * IOUringPollerTest.cpp
+ * Test fixture for the IOUringPoller.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <memory>
+#include <string>
+
+#include "common/io/IOUringPoller.h"
+#include "common/io/TimeoutManager.h"
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/Logging.h"
+#include "ola/base/Array.h"
+#include "ola/io/Descriptor.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/network/Socket.h"
+#include "ola/network/SocketAddress.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::Clock;
+using ola::ExportMap;
+using ola::NewCallback;
+using ola::NewSingleCallback;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::io::ConnectedDescriptor;
+using ola::io::IOUringPoller;
+using ola::io::LoopbackDescriptor;
+using ola::io::PollerInterface;
+using ola::io::TimeoutManager;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+using ola::network::UDPDatagram;
+using ola::network::UDPSocket;
+using std::auto_ptr;
+using std::string;
+
+class IOUringPollerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(IOUringPollerTest);
+  CPPUNIT_TEST(testRead);
+  CPPUNIT_TEST(testLevelTriggered);
+  CPPUNIT_TEST(testWrite);
+  CPPUNIT_TEST(testRemoveInCallback);
+  CPPUNIT_TEST(testRemoteEndCloseWithDelete);
+  CPPUNIT_TEST(testTimeout);
+  CPPUNIT_TEST(testUDPReceive);
+  CPPUNIT_TEST(testUDPRecvBatch);
+  CPPUNIT_TEST(testUDPBurst);
+  CPPUNIT_TEST(testUDPRemoveInCallback);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  IOUringPollerTest()
+      : m_read_count(0),
+        m_write_count(0),
+        m_timeout_count(0),
+        m_datagram_count(0) {
+  }
+
+  void setUp();
+  void tearDown();
+
+  void testRead();
+  void testLevelTriggered();
+  void testWrite();
+  void testRemoveInCallback();
+  void testRemoteEndCloseWithDelete();
+  void testTimeout();
+  void testUDPReceive();
+  void testUDPRecvBatch();
+  void testUDPBurst();
+  void testUDPRemoveInCallback();
+
+ private:
+  Clock m_clock;
+  ExportMap m_export_map;
+  auto_ptr<TimeoutManager> m_timeout_manager;
+  auto_ptr<IOUringPoller> m_poller;
+  unsigned int m_read_count;
+  unsigned int m_write_count;
+  unsigned int m_timeout_count;
+  unsigned int m_datagram_count;
+  string m_last_datagram;
+  IPV4SocketAddress m_last_source;
+
+  void ReadOneByte(ConnectedDescriptor *descriptor) {
+    uint8_t data;
+    unsigned int size;
+    descriptor->Receive(&data, sizeof(data), size);
+    m_read_count++;
+  }
+
+  void ReadAndRemove(ConnectedDescriptor *descriptor) {
+    ReadOneByte(descriptor);
+    m_poller->RemoveReadDescriptor(descriptor);
+  }
+
+  void ReadDatagram(UDPSocket *socket) {
+    uint8_t data[64];
+    ssize_t size = sizeof(data);
+    if (socket->RecvFrom(data, &size, &m_last_source)) {
+      m_last_datagram.assign(reinterpret_cast<char*>(data), size);
+      m_datagram_count++;
+    }
+    m_read_count++;
+  }
+
+  void ReadBatch(UDPSocket *socket) {
+    uint8_t buffers[8][64];
+    UDPDatagram datagrams[8];
+    for (unsigned int i = 0; i < arraysize(datagrams); i++) {
+      datagrams[i].data = buffers[i];
+      datagrams[i].buffer_size = sizeof(buffers[i]);
+    }
+    unsigned int count;
+    while ((count = socket->RecvBatch(datagrams, arraysize(datagrams)))) {
+      m_datagram_count += count;
+    }
+    m_read_count++;
+  }
+
+  void ReadDatagramAndRemove(UDPSocket *socket) {
+    ReadDatagram(socket);
+    m_poller->RemoveReadDescriptor(socket);
+  }
+
+  void BindSocket(UDPSocket *socket, IPV4SocketAddress *address) {
+    OLA_ASSERT_TRUE(socket->Init());
+    OLA_ASSERT_TRUE(socket->Bind(
+        IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+    OLA_ASSERT_TRUE(socket->GetSocketAddress(address));
+  }
+
+  void Send(UDPSocket *socket, const IPV4SocketAddress &address,
+            const string &data) {
+    OLA_ASSERT_EQ(
+        static_cast<ssize_t>(data.size()),
+        socket->SendTo(reinterpret_cast<const uint8_t*>(data.data()),
+                       data.size(), address));
+  }
+
+  void Writeable() { m_write_count++; }
+  void Timeout() { m_timeout_count++; }
+
+  bool Available() {
+    if (m_poller.get()) {
+      return true;
+    }
+    OLA_INFO << "io_uring isn't available, skipping test";
+    return false;
+  }
+
+  bool Poll(unsigned int usec = 0) {
+    return m_poller->Poll(m_timeout_manager.get(), TimeInterval(0, usec));
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IOUringPollerTest);
+
+void IOUringPollerTest::setUp() {
+  ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  m_read_count = 0;
+  m_write_count = 0;
+  m_timeout_count = 0;
+  m_datagram_count = 0;
+  m_last_datagram.clear();
+  m_timeout_manager.reset(new TimeoutManager(NULL, &m_clock));
+  m_poller.reset(new IOUringPoller(&m_export_map, &m_clock));
+  if (!m_poller->Init()) {
+    m_poller.reset();
+  }
+}
+
+void IOUringPollerTest::tearDown() {
+  m_poller.reset();
+  m_timeout_manager.reset();
+}
+
+/*
+ * Check read events are delivered.
+ */
+void IOUringPollerTest::testRead() {
+  if (!Available()) {
+    return;
+  }
+
+  LoopbackDescriptor loopback;
+  OLA_ASSERT_TRUE(loopback.Init());
+  loopback.SetOnData(
+      NewCallback(this, &IOUringPollerTest::ReadOneByte,
+                  static_cast<ConnectedDescriptor*>(&loopback)));
+  OLA_ASSERT_TRUE(m_poller->AddReadDescriptor(&loopback, false));
+  OLA_ASSERT_FALSE(m_poller->AddReadDescriptor(&loopback, false));
+
+  OLA_ASSERT_TRUE(Poll());
+  OLA_ASSERT_EQ(0u, m_read_count);
+
+  const uint8_t data[] = {1};
+  loopback.Send(data, arraysize(data));
+  OLA_ASSERT_TRUE(Poll(100000));
+  OLA_ASSERT_EQ(1u, m_read_count);
+
+  // No more data
+  OLA_ASSERT_TRUE(Poll());
+  OLA_ASSERT_EQ(1u, m_read_count);
+
+  OLA_ASSERT_TRUE(m_poller->RemoveReadDescriptor(&loopback));
+  OLA_ASSERT_FALSE(m_poller->RemoveReadDescriptor(&loopback));
+
+  // Removed descriptors don't get events.
+  loopback.Send(data, arraysize(data));
+  OLA_ASSERT_TRUE(Poll());
+  OLA_ASSERT_TRUE(Poll());
+  OLA_ASSERT_EQ(1u, m_read_count);
+}
+
+/*
+ * Check that a descriptor which still has data is called again.
+ */
+void IOUringPollerTest::testLevelTriggered() {
+  if (!Available()) {
+    return;
+  }
+
+  LoopbackDescriptor loopback;
+  OLA_ASSERT_TRUE(loopback.Init());
+  loopback.SetOnData(
+      NewCallback(this, &IOUringPollerTest::ReadOneByte,
+                  static_cast<ConnectedDescriptor*>(&loopback)));
+  OLA_ASSERT_TRUE(m_poller->AddReadDescriptor(&loopback, false));
+
+  const uint8_t data[] = {1, 2, 3};
+  loopback.Send(data, arraysize(data));
+  for (unsigned int i = 0; i < 10 && m_read_count < 3; i++) {
+    OLA_ASSERT_TRUE(Poll(100000));
+  }
+  OLA_ASSERT_EQ(3u, m_read_count);
+  OLA_ASSERT_TRUE(m_poller->RemoveReadDescriptor(&loopback));
+}
+
+/*
+ * Check write events, and adding a write descriptor to a descriptor that's
+ * already in the read set.
+ */
+void IOUringPollerTest::testWrite() {
+  if (!Available()) {
+    return;
+  }
+
+  LoopbackDescriptor loopback;
+  OLA_ASSERT_TRUE(loopback.Init());
+  loopback.SetOnData(
+      NewCallback(this, &IOUringPollerTest::ReadOneByte,
+                  static_cast<ConnectedDescriptor*>(&loopback)));
+  loopback.SetOnWritable(NewCallback(this, &IOUringPollerTest::Writeable));
+  OLA_ASSERT_TRUE(m_poller->AddReadDescriptor(&loopback, false));
+  OLA_ASSERT_TRUE(Poll());
+
+  OLA_ASSERT_TRUE(m_poller->AddWriteDescriptor(&loopback));
+  OLA_ASSERT_FALSE(m_poller->AddWriteDescriptor(&loopback));
+  OLA_ASSERT_TRUE(Poll(100000));
+  OLA_ASSERT_EQ(1u, m_write_count);
+  OLA_ASSERT_EQ(0u, m_read_count);
+
+  OLA_ASSERT_TRUE(m_poller->RemoveWriteDescriptor(&loopback));
+  OLA_ASSERT_TRUE(Poll());
+  OLA_ASSERT_EQ(1u, m_write_count);
+
+  // The read descriptor still works.
+  const uint8_t data[] = {1};
+  loopback.Send(data, arraysize(data));
+  OLA_ASSERT_TRUE(Poll(100000));
+  OLA_ASSERT_EQ(1u, m_read_count);
+  OLA_ASSERT_TRUE(m_poller->RemoveReadDescriptor(&loopback));
+}
+
+/*
+ * Check a descriptor can remove itself from within the callback.
+ */
+void IOUringPollerTest::testRemoveInCallback() {
+  if (!Available()) {
+    return;
+  }
+
+  LoopbackDescriptor loopback;
+  OLA_ASSERT_TRUE(loopback.Init());
+  loopback.SetOnData(
+      NewCallback(this, &IOUringPollerTest::ReadAndRemove,
+                  static_cast<ConnectedDescriptor*>(&loopback)));
+  OLA_ASSERT_TRUE(m_poller->AddReadDescriptor(&loopback, false));
+
+  const uint8_t data[] = {1, 2};
+  loopback.Send(data, arraysize(data));
+  OLA_ASSERT_TRUE(Poll(100000));
+  OLA_ASSERT_TRUE(Poll());
+  OLA_ASSERT_EQ(1u, m_read_count);
+
+  // It can be added again.
+  OLA_ASSERT_TRUE(m_poller->AddReadDescriptor(&loopback, false));
+  OLA_ASSERT_TRUE(Poll(100000));
+  OLA_ASSERT_EQ(2u, m_read_count);
+}
+
+/*
+ * Check descriptors added with delete_on_close are deleted when the remote end
+ * closes.
+ */
+void IOUringPollerTest::testRemoteEndCloseWithDelete() {
+  if (!Available()) {
+    return;
+  }
+
+  LoopbackDescriptor *loopback = new LoopbackDescriptor();
+  OLA_ASSERT_TRUE(loopback->Init());
+  OLA_ASSERT_TRUE(m_poller->AddReadDescriptor(loopback, true));
+  (*m_export_map.GetIntegerVar(
+      PollerInterface::K_CONNECTED_DESCRIPTORS_VAR))++;
+
+  loopback->CloseClient();
+  OLA_ASSERT_TRUE(Poll(100000));
+  OLA_ASSERT_EQ(0, m_export_map.GetIntegerVar(
+      PollerInterface::K_CONNECTED_DESCRIPTORS_VAR)->Get());
+}
+
+/*
+ * Check timeouts run, and that we don't block for longer than the poll
+ * interval.
+ */
+void IOUringPollerTest::testTimeout() {
+  if (!Available()) {
+    return;
+  }
+
+  m_timeout_manager->RegisterSingleTimeout(
+      TimeInterval(0, 10000),
+      NewSingleCallback(this, &IOUringPollerTest::Timeout));
+
+  TimeStamp start, end;
+  m_clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < 100 && !m_timeout_count; i++) {
+    OLA_ASSERT_TRUE(Poll(1000000));
+  }
+  m_clock.CurrentTime(&end);
+  OLA_ASSERT_EQ(1u, m_timeout_count);
+  OLA_ASSERT_LT(end - start, TimeInterval(0, 500000));
+
+  // A zero interval doesn't block.
+  m_clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < 100; i++) {
+    OLA_ASSERT_TRUE(Poll());
+  }
+  m_clock.CurrentTime(&end);
+  OLA_ASSERT_LT(end - start, TimeInterval(0, 100000));
+}
+
+
+/*
+ * Check datagrams are delivered to UDP sockets, and that RecvFrom() reports
+ * the payload and the source.
+ */
+void IOUringPollerTest::testUDPReceive() {
+  if (!Available()) {
+    return;
+  }
+
+  UDPSocket socket, client;
+  IPV4SocketAddress address, client_address;
+  BindSocket(&socket, &address);
+  BindSocket(&client, &client_address);
+  socket.SetOnData(
+      NewCallback(this, &IOUringPollerTest::ReadDatagram, &socket));
+  OLA_ASSERT_TRUE(m_poller->AddReadDescriptor(&socket));
+  OLA_ASSERT_TRUE(Poll());
+  OLA_ASSERT_EQ(0u, m_read_count);
+
+  Send(&client, address, "foo");
+  for (unsigned int i = 0; i < 10 && !m_datagram_count; i++) {
+    OLA_ASSERT_TRUE(Poll(100000));
+  }
+  OLA_ASSERT_EQ(1u, m_datagram_count);
+  OLA_ASSERT_EQ(string("foo"), m_last_datagram);
+  OLA_ASSERT_EQ(client_address, m_last_source);
+
+  // Two datagrams, the callback reads one per call.
+  Send(&client, address, "bar");
+  Send(&client, address, "bazz");
+  for (unsigned int i = 0; i < 10 && m_datagram_count < 3; i++) {
+    OLA_ASSERT_TRUE(Poll(100000));
+  }
+  OLA_ASSERT_EQ(3u, m_datagram_count);
+  OLA_ASSERT_EQ(string("bazz"), m_last_datagram);
+  OLA_ASSERT_EQ(0u, socket.UnreadDatagrams());
+
+  OLA_ASSERT_TRUE(m_poller->RemoveReadDescriptor(&socket));
+
+  // Once removed, the socket reads from the kernel again.
+  Send(&client, address, "qux");
+  OLA_ASSERT_TRUE(Poll());
+  OLA_ASSERT_EQ(3u, m_datagram_count);
+  ReadDatagram(&socket);
+  OLA_ASSERT_EQ(4u, m_datagram_count);
+  OLA_ASSERT_EQ(string("qux"), m_last_datagram);
+}
+
+/*
+ * Check RecvBatch() gets the datagrams from the completion queue.
+ */
+void IOUringPollerTest::testUDPRecvBatch() {
+  if (!Available()) {
+    return;
+  }
+
+  UDPSocket socket, client;
+  IPV4SocketAddress address, client_address;
+  BindSocket(&socket, &address);
+  BindSocket(&client, &client_address);
+  socket.SetOnData(
+      NewCallback(this, &IOUringPollerTest::ReadBatch, &socket));
+  OLA_ASSERT_TRUE(m_poller->AddReadDescriptor(&socket));
+
+  for (unsigned int i = 0; i < 20; i++) {
+    Send(&client, address, "datagram");
+  }
+  for (unsigned int i = 0; i < 20 && m_datagram_count < 20; i++) {
+    OLA_ASSERT_TRUE(Poll(100000));
+  }
+  OLA_ASSERT_EQ(20u, m_datagram_count);
+  OLA_ASSERT_TRUE(m_poller->RemoveReadDescriptor(&socket));
+}
+
+/*
+ * Check a burst that's larger than the buffer ring is delivered, this runs
+ * the ring dry and the receive has to be re-armed.
+ */
+void IOUringPollerTest::testUDPBurst() {
+  if (!Available()) {
+    return;
+  }
+
+  UDPSocket socket, client;
+  IPV4SocketAddress address, client_address;
+  BindSocket(&socket, &address);
+  BindSocket(&client, &client_address);
+  // The default buffer only holds a couple of hundred small datagrams.
+  OLA_ASSERT_TRUE(socket.SetReceiveBufferSize(1 << 20));
+  socket.SetOnData(
+      NewCallback(this, &IOUringPollerTest::ReadBatch, &socket));
+  OLA_ASSERT_TRUE(m_poller->AddReadDescriptor(&socket));
+
+  // This is larger than the poller's buffer ring.
+  const unsigned int BURST = 600;
+  for (unsigned int i = 0; i < BURST; i++) {
+    Send(&client, address, "datagram");
+  }
+  for (unsigned int i = 0; i < 100 && m_datagram_count < BURST; i++) {
+    OLA_ASSERT_TRUE(Poll(100000));
+  }
+  OLA_ASSERT_EQ(BURST, m_datagram_count);
+
+  // And it keeps working afterwards.
+  Send(&client, address, "datagram");
+  for (unsigned int i = 0; i < 10 && m_datagram_count <= BURST; i++) {
+    OLA_ASSERT_TRUE(Poll(100000));
+  }
+  OLA_ASSERT_EQ(BURST + 1, m_datagram_count);
+  OLA_ASSERT_TRUE(m_poller->RemoveReadDescriptor(&socket));
+}
+
+/*
+ * Check a UDP socket can remove itself from within the callback, while it
+ * still has datagrams queued.
+ */
+void IOUringPollerTest::testUDPRemoveInCallback() {
+  if (!Available()) {
+    return;
+  }
+
+  UDPSocket socket, client;
+  IPV4SocketAddress address, client_address;
+  BindSocket(&socket, &address);
+  BindSocket(&client, &client_address);
+  socket.SetOnData(
+      NewCallback(this, &IOUringPollerTest::ReadDatagramAndRemove, &socket));
+  OLA_ASSERT_TRUE(m_poller->AddReadDescriptor(&socket));
+
+  Send(&client, address, "foo");
+  Send(&client, address, "bar");
+  for (unsigned int i = 0; i < 10 && !m_datagram_count; i++) {
+    OLA_ASSERT_TRUE(Poll(100000));
+  }
+  OLA_ASSERT_TRUE(Poll());
+  OLA_ASSERT_EQ(1u, m_read_count);
+  OLA_ASSERT_EQ(string("foo"), m_last_datagram);
+  OLA_ASSERT_EQ(0u, socket.UnreadDatagrams());
+
+  // It can be added again. The second datagram may have been taken by the
+  // ring already, in which case it's dropped.
+  socket.SetOnData(
+      NewCallback(this, &IOUringPollerTest::ReadDatagram, &socket));
+  OLA_ASSERT_TRUE(m_poller->AddReadDescriptor(&socket));
+  Send(&client, address, "bazz");
+  for (unsigned int i = 0; i < 10 && m_last_datagram != "bazz"; i++) {
+    OLA_ASSERT_TRUE(Poll(100000));
+  }
+  OLA_ASSERT_EQ(string("bazz"), m_last_datagram);
+  OLA_ASSERT_TRUE(m_poller->RemoveReadDescriptor(&socket));
+}
@@ -38,6 +38,19 @@ common_libolacommon_la_SOURCES += \
     common/io/KQueuePoller.cpp
 endif
 
+if HAVE_IO_URING
+common_libolacommon_la_SOURCES += \
+    common/io/IOUringPoller.h \
+    common/io/IOUringPoller.cpp
+endif
+
+# PROGRAMS
+##################################################
+noinst_PROGRAMS += common/io/timeout_manager_benchmark
+common_io_timeout_manager_benchmark_SOURCES = \
+    common/io/timeout_manager_benchmark.cpp
+common_io_timeout_manager_benchmark_LDADD = common/libolacommon.la
+
 # TESTS
 ##################################################
 test_programs += \
@@ -78,3 +91,19 @@ common_io_StreamTester_SOURCES = common/io/InputStreamTest.cpp \
                                  common/io/OutputStreamTest.cpp
 common_io_StreamTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_io_StreamTester_LDADD = $(COMMON_TESTING_LIBS)
+
+if HAVE_EPOLL
+test_programs += common/io/EPollerTester
+
+common_io_EPollerTester_SOURCES = common/io/EPollerTest.cpp
+common_io_EPollerTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_io_EPollerTester_LDADD = $(COMMON_TESTING_LIBS)
+endif
+
+if HAVE_IO_URING
+test_programs += common/io/IOUringPollerTester
+
+common_io_IOUringPollerTester_SOURCES = common/io/IOUringPollerTest.cpp
+common_io_IOUringPollerTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_io_IOUringPollerTester_LDADD = $(COMMON_TESTING_LIBS)
+endif
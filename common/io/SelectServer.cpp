@@ -34,6 +34,7 @@
 #include <errno.h>
 
 #include <algorithm>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -56,6 +57,18 @@
 #include "common/io/EPoller.h"
 DEFINE_default_bool(use_epoll, true,
                     "Disable the use of epoll(), revert to select()");
+DEFINE_uint32(epoll_max_events, ola::io::EPoller::DEFAULT_MAX_EVENTS,
+              "The maximum number of events to handle per call to epoll()");
+DEFINE_default_bool(descriptor_stats, false,
+                    "Export the time spent handling events for each "
+                    "descriptor, requires epoll()");
+#endif
+
+#ifdef HAVE_IO_URING
+#include "common/io/IOUringPoller.h"
+DEFINE_default_bool(use_io_uring, false,
+                    "Use io_uring rather than epoll(), if the kernel supports "
+                    "it");
 #endif
 
 #ifdef HAVE_KQUEUE
@@ -297,12 +310,34 @@ void SelectServer::Init(const Options &options) {
   (void) options;
 #else
 
+#ifdef HAVE_IO_URING
+  bool using_io_uring = false;
+  if (FLAGS_use_io_uring && !options.force_select) {
+    std::auto_ptr<IOUringPoller> poller(
+        new IOUringPoller(m_export_map, m_clock));
+    if (poller->Init()) {
+      m_poller.reset(poller.release());
+      using_io_uring = true;
+    } else {
+      OLA_WARN << "io_uring isn't available, falling back";
+    }
+  }
+  if (m_export_map) {
+    m_export_map->GetBoolVar("using-io-uring")->Set(using_io_uring);
+  }
+#endif
+
 #ifdef HAVE_EPOLL
-  if (FLAGS_use_epoll && !options.force_select) {
-    m_poller.reset(new EPoller(m_export_map, m_clock));
+  bool using_epoll = false;
+  if (FLAGS_use_epoll && !m_poller.get() && !options.force_select) {
+    EPoller::Options epoll_options;
+    epoll_options.max_events = FLAGS_epoll_max_events;
+    epoll_options.descriptor_stats = FLAGS_descriptor_stats;
+    m_poller.reset(new EPoller(m_export_map, m_clock, epoll_options));
+    using_epoll = true;
   }
   if (m_export_map) {
-    m_export_map->GetBoolVar("using-epoll")->Set(FLAGS_use_epoll);
+    m_export_map->GetBoolVar("using-epoll")->Set(using_epoll);
   }
 #endif
 
@@ -18,11 +18,11 @@
  * Copyright (C) 2013 Simon Newton
  */
 
-#include <queue>
-#include <set>
+#include <deque>
 #include <vector>
 
 #include "ola/Logging.h"
+#include "ola/stl/STLUtils.h"
 #include "common/io/TimeoutManager.h"
 
 namespace ola {
@@ -39,19 +39,16 @@ using ola::thread::timeout_id;
 TimeoutManager::TimeoutManager(ExportMap *export_map,
                                Clock *clock)
     : m_export_map(export_map),
-      m_clock(clock) {
+      m_clock(clock),
+      m_running_event(NULL) {
   if (m_export_map) {
     m_export_map->GetIntegerVar(K_TIMER_VAR);
   }
 }
 
 TimeoutManager::~TimeoutManager() {
-  m_removed_timeouts.clear();
-
-  while (!m_events.empty()) {
-    delete m_events.top();
-    m_events.pop();
-  }
+  STLDeleteElements(&m_heap);
+  STLDeleteElements(&m_free_events);
 }
 
 timeout_id TimeoutManager::RegisterRepeatingTimeout(
@@ -63,8 +60,11 @@ timeout_id TimeoutManager::RegisterRepeatingTimeout(
   if (m_export_map)
     (*m_export_map->GetIntegerVar(K_TIMER_VAR))++;
 
-  Event *event = new RepeatingEvent(interval, m_clock, closure);
-  m_events.push(event);
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  Event *event = NewEvent();
+  event->InitRepeating(interval, now, closure);
+  PushEvent(event);
   return event;
 }
 
@@ -77,54 +77,131 @@ timeout_id TimeoutManager::RegisterSingleTimeout(
   if (m_export_map)
     (*m_export_map->GetIntegerVar(K_TIMER_VAR))++;
 
-  Event *event = new SingleEvent(interval, m_clock, closure);
-  m_events.push(event);
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  Event *event = NewEvent();
+  event->InitSingle(interval, now, closure);
+  PushEvent(event);
   return event;
 }
 
 void TimeoutManager::CancelTimeout(timeout_id id) {
-  // TODO(simon): just mark the timeouts as cancelled rather than using a
-  // remove set.
   if (id == INVALID_TIMEOUT)
     return;
 
-  if (!m_removed_timeouts.insert(id).second)
-    OLA_WARN << "timeout " << id << " already in remove set";
+  Event *event = reinterpret_cast<Event*>(id);
+  if (event == m_running_event) {
+    // The event is cancelling itself, ExecuteTimeouts() will clean up.
+    event->cancelled = true;
+    return;
+  }
+
+  if (event->heap_index == Event::NOT_IN_HEAP) {
+    OLA_WARN << "timeout " << id << " has already been removed";
+    return;
+  }
+
+  RemoveEvent(event);
+  ReleaseEvent(event);
 }
 
 TimeInterval TimeoutManager::ExecuteTimeouts(TimeStamp *now) {
-  Event *e;
-  if (m_events.empty())
-    return TimeInterval();
+  while (!m_heap.empty() && m_heap.front()->NextTime() <= *now) {
+    Event *e = m_heap.front();
+    RemoveEvent(e);
 
-  for (e = m_events.top(); !m_events.empty() && (e->NextTime() <= *now);
-       e = m_events.top()) {
-    m_events.pop();
+    m_running_event = e;
+    bool run_again = e->Trigger();
+    m_running_event = NULL;
 
-    // if this was removed, skip it
-    if (m_removed_timeouts.erase(e)) {
-      delete e;
-      if (m_export_map)
-        (*m_export_map->GetIntegerVar(K_TIMER_VAR))--;
-      continue;
-    }
-
-    if (e->Trigger()) {
-      // true implies we need to run this again
+    if (run_again && !e->cancelled) {
       e->UpdateTime(*now);
-      m_events.push(e);
+      PushEvent(e);
     } else {
-      delete e;
-      if (m_export_map)
-        (*m_export_map->GetIntegerVar(K_TIMER_VAR))--;
+      ReleaseEvent(e);
     }
     m_clock->CurrentTime(now);
   }
 
-  if (m_events.empty())
+  if (m_heap.empty())
     return TimeInterval();
   else
-    return m_events.top()->NextTime() - *now;
+    return m_heap.front()->NextTime() - *now;
+}
+
+TimeoutManager::Event *TimeoutManager::NewEvent() {
+  if (m_free_events.empty())
+    return new Event();
+
+  Event *event = m_free_events.front();
+  m_free_events.pop_front();
+  return event;
+}
+
+/*
+ * Called when an event is no longer in use.
+ */
+void TimeoutManager::ReleaseEvent(Event *event) {
+  if (m_export_map)
+    (*m_export_map->GetIntegerVar(K_TIMER_VAR))--;
+
+  event->Clear();
+  m_free_events.push_back(event);
+}
+
+void TimeoutManager::PushEvent(Event *event) {
+  m_heap.push_back(event);
+  event->heap_index = m_heap.size() - 1;
+  SiftUp(event->heap_index);
+}
+
+void TimeoutManager::RemoveEvent(Event *event) {
+  size_t index = event->heap_index;
+  Event *last = m_heap.back();
+  m_heap.pop_back();
+  event->heap_index = Event::NOT_IN_HEAP;
+
+  if (last != event) {
+    // Move the last event into the hole, it may need to go either way.
+    SetHeapEntry(index, last);
+    SiftUp(index);
+    SiftDown(last->heap_index);
+  }
+}
+
+void TimeoutManager::SiftUp(size_t index) {
+  Event *event = m_heap[index];
+  while (index > 0) {
+    size_t parent = (index - 1) / 2;
+    if (m_heap[parent]->NextTime() <= event->NextTime())
+      break;
+    SetHeapEntry(index, m_heap[parent]);
+    index = parent;
+  }
+  SetHeapEntry(index, event);
+}
+
+void TimeoutManager::SiftDown(size_t index) {
+  Event *event = m_heap[index];
+  const size_t size = m_heap.size();
+  while (true) {
+    size_t child = 2 * index + 1;
+    if (child >= size)
+      break;
+    if (child + 1 < size &&
+        m_heap[child + 1]->NextTime() < m_heap[child]->NextTime())
+      child++;
+    if (event->NextTime() <= m_heap[child]->NextTime())
+      break;
+    SetHeapEntry(index, m_heap[child]);
+    index = child;
+  }
+  SetHeapEntry(index, event);
+}
+
+void TimeoutManager::SetHeapEntry(size_t index, Event *event) {
+  m_heap[index] = event;
+  event->heap_index = index;
 }
 }  // namespace io
 }  // namespace ola
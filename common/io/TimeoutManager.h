@@ -21,8 +21,7 @@
 #ifndef COMMON_IO_TIMEOUTMANAGER_H_
 #define COMMON_IO_TIMEOUTMANAGER_H_
 
-#include <queue>
-#include <set>
+#include <deque>
 #include <vector>
 
 #include "ola/Callback.h"
@@ -85,11 +84,10 @@ class TimeoutManager {
 
   /**
    * @brief Check if there are any events in the queue.
-   * Events remain in the queue even if they have been cancelled.
    * @returns true if there are events pending, false otherwise.
    */
   bool EventsPending() const {
-    return !m_events.empty();
+    return !m_heap.empty();
   }
 
   /**
@@ -103,95 +101,101 @@ class TimeoutManager {
   static const char K_TIMER_VAR[];
 
  private :
+  /*
+   * A single or repeating event. Events live in an intrusive binary heap,
+   * ordered by the time they next trigger, and know their own position in
+   * the heap so they can be removed as soon as they're cancelled.
+   *
+   * Events are pooled, since timeouts are registered and cancelled at a high
+   * rate. They're never freed until the TimeoutManager is destroyed, so
+   * cancelling a timeout that has already run is safe, as it was before.
+   */
   class Event {
    public:
-    explicit Event(const TimeInterval &interval, const Clock *clock)
-        : m_interval(interval) {
-      TimeStamp now;
-      clock->CurrentTime(&now);
-      m_next = now + m_interval;
+    Event()
+        : heap_index(NOT_IN_HEAP),
+          cancelled(false),
+          m_single_closure(NULL),
+          m_repeating_closure(NULL) {
     }
-    virtual ~Event() {}
-    virtual bool Trigger() = 0;
+    ~Event() { Clear(); }
 
-    void UpdateTime(const TimeStamp &now) {
-      m_next = now + m_interval;
+    void InitSingle(const TimeInterval &interval, const TimeStamp &now,
+                    ola::BaseCallback0<void> *closure) {
+      Init(interval, now);
+      m_single_closure = closure;
     }
 
-    TimeStamp NextTime() const { return m_next; }
-
-   private:
-    TimeInterval m_interval;
-    TimeStamp m_next;
-  };
-
-  // An event that only happens once
-  class SingleEvent: public Event {
-   public:
-    SingleEvent(const TimeInterval &interval,
-                const Clock *clock,
-                ola::BaseCallback0<void> *closure):
-      Event(interval, clock),
-      m_closure(closure) {
-    }
-
-    virtual ~SingleEvent() {
-      if (m_closure)
-        delete m_closure;
+    void InitRepeating(const TimeInterval &interval, const TimeStamp &now,
+                       ola::BaseCallback0<bool> *closure) {
+      Init(interval, now);
+      m_repeating_closure = closure;
     }
 
+    // Returns true if the event should be run again.
     bool Trigger() {
-      if (m_closure) {
-        m_closure->Run();
-        // it's deleted itself at this point
-        m_closure = NULL;
+      if (m_single_closure) {
+        ola::BaseCallback0<void> *closure = m_single_closure;
+        // The closure deletes itself.
+        m_single_closure = NULL;
+        closure->Run();
+        return false;
       }
-      return false;
+      return m_repeating_closure ? m_repeating_closure->Run() : false;
     }
 
-   private:
-     ola::BaseCallback0<void> *m_closure;
-  };
-
-  /*
-   * An event that occurs more than once. The closure can return false to
-   * indicate that it should not be called again.
-   */
-  class RepeatingEvent: public Event {
-   public:
-    RepeatingEvent(const TimeInterval &interval,
-                   const Clock *clock,
-                   ola::BaseCallback0<bool> *closure):
-      Event(interval, clock),
-      m_closure(closure) {
-    }
-    ~RepeatingEvent() {
-      delete m_closure;
+    void UpdateTime(const TimeStamp &now) {
+      m_next = now + m_interval;
     }
-    bool Trigger() {
-      if (!m_closure)
-        return false;
-      return m_closure->Run();
+
+    const TimeStamp &NextTime() const { return m_next; }
+
+    // Delete any closure, ready for the Event to be reused.
+    void Clear() {
+      delete m_single_closure;
+      delete m_repeating_closure;
+      m_single_closure = NULL;
+      m_repeating_closure = NULL;
+      cancelled = false;
     }
 
+    static const size_t NOT_IN_HEAP = static_cast<size_t>(-1);
+
+    size_t heap_index;
+    bool cancelled;
+
    private:
-    ola::BaseCallback0<bool> *m_closure;
-  };
+    TimeInterval m_interval;
+    TimeStamp m_next;
+    ola::BaseCallback0<void> *m_single_closure;
+    ola::BaseCallback0<bool> *m_repeating_closure;
 
-  struct ltevent {
-    bool operator()(Event *e1, Event *e2) const {
-      return e1->NextTime() > e2->NextTime();
+    void Init(const TimeInterval &interval, const TimeStamp &now) {
+      m_interval = interval;
+      m_next = now + interval;
     }
+
+    DISALLOW_COPY_AND_ASSIGN(Event);
   };
 
-  typedef std::priority_queue<Event*, std::vector<Event*>, ltevent>
-      event_queue_t;
+  typedef std::vector<Event*> EventVector;
 
   ola::ExportMap *m_export_map;
   Clock *m_clock;
 
-  event_queue_t m_events;
-  std::set<ola::thread::timeout_id> m_removed_timeouts;
+  EventVector m_heap;
+  // Unused events, reused oldest first.
+  std::deque<Event*> m_free_events;
+  // The event that is being triggered, or NULL.
+  Event *m_running_event;
+
+  Event *NewEvent();
+  void ReleaseEvent(Event *event);
+  void PushEvent(Event *event);
+  void RemoveEvent(Event *event);
+  void SiftUp(size_t index);
+  void SiftDown(size_t index);
+  void SetHeapEntry(size_t index, Event *event);
 
   DISALLOW_COPY_AND_ASSIGN(TimeoutManager);
 };
@@ -21,6 +21,7 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include <map>
+#include <vector>
 
 #include "common/io/TimeoutManager.h"
 #include "ola/Callback.h"
@@ -44,6 +45,8 @@ class TimeoutManagerTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testRepeatingTimeouts);
   CPPUNIT_TEST(testAbortedRepeatingTimeouts);
   CPPUNIT_TEST(testPendingEventShutdown);
+  CPPUNIT_TEST(testOrdering);
+  CPPUNIT_TEST(testCancelFromCallback);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -51,6 +54,8 @@ class TimeoutManagerTest: public CppUnit::TestFixture {
     void testRepeatingTimeouts();
     void testAbortedRepeatingTimeouts();
     void testPendingEventShutdown();
+    void testOrdering();
+    void testCancelFromCallback();
 
     void HandleEvent(unsigned int event_id) {
       m_event_counters[event_id]++;
@@ -67,6 +72,16 @@ class TimeoutManagerTest: public CppUnit::TestFixture {
       return m_event_counters[event_id] < 2;
     }
 
+    void RecordEvent(unsigned int event_id) {
+      m_event_order.push_back(event_id);
+    }
+
+    bool CancelSelf(TimeoutManager *timeout_manager, timeout_id *id) {
+      m_event_counters[0]++;
+      timeout_manager->CancelTimeout(*id);
+      return true;
+    }
+
     unsigned int GetEventCounter(unsigned int event_id) {
       return m_event_counters[event_id];
     }
@@ -74,6 +89,7 @@ class TimeoutManagerTest: public CppUnit::TestFixture {
  private:
     ExportMap m_map;
     std::map<unsigned int, unsigned int> m_event_counters;
+    std::vector<unsigned int> m_event_order;
 };
 
 
@@ -241,3 +257,74 @@ void TimeoutManagerTest::testPendingEventShutdown() {
 
   OLA_ASSERT_TRUE(timeout_manager.EventsPending());
 }
+
+
+/*
+ * Check events run in order, and cancelled events are removed straight away.
+ */
+void TimeoutManagerTest::testOrdering() {
+  MockClock clock;
+  TimeoutManager timeout_manager(&m_map, &clock);
+
+  // Register in a scrambled order, cancelling every third one.
+  const unsigned int EVENT_COUNT = 50;
+  std::vector<timeout_id> ids;
+  for (unsigned int i = 0; i < EVENT_COUNT; i++) {
+    unsigned int delay = (i * 17) % EVENT_COUNT + 1;
+    ids.push_back(timeout_manager.RegisterSingleTimeout(
+        TimeInterval(0, delay * 1000),
+        NewSingleCallback(this, &TimeoutManagerTest::RecordEvent, delay)));
+  }
+  for (unsigned int i = 0; i < EVENT_COUNT; i += 3) {
+    timeout_manager.CancelTimeout(ids[i]);
+  }
+  OLA_ASSERT_EQ(static_cast<int>(EVENT_COUNT - (EVENT_COUNT + 2) / 3),
+                m_map.GetIntegerVar(TimeoutManager::K_TIMER_VAR)->Get());
+
+  // Events registered after the cancellations reuse the cancelled events.
+  timeout_manager.RegisterSingleTimeout(
+      TimeInterval(0, 500),
+      NewSingleCallback(this, &TimeoutManagerTest::RecordEvent, 0u));
+
+  TimeStamp now;
+  clock.AdvanceTime(1, 0);
+  clock.CurrentTime(&now);
+  TimeInterval next = timeout_manager.ExecuteTimeouts(&now);
+  OLA_ASSERT_TRUE(next.IsZero());
+  OLA_ASSERT_FALSE(timeout_manager.EventsPending());
+  OLA_ASSERT_EQ(0, m_map.GetIntegerVar(TimeoutManager::K_TIMER_VAR)->Get());
+
+  OLA_ASSERT_EQ(static_cast<size_t>(EVENT_COUNT - (EVENT_COUNT + 2) / 3 + 1),
+                m_event_order.size());
+  OLA_ASSERT_EQ(0u, m_event_order[0]);
+  for (unsigned int i = 1; i < m_event_order.size(); i++) {
+    OLA_ASSERT_LT(m_event_order[i - 1], m_event_order[i]);
+  }
+}
+
+
+/*
+ * Check a repeating timeout can cancel itself.
+ */
+void TimeoutManagerTest::testCancelFromCallback() {
+  MockClock clock;
+  TimeoutManager timeout_manager(&m_map, &clock);
+
+  timeout_id id = ola::thread::INVALID_TIMEOUT;
+  id = timeout_manager.RegisterRepeatingTimeout(
+      TimeInterval(1, 0),
+      NewCallback(this, &TimeoutManagerTest::CancelSelf, &timeout_manager,
+                  &id));
+
+  TimeStamp now;
+  clock.AdvanceTime(1, 1);
+  clock.CurrentTime(&now);
+  timeout_manager.ExecuteTimeouts(&now);
+  OLA_ASSERT_EQ(1u, GetEventCounter(0));
+  OLA_ASSERT_FALSE(timeout_manager.EventsPending());
+
+  clock.AdvanceTime(1, 0);
+  clock.CurrentTime(&now);
+  timeout_manager.ExecuteTimeouts(&now);
+  OLA_ASSERT_EQ(1u, GetEventCounter(0));
+}
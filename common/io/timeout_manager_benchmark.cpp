@@ -0,0 +1,216 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * timeout_manager_benchmark.cpp
+ * Compare the TimeoutManager with the priority_queue & remove set it used
+ * to be built on.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "common/io/TimeoutManager.h"
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+
+using ola::Clock;
+using ola::MockClock;
+using ola::NewSingleCallback;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::io::TimeoutManager;
+using ola::thread::timeout_id;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+DEFINE_s_uint32(timeouts, t, 10000,
+                "The number of timeouts to register in each round");
+DEFINE_s_uint32(rounds, r, 100, "The number of rounds to run");
+
+/*
+ * The TimeoutManager as it used to be: one heap allocation per timeout, a
+ * priority_queue and lazy cancellation using a set. Only single timeouts are
+ * needed for the benchmark.
+ */
+class LegacyTimeoutManager {
+ public:
+  explicit LegacyTimeoutManager(Clock *clock) : m_clock(clock) {}
+
+  ~LegacyTimeoutManager() {
+    while (!m_events.empty()) {
+      delete m_events.top();
+      m_events.pop();
+    }
+  }
+
+  timeout_id RegisterSingleTimeout(const TimeInterval &interval,
+                                   ola::SingleUseCallback0<void> *closure) {
+    TimeStamp now;
+    m_clock->CurrentTime(&now);
+    Event *event = new Event(now + interval, closure);
+    m_events.push(event);
+    return event;
+  }
+
+  void CancelTimeout(timeout_id id) {
+    m_removed_timeouts.insert(id);
+  }
+
+  void ExecuteTimeouts(TimeStamp *now) {
+    while (!m_events.empty() && m_events.top()->next <= *now) {
+      Event *e = m_events.top();
+      m_events.pop();
+      if (!m_removed_timeouts.erase(e)) {
+        e->closure->Run();
+        e->closure = NULL;
+      }
+      delete e;
+      m_clock->CurrentTime(now);
+    }
+  }
+
+ private:
+  struct Event {
+    Event(const TimeStamp &next, ola::SingleUseCallback0<void> *closure)
+        : next(next), closure(closure) {}
+    ~Event() { delete closure; }
+
+    TimeStamp next;
+    ola::SingleUseCallback0<void> *closure;
+  };
+
+  struct ltevent {
+    bool operator()(Event *e1, Event *e2) const {
+      return e1->next > e2->next;
+    }
+  };
+
+  Clock *m_clock;
+  std::priority_queue<Event*, vector<Event*>, ltevent> m_events;
+  std::set<timeout_id> m_removed_timeouts;
+};
+
+static unsigned int s_expired = 0;
+
+void Expired() {
+  s_expired++;
+}
+
+/*
+ * Register timeouts with a spread of delays.
+ */
+template <typename Manager>
+void RegisterTimeouts(Manager *manager, vector<timeout_id> *ids) {
+  ids->clear();
+  for (unsigned int i = 0; i < FLAGS_timeouts; i++) {
+    ids->push_back(manager->RegisterSingleTimeout(
+        TimeInterval(0, 1000 + (i * 7919) % 1000000),
+        NewSingleCallback(Expired)));
+  }
+}
+
+/*
+ * Register timeouts and cancel them before they expire, like RDM requests
+ * that get a response.
+ */
+template <typename Manager>
+void RegisterAndCancel(Manager *manager, MockClock *clock) {
+  vector<timeout_id> ids;
+  for (unsigned int round = 0; round < FLAGS_rounds; round++) {
+    RegisterTimeouts(manager, &ids);
+    vector<timeout_id>::const_iterator iter = ids.begin();
+    for (; iter != ids.end(); ++iter) {
+      manager->CancelTimeout(*iter);
+    }
+    // The legacy manager only frees cancelled timeouts when they would have
+    // expired.
+    clock->AdvanceTime(1, 0);
+    TimeStamp now;
+    clock->CurrentTime(&now);
+    manager->ExecuteTimeouts(&now);
+  }
+}
+
+/*
+ * Register timeouts and let them all expire.
+ */
+template <typename Manager>
+void RegisterAndExpire(Manager *manager, MockClock *clock) {
+  vector<timeout_id> ids;
+  for (unsigned int round = 0; round < FLAGS_rounds; round++) {
+    RegisterTimeouts(manager, &ids);
+    clock->AdvanceTime(1, 0);
+    TimeStamp now;
+    clock->CurrentTime(&now);
+    manager->ExecuteTimeouts(&now);
+  }
+}
+
+template <typename Manager>
+void RunBenchmark(const string &description,
+                  void (*benchmark)(Manager*, MockClock*)) {
+  MockClock mock_clock;
+  Manager manager(&mock_clock);
+
+  Clock clock;
+  TimeStamp start, end;
+  s_expired = 0;
+  clock.CurrentTime(&start);
+  benchmark(&manager, &mock_clock);
+  clock.CurrentTime(&end);
+
+  uint64_t operations = static_cast<uint64_t>(FLAGS_rounds) * FLAGS_timeouts;
+  double ns_per_timeout = (end - start).AsInt() * 1000.0 / operations;
+  cout << std::left << std::setw(32) << description << std::right
+       << std::setw(10) << std::fixed << std::setprecision(1)
+       << ns_per_timeout << " ns/timeout (" << s_expired << " expired)"
+       << endl;
+}
+
+/*
+ * The current TimeoutManager, with the same constructor as the legacy one.
+ */
+class CurrentTimeoutManager : public TimeoutManager {
+ public:
+  explicit CurrentTimeoutManager(Clock *clock)
+      : TimeoutManager(NULL, clock) {}
+};
+
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Benchmark registering, cancelling and expiring timeouts.");
+
+  cout << FLAGS_timeouts << " timeouts x " << FLAGS_rounds << " rounds"
+       << endl;
+  RunBenchmark<LegacyTimeoutManager>(
+      "legacy register/cancel", RegisterAndCancel<LegacyTimeoutManager>);
+  RunBenchmark<CurrentTimeoutManager>(
+      "current register/cancel", RegisterAndCancel<CurrentTimeoutManager>);
+  RunBenchmark<LegacyTimeoutManager>(
+      "legacy register/expire", RegisterAndExpire<LegacyTimeoutManager>);
+  RunBenchmark<CurrentTimeoutManager>(
+      "current register/expire", RegisterAndExpire<CurrentTimeoutManager>);
+  return 0;
+}
@@ -48,12 +48,16 @@
 #include <netinet/in.h>
 #endif
 
+#include <algorithm>
 #include <string>
 
 #include "common/network/SocketHelper.h"
+#include "ola/Callback.h"
+#include "ola/ExportMap.h"
 #include "ola/Logging.h"
 #include "ola/network/NetworkUtils.h"
 #include "ola/network/TCPSocketFactory.h"
+#include "ola/thread/SchedulerInterface.h"
 
 namespace ola {
 namespace network {
@@ -76,11 +80,195 @@ bool ReceiveFrom(int fd, uint8_t *buffer, ssize_t *data_read,
   return true;
 }
 
+/*
+ * Return the source of a datagram the poller received for us.
+ */
+IPV4SocketAddress DatagramSource(const ola::io::ReceivedDatagram &datagram) {
+  struct sockaddr_in source;
+  memset(&source, 0, sizeof(source));
+  if (datagram.source) {
+    memcpy(&source, datagram.source,
+           std::min(sizeof(source),
+                    static_cast<size_t>(datagram.source_size)));
+  }
+  return IPV4SocketAddress(IPV4Address(source.sin_addr.s_addr),
+                           NetworkToHost(source.sin_port));
+}
+
+#ifdef SO_RXQ_OVFL
+/*
+ * Update the drop count from the SO_RXQ_OVFL message, if there is one.
+ */
+void UpdateDrops(struct msghdr *header, UIntMap *drops,
+                 const std::string &key) {
+  for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(header); cmsg;
+       cmsg = CMSG_NXTHDR(header, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+      uint32_t count;
+      memcpy(&count, CMSG_DATA(cmsg), sizeof(count));
+      (*drops)[key] = count;
+    }
+  }
+}
+#endif  // SO_RXQ_OVFL
 }  // namespace
 
+#ifdef HAVE_SENDMMSG
+/*
+ * The datagrams queued on a UDPSocket, these are sent with a single call to
+ * sendmmsg().
+ *
+ * Datagrams are copied into preallocated slots, so queuing doesn't allocate.
+ */
+class UDPSendBatch {
+ public:
+  UDPSendBatch(int fd,
+               ola::thread::SchedulerInterface *scheduler,
+               UIntMap *send_errors,
+               const std::string &key)
+      : m_fd(fd),
+        m_scheduler(scheduler),
+        m_send_errors(send_errors),
+        m_key(key),
+        m_flush_timeout(ola::thread::INVALID_TIMEOUT),
+        m_count(0) {
+    memset(m_messages, 0, sizeof(m_messages));
+    for (unsigned int i = 0; i < MAX_DATAGRAMS; i++) {
+      m_iovecs[i].iov_base = m_data[i];
+      m_messages[i].msg_hdr.msg_name = &m_destinations[i];
+      m_messages[i].msg_hdr.msg_namelen = sizeof(m_destinations[i]);
+      m_messages[i].msg_hdr.msg_iov = &m_iovecs[i];
+      m_messages[i].msg_hdr.msg_iovlen = 1;
+    }
+  }
+
+  void SetSendErrors(UIntMap *send_errors, const std::string &key) {
+    m_send_errors = send_errors;
+    m_key = key;
+  }
+
+  ~UDPSendBatch() {
+    if (m_flush_timeout != ola::thread::INVALID_TIMEOUT) {
+      m_scheduler->RemoveTimeout(m_flush_timeout);
+    }
+  }
+
+  /*
+   * Queue a datagram.
+   * @returns false if the datagram is too large to be queued.
+   */
+  bool Add(const struct ola::io::IOVec *iov, int iov_count,
+           const IPV4SocketAddress &dest) {
+    unsigned int size = 0;
+    for (int i = 0; i < iov_count; i++) {
+      size += iov[i].iov_len;
+    }
+    if (size > MAX_DATAGRAM_SIZE) {
+      return false;
+    }
+    if (!dest.ToSockAddr(reinterpret_cast<sockaddr*>(&m_destinations[m_count]),
+                         sizeof(m_destinations[m_count]))) {
+      // Match the behaviour of SendTo(), which sends nothing.
+      return true;
+    }
+
+    uint8_t *data = m_data[m_count];
+    for (int i = 0; i < iov_count; i++) {
+      memcpy(data, iov[i].iov_base, iov[i].iov_len);
+      data += iov[i].iov_len;
+    }
+    m_iovecs[m_count].iov_len = size;
+    m_count++;
+
+    if (m_count == MAX_DATAGRAMS) {
+      Flush();
+    } else if (m_flush_timeout == ola::thread::INVALID_TIMEOUT) {
+      // This runs once the current event has been handled.
+      m_flush_timeout = m_scheduler->RegisterSingleTimeout(
+          0, NewSingleCallback(this, &UDPSendBatch::FlushFromTimeout));
+    }
+    return true;
+  }
+
+  /*
+   * Send all queued datagrams.
+   * @returns the number of datagrams that failed to send.
+   */
+  unsigned int Flush() {
+    unsigned int sent = 0;
+    unsigned int failed = 0;
+    while (sent < m_count) {
+      int r = sendmmsg(m_fd, m_messages + sent, m_count - sent, 0);
+      if (r < 0 && errno == EINTR) {
+        continue;
+      }
+      if (r <= 0) {
+        // The datagram at the head of the batch failed, skip it and carry on
+        // with the rest.
+        IPV4SocketAddress dest = GenericSocketAddress(
+            *reinterpret_cast<const struct sockaddr*>(
+              &m_destinations[sent])).V4Addr();
+        OLA_INFO << "sendmmsg failed: " << dest << " : " << strerror(errno);
+        if (m_send_errors) {
+          (*m_send_errors)[m_key]++;
+        }
+        failed++;
+        sent++;
+      } else {
+        sent += r;
+      }
+    }
+    m_count = 0;
+    return failed;
+  }
+
+  bool Empty() const { return m_count == 0; }
+
+  // Large enough for any E1.31 or Art-Net packet.
+  static const unsigned int MAX_DATAGRAM_SIZE = 1472;
+
+ private:
+  static const unsigned int MAX_DATAGRAMS = 64;
+
+  const int m_fd;
+  ola::thread::SchedulerInterface *m_scheduler;
+  UIntMap *m_send_errors;
+  std::string m_key;
+  ola::thread::timeout_id m_flush_timeout;
+  unsigned int m_count;
+
+  uint8_t m_data[MAX_DATAGRAMS][MAX_DATAGRAM_SIZE];
+  struct sockaddr_in m_destinations[MAX_DATAGRAMS];
+  struct iovec m_iovecs[MAX_DATAGRAMS];
+  struct mmsghdr m_messages[MAX_DATAGRAMS];
+
+  void FlushFromTimeout() {
+    m_flush_timeout = ola::thread::INVALID_TIMEOUT;
+    Flush();
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(UDPSendBatch);
+};
+#else
+// sendmmsg() isn't available, so batching is never enabled.
+class UDPSendBatch {
+ public:
+  void SetSendErrors(UIntMap*, const std::string&) {}
+  bool Add(const struct ola::io::IOVec*, int, const IPV4SocketAddress&) {
+    return false;
+  }
+  unsigned int Flush() { return 0; }
+  bool Empty() const { return true; }
+};
+#endif  // HAVE_SENDMMSG
+
 // UDPSocket
 // ------------------------------------------------
 
+UDPSocket::~UDPSocket() {
+  Close();
+}
+
 bool UDPSocket::Init() {
   if (m_handle != ola::io::INVALID_DESCRIPTOR)
     return false;
@@ -177,8 +365,14 @@ bool UDPSocket::Close() {
 #else
   int fd = m_handle;
 #endif
+  if (m_send_batch) {
+    m_send_batch->Flush();
+    delete m_send_batch;
+    m_send_batch = NULL;
+  }
   m_handle = ola::io::INVALID_DESCRIPTOR;
   m_bound_to_port = false;
+  m_rx_drops = NULL;
 #ifdef _WIN32
   if (closesocket(fd)) {
 #else
@@ -203,6 +397,18 @@ ssize_t UDPSocket::SendTo(const uint8_t *buffer,
   if (!ValidWriteDescriptor())
     return 0;
 
+  if (m_send_batch) {
+    struct ola::io::IOVec iov;
+    iov.iov_base = const_cast<uint8_t*>(buffer);
+    iov.iov_len = size;
+    if (m_send_batch->Add(&iov, 1, dest)) {
+      return size;
+    }
+    // Too large to batch, send whatever is queued first to preserve the
+    // ordering.
+    m_send_batch->Flush();
+  }
+
   struct sockaddr_in destination;
   if (!dest.ToSockAddr(reinterpret_cast<sockaddr*>(&destination),
                        sizeof(destination))) {
@@ -220,8 +426,10 @@ ssize_t UDPSocket::SendTo(const uint8_t *buffer,
     0,
     reinterpret_cast<const struct sockaddr*>(&destination),
     sizeof(struct sockaddr));
-  if (bytes_sent < 0 || static_cast<unsigned int>(bytes_sent) != size)
+  if (bytes_sent < 0 || static_cast<unsigned int>(bytes_sent) != size) {
     OLA_INFO << "sendto failed: " << dest << " : " << strerror(errno);
+    CountSendError();
+  }
   return bytes_sent;
 }
 
@@ -248,6 +456,19 @@ ssize_t UDPSocket::SendTo(ola::io::IOVecInterface *data,
   if (iov == NULL)
     return 0;
 
+  if (m_send_batch) {
+    if (m_send_batch->Add(iov, io_len, dest)) {
+      ssize_t size = 0;
+      for (int i = 0; i < io_len; i++) {
+        size += iov[i].iov_len;
+      }
+      data->FreeIOVec(iov);
+      data->Pop(size);
+      return size;
+    }
+    m_send_batch->Flush();
+  }
+
 #ifdef _WIN32
   ssize_t bytes_sent = 0;
 
@@ -273,35 +494,60 @@ ssize_t UDPSocket::SendTo(ola::io::IOVecInterface *data,
   if (bytes_sent < 0) {
     OLA_INFO << "Failed to send on " << WriteDescriptor() << ": to "
              << dest << " : " <<  strerror(errno);
+    CountSendError();
   } else {
     data->Pop(bytes_sent);
   }
   return bytes_sent;
 }
 
-bool UDPSocket::RecvFrom(uint8_t *buffer, ssize_t *data_read) const {
-  socklen_t length = 0;
-#ifdef _WIN32
-  return ReceiveFrom(m_handle.m_handle.m_fd, buffer, data_read, NULL, &length);
+void UDPSocket::EnableSendErrorCounting(UIntMap *send_errors,
+                                        const std::string &key) {
+  m_send_errors = send_errors;
+  m_send_errors_key = key;
+  if (m_send_errors) {
+    (*m_send_errors)[m_send_errors_key] = 0;
+  }
+  if (m_send_batch) {
+    m_send_batch->SetSendErrors(m_send_errors, m_send_errors_key);
+  }
+}
+
+bool UDPSocket::EnableSendBatching(
+    ola::thread::SchedulerInterface *scheduler) {
+#ifdef HAVE_SENDMMSG
+  if (m_handle == ola::io::INVALID_DESCRIPTOR || !scheduler) {
+    return false;
+  }
+  if (m_send_batch) {
+    m_send_batch->Flush();
+    delete m_send_batch;
+  }
+  m_send_batch = new UDPSendBatch(m_handle, scheduler, m_send_errors,
+                                  m_send_errors_key);
+  return true;
 #else
-  return ReceiveFrom(m_handle, buffer, data_read, NULL, &length);
-#endif
+  (void) scheduler;
+  return false;
+#endif  // HAVE_SENDMMSG
+}
+
+bool UDPSocket::FlushSendBatch() {
+  return m_send_batch ? m_send_batch->Flush() == 0 : true;
+}
+
+bool UDPSocket::RecvFrom(uint8_t *buffer, ssize_t *data_read) const {
+  return Receive(buffer, data_read, NULL);
 }
 
 bool UDPSocket::RecvFrom(
     uint8_t *buffer,
     ssize_t *data_read,
     IPV4Address &source) const {  // NOLINT(runtime/references)
-  struct sockaddr_in src_sockaddr;
-  socklen_t src_size = sizeof(src_sockaddr);
-#ifdef _WIN32
-  bool ok = ReceiveFrom(m_handle.m_handle.m_fd, buffer, data_read,
-                        &src_sockaddr, &src_size);
-#else
-  bool ok = ReceiveFrom(m_handle, buffer, data_read, &src_sockaddr, &src_size);
-#endif
+  IPV4SocketAddress source_address;
+  bool ok = Receive(buffer, data_read, &source_address);
   if (ok)
-    source = IPV4Address(src_sockaddr.sin_addr.s_addr);
+    source = source_address.Host();
   return ok;
 }
 
@@ -309,17 +555,11 @@ bool UDPSocket::RecvFrom(uint8_t *buffer,
                          ssize_t *data_read,
                          IPV4Address &source,  // NOLINT(runtime/references)
                          uint16_t &port) const {  // NOLINT(runtime/references)
-  struct sockaddr_in src_sockaddr;
-  socklen_t src_size = sizeof(src_sockaddr);
-#ifdef _WIN32
-  bool ok = ReceiveFrom(m_handle.m_handle.m_fd, buffer, data_read,
-                        &src_sockaddr, &src_size);
-#else
-  bool ok = ReceiveFrom(m_handle, buffer, data_read, &src_sockaddr, &src_size);
-#endif
+  IPV4SocketAddress source_address;
+  bool ok = Receive(buffer, data_read, &source_address);
   if (ok) {
-    source = IPV4Address(src_sockaddr.sin_addr.s_addr);
-    port = NetworkToHost(src_sockaddr.sin_port);
+    source = source_address.Host();
+    port = source_address.Port();
   }
   return ok;
 }
@@ -327,21 +567,205 @@ bool UDPSocket::RecvFrom(uint8_t *buffer,
 bool UDPSocket::RecvFrom(uint8_t *buffer,
                          ssize_t *data_read,
                          IPV4SocketAddress *source) {
+  return Receive(buffer, data_read, source);
+}
+
+/*
+ * Receive a single datagram. If the poller has received datagrams for us,
+ * these are returned instead of calling into the kernel.
+ */
+bool UDPSocket::Receive(uint8_t *buffer,
+                        ssize_t *data_read,
+                        IPV4SocketAddress *source) const {
+  if (m_received) {
+    if (m_received_read == m_received_count)
+      return false;
+    const ola::io::ReceivedDatagram &datagram = m_received[m_received_read++];
+    *data_read = std::min(*data_read, static_cast<ssize_t>(datagram.size));
+    memcpy(buffer, datagram.data, *data_read);
+    if (source)
+      *source = DatagramSource(datagram);
+    return true;
+  }
+
   struct sockaddr_in src_sockaddr;
   socklen_t src_size = sizeof(src_sockaddr);
 #ifdef _WIN32
   bool ok = ReceiveFrom(m_handle.m_handle.m_fd, buffer, data_read,
-                        &src_sockaddr, &src_size);
+                        source ? &src_sockaddr : NULL, &src_size);
 #else
-  bool ok = ReceiveFrom(m_handle, buffer, data_read, &src_sockaddr, &src_size);
+  bool ok = ReceiveFrom(m_handle, buffer, data_read,
+                        source ? &src_sockaddr : NULL, &src_size);
 #endif
-  if (ok) {
+  if (ok && source) {
     *source = IPV4SocketAddress(IPV4Address(src_sockaddr.sin_addr.s_addr),
                                 NetworkToHost(src_sockaddr.sin_port));
   }
   return ok;
 }
 
+unsigned int UDPSocket::RecvBatch(UDPDatagram *datagrams, unsigned int count) {
+  if (m_received) {
+    unsigned int received = 0;
+    for (; received < count && m_received_read < m_received_count;
+         received++) {
+      const ola::io::ReceivedDatagram &datagram = m_received[m_received_read++];
+      datagrams[received].size = std::min(datagrams[received].buffer_size,
+                                          datagram.size);
+      memcpy(datagrams[received].data, datagram.data,
+             datagrams[received].size);
+      datagrams[received].source = DatagramSource(datagram);
+    }
+
+#ifdef SO_RXQ_OVFL
+    if (m_rx_drops && received && m_received[m_received_read - 1].control) {
+      const ola::io::ReceivedDatagram &last = m_received[m_received_read - 1];
+      struct msghdr header;
+      memset(&header, 0, sizeof(header));
+      header.msg_control = const_cast<uint8_t*>(last.control);
+      header.msg_controllen = last.control_size;
+      UpdateDrops(&header, m_rx_drops, m_rx_drops_key);
+    }
+#endif  // SO_RXQ_OVFL
+    return received;
+  }
+
+#ifdef HAVE_RECVMMSG
+  static const unsigned int MAX_BATCH_SIZE = 64;
+  // Large enough for the SO_RXQ_OVFL message.
+  static const unsigned int CONTROL_SIZE = CMSG_SPACE(sizeof(uint32_t));
+
+  struct mmsghdr messages[MAX_BATCH_SIZE];
+  struct iovec iovecs[MAX_BATCH_SIZE];
+  struct sockaddr_in sources[MAX_BATCH_SIZE];
+  uint8_t control[MAX_BATCH_SIZE][CONTROL_SIZE];
+
+  count = std::min(count, MAX_BATCH_SIZE);
+  memset(messages, 0, count * sizeof(messages[0]));
+  for (unsigned int i = 0; i < count; i++) {
+    iovecs[i].iov_base = datagrams[i].data;
+    iovecs[i].iov_len = datagrams[i].buffer_size;
+    messages[i].msg_hdr.msg_name = &sources[i];
+    messages[i].msg_hdr.msg_namelen = sizeof(sources[i]);
+    messages[i].msg_hdr.msg_iov = &iovecs[i];
+    messages[i].msg_hdr.msg_iovlen = 1;
+    if (m_rx_drops) {
+      messages[i].msg_hdr.msg_control = control[i];
+      messages[i].msg_hdr.msg_controllen = CONTROL_SIZE;
+    }
+  }
+
+  int received;
+  do {
+    received = recvmmsg(m_handle, messages, count, MSG_DONTWAIT, NULL);
+  } while (received < 0 && errno == EINTR);
+
+  if (received < 0) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      OLA_WARN << "recvmmsg fd: " << m_handle << " failed: "
+               << strerror(errno);
+    }
+    return 0;
+  }
+
+  for (int i = 0; i < received; i++) {
+    datagrams[i].size = messages[i].msg_len;
+    datagrams[i].source = IPV4SocketAddress(
+        IPV4Address(sources[i].sin_addr.s_addr),
+        NetworkToHost(sources[i].sin_port));
+  }
+
+#ifdef SO_RXQ_OVFL
+  if (m_rx_drops && received > 0) {
+    // The count is cumulative, so only the last datagram matters.
+    UpdateDrops(&messages[received - 1].msg_hdr, m_rx_drops, m_rx_drops_key);
+  }
+#endif  // SO_RXQ_OVFL
+  return received;
+#else
+  if (count == 0) {
+    return 0;
+  }
+  ssize_t size = datagrams[0].buffer_size;
+  if (!RecvFrom(datagrams[0].data, &size, &datagrams[0].source)) {
+    return 0;
+  }
+  datagrams[0].size = size;
+  return 1;
+#endif  // HAVE_RECVMMSG
+}
+
+bool UDPSocket::SetReceiveBufferSize(unsigned int size) {
+  if (m_handle == ola::io::INVALID_DESCRIPTOR)
+    return false;
+
+  int value = size;
+#ifdef _WIN32
+  int ok = setsockopt(m_handle.m_handle.m_fd,
+#else
+  int ok = setsockopt(m_handle,
+#endif
+                      SOL_SOCKET,
+                      SO_RCVBUF,
+                      reinterpret_cast<char*>(&value),
+                      sizeof(value));
+  if (ok < 0) {
+    OLA_WARN << "Failed to set SO_RCVBUF for " << m_handle << ", "
+             << strerror(errno);
+    return false;
+  }
+
+#ifndef _WIN32
+  // Linux limits the buffer to net.core.rmem_max, and doubles the value to
+  // account for bookkeeping.
+  socklen_t length = sizeof(value);
+  if (getsockopt(m_handle, SOL_SOCKET, SO_RCVBUF,
+                 reinterpret_cast<char*>(&value), &length) == 0 &&
+      static_cast<unsigned int>(value) < size) {
+    OLA_WARN << "Receive buffer for " << m_handle << " is " << value
+             << " bytes, requested " << size << ", check net.core.rmem_max";
+  }
+#endif  // _WIN32
+  return true;
+}
+
+void UDPSocket::SetReceivedDatagrams(
+    const ola::io::ReceivedDatagram *datagrams,
+    unsigned int count) {
+  m_received = datagrams;
+  m_received_count = datagrams ? count : 0;
+  m_received_read = 0;
+}
+
+void UDPSocket::CountSendError() const {
+  if (m_send_errors) {
+    (*m_send_errors)[m_send_errors_key]++;
+  }
+}
+
+bool UDPSocket::EnableDropCounting(UIntMap *drops, const std::string &key) {
+#if defined(HAVE_RECVMMSG) && defined(SO_RXQ_OVFL)
+  if (m_handle == ola::io::INVALID_DESCRIPTOR || !drops)
+    return false;
+
+  int enable = 1;
+  if (setsockopt(m_handle, SOL_SOCKET, SO_RXQ_OVFL, &enable,
+                 sizeof(enable)) < 0) {
+    OLA_WARN << "Failed to set SO_RXQ_OVFL for " << m_handle << ", "
+             << strerror(errno);
+    return false;
+  }
+  m_rx_drops = drops;
+  m_rx_drops_key = key;
+  (*m_rx_drops)[m_rx_drops_key] = 0;
+  return true;
+#else
+  (void) drops;
+  (void) key;
+  return false;
+#endif  // defined(HAVE_RECVMMSG) && defined(SO_RXQ_OVFL)
+}
+
 bool UDPSocket::EnableBroadcast() {
   if (m_handle == ola::io::INVALID_DESCRIPTOR)
     return false;
@@ -24,6 +24,7 @@
 #include <string>
 
 #include "ola/Callback.h"
+#include "ola/ExportMap.h"
 #include "ola/Logging.h"
 #include "ola/io/Descriptor.h"
 #include "ola/io/IOQueue.h"
@@ -56,6 +57,9 @@ class SocketTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testTCPSocketServerClose);
   CPPUNIT_TEST(testUDPSocket);
   CPPUNIT_TEST(testIOQueueUDPSend);
+  CPPUNIT_TEST(testUDPSendBatching);
+  CPPUNIT_TEST(testUDPSendErrors);
+  CPPUNIT_TEST(testUDPRecvBatch);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -65,6 +69,9 @@ class SocketTest: public CppUnit::TestFixture {
     void testTCPSocketServerClose();
     void testUDPSocket();
     void testIOQueueUDPSend();
+    void testUDPSendBatching();
+    void testUDPSendErrors();
+    void testUDPRecvBatch();
 
     // timing out indicates something went wrong
     void Timeout() {
@@ -279,6 +286,168 @@ void SocketTest::testIOQueueUDPSend() {
 }
 
 
+/*
+ * Test UDP sockets with send batching enabled. Both sides batch, so the echo
+ * is only sent when the SelectServer flushes the batch.
+ */
+void SocketTest::testUDPSendBatching() {
+  ola::ExportMap export_map;
+  ola::UIntMap *send_errors = export_map.GetUIntMapVar("send-errors", "socket");
+
+  IPV4SocketAddress socket_address(IPV4Address::Loopback(), 0);
+  UDPSocket socket;
+  OLA_ASSERT_FALSE(socket.EnableSendBatching(m_ss));
+  OLA_ASSERT_TRUE(socket.Init());
+  OLA_ASSERT_TRUE(socket.Bind(socket_address));
+  socket.EnableSendErrorCounting(send_errors, "server");
+  if (!socket.EnableSendBatching(m_ss)) {
+    OLA_INFO << "Send batching not supported, skipping test";
+    return;
+  }
+  OLA_ASSERT_EQ(0u, (*send_errors)["server"]);
+
+  IPV4SocketAddress local_address;
+  OLA_ASSERT_TRUE(socket.GetSocketAddress(&local_address));
+
+  socket.SetOnData(
+      ola::NewCallback(this, &SocketTest::UDPReceiveAndSend, &socket));
+  OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(&socket));
+
+  UDPSocket client_socket;
+  OLA_ASSERT_TRUE(client_socket.Init());
+  OLA_ASSERT_TRUE(client_socket.EnableSendBatching(m_ss));
+  client_socket.EnableSendErrorCounting(send_errors, "client");
+
+  client_socket.SetOnData(
+      ola::NewCallback(
+        this, &SocketTest::UDPReceiveAndTerminate,
+        static_cast<UDPSocket*>(&client_socket)));
+  OLA_ASSERT_TRUE(m_ss->AddReadDescriptor(&client_socket));
+
+  // Too large to batch, this is sent immediately.
+  uint8_t large_datagram[2000];
+  memset(large_datagram, 0, sizeof(large_datagram));
+  ssize_t bytes_sent = client_socket.SendTo(large_datagram,
+                                            sizeof(large_datagram),
+                                            IPV4SocketAddress(
+                                                IPV4Address::Loopback(), 9));
+  OLA_ASSERT_EQ(static_cast<ssize_t>(sizeof(large_datagram)), bytes_sent);
+
+  bytes_sent = client_socket.SendTo(
+      static_cast<const uint8_t*>(test_cstring),
+      sizeof(test_cstring),
+      local_address);
+  OLA_ASSERT_EQ(static_cast<ssize_t>(sizeof(test_cstring)), bytes_sent);
+  m_ss->Run();
+  m_ss->RemoveReadDescriptor(&socket);
+  m_ss->RemoveReadDescriptor(&client_socket);
+
+  OLA_ASSERT_EQ(0u, (*send_errors)["server"]);
+  OLA_ASSERT_EQ(0u, (*send_errors)["client"]);
+}
+
+
+/*
+ * Check that datagrams which fail to send are counted, whether they're sent
+ * directly or in a batch.
+ */
+void SocketTest::testUDPSendErrors() {
+  ola::ExportMap export_map;
+  ola::UIntMap *send_errors = export_map.GetUIntMapVar("send-errors", "socket");
+  // Broadcast isn't enabled, so sending to the broadcast address fails.
+  const IPV4SocketAddress destination(IPV4Address::Broadcast(), 9);
+
+  UDPSocket socket;
+  OLA_ASSERT_TRUE(socket.Init());
+  socket.EnableSendErrorCounting(send_errors, "socket");
+  OLA_ASSERT_EQ(0u, (*send_errors)["socket"]);
+
+  const uint8_t data[] = {1, 2, 3, 4};
+  OLA_ASSERT_TRUE(socket.SendTo(data, sizeof(data), destination) < 0);
+  OLA_ASSERT_EQ(1u, (*send_errors)["socket"]);
+  // Nothing is queued.
+  OLA_ASSERT_TRUE(socket.FlushSendBatch());
+
+  if (!socket.EnableSendBatching(m_ss)) {
+    OLA_INFO << "Send batching not supported, skipping the rest of the test";
+    return;
+  }
+
+  // Queued datagrams are only counted when the batch is sent, and the flush
+  // reports the failure.
+  OLA_ASSERT_EQ(static_cast<ssize_t>(sizeof(data)),
+                socket.SendTo(data, sizeof(data), destination));
+  OLA_ASSERT_EQ(static_cast<ssize_t>(sizeof(data)),
+                socket.SendTo(data, sizeof(data), destination));
+  OLA_ASSERT_EQ(1u, (*send_errors)["socket"]);
+  OLA_ASSERT_FALSE(socket.FlushSendBatch());
+  OLA_ASSERT_EQ(3u, (*send_errors)["socket"]);
+  OLA_ASSERT_TRUE(socket.FlushSendBatch());
+
+  // Batches flushed by the SelectServer are counted too.
+  OLA_ASSERT_EQ(static_cast<ssize_t>(sizeof(data)),
+                socket.SendTo(data, sizeof(data), destination));
+  m_ss->RegisterSingleTimeout(
+      10, ola::NewSingleCallback(m_ss, &SelectServer::Terminate));
+  m_ss->Run();
+  OLA_ASSERT_EQ(4u, (*send_errors)["socket"]);
+}
+
+
+/*
+ * Test receiving several datagrams with RecvBatch().
+ */
+void SocketTest::testUDPRecvBatch() {
+  ola::ExportMap export_map;
+  ola::UIntMap *drops = export_map.GetUIntMapVar("drops", "socket");
+
+  UDPSocket socket;
+  OLA_ASSERT_FALSE(socket.SetReceiveBufferSize(65536));
+  OLA_ASSERT_TRUE(socket.Init());
+  OLA_ASSERT_TRUE(socket.Bind(IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+  OLA_ASSERT_TRUE(socket.SetReceiveBufferSize(65536));
+  bool counting_drops = socket.EnableDropCounting(drops, "server");
+
+  IPV4SocketAddress local_address;
+  OLA_ASSERT_TRUE(socket.GetSocketAddress(&local_address));
+
+  UDPSocket client_socket;
+  OLA_ASSERT_TRUE(client_socket.Init());
+
+  static const unsigned int DATAGRAM_COUNT = 3;
+  for (uint8_t i = 0; i < DATAGRAM_COUNT; i++) {
+    OLA_ASSERT_EQ(static_cast<ssize_t>(sizeof(i)),
+                  client_socket.SendTo(&i, sizeof(i), local_address));
+  }
+
+  uint8_t buffers[DATAGRAM_COUNT + 1][10];
+  ola::network::UDPDatagram datagrams[DATAGRAM_COUNT + 1];
+  for (unsigned int i = 0; i < DATAGRAM_COUNT + 1; i++) {
+    datagrams[i].data = buffers[i];
+    datagrams[i].buffer_size = sizeof(buffers[i]);
+  }
+
+  unsigned int received = 0;
+  while (received < DATAGRAM_COUNT) {
+    unsigned int count = socket.RecvBatch(datagrams + received,
+                                          DATAGRAM_COUNT + 1 - received);
+    OLA_ASSERT_NE(0u, count);
+    received += count;
+  }
+  OLA_ASSERT_EQ(DATAGRAM_COUNT, received);
+
+  for (unsigned int i = 0; i < DATAGRAM_COUNT; i++) {
+    OLA_ASSERT_EQ(static_cast<ssize_t>(1), datagrams[i].size);
+    OLA_ASSERT_EQ(static_cast<uint8_t>(i), buffers[i][0]);
+    OLA_ASSERT_EQ(IPV4Address::Loopback(), datagrams[i].source.Host());
+  }
+
+  if (counting_drops) {
+    OLA_ASSERT_EQ(0u, (*drops)["server"]);
+  }
+}
+
+
 /*
  * Receive some data and close the socket
  */
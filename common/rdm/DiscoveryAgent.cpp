@@ -77,6 +77,14 @@ void DiscoveryAgent::StartIncrementalDiscovery(
   InitDiscovery(on_complete, true);
 }
 
+void DiscoveryAgent::SetKnownUIDs(const UIDSet &uids) {
+  if (m_on_complete) {
+    OLA_WARN << "Discovery procedure running, ignoring known UIDs";
+    return;
+  }
+  m_uids = uids;
+}
+
 /*
  * Start the discovery process
  * @param on_complete the callback to run when discovery completes
@@ -114,6 +122,7 @@ void DiscoveryAgent::InitDiscovery(
 
   m_bad_uids.Clear();
   m_tree_corrupt = false;
+  m_stats = DiscoveryStats();
 
   // push the first range on to the branch stack
   UID lower(0, 0);
@@ -153,6 +162,7 @@ void DiscoveryAgent::MaybeMuteNextDevice() {
     m_muting_uid = m_uids_to_mute.front();
     m_uids_to_mute.pop();
     OLA_DEBUG << "Muting previously discovered responder: " << m_muting_uid;
+    m_stats.mutes++;
     m_target->MuteDevice(m_muting_uid, m_incremental_mute_callback.get());
   }
 }
@@ -163,8 +173,10 @@ void DiscoveryAgent::MaybeMuteNextDevice() {
 void DiscoveryAgent::IncrementalMuteComplete(bool status) {
   if (!status) {
     m_uids.RemoveUID(m_muting_uid);
+    m_stats.lost_uids++;
     OLA_WARN << "Unable to mute " << m_muting_uid << ", device has gone";
   } else {
+    m_stats.verified_uids++;
     OLA_DEBUG << "Muted " << m_muting_uid;
   }
   MaybeMuteNextDevice();
@@ -176,6 +188,9 @@ void DiscoveryAgent::IncrementalMuteComplete(bool status) {
 void DiscoveryAgent::SendDiscovery() {
   if (m_uid_ranges.empty()) {
     // we're hit the end of the stack, now we're done
+    OLA_INFO << "Discovery complete, found " << m_uids.Size() << " UIDs with "
+             << m_stats.branches << " branches, " << m_stats.collisions
+             << " collisions and " << m_stats.mutes << " mutes";
     if (m_on_complete) {
       m_on_complete->Run(!m_tree_corrupt, m_uids);
       m_on_complete = NULL;
@@ -204,6 +219,7 @@ void DiscoveryAgent::SendDiscovery() {
               << ", attempt " << range->attempt << ", uids found: "
               << range->uids_discovered << ", failures " << range->failures
               << ", corrupted " << range->branch_corrupt;
+    m_stats.branches++;
     m_target->Branch(range->lower, range->upper, m_branch_callback.get());
   }
 }
@@ -319,6 +335,7 @@ void DiscoveryAgent::BranchComplete(const uint8_t *data, unsigned int length) {
     m_muting_uid = located_uid;
     m_mute_attempts = 0;
     OLA_INFO << "Muting " << m_muting_uid;
+    m_stats.mutes++;
     m_target->MuteDevice(m_muting_uid, m_branch_mute_callback.get());
   }
 }
@@ -335,6 +352,7 @@ void DiscoveryAgent::BranchMuteComplete(bool status) {
     // failed to mute, if we haven't reached the limit try it again
     if (m_mute_attempts < MAX_MUTE_ATTEMPTS) {
       OLA_INFO << "Muting " << m_muting_uid;
+      m_stats.mutes++;
       m_target->MuteDevice(m_muting_uid, m_branch_mute_callback.get());
       return;
     } else {
@@ -351,6 +369,7 @@ void DiscoveryAgent::BranchMuteComplete(bool status) {
  * Handle a DUB collision.
  */
 void DiscoveryAgent::HandleCollision() {
+  m_stats.collisions++;
   UIDRange *range = m_uid_ranges.top();
   UID lower_uid = range->lower;
   UID upper_uid = range->upper;
@@ -51,6 +51,8 @@ class DiscoveryAgentTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testNonMutingResponder);
   CPPUNIT_TEST(testFlakeyResponder);
   CPPUNIT_TEST(testProxy);
+  CPPUNIT_TEST(testKnownUIDs);
+  CPPUNIT_TEST(testLargeBus);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -69,6 +71,8 @@ class DiscoveryAgentTest: public CppUnit::TestFixture {
     void testNonMutingResponder();
     void testFlakeyResponder();
     void testProxy();
+    void testKnownUIDs();
+    void testLargeBus();
 
  private:
     bool m_callback_run;
@@ -479,3 +483,90 @@ void DiscoveryAgentTest::testProxy() {
   OLA_ASSERT_TRUE(m_callback_run);
   m_callback_run = false;
 }
+
+
+/**
+ * Test that incremental discovery verifies UIDs passed to SetKnownUIDs.
+ */
+void DiscoveryAgentTest::testKnownUIDs() {
+  UIDSet uids;
+  ResponderList responders;
+  uids.AddUID(UID(0x7a70, 0x00002002));
+  uids.AddUID(UID(0x7a77, 0x00002002));
+  PopulateResponderListFromUIDs(uids, &responders);
+  MockDiscoveryTarget target(responders);
+
+  // one of the known UIDs has gone, and a new responder has appeared
+  UID missing_uid(0x7a70, 0x00002001);
+  UIDSet known_uids(uids);
+  known_uids.AddUID(missing_uid);
+  UID new_uid(0x8080, 0x00103456);
+  target.AddResponder(new MockResponder(new_uid));
+  uids.AddUID(new_uid);
+
+  DiscoveryAgent agent(&target);
+  agent.SetKnownUIDs(known_uids);
+  agent.StartIncrementalDiscovery(
+      ola::NewSingleCallback(this,
+                             &DiscoveryAgentTest::DiscoverySuccessful,
+                             static_cast<const UIDSet*>(&uids)));
+  OLA_ASSERT_TRUE(m_callback_run);
+
+  const DiscoveryAgent::DiscoveryStats &stats = agent.Stats();
+  OLA_ASSERT_EQ(2u, stats.verified_uids);
+  OLA_ASSERT_EQ(1u, stats.lost_uids);
+  // 3 known mutes + 1 for the new responder.
+  OLA_ASSERT_EQ(4u, stats.mutes);
+  OLA_ASSERT_EQ(0u, stats.collisions);
+  // one DUB to find the new responder, one to confirm the tree is empty.
+  OLA_ASSERT_EQ(2u, stats.branches);
+}
+
+
+/**
+ * Compare full discovery against seeded incremental discovery on a bus with
+ * 500 responders.
+ */
+void DiscoveryAgentTest::testLargeBus() {
+  UIDSet uids;
+  ResponderList responders;
+  for (unsigned int i = 0; i < 500; i++) {
+    uids.AddUID(UID(0x7a70 + (i % 5), 0x00010000 + i * 7919));
+  }
+  PopulateResponderListFromUIDs(uids, &responders);
+  DeferredDiscoveryTarget target(responders);
+
+  DiscoveryAgent full_agent(&target);
+  full_agent.StartFullDiscovery(
+      ola::NewSingleCallback(this,
+                             &DiscoveryAgentTest::DiscoverySuccessful,
+                             static_cast<const UIDSet*>(&uids)));
+  target.RunPendingCommands();
+  OLA_ASSERT_TRUE(m_callback_run);
+  m_callback_run = false;
+  const DiscoveryAgent::DiscoveryStats full_stats = full_agent.Stats();
+  OLA_INFO << "Full discovery: " << full_stats.branches << " branches, "
+           << full_stats.collisions << " collisions, " << full_stats.mutes
+           << " mutes";
+  OLA_ASSERT_EQ(500u, full_stats.mutes);
+  OLA_ASSERT_TRUE(full_stats.collisions > 0);
+
+  // A new agent stands in for olad restarting with the saved UIDs.
+  DiscoveryAgent seeded_agent(&target);
+  seeded_agent.SetKnownUIDs(uids);
+  seeded_agent.StartIncrementalDiscovery(
+      ola::NewSingleCallback(this,
+                             &DiscoveryAgentTest::DiscoverySuccessful,
+                             static_cast<const UIDSet*>(&uids)));
+  target.RunPendingCommands();
+  OLA_ASSERT_TRUE(m_callback_run);
+  const DiscoveryAgent::DiscoveryStats seeded_stats = seeded_agent.Stats();
+  OLA_INFO << "Seeded discovery: " << seeded_stats.branches << " branches, "
+           << seeded_stats.collisions << " collisions, " << seeded_stats.mutes
+           << " mutes";
+  OLA_ASSERT_EQ(500u, seeded_stats.verified_uids);
+  OLA_ASSERT_EQ(0u, seeded_stats.lost_uids);
+  OLA_ASSERT_EQ(0u, seeded_stats.collisions);
+  OLA_ASSERT_EQ(1u, seeded_stats.branches);
+  OLA_ASSERT_TRUE(seeded_stats.branches < full_stats.branches);
+}
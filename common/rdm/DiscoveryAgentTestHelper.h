@@ -24,6 +24,7 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <string.h>
 #include <algorithm>
+#include <queue>
 #include <vector>
 
 #include "ola/Logging.h"
@@ -427,4 +428,64 @@ class MockDiscoveryTarget: public ola::rdm::DiscoveryTargetInterface {
     ResponderList m_responders;
     unsigned int m_unmute_calls;
 };
+
+
+/**
+ * A MockDiscoveryTarget that queues the mute and branch commands until
+ * RunPendingCommands() is called. Unlike MockDiscoveryTarget, the stack doesn't
+ * grow with each command, so this can be used to simulate large buses.
+ */
+class DeferredDiscoveryTarget: public MockDiscoveryTarget {
+ public:
+    explicit DeferredDiscoveryTarget(const ResponderList &responders)
+        : MockDiscoveryTarget(responders) {
+    }
+
+    void MuteDevice(const ola::rdm::UID &target,
+                    MuteDeviceCallback *mute_complete) {
+      PendingCommand command(target, target);
+      command.mute_complete = mute_complete;
+      m_commands.push(command);
+    }
+
+    void Branch(const ola::rdm::UID &lower,
+                const ola::rdm::UID &upper,
+                BranchCallback *callback) {
+      PendingCommand command(lower, upper);
+      command.branch_complete = callback;
+      m_commands.push(command);
+    }
+
+    // Run commands until the queue is empty
+    void RunPendingCommands() {
+      while (!m_commands.empty()) {
+        PendingCommand command = m_commands.front();
+        m_commands.pop();
+        if (command.mute_complete) {
+          MockDiscoveryTarget::MuteDevice(command.lower,
+                                          command.mute_complete);
+        } else {
+          MockDiscoveryTarget::Branch(command.lower, command.upper,
+                                      command.branch_complete);
+        }
+      }
+    }
+
+ private:
+    struct PendingCommand {
+      PendingCommand(const ola::rdm::UID &_lower, const ola::rdm::UID &_upper)
+          : lower(_lower),
+            upper(_upper),
+            mute_complete(NULL),
+            branch_complete(NULL) {
+      }
+
+      ola::rdm::UID lower;
+      ola::rdm::UID upper;
+      MuteDeviceCallback *mute_complete;
+      BranchCallback *branch_complete;
+    };
+
+    std::queue<PendingCommand> m_commands;
+};
 #endif  // COMMON_RDM_DISCOVERYAGENTTESTHELPER_H_
@@ -55,6 +55,17 @@ common_libolacommon_la_LIBADD += $(libprotobuf_LIBS)
 
 EXTRA_DIST += common/rdm/Pids.proto
 
+# PROGRAMS
+##################################################
+# pid_store_compiler is run during the build to generate data/rdm/pids.bin
+noinst_PROGRAMS += \
+    common/rdm/pid_store_benchmark \
+    common/rdm/pid_store_compiler
+common_rdm_pid_store_benchmark_SOURCES = common/rdm/pid_store_benchmark.cpp
+common_rdm_pid_store_benchmark_LDADD = common/libolacommon.la
+common_rdm_pid_store_compiler_SOURCES = common/rdm/pid_store_compiler.cpp
+common_rdm_pid_store_compiler_LDADD = common/libolacommon.la
+
 common/rdm/Pids.pb.cc common/rdm/Pids.pb.h: common/rdm/Makefile.mk common/rdm/Pids.proto
 	$(PROTOC) --cpp_out common/rdm --proto_path $(srcdir)/common/rdm $(srcdir)/common/rdm/Pids.proto
 
@@ -26,10 +26,13 @@
 #include "ola/rdm/PidStore.h"
 #include "ola/rdm/RDMEnums.h"
 #include "ola/stl/STLUtils.h"
+#include "ola/thread/Mutex.h"
 
 namespace ola {
 namespace rdm {
 
+using ola::messaging::Descriptor;
+using ola::thread::MutexLocker;
 using std::string;
 using std::vector;
 
@@ -162,6 +165,30 @@ PidDescriptor::~PidDescriptor() {
 }
 
 
+const Descriptor *PidDescriptor::GetRequest() const {
+  BuildFrames();
+  return m_get_request;
+}
+
+
+const Descriptor *PidDescriptor::GetResponse() const {
+  BuildFrames();
+  return m_get_response;
+}
+
+
+const Descriptor *PidDescriptor::SetRequest() const {
+  BuildFrames();
+  return m_set_request;
+}
+
+
+const Descriptor *PidDescriptor::SetResponse() const {
+  BuildFrames();
+  return m_set_response;
+}
+
+
 /**
  * Lookup a PID by value.
  * @param pid_value the 16 bit pid value.
@@ -194,6 +221,7 @@ const PidDescriptor *PidStore::LookupPID(const string &pid_name) const {
  * @returns true if the request is valid, false otherwise.
  */
 bool PidDescriptor::IsGetValid(uint16_t sub_device) const {
+  BuildFrames();
   return m_get_request && RequestValid(sub_device, m_get_subdevice_range);
 }
 
@@ -204,10 +232,30 @@ bool PidDescriptor::IsGetValid(uint16_t sub_device) const {
  * @returns true if the request is valid, false otherwise.
  */
 bool PidDescriptor::IsSetValid(uint16_t sub_device) const {
+  BuildFrames();
   return m_set_request && RequestValid(sub_device, m_set_subdevice_range);
 }
 
 
+/**
+ * If this descriptor was created with a PidFrameBuilder, build the
+ * Descriptors and then free the builder.
+ */
+void PidDescriptor::BuildFrames() const {
+  if (__atomic_load_n(&m_built, __ATOMIC_ACQUIRE)) {
+    return;
+  }
+
+  MutexLocker locker(&m_mutex);
+  if (m_builder.get()) {
+    m_builder->BuildFrames(&m_get_request, &m_get_response, &m_set_request,
+                           &m_set_response);
+    m_builder.reset();
+  }
+  __atomic_store_n(&m_built, true, __ATOMIC_RELEASE);
+}
+
+
 /**
  * Returns is a request is valid
  */
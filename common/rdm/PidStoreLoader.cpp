@@ -19,8 +19,11 @@
  */
 
 #include <errno.h>
+#include <stdint.h>
+#include <string.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 #include <google/protobuf/text_format.h>
+#include <algorithm>
 #include <fstream>
 #include <set>
 #include <sstream>
@@ -50,6 +53,8 @@ using std::string;
 using std::vector;
 
 const char PidStoreLoader::OVERRIDE_FILE_NAME[] = "overrides.proto";
+const char PidStoreLoader::COMPILED_FILE_NAME[] = "pids.bin";
+const char PidStoreLoader::COMPILED_FILE_MAGIC[] = "OLA PID STORE 1";
 const uint16_t PidStoreLoader::ESTA_MANUFACTURER_ID = 0;
 const uint16_t PidStoreLoader::MANUFACTURER_PID_MIN = 0x8000;
 const uint16_t PidStoreLoader::MANUFACTURER_PID_MAX = 0xffe0;
@@ -70,37 +75,19 @@ const RootPidStore *PidStoreLoader::LoadFromFile(const string &file,
 
 const RootPidStore *PidStoreLoader::LoadFromDirectory(
     const string &directory,
-    bool validate) {
+    bool validate,
+    bool use_compiled) {
   vector<string> files;
-
   string override_file;
-  vector<string> all_files;
-  ola::file::ListDirectory(directory, &all_files);
-  vector<string>::const_iterator file_iter = all_files.begin();
-  for (; file_iter != all_files.end(); ++file_iter) {
-    if (ola::file::FilenameFromPath(*file_iter) == OVERRIDE_FILE_NAME) {
-      override_file = *file_iter;
-    } else if (StringEndsWith(*file_iter, ".proto")) {
-      files.push_back(*file_iter);
-    }
-  }
+  ListProtoFiles(directory, &files, &override_file);
 
   ola::rdm::pid::PidStore pid_store_pb;
-  vector<string>::const_iterator iter = files.begin();
-  for (; iter != files.end(); ++iter) {
-    std::ifstream proto_file(iter->data());
-    if (!proto_file.is_open()) {
-      OLA_WARN << "Failed to open " << *iter << ": " << strerror(errno);
-      return NULL;
-    }
-
-    google::protobuf::io::IstreamInputStream input_stream(&proto_file);
-    bool ok = google::protobuf::TextFormat::Merge(&input_stream,
-                                                  &pid_store_pb);
-    proto_file.close();
-
-    if (!ok) {
-      OLA_WARN << "Failed to load " << *iter;
+  bool compiled = use_compiled && ReadCompiledFile(
+      ola::file::JoinPaths(directory, COMPILED_FILE_NAME), files,
+      &pid_store_pb);
+  if (!compiled) {
+    pid_store_pb.Clear();
+    if (!ReadFiles(files, &pid_store_pb)) {
       return NULL;
     }
   }
@@ -112,7 +99,47 @@ const RootPidStore *PidStoreLoader::LoadFromDirectory(
     }
   }
 
-  return BuildStore(pid_store_pb, override_pb, validate);
+  return BuildStore(&pid_store_pb, &override_pb, validate, compiled);
+}
+
+bool PidStoreLoader::CompileDirectory(const string &directory,
+                                      const string &output_file) {
+  vector<string> files;
+  string override_file;
+  ListProtoFiles(directory, &files, &override_file);
+
+  ola::rdm::pid::PidStore pid_store_pb;
+  if (!ReadFiles(files, &pid_store_pb)) {
+    return false;
+  }
+
+  // The compiled data isn't validated when it's loaded, so do it now.
+  ola::rdm::pid::PidStore override_pb;
+  auto_ptr<const RootPidStore> store(
+      BuildStore(&pid_store_pb, &override_pb, true));
+  if (!store.get()) {
+    return false;
+  }
+
+  string header;
+  if (!CompiledFileHeader(files, &header)) {
+    return false;
+  }
+
+  std::ofstream output(output_file.c_str(),
+                       std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!output.is_open()) {
+    OLA_WARN << "Failed to open " << output_file << ": " << strerror(errno);
+    return false;
+  }
+  output << header;
+  bool ok = pid_store_pb.SerializeToOstream(&output);
+  output.close();
+  if (!ok || output.fail()) {
+    OLA_WARN << "Failed to write " << output_file;
+    return false;
+  }
+  return true;
 }
 
 const RootPidStore *PidStoreLoader::LoadFromStream(std::istream *data,
@@ -125,7 +152,7 @@ const RootPidStore *PidStoreLoader::LoadFromStream(std::istream *data,
     return NULL;
 
   ola::rdm::pid::PidStore override_pb;
-  return BuildStore(pid_store_pb, override_pb, validate);
+  return BuildStore(&pid_store_pb, &override_pb, validate);
 }
 
 bool PidStoreLoader::ReadFile(const std::string &file_path,
@@ -146,22 +173,135 @@ bool PidStoreLoader::ReadFile(const std::string &file_path,
   return ok;
 }
 
+/*
+ * Find the .proto files in a directory. The files are sorted so that the
+ * compiled file header doesn't depend on the directory order.
+ */
+void PidStoreLoader::ListProtoFiles(const string &directory,
+                                    vector<string> *files,
+                                    string *override_file) {
+  vector<string> all_files;
+  ola::file::ListDirectory(directory, &all_files);
+  std::sort(all_files.begin(), all_files.end());
+  vector<string>::const_iterator file_iter = all_files.begin();
+  for (; file_iter != all_files.end(); ++file_iter) {
+    if (ola::file::FilenameFromPath(*file_iter) == OVERRIDE_FILE_NAME) {
+      *override_file = *file_iter;
+    } else if (StringEndsWith(*file_iter, ".proto")) {
+      files->push_back(*file_iter);
+    }
+  }
+}
+
+/*
+ * Merge the contents of the text files into a single protobuf.
+ */
+bool PidStoreLoader::ReadFiles(const vector<string> &files,
+                               ola::rdm::pid::PidStore *proto) {
+  vector<string>::const_iterator iter = files.begin();
+  for (; iter != files.end(); ++iter) {
+    if (!ReadFile(*iter, proto)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Read the compiled store, if it's up to date with the .proto files.
+ */
+bool PidStoreLoader::ReadCompiledFile(const string &file_path,
+                                      const vector<string> &files,
+                                      ola::rdm::pid::PidStore *proto) {
+  std::ifstream compiled_file(file_path.c_str(),
+                              std::ios::in | std::ios::binary);
+  if (!compiled_file.is_open()) {
+    OLA_DEBUG << "No compiled PID data at " << file_path;
+    return false;
+  }
+
+  string expected_header;
+  if (!CompiledFileHeader(files, &expected_header)) {
+    return false;
+  }
+
+  // The header ends with an empty line.
+  string header, line;
+  while (std::getline(compiled_file, line)) {
+    header.append(line);
+    header.push_back('\n');
+    if (line.empty() || header.size() > expected_header.size()) {
+      break;
+    }
+  }
+
+  if (header != expected_header) {
+    OLA_WARN << file_path << " is out of date, loading the .proto files "
+             << "instead";
+    return false;
+  }
+
+  if (!proto->ParseFromIstream(&compiled_file)) {
+    OLA_WARN << "Failed to load " << file_path;
+    return false;
+  }
+  OLA_DEBUG << "Loaded compiled PID data from " << file_path;
+  return true;
+}
+
+/*
+ * Generate the header for the compiled file. This contains the name, size and
+ * a hash of each .proto file, so we can tell if the compiled file is stale.
+ */
+bool PidStoreLoader::CompiledFileHeader(const vector<string> &files,
+                                        string *header) {
+  ostringstream str;
+  str << COMPILED_FILE_MAGIC << "\n";
+
+  vector<string>::const_iterator iter = files.begin();
+  for (; iter != files.end(); ++iter) {
+    std::ifstream proto_file(iter->c_str(), std::ios::in | std::ios::binary);
+    if (!proto_file.is_open()) {
+      OLA_WARN << "Failed to open " << *iter << ": " << strerror(errno);
+      return false;
+    }
+
+    // 32 bit FNV-1a
+    uint32_t hash = 2166136261u;
+    unsigned int size = 0;
+    char buffer[4096];
+    while (proto_file.read(buffer, sizeof(buffer)) || proto_file.gcount()) {
+      std::streamsize length = proto_file.gcount();
+      for (std::streamsize i = 0; i < length; i++) {
+        hash = (hash ^ static_cast<uint8_t>(buffer[i])) * 16777619u;
+      }
+      size += length;
+    }
+    str << ola::file::FilenameFromPath(*iter) << " " << size << " "
+        << strings::ToHex(hash, false) << "\n";
+  }
+  str << "\n";
+  *header = str.str();
+  return true;
+}
+
 /*
  * Build the RootPidStore from a protocol buffer.
  */
 const RootPidStore *PidStoreLoader::BuildStore(
-    const ola::rdm::pid::PidStore &store_pb,
-    const ola::rdm::pid::PidStore &override_pb,
-    bool validate) {
+    ola::rdm::pid::PidStore *store_pb,
+    ola::rdm::pid::PidStore *override_pb,
+    bool validate,
+    bool lazy) {
   ManufacturerMap pid_data;
   // Load the overrides first so they get first dibs on each PID.
-  if (!LoadFromProto(&pid_data, override_pb, validate)) {
+  if (!LoadFromProto(&pid_data, override_pb, validate, false)) {
     FreeManufacturerMap(&pid_data);
     return NULL;
   }
 
   // Load the main data
-  if (!LoadFromProto(&pid_data, store_pb, validate)) {
+  if (!LoadFromProto(&pid_data, store_pb, validate, lazy)) {
     FreeManufacturerMap(&pid_data);
     return NULL;
   }
@@ -190,7 +330,7 @@ const RootPidStore *PidStoreLoader::BuildStore(
   OLA_DEBUG << "Load Complete";
   return new RootPidStore(esta_store.release(),
                           manufacturer_map,
-                          store_pb.version());
+                          store_pb->version());
 }
 
 /*
@@ -198,34 +338,37 @@ const RootPidStore *PidStoreLoader::BuildStore(
  * @param[out] pid_data the ManufacturerMap to populate.
  * @param proto the Protobuf data.
  * @param validate Enables strict validation mode.
+ * @param lazy Build the Descriptors for each PID on first use. The Pid
+ *   messages are moved out of the proto.
  *
  * If a collision occurs, the data in the map is not replaced.
  */
 bool PidStoreLoader::LoadFromProto(ManufacturerMap *pid_data,
-                                   const ola::rdm::pid::PidStore &proto,
-                                   bool validate) {
+                                   ola::rdm::pid::PidStore *proto,
+                                   bool validate,
+                                   bool lazy) {
   set<uint16_t> seen_manufacturer_ids;
 
   ManufacturerMap::iterator iter = STLLookupOrInsertNew(
       pid_data, ESTA_MANUFACTURER_ID);
-  if (!GetPidList(iter->second, proto, validate, true)) {
+  if (!GetPidList(iter->second, proto, validate, lazy, true)) {
     return false;
   }
 
-  for (int i = 0; i < proto.manufacturer_size(); ++i) {
-    const ola::rdm::pid::Manufacturer &manufacturer = proto.manufacturer(i);
+  for (int i = 0; i < proto->manufacturer_size(); ++i) {
+    ola::rdm::pid::Manufacturer *manufacturer = proto->mutable_manufacturer(i);
 
-    if (STLContains(seen_manufacturer_ids, manufacturer.manufacturer_id())) {
-      OLA_WARN << "Manufacturer id " << manufacturer.manufacturer_id() <<
-          "(" << manufacturer.manufacturer_name() <<
+    if (STLContains(seen_manufacturer_ids, manufacturer->manufacturer_id())) {
+      OLA_WARN << "Manufacturer id " << manufacturer->manufacturer_id() <<
+          "(" << manufacturer->manufacturer_name() <<
           ") listed more than once in the PIDs file";
       return false;
     }
-    seen_manufacturer_ids.insert(manufacturer.manufacturer_id());
+    seen_manufacturer_ids.insert(manufacturer->manufacturer_id());
 
     ManufacturerMap::iterator iter = STLLookupOrInsertNew(
-        pid_data, manufacturer.manufacturer_id());
-    if (!GetPidList(iter->second, manufacturer, validate, false)) {
+        pid_data, manufacturer->manufacturer_id());
+    if (!GetPidList(iter->second, manufacturer, validate, lazy, false)) {
       return false;
     }
   }
@@ -239,14 +382,15 @@ bool PidStoreLoader::LoadFromProto(ManufacturerMap *pid_data,
  */
 template <typename pb_object>
 bool PidStoreLoader::GetPidList(PidMap *pid_map,
-                                const pb_object &store,
+                                pb_object *store,
                                 bool validate,
+                                bool lazy,
                                 bool limit_pid_values) {
   set<uint16_t> seen_pids;
   set<string> seen_names;
 
-  for (int i = 0; i < store.pid_size(); ++i) {
-    const ola::rdm::pid::Pid &pid = store.pid(i);
+  for (int i = 0; i < store->pid_size(); ++i) {
+    const ola::rdm::pid::Pid &pid = store->pid(i);
 
     OLA_DEBUG << "Loading " << pid.name();
     if (validate) {
@@ -279,7 +423,9 @@ bool PidStoreLoader::GetPidList(PidMap *pid_map,
       continue;
     }
 
-    const PidDescriptor *descriptor = PidToDescriptor(pid, validate);
+    const PidDescriptor *descriptor = lazy ?
+        PidToLazyDescriptor(store->mutable_pid(i)) :
+        PidToDescriptor(pid, validate);
     if (!descriptor) {
       return false;
     }
@@ -353,6 +499,25 @@ PidDescriptor *PidStoreLoader::PidToDescriptor(const ola::rdm::pid::Pid &pid,
   return descriptor;
 }
 
+/*
+ * Build a PidDescriptor which converts the frame formats on first use.
+ */
+PidDescriptor *PidStoreLoader::PidToLazyDescriptor(ola::rdm::pid::Pid *pid) {
+  PidDescriptor::sub_device_validator get_validator =
+    PidDescriptor::ANY_SUB_DEVICE;
+  if (pid->has_get_sub_device_range())
+    get_validator = ConvertSubDeviceValidator(pid->get_sub_device_range());
+  PidDescriptor::sub_device_validator set_validator =
+    PidDescriptor::ANY_SUB_DEVICE;
+  if (pid->has_set_sub_device_range())
+    set_validator = ConvertSubDeviceValidator(pid->set_sub_device_range());
+
+  const string name = pid->name();
+  const uint16_t value = pid->value();
+  return new PidDescriptor(name, value, new ProtoFrameBuilder(pid),
+                           get_validator, set_validator);
+}
+
 /*
  * Convert a protobuf frame format to a Descriptor object
  */
@@ -585,5 +750,24 @@ void PidStoreLoader::FreeManufacturerMap(ManufacturerMap *data) {
   }
   data->clear();
 }
+
+/*
+ * The data was validated when the store was compiled, so we don't validate it
+ * again here.
+ */
+void ProtoFrameBuilder::BuildFrames(const Descriptor **get_request,
+                                    const Descriptor **get_response,
+                                    const Descriptor **set_request,
+                                    const Descriptor **set_response) {
+  PidStoreLoader loader;
+  *get_request = m_pid.has_get_request() ?
+      loader.FrameFormatToDescriptor(m_pid.get_request(), false) : NULL;
+  *get_response = m_pid.has_get_response() ?
+      loader.FrameFormatToDescriptor(m_pid.get_response(), false) : NULL;
+  *set_request = m_pid.has_set_request() ?
+      loader.FrameFormatToDescriptor(m_pid.set_request(), false) : NULL;
+  *set_response = m_pid.has_set_response() ?
+      loader.FrameFormatToDescriptor(m_pid.set_response(), false) : NULL;
+}
 }  // namespace rdm
 }  // namespace ola
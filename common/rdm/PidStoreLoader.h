@@ -57,12 +57,35 @@ class PidStoreLoader {
    * @param directory the directory to load files from.
    * @param validate set to true if we should perform validation of the
    *   contents.
+   * @param use_compiled use the compiled store in the directory, if it's up
+   *   to date with the .proto files.
    * @returns A pointer to a new RootPidStore or NULL if loading failed.
    *
    * This is an all-or-nothing load. Any error with cause us to abort the load.
+   *
+   * The compiled store was validated when it was built, so the Descriptors for
+   * each PID are only built when the PID is first used.
    */
   const RootPidStore *LoadFromDirectory(const std::string &directory,
-                                        bool validate = true);
+                                        bool validate = true,
+                                        bool use_compiled = true);
+
+  /**
+   * @brief Compile the .proto files in a directory into a single binary file.
+   * @param directory the directory containing the .proto files.
+   * @param output_file the file to write.
+   * @returns true if the data was valid and the file was written, false
+   *   otherwise.
+   *
+   * The overrides file isn't included, since it's a local system override.
+   */
+  bool CompileDirectory(const std::string &directory,
+                        const std::string &output_file);
+
+  /**
+   * @brief The name of the compiled store within the PID data directory.
+   */
+  static const char COMPILED_FILE_NAME[];
 
   /**
    * @brief Load Pid information from a stream
@@ -82,23 +105,37 @@ class PidStoreLoader {
 
   bool ReadFile(const std::string &file_path,
                 ola::rdm::pid::PidStore *proto);
-
-  const RootPidStore *BuildStore(const ola::rdm::pid::PidStore &store_pb,
-                                 const ola::rdm::pid::PidStore &override_pb,
-                                 bool validate);
+  void ListProtoFiles(const std::string &directory,
+                      std::vector<std::string> *files,
+                      std::string *override_file);
+  bool ReadFiles(const std::vector<std::string> &files,
+                 ola::rdm::pid::PidStore *proto);
+  bool ReadCompiledFile(const std::string &file_path,
+                        const std::vector<std::string> &files,
+                        ola::rdm::pid::PidStore *proto);
+  bool CompiledFileHeader(const std::vector<std::string> &files,
+                          std::string *header);
+
+  const RootPidStore *BuildStore(ola::rdm::pid::PidStore *store_pb,
+                                 ola::rdm::pid::PidStore *override_pb,
+                                 bool validate,
+                                 bool lazy = false);
 
   bool LoadFromProto(ManufacturerMap *pid_data,
-                     const ola::rdm::pid::PidStore &proto,
-                     bool validate);
+                     ola::rdm::pid::PidStore *proto,
+                     bool validate,
+                     bool lazy);
 
   template <typename pb_object>
   bool GetPidList(PidMap *pid_map,
-                  const pb_object &store,
+                  pb_object *store,
                   bool validate,
+                  bool lazy,
                   bool limit_pid_values);
 
   PidDescriptor *PidToDescriptor(const ola::rdm::pid::Pid &pid,
                                  bool validate);
+  PidDescriptor *PidToLazyDescriptor(ola::rdm::pid::Pid *pid);
   const ola::messaging::Descriptor* FrameFormatToDescriptor(
       const ola::rdm::pid::FrameFormat &format,
       bool validate);
@@ -119,12 +156,41 @@ class PidStoreLoader {
   void FreeManufacturerMap(ManufacturerMap *data);
 
   static const char OVERRIDE_FILE_NAME[];
+  static const char COMPILED_FILE_MAGIC[];
   static const uint16_t ESTA_MANUFACTURER_ID;
   static const uint16_t MANUFACTURER_PID_MIN;
   static const uint16_t MANUFACTURER_PID_MAX;
 
+  friend class ProtoFrameBuilder;
+
   DISALLOW_COPY_AND_ASSIGN(PidStoreLoader);
 };
+
+
+/**
+ * @brief Builds the Descriptors for a PID from the Pid protobuf.
+ */
+class ProtoFrameBuilder : public PidFrameBuilder {
+ public:
+  /**
+   * @brief Create a new ProtoFrameBuilder.
+   * @param pid the Pid protobuf. The contents are swapped into the builder,
+   *   leaving pid empty.
+   */
+  explicit ProtoFrameBuilder(ola::rdm::pid::Pid *pid) {
+    m_pid.Swap(pid);
+  }
+
+  void BuildFrames(const ola::messaging::Descriptor **get_request,
+                   const ola::messaging::Descriptor **get_response,
+                   const ola::messaging::Descriptor **set_request,
+                   const ola::messaging::Descriptor **set_response);
+
+ private:
+  ola::rdm::pid::Pid m_pid;
+
+  DISALLOW_COPY_AND_ASSIGN(ProtoFrameBuilder);
+};
 }  // namespace rdm
 }  // namespace ola
 #endif  // COMMON_RDM_PIDSTORELOADER_H_
@@ -19,7 +19,10 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <fstream>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -28,6 +31,7 @@
 #include "common/rdm/PidStoreLoader.h"
 #include "ola/Constants.h"
 #include "ola/Logging.h"
+#include "ola/file/Util.h"
 #include "ola/messaging/Descriptor.h"
 #include "ola/messaging/SchemaPrinter.h"
 #include "ola/rdm/PidStore.h"
@@ -56,6 +60,7 @@ class PidStoreTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testPidStoreLoad);
   CPPUNIT_TEST(testPidStoreFileLoad);
   CPPUNIT_TEST(testPidStoreDirectoryLoad);
+  CPPUNIT_TEST(testPidStoreCompiledLoad);
   CPPUNIT_TEST(testPidStoreLoadMissingFile);
   CPPUNIT_TEST(testPidStoreLoadDuplicateManufacturer);
   CPPUNIT_TEST(testPidStoreLoadDuplicateValue);
@@ -70,6 +75,7 @@ class PidStoreTest: public CppUnit::TestFixture {
   void testPidStoreLoad();
   void testPidStoreFileLoad();
   void testPidStoreDirectoryLoad();
+  void testPidStoreCompiledLoad();
   void testPidStoreLoadMissingFile();
   void testPidStoreLoadDuplicateManufacturer();
   void testPidStoreLoadDuplicateValue();
@@ -84,6 +90,12 @@ class PidStoreTest: public CppUnit::TestFixture {
     path.append(filename);
     return path;
   }
+
+  void CopyFile(const string &source, const string &destination) {
+    std::ifstream input(source.c_str(), std::ios::binary);
+    std::ofstream output(destination.c_str(), std::ios::binary);
+    output << input.rdbuf();
+  }
 };
 
 
@@ -443,6 +455,77 @@ void PidStoreTest::testPidStoreDirectoryLoad() {
 }
 
 
+/**
+ * Check that the compiled store matches the .proto files, and that it's
+ * ignored once the .proto files change.
+ */
+void PidStoreTest::testPidStoreCompiledLoad() {
+  char directory_template[] = "/tmp/ola-pid-store-XXXXXX";
+  OLA_ASSERT_NOT_NULL(mkdtemp(directory_template));
+  const string directory = directory_template;
+
+  const char *files[] = {"overrides.proto", "pids1.proto", "pids2.proto"};
+  for (unsigned int i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+    CopyFile(GetTestDataFile(string("pids/") + files[i]),
+             ola::file::JoinPaths(directory, files[i]));
+  }
+  const string compiled_file = ola::file::JoinPaths(
+      directory, PidStoreLoader::COMPILED_FILE_NAME);
+
+  PidStoreLoader loader;
+  OLA_ASSERT_TRUE(loader.CompileDirectory(directory, compiled_file));
+
+  auto_ptr<const RootPidStore> root_store(
+      loader.LoadFromDirectory(directory));
+  OLA_ASSERT_NOT_NULL(root_store.get());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1302986774), root_store->Version());
+  OLA_ASSERT_NOT_NULL(root_store->EstaStore());
+  OLA_ASSERT_EQ(4u, root_store->EstaStore()->PidCount());
+
+  // The overrides file still applies.
+  const PidDescriptor *foo_bar = root_store->GetDescriptor(
+      "FOO_BAR", ola::OPEN_LIGHTING_ESTA_CODE);
+  OLA_ASSERT_NOT_NULL(foo_bar);
+  OLA_ASSERT_NULL(root_store->GetDescriptor("SERIAL_NUMBER",
+                                            ola::OPEN_LIGHTING_ESTA_CODE));
+
+  // The descriptors are built on first use.
+  const PidDescriptor *proxied_devices = root_store->GetDescriptor(
+      "PROXIED_DEVICES");
+  OLA_ASSERT_NOT_NULL(proxied_devices);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(16), proxied_devices->Value());
+  OLA_ASSERT_TRUE(proxied_devices->IsGetValid(0));
+  OLA_ASSERT_FALSE(proxied_devices->IsGetValid(1));
+  OLA_ASSERT_FALSE(proxied_devices->IsSetValid(0));
+  OLA_ASSERT_NOT_NULL(proxied_devices->GetRequest());
+  OLA_ASSERT_NULL(proxied_devices->SetRequest());
+  OLA_ASSERT_NULL(proxied_devices->SetResponse());
+
+  ola::messaging::SchemaPrinter printer;
+  proxied_devices->GetResponse()->Accept(&printer);
+  OLA_ASSERT_EQ(
+      string("uids {\n  manufacturer_id: uint16\n  device_id: uint32\n}\n"),
+      printer.AsString());
+
+  // Change one of the .proto files, the compiled store is now out of date.
+  {
+    std::ofstream output(ola::file::JoinPaths(directory, "pids1.proto").c_str(),
+                         std::ios::app);
+    output << "pid {\n  name: \"NEW_PID\"\n  value: 48\n}\n";
+  }
+  root_store.reset(loader.LoadFromDirectory(directory));
+  OLA_ASSERT_NOT_NULL(root_store.get());
+  OLA_ASSERT_EQ(5u, root_store->EstaStore()->PidCount());
+  OLA_ASSERT_NOT_NULL(root_store->GetDescriptor("NEW_PID"));
+
+  for (unsigned int i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+    unlink(ola::file::JoinPaths(directory, files[i]).c_str());
+  }
+  unlink(compiled_file.c_str());
+  rmdir(directory.c_str());
+}
+
+
 /**
  * Check that loading a missing file fails.
  */
@@ -315,6 +315,14 @@ uint16_t RDMRequest::Checksum(uint16_t checksum) const {
       m_override_options.checksum : checksum;
 }
 
+bool RDMRequest::BypassCache() const {
+  return (m_override_options.bypass_cache ||
+          m_override_options.has_message_length ||
+          m_override_options.has_checksum ||
+          m_override_options.sub_start_code != SUB_START_CODE ||
+          m_override_options.message_count != 0);
+}
+
 RDMRequest* RDMRequest::InflateFromData(const uint8_t *data,
                                         unsigned int length) {
   RDMCommandHeader command_message;
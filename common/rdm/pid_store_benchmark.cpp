@@ -0,0 +1,134 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * pid_store_benchmark.cpp
+ * Compare the time taken to load the PID store from the .proto files and from
+ * the compiled store.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/rdm/PidStoreLoader.h"
+#include "ola/Clock.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/file/Util.h"
+#include "ola/rdm/PidStore.h"
+
+using ola::Clock;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::rdm::PidDescriptor;
+using ola::rdm::PidStore;
+using ola::rdm::PidStoreLoader;
+using ola::rdm::RootPidStore;
+using std::auto_ptr;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+DEFINE_string(pid_location, "",
+              "The directory containing the PID data, defaults to the "
+              "installed location");
+DEFINE_s_uint32(iterations, i, 10, "The number of loads to run");
+
+/*
+ * Build the Descriptors for every PID in a store, which is what a client that
+ * uses every PID would trigger.
+ */
+unsigned int BuildDescriptors(const PidStore *store) {
+  if (!store) {
+    return 0;
+  }
+  vector<const PidDescriptor*> pids;
+  store->AllPids(&pids);
+  unsigned int frames = 0;
+  vector<const PidDescriptor*>::const_iterator iter = pids.begin();
+  for (; iter != pids.end(); ++iter) {
+    frames += ((*iter)->GetRequest() != NULL) +
+              ((*iter)->GetResponse() != NULL) +
+              ((*iter)->SetRequest() != NULL) +
+              ((*iter)->SetResponse() != NULL);
+  }
+  return frames;
+}
+
+/*
+ * Load the store & print the average time taken.
+ */
+void RunBenchmark(const string &description, const string &directory,
+                  bool validate, bool use_compiled, bool build_all) {
+  Clock clock;
+  unsigned int pid_count = 0;
+
+  TimeStamp start, end;
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < FLAGS_iterations; i++) {
+    PidStoreLoader loader;
+    auto_ptr<const RootPidStore> store(
+        loader.LoadFromDirectory(directory, validate, use_compiled));
+    if (!store.get()) {
+      cout << description << ": failed to load " << directory << endl;
+      return;
+    }
+    pid_count = store->EstaStore() ? store->EstaStore()->PidCount() : 0;
+    if (build_all) {
+      BuildDescriptors(store->EstaStore());
+    }
+  }
+  clock.CurrentTime(&end);
+
+  TimeInterval duration = end - start;
+  double ms_per_load = duration.AsInt() / 1000.0 / FLAGS_iterations;
+  cout << std::left << std::setw(32) << description << std::right
+       << std::setw(10) << std::fixed << std::setprecision(2) << ms_per_load
+       << " ms/load (" << pid_count << " ESTA PIDs)" << endl;
+}
+
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "[options]",
+               "Benchmark loading the RDM PID store.");
+
+  if (FLAGS_iterations == 0) {
+    ola::DisplayUsageAndExit();
+  }
+
+  string directory = FLAGS_pid_location.str();
+  if (directory.empty()) {
+    directory = RootPidStore::DataLocation();
+  }
+
+  cout << "Loading " << directory << ", " << FLAGS_iterations
+       << " iterations" << endl;
+  RunBenchmark("text, validated", directory, true, false, false);
+  RunBenchmark("text, not validated", directory, false, false, false);
+
+  string compiled_file = ola::file::JoinPaths(
+      directory, PidStoreLoader::COMPILED_FILE_NAME);
+  if (!std::ifstream(compiled_file.c_str()).is_open()) {
+    cout << "No " << compiled_file << ", run pid_store_compiler to create it"
+         << endl;
+    return 0;
+  }
+  RunBenchmark("compiled", directory, false, true, false);
+  RunBenchmark("compiled, all ESTA PIDs used", directory, false, true, true);
+  return 0;
+}
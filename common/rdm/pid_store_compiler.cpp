@@ -0,0 +1,49 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * pid_store_compiler.cpp
+ * Compile the RDM PID .proto files into the binary store olad loads at
+ * startup.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdlib.h>
+#include <iostream>
+#include <string>
+
+#include "common/rdm/PidStoreLoader.h"
+#include "ola/base/Flags.h"
+#include "ola/base/Init.h"
+#include "ola/base/SysExits.h"
+
+using ola::rdm::PidStoreLoader;
+using std::cerr;
+using std::endl;
+using std::string;
+
+int main(int argc, char *argv[]) {
+  ola::AppInit(&argc, argv, "<pid-data-dir> <output-file>",
+               "Compile the PID .proto files into a binary store.");
+
+  if (argc != 3) {
+    ola::DisplayUsageAndExit();
+  }
+
+  PidStoreLoader loader;
+  if (!loader.CompileDirectory(argv[1], argv[2])) {
+    cerr << "Failed to compile the PID data in " << argv[1] << endl;
+    exit(ola::EXIT_DATAERR);
+  }
+  return ola::EXIT_OK;
+}
@@ -34,7 +34,7 @@
 #include "common/rpc/RpcService.h"
 #include "ola/Callback.h"
 #include "ola/Logging.h"
-#include "ola/base/Array.h"
+#include "ola/io/SelectServerInterface.h"
 #include "ola/stl/STLUtils.h"
 
 namespace ola {
@@ -50,14 +50,9 @@ const char RpcChannel::K_RPC_RECEIVED_TYPE_VAR[] = "rpc-received-type";
 const char RpcChannel::K_RPC_RECEIVED_VAR[] = "rpc-received";
 const char RpcChannel::K_RPC_SENT_ERROR_VAR[] = "rpc-send-errors";
 const char RpcChannel::K_RPC_SENT_VAR[] = "rpc-sent";
+const char RpcChannel::K_RPC_STREAM_DROPPED_VAR[] = "rpc-stream-dropped";
 const char RpcChannel::STREAMING_NO_RESPONSE[] = "STREAMING_NO_RESPONSE";
 
-const char *RpcChannel::K_RPC_VARIABLES[] = {
-  K_RPC_RECEIVED_VAR,
-  K_RPC_SENT_ERROR_VAR,
-  K_RPC_SENT_VAR,
-};
-
 class OutstandingRequest {
   /*
    * These are requests on the server end that haven't completed yet.
@@ -117,8 +112,11 @@ RpcChannel::RpcChannel(
       m_buffer_size(0),
       m_expected_size(0),
       m_current_size(0),
-      m_export_map(export_map),
-      m_recv_type_map(NULL) {
+      m_ss(NULL),
+      m_max_stream_messages(0),
+      m_queued_stream_messages(0),
+      m_write_offset(0),
+      m_write_registered(false) {
   if (descriptor) {
     descriptor->SetOnData(
         ola::NewCallback(this, &RpcChannel::DescriptorReady));
@@ -126,16 +124,30 @@ RpcChannel::RpcChannel(
         ola::NewSingleCallback(this, &RpcChannel::HandleChannelClose));
   }
 
-  if (m_export_map) {
-    for (unsigned int i = 0; i < arraysize(K_RPC_VARIABLES); ++i) {
-      m_export_map->GetCounterVar(string(K_RPC_VARIABLES[i]));
-    }
-    m_recv_type_map = m_export_map->GetUIntMapVar(K_RPC_RECEIVED_TYPE_VAR,
-                                                  "type");
+  if (export_map) {
+    m_received_var = export_map->GetCounter(K_RPC_RECEIVED_VAR);
+    m_send_errors_var = export_map->GetCounter(K_RPC_SENT_ERROR_VAR);
+    m_sent_var = export_map->GetCounter(K_RPC_SENT_VAR);
+    m_stream_dropped_var = export_map->GetCounter(K_RPC_STREAM_DROPPED_VAR);
+
+    export_map->GetUIntMapVar(K_RPC_RECEIVED_TYPE_VAR, "type");
+    m_recv_request_var = export_map->GetCounter(K_RPC_RECEIVED_TYPE_VAR,
+                                                "request");
+    m_recv_response_var = export_map->GetCounter(K_RPC_RECEIVED_TYPE_VAR,
+                                                 "response");
+    m_recv_cancelled_var = export_map->GetCounter(K_RPC_RECEIVED_TYPE_VAR,
+                                                  "cancelled");
+    m_recv_failed_var = export_map->GetCounter(K_RPC_RECEIVED_TYPE_VAR,
+                                               "failed");
+    m_recv_not_implemented_var = export_map->GetCounter(
+        K_RPC_RECEIVED_TYPE_VAR, "not-implemented");
+    m_recv_stream_request_var = export_map->GetCounter(
+        K_RPC_RECEIVED_TYPE_VAR, "stream_request");
   }
 }
 
 RpcChannel::~RpcChannel() {
+  ClearWriteQueue();
   free(m_buffer);
 }
 
@@ -273,6 +285,41 @@ void RpcChannel::RequestComplete(OutstandingRequest *request) {
   DeleteOutstandingRequest(request);
 }
 
+void RpcChannel::EnableWriteQueue(ola::io::SelectServerInterface *ss,
+                                  unsigned int max_stream_messages) {
+  if (!m_descriptor) {
+    return;
+  }
+  m_ss = ss;
+  m_max_stream_messages = max_stream_messages;
+  m_descriptor->SetOnWritable(
+      ola::NewCallback(this, &RpcChannel::DescriptorWritable));
+}
+
+bool RpcChannel::SendEncodedStreamRequest(const string &data) {
+  return SendFramedMsg(data, true);
+}
+
+bool RpcChannel::EncodeStreamRequest(const MethodDescriptor *method,
+                                     const Message &request,
+                                     string *output) {
+  if (method->output_type()->name() != STREAMING_NO_RESPONSE) {
+    OLA_WARN << "Can't encode " << method->name()
+             << " as a stream request, the output type isn't "
+             << STREAMING_NO_RESPONSE;
+    return false;
+  }
+
+  RpcMessage message;
+  message.set_type(STREAM_REQUEST);
+  // Stream requests never get a response, so the id isn't used.
+  message.set_id(0);
+  message.set_name(method->name());
+  request.SerializeToString(message.mutable_buffer());
+  FrameMsg(message, output);
+  return true;
+}
+
 RpcSession *RpcChannel::Session() {
   return m_session.get();
 }
@@ -284,47 +331,168 @@ RpcSession *RpcChannel::Session() {
  * Write an RpcMessage to the write descriptor.
  */
 bool RpcChannel::SendMsg(RpcMessage *msg) {
+  string output;
+  FrameMsg(*msg, &output);
+  return SendFramedMsg(output, msg->type() == STREAM_REQUEST);
+}
+
+
+/*
+ * Write a framed message to the write descriptor, or queue it if the
+ * descriptor would block.
+ */
+bool RpcChannel::SendFramedMsg(const string &data, bool is_stream) {
   if (!(m_descriptor && m_descriptor->ValidReadDescriptor())) {
     OLA_WARN << "RPC descriptor closed, not sending messages";
     return false;
   }
 
-  uint32_t header;
-  // reserve the first 4 bytes for the header
-  string output(sizeof(header), 0);
-  msg->AppendToString(&output);
-  int length = output.size();
-
-  RpcHeader::EncodeHeader(&header, PROTOCOL_VERSION,
-                                length - sizeof(header));
-  output.replace(
-      0, sizeof(header),
-      reinterpret_cast<const char*>(&header), sizeof(header));
+  if (!m_write_queue.empty()) {
+    // Keep the messages in order
+    QueueMsg(data, is_stream);
+    return true;
+  }
 
   ssize_t ret = m_descriptor->Send(
-      reinterpret_cast<const uint8_t*>(output.data()), length);
+      reinterpret_cast<const uint8_t*>(data.data()), data.size());
+
+  if (ret != static_cast<ssize_t>(data.size())) {
+    if (m_ss && (ret >= 0 || errno == EAGAIN || errno == EWOULDBLOCK)) {
+      m_write_offset = ret > 0 ? ret : 0;
+      QueueMsg(data, is_stream);
+      return true;
+    }
 
-  if (ret != length) {
     OLA_WARN << "Failed to send full RPC message, closing channel";
+    SendFailed();
+    return false;
+  }
 
-    if (m_export_map) {
-      (*m_export_map->GetCounterVar(K_RPC_SENT_ERROR_VAR))++;
-    }
+  m_sent_var++;
+  return true;
+}
 
-    // At this point there is no point using the descriptor since framing has
-    // probably been messed up.
-    // TODO(simon): consider if it's worth leaving the descriptor open for
-    // reading.
-    m_descriptor = NULL;
 
-    HandleChannelClose();
-    return false;
+/*
+ * Add a message to the write queue, dropping the oldest stream requests if
+ * there are too many.
+ */
+void RpcChannel::QueueMsg(const string &data, bool is_stream) {
+  m_write_queue.push_back(QueuedMessage());
+  m_write_queue.back().data = data;
+  m_write_queue.back().is_stream = is_stream;
+  if (is_stream) {
+    m_queued_stream_messages++;
+  }
+
+  // A message that has been partially sent can't be dropped without breaking
+  // the framing.
+  WriteQueue::iterator iter = m_write_queue.begin();
+  if (m_write_offset) {
+    ++iter;
+  }
+  while (m_queued_stream_messages > m_max_stream_messages &&
+         iter != m_write_queue.end()) {
+    if (iter->is_stream) {
+      iter = m_write_queue.erase(iter);
+      m_queued_stream_messages--;
+      m_stream_dropped_var++;
+    } else {
+      ++iter;
+    }
   }
 
-  if (m_export_map) {
-    (*m_export_map->GetCounterVar(K_RPC_SENT_VAR))++;
+  if (!m_write_registered) {
+    m_ss->AddWriteDescriptor(m_descriptor);
+    m_write_registered = true;
   }
-  return true;
+}
+
+
+/*
+ * Called when the descriptor can be written to, this sends as much of the
+ * write queue as possible.
+ */
+void RpcChannel::DescriptorWritable() {
+  while (!m_write_queue.empty()) {
+    const QueuedMessage &msg = m_write_queue.front();
+    unsigned int remaining = msg.data.size() - m_write_offset;
+    ssize_t ret = m_descriptor->Send(
+        reinterpret_cast<const uint8_t*>(msg.data.data()) + m_write_offset,
+        remaining);
+
+    if (ret < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        OLA_WARN << "Failed to send queued RPC message, closing channel";
+        SendFailed();
+      }
+      return;
+    }
+
+    if (static_cast<unsigned int>(ret) != remaining) {
+      m_write_offset += ret;
+      return;
+    }
+
+    if (msg.is_stream) {
+      m_queued_stream_messages--;
+    }
+    m_write_queue.pop_front();
+    m_write_offset = 0;
+
+    m_sent_var++;
+  }
+
+  m_ss->RemoveWriteDescriptor(m_descriptor);
+  m_write_registered = false;
+}
+
+
+/*
+ * Discard any queued messages.
+ */
+void RpcChannel::ClearWriteQueue() {
+  if (m_write_registered && m_descriptor) {
+    m_ss->RemoveWriteDescriptor(m_descriptor);
+  }
+  m_write_registered = false;
+  m_write_queue.clear();
+  m_queued_stream_messages = 0;
+  m_write_offset = 0;
+}
+
+
+/*
+ * Called when a write fails.
+ */
+void RpcChannel::SendFailed() {
+  m_send_errors_var++;
+
+  // At this point there is no point using the descriptor since framing has
+  // probably been messed up.
+  // TODO(simon): consider if it's worth leaving the descriptor open for
+  // reading.
+  ClearWriteQueue();
+  m_descriptor = NULL;
+
+  HandleChannelClose();
+}
+
+
+/*
+ * Add the RPC header to a message.
+ */
+void RpcChannel::FrameMsg(const RpcMessage &msg, string *output) {
+  uint32_t header;
+  // reserve the first 4 bytes for the header
+  output->assign(sizeof(header), 0);
+  msg.AppendToString(output);
+
+  RpcHeader::EncodeHeader(&header, PROTOCOL_VERSION,
+                          output->size() - sizeof(header));
+  output->replace(
+      0, sizeof(header),
+      reinterpret_cast<const char*>(&header), sizeof(header));
 }
 
 
@@ -393,38 +561,31 @@ bool RpcChannel::HandleNewMsg(uint8_t *data, unsigned int size) {
     return false;
   }
 
-  if (m_export_map)
-    (*m_export_map->GetCounterVar(K_RPC_RECEIVED_VAR))++;
+  m_received_var++;
 
   switch (msg.type()) {
     case REQUEST:
-      if (m_recv_type_map)
-        (*m_recv_type_map)["request"]++;
+      m_recv_request_var++;
       HandleRequest(&msg);
       break;
     case RESPONSE:
-      if (m_recv_type_map)
-        (*m_recv_type_map)["response"]++;
+      m_recv_response_var++;
       HandleResponse(&msg);
       break;
     case RESPONSE_CANCEL:
-      if (m_recv_type_map)
-        (*m_recv_type_map)["cancelled"]++;
+      m_recv_cancelled_var++;
       HandleCanceledResponse(&msg);
       break;
     case RESPONSE_FAILED:
-      if (m_recv_type_map)
-        (*m_recv_type_map)["failed"]++;
+      m_recv_failed_var++;
       HandleFailedResponse(&msg);
       break;
     case RESPONSE_NOT_IMPLEMENTED:
-      if (m_recv_type_map)
-        (*m_recv_type_map)["not-implemented"]++;
+      m_recv_not_implemented_var++;
       HandleNotImplemented(&msg);
       break;
     case STREAM_REQUEST:
-      if (m_recv_type_map)
-        (*m_recv_type_map)["stream_request"]++;
+      m_recv_stream_request_var++;
       HandleStreamRequest(&msg);
       break;
     default:
@@ -625,6 +786,7 @@ void RpcChannel::HandleNotImplemented(RpcMessage *msg) {
  * Invoke the Channel close handler/
  */
 void RpcChannel::HandleChannelClose() {
+  ClearWriteQueue();
   if (m_on_close.get()) {
     m_on_close.release()->Run(m_session.get());
   }
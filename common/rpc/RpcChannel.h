@@ -30,13 +30,20 @@
 #include <ola/Callback.h>
 #include <ola/io/Descriptor.h>
 #include <ola/util/SequenceNumber.h>
+#include <deque>
 #include <memory>
+#include <string>
 
 #include "ola/ExportMap.h"
 
 #include HASH_MAP_H
 
 namespace ola {
+
+namespace io {
+class SelectServerInterface;
+}
+
 namespace rpc {
 
 class RpcMessage;
@@ -117,6 +124,46 @@ class RpcChannel {
                     google::protobuf::Message *response,
                     SingleUseCallback0<void> *done);
 
+    /**
+     * @brief Queue outgoing messages when the descriptor would block, rather
+     * than closing the channel.
+     * @param ss the SelectServer to register the descriptor with while there
+     *   is queued data. Ownership is not transferred.
+     * @param max_stream_messages the maximum number of streaming requests to
+     *   queue. Once this is reached, the oldest queued streaming request is
+     *   dropped. Other messages are never dropped.
+     *
+     * The descriptor must be non-blocking for this to have any effect.
+     */
+    void EnableWriteQueue(ola::io::SelectServerInterface *ss,
+                          unsigned int max_stream_messages);
+
+    /**
+     * @brief Send a streaming request that was encoded with
+     *   EncodeStreamRequest().
+     * @param data the encoded request.
+     * @returns true if the request was sent or queued, false if the channel
+     *   has failed.
+     *
+     * This allows the same request to be sent to many channels while only
+     * serializing it once.
+     */
+    bool SendEncodedStreamRequest(const std::string &data);
+
+    /**
+     * @brief Serialize a call to a streaming method, ready to be sent with
+     *   SendEncodedStreamRequest().
+     * @param method the streaming method to call.
+     * @param request the request to send.
+     * @param[out] output the encoded message, including the RPC header.
+     * @returns true if the request was encoded, false if the method isn't a
+     *   streaming method.
+     */
+    static bool EncodeStreamRequest(
+        const google::protobuf::MethodDescriptor *method,
+        const google::protobuf::Message &request,
+        std::string *output);
+
     /**
      * @brief Invoked by the RPC completion handler when the server side
      * response is ready.
@@ -139,6 +186,13 @@ class RpcChannel {
     typedef HASH_NAMESPACE::HASH_MAP_CLASS<int, class OutstandingResponse*>
       ResponseMap;
 
+    // A framed message waiting for the descriptor to become writable.
+    struct QueuedMessage {
+      std::string data;
+      bool is_stream;  // true if the message can be dropped
+    };
+    typedef std::deque<QueuedMessage> WriteQueue;
+
     std::auto_ptr<RpcSession> m_session;
     RpcService *m_service;  // service to dispatch requests to
     std::auto_ptr<CloseCallback> m_on_close;
@@ -151,10 +205,31 @@ class RpcChannel {
     unsigned int m_current_size;  // the amount of data read for the current msg
     HASH_NAMESPACE::HASH_MAP_CLASS<int, class OutstandingRequest*> m_requests;
     ResponseMap m_responses;
-    ExportMap *m_export_map;
-    UIntMap *m_recv_type_map;
+    // Handles for the stats, these do nothing if there isn't an ExportMap.
+    Counter m_received_var;
+    Counter m_send_errors_var;
+    Counter m_sent_var;
+    Counter m_stream_dropped_var;
+    Counter m_recv_request_var;
+    Counter m_recv_response_var;
+    Counter m_recv_cancelled_var;
+    Counter m_recv_failed_var;
+    Counter m_recv_not_implemented_var;
+    Counter m_recv_stream_request_var;
+    ola::io::SelectServerInterface *m_ss;  // set if write queuing is enabled
+    unsigned int m_max_stream_messages;
+    unsigned int m_queued_stream_messages;
+    unsigned int m_write_offset;  // bytes of the front message already sent
+    bool m_write_registered;
+    WriteQueue m_write_queue;
 
     bool SendMsg(RpcMessage *msg);
+    bool SendFramedMsg(const std::string &data, bool is_stream);
+    void QueueMsg(const std::string &data, bool is_stream);
+    void DescriptorWritable();
+    void ClearWriteQueue();
+    void SendFailed();
+    static void FrameMsg(const RpcMessage &msg, std::string *output);
     int AllocateMsgBuffer(unsigned int size);
     int ReadHeader(unsigned int *version, unsigned int *size) const;
     bool HandleNewMsg(uint8_t *buffer, unsigned int size);
@@ -178,7 +253,7 @@ class RpcChannel {
     static const char K_RPC_RECEIVED_VAR[];
     static const char K_RPC_SENT_ERROR_VAR[];
     static const char K_RPC_SENT_VAR[];
-    static const char *K_RPC_VARIABLES[];
+    static const char K_RPC_STREAM_DROPPED_VAR[];
     static const char STREAMING_NO_RESPONSE[];
     static const unsigned int INITIAL_BUFFER_SIZE = 1 << 11;  // 2k
     static const unsigned int MAX_BUFFER_SIZE = 1 << 20;  // 1M
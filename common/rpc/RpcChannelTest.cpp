@@ -29,6 +29,8 @@
 #include "common/rpc/TestService.pb.h"
 #include "common/rpc/TestServiceService.pb.h"
 #include "ola/Callback.h"
+#include "ola/ExportMap.h"
+#include "ola/io/Descriptor.h"
 #include "ola/io/SelectServer.h"
 #include "ola/network/Socket.h"
 #include "ola/testing/TestUtils.h"
@@ -37,6 +39,7 @@
 using ola::NewSingleCallback;
 using ola::io::LoopbackDescriptor;
 using ola::io::SelectServer;
+using ola::io::UnixSocket;
 using ola::rpc::EchoReply;
 using ola::rpc::EchoRequest;
 using ola::rpc::RpcChannel;
@@ -53,6 +56,8 @@ class RpcChannelTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testEcho);
   CPPUNIT_TEST(testFailedEcho);
   CPPUNIT_TEST(testStreamRequest);
+  CPPUNIT_TEST(testEncodedStreamRequest);
+  CPPUNIT_TEST(testWriteQueue);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -61,6 +66,8 @@ class RpcChannelTest: public CppUnit::TestFixture {
   void testEcho();
   void testFailedEcho();
   void testStreamRequest();
+  void testEncodedStreamRequest();
+  void testWriteQueue();
   void EchoComplete();
   void FailedEchoComplete();
 
@@ -79,6 +86,37 @@ class RpcChannelTest: public CppUnit::TestFixture {
 
 CPPUNIT_TEST_SUITE_REGISTRATION(RpcChannelTest);
 
+
+/*
+ * A TestService that counts stream requests, and stops the SelectServer when
+ * it sees the last one.
+ */
+class CountingStreamService: public ola::rpc::TestService {
+ public:
+  explicit CountingStreamService(SelectServer *ss)
+      : count(0),
+        m_ss(ss) {
+  }
+
+  void Stream(RpcController*,
+              const EchoRequest* request,
+              STREAMING_NO_RESPONSE*,
+              CompletionCallback*) {
+    count++;
+    if (request->data() == LAST_REQUEST) {
+      m_ss->Terminate();
+    }
+  }
+
+  unsigned int count;
+  static const char LAST_REQUEST[];
+
+ private:
+  SelectServer *m_ss;
+};
+
+const char CountingStreamService::LAST_REQUEST[] = "last";
+
 void RpcChannelTest::setUp() {
   m_socket.reset(new LoopbackDescriptor());
   m_socket->Init();
@@ -139,3 +177,69 @@ void RpcChannelTest::testStreamRequest() {
   m_stub->Stream(NULL, &m_request, NULL, NULL);
   m_ss.Run();
 }
+
+/*
+ * Check that pre-encoded stream requests work
+ */
+void RpcChannelTest::testEncodedStreamRequest() {
+  const google::protobuf::ServiceDescriptor *service =
+      TestService::descriptor();
+  string encoded;
+  m_request.set_data("foo");
+
+  OLA_ASSERT_FALSE(RpcChannel::EncodeStreamRequest(
+      service->FindMethodByName("Echo"), m_request, &encoded));
+  OLA_ASSERT_TRUE(RpcChannel::EncodeStreamRequest(
+      service->FindMethodByName("Stream"), m_request, &encoded));
+  OLA_ASSERT_TRUE(m_channel->SendEncodedStreamRequest(encoded));
+  m_ss.Run();
+}
+
+/*
+ * Check that stream requests are queued, and the oldest dropped, when the
+ * other end isn't reading.
+ */
+void RpcChannelTest::testWriteQueue() {
+  const unsigned int REQUEST_COUNT = 100;
+  const unsigned int MAX_QUEUED = 4;
+
+  UnixSocket socket;
+  OLA_ASSERT_TRUE(socket.Init());
+  UnixSocket *other_end = socket.OppositeEnd();
+
+  ola::ExportMap export_map;
+  RpcChannel sender(NULL, &socket, &export_map);
+  sender.EnableWriteQueue(&m_ss, MAX_QUEUED);
+
+  CountingStreamService service(&m_ss);
+  RpcChannel receiver(&service, other_end);
+
+  const google::protobuf::MethodDescriptor *method =
+      TestService::descriptor()->FindMethodByName("Stream");
+  string encoded;
+  m_request.set_data(string(16384, 'x'));
+  OLA_ASSERT_TRUE(RpcChannel::EncodeStreamRequest(method, m_request,
+                                                  &encoded));
+
+  // Nothing is reading from the other end yet, so once the socket buffer is
+  // full the requests are queued.
+  for (unsigned int i = 0; i < REQUEST_COUNT - 1; i++) {
+    OLA_ASSERT_TRUE(sender.SendEncodedStreamRequest(encoded));
+  }
+  m_request.set_data(CountingStreamService::LAST_REQUEST);
+  OLA_ASSERT_TRUE(RpcChannel::EncodeStreamRequest(method, m_request,
+                                                  &encoded));
+  OLA_ASSERT_TRUE(sender.SendEncodedStreamRequest(encoded));
+
+  unsigned int dropped = export_map.GetCounterVar(
+      "rpc-stream-dropped")->Get();
+  OLA_ASSERT_TRUE(dropped > 0);
+
+  // The newest request is never dropped, so this terminates once the queue
+  // has been sent.
+  m_ss.AddReadDescriptor(other_end);
+  m_ss.Run();
+  m_ss.RemoveReadDescriptor(other_end);
+
+  OLA_ASSERT_EQ(REQUEST_COUNT, service.count + dropped);
+}
@@ -130,6 +130,7 @@ bool RpcServer::AddClient(ConnectedDescriptor *descriptor) {
   // ownership of the socket here.
   RpcChannel *channel = new RpcChannel(m_service, descriptor,
                                        m_options.export_map);
+  channel->EnableWriteQueue(m_ss, m_options.max_queued_stream_messages);
 
   if (m_session_handler) {
     m_session_handler->NewClient(channel->Session());
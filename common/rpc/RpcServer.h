@@ -72,10 +72,19 @@ class RpcServer {
      */
     ola::network::TCPAcceptingSocket *listen_socket;
 
+    /**
+     * @brief The number of streaming messages to queue for a client that
+     * isn't reading fast enough.
+     *
+     * Once this is reached the oldest queued streaming message is dropped.
+     */
+    unsigned int max_queued_stream_messages;
+
     Options()
       : listen_port(0),
         export_map(NULL),
-        listen_socket(NULL) {
+        listen_socket(NULL),
+        max_queued_stream_messages(DEFAULT_MAX_QUEUED_STREAM_MESSAGES) {
     }
   };
 
@@ -113,6 +122,11 @@ class RpcServer {
    */
   bool AddClient(ola::io::ConnectedDescriptor *descriptor);
 
+  /**
+   * @brief The default value for Options::max_queued_stream_messages.
+   */
+  static const unsigned int DEFAULT_MAX_QUEUED_STREAM_MESSAGES = 64;
+
  private:
   typedef std::set<ola::io::ConnectedDescriptor*> ClientDescriptors;
 
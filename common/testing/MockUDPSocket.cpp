@@ -206,6 +206,30 @@ bool MockUDPSocket::RecvFrom(
 }
 
 
+/*
+ * Return all the queued datagrams, up to count.
+ */
+unsigned int MockUDPSocket::RecvBatch(ola::network::UDPDatagram *datagrams,
+                                      unsigned int count) {
+  unsigned int received = 0;
+  while (received < count && !m_received_data.empty()) {
+    ola::network::UDPDatagram *datagram = &datagrams[received];
+    datagram->size = datagram->buffer_size;
+    if (!RecvFrom(datagram->data, &datagram->size, &datagram->source)) {
+      break;
+    }
+    received++;
+  }
+  return received;
+}
+
+
+bool MockUDPSocket::EnableDropCounting(OLA_UNUSED UIntMap *drops,
+                                       OLA_UNUSED const std::string &key) {
+  return false;
+}
+
+
 bool MockUDPSocket::EnableBroadcast() {
   m_broadcast_set = true;
   return true;
@@ -239,6 +263,15 @@ bool MockUDPSocket::SetTos(uint8_t tos) {
 }
 
 
+/*
+ * Batching is never enabled, so datagrams can be verified as they're sent.
+ */
+bool MockUDPSocket::EnableSendBatching(
+    OLA_UNUSED ola::thread::SchedulerInterface *scheduler) {
+  return false;
+}
+
+
 void MockUDPSocket::AddExpectedData(const uint8_t *data,
                                     unsigned int size,
                                     const IPV4Address &ip,
@@ -0,0 +1,144 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * FramePacer.cpp
+ * Paces the frames sent by output threads.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/thread/FramePacer.h"
+
+namespace ola {
+namespace thread {
+
+namespace {
+
+/*
+ * Uses the monotonic clock if we have one.
+ */
+class MonotonicPacerClock : public PacerClock, public PacerSleeper {
+ public:
+  int64_t Now() const;
+  void SleepUntil(int64_t wake_up_us);
+};
+
+MonotonicPacerClock default_pacer_clock;
+}  // namespace
+
+FramePacer::FramePacer(const TimeInterval &frame_interval,
+                       const PacerClock *clock,
+                       PacerSleeper *sleeper)
+    : m_clock(clock ? clock : &default_pacer_clock),
+      m_sleeper(sleeper ? sleeper : &default_pacer_clock),
+      m_interval_us(frame_interval.AsInt()),
+      m_next_frame_us(0) {
+}
+
+void FramePacer::Reset() {
+  m_next_frame_us = m_clock->Now() + m_interval_us;
+}
+
+void FramePacer::WaitForNextFrame() {
+  if (m_next_frame_us == 0) {
+    Reset();
+  }
+
+  m_sleeper->SleepUntil(m_next_frame_us);
+  int64_t now = m_clock->Now();
+  int64_t jitter = now > m_next_frame_us ? now - m_next_frame_us : 0;
+
+  m_stats.frames++;
+  m_stats.total_jitter += TimeInterval(jitter);
+  if (TimeInterval(jitter) > m_stats.max_jitter) {
+    m_stats.max_jitter = TimeInterval(jitter);
+  }
+
+  if (jitter > m_interval_us) {
+    // We've missed at least one frame, don't try to catch up.
+    m_stats.late_frames++;
+    m_next_frame_us = now + m_interval_us;
+  } else {
+    m_next_frame_us += m_interval_us;
+  }
+}
+
+void FramePacer::Sleep(const TimeInterval &interval) {
+  m_sleeper->SleepUntil(m_clock->Now() + interval.AsInt());
+}
+
+bool FramePacer::SetRealtimePriority(int priority) {
+#ifdef _WIN32
+  OLA_WARN << "Real time priority isn't supported, ignoring " << priority;
+  return false;
+#else
+  struct sched_param param;
+  memset(&param, 0, sizeof(param));
+  param.sched_priority = priority;
+  int r = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+  if (r != 0) {
+    OLA_WARN << "Unable to set SCHED_FIFO priority " << priority << ": "
+             << strerror(r);
+    return false;
+  }
+  return true;
+#endif  // _WIN32
+}
+
+int64_t MonotonicPacerClock::Now() const {
+#if defined(HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC)
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<int64_t>(now.tv_sec) * USEC_IN_SECONDS +
+      now.tv_nsec / 1000;
+#else
+  Clock clock;
+  TimeStamp now;
+  clock.CurrentTime(&now);
+  return static_cast<int64_t>(now.Seconds()) * USEC_IN_SECONDS +
+      now.MicroSeconds();
+#endif  // HAVE_CLOCK_GETTIME
+}
+
+void MonotonicPacerClock::SleepUntil(int64_t wake_up_us) {
+#if defined(HAVE_CLOCK_NANOSLEEP) && defined(HAVE_CLOCK_GETTIME) && \
+    defined(CLOCK_MONOTONIC)
+  struct timespec wake_up;
+  wake_up.tv_sec = wake_up_us / USEC_IN_SECONDS;
+  wake_up.tv_nsec = (wake_up_us % USEC_IN_SECONDS) * 1000;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake_up, NULL) ==
+         EINTR) {
+  }
+#else
+  int64_t now = Now();
+  if (wake_up_us > now) {
+    usleep(wake_up_us - now);
+  }
+#endif  // HAVE_CLOCK_NANOSLEEP
+}
+}  // namespace thread
+}  // namespace ola
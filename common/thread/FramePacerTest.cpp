@@ -0,0 +1,192 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * FramePacerTest.cpp
+ * Test fixture for the FramePacer class
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <vector>
+
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "ola/testing/TestUtils.h"
+#include "ola/thread/FramePacer.h"
+
+using ola::DmxBuffer;
+using ola::TimeInterval;
+using ola::thread::FramePacer;
+using ola::thread::PacerClock;
+using ola::thread::PacerSleeper;
+using std::vector;
+
+/*
+ * A clock that only moves when we sleep or advance it. Each sleep wakes up
+ * wake_up_delay_us late.
+ */
+class FakePacerClock : public PacerClock, public PacerSleeper {
+ public:
+  FakePacerClock() : m_now(1000000), m_wake_up_delay(0) {}
+
+  int64_t Now() const { return m_now; }
+
+  void SleepUntil(int64_t wake_up_us) {
+    if (wake_up_us > m_now) {
+      m_now = wake_up_us;
+    }
+    m_now += m_wake_up_delay;
+  }
+
+  void Advance(int64_t interval_us) { m_now += interval_us; }
+  void SetWakeUpDelay(int64_t delay_us) { m_wake_up_delay = delay_us; }
+
+ private:
+  int64_t m_now;
+  int64_t m_wake_up_delay;
+};
+
+
+/*
+ * A widget which records when each frame was written, and takes a fixed
+ * time to write each one.
+ */
+class FakeWidget {
+ public:
+  FakeWidget(FakePacerClock *clock, int64_t write_time_us)
+      : m_clock(clock),
+        m_write_time_us(write_time_us) {}
+
+  void Write(const DmxBuffer&) {
+    m_frame_times.push_back(m_clock->Now());
+    m_clock->Advance(m_write_time_us);
+  }
+
+  const vector<int64_t> &FrameTimes() const { return m_frame_times; }
+
+ private:
+  FakePacerClock *m_clock;
+  const int64_t m_write_time_us;
+  vector<int64_t> m_frame_times;
+};
+
+
+class FramePacerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(FramePacerTest);
+  CPPUNIT_TEST(testFrameRate);
+  CPPUNIT_TEST(testLateFrames);
+  CPPUNIT_TEST(testSleep);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp() {
+    ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  }
+
+  void testFrameRate();
+  void testLateFrames();
+  void testSleep();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FramePacerTest);
+
+
+/*
+ * Check the frame rate doesn't depend on how long each frame takes to send.
+ */
+void FramePacerTest::testFrameRate() {
+  const unsigned int FRAMES = 20;
+  FakePacerClock clock;
+  clock.SetWakeUpDelay(100);
+  FramePacer pacer(TimeInterval(0, 5000), &clock, &clock);
+  OLA_ASSERT_EQ(TimeInterval(0, 5000), pacer.FrameInterval());
+
+  FakeWidget widget(&clock, 1000);
+  DmxBuffer buffer;
+  buffer.Blackout();
+  for (unsigned int i = 0; i < FRAMES; i++) {
+    widget.Write(buffer);
+    pacer.WaitForNextFrame();
+  }
+
+  // The first wait schedules the frames one interval from when it was
+  // called, after that the frames are exactly one interval apart.
+  const vector<int64_t> &frame_times = widget.FrameTimes();
+  OLA_ASSERT_EQ(static_cast<size_t>(FRAMES), frame_times.size());
+  OLA_ASSERT_EQ(static_cast<int64_t>(1000 + 5000 + 100),
+                frame_times[1] - frame_times[0]);
+  for (unsigned int i = 2; i < FRAMES; i++) {
+    OLA_ASSERT_EQ(static_cast<int64_t>(5000),
+                  frame_times[i] - frame_times[i - 1]);
+  }
+
+  const ola::thread::FrameTimingStats &stats = pacer.Stats();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(FRAMES), stats.frames);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), stats.late_frames);
+  OLA_ASSERT_EQ(TimeInterval(0, 100), stats.max_jitter);
+  OLA_ASSERT_EQ(TimeInterval(0, 100), stats.MeanJitter());
+
+  pacer.ResetStats();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), pacer.Stats().frames);
+}
+
+
+/*
+ * Check that missed frames are skipped, rather than sent back to back.
+ */
+void FramePacerTest::testLateFrames() {
+  FakePacerClock clock;
+  FramePacer pacer(TimeInterval(0, 2000), &clock, &clock);
+  pacer.WaitForNextFrame();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), pacer.Stats().late_frames);
+  OLA_ASSERT_EQ(static_cast<int64_t>(1002000), clock.Now());
+
+  // A slow widget, the frame was due at 1004000.
+  FakeWidget widget(&clock, 10000);
+  DmxBuffer buffer;
+  widget.Write(buffer);
+  pacer.WaitForNextFrame();
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), pacer.Stats().late_frames);
+  OLA_ASSERT_EQ(TimeInterval(0, 8000), pacer.Stats().max_jitter);
+  OLA_ASSERT_EQ(static_cast<int64_t>(1012000), clock.Now());
+
+  // The next frame is a full interval after the late one.
+  pacer.WaitForNextFrame();
+  OLA_ASSERT_EQ(static_cast<int64_t>(1014000), clock.Now());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(1), pacer.Stats().late_frames);
+  OLA_ASSERT_EQ(static_cast<uint64_t>(3), pacer.Stats().frames);
+}
+
+
+/*
+ * Check the short sleeps used for the break & MAB.
+ */
+void FramePacerTest::testSleep() {
+  FakePacerClock clock;
+  FramePacer pacer(TimeInterval(0, 25000), &clock, &clock);
+  pacer.Sleep(TimeInterval(0, 2000));
+  OLA_ASSERT_EQ(static_cast<int64_t>(1002000), clock.Now());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), pacer.Stats().frames);
+
+  // Sleeping doesn't move the frame schedule.
+  pacer.WaitForNextFrame();
+  OLA_ASSERT_EQ(static_cast<int64_t>(1027000), clock.Now());
+  pacer.Sleep(TimeInterval(0, 110));
+  pacer.WaitForNextFrame();
+  OLA_ASSERT_EQ(static_cast<int64_t>(1052000), clock.Now());
+  OLA_ASSERT_EQ(static_cast<uint64_t>(0), pacer.Stats().late_frames);
+}
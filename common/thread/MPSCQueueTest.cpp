@@ -0,0 +1,165 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * MPSCQueueTest.cpp
+ * Test fixture for the MPSCQueue class
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <sched.h>
+#include <vector>
+
+#include "ola/Logging.h"
+#include "ola/stl/STLUtils.h"
+#include "ola/testing/TestUtils.h"
+#include "ola/thread/MPSCQueue.h"
+#include "ola/thread/Thread.h"
+
+using ola::thread::MPSCQueue;
+using ola::thread::Thread;
+using std::vector;
+
+/*
+ * Pushes a sequence of numbers onto a queue, spinning if it's full. The
+ * producer id is held in the top 8 bits.
+ */
+class ProducerThread: public Thread {
+ public:
+  ProducerThread(MPSCQueue<unsigned int> *queue, unsigned int id,
+                 unsigned int count)
+      : Thread(Options("ProducerThread")),
+        m_queue(queue),
+        m_id(id),
+        m_count(count) {
+  }
+
+  void *Run() {
+    for (unsigned int i = 0; i < m_count; i++) {
+      while (!m_queue->Push((m_id << 24) | i)) {
+        sched_yield();
+      }
+    }
+    return NULL;
+  }
+
+ private:
+  MPSCQueue<unsigned int> *m_queue;
+  const unsigned int m_id;
+  const unsigned int m_count;
+};
+
+
+class MPSCQueueTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(MPSCQueueTest);
+  CPPUNIT_TEST(testPushPop);
+  CPPUNIT_TEST(testWrapAround);
+  CPPUNIT_TEST(testThreads);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp() {
+    ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  }
+
+  void testPushPop();
+  void testWrapAround();
+  void testThreads();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MPSCQueueTest);
+
+
+/*
+ * Check the queue fills up and empties in order.
+ */
+void MPSCQueueTest::testPushPop() {
+  MPSCQueue<unsigned int> queue(3);
+  OLA_ASSERT_EQ(4u, queue.Capacity());
+  OLA_ASSERT_TRUE(queue.Empty());
+
+  unsigned int item = 0;
+  OLA_ASSERT_FALSE(queue.Pop(&item));
+
+  for (unsigned int i = 0; i < 4; i++) {
+    OLA_ASSERT_TRUE(queue.Push(i));
+  }
+  OLA_ASSERT_FALSE(queue.Push(4));
+  OLA_ASSERT_FALSE(queue.Empty());
+
+  for (unsigned int i = 0; i < 4; i++) {
+    OLA_ASSERT_TRUE(queue.Pop(&item));
+    OLA_ASSERT_EQ(i, item);
+  }
+  OLA_ASSERT_FALSE(queue.Pop(&item));
+  OLA_ASSERT_TRUE(queue.Empty());
+}
+
+
+/*
+ * Check the ring buffer wraps around correctly.
+ */
+void MPSCQueueTest::testWrapAround() {
+  MPSCQueue<unsigned int> queue(4);
+  unsigned int item = 0;
+  for (unsigned int i = 0; i < 100; i++) {
+    OLA_ASSERT_TRUE(queue.Push(i));
+    OLA_ASSERT_TRUE(queue.Push(i + 1000));
+    OLA_ASSERT_TRUE(queue.Pop(&item));
+    OLA_ASSERT_EQ(i, item);
+    OLA_ASSERT_TRUE(queue.Pop(&item));
+    OLA_ASSERT_EQ(i + 1000, item);
+  }
+  OLA_ASSERT_TRUE(queue.Empty());
+}
+
+
+/*
+ * Check nothing is lost, and each producer's items stay in order, with
+ * several producers.
+ */
+void MPSCQueueTest::testThreads() {
+  const unsigned int PRODUCERS = 4;
+  const unsigned int COUNT = 50000;
+  MPSCQueue<unsigned int> queue(64);
+
+  vector<ProducerThread*> producers;
+  for (unsigned int i = 0; i < PRODUCERS; i++) {
+    producers.push_back(new ProducerThread(&queue, i, COUNT));
+    OLA_ASSERT_TRUE(producers.back()->Start());
+  }
+
+  vector<unsigned int> expected(PRODUCERS, 0);
+  unsigned int received = 0;
+  while (received < PRODUCERS * COUNT) {
+    unsigned int item;
+    if (queue.Pop(&item)) {
+      const unsigned int id = item >> 24;
+      OLA_ASSERT_LT(id, PRODUCERS);
+      OLA_ASSERT_EQ(expected[id], item & 0xffffff);
+      expected[id]++;
+      received++;
+    } else {
+      sched_yield();
+    }
+  }
+
+  for (unsigned int i = 0; i < PRODUCERS; i++) {
+    OLA_ASSERT_TRUE(producers[i]->Join());
+  }
+  ola::STLDeleteElements(&producers);
+  OLA_ASSERT_TRUE(queue.Empty());
+}
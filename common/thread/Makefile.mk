@@ -3,6 +3,7 @@
 common_libolacommon_la_SOURCES += \
     common/thread/ConsumerThread.cpp \
     common/thread/ExecutorThread.cpp \
+    common/thread/FramePacer.cpp \
     common/thread/Mutex.cpp \
     common/thread/PeriodicThread.cpp \
     common/thread/SignalThread.cpp \
@@ -14,7 +15,10 @@ common_libolacommon_la_SOURCES += \
 ##################################################
 test_programs += common/thread/ExecutorThreadTester \
                  common/thread/ThreadTester \
-                 common/thread/FutureTester
+                 common/thread/FramePacerTester \
+                 common/thread/FutureTester \
+                 common/thread/MPSCQueueTester \
+                 common/thread/SPSCQueueTester
 
 common_thread_ThreadTester_SOURCES = \
     common/thread/ThreadPoolTest.cpp \
@@ -22,10 +26,22 @@ common_thread_ThreadTester_SOURCES = \
 common_thread_ThreadTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_thread_ThreadTester_LDADD = $(COMMON_TESTING_LIBS)
 
+common_thread_FramePacerTester_SOURCES = common/thread/FramePacerTest.cpp
+common_thread_FramePacerTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_thread_FramePacerTester_LDADD = $(COMMON_TESTING_LIBS)
+
 common_thread_FutureTester_SOURCES = common/thread/FutureTest.cpp
 common_thread_FutureTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 common_thread_FutureTester_LDADD = $(COMMON_TESTING_LIBS)
 
+common_thread_MPSCQueueTester_SOURCES = common/thread/MPSCQueueTest.cpp
+common_thread_MPSCQueueTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_thread_MPSCQueueTester_LDADD = $(COMMON_TESTING_LIBS)
+
+common_thread_SPSCQueueTester_SOURCES = common/thread/SPSCQueueTest.cpp
+common_thread_SPSCQueueTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
+common_thread_SPSCQueueTester_LDADD = $(COMMON_TESTING_LIBS)
+
 common_thread_ExecutorThreadTester_SOURCES = \
     common/thread/ExecutorThreadTest.cpp
 common_thread_ExecutorThreadTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
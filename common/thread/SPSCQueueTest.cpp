@@ -0,0 +1,144 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SPSCQueueTest.cpp
+ * Test fixture for the SPSCQueue class
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <sched.h>
+
+#include "ola/Logging.h"
+#include "ola/testing/TestUtils.h"
+#include "ola/thread/SPSCQueue.h"
+#include "ola/thread/Thread.h"
+
+using ola::thread::SPSCQueue;
+using ola::thread::Thread;
+
+/*
+ * Pushes a sequence of numbers onto a queue, spinning if it's full.
+ */
+class ProducerThread: public Thread {
+ public:
+  ProducerThread(SPSCQueue<unsigned int> *queue, unsigned int count)
+      : Thread(Options("ProducerThread")),
+        m_queue(queue),
+        m_count(count) {
+  }
+
+  void *Run() {
+    for (unsigned int i = 0; i < m_count; i++) {
+      while (!m_queue->Push(i)) {
+        sched_yield();
+      }
+    }
+    return NULL;
+  }
+
+ private:
+  SPSCQueue<unsigned int> *m_queue;
+  const unsigned int m_count;
+};
+
+
+class SPSCQueueTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(SPSCQueueTest);
+  CPPUNIT_TEST(testPushPop);
+  CPPUNIT_TEST(testWrapAround);
+  CPPUNIT_TEST(testThreads);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void setUp() {
+    ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  }
+
+  void testPushPop();
+  void testWrapAround();
+  void testThreads();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SPSCQueueTest);
+
+
+/*
+ * Check the queue fills up and empties in order.
+ */
+void SPSCQueueTest::testPushPop() {
+  SPSCQueue<unsigned int> queue(3);
+  OLA_ASSERT_EQ(4u, queue.Capacity());
+  OLA_ASSERT_TRUE(queue.Empty());
+
+  unsigned int item = 0;
+  OLA_ASSERT_FALSE(queue.Pop(&item));
+
+  for (unsigned int i = 0; i < 4; i++) {
+    OLA_ASSERT_TRUE(queue.Push(i));
+  }
+  OLA_ASSERT_FALSE(queue.Push(4));
+  OLA_ASSERT_FALSE(queue.Empty());
+
+  for (unsigned int i = 0; i < 4; i++) {
+    OLA_ASSERT_TRUE(queue.Pop(&item));
+    OLA_ASSERT_EQ(i, item);
+  }
+  OLA_ASSERT_FALSE(queue.Pop(&item));
+  OLA_ASSERT_TRUE(queue.Empty());
+}
+
+
+/*
+ * Check the ring buffer wraps around correctly.
+ */
+void SPSCQueueTest::testWrapAround() {
+  SPSCQueue<unsigned int> queue(4);
+  unsigned int item = 0;
+  for (unsigned int i = 0; i < 100; i++) {
+    OLA_ASSERT_TRUE(queue.Push(i));
+    OLA_ASSERT_TRUE(queue.Push(i + 1000));
+    OLA_ASSERT_TRUE(queue.Pop(&item));
+    OLA_ASSERT_EQ(i, item);
+    OLA_ASSERT_TRUE(queue.Pop(&item));
+    OLA_ASSERT_EQ(i + 1000, item);
+  }
+  OLA_ASSERT_TRUE(queue.Empty());
+}
+
+
+/*
+ * Check nothing is lost or re-ordered between two threads.
+ */
+void SPSCQueueTest::testThreads() {
+  const unsigned int COUNT = 200000;
+  SPSCQueue<unsigned int> queue(64);
+  ProducerThread producer(&queue, COUNT);
+  OLA_ASSERT_TRUE(producer.Start());
+
+  unsigned int expected = 0;
+  while (expected < COUNT) {
+    unsigned int item;
+    if (queue.Pop(&item)) {
+      OLA_ASSERT_EQ(expected, item);
+      expected++;
+    } else {
+      sched_yield();
+    }
+  }
+  OLA_ASSERT_TRUE(producer.Join());
+  OLA_ASSERT_TRUE(queue.Empty());
+}
@@ -36,6 +36,7 @@
 #include "ola/DmxBuffer.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
+#include "common/dmx/HTPMerge.h"
 
 namespace ola {
 
@@ -44,6 +45,11 @@ using std::max;
 using std::string;
 using std::vector;
 
+namespace {
+// The maximum number of buffers passed to a merge kernel in one call.
+const unsigned int HTP_MERGE_BATCH_SIZE = 8;
+}  // namespace
+
 DmxBuffer::DmxBuffer()
     : m_ref_count(NULL),
       m_copy_on_write(false),
@@ -121,9 +127,8 @@ bool DmxBuffer::HTPMerge(const DmxBuffer &other) {
                                   other.m_length);
   unsigned int merge_length = min(m_length, other.m_length);
 
-  for (unsigned int i = 0; i < merge_length; i++) {
-    m_data[i] = max(m_data[i], other.m_data[i]);
-  }
+  const uint8_t *input = other.m_data;
+  ola::dmx::GetHTPMergeFunction()(m_data, &input, 1, merge_length);
 
   if (other_length > m_length) {
     memcpy(m_data + merge_length, other.m_data + merge_length,
@@ -134,12 +139,78 @@ bool DmxBuffer::HTPMerge(const DmxBuffer &other) {
 }
 
 
+bool DmxBuffer::HTPMerge(const vector<const DmxBuffer*> &others) {
+  if (!m_data) {
+    if (!Init())
+      return false;
+  }
+  DuplicateIfNeeded();
+
+  // Find the longest and shortest of the buffers. Empty buffers don't take
+  // part in the merge.
+  unsigned int merged_length = m_length;
+  unsigned int common_length = DMX_UNIVERSE_SIZE;
+  vector<const DmxBuffer*>::const_iterator iter = others.begin();
+  for (; iter != others.end(); ++iter) {
+    if ((*iter)->m_data && (*iter)->m_length) {
+      merged_length = max(merged_length, (*iter)->m_length);
+      common_length = min(common_length, (*iter)->m_length);
+    }
+  }
+  merged_length = min((unsigned int) DMX_UNIVERSE_SIZE, merged_length);
+  common_length = min(merged_length, common_length);
+
+  // Slots beyond our current length are zeroed, max(0, x) == x so this gives
+  // the same result as the copy in the pairwise HTPMerge above.
+  memset(m_data + m_length, DMX_MIN_SLOT_VALUE, merged_length - m_length);
+  m_length = merged_length;
+
+  ola::dmx::HTPMergeFunction merge = ola::dmx::GetHTPMergeFunction();
+
+  // Merge the slots all the buffers have, HTP_MERGE_BATCH_SIZE buffers at a
+  // time.
+  const uint8_t *inputs[HTP_MERGE_BATCH_SIZE];
+  unsigned int input_count = 0;
+  for (iter = others.begin(); iter != others.end(); ++iter) {
+    if (!(*iter)->m_data || !(*iter)->m_length) {
+      continue;
+    }
+    inputs[input_count++] = (*iter)->m_data;
+    if (input_count == HTP_MERGE_BATCH_SIZE) {
+      merge(m_data, inputs, input_count, common_length);
+      input_count = 0;
+    }
+  }
+  if (input_count) {
+    merge(m_data, inputs, input_count, common_length);
+  }
+
+  // Then merge the remaining slots from the longer buffers.
+  for (iter = others.begin(); iter != others.end(); ++iter) {
+    unsigned int length = min((unsigned int) DMX_UNIVERSE_SIZE,
+                              (*iter)->m_length);
+    if ((*iter)->m_data && length > common_length) {
+      const uint8_t *input = (*iter)->m_data + common_length;
+      merge(m_data + common_length, &input, 1, length - common_length);
+    }
+  }
+  return true;
+}
+
+
 bool DmxBuffer::Set(const uint8_t *data, unsigned int length) {
   if (!data)
     return false;
 
-  if (m_copy_on_write)
-    CleanupMemory();
+  if (m_copy_on_write) {
+    // If we're the last user of the shared memory, reuse it rather than
+    // freeing & allocating it again.
+    if (m_ref_count && *m_ref_count == 1) {
+      m_copy_on_write = false;
+    } else {
+      CleanupMemory();
+    }
+  }
   if (!m_data) {
     if (!Init())
       return false;
@@ -21,6 +21,7 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <string.h>
 #include <string>
+#include <vector>
 
 #include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
@@ -28,6 +29,7 @@
 
 using std::ostringstream;
 using std::string;
+using std::vector;
 using ola::DmxBuffer;
 
 class DmxBufferTest: public CppUnit::TestFixture {
@@ -38,6 +40,7 @@ class DmxBufferTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testAssign);
   CPPUNIT_TEST(testCopy);
   CPPUNIT_TEST(testMerge);
+  CPPUNIT_TEST(testMultiMerge);
   CPPUNIT_TEST(testStringToDmx);
   CPPUNIT_TEST(testCopyOnWrite);
   CPPUNIT_TEST(testSetRange);
@@ -53,6 +56,7 @@ class DmxBufferTest: public CppUnit::TestFixture {
     void testStringGetSet();
     void testCopy();
     void testMerge();
+    void testMultiMerge();
     void testStringToDmx();
     void testCopyOnWrite();
     void testSetRange();
@@ -286,6 +290,69 @@ void DmxBufferTest::testMerge() {
 }
 
 
+/*
+ * Check that merging many buffers at once matches merging them one by one.
+ */
+void DmxBufferTest::testMultiMerge() {
+  DmxBuffer buffer1(TEST_DATA, sizeof(TEST_DATA));
+  DmxBuffer buffer2(TEST_DATA2, sizeof(TEST_DATA2));
+  DmxBuffer buffer3(TEST_DATA3, sizeof(TEST_DATA3));
+  DmxBuffer uninitialized_buffer;
+  const DmxBuffer merge_result(MERGE_RESULT2, sizeof(MERGE_RESULT2));
+
+  vector<const DmxBuffer*> buffers;
+  buffers.push_back(&buffer1);
+  buffers.push_back(&uninitialized_buffer);
+  buffers.push_back(&buffer2);
+  buffers.push_back(&buffer3);
+
+  DmxBuffer output;
+  OLA_ASSERT_TRUE(output.HTPMerge(buffers));
+  OLA_ASSERT_TRUE(merge_result == output);
+
+  // merging nothing leaves the buffer unchanged
+  OLA_ASSERT_TRUE(output.HTPMerge(vector<const DmxBuffer*>()));
+  OLA_ASSERT_TRUE(merge_result == output);
+
+  // the original buffers are untouched
+  OLA_ASSERT_TRUE(DmxBuffer(TEST_DATA, sizeof(TEST_DATA)) == buffer1);
+
+  // Now try full universes, more buffers than the kernel batch size and odd
+  // lengths, comparing against pairwise merges.
+  vector<DmxBuffer> sources;
+  for (unsigned int i = 0; i < 13; i++) {
+    uint8_t data[ola::DMX_UNIVERSE_SIZE];
+    for (unsigned int j = 0; j < ola::DMX_UNIVERSE_SIZE; j++) {
+      data[j] = static_cast<uint8_t>((j * 7 + i * 31) ^ (i * j));
+    }
+    unsigned int length = ola::DMX_UNIVERSE_SIZE;
+    if (i % 3 == 0) {
+      length -= 19 * i;
+    }
+    sources.push_back(DmxBuffer(data, length));
+  }
+
+  buffers.clear();
+  DmxBuffer expected;
+  for (unsigned int i = 0; i < sources.size(); i++) {
+    buffers.push_back(&sources[i]);
+    OLA_ASSERT_TRUE(expected.HTPMerge(sources[i]));
+
+    output.Reset();
+    OLA_ASSERT_TRUE(output.HTPMerge(buffers));
+    OLA_ASSERT_EQ(expected.Size(), output.Size());
+    OLA_ASSERT_DATA_EQUALS(expected.GetRaw(), expected.Size(),
+                           output.GetRaw(), output.Size());
+  }
+
+  // merging into a copy-on-write buffer doesn't change the original
+  DmxBuffer copy(buffer3);
+  OLA_ASSERT_TRUE(copy.HTPMerge(buffers));
+  OLA_ASSERT_TRUE(DmxBuffer(TEST_DATA3, sizeof(TEST_DATA3)) == buffer3);
+  OLA_ASSERT_EQ((unsigned int) ola::DMX_UNIVERSE_SIZE, copy.Size());
+}
+
+
 /*
  * Run the StringToDmxTest
  * @param input the string to parse
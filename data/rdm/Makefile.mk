@@ -5,6 +5,22 @@ dist_piddata_DATA = \
     data/rdm/pids.proto \
     data/rdm/manufacturer_pids.proto
 
+# The .proto files compiled into a single binary file, which is faster to load.
+# If this isn't built (cross-compiling without --with-pid-store-compiler) the
+# .proto files are loaded instead.
+if BUILD_PIDS_BIN
+nodist_piddata_DATA = data/rdm/pids.bin
+
+if USING_BUILT_PID_STORE_COMPILER
+PID_STORE_COMPILER_DEPS = common/rdm/pid_store_compiler$(EXEEXT)
+endif
+
+data/rdm/pids.bin: $(PID_STORE_COMPILER_DEPS) $(dist_piddata_DATA)
+	$(PID_STORE_COMPILER) $(srcdir)/data/rdm $@
+
+CLEANFILES += data/rdm/pids.bin
+endif
+
 # SCRIPTS
 ################################################
 dist_noinst_SCRIPTS += \
@@ -15,6 +15,8 @@
  *
  * ola-latency.cpp
  * Call FetchDmx and track the latency for each call.
+ * With --shm, track how long DMX written to shared memory takes to come back
+ * from olad.
  * Copyright (C) 2005 Simon Newton
  */
 
@@ -26,16 +28,20 @@
 #include <ola/OlaClientWrapper.h>
 #include <ola/base/Flags.h>
 #include <ola/base/Init.h>
+#include <ola/client/StreamingClient.h>
 #include <ola/thread/SignalThread.h>
 
 #include <iostream>
+#include <memory>
 #include <string>
+#include <vector>
 
 using ola::DmxBuffer;
 using ola::NewSingleCallback;
 using ola::OlaCallbackClientWrapper;
 using ola::TimeStamp;
 using ola::TimeInterval;
+using ola::client::StreamingClient;
 using std::cout;
 using std::endl;
 using std::string;
@@ -44,6 +50,9 @@ DEFINE_s_uint32(universe, u, 1, "The universe to receive data for");
 DEFINE_default_bool(send_dmx, false, "Use SendDmx messages, default is GetDmx");
 DEFINE_s_uint32(count, c, 0,
     "Exit after this many RPCs, default: infinite (0)");
+DEFINE_default_bool(shm, false,
+    "Write DMX via shared memory and time how long until olad sends it back. "
+    "olad must be on the same host and nothing else may send to the universe");
 
 class Tracker {
  public:
@@ -58,6 +67,9 @@ class Tracker {
 
     void GotDmx(const DmxBuffer &data, const string &error);
     void SendComplete(const string &error);
+    void Registered(const string &error);
+    void NewDmx(unsigned int universe, const DmxBuffer &data,
+                const string &error);
 
  private:
     uint32_t m_count;
@@ -65,6 +77,7 @@ class Tracker {
     TimeInterval m_max;
     ola::DmxBuffer m_buffer;
     OlaCallbackClientWrapper m_wrapper;
+    std::auto_ptr<StreamingClient> m_shm_client;
     ola::Clock m_clock;
     ola::thread::SignalThread m_signal_thread;
     TimeStamp m_send_time;
@@ -75,6 +88,17 @@ class Tracker {
 };
 
 bool Tracker::Setup() {
+  if (FLAGS_shm) {
+    m_shm_client.reset(new StreamingClient(StreamingClient::Options()));
+    if (!m_shm_client->Setup()) {
+      return false;
+    }
+    std::vector<unsigned int> universes(1, FLAGS_universe);
+    if (!m_shm_client->EnableSharedMemory(universes)) {
+      OLA_WARN << "Shared memory isn't available";
+      return false;
+    }
+  }
   return m_wrapper.Setup();
 }
 
@@ -86,7 +110,17 @@ void Tracker::Start() {
   m_signal_thread.InstallSignalHandler(
       SIGTERM,
       ola::NewCallback(ss, &ola::io::SelectServer::Terminate));
-  SendRequest();
+  if (FLAGS_shm) {
+    // Registering creates the universe if needed, olad then sends us each
+    // change.
+    m_wrapper.GetClient()->SetDmxCallback(
+        ola::NewCallback(this, &Tracker::NewDmx));
+    m_wrapper.GetClient()->RegisterUniverse(
+        FLAGS_universe, ola::REGISTER,
+        NewSingleCallback(this, &Tracker::Registered));
+  } else {
+    SendRequest();
+  }
 
   ss->Execute(ola::NewSingleCallback(this, &Tracker::StartSignalThread));
   ss->Run();
@@ -108,9 +142,32 @@ void Tracker::SendComplete(const string &) {
   LogTime();
 }
 
+void Tracker::Registered(const string &error) {
+  if (!error.empty()) {
+    OLA_WARN << "Register failed: " << error;
+    m_wrapper.GetSelectServer()->Terminate();
+    return;
+  }
+  SendRequest();
+}
+
+void Tracker::NewDmx(unsigned int, const DmxBuffer &data, const string &) {
+  // Ignore anything olad sent before it had our latest frame.
+  if (data == m_buffer) {
+    LogTime();
+  }
+}
+
 void Tracker::SendRequest() {
   m_clock.CurrentTime(&m_send_time);
-  if (FLAGS_send_dmx) {
+  if (FLAGS_shm) {
+    // Change the frame each time so we can tell when olad has it.
+    m_buffer.SetChannel(0, m_buffer.Get(0) + 1);
+    if (!m_shm_client->SendDmx(FLAGS_universe, m_buffer)) {
+      OLA_WARN << "Shared memory write failed";
+      m_wrapper.GetSelectServer()->Terminate();
+    }
+  } else if (FLAGS_send_dmx) {
     m_wrapper.GetClient()->SendDmx(
         FLAGS_universe,
         m_buffer,
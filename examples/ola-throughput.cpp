@@ -21,23 +21,120 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <ola/Clock.h>
+#include <ola/Constants.h>
 #include <ola/base/Flags.h>
 #include <ola/base/Init.h>
 #include <ola/DmxBuffer.h>
 #include <ola/Logging.h>
-#include <ola/StreamingClient.h>
 #include <ola/StringUtils.h>
+#include <ola/client/StreamingClient.h>
+#include <ola/stl/STLUtils.h>
+#include <ola/thread/Thread.h>
 
 #include <iostream>
 #include <string>
+#include <vector>
 
 using std::cout;
 using std::endl;
 using std::string;
-using ola::StreamingClient;
+using ola::Clock;
+using ola::TimeStamp;
+using ola::client::DMXBatch;
+using ola::client::StreamingClient;
+using ola::client::UniverseDMX;
 
 DEFINE_s_uint32(universe, u, 1, "The universe to send data on");
+DEFINE_s_uint32(universes, n, 1,
+                "The number of universes to send, starting at --universe");
 DEFINE_s_uint32(sleep, s, 40000, "Time between DMX updates in micro-seconds");
+DEFINE_uint32(frames, 0,
+              "Stop after this many frames and print the throughput, 0 runs "
+              "forever");
+DEFINE_bool(batch, false,
+            "Send all universes in each frame with a single batched RPC");
+DEFINE_bool(shm, false,
+            "Send the data via shared memory, olad must be on the same host");
+DEFINE_s_uint16(port, p, ola::OLA_DEFAULT_PORT,
+                "The port to connect to, use the DMX data port (9011) if olad "
+                "was started with --dmx-input-threads");
+DEFINE_s_uint32(clients, c, 1,
+                "The number of clients to run, each in its own thread. Each "
+                "client sends its own block of --universes universes.");
+
+/*
+ * Send one frame of data, either universe by universe or as a batch.
+ */
+bool SendFrame(StreamingClient *client, const DMXBatch &batch) {
+  if (FLAGS_batch) {
+    return client->SendDMXBatch(batch);
+  }
+
+  DMXBatch::const_iterator iter = batch.begin();
+  for (; iter != batch.end(); ++iter) {
+    if (!client->SendDmx(iter->universe, iter->data)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * A client which sends frames from its own thread.
+ */
+class SenderThread : public ola::thread::Thread {
+ public:
+  explicit SenderThread(unsigned int first_universe)
+      : Thread(Thread::Options("sender")),
+        m_first_universe(first_universe),
+        m_ok(false) {
+  }
+
+  bool Ok() const { return m_ok; }
+
+ protected:
+  void *Run() {
+    StreamingClient::Options options;
+    options.server_port = FLAGS_port;
+    StreamingClient ola_client(options);
+    if (!ola_client.Setup()) {
+      OLA_FATAL << "Setup failed";
+      return NULL;
+    }
+
+    ola::DmxBuffer buffer;
+    buffer.Blackout();
+
+    DMXBatch batch;
+    std::vector<unsigned int> universes;
+    for (unsigned int i = 0; i < FLAGS_universes; i++) {
+      batch.push_back(UniverseDMX(m_first_universe + i, buffer));
+      universes.push_back(m_first_universe + i);
+    }
+
+    if (FLAGS_shm && !ola_client.EnableSharedMemory(universes)) {
+      OLA_WARN << "Shared memory isn't available, falling back to RPCs";
+    }
+
+    for (unsigned int frame = 0; !FLAGS_frames || frame < FLAGS_frames;
+         frame++) {
+      if (FLAGS_sleep) {
+        usleep(FLAGS_sleep);
+      }
+      if (!SendFrame(&ola_client, batch)) {
+        cout << "Send DMX failed" << endl;
+        return NULL;
+      }
+    }
+    m_ok = true;
+    return NULL;
+  }
+
+ private:
+  const unsigned int m_first_universe;
+  bool m_ok;
+};
 
 /*
  * Main
@@ -45,21 +142,49 @@ DEFINE_s_uint32(sleep, s, 40000, "Time between DMX updates in micro-seconds");
 int main(int argc, char *argv[]) {
   ola::AppInit(&argc, argv, "[options]", "Send DMX512 data to OLA.");
 
-  StreamingClient ola_client;
-  if (!ola_client.Setup()) {
-    OLA_FATAL << "Setup failed";
-    exit(1);
+  if (FLAGS_universes == 0 || FLAGS_clients == 0) {
+    ola::DisplayUsageAndExit();
   }
 
-  ola::DmxBuffer buffer;
-  buffer.Blackout();
+  std::vector<SenderThread*> senders;
+  for (unsigned int i = 0; i < FLAGS_clients; i++) {
+    senders.push_back(new SenderThread(FLAGS_universe + i * FLAGS_universes));
+  }
 
-  while (1) {
-    usleep(FLAGS_sleep);
-    if (!ola_client.SendDmx(FLAGS_universe, buffer)) {
-      cout << "Send DMX failed" << endl;
-      return false;
-    }
+  Clock clock;
+  TimeStamp start, end;
+  clock.CurrentTime(&start);
+
+  std::vector<SenderThread*>::iterator iter = senders.begin();
+  for (; iter != senders.end(); ++iter) {
+    (*iter)->Start();
+  }
+
+  bool ok = true;
+  for (iter = senders.begin(); iter != senders.end(); ++iter) {
+    (*iter)->Join();
+    ok &= (*iter)->Ok();
+  }
+  ola::STLDeleteElements(&senders);
+
+  clock.CurrentTime(&end);
+  if (!ok) {
+    return 1;
+  }
+
+  int64_t duration = (end - start).InMilliSeconds();
+  cout << "Sent " << FLAGS_frames << " frames of " << FLAGS_universes
+       << " universes from " << FLAGS_clients << " client"
+       << (FLAGS_clients == 1 ? " " : "s ")
+       << (FLAGS_batch ? "batched" : "individually")
+       << (FLAGS_shm ? " via shared memory" : "")
+       << " in " << duration << "ms";
+  if (duration) {
+    uint64_t universes = static_cast<uint64_t>(FLAGS_frames) *
+                         FLAGS_universes * FLAGS_clients;
+    cout << ", " << universes * 1000 / duration
+         << " universes/s";
   }
+  cout << endl;
   return 0;
 }
@@ -52,6 +52,12 @@ static const uint8_t DMX_MAX_SLOT_VALUE = 255;
  */
 static const uint8_t DMX512_START_CODE = 0;
 
+/**
+ * @brief The start code for per-slot priority data.
+ * This is used by E1.31 sources to send a priority for each slot.
+ */
+static const uint8_t SLOT_PRIORITY_START_CODE = 0xdd;
+
 /**
  * @brief The default port which olad listens on for incoming RPC connections.
  */
@@ -29,6 +29,7 @@
 #include <stdint.h>
 #include <iostream>
 #include <string>
+#include <vector>
 
 
 namespace ola {
@@ -117,6 +118,16 @@ class DmxBuffer {
      */
     bool HTPMerge(const DmxBuffer &other);
 
+    /**
+     * @brief HTP Merge a number of DmxBuffers into this one.
+     *
+     * This produces the same result as calling HTPMerge() with each buffer in
+     * turn, but all the buffers are merged in a single pass.
+     * @param others the DmxBuffers to HTP merge into this one
+     * @return false if the merge failed, and true if merge was successful
+     */
+    bool HTPMerge(const std::vector<const DmxBuffer*> &others);
+
     /**
      * @brief Set the contents of this DmxBuffer
      * @param data is a pointer to an array of uint8_t values
@@ -85,6 +85,140 @@ struct VariableLessThan: public std::binary_function<BaseVariable*,
 };
 
 
+/**
+ * @class Counter <ola/ExportMap.h>
+ * @brief A handle to a counter held in the ExportMap.
+ *
+ * Handles are fetched from the ExportMap once and kept by the caller, so
+ * incrementing one is a relaxed atomic add rather than a lookup by name. The
+ * value is only formatted when the variables are displayed.
+ *
+ * A default constructed handle isn't attached to a variable and does nothing,
+ * so callers don't need to check if they were given an ExportMap.
+ */
+class Counter {
+ public:
+  Counter() : m_value(NULL) {}
+  explicit Counter(unsigned int *value) : m_value(value) {}
+
+  /**
+   * @brief Check if this handle is attached to a variable.
+   */
+  bool IsValid() const { return m_value != NULL; }
+
+  /**
+   * @brief Add to the counter.
+   * @param delta the amount to add.
+   */
+  void Increment(unsigned int delta = 1) {
+    if (m_value) {
+      __atomic_add_fetch(m_value, delta, __ATOMIC_RELAXED);
+    }
+  }
+
+  void operator++(int) { Increment(); }
+
+  /**
+   * @brief Get the value of the counter, or 0 if the handle isn't attached.
+   */
+  unsigned int Get() const {
+    return m_value ? __atomic_load_n(m_value, __ATOMIC_RELAXED) : 0;
+  }
+
+ private:
+  unsigned int *m_value;
+};
+
+
+/**
+ * @class Gauge <ola/ExportMap.h>
+ * @brief A handle to a value in the ExportMap that can go up and down.
+ *
+ * Like Counter, a default constructed Gauge does nothing.
+ */
+class Gauge {
+ public:
+  Gauge() : m_value(NULL) {}
+  explicit Gauge(unsigned int *value) : m_value(value) {}
+
+  bool IsValid() const { return m_value != NULL; }
+
+  void Set(unsigned int value) {
+    if (m_value) {
+      __atomic_store_n(m_value, value, __ATOMIC_RELAXED);
+    }
+  }
+
+  void Increment() {
+    if (m_value) {
+      __atomic_add_fetch(m_value, 1, __ATOMIC_RELAXED);
+    }
+  }
+
+  void Decrement() {
+    if (m_value) {
+      __atomic_sub_fetch(m_value, 1, __ATOMIC_RELAXED);
+    }
+  }
+
+  unsigned int Get() const {
+    return m_value ? __atomic_load_n(m_value, __ATOMIC_RELAXED) : 0;
+  }
+
+ private:
+  unsigned int *m_value;
+};
+
+
+/**
+ * @class Histogram <ola/ExportMap.h>
+ * @brief A handle to a set of bucket counters in the ExportMap.
+ *
+ * A value is counted in the first bucket whose upper bound is greater than or
+ * equal to it, values larger than all the bounds go in the last bucket.
+ * Like Counter, a default constructed Histogram does nothing.
+ */
+class Histogram {
+ public:
+  Histogram() : m_bounds(NULL), m_bound_count(0) {}
+
+  /**
+   * @brief Create a new Histogram. Use ExportMap::GetHistogram() instead.
+   * @param bounds the upper bound of each bucket, in ascending order. This
+   *   must remain valid for the lifetime of the handle.
+   * @param bound_count the number of bounds.
+   * @param buckets bound_count + 1 counters, one per bucket.
+   */
+  Histogram(const unsigned int bounds[], unsigned int bound_count,
+            const std::vector<Counter> &buckets)
+      : m_bounds(bounds),
+        m_bound_count(bound_count),
+        m_buckets(buckets) {
+  }
+
+  bool IsValid() const { return !m_buckets.empty(); }
+
+  /**
+   * @brief Count a value in the matching bucket.
+   */
+  void Observe(unsigned int value) {
+    if (m_buckets.empty()) {
+      return;
+    }
+    unsigned int bucket = 0;
+    while (bucket < m_bound_count && value > m_bounds[bucket]) {
+      bucket++;
+    }
+    m_buckets[bucket].Increment();
+  }
+
+ private:
+  const unsigned int *m_bounds;
+  unsigned int m_bound_count;
+  std::vector<Counter> m_buckets;
+};
+
+
 /**
  * @class BoolVariable <ola/ExportMap.h>
  * @brief A boolean variable.
@@ -180,16 +314,25 @@ class CounterVariable: public BaseVariable {
         m_value(0) {}
   ~CounterVariable() {}
 
-  void operator++(int) { m_value++; }
-  void operator+=(unsigned int value) { m_value += value; }
-  void Reset() { m_value = 0; }
-  unsigned int Get() const { return m_value; }
+  void operator++(int) { __atomic_add_fetch(&m_value, 1, __ATOMIC_RELAXED); }
+  void operator+=(unsigned int value) {
+    __atomic_add_fetch(&m_value, value, __ATOMIC_RELAXED);
+  }
+  void Reset() { __atomic_store_n(&m_value, 0, __ATOMIC_RELAXED); }
+  unsigned int Get() const {
+    return __atomic_load_n(&m_value, __ATOMIC_RELAXED);
+  }
   const std::string Value() const {
     std::ostringstream out;
-    out << m_value;
+    out << Get();
     return out.str();
   }
 
+  /**
+   * @brief Return a handle to this counter.
+   */
+  Counter Handle() { return Counter(&m_value); }
+
  private:
   unsigned int m_value;
 };
@@ -221,6 +364,9 @@ class MapVariable: public BaseVariable {
 
 typedef MapVariable<std::string> StringMap;
 
+template<>
+inline const std::string MapVariable<unsigned int>::Value() const;
+
 
 /**
  * An map of integer values. This provides an increment operation.
@@ -237,7 +383,10 @@ class IntMap: public MapVariable<int> {
 
 
 /**
- * An IntMap. This provides an increment operation.
+ * A map of unsigned int values. This provides an increment operation, and
+ * handles to individual entries.
+ *
+ * A handle remains valid until its key is removed from the map.
  */
 class UIntMap: public MapVariable<unsigned int> {
  public:
@@ -245,7 +394,21 @@ class UIntMap: public MapVariable<unsigned int> {
       : MapVariable<unsigned int>(name, label) {}
 
   void Increment(const std::string &key) {
-    m_variables[key]++;
+    __atomic_add_fetch(&m_variables[key], 1, __ATOMIC_RELAXED);
+  }
+
+  /**
+   * @brief Return a Counter handle for a key, creating the entry if needed.
+   */
+  Counter GetCounter(const std::string &key) {
+    return Counter(&m_variables[key]);
+  }
+
+  /**
+   * @brief Return a Gauge handle for a key, creating the entry if needed.
+   */
+  Gauge GetGauge(const std::string &key) {
+    return Gauge(&m_variables[key]);
   }
 };
 
@@ -298,6 +461,22 @@ inline const std::string MapVariable<Type>::Value() const {
 }
 
 
+/*
+ * Unsigned ints may be updated through handles, so load them atomically.
+ */
+template<>
+inline const std::string MapVariable<unsigned int>::Value() const {
+  std::ostringstream value;
+  value << "map:" << m_label;
+  std::map<std::string, unsigned int>::const_iterator iter;
+  for (iter = m_variables.begin(); iter != m_variables.end(); ++iter) {
+    value << " " << iter->first << ":"
+          << __atomic_load_n(&iter->second, __ATOMIC_RELAXED);
+  }
+  return value.str();
+}
+
+
 /*
  * Strings need to be quoted
  */
@@ -372,6 +551,60 @@ class ExportMap {
   UIntMap *GetUIntMapVar(const std::string &name,
                          const std::string &label = "");
 
+  /**
+   * @brief Get a handle to a CounterVariable.
+   * @param name the name of the variable.
+   * @return a Counter handle, valid for the lifetime of the ExportMap.
+   *
+   * Unlike the Get*Var() methods, which look the variable up each time,
+   * handles are meant to be fetched once and kept, so updating them is
+   * cheap enough for the DMX frame path.
+   */
+  Counter GetCounter(const std::string &name);
+
+  /**
+   * @brief Get a Counter handle for an entry in a UIntMap.
+   * @param name the name of the UIntMap.
+   * @param key the key within the map.
+   * @return a Counter handle, valid until the key is removed from the map.
+   */
+  Counter GetCounter(const std::string &name, const std::string &key);
+
+  /**
+   * @brief Get a Gauge handle for an entry in a UIntMap.
+   * @param name the name of the UIntMap.
+   * @param key the key within the map.
+   * @return a Gauge handle, valid until the key is removed from the map.
+   */
+  Gauge GetGauge(const std::string &name, const std::string &key);
+
+  /**
+   * @brief Get a Histogram handle, backed by entries in a UIntMap.
+   * @param name the name of the UIntMap.
+   * @param key the prefix for the bucket keys.
+   * @param bounds the upper bound of each bucket, in ascending order. This
+   *   must remain valid for the lifetime of the handle.
+   * @param bound_count the number of bounds.
+   * @return a Histogram handle, valid until RemoveHistogram() is called.
+   *
+   * The buckets are exported as "<key>:<upper bound>" with the last one
+   * being "<key>:inf".
+   */
+  Histogram GetHistogram(const std::string &name,
+                         const std::string &key,
+                         const unsigned int bounds[],
+                         unsigned int bound_count);
+
+  /**
+   * @brief Remove the buckets created by GetHistogram().
+   *
+   * Any handles to the histogram must not be used after this.
+   */
+  void RemoveHistogram(const std::string &name,
+                       const std::string &key,
+                       const unsigned int bounds[],
+                       unsigned int bound_count);
+
   /**
    * @brief Fetch a list of all known variables.
    * @returns a vector of all variables.
@@ -388,6 +621,11 @@ class ExportMap {
                   const std::string &name,
                   const std::string &label);
 
+  static std::string BucketKey(const std::string &key,
+                               const unsigned int bounds[],
+                               unsigned int bound_count,
+                               unsigned int bucket);
+
   std::map<std::string, BoolVariable*> m_bool_variables;
   std::map<std::string, CounterVariable*> m_counter_variables;
   std::map<std::string, IntegerVariable*> m_int_variables;
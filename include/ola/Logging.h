@@ -44,6 +44,8 @@
 #ifndef INCLUDE_OLA_LOGGING_H_
 #define INCLUDE_OLA_LOGGING_H_
 
+#include <ola/base/Macro.h>
+#include <stdint.h>
 #include <ostream>
 #include <string>
 #include <sstream>
@@ -55,6 +57,7 @@
  * @param level the log_level to log at.
  */
 #define OLA_LOG(level) (level <= ola::LogLevel()) && \
+                        ola::LogLine::Allowed(__FILE__, __LINE__) && \
                         ola::LogLine(__FILE__, __LINE__, level).stream()
 /**
  * Provide a stream to log a fatal message. e.g.
@@ -90,6 +93,8 @@
 
 namespace ola {
 
+class Clock;
+
 /**
  * @brief The OLA log levels.
  * This controls the verbosity of logging. Each level also includes those below
@@ -110,6 +115,12 @@ enum log_level {
  */
 extern log_level logging_level;
 
+/**
+ * @private
+ * @brief True if SetLogRateLimit() has set a limit.
+ */
+extern bool log_rate_limited;
+
 /**
  * @brief The destination to write log messages to
  */
@@ -208,6 +219,68 @@ class UnixSyslogDestination : public SyslogDestination {
 };
 #endif
 
+/**
+ * @brief A LogDestination that hands lines to a background thread, which
+ * writes them to another LogDestination.
+ *
+ * Write() copies the line into a lock free queue and returns, so a slow
+ * destination (stderr to a terminal, syslog) doesn't hold up the thread that
+ * logged. If the queue is full the line is dropped and counted, the number of
+ * dropped lines is logged once there is space again.
+ *
+ * Lines longer than MAX_LINE_LENGTH are truncated.
+ *
+ * The thread is started by the first Write(), and again by the first Write()
+ * in a child process, so it's safe to create the destination before
+ * daemonising.
+ */
+class AsyncLogDestination: public LogDestination {
+ public:
+  /**
+   * @brief Create a new AsyncLogDestination.
+   * @param destination the LogDestination to write to, ownership is
+   *   transferred.
+   * @param queue_size the number of lines that can be waiting to be written.
+   */
+  explicit AsyncLogDestination(LogDestination *destination,
+                               unsigned int queue_size = DEFAULT_QUEUE_SIZE);
+
+  /**
+   * @brief Destructor, this writes any lines still in the queue.
+   */
+  ~AsyncLogDestination();
+
+  /**
+   * @brief Queue a line to be written by the background thread.
+   */
+  void Write(log_level level, const std::string &log_line);
+
+  /**
+   * @brief Block until the lines queued so far have been written.
+   *
+   * This returns straight away if the thread isn't running in this process.
+   */
+  void Flush();
+
+  /**
+   * @brief The number of lines dropped because the queue was full.
+   */
+  uint64_t DroppedLines() const;
+
+  static const unsigned int DEFAULT_QUEUE_SIZE = 1024;
+  static const unsigned int MAX_LINE_LENGTH = 512;
+
+ private:
+  class WriterThread;
+
+  const unsigned int m_queue_size;
+  WriterThread *m_writer;
+
+  void StartWriter();
+
+  DISALLOW_COPY_AND_ASSIGN(AsyncLogDestination);
+};
+
 /**@}*/
 
 /**
@@ -221,11 +294,23 @@ class LogLine {
   ~LogLine();
   void Write();
 
+  /*
+   * Check the rate limit for a logging statement. This runs before the
+   * LogLine is created, so suppressed lines aren't formatted.
+   */
+  static bool Allowed(const char *file, int line) {
+    return !log_rate_limited || RateLimitAllows(file, line);
+  }
+
   std::ostream &stream() { return m_stream; }
  private:
+  const char *m_file;
+  int m_line;
   log_level m_level;
   std::ostringstream m_stream;
   unsigned int m_prefix_length;
+
+  static bool RateLimitAllows(const char *file, int line);
 };
 /**@endcond*/
 
@@ -272,6 +357,28 @@ bool InitLogging(log_level level, log_output output);
  * @param destination the LogDestination to use.
  */
 void InitLogging(log_level level, LogDestination *destination);
+
+/**
+ * @brief Limit the number of lines each logging statement writes.
+ * @param lines_per_second the maximum number of lines a single OLA_WARN,
+ *   OLA_INFO etc. statement can write each second, 0 removes the limit.
+ * @param clock the Clock to use, NULL uses the system clock. This is for
+ *   testing.
+ *
+ * Lines over the limit are suppressed before they're formatted. The next line
+ * written by the same statement notes how many were suppressed, so a flood of
+ * identical messages, for example one per malformed packet, turns into one
+ * line per second.
+ *
+ * This should be called before any threads start logging.
+ */
+void SetLogRateLimit(unsigned int lines_per_second,
+                     const Clock *clock = NULL);
+
+/**
+ * @brief The number of lines suppressed by the rate limit.
+ */
+uint64_t SuppressedLogLines();
 /***/
 }  // namespace ola
 /**@}*/
@@ -111,9 +111,23 @@ struct SendRDMArgs {
    */
   bool include_raw_frames;
 
+  /**
+   * @brief Set to true to always send the request to the responder, rather
+   * than using a response cached by olad.
+   */
+  bool bypass_cache;
+
+  /**
+   * @brief Set to true to send the request after any interactive requests
+   * for the same port. Use this for bulk reads.
+   */
+  bool background;
+
   explicit SendRDMArgs(RDMCallback *_callback)
     : callback(_callback),
-      include_raw_frames(false) {
+      include_raw_frames(false),
+      bypass_cache(false),
+      background(false) {
   }
 };
 }  // namespace client
@@ -38,8 +38,15 @@ class OlaClient;
  */
 class ClientRDMAPIShim : public ola::rdm::RDMAPIImplInterface {
  public:
-  explicit ClientRDMAPIShim(OlaClient *client)
-      : m_client(client) {
+  /**
+   * @brief Create a new ClientRDMAPIShim.
+   * @param client the OlaClient to send requests with.
+   * @param background true if the requests should be sent as background
+   *   requests, see SendRDMArgs::background.
+   */
+  explicit ClientRDMAPIShim(OlaClient *client, bool background = false)
+      : m_client(client),
+        m_background(background) {
   }
 
   bool RDMGet(rdm_callback *callback,
@@ -68,6 +75,7 @@ class ClientRDMAPIShim : public ola::rdm::RDMAPIImplInterface {
 
  private:
   OlaClient *m_client;
+  bool m_background;
 
   void HandleResponse(
       rdm_callback *callback,
@@ -21,6 +21,7 @@
 #ifndef INCLUDE_OLA_CLIENT_CLIENTTYPES_H_
 #define INCLUDE_OLA_CLIENT_CLIENTTYPES_H_
 
+#include <ola/DmxBuffer.h>
 #include <ola/dmx/SourcePriorities.h>
 #include <ola/rdm/RDMFrame.h>
 #include <ola/rdm/RDMResponseCodes.h>
@@ -326,6 +327,38 @@ struct DMXMetadata {
 };
 
 
+/**
+ * @brief DMX data for a single universe, used to send many universes at once.
+ */
+struct UniverseDMX {
+  /**
+   * @brief The universe to send to.
+   */
+  unsigned int universe;
+  /**
+   * @brief The DMX data.
+   */
+  DmxBuffer data;
+  /**
+   * @brief The priority of the data.
+   */
+  uint8_t priority;
+
+  UniverseDMX(unsigned int _universe,
+              const DmxBuffer &_data,
+              uint8_t _priority = ola::dmx::SOURCE_PRIORITY_DEFAULT)
+      : universe(_universe),
+        data(_data),
+        priority(_priority) {
+  }
+};
+
+/**
+ * @brief DMX data for many universes.
+ */
+typedef std::vector<UniverseDMX> DMXBatch;
+
+
 /**
  * @brief Metadata that accompanies RDM Responses.
  */
@@ -248,6 +248,14 @@ class OlaClient {
                const DmxBuffer &data,
                const SendDMXArgs &args);
 
+  /**
+   * @brief Stream DMX data for many universes in a single RPC.
+   * @param batch the data to send.
+   *
+   * Like SendDMX() without a callback, no response is sent by the server.
+   */
+  void SendDMXBatch(const DMXBatch &batch);
+
   /**
    * @brief Fetch the latest DMX data for a universe.
    * @param universe the universe id to get data for.
@@ -28,13 +28,22 @@
 #include <ola/Constants.h>
 #include <ola/DmxBuffer.h>
 #include <ola/base/Macro.h>
+#include <ola/client/ClientTypes.h>
 #include <ola/dmx/SourcePriorities.h>
 
+#include <map>
+#include <memory>
+#include <vector>
+
 namespace ola {
 
+namespace dmx { class SharedDmxRegion; }
 namespace io { class SelectServer; }
 namespace network { class TCPSocket; }
-namespace proto { class OlaServerService_Stub; }
+namespace proto {
+class DmxDataBatch;
+class OlaServerService_Stub;
+}
 namespace rpc {
 class RpcChannel;
 class RpcSession;
@@ -164,6 +173,31 @@ class StreamingClient : public StreamingClientInterface {
                const DmxBuffer &data,
                const SendArgs &args);
 
+  /**
+   * @brief Send DMX data for many universes.
+   * @param batch the data to send.
+   * @returns true if sent sucessfully, false if the connection to the server
+   *   has been closed.
+   *
+   * This is much cheaper than calling SendDMX() for each universe, since the
+   * data is sent in as few RPCs as possible and the server only updates each
+   * universe once.
+   */
+  bool SendDMXBatch(const DMXBatch &batch);
+
+  /**
+   * @brief Send the data for some universes via shared memory.
+   * @param universes the universes to send via shared memory.
+   * @returns true if shared memory is now in use, false if olad or this
+   *   platform doesn't support it. In the latter case, the data is still sent
+   *   with RPCs.
+   *
+   * This only works if olad is on the same host and running as the same
+   * user. Each call replaces the universes from the previous call. Data for
+   * other universes is still sent with RPCs.
+   */
+  bool EnableSharedMemory(const std::vector<unsigned int> &universes);
+
   void ChannelClosed(ola::rpc::RpcSession *session);
 
  private:
@@ -174,8 +208,22 @@ class StreamingClient : public StreamingClientInterface {
   class ola::rpc::RpcChannel *m_channel;
   class ola::proto::OlaServerService_Stub *m_stub;
   bool m_socket_closed;
+  std::auto_ptr<ola::proto::DmxDataBatch> m_batch;
+  ola::dmx::SharedDmxRegion *m_region;
+  std::map<unsigned int, unsigned int> m_region_slots;
+  int m_doorbell_fd;
 
+  bool CheckConnection();
   bool Send(unsigned int universe, uint8_t priority, const DmxBuffer &data);
+  bool WriteToRegion(unsigned int universe, uint8_t priority,
+                     const DmxBuffer &data);
+  void RingDoorbell();
+  void CloseSharedMemory();
+
+  // Limits the size of each RPC, 512 universes is about 270kB.
+  static const unsigned int MAX_BATCH_SIZE = 512;
+  // How long to wait for olad to create the shared memory region.
+  static const unsigned int SHARED_MEMORY_TIMEOUT_MS = 2000;
 
   DISALLOW_COPY_AND_ASSIGN(StreamingClient);
 };
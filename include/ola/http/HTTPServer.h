@@ -26,6 +26,7 @@
 #include <ola/base/Macro.h>
 #include <ola/io/Descriptor.h>
 #include <ola/io/SelectServer.h>
+#include <ola/thread/Mutex.h>
 #include <ola/thread/Thread.h>
 #include <ola/web/Json.h>
 // 0.4.6 of microhttp doesn't include stdarg so we do it here.
@@ -75,6 +76,15 @@ class HTTPRequest {
 
   bool InFlight() const { return m_in_flight; }
   void SetInFlight() { m_in_flight = true; }
+  struct MHD_Connection *Connection() const { return m_connection; }
+
+  // These are used when libmicrohttpd runs its own threads. The request is
+  // handled on the HTTP server thread, and the response is passed back to be
+  // queued from the libmicrohttpd thread.
+  void SetPendingResponse(unsigned int status_code,
+                          struct MHD_Response *response);
+  void SetFailed();
+  int QueuePendingResponse();
 
  private:
   std::string m_url;
@@ -85,6 +95,9 @@ class HTTPRequest {
   std::map<std::string, std::string> m_post_params;
   struct MHD_PostProcessor *m_processor;
   bool m_in_flight;
+  bool m_failed;
+  unsigned int m_pending_status_code;
+  struct MHD_Response *m_pending_response;
 
   static const unsigned int K_POST_BUFFER_SIZE = 1024;
 
@@ -97,8 +110,16 @@ class HTTPRequest {
  */
 class HTTPResponse {
  public:
-  explicit HTTPResponse(struct MHD_Connection *connection):
+  /**
+   * @brief Create a new response.
+   * @param connection the connection to send the response on.
+   * @param request if not NULL, the response is passed to the request rather
+   *   than queued on the connection, see HTTPRequest::SetPendingResponse().
+   */
+  explicit HTTPResponse(struct MHD_Connection *connection,
+                        HTTPRequest *request = NULL):
     m_connection(connection),
+    m_request(request),
     m_status_code(MHD_HTTP_OK) {}
 
   void Append(const std::string &data) { m_data.append(data); }
@@ -108,18 +129,97 @@ class HTTPResponse {
   void SetNoCache();
   int SendJson(const ola::web::JsonValue &json);
   int Send();
+  int SendStream(class HTTPStream *stream);
   struct MHD_Connection *Connection() const { return m_connection; }
  private:
   std::string m_data;
   struct MHD_Connection *m_connection;
+  HTTPRequest *m_request;
   typedef std::multimap<std::string, std::string> HeadersMultiMap;
   HeadersMultiMap m_headers;
   unsigned int m_status_code;
 
+  int QueueResponse(struct MHD_Response *response);
+
+  static const unsigned int K_STREAM_BLOCK_SIZE = 4096;
+
   DISALLOW_COPY_AND_ASSIGN(HTTPResponse);
 };
 
 
+/**
+ * @brief A response body that's sent incrementally.
+ *
+ * Streams are created with HTTPServer::StartStream(), and stay open until
+ * either Close() is called or the client disconnects. Data passed to Send() is
+ * buffered until libmicrohttpd is ready to write it, and the connection is
+ * suspended while there is nothing to send, so an idle stream doesn't cost
+ * anything.
+ *
+ * All methods must be called on the HTTP server thread. The stream is deleted
+ * by the HTTPServer once the connection has closed, after the on-close
+ * callback has run.
+ */
+class HTTPStream {
+ public:
+  HTTPStream(class HTTPServer *server, struct MHD_Connection *connection);
+  ~HTTPStream();
+
+  /**
+   * @brief Queue data to be sent to the client.
+   */
+  void Send(const std::string &data);
+
+  /**
+   * @brief End the response once any queued data has been sent.
+   */
+  void Close();
+
+  /**
+   * @brief The number of bytes waiting to be sent.
+   */
+  size_t QueuedBytes() const;
+
+  /**
+   * @brief Set the callback to run when the connection closes.
+   * @param on_close the callback to run, ownership is transferred.
+   */
+  void SetOnClose(ola::SingleUseCallback0<void> *on_close);
+
+  /**
+   * @brief Called by libmicrohttpd to fetch the next chunk of data.
+   */
+  ssize_t Read(char *data, size_t size);
+
+  /**
+   * @brief Called by libmicrohttpd when the connection has closed.
+   */
+  void Closed();
+
+  /**
+   * @brief Called by the HTTPServer, on the HTTP server thread, once the
+   * connection has closed.
+   */
+  void RunOnClose();
+
+ private:
+  class HTTPServer *m_server;
+  struct MHD_Connection *m_connection;
+  // Read() may be called from one of libmicrohttpd's threads.
+  mutable ola::thread::Mutex m_mutex;
+  std::string m_buffer;
+  size_t m_offset;
+  bool m_suspended;
+  bool m_closed;
+  bool m_detached;
+  ola::SingleUseCallback0<void> *m_on_close;
+
+  void Resume();
+
+  DISALLOW_COPY_AND_ASSIGN(HTTPStream);
+};
+
+
 /**
  * @addtogroup http_server
  * @{
@@ -152,10 +252,16 @@ class HTTPServer: public ola::thread::Thread {
     uint16_t port;
     // The root for content served with ServeStaticContent();
     std::string data_dir;
+    // If non-0, libmicrohttpd runs a pool of this many threads, using epoll
+    // where it's available. Registered files are served from these threads,
+    // everything else is passed to the HTTP server thread. If 0, all requests
+    // are handled on the HTTP server thread.
+    unsigned int thread_pool_size;
 
     HTTPServerOptions()
       : port(0),
-        data_dir("") {
+        data_dir(""),
+        thread_pool_size(0) {
     }
   };
 
@@ -172,12 +278,14 @@ class HTTPServer: public ola::thread::Thread {
    */
   void HandleHTTPIO() {}
 
+  int StartRequest(HTTPRequest *request);
   int DispatchRequest(const HTTPRequest *request, HTTPResponse *response);
 
   // Register a callback handler.
   bool RegisterHandler(const std::string &path, BaseHTTPCallback *handler);
 
-  // Register a file handler.
+  // Register a file handler. Files registered before Init() is called are
+  // loaded into memory by Init(), and served from there.
   bool RegisterFile(const std::string &path,
                     const std::string &content_type);
   bool RegisterFile(const std::string &path,
@@ -199,6 +307,16 @@ class HTTPServer: public ola::thread::Thread {
                          const std::string &content_type,
                          HTTPResponse *response);
 
+  /**
+   * @brief Start a streaming response.
+   * @param response the response to stream, the headers are sent straight
+   *   away. Ownership is not transferred.
+   * @returns a new HTTPStream, or NULL if streaming isn't supported by this
+   *   version of libmicrohttpd or the response couldn't be queued.
+   */
+  HTTPStream *StartStream(HTTPResponse *response);
+  void StreamClosed(HTTPStream *stream);
+
   static const char CONTENT_TYPE_PLAIN[];
   static const char CONTENT_TYPE_HTML[];
   static const char CONTENT_TYPE_GIF[];
@@ -229,6 +347,24 @@ class HTTPServer: public ola::thread::Thread {
     uint8_t         : 6;
   };
 
+  // A representation of a cached file, and the response to use if the client
+  // already has it.
+  struct CachedVariant {
+    CachedVariant() : response(NULL), not_modified(NULL) {}
+
+    std::string etag;
+    struct MHD_Response *response;
+    struct MHD_Response *not_modified;
+  };
+
+  struct CachedFile {
+    CachedVariant identity;
+    CachedVariant gzip;
+    CachedVariant brotli;
+  };
+
+  typedef std::map<std::string, CachedFile*> FileCache;
+
   struct Descriptor_lt {
     bool operator()(const DescriptorState *d1,
                     const DescriptorState *d2) const {
@@ -242,16 +378,38 @@ class HTTPServer: public ola::thread::Thread {
   struct MHD_Daemon *m_httpd;
   std::auto_ptr<ola::io::SelectServer> m_select_server;
   SocketSet m_sockets;
+  std::set<HTTPStream*> m_streams;
+  // Populated by Init(), and read-only after that.
+  FileCache m_file_cache;
 
   std::map<std::string, BaseHTTPCallback*> m_handlers;
   std::map<std::string, static_file_info> m_static_content;
   BaseHTTPCallback *m_default_handler;
   unsigned int m_port;
   std::string m_data_dir;
+  unsigned int m_thread_pool_size;
+  // Protects m_stopping, so the pool threads don't pass requests to the HTTP
+  // server thread once the destructor has started.
+  ola::thread::Mutex m_stopping_lock;
+  bool m_stopping;
 
   int ServeStaticContent(static_file_info *file_info,
                          HTTPResponse *response);
 
+  void DispatchDeferred(HTTPRequest *request);
+  void ReleaseStream(HTTPStream *stream);
+
+  bool ReadFile(const std::string &file, std::string *data) const;
+  void LoadFileCache();
+  bool LoadVariant(const std::string &data,
+                   const std::string &content_type,
+                   const std::string &etag,
+                   const std::string &encoding,
+                   bool vary,
+                   CachedVariant *variant);
+  void FreeVariant(CachedVariant *variant);
+  int ServeCachedFile(const HTTPRequest *request, const CachedFile *file);
+
   void InsertSocket(bool is_readable, bool is_writeable, int fd);
   void FreeSocket(DescriptorState *state);
 
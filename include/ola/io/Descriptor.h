@@ -28,6 +28,8 @@
 #include <ola/io/IOQueue.h>
 #include <string>
 
+struct sockaddr;
+
 namespace ola {
 namespace io {
 
@@ -130,6 +132,21 @@ static DescriptorHandle INVALID_DESCRIPTOR = -1;
  */
 int ToFD(const DescriptorHandle& handle);
 
+/**
+ * @brief A datagram a poller has received on behalf of a descriptor.
+ *
+ * The pointers remain valid until the descriptor's
+ * ReadFileDescriptor::SetReceivedDatagrams() is called again.
+ */
+struct ReceivedDatagram {
+  const uint8_t *data;  /**< The datagram */
+  unsigned int size;  /**< The size of the datagram */
+  const struct sockaddr *source;  /**< The source address */
+  unsigned int source_size;  /**< The size of source */
+  const uint8_t *control;  /**< The ancillary data, may be NULL */
+  unsigned int control_size;  /**< The size of control */
+};
+
 /*
  * A FileDescriptor which can be read from.
  */
@@ -161,6 +178,35 @@ class ReadFileDescriptor {
    * This is usually called by the SelectServer.
    */
   virtual void PerformRead() = 0;
+
+  /**
+   * @brief Check if the poller may receive datagrams for this descriptor.
+   * @returns true if this descriptor supports SetReceivedDatagrams().
+   *
+   * Pollers which receive in the kernel, like io_uring, hand the datagrams to
+   * the descriptor rather than signalling that it's readable.
+   */
+  virtual bool AcceptsReceivedDatagrams() const { return false; }
+
+  /**
+   * @brief Supply datagrams which the poller has received for this descriptor.
+   * @param datagrams the datagrams, or NULL once PerformRead() has returned.
+   * @param count the number of datagrams.
+   *
+   * While datagrams are set, reads return them in order, rather than calling
+   * into the kernel, and fail once they've all been read.
+   */
+  virtual void SetReceivedDatagrams(const ReceivedDatagram *datagrams,
+                                    unsigned int count) {
+    (void) datagrams;
+    (void) count;
+  }
+
+  /**
+   * @brief The number of datagrams from SetReceivedDatagrams() which haven't
+   *   been read yet.
+   */
+  virtual unsigned int UnreadDatagrams() const { return 0; }
 };
 
 
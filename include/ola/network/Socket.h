@@ -34,8 +34,27 @@
 #include <string>
 
 namespace ola {
+
+class UIntMap;
+
+namespace thread {
+class SchedulerInterface;
+}  // namespace thread
+
 namespace network {
 
+class UDPSendBatch;
+
+/**
+ * @brief A datagram received with UDPSocketInterface::RecvBatch().
+ */
+struct UDPDatagram {
+  uint8_t *data;  /**< The buffer to receive into, set by the caller */
+  unsigned int buffer_size;  /**< The size of data, set by the caller */
+  ssize_t size;  /**< The size of the datagram that was received */
+  IPV4SocketAddress source;  /**< The source of the datagram */
+};
+
 /**
  * @brief The interface for UDPSockets.
  *
@@ -185,6 +204,40 @@ class UDPSocketInterface: public ola::io::BidirectionalFileDescriptor {
                         ssize_t *data_read,
                         IPV4SocketAddress *source) = 0;
 
+  /**
+   * @brief Receive the waiting datagrams with a single system call.
+   * @param datagrams an array of count datagrams. The data and buffer_size
+   *   members must be set, the size and source members are filled in.
+   * @param count the number of entries in datagrams.
+   * @return the number of datagrams received, 0 if none were waiting or there
+   *   was an error.
+   *
+   * This should be called when the socket is readable. If recvmmsg() isn't
+   * available, at most one datagram is received.
+   */
+  virtual unsigned int RecvBatch(UDPDatagram *datagrams,
+                                 unsigned int count) = 0;
+
+  /**
+   * @brief Set the size of the kernel receive buffer (SO_RCVBUF).
+   * @param size the requested size in bytes. The kernel may clamp this.
+   * @return true if the option was set, false otherwise.
+   */
+  virtual bool SetReceiveBufferSize(unsigned int size) = 0;
+
+  /**
+   * @brief Count the datagrams the kernel drops because the receive buffer is
+   *   full (SO_RXQ_OVFL).
+   * @param drops the map entry for key is set to the number of dropped
+   *   datagrams.
+   * @param key the key to use in drops.
+   * @return true if drop counting was enabled, false if the platform doesn't
+   *   support it.
+   *
+   * The count is updated as datagrams are received with RecvBatch().
+   */
+  virtual bool EnableDropCounting(UIntMap *drops, const std::string &key) = 0;
+
   /**
    * @brief Enable broadcasting for this socket.
    * @return true if it worked, false otherwise
@@ -224,6 +277,35 @@ class UDPSocketInterface: public ola::io::BidirectionalFileDescriptor {
    */
   virtual bool SetTos(uint8_t tos) = 0;
 
+  /**
+   * @brief Count the datagrams that fail to send.
+   * @param send_errors the map entry for key is incremented for each datagram
+   *   that fails to send, whether it was sent directly or in a batch.
+   * @param key the key to use in send_errors.
+   */
+  virtual void EnableSendErrorCounting(UIntMap *send_errors,
+                                       const std::string &key) = 0;
+
+  /**
+   * @brief Queue outgoing datagrams and send them in batches.
+   * @param scheduler the scheduler used to flush the queue once the current
+   *   event has been handled.
+   * @return true if batching was enabled, false if the platform doesn't
+   *   support it, in which case datagrams are sent immediately.
+   *
+   * While batching is enabled, SendTo() returns the size of the datagram once
+   * it's queued. Datagrams that fail to send when the queue is flushed are
+   * logged and counted, see EnableSendErrorCounting().
+   */
+  virtual bool EnableSendBatching(
+      ola::thread::SchedulerInterface *scheduler) = 0;
+
+  /**
+   * @brief Send any queued datagrams now.
+   * @return false if any of the queued datagrams failed to send.
+   */
+  virtual bool FlushSendBatch() = 0;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(UDPSocketInterface);
 };
@@ -237,8 +319,14 @@ class UDPSocket: public UDPSocketInterface {
   UDPSocket()
       : UDPSocketInterface(),
         m_handle(ola::io::INVALID_DESCRIPTOR),
-        m_bound_to_port(false) {}
-  ~UDPSocket() { Close(); }
+        m_bound_to_port(false),
+        m_send_batch(NULL),
+        m_send_errors(NULL),
+        m_rx_drops(NULL),
+        m_received(NULL),
+        m_received_count(0),
+        m_received_read(0) {}
+  ~UDPSocket();
   bool Init();
   bool Bind(const IPV4SocketAddress &endpoint);
 
@@ -273,6 +361,11 @@ class UDPSocket: public UDPSocketInterface {
                 ssize_t *data_read,
                 IPV4SocketAddress *source);
 
+  unsigned int RecvBatch(UDPDatagram *datagrams, unsigned int count);
+
+  bool SetReceiveBufferSize(unsigned int size);
+  bool EnableDropCounting(UIntMap *drops, const std::string &key);
+
   bool EnableBroadcast();
   bool SetMulticastInterface(const IPV4Address &iface);
   bool JoinMulticast(const IPV4Address &iface,
@@ -283,9 +376,33 @@ class UDPSocket: public UDPSocketInterface {
 
   bool SetTos(uint8_t tos);
 
+  void EnableSendErrorCounting(UIntMap *send_errors, const std::string &key);
+  bool EnableSendBatching(ola::thread::SchedulerInterface *scheduler);
+  bool FlushSendBatch();
+
+  bool AcceptsReceivedDatagrams() const { return true; }
+  void SetReceivedDatagrams(const ola::io::ReceivedDatagram *datagrams,
+                            unsigned int count);
+  unsigned int UnreadDatagrams() const {
+    return m_received_count - m_received_read;
+  }
+
  private:
   ola::io::DescriptorHandle m_handle;
   bool m_bound_to_port;
+  UDPSendBatch *m_send_batch;
+  UIntMap *m_send_errors;
+  std::string m_send_errors_key;
+  UIntMap *m_rx_drops;
+  std::string m_rx_drops_key;
+  // Set while the poller is handing us datagrams it has received.
+  const ola::io::ReceivedDatagram *m_received;
+  unsigned int m_received_count;
+  mutable unsigned int m_received_read;
+
+  void CountSendError() const;
+  bool Receive(uint8_t *buffer, ssize_t *data_read,
+               IPV4SocketAddress *source) const;
 
   DISALLOW_COPY_AND_ASSIGN(UDPSocket);
 };
@@ -117,7 +117,8 @@ class DiscoveryTargetInterface {
  * the DiscoveryAgent.
  *
  * The discovery process goes something like this:
- *   - if incremental, copy all previously discovered UIDs to the mute list
+ *   - if incremental, copy all previously discovered UIDs (or those passed to
+ *     SetKnownUIDs()) to the mute list
  *   - push (0, 0xffffffffffff) onto the resolution stack
  *   - unmute all
  *   - mute all previously discovered UIDs, for any that fail to mute remove
@@ -148,6 +149,25 @@ class DiscoveryAgent {
   typedef ola::SingleUseCallback2<void, bool, const UIDSet&>
     DiscoveryCompleteCallback;
 
+  /**
+   * @brief Counters for the most recent discovery operation.
+   */
+  struct DiscoveryStats {
+    DiscoveryStats()
+        : branches(0),
+          collisions(0),
+          mutes(0),
+          verified_uids(0),
+          lost_uids(0) {
+    }
+
+    unsigned int branches;  // the number of DUB commands sent
+    unsigned int collisions;  // the number of DUB responses that collided
+    unsigned int mutes;  // the number of mute commands sent
+    unsigned int verified_uids;  // known UIDs that acked the mute
+    unsigned int lost_uids;  // known UIDs that failed to ack the mute
+  };
+
   /**
    * @brief Cancel any in-progress discovery operation.
    * If a discovery operation is running, this will result in the callback
@@ -167,6 +187,22 @@ class DiscoveryAgent {
    */
   void StartIncrementalDiscovery(DiscoveryCompleteCallback *on_complete);
 
+  /**
+   * @brief Set the UIDs that are expected to be present.
+   * @param uids the UIDs, usually saved from an earlier discovery operation.
+   *
+   * The next incremental discovery operation mutes these UIDs before sending
+   * any DUB commands, so the branch search only has to locate devices that
+   * weren't already known. UIDs that don't ack the mute are dropped. This is
+   * ignored if a discovery operation is running.
+   */
+  void SetKnownUIDs(const UIDSet &uids);
+
+  /**
+   * @brief Return the counters for the most recent discovery operation.
+   */
+  const DiscoveryStats &Stats() const { return m_stats; }
+
  private:
   /**
    * @brief Represents a range of UIDs (a branch of the UID tree)
@@ -214,6 +250,7 @@ class DiscoveryAgent {
   unsigned int m_unmute_count;
   unsigned int m_mute_attempts;
   bool m_tree_corrupt;  // true if there was a problem with discovery
+  DiscoveryStats m_stats;
 
   void InitDiscovery(DiscoveryCompleteCallback *on_complete,
                      bool incremental);
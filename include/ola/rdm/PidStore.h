@@ -32,6 +32,7 @@
 #include <stdint.h>
 #include <ola/messaging/Descriptor.h>
 #include <ola/base/Macro.h>
+#include <ola/thread/Mutex.h>
 #include <istream>
 #include <map>
 #include <memory>
@@ -64,6 +65,11 @@ class PidDescriptor;
  * An overrides.proto file can be used as a local system override of any PID
  * data. This allows manufacturers to specify their own manufacturer specific
  * commands and for testing of draft PIDs.
+ *
+ * The .proto files can be compiled into a single pids.bin file at build time.
+ * If pids.bin is present, and the .proto files haven't changed since it was
+ * built, it's loaded instead of the .proto files and the Descriptors for each
+ * PID are built the first time the PID is used.
  */
 class RootPidStore {
  public:
@@ -239,6 +245,29 @@ class PidStore {
 };
 
 
+/**
+ * @brief Builds the Descriptors for a PidDescriptor.
+ *
+ * This allows the Descriptors to be built when the PID is first used, rather
+ * than when the store is loaded.
+ */
+class PidFrameBuilder {
+ public:
+  virtual ~PidFrameBuilder() {}
+
+  /**
+   * @brief Build the Descriptors for the GET/SET Requests & Responses.
+   *
+   * Each Descriptor is set to NULL if the PID doesn't support it. Ownership
+   * of the Descriptors is transferred to the caller.
+   */
+  virtual void BuildFrames(const ola::messaging::Descriptor **get_request,
+                           const ola::messaging::Descriptor **get_response,
+                           const ola::messaging::Descriptor **set_request,
+                           const ola::messaging::Descriptor **set_response) = 0;
+};
+
+
 /**
  * Contains the descriptors for the GET/SET Requests & Responses for a single
  * PID.
@@ -268,6 +297,32 @@ class PidDescriptor {
         m_get_response(get_response),
         m_set_request(set_request),
         m_set_response(set_response),
+        m_built(true),
+        m_get_subdevice_range(get_sub_device_range),
+        m_set_subdevice_range(set_sub_device_range) {
+  }
+
+  /**
+   * @brief Create a PidDescriptor which builds its Descriptors on first use.
+   * @param name the name of the PID.
+   * @param value the PID.
+   * @param builder the PidFrameBuilder, ownership is transferred.
+   * @param get_sub_device_range the sub devices GET requests are valid for.
+   * @param set_sub_device_range the sub devices SET requests are valid for.
+   */
+  PidDescriptor(const std::string &name,
+                uint16_t value,
+                PidFrameBuilder *builder,
+                sub_device_validator get_sub_device_range,
+                sub_device_validator set_sub_device_range)
+      : m_name(name),
+        m_pid_value(value),
+        m_get_request(NULL),
+        m_get_response(NULL),
+        m_set_request(NULL),
+        m_set_response(NULL),
+        m_builder(builder),
+        m_built(false),
         m_get_subdevice_range(get_sub_device_range),
         m_set_subdevice_range(set_sub_device_range) {
   }
@@ -275,14 +330,10 @@ class PidDescriptor {
 
   const std::string &Name() const { return m_name; }
   uint16_t Value() const { return m_pid_value; }
-  const ola::messaging::Descriptor *GetRequest() const { return m_get_request; }
-  const ola::messaging::Descriptor *GetResponse() const {
-    return m_get_response;
-  }
-  const ola::messaging::Descriptor *SetRequest() const { return m_set_request; }
-  const ola::messaging::Descriptor *SetResponse() const {
-    return m_set_response;
-  }
+  const ola::messaging::Descriptor *GetRequest() const;
+  const ola::messaging::Descriptor *GetResponse() const;
+  const ola::messaging::Descriptor *SetRequest() const;
+  const ola::messaging::Descriptor *SetResponse() const;
 
   bool IsGetValid(uint16_t sub_device) const;
   bool IsSetValid(uint16_t sub_device) const;
@@ -290,13 +341,19 @@ class PidDescriptor {
  private:
   const std::string m_name;
   uint16_t m_pid_value;
-  const ola::messaging::Descriptor *m_get_request;
-  const ola::messaging::Descriptor *m_get_response;
-  const ola::messaging::Descriptor *m_set_request;
-  const ola::messaging::Descriptor *m_set_response;
+  mutable const ola::messaging::Descriptor *m_get_request;
+  mutable const ola::messaging::Descriptor *m_get_response;
+  mutable const ola::messaging::Descriptor *m_set_request;
+  mutable const ola::messaging::Descriptor *m_set_response;
+  mutable std::auto_ptr<PidFrameBuilder> m_builder;
+  // Set once the Descriptors have been built, so only the first use of a PID
+  // takes the lock.
+  mutable bool m_built;
+  mutable ola::thread::Mutex m_mutex;
   sub_device_validator m_get_subdevice_range;
   sub_device_validator m_set_subdevice_range;
 
+  void BuildFrames() const;
   bool RequestValid(uint16_t sub_device,
                     const sub_device_validator &validator) const;
 
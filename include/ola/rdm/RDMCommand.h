@@ -244,7 +244,9 @@ class RDMRequest: public RDMCommand {
         sub_start_code(SUB_START_CODE),
         message_length(0),
         message_count(0),
-        checksum(0) {
+        checksum(0),
+        bypass_cache(false),
+        background(false) {
     }
 
     void SetMessageLength(uint8_t message_length_arg) {
@@ -264,6 +266,18 @@ class RDMRequest: public RDMCommand {
     uint8_t message_length;
     uint8_t message_count;
     uint16_t checksum;
+
+    /**
+     * @brief Always send the request to the responder, even if a cached
+     * response is available.
+     */
+    bool bypass_cache;
+
+    /**
+     * @brief Schedule the request behind interactive requests, used for
+     * bulk reads.
+     */
+    bool background;
   };
 
   /**
@@ -332,6 +346,18 @@ class RDMRequest: public RDMCommand {
   uint8_t MessageLength() const;
   uint16_t Checksum(uint16_t checksum) const;
 
+  /**
+   * @brief Check if the response to this request can't be served from a cache.
+   * @returns true if bypass_cache was set, or if any of the other override
+   *   options are in use.
+   */
+  bool BypassCache() const;
+
+  /**
+   * @brief Check if this is a low priority, background request.
+   */
+  bool IsBackground() const { return m_override_options.background; }
+
   /**
    * @name Mutators
    * @{
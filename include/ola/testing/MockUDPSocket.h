@@ -93,6 +93,10 @@ class MockUDPSocket: public ola::network::UDPSocketInterface {
   bool RecvFrom(uint8_t *buffer,
                 ssize_t *data_read,
                 ola::network::IPV4SocketAddress *source);
+  unsigned int RecvBatch(ola::network::UDPDatagram *datagrams,
+                         unsigned int count);
+  bool SetReceiveBufferSize(OLA_UNUSED unsigned int size) { return true; }
+  bool EnableDropCounting(UIntMap *drops, const std::string &key);
   bool EnableBroadcast();
   bool SetMulticastInterface(const ola::network::IPV4Address &iface);
   bool JoinMulticast(const ola::network::IPV4Address &iface,
@@ -103,6 +107,11 @@ class MockUDPSocket: public ola::network::UDPSocketInterface {
 
   bool SetTos(uint8_t tos);
 
+  void EnableSendErrorCounting(OLA_UNUSED UIntMap *send_errors,
+                               OLA_UNUSED const std::string &key) {}
+  bool EnableSendBatching(ola::thread::SchedulerInterface *scheduler);
+  bool FlushSendBatch() { return true; }
+
   void SetDiscardMode(bool discard_mode) { m_discard_mode = discard_mode; }
 
   // these are methods used for verification
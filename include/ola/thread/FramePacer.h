@@ -0,0 +1,183 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * FramePacer.h
+ * Paces the frames sent by output threads.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLA_THREAD_FRAMEPACER_H_
+#define INCLUDE_OLA_THREAD_FRAMEPACER_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <ola/Clock.h>
+#include <ola/base/Macro.h>
+
+namespace ola {
+namespace thread {
+
+/**
+ * @brief Timing statistics for a FramePacer.
+ *
+ * Jitter is how late the thread woke up for a frame, compared to when the
+ * frame was due.
+ */
+struct FrameTimingStats {
+  /** @brief The number of frames. */
+  uint64_t frames;
+  /** @brief The number of frames that were more than a frame late. */
+  uint64_t late_frames;
+  /** @brief The largest jitter seen. */
+  TimeInterval max_jitter;
+  /** @brief The sum of the jitter for all frames. */
+  TimeInterval total_jitter;
+
+  FrameTimingStats() : frames(0), late_frames(0) {}
+
+  /**
+   * @brief The mean jitter.
+   */
+  TimeInterval MeanJitter() const {
+    return frames ? TimeInterval(total_jitter.AsInt() /
+                                 static_cast<int64_t>(frames)) :
+                    TimeInterval();
+  }
+};
+
+/**
+ * @brief The time source used by a FramePacer.
+ *
+ * Times are in microseconds from an arbitrary epoch. The default uses the
+ * monotonic clock, tests provide their own.
+ */
+class PacerClock {
+ public:
+  virtual ~PacerClock() {}
+
+  /**
+   * @brief The current time in microseconds.
+   */
+  virtual int64_t Now() const = 0;
+};
+
+/**
+ * @brief Puts the output thread to sleep for a FramePacer.
+ */
+class PacerSleeper {
+ public:
+  virtual ~PacerSleeper() {}
+
+  /**
+   * @brief Sleep until a time, in the PacerClock's time base.
+   * @param wake_up_us the time to wake up, in microseconds.
+   */
+  virtual void SleepUntil(int64_t wake_up_us) = 0;
+};
+
+/**
+ * @brief Sleeps until the next frame is due.
+ *
+ * Frames are scheduled at fixed intervals from when the pacer was Reset(), so
+ * the time taken to send each frame doesn't affect the frame rate. Where
+ * clock_nanosleep() is available, the pacer sleeps until an absolute time on
+ * the monotonic clock, otherwise it falls back to usleep().
+ *
+ * If a frame is more than a frame interval late, the missed frames are
+ * skipped rather than being sent back to back.
+ *
+ * A FramePacer isn't thread safe, it should only be used by the output thread.
+ * A single thread can drive several ports with one FramePacer.
+ *
+ * @examplepara
+ *   @code
+ *   FramePacer pacer(TimeInterval(0, 25000));  // 40 fps
+ *   while (running) {
+ *     SendBreak();
+ *     pacer.Sleep(TimeInterval(0, 110));
+ *     SendFrame();
+ *     pacer.WaitForNextFrame();
+ *   }
+ *   @endcode
+ */
+class FramePacer {
+ public:
+  /**
+   * @brief Create a new FramePacer.
+   * @param frame_interval the time between frames.
+   * @param clock the clock to use, or NULL for the monotonic clock.
+   *   Ownership is not transferred.
+   * @param sleeper the sleeper to use, or NULL to sleep on the monotonic
+   *   clock. Ownership is not transferred.
+   */
+  explicit FramePacer(const TimeInterval &frame_interval,
+                      const PacerClock *clock = NULL,
+                      PacerSleeper *sleeper = NULL);
+
+  /**
+   * @brief Schedule the next frame one frame interval from now.
+   *
+   * This doesn't reset the statistics.
+   */
+  void Reset();
+
+  /**
+   * @brief Wait until the next frame is due.
+   *
+   * The first call schedules the frames from now.
+   */
+  void WaitForNextFrame();
+
+  /**
+   * @brief Sleep for a short time, used for the break and mark after break.
+   * @param interval the time to sleep for.
+   */
+  void Sleep(const TimeInterval &interval);
+
+  /**
+   * @brief The time between frames.
+   */
+  TimeInterval FrameInterval() const { return TimeInterval(m_interval_us); }
+
+  /**
+   * @brief The timing statistics.
+   */
+  const FrameTimingStats &Stats() const { return m_stats; }
+
+  /**
+   * @brief Reset the timing statistics.
+   */
+  void ResetStats() { m_stats = FrameTimingStats(); }
+
+  /**
+   * @brief Set the real time priority of the calling thread.
+   * @param priority the SCHED_FIFO priority.
+   * @returns true if the priority was changed, false otherwise. This usually
+   *   requires extra privileges.
+   */
+  static bool SetRealtimePriority(int priority);
+
+ private:
+  const PacerClock *m_clock;
+  PacerSleeper *m_sleeper;
+  const int64_t m_interval_us;
+  int64_t m_next_frame_us;
+  FrameTimingStats m_stats;
+
+  DISALLOW_COPY_AND_ASSIGN(FramePacer);
+};
+}  // namespace thread
+}  // namespace ola
+#endif  // INCLUDE_OLA_THREAD_FRAMEPACER_H_
@@ -0,0 +1,174 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * MPSCQueue.h
+ * A bounded, lock free, multiple producer single consumer queue.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLA_THREAD_MPSCQUEUE_H_
+#define INCLUDE_OLA_THREAD_MPSCQUEUE_H_
+
+#include <ola/base/Macro.h>
+#include <vector>
+
+namespace ola {
+namespace thread {
+
+/**
+ * @brief A bounded, lock free queue from many threads to one.
+ *
+ * Any number of threads may call Push() but only one thread may call Pop().
+ * Neither call blocks, Push() returns false if the queue is full and Pop()
+ * returns false if it's empty.
+ *
+ * Each slot has a sequence number, which tells a producer when the slot is
+ * free and the consumer when the slot has been filled. Producers claim a slot
+ * by incrementing the tail with a compare & swap, so a producer that's
+ * descheduled between claiming and filling a slot only holds up the consumer,
+ * not the other producers.
+ *
+ * @examplepara
+ *   @code
+ *   MPSCQueue<Message> queue(1024);
+ *   // any producer thread
+ *   if (!queue.Push(message)) {
+ *     // full, drop the message
+ *   }
+ *   // consumer thread
+ *   Message message;
+ *   while (queue.Pop(&message)) {
+ *     Handle(message);
+ *   }
+ *   @endcode
+ */
+template <typename T>
+class MPSCQueue {
+ public:
+  /**
+   * @brief Create a new queue.
+   * @param capacity the maximum number of items in the queue, this is rounded
+   *   up to a power of two.
+   */
+  explicit MPSCQueue(unsigned int capacity)
+      : m_mask(RoundUp(capacity) - 1),
+        m_slots(m_mask + 1),
+        m_head(0),
+        m_tail(0) {
+    for (unsigned int i = 0; i <= m_mask; i++) {
+      m_slots[i].sequence = i;
+    }
+  }
+
+  /**
+   * @brief Add an item to the back of the queue, called by the producers.
+   * @param item the item to add.
+   * @returns true if the item was added, false if the queue was full.
+   */
+  bool Push(const T &item) {
+    unsigned int tail = __atomic_load_n(&m_tail, __ATOMIC_RELAXED);
+    Slot *slot;
+    while (true) {
+      slot = &m_slots[tail & m_mask];
+      const unsigned int sequence = __atomic_load_n(&slot->sequence,
+                                                    __ATOMIC_ACQUIRE);
+      const int difference = static_cast<int>(sequence - tail);
+      if (difference == 0) {
+        // The slot is free, try to claim it. On failure tail is updated.
+        if (__atomic_compare_exchange_n(&m_tail, &tail, tail + 1, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+          break;
+        }
+      } else if (difference < 0) {
+        // The consumer hasn't finished with the slot from the last lap.
+        return false;
+      } else {
+        // Another producer claimed the slot.
+        tail = __atomic_load_n(&m_tail, __ATOMIC_RELAXED);
+      }
+    }
+    slot->item = item;
+    // Publish the item to the consumer.
+    __atomic_store_n(&slot->sequence, tail + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  /**
+   * @brief Remove the item at the front of the queue, called by the consumer.
+   * @param[out] item the item removed.
+   * @returns true if an item was removed, false if the queue was empty, or
+   *   the producer of the next item hasn't finished writing it.
+   */
+  bool Pop(T *item) {
+    Slot *slot = &m_slots[m_head & m_mask];
+    const unsigned int sequence = __atomic_load_n(&slot->sequence,
+                                                  __ATOMIC_ACQUIRE);
+    if (sequence != m_head + 1) {
+      return false;
+    }
+    *item = slot->item;
+    // Hand the slot back to the producers for the next lap.
+    __atomic_store_n(&slot->sequence, m_head + m_mask + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&m_head, m_head + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  /**
+   * @brief Check if the queue is empty.
+   *
+   * This is only a hint if called from a producer thread.
+   */
+  bool Empty() const {
+    return __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE) ==
+           __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+  }
+
+  /**
+   * @brief The maximum number of items the queue can hold.
+   */
+  unsigned int Capacity() const { return m_mask + 1; }
+
+ private:
+  static const unsigned int CACHE_LINE_SIZE = 64;
+
+  struct Slot {
+    unsigned int sequence;
+    T item;
+  };
+
+  const unsigned int m_mask;
+  std::vector<Slot> m_slots;
+  // The counters only ever increase, and wrap around. The head is only used by
+  // the consumer and the tail is shared by the producers, so we keep them on
+  // separate cache lines.
+  char m_pad1[CACHE_LINE_SIZE];
+  unsigned int m_head;
+  char m_pad2[CACHE_LINE_SIZE];
+  unsigned int m_tail;
+  char m_pad3[CACHE_LINE_SIZE];
+
+  static unsigned int RoundUp(unsigned int capacity) {
+    unsigned int size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    return size;
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(MPSCQueue);
+};
+}  // namespace thread
+}  // namespace ola
+#endif  // INCLUDE_OLA_THREAD_MPSCQUEUE_H_
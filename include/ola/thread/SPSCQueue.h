@@ -0,0 +1,144 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ * SPSCQueue.h
+ * A bounded, lock free, single producer single consumer queue.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLA_THREAD_SPSCQUEUE_H_
+#define INCLUDE_OLA_THREAD_SPSCQUEUE_H_
+
+#include <ola/base/Macro.h>
+#include <vector>
+
+namespace ola {
+namespace thread {
+
+/**
+ * @brief A bounded, lock free queue between two threads.
+ *
+ * Exactly one thread may call Push() and exactly one (other) thread may call
+ * Pop(). Neither call blocks, Push() returns false if the queue is full and
+ * Pop() returns false if it's empty. It's up to the caller to arrange for the
+ * consumer to be woken up, usually with SelectServer::Execute().
+ *
+ * The queue is intended for small items, like pointers, since items are
+ * copied in & out.
+ *
+ * @examplepara
+ *   @code
+ *   SPSCQueue<Message*> queue(1024);
+ *   // producer thread
+ *   if (!queue.Push(message)) {
+ *     // full, try again later
+ *   }
+ *   // consumer thread
+ *   Message *message;
+ *   while (queue.Pop(&message)) {
+ *     Handle(message);
+ *   }
+ *   @endcode
+ */
+template <typename T>
+class SPSCQueue {
+ public:
+  /**
+   * @brief Create a new queue.
+   * @param capacity the maximum number of items in the queue, this is rounded
+   *   up to a power of two.
+   */
+  explicit SPSCQueue(unsigned int capacity)
+      : m_mask(RoundUp(capacity) - 1),
+        m_items(m_mask + 1),
+        m_head(0),
+        m_tail(0) {
+  }
+
+  /**
+   * @brief Add an item to the back of the queue, called by the producer.
+   * @param item the item to add.
+   * @returns true if the item was added, false if the queue was full.
+   */
+  bool Push(const T &item) {
+    const unsigned int tail = m_tail;
+    if (tail - m_head > m_mask) {
+      return false;
+    }
+    m_items[tail & m_mask] = item;
+    // The item must be visible before the consumer sees the new tail.
+    __sync_synchronize();
+    m_tail = tail + 1;
+    return true;
+  }
+
+  /**
+   * @brief Remove the item at the front of the queue, called by the consumer.
+   * @param[out] item the item removed.
+   * @returns true if an item was removed, false if the queue was empty.
+   */
+  bool Pop(T *item) {
+    const unsigned int head = m_head;
+    if (head == m_tail) {
+      return false;
+    }
+    // Don't read the item until we've seen the tail that covers it.
+    __sync_synchronize();
+    *item = m_items[head & m_mask];
+    // And make sure we're done with it before the producer can reuse the slot.
+    __sync_synchronize();
+    m_head = head + 1;
+    return true;
+  }
+
+  /**
+   * @brief Check if the queue is empty.
+   *
+   * This is only a hint if called from the producer thread.
+   */
+  bool Empty() const { return m_head == m_tail; }
+
+  /**
+   * @brief The maximum number of items the queue can hold.
+   */
+  unsigned int Capacity() const { return m_mask + 1; }
+
+ private:
+  static const unsigned int CACHE_LINE_SIZE = 64;
+
+  const unsigned int m_mask;
+  std::vector<T> m_items;
+  // The counters only ever increase, and wrap around. The head is written by
+  // the consumer and the tail by the producer, so we keep them on separate
+  // cache lines.
+  char m_pad1[CACHE_LINE_SIZE];
+  volatile unsigned int m_head;
+  char m_pad2[CACHE_LINE_SIZE];
+  volatile unsigned int m_tail;
+  char m_pad3[CACHE_LINE_SIZE];
+
+  static unsigned int RoundUp(unsigned int capacity) {
+    unsigned int size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    return size;
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(SPSCQueue);
+};
+}  // namespace thread
+}  // namespace ola
+#endif  // INCLUDE_OLA_THREAD_SPSCQUEUE_H_
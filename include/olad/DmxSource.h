@@ -49,8 +49,19 @@ class DmxSource {
         m_priority(priority) {
     }
 
+    DmxSource(const DmxBuffer &buffer,
+              const DmxBuffer &slot_priorities,
+              const TimeStamp &timestamp,
+              uint8_t priority):
+        m_buffer(buffer),
+        m_slot_priorities(slot_priorities),
+        m_timestamp(timestamp),
+        m_priority(priority) {
+    }
+
     DmxSource(const DmxSource &other) {
       m_buffer = other.m_buffer;
+      m_slot_priorities = other.m_slot_priorities;
       m_timestamp = other.m_timestamp;
       m_priority = other.m_priority;
     }
@@ -62,6 +73,7 @@ class DmxSource {
     DmxSource& operator=(const DmxSource& other) {
       if (this != &other) {
         m_buffer = other.m_buffer;
+        m_slot_priorities = other.m_slot_priorities;
         m_timestamp = other.m_timestamp;
         m_priority = other.m_priority;
       }
@@ -73,6 +85,7 @@ class DmxSource {
      */
     bool operator==(const DmxSource &other) const {
       return (m_buffer == other.m_buffer &&
+              m_slot_priorities == other.m_slot_priorities &&
               m_timestamp == other.m_timestamp &&
               m_priority == other.m_priority);
     }
@@ -84,6 +97,19 @@ class DmxSource {
     void UpdateData(const DmxBuffer &buffer, const TimeStamp &timestamp,
                     uint8_t priority) {
       m_buffer = buffer;
+      m_slot_priorities.Reset();
+      m_timestamp = timestamp;
+      m_priority = priority;
+    }
+
+
+    /*
+     * Update the DmxSource with new data and per-slot priorities
+     */
+    void UpdateData(const DmxBuffer &buffer, const DmxBuffer &slot_priorities,
+                    const TimeStamp &timestamp, uint8_t priority) {
+      m_buffer = buffer;
+      m_slot_priorities = slot_priorities;
       m_timestamp = timestamp;
       m_priority = priority;
     }
@@ -95,6 +121,20 @@ class DmxSource {
     const DmxBuffer &Data() const { return m_buffer; }
 
 
+    /*
+     * Get the per-slot priorities for this source. A slot priority of 0 means
+     * the source isn't sending that slot. This is empty if the source only
+     * has a single priority.
+     */
+    const DmxBuffer &SlotPriorities() const { return m_slot_priorities; }
+
+
+    /*
+     * Check if this source has per-slot priorities
+     */
+    bool HasSlotPriorities() const { return m_slot_priorities.Size() != 0; }
+
+
     /*
      * Get the timestamp
      */
@@ -125,6 +165,7 @@ class DmxSource {
 
  private:
     DmxBuffer m_buffer;
+    DmxBuffer m_slot_priorities;
     TimeStamp m_timestamp;
     uint8_t m_priority;
 
@@ -1,6 +1,7 @@
 oladinclude_HEADERS = \
     include/olad/Device.h \
     include/olad/DmxSource.h \
+    include/olad/OutputSyncGroup.h \
     include/olad/Plugin.h \
     include/olad/PluginAdaptor.h \
     include/olad/Port.h \
@@ -0,0 +1,165 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * OutputSyncGroup.h
+ * Sends the frames for a group of output ports together, followed by a sync
+ * message.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef INCLUDE_OLAD_OUTPUTSYNCGROUP_H_
+#define INCLUDE_OLAD_OUTPUTSYNCGROUP_H_
+
+#include <ola/Callback.h>
+#include <ola/DmxBuffer.h>
+#include <ola/base/Macro.h>
+#include <ola/thread/SchedulerInterface.h>
+#include <stdint.h>
+#include <map>
+#include <memory>
+
+namespace ola {
+
+class OutputPort;
+
+/**
+ * @brief Sends the frames for a group of output ports together, followed by
+ * a single sync message.
+ *
+ * Protocols like E1.31 and Art-Net let receivers hold the data for each
+ * universe until a sync message arrives, so fixtures spanning several
+ * universes update at the same time. The ports in a group pass their frames
+ * to WriteDMX(), which holds them. The held frames are sent back-to-back,
+ * followed by the sync message, once:
+ *  - every active port in the group has a frame waiting,
+ *  - a port with a frame waiting is written to again, which means the source
+ *    has moved on to the next frame, or
+ *  - max_wait_ms has passed since the first frame was held.
+ *
+ * A port is active if it had a frame in the last group that was sent, or has
+ * been written to since. Ports start out active. This means a universe that
+ * stops updating delays at most one frame of the others, rather than every
+ * frame.
+ */
+class OutputSyncGroup {
+ public:
+  /**
+   * @brief Sends a frame for a port.
+   */
+  typedef Callback2<bool, const DmxBuffer&, uint8_t> SendCallback;
+
+  /**
+   * @brief Sends the sync message.
+   */
+  typedef Callback0<void> SyncCallback;
+
+  /**
+   * @brief Create a new OutputSyncGroup.
+   * @param scheduler the scheduler used to send frames that have been held
+   *   for max_wait_ms.
+   * @param max_wait_ms the longest a frame is held for.
+   * @param sync_callback the callback run after each group of frames is sent,
+   *   ownership is transferred.
+   */
+  OutputSyncGroup(ola::thread::SchedulerInterface *scheduler,
+                  unsigned int max_wait_ms,
+                  SyncCallback *sync_callback);
+
+  /**
+   * @brief Destructor.
+   *
+   * Held frames are discarded.
+   */
+  ~OutputSyncGroup();
+
+  /**
+   * @brief Add a port to the group.
+   * @param port the port to add.
+   * @param send_callback the callback used to send the port's frames,
+   *   ownership is transferred.
+   */
+  void AddPort(const OutputPort *port, SendCallback *send_callback);
+
+  /**
+   * @brief Remove a port from the group.
+   *
+   * Any frame held for the port is discarded.
+   */
+  void RemovePort(const OutputPort *port);
+
+  /**
+   * @brief Hold a frame for a port until the group is sent.
+   * @param port the port the frame is for.
+   * @param buffer the DMX data.
+   * @param priority the priority of the data.
+   * @return false if the port isn't in the group.
+   */
+  bool WriteDMX(const OutputPort *port, const DmxBuffer &buffer,
+                uint8_t priority);
+
+  /**
+   * @brief Send the held frames, followed by the sync message.
+   *
+   * Nothing is sent if there aren't any frames held.
+   */
+  void Flush();
+
+  /**
+   * @brief The number of ports in the group.
+   */
+  unsigned int PortCount() const { return m_ports.size(); }
+
+  /**
+   * @brief The number of ports with a frame waiting to be sent.
+   */
+  unsigned int HeldCount() const { return m_held_count; }
+
+  /**
+   * @brief The number of ports the group waits for before sending.
+   */
+  unsigned int ActiveCount() const { return m_active_count; }
+
+ private:
+  struct PortState {
+    explicit PortState(SendCallback *callback)
+        : send_callback(callback),
+          priority(0),
+          held(false),
+          active(true) {
+    }
+
+    std::auto_ptr<SendCallback> send_callback;
+    DmxBuffer buffer;
+    uint8_t priority;
+    bool held;
+    bool active;
+  };
+
+  typedef std::map<const OutputPort*, PortState*> PortMap;
+
+  ola::thread::SchedulerInterface *m_scheduler;
+  const unsigned int m_max_wait_ms;
+  std::auto_ptr<SyncCallback> m_sync_callback;
+  PortMap m_ports;
+  unsigned int m_held_count;
+  unsigned int m_active_count;
+  ola::thread::timeout_id m_timeout;
+
+  void CancelTimeout();
+
+  DISALLOW_COPY_AND_ASSIGN(OutputSyncGroup);
+};
+}  // namespace ola
+#endif  // INCLUDE_OLAD_OUTPUTSYNCGROUP_H_
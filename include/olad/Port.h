@@ -25,6 +25,7 @@
 #include <ola/base/Macro.h>
 #include <ola/rdm/RDMCommand.h>
 #include <ola/rdm/RDMControllerInterface.h>
+#include <ola/rdm/UIDSet.h>
 #include <ola/timecode/TimeCode.h>
 #include <olad/DmxSource.h>
 #include <olad/PluginAdaptor.h>
@@ -186,6 +187,16 @@ class OutputPort: public Port, ola::rdm::DiscoverableRDMControllerInterface {
   virtual void RunIncrementalDiscovery(
       ola::rdm::RDMDiscoveryCallback *on_complete) = 0;
 
+  /**
+   * @brief Set the UIDs that were present on this port when it was last used.
+   * @param uids the saved UIDs
+   *
+   * This is called before the port is patched. Ports that run discovery
+   * themselves can use this to verify the known devices rather than searching
+   * for them.
+   */
+  virtual void SetKnownUIDs(const ola::rdm::UIDSet &uids) = 0;
+
   // timecode support
   virtual bool SupportsTimeCode() const = 0;
   virtual bool SendTimeCode(const ola::timecode::TimeCode &timecode) = 0;
@@ -250,6 +261,9 @@ class BasicInputPort: public InputPort {
     return ola::dmx::SOURCE_PRIORITY_MIN;
   }
 
+  // Get the inherited per-slot priorities, or NULL if there aren't any
+  virtual const DmxBuffer *InheritedSlotPriorities() const { return NULL; }
+
   // override this to cancel the SetUniverse operation.
   virtual bool PreSetUniverse(Universe *, Universe *) { return true; }
 
@@ -324,6 +338,11 @@ class BasicOutputPort: public OutputPort {
   virtual void RunIncrementalDiscovery(
       ola::rdm::RDMDiscoveryCallback *on_complete);
 
+  /**
+   * @brief This is a noop for ports that don't run discovery themselves
+   */
+  virtual void SetKnownUIDs(const ola::rdm::UIDSet &) {}
+
   // TimeCode
   virtual bool SupportsTimeCode() const { return false; }
 
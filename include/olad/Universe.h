@@ -22,6 +22,7 @@
 #define INCLUDE_OLAD_UNIVERSE_H_
 
 #include <ola/Clock.h>
+#include <ola/Constants.h>
 #include <ola/DmxBuffer.h>
 #include <ola/ExportMap.h>
 #include <ola/base/Macro.h>
@@ -29,8 +30,10 @@
 #include <ola/rdm/RDMControllerInterface.h>
 #include <ola/rdm/UID.h>
 #include <ola/rdm/UIDSet.h>
+#include <ola/thread/SchedulerInterface.h>
 #include <olad/DmxSource.h>
 
+#include <memory>
 #include <set>
 #include <map>
 #include <vector>
@@ -40,7 +43,12 @@ namespace ola {
 
 class Client;
 class InputPort;
+class OutputPacer;
 class OutputPort;
+class RDMResponseCache;
+class RDMScheduler;
+struct OutputPacerOptions;
+struct RDMSchedulerOptions;
 
 class Universe: public ola::rdm::RDMControllerInterface {
  public:
@@ -88,6 +96,23 @@ class Universe: public ola::rdm::RDMControllerInterface {
       m_rdm_discovery_interval = discovery_interval;
     }
 
+    /**
+     * @brief Set how RDM requests are scheduled on the output ports.
+     * @param scheduler the scheduler used to pace RDM requests, may be NULL.
+     * @param options the RDMSchedulerOptions.
+     */
+    void SetRDMSchedulerOptions(ola::thread::SchedulerInterface *scheduler,
+                                const RDMSchedulerOptions &options);
+
+    /**
+     * @brief Set how DMX frames are paced on the output ports.
+     * @param scheduler the scheduler used to write held and keepalive frames,
+     *   may be NULL.
+     * @param options the OutputPacerOptions.
+     */
+    void SetOutputPacerOptions(ola::thread::SchedulerInterface *scheduler,
+                               const OutputPacerOptions &options);
+
     // Each universe has a DMXBuffer
     bool SetDMX(const DmxBuffer &buffer);
     const DmxBuffer &GetDMX() const { return m_buffer; }
@@ -131,6 +156,7 @@ class Universe: public ola::rdm::RDMControllerInterface {
                          bool full = true);
     void NewUIDList(OutputPort *port, const ola::rdm::UIDSet &uids);
     void GetUIDs(ola::rdm::UIDSet *uids) const;
+    void GetUIDs(const OutputPort *port, ola::rdm::UIDSet *uids) const;
     unsigned int UIDCount() const;
 
     bool operator==(const Universe &other) {
@@ -144,6 +170,10 @@ class Universe: public ola::rdm::RDMControllerInterface {
     static const char K_UNIVERSE_MODE_VAR[];
     static const char K_UNIVERSE_NAME_VAR[];
     static const char K_UNIVERSE_OUTPUT_PORT_VAR[];
+    static const char K_UNIVERSE_RDM_CACHE_HITS[];
+    static const char K_UNIVERSE_RDM_CACHE_MISSES[];
+    static const char K_UNIVERSE_RDM_DISCOVERIES[];
+    static const char K_UNIVERSE_RDM_DISCOVERY_TIME_VAR[];
     static const char K_UNIVERSE_RDM_REQUESTS[];
     static const char K_UNIVERSE_SINK_CLIENTS_VAR[];
     static const char K_UNIVERSE_SOURCE_CLIENTS_VAR[];
@@ -158,6 +188,14 @@ class Universe: public ola::rdm::RDMControllerInterface {
       std::vector<rdm::RDMFrame> frames;
     } broadcast_request_tracker;
 
+    // A source's data and priorities as of the last per-slot priority merge
+    typedef struct {
+      const DmxSource *source;
+      DmxBuffer data;
+      DmxBuffer slot_priorities;
+      uint8_t priority;
+    } slot_merge_source;
+
     typedef std::map<Client*, bool> SourceClientMap;
 
     std::string m_universe_name;
@@ -177,26 +215,77 @@ class Universe: public ola::rdm::RDMControllerInterface {
     DmxBuffer m_buffer;
     ExportMap *m_export_map;
     std::map<ola::rdm::UID, OutputPort*> m_output_uids;
+    std::auto_ptr<RDMResponseCache> m_rdm_cache;
+    RDMScheduler *m_rdm_scheduler;
+    OutputPacer *m_output_pacer;
     Clock *m_clock;
     TimeInterval m_rdm_discovery_interval;
     TimeStamp m_last_discovery_time;
+    /**
+     * The sources at m_active_priority. This is updated incrementally as
+     * sources change, and rebuilt from the ports & clients when stale.
+     */
+    std::vector<const DmxSource*> m_active_sources;
+    bool m_active_sources_stale;
+    // true if the last merge used per-slot priorities
+    bool m_slot_priority_merge;
+    // true if the sources have changed since the last per-slot priority merge
+    bool m_slot_merge_stale;
+    // The sources in the last per-slot priority merge
+    std::vector<slot_merge_source> m_slot_merge_sources;
+    // The merged data and the winning priority of each slot
+    uint8_t m_slot_merge_data[DMX_UNIVERSE_SIZE];
+    uint8_t m_slot_merge_priorities[DMX_UNIVERSE_SIZE];
+    unsigned int m_slot_merge_length;
+    // Scratch space for SlotPriorityMergeSources
+    std::vector<const DmxSource*> m_slot_merge_candidates;
+    // Scratch space for HTPMergeSources, kept to avoid allocating each merge
+    std::vector<const DmxBuffer*> m_merge_buffers;
+    // Handles to this universe's entries in the ExportMap, these do nothing if
+    // there isn't an ExportMap.
+    Counter m_frames_var;
+    Counter m_rdm_requests_var;
+    Counter m_rdm_cache_hits_var;
+    Counter m_rdm_cache_misses_var;
+    Counter m_rdm_discoveries_var;
+    Gauge m_input_ports_var;
+    Gauge m_output_ports_var;
+    Gauge m_sink_clients_var;
+    Gauge m_source_clients_var;
+    Gauge m_rdm_discovery_time_var;
+    Gauge m_uid_count_var;
 
     void HandleBroadcastAck(broadcast_request_tracker *tracker,
                             ola::rdm::RDMReply *reply);
     void HandleBroadcastDiscovery(broadcast_request_tracker *tracker,
                                   ola::rdm::RDMReply *reply);
+    void HandleRDMReply(ola::rdm::RDMRequest *request,
+                        ola::rdm::RDMCallback *callback,
+                        ola::rdm::RDMReply *reply);
+    void UIDsChanged();
     bool UpdateDependants();
     void UpdateName();
     void UpdateMode();
-    void HTPMergeSources(const std::vector<DmxSource> &sources);
+    void HTPMergeSources();
     bool MergeAll(const InputPort *port, const Client *client);
+    bool UpdateActiveSources(const DmxSource *changed_source,
+                             const TimeStamp &now);
+    void RebuildActiveSources(const TimeStamp &now);
+    void ConsiderSource(const DmxSource *source, const TimeStamp &now);
+    bool SlotPriorityMergeSources(const TimeStamp &now, bool *changed);
+    bool UpdateSlotPriorityMerge(const DmxSource &changed_source,
+                                 const TimeStamp &now,
+                                 bool *changed);
     void PortDiscoveryComplete(BaseCallback0<void> *on_complete,
                                OutputPort *output_port,
                                const ola::rdm::UIDSet &uids);
     void DiscoveryComplete(ola::rdm::RDMDiscoveryCallback *on_complete);
 
-    void SafeIncrement(const std::string &name);
-    void SafeDecrement(const std::string &name);
+    static bool IsMergeable(const DmxSource &source, const TimeStamp &now);
+    static bool IsOlderSource(const DmxSource *source1,
+                              const DmxSource *source2);
+    static unsigned int SlotMergeLength(const DmxSource &source);
+    static uint8_t SlotPriority(const DmxSource &source, unsigned int slot);
 
     template<class PortClass>
     bool GenericAddPort(PortClass *port,
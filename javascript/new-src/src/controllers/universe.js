@@ -24,19 +24,63 @@ ola.controller('universeCtrl',
       'use strict';
       $scope.dmx = [];
       $scope.Universe = $routeParams.id;
+      var interval;
+      var source;
 
-      var interval = $interval(function() {
-        $ola.get.Dmx($scope.Universe).then(function(data) {
-          for (var i = 0; i < OLA.MAX_CHANNEL_NUMBER; i++) {
-            $scope.dmx[i] =
-              (typeof data.dmx[i] === 'number') ?
-                data.dmx[i] : OLA.MIN_CHANNEL_VALUE;
+      for (var i = 0; i < OLA.MAX_CHANNEL_NUMBER; i++) {
+        $scope.dmx[i] = OLA.MIN_CHANNEL_VALUE;
+      }
+
+      var poll = function() {
+        interval = $interval(function() {
+          $ola.get.Dmx($scope.Universe).then(function(data) {
+            for (var i = 0; i < OLA.MAX_CHANNEL_NUMBER; i++) {
+              $scope.dmx[i] =
+                (typeof data.dmx[i] === 'number') ?
+                  data.dmx[i] : OLA.MIN_CHANNEL_VALUE;
+            }
+          });
+        }, 100);
+      };
+
+      var applyChanges = function(data) {
+        for (var i = data.length; i < OLA.MAX_CHANNEL_NUMBER; i++) {
+          $scope.dmx[i] = OLA.MIN_CHANNEL_VALUE;
+        }
+        data.changes.forEach(function(change) {
+          for (var j = 0; j < change[1].length; j++) {
+            $scope.dmx[change[0] + j] = change[1][j];
           }
         });
-      }, 100);
+      };
+
+      if ('EventSource' in window) {
+        // The server pushes the slots that changed.
+        source = new EventSource('/stream_dmx?u=' + $scope.Universe);
+        source.addEventListener('dmx', function(event) {
+          var data = JSON.parse(event.data);
+          $scope.$apply(function() {
+            applyChanges(data);
+          });
+        });
+        source.onerror = function() {
+          if (source.readyState === EventSource.CLOSED) {
+            // Older servers don't support streaming.
+            source = undefined;
+            poll();
+          }
+        };
+      } else {
+        poll();
+      }
 
       $scope.$on('$destroy', function() {
-        $interval.cancel(interval);
+        if (source) {
+          source.close();
+        }
+        if (interval) {
+          $interval.cancel(interval);
+        }
       });
 
       $scope.getColor = function(i) {
@@ -18,11 +18,14 @@
  * Copyright (C) 2007 Simon Newton
  */
 
+#include <string.h>
 #include <sys/time.h>
 #include <algorithm>
 #include <map>
 #include <memory>
 #include <vector>
+#include "common/dmx/PriorityMerge.h"
+#include "ola/Constants.h"
 #include "ola/Logging.h"
 #include "libs/acn/DMPE131Inflator.h"
 #include "libs/acn/DMPHeader.h"
@@ -74,6 +77,12 @@ bool DMPE131Inflator::HandlePDUData(uint32_t vector,
   if (universe_iter == m_handlers.end())
     return true;
 
+  uint16_t sync_address = e131_header.SyncAddress();
+  if (sync_address && m_sync_addresses.insert(sync_address).second &&
+      m_sync_address_callback.get()) {
+    m_sync_address_callback->Run(sync_address);
+  }
+
   DMPHeader dmp_header = headers.GetDMPHeader();
 
   if (!dmp_header.IsVirtual() || dmp_header.IsRelative() ||
@@ -115,32 +124,45 @@ bool DMPE131Inflator::HandlePDUData(uint32_t vector,
   else if (length_remaining && address->Number())
     start_code = *(data + available_length);
 
+  // Per-slot priority data is only used if the handler asked for it.
+  bool slot_priority_data = (!e131_header.UsingRev2() &&
+                             start_code == ola::SLOT_PRIORITY_START_CODE &&
+                             universe_iter->second.slot_priorities);
+
   // The only time we want to continue processing a non-0 start code is if it
-  // contains a Terminate message.
-  if (start_code && !e131_header.StreamTerminated()) {
+  // contains a Terminate message or per-slot priorities.
+  if (start_code && !slot_priority_data && !e131_header.StreamTerminated()) {
     OLA_INFO << "Skipping packet with non-0 start code: " << start_code;
     return true;
   }
 
-  DmxBuffer *target_buffer;
-  if (!TrackSourceIfRequired(&universe_iter->second, headers,
-                             &target_buffer)) {
+  dmx_source *source;
+  if (!TrackSourceIfRequired(&universe_iter->second, headers, &source)) {
     // no need to continue processing
     return true;
   }
 
   // Reaching here means that we actually have new data and we should merge.
-  if (target_buffer && start_code == 0) {
+  if (source && (start_code == 0 || slot_priority_data)) {
     unsigned int channels = std::min(length_remaining, address->Number());
-    if (e131_header.UsingRev2())
-      target_buffer->Set(data + available_length, channels);
-    else
-     target_buffer->Set(data + available_length + 1, channels - 1);
+    if (e131_header.UsingRev2()) {
+      source->buffer.Set(data + available_length, channels);
+    } else if (slot_priority_data) {
+      source->slot_priorities.Set(data + available_length + 1, channels - 1);
+      source->slot_priorities_heard_from = source->last_heard_from;
+    } else {
+      source->buffer.Set(data + available_length + 1, channels - 1);
+    }
   }
 
   if (universe_iter->second.priority)
     *universe_iter->second.priority = universe_iter->second.active_priority;
 
+  if (SlotPriorityMerge(&universe_iter->second)) {
+    RunHandler(&universe_iter->second, sync_address);
+    return true;
+  }
+
   // merge the sources
   switch (universe_iter->second.sources.size()) {
     case 0:
@@ -149,7 +171,7 @@ bool DMPE131Inflator::HandlePDUData(uint32_t vector,
     case 1:
       universe_iter->second.buffer->Set(
           universe_iter->second.sources[0].buffer);
-      universe_iter->second.closure->Run();
+      RunHandler(&universe_iter->second, sync_address);
       break;
     default:
       // HTP Merge
@@ -158,12 +180,40 @@ bool DMPE131Inflator::HandlePDUData(uint32_t vector,
         universe_iter->second.sources.begin();
       for (; source_iter != universe_iter->second.sources.end(); ++source_iter)
         universe_iter->second.buffer->HTPMerge(source_iter->buffer);
-      universe_iter->second.closure->Run();
+      RunHandler(&universe_iter->second, sync_address);
   }
   return true;
 }
 
 
+/*
+ * Run the handlers holding data for a sync address.
+ * @param sync_address the sync address from the synchronization packet.
+ */
+void DMPE131Inflator::HandleSync(uint16_t sync_address) {
+  m_clock.CurrentTime(&m_last_sync[sync_address]);
+
+  // The handlers may change the set of handlers, so take a copy first.
+  vector<uint16_t> universes;
+  UniverseHandlers::const_iterator iter = m_handlers.begin();
+  for (; iter != m_handlers.end(); ++iter) {
+    if (iter->second.sync_pending &&
+        iter->second.sync_address == sync_address) {
+      universes.push_back(iter->first);
+    }
+  }
+
+  vector<uint16_t>::const_iterator universe_iter = universes.begin();
+  for (; universe_iter != universes.end(); ++universe_iter) {
+    UniverseHandlers::iterator handler_iter = m_handlers.find(*universe_iter);
+    if (handler_iter != m_handlers.end() && handler_iter->second.sync_pending) {
+      handler_iter->second.sync_pending = false;
+      handler_iter->second.closure->Run();
+    }
+  }
+}
+
+
 /*
  * Set the closure to be called when we receive data for this universe.
  * @param universe the universe to register the handler for
@@ -175,6 +225,25 @@ bool DMPE131Inflator::SetHandler(uint16_t universe,
                                  ola::DmxBuffer *buffer,
                                  uint8_t *priority,
                                  ola::Callback0<void> *closure) {
+  return SetHandler(universe, buffer, NULL, priority, closure);
+}
+
+
+/*
+ * Set the closure to be called when we receive data for this universe, and
+ * accept per-slot priorities (start code 0xdd) from sources.
+ * @param universe the universe to register the handler for
+ * @param buffer the DmxBuffer to update with the data
+ * @param slot_priorities the DmxBuffer to update with the per-slot
+ *   priorities. This is empty if none of the sources are sending them.
+ * @param handler the Callback0 to call when there is data for this universe.
+ * Ownership of the closure is transferred to the node.
+ */
+bool DMPE131Inflator::SetHandler(uint16_t universe,
+                                 ola::DmxBuffer *buffer,
+                                 ola::DmxBuffer *slot_priorities,
+                                 uint8_t *priority,
+                                 ola::Callback0<void> *closure) {
   if (!closure || !buffer)
     return false;
 
@@ -186,12 +255,16 @@ bool DMPE131Inflator::SetHandler(uint16_t universe,
     handler.closure = closure;
     handler.active_priority = 0;
     handler.priority = priority;
+    handler.slot_priorities = slot_priorities;
+    handler.sync_address = 0;
+    handler.sync_pending = false;
     m_handlers[universe] = handler;
   } else {
     Callback0<void> *old_closure = iter->second.closure;
     iter->second.closure = closure;
     iter->second.buffer = buffer;
     iter->second.priority = priority;
+    iter->second.slot_priorities = slot_priorities;
     delete old_closure;
   }
   return true;
@@ -236,16 +309,16 @@ void DMPE131Inflator::RegisteredUniverses(vector<uint16_t> *universes) {
  * priority.
  * @param universe_data the universe_handler struct for this universe,
  * @param HeaderSet the set of headers in this packet
- * @param buffer, if set to a non-NULL pointer, the caller should copy the data
- * in the buffer.
+ * @param source, if set to a non-NULL pointer, the caller should copy the data
+ * in to the source.
  * @returns true if we should remerge the data, false otherwise.
  */
 bool DMPE131Inflator::TrackSourceIfRequired(
     universe_handler *universe_data,
     const HeaderSet &headers,
-    DmxBuffer **buffer) {
+    dmx_source **source) {
 
-  *buffer = NULL;  // default the buffer to NULL
+  *source = NULL;  // default the source to NULL
   ola::TimeStamp now;
   m_clock.CurrentTime(&now);
   const E131Header &e131_header = headers.GetE131Header();
@@ -302,7 +375,7 @@ bool DMPE131Inflator::TrackSourceIfRequired(
       new_source.sequence = e131_header.Sequence();
       new_source.last_heard_from = now;
       iter = sources.insert(sources.end(), new_source);
-      *buffer = &iter->buffer;
+      *source = &*iter;
       return true;
     }
 
@@ -347,9 +420,103 @@ bool DMPE131Inflator::TrackSourceIfRequired(
         iter = sources.insert(sources.end(), this_source);
       }
     }
-    *buffer = &iter->buffer;
+    *source = &*iter;
     return true;
   }
 }
+
+
+/*
+ * If any of the sources have sent per-slot priorities, merge the sources slot
+ * by slot. Sources without per-slot priorities use the active priority for
+ * all slots.
+ * @param universe_data the universe_handler struct for this universe,
+ * @returns true if the sources were merged, false if no source has per-slot
+ *   priorities and the caller should do a normal merge.
+ */
+bool DMPE131Inflator::SlotPriorityMerge(universe_handler *universe_data) {
+  if (!universe_data->slot_priorities) {
+    return false;
+  }
+
+  ola::TimeStamp now;
+  m_clock.CurrentTime(&now);
+  bool has_slot_priorities = false;
+  vector<dmx_source> &sources = universe_data->sources;
+  vector<dmx_source>::iterator iter = sources.begin();
+  for (; iter != sources.end(); ++iter) {
+    // Sources that stop sending per-slot priorities revert to the universe
+    // priority.
+    if (iter->slot_priorities.Size() &&
+        now > iter->slot_priorities_heard_from + EXPIRY_INTERVAL) {
+      OLA_INFO << "Per-slot priorities from " << iter->cid.ToString()
+               << " have expired";
+      iter->slot_priorities.Reset();
+    }
+    has_slot_priorities |= iter->slot_priorities.Size() != 0;
+  }
+
+  if (!has_slot_priorities) {
+    universe_data->slot_priorities->Reset();
+    return false;
+  }
+
+  ola::dmx::PriorityMergeFunction merge =
+      ola::dmx::GetPriorityMergeFunction(ola::dmx::PRIORITY_TIE_HTP);
+  uint8_t data[DMX_UNIVERSE_SIZE];
+  uint8_t priorities[DMX_UNIVERSE_SIZE];
+  uint8_t source_priorities[DMX_UNIVERSE_SIZE];
+  memset(data, 0, sizeof(data));
+  memset(priorities, 0, sizeof(priorities));
+  unsigned int length = 0;
+
+  for (iter = sources.begin(); iter != sources.end(); ++iter) {
+    unsigned int source_length = iter->buffer.Size();
+    const uint8_t *slot_priorities = source_priorities;
+    if (iter->slot_priorities.Size()) {
+      source_length = std::min(source_length, iter->slot_priorities.Size());
+      slot_priorities = iter->slot_priorities.GetRaw();
+    } else {
+      // A slot priority of 0 means the slot isn't sourced.
+      memset(source_priorities,
+             std::max(universe_data->active_priority,
+                      static_cast<uint8_t>(1)),
+             source_length);
+    }
+    if (source_length) {
+      merge(data, priorities, iter->buffer.GetRaw(), slot_priorities,
+            source_length);
+    }
+    length = std::max(length, source_length);
+  }
+
+  universe_data->buffer->Set(data, length);
+  universe_data->slot_priorities->Set(priorities, length);
+  return true;
+}
+
+
+/*
+ * Run the handler for a universe, or if the data is synchronized, hold it
+ * until the sync packet arrives.
+ * @param universe_data the universe_handler struct for this universe.
+ * @param sync_address the sync address from the data packet, may be 0.
+ */
+void DMPE131Inflator::RunHandler(universe_handler *universe_data,
+                                 uint16_t sync_address) {
+  if (sync_address) {
+    std::map<uint16_t, TimeStamp>::const_iterator iter =
+        m_last_sync.find(sync_address);
+    TimeStamp now;
+    m_clock.CurrentTime(&now);
+    if (iter != m_last_sync.end() && now < iter->second + EXPIRY_INTERVAL) {
+      universe_data->sync_address = sync_address;
+      universe_data->sync_pending = true;
+      return;
+    }
+  }
+  universe_data->sync_pending = false;
+  universe_data->closure->Run();
+}
 }  // namespace acn
 }  // namespace ola
@@ -23,6 +23,8 @@
 #define LIBS_ACN_DMPE131INFLATOR_H_
 
 #include <map>
+#include <memory>
+#include <set>
 #include <vector>
 #include "ola/Clock.h"
 #include "ola/Callback.h"
@@ -44,10 +46,32 @@ class DMPE131Inflator: public DMPInflator {
 
     bool SetHandler(uint16_t universe, ola::DmxBuffer *buffer,
                     uint8_t *priority, ola::Callback0<void> *handler);
+    bool SetHandler(uint16_t universe, ola::DmxBuffer *buffer,
+                    ola::DmxBuffer *slot_priorities, uint8_t *priority,
+                    ola::Callback0<void> *handler);
     bool RemoveHandler(uint16_t universe);
 
     void RegisteredUniverses(std::vector<uint16_t> *universes);
 
+    /*
+     * Run the handlers for the universes holding synchronized data for this
+     * sync address.
+     *
+     * Data with a sync address is merged into the handler's buffer as it
+     * arrives, but the handler isn't run until the sync packet arrives. If no
+     * sync packet has been received for the sync address within the last
+     * 2.5s, the handler is run straight away.
+     */
+    void HandleSync(uint16_t sync_address);
+
+    /*
+     * Set the callback run the first time data for one of our universes
+     * refers to a sync address. Ownership is transferred.
+     */
+    void SetSyncAddressHandler(ola::Callback1<void, uint16_t> *callback) {
+      m_sync_address_callback.reset(callback);
+    }
+
  protected:
     virtual bool HandlePDUData(uint32_t vector,
                                const HeaderSet &headers,
@@ -60,6 +84,9 @@ class DMPE131Inflator: public DMPInflator {
       uint8_t sequence;
       TimeStamp last_heard_from;
       DmxBuffer buffer;
+      // The per-slot priorities from the last 0xdd packet, if any.
+      DmxBuffer slot_priorities;
+      TimeStamp slot_priorities_heard_from;
     } dmx_source;
 
     typedef struct {
@@ -67,7 +94,10 @@ class DMPE131Inflator: public DMPInflator {
       Callback0<void> *closure;
       uint8_t active_priority;
       uint8_t *priority;
+      DmxBuffer *slot_priorities;
       std::vector<dmx_source> sources;
+      uint16_t sync_address;
+      bool sync_pending;
     } universe_handler;
 
     typedef std::map<uint16_t, universe_handler> UniverseHandlers;
@@ -75,10 +105,15 @@ class DMPE131Inflator: public DMPInflator {
     UniverseHandlers m_handlers;
     bool m_ignore_preview;
     ola::Clock m_clock;
+    std::map<uint16_t, TimeStamp> m_last_sync;
+    std::set<uint16_t> m_sync_addresses;
+    std::auto_ptr<ola::Callback1<void, uint16_t> > m_sync_address_callback;
 
     bool TrackSourceIfRequired(universe_handler *universe_data,
                                const HeaderSet &headers,
-                               DmxBuffer **buffer);
+                               dmx_source **source);
+    bool SlotPriorityMerge(universe_handler *universe_data);
+    void RunHandler(universe_handler *universe_data, uint16_t sync_address);
 
     // The max number of sources we'll track per universe.
     static const uint8_t MAX_MERGE_SOURCES = 6;
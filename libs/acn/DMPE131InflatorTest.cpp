@@ -0,0 +1,176 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DMPE131InflatorTest.cpp
+ * Test fixture for the DMPE131Inflator class
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+#include <string>
+
+#include "ola/Callback.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/acn/ACNVectors.h"
+#include "ola/acn/CID.h"
+#include "libs/acn/DMPAddress.h"
+#include "libs/acn/DMPE131Inflator.h"
+#include "libs/acn/HeaderSet.h"
+#include "ola/testing/TestUtils.h"
+
+namespace ola {
+namespace acn {
+
+using ola::DmxBuffer;
+using std::string;
+
+class DMPE131InflatorTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(DMPE131InflatorTest);
+  CPPUNIT_TEST(testUnsynchronized);
+  CPPUNIT_TEST(testSynchronized);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    DMPE131InflatorTest()
+        : m_inflator(true),
+          m_cid(CID::Generate()),
+          m_priority(0),
+          m_handler_count(0),
+          m_sync_address(0) {
+    }
+
+    void setUp();
+
+    void testUnsynchronized();
+    void testSynchronized();
+
+ private:
+    DMPE131Inflator m_inflator;
+    CID m_cid;
+    DmxBuffer m_buffer;
+    uint8_t m_priority;
+    unsigned int m_handler_count;
+    uint16_t m_sync_address;
+
+    void SendData(uint8_t sequence, uint16_t sync_address,
+                  const string &data);
+    void DataReceived() { m_handler_count++; }
+    void SyncAddressSeen(uint16_t sync_address) {
+      m_sync_address = sync_address;
+    }
+
+    static const uint16_t UNIVERSE;
+    static const uint16_t SYNC_ADDRESS;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DMPE131InflatorTest);
+
+const uint16_t DMPE131InflatorTest::UNIVERSE = 1;
+const uint16_t DMPE131InflatorTest::SYNC_ADDRESS = 7000;
+
+
+void DMPE131InflatorTest::setUp() {
+  OLA_ASSERT(m_inflator.SetHandler(
+      UNIVERSE, &m_buffer, &m_priority,
+      NewCallback(this, &DMPE131InflatorTest::DataReceived)));
+  m_inflator.SetSyncAddressHandler(
+      NewCallback(this, &DMPE131InflatorTest::SyncAddressSeen));
+}
+
+
+/*
+ * Pass a data packet to the inflator.
+ */
+void DMPE131InflatorTest::SendData(uint8_t sequence, uint16_t sync_address,
+                                   const string &data) {
+  RootHeader root_header;
+  root_header.SetCid(m_cid);
+  E131Header e131_header("source", 100, sequence, UNIVERSE);
+  e131_header.SetSyncAddress(sync_address);
+
+  HeaderSet headers;
+  headers.SetRootHeader(root_header);
+  headers.SetE131Header(e131_header);
+  headers.SetDMPHeader(DMPHeader(true, false, RANGE_EQUAL, TWO_BYTES));
+
+  uint16_t slot_count = static_cast<uint16_t>(data.size() + 1);
+  TwoByteRangeDMPAddress address(0, 1, slot_count);
+  uint8_t pdu_data[DMX_UNIVERSE_SIZE + 7];
+  unsigned int length = sizeof(pdu_data);
+  OLA_ASSERT(address.Pack(pdu_data, &length));
+  pdu_data[length++] = 0;  // start code
+  memcpy(pdu_data + length, data.data(), data.size());
+  length += static_cast<unsigned int>(data.size());
+
+  OLA_ASSERT(m_inflator.HandlePDUData(DMP_SET_PROPERTY_VECTOR, headers,
+                                      pdu_data, length));
+}
+
+
+/*
+ * Check data without a sync address is passed on straight away.
+ */
+void DMPE131InflatorTest::testUnsynchronized() {
+  SendData(1, 0, "abc");
+  OLA_ASSERT_EQ(1u, m_handler_count);
+  OLA_ASSERT_EQ(string("abc"), m_buffer.Get());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(0), m_sync_address);
+
+  // A sync packet doesn't run the handler again.
+  m_inflator.HandleSync(SYNC_ADDRESS);
+  SendData(2, 0, "def");
+  OLA_ASSERT_EQ(2u, m_handler_count);
+  m_inflator.HandleSync(SYNC_ADDRESS);
+  OLA_ASSERT_EQ(2u, m_handler_count);
+}
+
+
+/*
+ * Check data with a sync address is held until the sync packet arrives.
+ */
+void DMPE131InflatorTest::testSynchronized() {
+  // Until a sync packet has been received, the data is passed on straight
+  // away.
+  SendData(1, SYNC_ADDRESS, "abc");
+  OLA_ASSERT_EQ(1u, m_handler_count);
+  OLA_ASSERT_EQ(SYNC_ADDRESS, m_sync_address);
+
+  m_inflator.HandleSync(SYNC_ADDRESS);
+  OLA_ASSERT_EQ(1u, m_handler_count);
+
+  SendData(2, SYNC_ADDRESS, "def");
+  SendData(3, SYNC_ADDRESS, "ghi");
+  OLA_ASSERT_EQ(1u, m_handler_count);
+
+  // A sync packet for a different address doesn't release the data.
+  m_inflator.HandleSync(SYNC_ADDRESS + 1);
+  OLA_ASSERT_EQ(1u, m_handler_count);
+
+  m_inflator.HandleSync(SYNC_ADDRESS);
+  OLA_ASSERT_EQ(2u, m_handler_count);
+  OLA_ASSERT_EQ(string("ghi"), m_buffer.Get());
+
+  // Nothing is pending now.
+  m_inflator.HandleSync(SYNC_ADDRESS);
+  OLA_ASSERT_EQ(2u, m_handler_count);
+
+  // Data without a sync address isn't held.
+  SendData(4, 0, "jkl");
+  OLA_ASSERT_EQ(3u, m_handler_count);
+}
+}  // namespace acn
+}  // namespace ola
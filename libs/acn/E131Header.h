@@ -38,6 +38,7 @@ class E131Header {
         : m_priority(0),
           m_sequence(0),
           m_universe(0),
+          m_sync_address(0),
           m_is_preview(false),
           m_has_terminated(false),
           m_is_rev2(false) {
@@ -53,6 +54,7 @@ class E131Header {
           m_priority(priority),
           m_sequence(sequence),
           m_universe(universe),
+          m_sync_address(0),
           m_is_preview(is_preview),
           m_has_terminated(has_terminated),
           m_is_rev2(is_rev2) {
@@ -63,6 +65,13 @@ class E131Header {
     uint8_t Priority() const { return m_priority; }
     uint8_t Sequence() const { return m_sequence; }
     uint16_t Universe() const { return m_universe; }
+    // The universe synchronization packets for this data are sent on, 0 if
+    // the data isn't synchronized.
+    uint16_t SyncAddress() const { return m_sync_address; }
+    void SetSyncAddress(uint16_t sync_address) {
+      m_sync_address = sync_address;
+    }
+
     bool PreviewData() const { return m_is_preview; }
     bool StreamTerminated() const { return m_has_terminated; }
 
@@ -73,6 +82,7 @@ class E131Header {
         m_priority == other.m_priority &&
         m_sequence == other.m_sequence &&
         m_universe == other.m_universe &&
+        m_sync_address == other.m_sync_address &&
         m_is_preview == other.m_is_preview &&
         m_has_terminated == other.m_has_terminated &&
         m_is_rev2 == other.m_is_rev2;
@@ -84,7 +94,7 @@ class E131Header {
     struct e131_pdu_header_s {
       char source[SOURCE_NAME_LEN];
       uint8_t priority;
-      uint16_t reserved;
+      uint16_t sync_address;
       uint8_t sequence;
       uint8_t options;
       uint16_t universe;
@@ -99,6 +109,7 @@ class E131Header {
     uint8_t m_priority;
     uint8_t m_sequence;
     uint16_t m_universe;
+    uint16_t m_sync_address;
     bool m_is_preview;
     bool m_has_terminated;
     bool m_is_rev2;
@@ -53,6 +53,7 @@ bool E131Inflator::DecodeHeader(HeaderSet *headers,
           NetworkToHost(raw_header.universe),
           raw_header.options & E131Header::PREVIEW_DATA_MASK,
           raw_header.options & E131Header::STREAM_TERMINATED_MASK);
+      header.SetSyncAddress(NetworkToHost(raw_header.sync_address));
       m_last_header = header;
       m_last_header_valid = true;
       headers->SetE131Header(header);
@@ -18,6 +18,7 @@
  * Copyright (C) 2005 Simon Newton
  */
 
+#include <stddef.h>
 #include <string.h>
 #include <algorithm>
 #include <map>
@@ -45,6 +46,9 @@ using std::string;
 using std::set;
 using std::vector;
 
+const char E131Node::RECEIVE_DROPS_VAR[] = "e131-receive-drops";
+const char E131Node::SEND_ERRORS_VAR[] = "e131-send-errors";
+
 class TrackedSource {
  public:
   TrackedSource()
@@ -119,7 +123,10 @@ E131Node::E131Node(ola::thread::SchedulerInterface *ss,
       m_e131_sender(&m_socket, &m_root_sender),
       m_dmp_inflator(options.ignore_preview),
       m_discovery_inflator(NewCallback(this, &E131Node::NewDiscoveryPage)),
-      m_incoming_udp_transport(&m_socket, &m_root_inflator),
+      m_extended_inflator(NewCallback(this, &E131Node::SyncReceived)),
+      m_incoming_udp_transport(
+          &m_socket, &m_root_inflator,
+          options.batch_receives ? RECEIVE_BATCH_SIZE : 1),
       m_send_buffer(NULL),
       m_discovery_timeout(ola::thread::INVALID_TIMEOUT) {
 
@@ -133,9 +140,12 @@ E131Node::E131Node(ola::thread::SchedulerInterface *ss,
   // setup all the inflators
   m_root_inflator.AddInflator(&m_e131_inflator);
   m_root_inflator.AddInflator(&m_e131_rev2_inflator);
+  m_root_inflator.AddInflator(&m_extended_inflator);
   m_e131_inflator.AddInflator(&m_dmp_inflator);
   m_e131_inflator.AddInflator(&m_discovery_inflator);
   m_e131_rev2_inflator.AddInflator(&m_dmp_inflator);
+  m_dmp_inflator.SetSyncAddressHandler(
+      NewCallback(this, &E131Node::JoinSyncAddress));
 }
 
 
@@ -151,6 +161,14 @@ E131Node::~E131Node() {
     RemoveHandler(*iter);
   }
 
+  set<uint16_t>::const_iterator sync_iter = m_rx_sync_addresses.begin();
+  for (; sync_iter != m_rx_sync_addresses.end(); ++sync_iter) {
+    IPV4Address addr;
+    if (m_e131_sender.UniverseIP(*sync_iter, &addr)) {
+      m_socket.LeaveMulticast(m_interface.ip_address, addr);
+    }
+  }
+
   Stop();
   if (m_send_buffer)
     delete[] m_send_buffer;
@@ -181,6 +199,26 @@ bool E131Node::Start() {
   m_socket.SetTos(m_options.dscp);
   m_socket.SetMulticastInterface(m_interface.ip_address);
 
+  if (m_options.export_map) {
+    m_socket.EnableSendErrorCounting(
+        m_options.export_map->GetUIntMapVar(SEND_ERRORS_VAR, "interface"),
+        m_interface.ip_address.ToString());
+  }
+
+  if (m_options.batch_sends && !m_socket.EnableSendBatching(m_ss)) {
+    OLA_INFO << "Send batching isn't supported, sending packets one by one";
+  }
+
+  if (m_options.receive_buffer_size) {
+    m_socket.SetReceiveBufferSize(m_options.receive_buffer_size);
+  }
+
+  if (m_options.export_map) {
+    m_socket.EnableDropCounting(
+        m_options.export_map->GetUIntMapVar(RECEIVE_DROPS_VAR, "interface"),
+        m_interface.ip_address.ToString());
+  }
+
   m_socket.SetOnData(NewCallback(&m_incoming_udp_transport,
                                  &IncomingUDPTransport::Receive));
 
@@ -213,6 +251,8 @@ bool E131Node::SetSourceName(uint16_t universe, const string &source) {
     settings->source = source;
   } else {
     iter->second.source = source;
+    // The source name is part of the template.
+    iter->second.packet_template.Clear();
   }
   return true;
 }
@@ -261,6 +301,16 @@ bool E131Node::SendDMXWithSequenceOffset(uint16_t universe,
     settings = &iter->second;
   }
 
+  if (m_options.use_packet_templates) {
+    bool result = SendFromTemplate(
+        universe, settings, buffer,
+        static_cast<uint8_t>(settings->sequence + sequence_offset),
+        priority, preview);
+    if (result && !sequence_offset)
+      settings->sequence++;
+    return result;
+  }
+
   const uint8_t *dmp_data;
   unsigned int dmp_data_length;
 
@@ -291,6 +341,7 @@ bool E131Node::SendDMXWithSequenceOffset(uint16_t universe,
                     preview,  // preview
                     false,  // terminated
                     m_options.use_rev2);
+  header.SetSyncAddress(settings->sync_address);
 
   bool result = m_e131_sender.SendDMP(header, pdu);
   if (result && !sequence_offset)
@@ -343,8 +394,45 @@ bool E131Node::SendStreamTerminated(uint16_t universe,
   return result;
 }
 
+bool E131Node::SetSyncAddress(uint16_t universe, uint16_t sync_address) {
+  if (m_options.use_rev2) {
+    OLA_WARN << "Revision 0.2 of E1.31 doesn't support synchronization";
+    return false;
+  }
+
+  ActiveTxUniverses::iterator iter = m_tx_universes.find(universe);
+  tx_universe *settings;
+  if (iter == m_tx_universes.end()) {
+    settings = SetupOutgoingSettings(universe);
+  } else {
+    settings = &iter->second;
+  }
+  settings->sync_address = sync_address;
+  return true;
+}
+
+bool E131Node::SendSynchronization(uint16_t sync_address) {
+  // Sync packets have their own sequence numbers, separate from the data
+  // packets.
+  uint8_t &sequence = m_sync_sequence_numbers[sync_address];
+  bool result = m_e131_sender.SendSync(sequence, sync_address);
+  if (result) {
+    sequence++;
+  }
+  // Send the queued data packets now, and report any that failed.
+  return m_socket.FlushSendBatch() && result;
+}
+
+bool E131Node::SetHandler(uint16_t universe,
+                          DmxBuffer *buffer,
+                          uint8_t *priority,
+                          Callback0<void> *closure) {
+  return SetHandler(universe, buffer, NULL, priority, closure);
+}
+
 bool E131Node::SetHandler(uint16_t universe,
                           DmxBuffer *buffer,
+                          DmxBuffer *slot_priorities,
                           uint8_t *priority,
                           Callback0<void> *closure) {
   IPV4Address addr;
@@ -359,7 +447,8 @@ bool E131Node::SetHandler(uint16_t universe,
     return false;
   }
 
-  return m_dmp_inflator.SetHandler(universe, buffer, priority, closure);
+  return m_dmp_inflator.SetHandler(universe, buffer, slot_priorities, priority,
+                                  closure);
 }
 
 bool E131Node::RemoveHandler(uint16_t universe) {
@@ -399,12 +488,99 @@ E131Node::tx_universe *E131Node::SetupOutgoingSettings(uint16_t universe) {
   tx_universe settings;
   settings.source = m_options.source_name;
   settings.sequence = 0;
+  settings.sync_address = 0;
   ActiveTxUniverses::iterator iter =
       m_tx_universes.insert(std::make_pair(universe, settings)).first;
   return &iter->second;
 }
 
 
+/*
+ * Pack a complete data packet for a universe, which later frames are patched
+ * into.
+ */
+bool E131Node::BuildPacketTemplate(uint16_t universe,
+                                   tx_universe *settings,
+                                   const uint8_t *dmp_data,
+                                   unsigned int dmp_data_length) {
+  IPV4Address addr;
+  if (!E131Sender::UniverseIP(universe, &addr)) {
+    return false;
+  }
+
+  if (!settings->packet_template.Build(&m_e131_sender, settings->source,
+                                       universe, m_options.use_rev2,
+                                       dmp_data, dmp_data_length)) {
+    return false;
+  }
+  settings->destination = IPV4SocketAddress(addr, ola::acn::ACN_PORT);
+  return true;
+}
+
+
+/*
+ * Send a frame by patching the universe's packet template.
+ */
+bool E131Node::SendFromTemplate(uint16_t universe,
+                                tx_universe *settings,
+                                const ola::DmxBuffer &buffer,
+                                uint8_t sequence,
+                                uint8_t priority,
+                                bool preview) {
+  unsigned int slot_count = buffer.Size();
+  unsigned int start_code_size = m_options.use_rev2 ? 0 : 1;
+  unsigned int dmp_data_length = slot_count + start_code_size;
+  E131PacketTemplate *packet = &settings->packet_template;
+
+  if (!packet->IsBuilt() || packet->DMPDataLength() != dmp_data_length) {
+    const uint8_t *dmp_data = buffer.GetRaw();
+    if (!m_options.use_rev2) {
+      memcpy(m_send_buffer + 1, dmp_data, slot_count);
+      dmp_data = m_send_buffer;
+    }
+    if (!BuildPacketTemplate(universe, settings, dmp_data, dmp_data_length)) {
+      return false;
+    }
+  }
+
+  packet->SetHeader(priority, sequence, preview, settings->sync_address);
+  buffer.Get(packet->DMPData() + start_code_size, &slot_count);
+
+  ssize_t sent = m_socket.SendTo(packet->Data(), packet->Size(),
+                                 settings->destination);
+  return sent == static_cast<ssize_t>(packet->Size());
+}
+
+
+/*
+ * Called when we receive a synchronization packet.
+ */
+void E131Node::SyncReceived(OLA_UNUSED const HeaderSet &headers,
+                            OLA_UNUSED uint8_t sequence,
+                            uint16_t sync_address) {
+  m_dmp_inflator.HandleSync(sync_address);
+}
+
+
+/*
+ * Called the first time data for one of our universes refers to a sync
+ * address. Sync packets are multicast to the sync address' group, so join it.
+ */
+void E131Node::JoinSyncAddress(uint16_t sync_address) {
+  IPV4Address addr;
+  if (!m_e131_sender.UniverseIP(sync_address, &addr)) {
+    return;
+  }
+
+  if (m_socket.JoinMulticast(m_interface.ip_address, addr)) {
+    m_rx_sync_addresses.insert(sync_address);
+  } else {
+    OLA_WARN << "Failed to join multicast group " << addr
+             << " for sync address " << sync_address;
+  }
+}
+
+
 bool E131Node::PerformDiscoveryHousekeeping() {
   // Send the Universe Discovery packets.
   vector<uint16_t> universes;
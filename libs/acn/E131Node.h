@@ -29,6 +29,7 @@
 #include "ola/Callback.h"
 #include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
 #include "ola/acn/ACNPort.h"
 #include "ola/acn/CID.h"
 #include "ola/base/Macro.h"
@@ -38,7 +39,9 @@
 #include "ola/network/Socket.h"
 #include "libs/acn/DMPE131Inflator.h"
 #include "libs/acn/E131DiscoveryInflator.h"
+#include "libs/acn/E131ExtendedInflator.h"
 #include "libs/acn/E131Inflator.h"
+#include "libs/acn/E131PacketTemplate.h"
 #include "libs/acn/E131Sender.h"
 #include "libs/acn/RootInflator.h"
 #include "libs/acn/RootSender.h"
@@ -58,17 +61,32 @@ class E131Node {
        : use_rev2(false),
          ignore_preview(true),
          enable_draft_discovery(false),
+         batch_sends(false),
+         batch_receives(false),
+         use_packet_templates(true),
+         receive_buffer_size(0),
          dscp(0),
          port(ola::acn::ACN_PORT),
-         source_name(ola::OLA_DEFAULT_INSTANCE_NAME) {
+         source_name(ola::OLA_DEFAULT_INSTANCE_NAME),
+         export_map(NULL) {
     }
 
     bool use_rev2;  /**< Use Revision 0.2 of the 2009 draft */
     bool ignore_preview;  /**< Ignore preview data */
     bool enable_draft_discovery;  /**< Enable 2014 draft discovery */
+    /** Send the packets for each SelectServer iteration in a batch */
+    bool batch_sends;
+    /** Read all waiting packets each time the socket is readable */
+    bool batch_receives;
+    /** Patch a prebuilt packet for each frame, rather than packing it */
+    bool use_packet_templates;
+    /** The socket receive buffer size in bytes, 0 uses the system default */
+    unsigned int receive_buffer_size;
     uint8_t dscp;  /**< The DSCP value to tag packets with */
     uint16_t port; /**< The UDP port to use, defaults to ACN_PORT */
     std::string source_name; /**< The source name to use */
+    /** If not NULL, send errors and receive drops are counted here */
+    ola::ExportMap *export_map;
   };
 
   struct KnownController {
@@ -171,6 +189,31 @@ class E131Node {
                             const ola::DmxBuffer &buffer = DmxBuffer(),
                             uint8_t priority = DEFAULT_PRIORITY);
 
+  /**
+   * @brief Set the sync address for a universe we send on.
+   * @param universe the id of the universe.
+   * @param sync_address the universe the synchronization packets are sent on,
+   *   or 0 to stop synchronizing this universe.
+   * @return false if the node is using revision 0.2, which doesn't support
+   *   synchronization.
+   *
+   * Receivers hold the data for a universe with a sync address until they
+   * receive a synchronization packet for the address, see
+   * SendSynchronization().
+   */
+  bool SetSyncAddress(uint16_t universe, uint16_t sync_address);
+
+  /**
+   * @brief Send a synchronization packet.
+   * @param sync_address the universe to send the packet on.
+   * @return true if it was sent successfully, false otherwise
+   *
+   * If batch_sends is enabled, the packet is sent in the same batch as the
+   * data packets queued before it, and the batch is sent straight away. This
+   * returns false if any of the batch failed to send.
+   */
+  bool SendSynchronization(uint16_t sync_address);
+
   /**
    * @brief Set the Callback to be run when we receive data for this universe.
    * @param universe the universe to register the handler for
@@ -182,6 +225,21 @@ class E131Node {
   bool SetHandler(uint16_t universe, ola::DmxBuffer *buffer,
                   uint8_t *priority, ola::Callback0<void> *handler);
 
+  /**
+   * @brief Set the Callback to be run when we receive data for this universe,
+   *   and accept per-slot priorities (start code 0xdd).
+   * @param universe the universe to register the handler for
+   * @param buffer the DmxBuffer to copy the data to.
+   * @param slot_priorities the DmxBuffer to copy the per-slot priorities to.
+   *   This is empty if no source is sending per-slot priorities.
+   * @param priority the priority to set.
+   * @param handler the Callback to call when there is data for this universe.
+   *   Ownership is transferred.
+   */
+  bool SetHandler(uint16_t universe, ola::DmxBuffer *buffer,
+                  ola::DmxBuffer *slot_priorities, uint8_t *priority,
+                  ola::Callback0<void> *handler);
+
   /**
    * @brief Remove the handler for a particular universe.
    * @param universe the universe handler to remove
@@ -211,6 +269,11 @@ class E131Node {
   struct tx_universe {
     std::string source;
     uint8_t sequence;
+    // The last packet sent for this universe, which is patched for each
+    // frame.
+    E131PacketTemplate packet_template;
+    ola::network::IPV4SocketAddress destination;
+    uint16_t sync_address;
   };
 
   typedef std::map<uint16_t, tx_universe> ActiveTxUniverses;
@@ -232,16 +295,34 @@ class E131Node {
   E131InflatorRev2 m_e131_rev2_inflator;
   DMPE131Inflator m_dmp_inflator;
   E131DiscoveryInflator m_discovery_inflator;
+  E131ExtendedInflator m_extended_inflator;
 
   IncomingUDPTransport m_incoming_udp_transport;
   ActiveTxUniverses m_tx_universes;
   uint8_t *m_send_buffer;
+  // The sequence numbers for the sync addresses we send on.
+  std::map<uint16_t, uint8_t> m_sync_sequence_numbers;
+  // The sync addresses we've joined the multicast groups for.
+  std::set<uint16_t> m_rx_sync_addresses;
 
   // Discovery members
   ola::thread::timeout_id m_discovery_timeout;
   TrackedSources m_discovered_sources;
 
   tx_universe *SetupOutgoingSettings(uint16_t universe);
+  bool BuildPacketTemplate(uint16_t universe, tx_universe *settings,
+                           const uint8_t *dmp_data,
+                           unsigned int dmp_data_length);
+  bool SendFromTemplate(uint16_t universe,
+                        tx_universe *settings,
+                        const ola::DmxBuffer &buffer,
+                        uint8_t sequence,
+                        uint8_t priority,
+                        bool preview);
+
+  void SyncReceived(const HeaderSet &headers, uint8_t sequence,
+                    uint16_t sync_address);
+  void JoinSyncAddress(uint16_t sync_address);
 
   bool PerformDiscoveryHousekeeping();
   void NewDiscoveryPage(const HeaderSet &headers,
@@ -253,6 +334,9 @@ class E131Node {
   static const uint16_t UNIVERSE_DISCOVERY_INTERVAL = 10000;  // milliseconds
   static const uint16_t DISCOVERY_UNIVERSE_ID = 64214;
   static const uint16_t DISCOVERY_PAGE_SIZE = 512;
+  static const unsigned int RECEIVE_BATCH_SIZE = 32;
+  static const char RECEIVE_DROPS_VAR[];
+  static const char SEND_ERRORS_VAR[];
 
   DISALLOW_COPY_AND_ASSIGN(E131Node);
 };
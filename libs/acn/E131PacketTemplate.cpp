@@ -0,0 +1,101 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131PacketTemplate.cpp
+ * A packed E1.31 data packet that is patched for each frame.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "ola/acn/CID.h"
+#include "ola/network/NetworkUtils.h"
+#include "libs/acn/DMPAddress.h"
+#include "libs/acn/DMPPDU.h"
+#include "libs/acn/E131Header.h"
+#include "libs/acn/E131PacketTemplate.h"
+#include "libs/acn/PreamblePacker.h"
+
+namespace ola {
+namespace acn {
+
+using ola::network::HostToNetwork;
+using std::string;
+using std::vector;
+
+bool E131PacketTemplate::Build(E131Sender *sender,
+                               const string &source,
+                               uint16_t universe,
+                               bool rev2,
+                               const uint8_t *dmp_data,
+                               unsigned int dmp_data_length) {
+  TwoByteRangeDMPAddress range_addr(0, 1, (uint16_t) dmp_data_length);
+  DMPAddressData<TwoByteRangeDMPAddress> range_chunk(&range_addr,
+                                                     dmp_data,
+                                                     dmp_data_length);
+  vector<DMPAddressData<TwoByteRangeDMPAddress> > ranged_chunks;
+  ranged_chunks.push_back(range_chunk);
+  const DMPPDU *pdu = NewRangeDMPSetProperty<uint16_t>(true,
+                                                       false,
+                                                       ranged_chunks);
+
+  E131Header header(source, 0, 0, universe, false, false, rev2);
+
+  // Resizing within the capacity doesn't reallocate, so a universe only
+  // allocates once.
+  m_packet.resize(PreamblePacker::MAX_DATAGRAM_SIZE);
+  unsigned int length = static_cast<unsigned int>(m_packet.size());
+  bool ok = sender->PackDMP(header, pdu, &m_packet[0], &length);
+  delete pdu;
+
+  if (!ok) {
+    m_packet.clear();
+    return false;
+  }
+  m_packet.resize(length);
+  m_data_offset = length - dmp_data_length;
+  m_rev2 = rev2;
+  return true;
+}
+
+
+void E131PacketTemplate::SetHeader(uint8_t priority,
+                                   uint8_t sequence,
+                                   bool preview,
+                                   uint16_t sync_address) {
+  // The framing layer header follows the preamble, the root layer's flags &
+  // length, vector and CID, and the framing layer's flags & length and
+  // vector.
+  uint8_t *header = &m_packet[0] + PreamblePacker::ACN_HEADER_SIZE + 2 + 4 +
+                    CID::CID_LENGTH + 2 + 4;
+  if (m_rev2) {
+    header[offsetof(E131Rev2Header::e131_rev2_pdu_header, priority)] =
+        priority;
+    header[offsetof(E131Rev2Header::e131_rev2_pdu_header, sequence)] =
+        sequence;
+  } else {
+    header[offsetof(E131Header::e131_pdu_header, priority)] = priority;
+    header[offsetof(E131Header::e131_pdu_header, sequence)] = sequence;
+    header[offsetof(E131Header::e131_pdu_header, options)] =
+        preview ? E131Header::PREVIEW_DATA_MASK : 0;
+    uint16_t network_sync_address = HostToNetwork(sync_address);
+    memcpy(header + offsetof(E131Header::e131_pdu_header, sync_address),
+           &network_sync_address, sizeof(network_sync_address));
+  }
+}
+}  // namespace acn
+}  // namespace ola
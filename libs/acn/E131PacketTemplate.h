@@ -0,0 +1,102 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131PacketTemplate.h
+ * A packed E1.31 data packet that is patched for each frame.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef LIBS_ACN_E131PACKETTEMPLATE_H_
+#define LIBS_ACN_E131PACKETTEMPLATE_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "libs/acn/E131Sender.h"
+
+namespace ola {
+namespace acn {
+
+/**
+ * @brief A packed E1.31 data packet for a universe.
+ *
+ * Only the priority, sequence number, options, sync address and slot data
+ * change between frames, so these are patched in place rather than packing
+ * the whole packet again. The template is packed with
+ * E131Sender::PackDMP(), so the layout always matches the packed path.
+ */
+class E131PacketTemplate {
+ public:
+  E131PacketTemplate()
+      : m_data_offset(0),
+        m_rev2(false) {
+  }
+
+  /**
+   * @brief Pack the template.
+   * @param sender the E131Sender to pack with.
+   * @param source the source name.
+   * @param universe the universe.
+   * @param rev2 true to use Revision 0.2 of the 2009 draft.
+   * @param dmp_data the property data, including the start code for the
+   *   ANSI revision.
+   * @param dmp_data_length the length of dmp_data.
+   * @returns true if the template was packed.
+   */
+  bool Build(E131Sender *sender, const std::string &source,
+             uint16_t universe, bool rev2, const uint8_t *dmp_data,
+             unsigned int dmp_data_length);
+
+  /**
+   * @brief Discard the template, so it's built again for the next frame.
+   */
+  void Clear() { m_packet.clear(); }
+
+  bool IsBuilt() const { return !m_packet.empty(); }
+
+  /**
+   * @brief The length of the property data, including the start code.
+   */
+  unsigned int DMPDataLength() const {
+    return static_cast<unsigned int>(m_packet.size()) - m_data_offset;
+  }
+
+  /**
+   * @brief Patch the framing layer header.
+   *
+   * The 0.2 draft doesn't have the options or sync address fields, so
+   * preview and sync_address are ignored for rev2 templates.
+   */
+  void SetHeader(uint8_t priority, uint8_t sequence, bool preview,
+                 uint16_t sync_address);
+
+  /**
+   * @brief The property data, the slot data is copied in here.
+   */
+  uint8_t *DMPData() { return &m_packet[m_data_offset]; }
+
+  const uint8_t *Data() const { return &m_packet[0]; }
+  unsigned int Size() const {
+    return static_cast<unsigned int>(m_packet.size());
+  }
+
+ private:
+  std::vector<uint8_t> m_packet;
+  unsigned int m_data_offset;
+  bool m_rev2;
+};
+}  // namespace acn
+}  // namespace ola
+#endif  // LIBS_ACN_E131PACKETTEMPLATE_H_
@@ -0,0 +1,165 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * E131PacketTemplateTest.cpp
+ * Test fixture for the E131PacketTemplate class
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "ola/Constants.h"
+#include "ola/acn/CID.h"
+#include "libs/acn/DMPAddress.h"
+#include "libs/acn/DMPPDU.h"
+#include "libs/acn/E131Header.h"
+#include "libs/acn/E131PacketTemplate.h"
+#include "libs/acn/E131Sender.h"
+#include "libs/acn/PreamblePacker.h"
+#include "libs/acn/RootSender.h"
+#include "ola/testing/TestUtils.h"
+
+namespace ola {
+namespace acn {
+
+using std::string;
+using std::vector;
+
+class E131PacketTemplateTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(E131PacketTemplateTest);
+  CPPUNIT_TEST(testMatchesPackedPacket);
+  CPPUNIT_TEST(testMatchesPackedRev2Packet);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+    E131PacketTemplateTest()
+        : m_root_sender(CID::Generate()),
+          m_sender(NULL, &m_root_sender) {
+    }
+
+    void testMatchesPackedPacket();
+    void testMatchesPackedRev2Packet();
+
+ private:
+    RootSender m_root_sender;
+    E131Sender m_sender;
+
+    void CheckMatches(bool rev2, unsigned int dmp_data_length,
+                      uint8_t priority, uint8_t sequence, bool preview,
+                      uint16_t sync_address);
+    void Pack(const E131Header &header, const uint8_t *dmp_data,
+              unsigned int dmp_data_length, vector<uint8_t> *packet);
+
+    static const char SOURCE_NAME[];
+    static const uint16_t UNIVERSE = 42;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(E131PacketTemplateTest);
+
+const char E131PacketTemplateTest::SOURCE_NAME[] = "ola";
+
+
+/*
+ * Pack a packet with the E131PDU, as the non-template path does.
+ */
+void E131PacketTemplateTest::Pack(const E131Header &header,
+                                  const uint8_t *dmp_data,
+                                  unsigned int dmp_data_length,
+                                  vector<uint8_t> *packet) {
+  TwoByteRangeDMPAddress range_addr(0, 1, (uint16_t) dmp_data_length);
+  DMPAddressData<TwoByteRangeDMPAddress> range_chunk(&range_addr,
+                                                     dmp_data,
+                                                     dmp_data_length);
+  vector<DMPAddressData<TwoByteRangeDMPAddress> > ranged_chunks;
+  ranged_chunks.push_back(range_chunk);
+  const DMPPDU *pdu = NewRangeDMPSetProperty<uint16_t>(true,
+                                                       false,
+                                                       ranged_chunks);
+
+  packet->resize(PreamblePacker::MAX_DATAGRAM_SIZE);
+  unsigned int length = static_cast<unsigned int>(packet->size());
+  OLA_ASSERT_TRUE(m_sender.PackDMP(header, pdu, &(*packet)[0], &length));
+  packet->resize(length);
+  delete pdu;
+}
+
+
+/*
+ * Build a template from one frame, patch it with the settings for another
+ * and check it matches the packet packed with those settings.
+ */
+void E131PacketTemplateTest::CheckMatches(bool rev2,
+                                          unsigned int dmp_data_length,
+                                          uint8_t priority,
+                                          uint8_t sequence,
+                                          bool preview,
+                                          uint16_t sync_address) {
+  uint8_t first_frame[DMX_UNIVERSE_SIZE + 1];
+  uint8_t second_frame[DMX_UNIVERSE_SIZE + 1];
+  for (unsigned int i = 0; i < sizeof(first_frame); i++) {
+    first_frame[i] = static_cast<uint8_t>(i);
+    second_frame[i] = static_cast<uint8_t>(255 - i);
+  }
+
+  E131PacketTemplate packet_template;
+  OLA_ASSERT_TRUE(packet_template.Build(&m_sender, SOURCE_NAME, UNIVERSE,
+                                        rev2, first_frame, dmp_data_length));
+  OLA_ASSERT_TRUE(packet_template.IsBuilt());
+  OLA_ASSERT_EQ(dmp_data_length, packet_template.DMPDataLength());
+
+  packet_template.SetHeader(priority, sequence, preview, sync_address);
+  memcpy(packet_template.DMPData(), second_frame, dmp_data_length);
+
+  E131Header header(SOURCE_NAME, priority, sequence, UNIVERSE, preview, false,
+                    rev2);
+  if (!rev2) {
+    header.SetSyncAddress(sync_address);
+  }
+  vector<uint8_t> expected;
+  Pack(header, second_frame, dmp_data_length, &expected);
+
+  OLA_ASSERT_DATA_EQUALS(&expected[0],
+                         static_cast<unsigned int>(expected.size()),
+                         packet_template.Data(), packet_template.Size());
+}
+
+
+/*
+ * Check templates match the E131PDU packed packets for the ANSI revision.
+ */
+void E131PacketTemplateTest::testMatchesPackedPacket() {
+  CheckMatches(false, DMX_UNIVERSE_SIZE + 1, 100, 0, false, 0);
+  CheckMatches(false, DMX_UNIVERSE_SIZE + 1, 200, 1, true, 0);
+  CheckMatches(false, DMX_UNIVERSE_SIZE + 1, 0, 255, false, 7);
+  CheckMatches(false, 1, 100, 128, true, 63999);
+  CheckMatches(false, 25, 150, 17, false, 0x1234);
+}
+
+
+/*
+ * Check templates match the E131PDU packed packets for the 0.2 draft.
+ */
+void E131PacketTemplateTest::testMatchesPackedRev2Packet() {
+  CheckMatches(true, DMX_UNIVERSE_SIZE, 100, 0, false, 0);
+  CheckMatches(true, DMX_UNIVERSE_SIZE, 200, 255, false, 0);
+  CheckMatches(true, 1, 0, 128, false, 0);
+  CheckMatches(true, 24, 150, 17, false, 0);
+}
+}  // namespace acn
+}  // namespace ola
@@ -18,6 +18,8 @@
  * Copyright (C) 2007 Simon Newton
  */
 
+#include <string.h>
+
 #include "ola/Logging.h"
 #include "ola/acn/ACNVectors.h"
 #include "ola/network/IPV4Address.h"
@@ -27,6 +29,7 @@
 #include "libs/acn/E131Inflator.h"
 #include "libs/acn/E131Sender.h"
 #include "libs/acn/E131PDU.h"
+#include "libs/acn/E131SyncPDU.h"
 #include "libs/acn/RootSender.h"
 #include "libs/acn/UDPTransport.h"
 
@@ -36,6 +39,39 @@ namespace acn {
 using ola::network::IPV4Address;
 using ola::network::HostToNetwork;
 
+namespace {
+
+/*
+ * A transport that copies the packed datagram into a buffer rather than
+ * sending it.
+ */
+class PackingTransport: public OutgoingTransport {
+ public:
+  PackingTransport(PreamblePacker *packer, uint8_t *data,
+                   unsigned int *length)
+      : m_packer(packer),
+        m_data(data),
+        m_length(length) {
+  }
+
+  bool Send(const PDUBlock<PDU> &pdu_block) {
+    unsigned int size;
+    const uint8_t *packed = m_packer->Pack(pdu_block, &size);
+    if (!packed || size > *m_length) {
+      return false;
+    }
+    memcpy(m_data, packed, size);
+    *m_length = size;
+    return true;
+  }
+
+ private:
+  PreamblePacker *m_packer;
+  uint8_t *m_data;
+  unsigned int *m_length;
+};
+}  // namespace
+
 /*
  * Create a new E131Sender
  * @param root_sender the root layer to use
@@ -78,6 +114,29 @@ bool E131Sender::SendDMP(const E131Header &header, const DMPPDU *dmp_pdu) {
   return m_root_sender->SendPDU(vector, pdu, &transport);
 }
 
+/*
+ * Pack a DMPPDU into a buffer
+ * @param header the E131Header
+ * @param dmp_pdu the DMPPDU to pack
+ * @param data the buffer to pack into
+ * @param length the size of the buffer, updated with the packet size
+ */
+bool E131Sender::PackDMP(const E131Header &header, const DMPPDU *dmp_pdu,
+                         uint8_t *data, unsigned int *length) {
+  if (!m_root_sender) {
+    return false;
+  }
+
+  PackingTransport transport(&m_packer, data, length);
+
+  E131PDU pdu(ola::acn::VECTOR_E131_DATA, header, dmp_pdu);
+  unsigned int vector = ola::acn::VECTOR_ROOT_E131;
+  if (header.UsingRev2()) {
+    vector = ola::acn::VECTOR_ROOT_E131_REV2;
+  }
+  return m_root_sender->SendPDU(vector, pdu, &transport);
+}
+
 bool E131Sender::SendDiscoveryData(const E131Header &header,
                                    const uint8_t *data,
                                    unsigned int data_size) {
@@ -99,6 +158,24 @@ bool E131Sender::SendDiscoveryData(const E131Header &header,
   return m_root_sender->SendPDU(vector, pdu, &transport);
 }
 
+bool E131Sender::SendSync(uint8_t sequence, uint16_t sync_address) {
+  if (!m_root_sender) {
+    return false;
+  }
+
+  IPV4Address addr;
+  if (!UniverseIP(sync_address, &addr)) {
+    OLA_INFO << "Could not convert universe " << sync_address << " to IP.";
+    return false;
+  }
+
+  OutgoingUDPTransport transport(&m_transport_impl, addr);
+
+  E131SyncPDU pdu(sequence, sync_address);
+  return m_root_sender->SendPDU(ola::acn::VECTOR_ROOT_E131_EXTENDED, pdu,
+                                &transport);
+}
+
 
 /*
  * Calculate the IP that corresponds to a universe.
@@ -41,9 +41,29 @@ class E131Sender {
   ~E131Sender() {}
 
   bool SendDMP(const E131Header &header, const DMPPDU *pdu);
+
+  /**
+   * @brief Pack a DMP packet, including the preamble and root layer, without
+   *   sending it.
+   * @param header the E131Header.
+   * @param pdu the DMPPDU.
+   * @param data the buffer to pack into.
+   * @param length the size of data, updated with the size of the packet.
+   * @returns true if the packet was packed, false if the buffer was too small.
+   */
+  bool PackDMP(const E131Header &header, const DMPPDU *pdu, uint8_t *data,
+               unsigned int *length);
   bool SendDiscoveryData(const E131Header &header, const uint8_t *data,
                          unsigned int data_size);
 
+  /**
+   * @brief Send a synchronization packet.
+   * @param sequence the sequence number, this is separate from the sequence
+   *   numbers of the data packets.
+   * @param sync_address the universe to send the packet on.
+   */
+  bool SendSync(uint8_t sequence, uint16_t sync_address);
+
   static bool UniverseIP(uint16_t universe,
                          class ola::network::IPV4Address *addr);
 
@@ -19,6 +19,7 @@
  */
 
 #include <string.h>
+#include <algorithm>
 
 #include "ola/Callback.h"
 #include "ola/Logging.h"
@@ -63,10 +64,13 @@ bool OutgoingUDPTransportImpl::Send(const PDUBlock<PDU> &pdu_block,
 
 
 IncomingUDPTransport::IncomingUDPTransport(ola::network::UDPSocket *socket,
-                                           BaseInflator *inflator)
+                                           BaseInflator *inflator,
+                                           unsigned int batch_size)
     : m_socket(socket),
       m_inflator(inflator),
-      m_recv_buffer(NULL) {
+      m_batch_size(std::max(batch_size, 1u)),
+      m_recv_buffer(NULL),
+      m_datagrams(NULL) {
 }
 
 
@@ -74,22 +78,40 @@ IncomingUDPTransport::IncomingUDPTransport(ola::network::UDPSocket *socket,
  * Called when new data arrives.
  */
 void IncomingUDPTransport::Receive() {
-  if (!m_recv_buffer)
-    m_recv_buffer = new uint8_t[PreamblePacker::MAX_DATAGRAM_SIZE];
+  if (!m_recv_buffer) {
+    // A ring of buffers, one per datagram in the batch.
+    m_recv_buffer = new uint8_t[
+        m_batch_size * PreamblePacker::MAX_DATAGRAM_SIZE];
+    m_datagrams = new ola::network::UDPDatagram[m_batch_size];
+    for (unsigned int i = 0; i < m_batch_size; i++) {
+      m_datagrams[i].data = (
+          m_recv_buffer + i * PreamblePacker::MAX_DATAGRAM_SIZE);
+      m_datagrams[i].buffer_size = PreamblePacker::MAX_DATAGRAM_SIZE;
+    }
+  }
 
-  ssize_t size = PreamblePacker::MAX_DATAGRAM_SIZE;
-  ola::network::IPV4SocketAddress source;
+  unsigned int received = m_socket->RecvBatch(m_datagrams, m_batch_size);
+  for (unsigned int i = 0; i < received; i++) {
+    HandleDatagram(m_datagrams[i].data, m_datagrams[i].size,
+                   m_datagrams[i].source);
+  }
+}
 
-  if (!m_socket->RecvFrom(m_recv_buffer, &size, &source))
-    return;
 
+/*
+ * Check the preamble and inflate a single datagram.
+ */
+void IncomingUDPTransport::HandleDatagram(
+    const uint8_t *data,
+    ssize_t size,
+    const ola::network::IPV4SocketAddress &source) {
   unsigned int header_size = PreamblePacker::ACN_HEADER_SIZE;
   if (size < static_cast<ssize_t>(header_size)) {
     OLA_WARN << "short ACN frame, discarding";
     return;
   }
 
-  if (memcmp(m_recv_buffer, PreamblePacker::ACN_HEADER, header_size)) {
+  if (memcmp(data, PreamblePacker::ACN_HEADER, header_size)) {
     OLA_WARN << "ACN header is bad, discarding";
     return;
   }
@@ -100,9 +122,8 @@ void IncomingUDPTransport::Receive() {
 
   m_inflator->InflatePDUBlock(
       &header_set,
-      m_recv_buffer + header_size,
+      data + header_size,
       static_cast<unsigned int>(size) - header_size);
-  return;
 }
 }  // namespace acn
 }  // namespace ola
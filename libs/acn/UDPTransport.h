@@ -93,11 +93,20 @@ class OutgoingUDPTransportImpl {
  */
 class IncomingUDPTransport {
  public:
+    /**
+     * @param socket the socket to receive on.
+     * @param inflator the inflator to pass the datagrams to.
+     * @param batch_size the maximum number of datagrams to read each time the
+     *   socket is readable.
+     */
     IncomingUDPTransport(ola::network::UDPSocket *socket,
-                         class BaseInflator *inflator);
+                         class BaseInflator *inflator,
+                         unsigned int batch_size = 1);
     ~IncomingUDPTransport() {
       if (m_recv_buffer)
         delete[] m_recv_buffer;
+      if (m_datagrams)
+        delete[] m_datagrams;
     }
 
     void Receive();
@@ -105,7 +114,12 @@ class IncomingUDPTransport {
  private:
     ola::network::UDPSocket *m_socket;
     class BaseInflator *m_inflator;
+    const unsigned int m_batch_size;
     uint8_t *m_recv_buffer;
+    ola::network::UDPDatagram *m_datagrams;
+
+    void HandleDatagram(const uint8_t *data, ssize_t size,
+                        const ola::network::IPV4SocketAddress &source);
 };
 }  // namespace acn
 }  // namespace ola
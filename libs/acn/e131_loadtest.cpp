@@ -19,24 +19,50 @@
  */
 
 #include <stdlib.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
 #include <algorithm>
+#include <iostream>
 #include <string>
+#include <vector>
 #include "ola/Callback.h"
+#include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
 #include "ola/Logging.h"
 #include "ola/base/Flags.h"
 #include "ola/base/Init.h"
 #include "ola/io/SelectServer.h"
+#include "ola/thread/Thread.h"
 #include "libs/acn/E131Node.h"
 
+using ola::Clock;
 using ola::DmxBuffer;
+using ola::TimeInterval;
+using ola::TimeStamp;
 using ola::io::SelectServer;
 using ola::acn::E131Node;
 using ola::NewCallback;
+using std::cout;
+using std::endl;
 using std::min;
 
 DEFINE_s_uint32(fps, s, 10, "Frames per second per universe [1 - 40]");
 DEFINE_s_uint16(universes, u, 1, "Number of universes to send");
+DEFINE_default_bool(benchmark, false,
+                    "Send frames as fast as possible, with and without packet "
+                    "templates, and report the packets/s");
+DEFINE_uint32(frames, 1000,
+              "The number of frames per universe to send in benchmark mode");
+DEFINE_default_bool(batch_sends, false,
+                    "Queue the packets and send them with sendmmsg()");
+DEFINE_default_bool(receive_benchmark, false,
+                    "Send frames to ourselves over multicast and report the "
+                    "CPU time the receiving thread spends on each packet. Use "
+                    "with --use-io-uring to compare the pollers");
+DEFINE_uint16(burst, 8,
+              "The number of frames per universe to send before receiving, "
+              "in receive benchmark mode");
 
 /**
  * Send N DMX frames using E1.31, where N is given by number_of_universes.
@@ -49,12 +75,197 @@ bool SendFrames(E131Node *node, DmxBuffer *buffer,
   return true;
 }
 
+/**
+ * Return the user CPU time used by this process, this excludes the time spent
+ * in the kernel sending the packets.
+ */
+int64_t UserTime() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return TimeInterval(usage.ru_utime.tv_sec, usage.ru_utime.tv_usec).AsInt();
+}
+
+/**
+ * Return the CPU time used by this thread, including the time in the kernel.
+ */
+int64_t ThreadTime() {
+  struct timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+void Increment(unsigned int *count) {
+  __atomic_add_fetch(count, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Sends bursts of frames, waiting for each burst to be received before
+ * sending the next one so the socket buffers don't overflow.
+ */
+class SenderThread : public ola::thread::Thread {
+ public:
+  SenderThread(E131Node *node, const DmxBuffer &buffer,
+               uint16_t number_of_universes, unsigned int frames,
+               unsigned int burst, const unsigned int *received)
+      : Thread(Thread::Options("sender")),
+        m_node(node),
+        m_buffer(buffer),
+        m_number_of_universes(number_of_universes),
+        m_frames(frames),
+        m_burst(burst),
+        m_received(received),
+        m_sent(0),
+        m_done(false) {
+  }
+
+  bool Done() const {
+    return __atomic_load_n(&m_done, __ATOMIC_ACQUIRE);
+  }
+
+  unsigned int Sent() const {
+    return __atomic_load_n(&m_sent, __ATOMIC_ACQUIRE);
+  }
+
+ protected:
+  void *Run() {
+    for (unsigned int frame = 0; frame < m_frames; frame += m_burst) {
+      for (unsigned int i = 0; i < m_burst; i++) {
+        for (uint16_t j = 1; j < m_number_of_universes + 1; j++) {
+          m_node->SendDMX(j, m_buffer);
+        }
+      }
+      const unsigned int sent = Sent() + m_burst * m_number_of_universes;
+      __atomic_store_n(&m_sent, sent, __ATOMIC_RELEASE);
+
+      // Give up on a burst if packets are lost.
+      for (unsigned int i = 0;
+           i < 1000 && __atomic_load_n(m_received, __ATOMIC_ACQUIRE) < sent;
+           i++) {
+        usleep(100);
+      }
+    }
+    __atomic_store_n(&m_done, true, __ATOMIC_RELEASE);
+    return NULL;
+  }
+
+ private:
+  E131Node *m_node;
+  const DmxBuffer m_buffer;
+  const uint16_t m_number_of_universes;
+  const unsigned int m_frames;
+  const unsigned int m_burst;
+  const unsigned int *m_received;
+  unsigned int m_sent;
+  bool m_done;
+};
+
+/**
+ * Receive frames sent by a second thread & print the CPU time this thread
+ * spends on each packet. The sending thread is charged for delivering the
+ * packets to the socket, so this is the cost of the SelectServer & the
+ * E1.31 inflators.
+ */
+bool RunReceiveBenchmark(bool batch_receives, const DmxBuffer &buffer,
+                         uint16_t number_of_universes, unsigned int frames,
+                         unsigned int burst) {
+  SelectServer ss, sender_ss;
+  E131Node sender(&sender_ss, "", E131Node::Options());
+  E131Node::Options options;
+  options.batch_receives = batch_receives;
+  // Large enough to hold a full burst.
+  options.receive_buffer_size = 4 * 1024 * 1024;
+  E131Node receiver(&ss, "", options);
+  if (!sender.Start() || !receiver.Start())
+    return false;
+
+  std::vector<DmxBuffer> received(number_of_universes);
+  uint8_t priority;
+  unsigned int packets = 0;
+  for (uint16_t i = 0; i < number_of_universes; i++) {
+    receiver.SetHandler(i + 1, &received[i], &priority,
+                        NewCallback(&Increment, &packets));
+  }
+  ss.AddReadDescriptor(receiver.GetSocket());
+
+  SenderThread sender_thread(&sender, buffer, number_of_universes, frames,
+                             burst, &packets);
+  int64_t start = ThreadTime();
+  if (!sender_thread.Start())
+    return false;
+  while (!sender_thread.Done()) {
+    ss.RunOnce(TimeInterval(0, 10000));
+  }
+  int64_t cpu_time = ThreadTime() - start;
+  sender_thread.Join();
+  ss.RemoveReadDescriptor(receiver.GetSocket());
+
+  cout << (batch_receives ? "batched receives: " : "single receives:  ")
+       << packets << " of " << sender_thread.Sent() << " packets, "
+       << (packets ? cpu_time / packets : 0)
+       << " ns CPU/packet" << endl;
+  return true;
+}
+
+/**
+ * Send frames for all universes as fast as possible & print the packets/s.
+ */
+bool RunBenchmark(bool use_packet_templates, const DmxBuffer &buffer,
+                  uint16_t number_of_universes, unsigned int frames) {
+  SelectServer ss;
+  E131Node::Options options;
+  options.use_packet_templates = use_packet_templates;
+  options.batch_sends = FLAGS_batch_sends;
+  E131Node node(&ss, "", options);
+  if (!node.Start())
+    return false;
+
+  Clock clock;
+  TimeStamp start, end;
+  int64_t user_start = UserTime();
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < frames; i++) {
+    for (uint16_t j = 1; j < number_of_universes + 1; j++) {
+      node.SendDMX(j, buffer);
+    }
+  }
+  clock.CurrentTime(&end);
+  int64_t user_time = UserTime() - user_start;
+
+  int64_t duration = std::max((end - start).AsInt(), static_cast<int64_t>(1));
+  unsigned int packets = frames * number_of_universes;
+  cout << (use_packet_templates ? "packet templates: " : "packing:          ")
+       << static_cast<uint64_t>(packets * 1000000.0 / duration)
+       << " packets/s, " << user_time * 1000.0 / packets
+       << " ns user CPU/packet" << endl;
+  return true;
+}
+
 int main(int argc, char* argv[]) {
   ola::AppInit(&argc, argv, "", "Run the E1.31 load test.");
 
   if (FLAGS_universes == 0 || FLAGS_fps == 0)
     return -1;
 
+  if (FLAGS_receive_benchmark) {
+    DmxBuffer buffer;
+    buffer.Blackout();
+    if (!RunReceiveBenchmark(false, buffer, FLAGS_universes, FLAGS_frames,
+                             FLAGS_burst) ||
+        !RunReceiveBenchmark(true, buffer, FLAGS_universes, FLAGS_frames,
+                             FLAGS_burst))
+      return -1;
+    return 0;
+  }
+
+  if (FLAGS_benchmark) {
+    DmxBuffer buffer;
+    buffer.Blackout();
+    if (!RunBenchmark(false, buffer, FLAGS_universes, FLAGS_frames) ||
+        !RunBenchmark(true, buffer, FLAGS_universes, FLAGS_frames))
+      return -1;
+    return 0;
+  }
+
   unsigned int fps = min(40u, static_cast<unsigned int>(FLAGS_fps));
   uint16_t universes = FLAGS_universes;
 
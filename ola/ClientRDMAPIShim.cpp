@@ -42,6 +42,7 @@ bool ClientRDMAPIShim::RDMGet(rdm_callback *callback,
                               unsigned int data_length) {
   SendRDMArgs args(NewSingleCallback(
       this, &ClientRDMAPIShim::HandleResponse, callback));
+  args.background = m_background;
   m_client->RDMGet(universe, uid, sub_device, pid, data, data_length, args);
   return true;
 }
@@ -55,6 +56,7 @@ bool ClientRDMAPIShim::RDMGet(rdm_pid_callback *callback,
                               unsigned int data_length) {
   SendRDMArgs args(NewSingleCallback(
       this, &ClientRDMAPIShim::HandleResponseWithPid, callback));
+  args.background = m_background;
   m_client->RDMGet(universe, uid, sub_device, pid, data, data_length, args);
   return true;
 }
@@ -68,6 +70,7 @@ bool ClientRDMAPIShim::RDMSet(rdm_callback *callback,
                               unsigned int data_length) {
   SendRDMArgs args(NewSingleCallback(
       this, &ClientRDMAPIShim::HandleResponse, callback));
+  args.background = m_background;
   m_client->RDMSet(universe, uid, sub_device, pid, data, data_length, args);
   return true;
 }
@@ -164,6 +164,10 @@ void OlaClient::SendDMX(unsigned int universe,
   m_core->SendDMX(universe, data, args);
 }
 
+void OlaClient::SendDMXBatch(const DMXBatch &batch) {
+  m_core->SendDMXBatch(batch);
+}
+
 void OlaClient::FetchDMX(unsigned int universe, DMXCallback *callback) {
   m_core->FetchDMX(universe, callback);
 }
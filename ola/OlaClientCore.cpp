@@ -451,6 +451,7 @@ void OlaClientCore::RegisterUniverse(unsigned int universe,
         ola::proto::UNREGISTER);
   request.set_universe(universe);
   request.set_action(action);
+  request.set_stream_data(true);
 
   if (m_connected) {
     CompletionCallback *cb = ola::NewSingleCallback(
@@ -493,6 +494,27 @@ void OlaClientCore::SendDMX(unsigned int universe,
   }
 }
 
+void OlaClientCore::SendDMXBatch(const DMXBatch &batch) {
+  if (!m_connected) {
+    return;
+  }
+
+  ola::proto::DmxDataBatch request;
+  DMXBatch::const_iterator iter = batch.begin();
+  while (iter != batch.end()) {
+    request.Clear();
+    for (; iter != batch.end() &&
+           static_cast<unsigned int>(request.data_size()) < MAX_DMX_BATCH_SIZE;
+         ++iter) {
+      ola::proto::DmxData *data = request.add_data();
+      data->set_universe(iter->universe);
+      data->set_data(iter->data.GetRaw(), iter->data.Size());
+      data->set_priority(iter->priority);
+    }
+    m_stub->StreamDmxDataBatch(NULL, &request, NULL, NULL);
+  }
+}
+
 void OlaClientCore::FetchDMX(unsigned int universe,
                              DMXCallback *callback) {
   ola::proto::UniverseRequest request;
@@ -623,18 +645,29 @@ void OlaClientCore::UpdateDmxData(ola::rpc::RpcController*,
                                   const ola::proto::DmxData *request,
                                   ola::proto::Ack*,
                                   CompletionCallback *done) {
+  HandleDmxData(*request);
+  done->Run();
+}
+
+void OlaClientCore::StreamDmxData(ola::rpc::RpcController*,
+                                  const ola::proto::DmxData *request,
+                                  ola::proto::STREAMING_NO_RESPONSE*,
+                                  CompletionCallback*) {
+  HandleDmxData(*request);
+}
+
+void OlaClientCore::HandleDmxData(const ola::proto::DmxData &request) {
   if (m_dmx_callback.get()) {
     DmxBuffer buffer;
-    buffer.Set(request->data());
+    buffer.Set(request.data());
 
     uint8_t priority = 0;
-    if (request->has_priority()) {
-      priority = request->priority();
+    if (request.has_priority()) {
+      priority = request.priority();
     }
-    DMXMetadata metadata(request->universe(), priority);
+    DMXMetadata metadata(request.universe(), priority);
     m_dmx_callback->Run(metadata, buffer);
   }
-  done->Run();
 }
 
 void OlaClientCore::ChannelClosed(ClosedCallback *callback,
@@ -1002,6 +1035,12 @@ void OlaClientCore::SendRDMCommand(bool is_set,
   if (args.include_raw_frames) {
     request.set_include_raw_response(true);
   }
+  if (args.bypass_cache) {
+    request.mutable_options()->set_bypass_cache(true);
+  }
+  if (args.background) {
+    request.mutable_options()->set_background(true);
+  }
 
   CompletionCallback *cb = NewSingleCallback(
       this,
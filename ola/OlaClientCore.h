@@ -246,6 +246,14 @@ class OlaClientCore: public ola::proto::OlaClientService {
                const DmxBuffer &data,
                const SendDMXArgs &args);
 
+  /**
+   * @brief Stream DMX data for many universes in a single RPC.
+   * @param batch the data to send.
+   *
+   * Like SendDMX() without a callback, no response is sent by the server.
+   */
+  void SendDMXBatch(const DMXBatch &batch);
+
   /**
    * @brief Fetch the latest DMX data for a universe.
    * @param universe the universe id to get data for.
@@ -322,6 +330,14 @@ class OlaClientCore: public ola::proto::OlaClientService {
                      ola::proto::Ack* response,
                      CompletionCallback* done);
 
+  /**
+   * @brief This is called by the channel when new DMX data is streamed to us.
+   */
+  void StreamDmxData(ola::rpc::RpcController* controller,
+                     const ola::proto::DmxData* request,
+                     ola::proto::STREAMING_NO_RESPONSE* response,
+                     CompletionCallback* done);
+
  private:
   ola::io::ConnectedDescriptor *m_descriptor;
   std::auto_ptr<RepeatableDMXCallback> m_dmx_callback;
@@ -329,6 +345,7 @@ class OlaClientCore: public ola::proto::OlaClientService {
   std::auto_ptr<ola::proto::OlaServerService_Stub> m_stub;
   int m_connected;
 
+  void HandleDmxData(const ola::proto::DmxData &request);
   void ChannelClosed(ClosedCallback *callback, ola::rpc::RpcSession *session);
 
   /**
@@ -442,6 +459,8 @@ class OlaClientCore: public ola::proto::OlaClientService {
       ola::rdm::RDMStatusCode *status_code);
 
   static const char NOT_CONNECTED_ERROR[];
+  // Limits the size of each batch RPC, 512 universes is about 270kB.
+  static const unsigned int MAX_DMX_BATCH_SIZE = 512;
 
   DISALLOW_COPY_AND_ASSIGN(OlaClientCore);
 };
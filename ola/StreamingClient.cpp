@@ -18,8 +18,22 @@
  * Copyright (C) 2005 Simon Newton
  */
 
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef HAVE_SHM_OPEN
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif  // HAVE_SHM_OPEN
+
 #include <ola/AutoStart.h>
 #include <ola/Callback.h>
+#include <ola/Clock.h>
 #include <ola/Constants.h>
 #include <ola/DmxBuffer.h>
 #include <ola/Logging.h>
@@ -29,9 +43,14 @@
 #include <ola/network/SocketAddress.h>
 #include <ola/network/TCPSocket.h>
 
+#include <map>
+#include <vector>
+
+#include "common/dmx/SharedDmxRegion.h"
 #include "common/protocol/Ola.pb.h"
 #include "common/protocol/OlaService.pb.h"
 #include "common/rpc/RpcChannel.h"
+#include "common/rpc/RpcController.h"
 #include "common/rpc/RpcSession.h"
 
 namespace ola {
@@ -40,7 +59,16 @@ namespace client {
 using ola::io::SelectServer;
 using ola::network::TCPSocket;
 using ola::proto::OlaServerService_Stub;
+using ola::dmx::SharedDmxRegion;
 using ola::rpc::RpcChannel;
+using std::map;
+using std::vector;
+
+namespace {
+void MarkComplete(bool *complete) {
+  *complete = true;
+}
+}  // namespace
 
 StreamingClient::StreamingClient(bool auto_start)
     : m_auto_start(auto_start),
@@ -49,7 +77,9 @@ StreamingClient::StreamingClient(bool auto_start)
       m_ss(NULL),
       m_channel(NULL),
       m_stub(NULL),
-      m_socket_closed(false) {
+      m_socket_closed(false),
+      m_region(NULL),
+      m_doorbell_fd(-1) {
 }
 
 StreamingClient::StreamingClient(const Options &options)
@@ -59,7 +89,9 @@ StreamingClient::StreamingClient(const Options &options)
       m_ss(NULL),
       m_channel(NULL),
       m_stub(NULL),
-      m_socket_closed(false) {
+      m_socket_closed(false),
+      m_region(NULL),
+      m_doorbell_fd(-1) {
 }
 
 StreamingClient::~StreamingClient() {
@@ -108,6 +140,8 @@ bool StreamingClient::Setup() {
 }
 
 void StreamingClient::Stop() {
+  CloseSharedMemory();
+
   if (m_stub)
     delete m_stub;
 
@@ -137,8 +171,123 @@ bool StreamingClient::SendDMX(unsigned int universe,
   return Send(universe, args.priority, data);
 }
 
-bool StreamingClient::Send(unsigned int universe, uint8_t priority,
-                           const DmxBuffer &data) {
+bool StreamingClient::SendDMXBatch(const DMXBatch &batch) {
+  if (!CheckConnection())
+    return false;
+
+  if (!m_batch.get())
+    m_batch.reset(new ola::proto::DmxDataBatch());
+
+  bool rang = false;
+  DMXBatch::const_iterator iter = batch.begin();
+  while (iter != batch.end()) {
+    // Clear() keeps the DmxData messages around, so they're reused.
+    m_batch->Clear();
+    for (; iter != batch.end() &&
+           static_cast<unsigned int>(m_batch->data_size()) < MAX_BATCH_SIZE;
+         ++iter) {
+      if (WriteToRegion(iter->universe, iter->priority, iter->data)) {
+        rang = true;
+        continue;
+      }
+      ola::proto::DmxData *data = m_batch->add_data();
+      data->set_universe(iter->universe);
+      data->set_data(iter->data.GetRaw(), iter->data.Size());
+      data->set_priority(iter->priority);
+    }
+    if (m_batch->data_size()) {
+      m_stub->StreamDmxDataBatch(NULL, m_batch.get(), NULL, NULL);
+    }
+
+    if (m_socket_closed) {
+      Stop();
+      return false;
+    }
+  }
+
+  // One ring covers all the slots written above.
+  if (rang)
+    RingDoorbell();
+  return true;
+}
+
+bool StreamingClient::EnableSharedMemory(
+    const vector<unsigned int> &universes) {
+  CloseSharedMemory();
+  if (universes.empty() || !CheckConnection())
+    return false;
+
+#ifdef HAVE_SHM_OPEN
+  // olad needs to reply before we can open the region, so this is the one
+  // RPC the StreamingClient waits for.
+  ola::proto::SharedMemoryRequest request;
+  ola::proto::SharedMemoryReply reply;
+  ola::rpc::RpcController controller;
+  bool complete = false;
+  vector<unsigned int>::const_iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter)
+    request.add_universe(*iter);
+  m_stub->OpenSharedMemory(&controller, &request, &reply,
+                           NewSingleCallback(MarkComplete, &complete));
+
+  Clock clock;
+  TimeStamp now, deadline;
+  clock.CurrentTime(&now);
+  deadline = now + TimeInterval(SHARED_MEMORY_TIMEOUT_MS / 1000,
+                                (SHARED_MEMORY_TIMEOUT_MS % 1000) * 1000);
+  while (!complete && !m_socket_closed && now < deadline) {
+    m_ss->RunOnce(deadline - now);
+    clock.CurrentTime(&now);
+  }
+
+  if (!complete || m_socket_closed) {
+    // The channel still references the request, so it has to go.
+    OLA_WARN << "olad didn't respond to the shared memory request";
+    Stop();
+    return false;
+  }
+
+  if (controller.Failed()) {
+    OLA_INFO << "olad can't use shared memory: " << controller.ErrorText();
+    return false;
+  }
+
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (reply.doorbell_path().size() >= sizeof(address.sun_path))
+    return false;
+  strncpy(address.sun_path, reply.doorbell_path().c_str(),
+          sizeof(address.sun_path) - 1);
+
+  m_region = SharedDmxRegion::Open(reply.region_name());
+  if (!m_region)
+    return false;
+
+  m_doorbell_fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+  if (m_doorbell_fd < 0 ||
+      connect(m_doorbell_fd, reinterpret_cast<struct sockaddr*>(&address),
+              sizeof(address)) < 0) {
+    OLA_WARN << "Failed to connect to " << reply.doorbell_path() << ": "
+             << strerror(errno);
+    CloseSharedMemory();
+    return false;
+  }
+
+  for (unsigned int i = 0; i < universes.size() && i < m_region->SlotCount();
+       i++) {
+    m_region_slots[universes[i]] = i;
+  }
+  return true;
+#else
+  return false;
+#endif  // HAVE_SHM_OPEN
+}
+
+/*
+ * Check the connection to the server is still open.
+ */
+bool StreamingClient::CheckConnection() {
   if (!m_stub || !m_socket->ValidReadDescriptor())
     return false;
 
@@ -152,6 +301,18 @@ bool StreamingClient::Send(unsigned int universe, uint8_t priority,
     Stop();
     return false;
   }
+  return true;
+}
+
+bool StreamingClient::Send(unsigned int universe, uint8_t priority,
+                           const DmxBuffer &data) {
+  if (!CheckConnection())
+    return false;
+
+  if (WriteToRegion(universe, priority, data)) {
+    RingDoorbell();
+    return true;
+  }
 
   ola::proto::DmxData request;
   request.set_universe(universe);
@@ -166,6 +327,51 @@ bool StreamingClient::Send(unsigned int universe, uint8_t priority,
   return true;
 }
 
+/*
+ * Write the data to the shared memory region.
+ * @returns false if this universe isn't sent via shared memory.
+ */
+bool StreamingClient::WriteToRegion(unsigned int universe, uint8_t priority,
+                                    const DmxBuffer &data) {
+  if (!m_region)
+    return false;
+
+  map<unsigned int, unsigned int>::const_iterator iter =
+      m_region_slots.find(universe);
+  if (iter == m_region_slots.end())
+    return false;
+  return m_region->Write(iter->second, priority, data);
+}
+
+/*
+ * Tell olad there is new data in the region.
+ */
+void StreamingClient::RingDoorbell() {
+#ifdef HAVE_SHM_OPEN
+  // If the socket buffer is full, olad has rings pending already so it's
+  // fine to drop this one.
+  const uint8_t ring = 0;
+  int flags = MSG_DONTWAIT;
+#ifdef MSG_NOSIGNAL
+  flags |= MSG_NOSIGNAL;
+#endif  // MSG_NOSIGNAL
+  if (send(m_doorbell_fd, &ring, sizeof(ring), flags) < 0 &&
+      errno != EAGAIN && errno != EWOULDBLOCK) {
+    OLA_WARN << "Failed to ring the doorbell: " << strerror(errno);
+  }
+#endif  // HAVE_SHM_OPEN
+}
+
+void StreamingClient::CloseSharedMemory() {
+  if (m_doorbell_fd >= 0) {
+    close(m_doorbell_fd);
+    m_doorbell_fd = -1;
+  }
+  delete m_region;
+  m_region = NULL;
+  m_region_slots.clear();
+}
+
 void StreamingClient::ChannelClosed(OLA_UNUSED ola::rpc::RpcSession *session) {
   m_socket_closed = true;
   OLA_WARN << "The RPC socket has been closed, this is more than likely due"
@@ -203,6 +203,12 @@ void StreamingClientTest::testSendDMX() {
   OLA_ASSERT_FALSE(ola_client.Setup());
 
   OLA_ASSERT_TRUE(ola_client.SendDmx(TEST_UNIVERSE, buffer));
+
+  // Send a batch of universes
+  ola::client::DMXBatch batch;
+  batch.push_back(ola::client::UniverseDMX(TEST_UNIVERSE, buffer));
+  batch.push_back(ola::client::UniverseDMX(TEST_UNIVERSE + 1, buffer));
+  OLA_ASSERT_TRUE(ola_client.SendDMXBatch(batch));
   ola_client.Stop();
 
   // Now reconnect
@@ -217,6 +223,7 @@ void StreamingClientTest::testSendDMX() {
   m_server_thread->Join();
 
   OLA_ASSERT_FALSE(ola_client.SendDmx(TEST_UNIVERSE, buffer));
+  OLA_ASSERT_FALSE(ola_client.SendDMXBatch(batch));
   ola_client.Stop();
 
   OLA_ASSERT_FALSE(ola_client.Setup());
@@ -0,0 +1,294 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DmxInputWorker.cpp
+ * A worker thread which receives streaming DMX data from clients.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/protocol/Ola.pb.h"
+#include "common/protocol/OlaService.pb.h"
+#include "common/rpc/RpcController.h"
+#include "common/rpc/RpcServer.h"
+#include "common/rpc/RpcSession.h"
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/dmx/SourcePriorities.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/DmxInputWorker.h"
+
+namespace ola {
+
+using ola::proto::DmxData;
+using ola::rpc::RpcController;
+using ola::rpc::RpcServer;
+using ola::rpc::RpcSession;
+using std::pair;
+using std::string;
+using std::vector;
+
+namespace {
+string WorkerName(unsigned int index) {
+  std::ostringstream str;
+  str << "dmx-input-" << index;
+  return str.str();
+}
+}  // namespace
+
+/*
+ * The service used on the worker's connections. Only the streaming DMX methods
+ * are implemented.
+ */
+class DmxInputWorker::WorkerService : public ola::proto::OlaServerService {
+ public:
+  explicit WorkerService(DmxInputWorker *worker) : m_worker(worker) {}
+
+  void StreamDmxData(RpcController *controller,
+                     const DmxData *request,
+                     ola::proto::STREAMING_NO_RESPONSE*,
+                     ola::rpc::RpcService::CompletionCallback*) {
+    m_worker->DataReceived(controller->Session(), *request);
+  }
+
+  void StreamDmxDataBatch(RpcController *controller,
+                          const ola::proto::DmxDataBatch *request,
+                          ola::proto::STREAMING_NO_RESPONSE*,
+                          ola::rpc::RpcService::CompletionCallback*) {
+    google::protobuf::RepeatedPtrField<DmxData>::const_iterator iter =
+        request->data().begin();
+    for (; iter != request->data().end(); ++iter) {
+      m_worker->DataReceived(controller->Session(), *iter);
+    }
+  }
+
+ private:
+  DmxInputWorker *m_worker;
+};
+
+
+DmxInputWorker::DmxInputWorker(unsigned int index,
+                               ola::io::SelectServerInterface *main_ss,
+                               Callback1<void, DmxInputWorker*> *on_data)
+    : Thread(Thread::Options(WorkerName(index))),
+      m_index(index),
+      m_main_ss(main_ss),
+      m_on_data(on_data),
+      m_service(new WorkerService(this)),
+      m_next_source_id(0),
+      m_queue(QUEUE_SIZE),
+      m_wake_up_pending(0),
+      m_blocked(0),
+      m_stopped(false) {
+  // We don't call Init() since the listening socket is owned by the main
+  // thread.
+  m_rpc_server.reset(new RpcServer(&m_ss, m_service.get(), this,
+                                   RpcServer::Options()));
+  m_ss.RunInLoop(NewCallback(this, &DmxInputWorker::Flush));
+}
+
+DmxInputWorker::~DmxInputWorker() {
+  Stop();
+  vector<DmxInputMessage*> messages;
+  TakeMessages(&messages);
+  STLDeleteElements(&messages);
+}
+
+void DmxInputWorker::Stop() {
+  if (m_stopped) {
+    return;
+  }
+
+  if (IsRunning()) {
+    m_ss.Terminate();
+    Join();
+  }
+  m_stopped = true;
+
+  // Now there's only one thread, closing the connections queues the
+  // SOURCE_REMOVED messages in m_outgoing.
+  m_rpc_server.reset();
+  m_ss.DrainCallbacks();
+}
+
+void DmxInputWorker::AddConnection(ola::io::ConnectedDescriptor *descriptor) {
+  m_ss.Execute(NewSingleCallback(this, &DmxInputWorker::AddConnectionInternal,
+                                 descriptor));
+}
+
+void DmxInputWorker::TakeMessages(vector<DmxInputMessage*> *messages) {
+  // Clear the flag before popping, so that anything pushed after this point
+  // causes another wake up.
+  m_wake_up_pending = 0;
+  __sync_synchronize();
+
+  DmxInputMessage *message;
+  while (m_queue.Pop(&message)) {
+    messages->push_back(message);
+  }
+
+  if (m_stopped) {
+    messages->insert(messages->end(), m_outgoing.begin(), m_outgoing.end());
+    m_outgoing.clear();
+    return;
+  }
+
+  __sync_synchronize();
+  if (__sync_bool_compare_and_swap(&m_blocked, 1, 0)) {
+    // The worker ran out of space, now there is some.
+    m_ss.Execute(NewSingleCallback(this, &DmxInputWorker::Flush));
+  }
+}
+
+void DmxInputWorker::DataReceived(RpcSession *session, const DmxData &data) {
+  SessionState *state = reinterpret_cast<SessionState*>(session->GetData());
+  if (!state) {
+    return;
+  }
+
+  if (!state->pending) {
+    state->pending = new DmxInputMessage(DmxInputMessage::DMX_DATA,
+                                         state->source_id);
+    m_dirty_sessions.push_back(state);
+  }
+
+  uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT;
+  if (data.has_priority()) {
+    priority = data.priority();
+    priority = std::max(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MIN),
+                        priority);
+    priority = std::min(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MAX),
+                        priority);
+  }
+
+  // Only the latest frame for each universe is kept.
+  vector<DmxInputMessage::Frame> &frames = state->pending->frames;
+  pair<std::map<unsigned int, unsigned int>::iterator, bool> result =
+      state->frame_index.insert(std::make_pair(data.universe(),
+                                               frames.size()));
+  if (result.second) {
+    frames.push_back(DmxInputMessage::Frame());
+  }
+  DmxInputMessage::Frame &frame = frames[result.first->second];
+  frame.universe = data.universe();
+  frame.priority = priority;
+  frame.buffer.Set(data.data());
+}
+
+void DmxInputWorker::NewClient(RpcSession *session) {
+  SessionState *state = new SessionState();
+  state->source_id = m_next_source_id++;
+  state->pending = NULL;
+  session->SetData(state);
+  m_outgoing.push_back(new DmxInputMessage(DmxInputMessage::SOURCE_ADDED,
+                                           state->source_id));
+}
+
+void DmxInputWorker::ClientRemoved(RpcSession *session) {
+  SessionState *state = reinterpret_cast<SessionState*>(session->GetData());
+  session->SetData(NULL);
+  if (!state) {
+    return;
+  }
+
+  // The last frames must arrive before the client is removed.
+  if (state->pending) {
+    m_dirty_sessions.erase(std::find(m_dirty_sessions.begin(),
+                                     m_dirty_sessions.end(),
+                                     state));
+    m_outgoing.push_back(state->pending);
+  }
+  m_outgoing.push_back(new DmxInputMessage(DmxInputMessage::SOURCE_REMOVED,
+                                           state->source_id));
+  delete state;
+}
+
+void *DmxInputWorker::Run() {
+  OLA_INFO << "DMX input worker " << m_index << " running";
+  m_ss.Run();
+  return NULL;
+}
+
+void DmxInputWorker::AddConnectionInternal(
+    ola::io::ConnectedDescriptor *descriptor) {
+  if (!m_rpc_server.get()) {
+    delete descriptor;
+    return;
+  }
+  m_rpc_server->AddClient(descriptor);
+}
+
+/*
+ * Called on each iteration of the worker's event loop, this passes everything
+ * received during the last iteration to the main thread.
+ */
+void DmxInputWorker::Flush() {
+  bool pushed = false;
+  while (!m_outgoing.empty()) {
+    if (!Push(m_outgoing.front())) {
+      break;
+    }
+    m_outgoing.pop_front();
+    pushed = true;
+  }
+
+  // Ordering only matters between the messages for a single client, and the
+  // control messages are always sent before the data.
+  while (m_outgoing.empty() && !m_dirty_sessions.empty()) {
+    SessionState *state = m_dirty_sessions.back();
+    if (!Push(state->pending)) {
+      break;
+    }
+    state->pending = NULL;
+    state->frame_index.clear();
+    m_dirty_sessions.pop_back();
+    pushed = true;
+  }
+
+  if (pushed) {
+    WakeUpMain();
+  }
+}
+
+bool DmxInputWorker::Push(DmxInputMessage *message) {
+  if (m_queue.Push(message)) {
+    return true;
+  }
+
+  // The queue is full. Ask the main thread to call Flush() once it's taken
+  // the messages, and check again in case it did so in the meantime.
+  m_blocked = 1;
+  __sync_synchronize();
+  return m_queue.Push(message);
+}
+
+void DmxInputWorker::WakeUpMain() {
+  if (__sync_bool_compare_and_swap(&m_wake_up_pending, 0, 1)) {
+    m_main_ss->Execute(
+        NewSingleCallback(this, &DmxInputWorker::RunDataHandler));
+  }
+}
+
+void DmxInputWorker::RunDataHandler() {
+  m_on_data->Run(this);
+}
+}  // namespace ola
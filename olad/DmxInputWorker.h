@@ -0,0 +1,194 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DmxInputWorker.h
+ * A worker thread which receives streaming DMX data from clients.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_DMXINPUTWORKER_H_
+#define OLAD_DMXINPUTWORKER_H_
+
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+#include "ola/io/Descriptor.h"
+#include "ola/io/SelectServer.h"
+#include "ola/rpc/RpcSessionHandler.h"
+#include "ola/thread/SPSCQueue.h"
+#include "ola/thread/Thread.h"
+
+namespace ola {
+
+namespace proto {
+class DmxData;
+}
+
+namespace rpc {
+class RpcServer;
+}
+
+/**
+ * @brief A message passed from a DmxInputWorker to the main thread.
+ */
+struct DmxInputMessage {
+  enum Type {
+    SOURCE_ADDED,  /**< @brief A client connected. */
+    SOURCE_REMOVED,  /**< @brief A client disconnected. */
+    DMX_DATA  /**< @brief A client sent DMX data. */
+  };
+
+  /**
+   * @brief The most recent data for a universe.
+   */
+  struct Frame {
+    unsigned int universe;
+    uint8_t priority;
+    DmxBuffer buffer;
+  };
+
+  DmxInputMessage(Type type, unsigned int source_id)
+      : type(type),
+        source_id(source_id) {
+  }
+
+  Type type;
+  /** @brief Identifies the client, unique within the worker. */
+  unsigned int source_id;
+  /** @brief The frames, if this is a DMX_DATA message. */
+  std::vector<Frame> frames;
+};
+
+
+/**
+ * @brief Receives streaming DMX RPCs on its own thread.
+ *
+ * Each DmxInputWorker runs a SelectServer on a separate thread. Connections
+ * are handed to it with AddConnection(), and from then on the socket reads
+ * and the protobuf decoding happen on the worker's thread. Only StreamDmxData
+ * and StreamDmxDataBatch are supported, all other RPCs fail. The worker
+ * doesn't own any universes, the frames are merged on the main thread.
+ *
+ * Frames received during one iteration of the worker's event loop are
+ * coalesced, so that only the most recent frame for each universe is passed
+ * on. The messages are passed to the main thread using a lock free queue and
+ * the main thread is woken up, at most once per batch, with
+ * SelectServer::Execute(). If the main thread falls behind and the queue
+ * fills, frames continue to be coalesced on the worker until there is space.
+ */
+class DmxInputWorker : public ola::thread::Thread,
+                       public ola::rpc::RpcSessionHandlerInterface {
+ public:
+  /**
+   * @brief Create a new DmxInputWorker.
+   * @param index the index of this worker, used to name the thread.
+   * @param main_ss the SelectServer for the main thread.
+   * @param on_data run on the main thread when there are messages to collect
+   *   with TakeMessages(). Ownership is transferred.
+   */
+  DmxInputWorker(unsigned int index,
+                 ola::io::SelectServerInterface *main_ss,
+                 ola::Callback1<void, DmxInputWorker*> *on_data);
+
+  /**
+   * @brief Destructor.
+   *
+   * The worker must be stopped first. Any messages which haven't been
+   * collected are deleted.
+   */
+  ~DmxInputWorker();
+
+  /**
+   * @brief Stop the worker's thread and close all connections.
+   *
+   * This must be called from the main thread, after which TakeMessages()
+   * returns the final SOURCE_REMOVED messages.
+   */
+  void Stop();
+
+  /**
+   * @brief Hand a new connection to the worker.
+   * @param descriptor the connected descriptor, ownership is transferred.
+   *
+   * This method is thread safe.
+   */
+  void AddConnection(ola::io::ConnectedDescriptor *descriptor);
+
+  /**
+   * @brief Collect the pending messages, called from the main thread.
+   * @param[out] messages the messages are appended here, ownership is
+   *   transferred.
+   */
+  void TakeMessages(std::vector<DmxInputMessage*> *messages);
+
+  /**
+   * @brief Called on the worker's thread when data arrives.
+   */
+  void DataReceived(ola::rpc::RpcSession *session,
+                    const ola::proto::DmxData &data);
+
+  // Called by the RpcServer when clients connect or disconnect.
+  void NewClient(ola::rpc::RpcSession *session);
+  void ClientRemoved(ola::rpc::RpcSession *session);
+
+  static const unsigned int QUEUE_SIZE = 1024;
+
+ protected:
+  void *Run();
+
+ private:
+  class WorkerService;
+
+  struct SessionState {
+    unsigned int source_id;
+    DmxInputMessage *pending;
+    // Maps universe to the index in pending->frames.
+    std::map<unsigned int, unsigned int> frame_index;
+  };
+
+  const unsigned int m_index;
+  ola::io::SelectServerInterface *m_main_ss;
+  std::auto_ptr<ola::Callback1<void, DmxInputWorker*> > m_on_data;
+  ola::io::SelectServer m_ss;
+  std::auto_ptr<WorkerService> m_service;
+  std::auto_ptr<ola::rpc::RpcServer> m_rpc_server;
+  unsigned int m_next_source_id;
+
+  // Only used on the worker's thread.
+  std::deque<DmxInputMessage*> m_outgoing;
+  std::vector<SessionState*> m_dirty_sessions;
+
+  // Shared between the threads.
+  ola::thread::SPSCQueue<DmxInputMessage*> m_queue;
+  volatile int m_wake_up_pending;
+  volatile int m_blocked;
+  bool m_stopped;
+
+  void AddConnectionInternal(ola::io::ConnectedDescriptor *descriptor);
+  void Flush();
+  bool Push(DmxInputMessage *message);
+  void WakeUpMain();
+  void RunDataHandler();
+
+  DISALLOW_COPY_AND_ASSIGN(DmxInputWorker);
+};
+}  // namespace ola
+#endif  // OLAD_DMXINPUTWORKER_H_
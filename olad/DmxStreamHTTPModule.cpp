@@ -0,0 +1,396 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DmxStreamHTTPModule.cpp
+ * Pushes DMX data to web clients using Server-Sent Events.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/DmxStreamHTTPModule.h"
+#include "olad/OladHTTPServer.h"
+
+namespace ola {
+
+using ola::client::DMXMetadata;
+using ola::client::Result;
+using ola::http::HTTPRequest;
+using ola::http::HTTPResponse;
+using ola::http::HTTPServer;
+using ola::http::HTTPStream;
+using std::make_pair;
+using std::ostringstream;
+using std::set;
+using std::string;
+using std::vector;
+
+const char DmxStreamHTTPModule::K_UNIVERSE_PARAMETER[] = "u";
+const char DmxStreamHTTPModule::K_FPS_PARAMETER[] = "fps";
+const TimeInterval DmxStreamHTTPModule::K_FLUSH_INTERVAL(
+    0, 1000000 / DmxStreamHTTPModule::K_MAX_FPS);
+const TimeInterval DmxStreamHTTPModule::K_HEARTBEAT_INTERVAL(15, 0);
+
+/**
+ * @brief Create a new DmxStreamHTTPModule
+ * @param http_server the HTTPServer to register the handler with
+ * @param client the OlaClient to fetch the DMX data with. The DMX callback
+ *   of the client is taken over by this module.
+ */
+DmxStreamHTTPModule::DmxStreamHTTPModule(HTTPServer *http_server,
+                                         ola::client::OlaClient *client)
+    : m_server(http_server),
+      m_client(client),
+      m_flush_timeout(ola::thread::INVALID_TIMEOUT) {
+  m_server->RegisterHandler(
+      "/stream_dmx",
+      NewCallback(this, &DmxStreamHTTPModule::StreamDmx));
+  m_client->SetDMXCallback(NewCallback(this, &DmxStreamHTTPModule::NewDmx));
+}
+
+
+/**
+ * @brief Teardown.
+ *
+ * This is called once the HTTP server thread has stopped, so the universes
+ * aren't unregistered; the client is closing anyway.
+ */
+DmxStreamHTTPModule::~DmxStreamHTTPModule() {
+  if (m_flush_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_server->SelectServer()->RemoveTimeout(m_flush_timeout);
+  }
+
+  ViewerSet::iterator iter = m_viewers.begin();
+  for (; iter != m_viewers.end(); ++iter) {
+    (*iter)->stream->SetOnClose(NULL);
+    (*iter)->stream->Close();
+    delete *iter;
+  }
+  m_viewers.clear();
+  STLDeleteValues(&m_universes);
+  m_client->SetDMXCallback(NULL);
+}
+
+
+/**
+ * @brief Start streaming DMX for one or more universes.
+ * @param request the HTTPRequest
+ * @param response the HTTPResponse
+ * @returns MHD_NO or MHD_YES
+ */
+int DmxStreamHTTPModule::StreamDmx(const HTTPRequest *request,
+                                   HTTPResponse *response) {
+  if (request->CheckParameterExists(OladHTTPServer::HELP_PARAMETER)) {
+    return OladHTTPServer::ServeUsage(
+        response, "?u=[universe],[universe]&amp;fps=[1-40]");
+  }
+
+  vector<string> tokens;
+  StringSplit(request->GetParameter(K_UNIVERSE_PARAMETER), &tokens, ",");
+  set<unsigned int> universes;
+  vector<string>::const_iterator token_iter = tokens.begin();
+  for (; token_iter != tokens.end(); ++token_iter) {
+    unsigned int universe_id;
+    if (!StringToInt(*token_iter, &universe_id)) {
+      return OladHTTPServer::ServeHelpRedirect(response);
+    }
+    universes.insert(universe_id);
+  }
+
+  if (universes.empty() || universes.size() > K_MAX_UNIVERSES) {
+    return OladHTTPServer::ServeHelpRedirect(response);
+  }
+
+  unsigned int fps = K_DEFAULT_FPS;
+  const string fps_str = request->GetParameter(K_FPS_PARAMETER);
+  if (!fps_str.empty() && (!StringToInt(fps_str, &fps) || fps == 0)) {
+    return OladHTTPServer::ServeHelpRedirect(response);
+  }
+  fps = std::min(fps, K_MAX_FPS);
+
+  response->SetContentType("text/event-stream");
+  response->SetNoCache();
+  HTTPStream *stream = m_server->StartStream(response);
+  if (!stream) {
+    // The web UI falls back to polling /get_dmx.
+    OLA_WARN << "Failed to start DMX stream";
+    response->SetStatus(MHD_HTTP_NOT_IMPLEMENTED);
+    response->SetContentType(HTTPServer::CONTENT_TYPE_PLAIN);
+    response->Append("DMX streaming isn't available");
+    int r = response->Send();
+    delete response;
+    return r;
+  }
+  delete response;
+
+  Viewer *viewer = new Viewer();
+  viewer->stream = stream;
+  viewer->min_interval = TimeInterval(0, 1000000 / fps);
+  viewer->last_write = *m_server->SelectServer()->WakeUpTime();
+
+  set<unsigned int>::const_iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    viewer->universes.push_back(ViewerUniverse(*iter));
+    AddUniverse(*iter);
+  }
+  m_viewers.insert(viewer);
+  stream->SetOnClose(
+      NewSingleCallback(this, &DmxStreamHTTPModule::ViewerClosed, viewer));
+
+  if (m_flush_timeout == ola::thread::INVALID_TIMEOUT) {
+    m_flush_timeout = m_server->SelectServer()->RegisterRepeatingTimeout(
+        K_FLUSH_INTERVAL,
+        NewCallback(this, &DmxStreamHTTPModule::Flush));
+  }
+
+  // This gets the headers out straight away, and sets the reconnect time.
+  stream->Send("retry: 1000\n\n");
+  return MHD_YES;
+}
+
+
+/**
+ * @brief Add a viewer of a universe, registering for the data if it's the
+ * first one.
+ */
+void DmxStreamHTTPModule::AddUniverse(unsigned int universe) {
+  UniverseState *state = STLFindOrNull(m_universes, universe);
+  if (!state) {
+    state = new UniverseState();
+    m_universes[universe] = state;
+    m_client->RegisterUniverse(
+        universe, ola::client::REGISTER,
+        NewSingleCallback(this, &DmxStreamHTTPModule::RegisterComplete,
+                          universe));
+    // Registering only gets us changes, so fetch the current data as well.
+    m_client->FetchDMX(
+        universe,
+        NewSingleCallback(this, &DmxStreamHTTPModule::InitialDmx));
+  }
+  state->viewers++;
+}
+
+
+/**
+ * @brief Remove a viewer of a universe, unregistering once there are none
+ * left.
+ */
+void DmxStreamHTTPModule::RemoveUniverse(unsigned int universe) {
+  UniverseMap::iterator iter = m_universes.find(universe);
+  if (iter == m_universes.end()) {
+    return;
+  }
+
+  if (--iter->second->viewers == 0) {
+    delete iter->second;
+    m_universes.erase(iter);
+    m_client->RegisterUniverse(
+        universe, ola::client::UNREGISTER,
+        NewSingleCallback(this, &DmxStreamHTTPModule::RegisterComplete,
+                          universe));
+  }
+}
+
+
+/**
+ * @brief Called when new DMX data arrives for a registered universe.
+ */
+void DmxStreamHTTPModule::NewDmx(const DMXMetadata &metadata,
+                                 const DmxBuffer &data) {
+  UniverseState *state = STLFindOrNull(m_universes, metadata.universe);
+  if (!state || (state->sequence && state->buffer == data)) {
+    return;
+  }
+  state->buffer = data;
+  state->sequence++;
+}
+
+
+/**
+ * @brief Called with the data for a universe when we start watching it.
+ */
+void DmxStreamHTTPModule::InitialDmx(const Result &result,
+                                     const DMXMetadata &metadata,
+                                     const DmxBuffer &data) {
+  if (!result.Success()) {
+    OLA_WARN << "Failed to fetch DMX for universe " << metadata.universe
+             << ": " << result.Error();
+    return;
+  }
+
+  UniverseState *state = STLFindOrNull(m_universes, metadata.universe);
+  // Don't overwrite any newer data that arrived first.
+  if (state && state->sequence == 0) {
+    state->buffer = data;
+    state->sequence++;
+  }
+}
+
+
+void DmxStreamHTTPModule::RegisterComplete(unsigned int universe,
+                                           const Result &result) {
+  if (!result.Success()) {
+    OLA_WARN << "Failed to (un)register universe " << universe << ": "
+             << result.Error();
+  }
+}
+
+
+/**
+ * @brief Called when a client's connection closes.
+ */
+void DmxStreamHTTPModule::ViewerClosed(Viewer *viewer) {
+  vector<ViewerUniverse>::const_iterator iter = viewer->universes.begin();
+  for (; iter != viewer->universes.end(); ++iter) {
+    RemoveUniverse(iter->universe);
+  }
+  m_viewers.erase(viewer);
+  delete viewer;
+
+  if (m_viewers.empty() && m_flush_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_server->SelectServer()->RemoveTimeout(m_flush_timeout);
+    m_flush_timeout = ola::thread::INVALID_TIMEOUT;
+  }
+}
+
+
+/**
+ * @brief Send any changes to the viewers.
+ */
+bool DmxStreamHTTPModule::Flush() {
+  const TimeStamp now = *m_server->SelectServer()->WakeUpTime();
+  EventCache cache;
+  ViewerSet::iterator iter = m_viewers.begin();
+  for (; iter != m_viewers.end(); ++iter) {
+    FlushViewer(*iter, now, &cache);
+  }
+  return true;
+}
+
+
+/**
+ * @brief Send any changes to a single viewer.
+ * @returns true if anything was sent.
+ */
+bool DmxStreamHTTPModule::FlushViewer(Viewer *viewer, const TimeStamp &now,
+                                      EventCache *cache) {
+  // Slow clients are skipped until they catch up, by which time the changes
+  // will have been merged.
+  if (viewer->stream->QueuedBytes() > K_MAX_QUEUED_BYTES ||
+      now - viewer->last_event < viewer->min_interval) {
+    return false;
+  }
+
+  string output;
+  vector<ViewerUniverse>::iterator iter = viewer->universes.begin();
+  for (; iter != viewer->universes.end(); ++iter) {
+    const UniverseState *state = STLFindOrNull(m_universes, iter->universe);
+    if (!state || state->sequence == iter->sequence) {
+      continue;
+    }
+
+    const std::pair<unsigned int, unsigned int> key(iter->universe,
+                                                    iter->sequence);
+    EventCache::const_iterator event = cache->find(key);
+    if (event == cache->end()) {
+      string data;
+      AppendEvent(iter->universe, iter->sent, state->buffer, &data);
+      event = cache->insert(make_pair(key, data)).first;
+    }
+    output.append(event->second);
+    iter->sent = state->buffer;
+    iter->sequence = state->sequence;
+  }
+
+  if (!output.empty()) {
+    viewer->last_event = now;
+  } else if (now - viewer->last_write >= K_HEARTBEAT_INTERVAL) {
+    // This lets us notice clients that have gone away.
+    output = ":\n\n";
+  } else {
+    return false;
+  }
+
+  viewer->stream->Send(output);
+  viewer->last_write = now;
+  return true;
+}
+
+
+/**
+ * @brief Append an event with the slots that differ between two buffers.
+ *
+ * Changes separated by fewer than K_MERGE_GAP unchanged slots are sent as a
+ * single range, since that's shorter than starting a new one. Nothing is
+ * appended if the buffers are the same.
+ */
+void DmxStreamHTTPModule::AppendEvent(unsigned int universe,
+                                      const DmxBuffer &previous,
+                                      const DmxBuffer &current,
+                                      string *output) {
+  const uint8_t *old_data = previous.GetRaw();
+  const uint8_t *new_data = current.GetRaw();
+  const unsigned int old_size = previous.Size();
+  const unsigned int size = current.Size();
+
+  ostringstream str;
+  bool changed = false;
+  unsigned int slot = 0;
+  while (slot < size) {
+    if (slot < old_size && old_data[slot] == new_data[slot]) {
+      slot++;
+      continue;
+    }
+
+    unsigned int last_change = slot;
+    for (unsigned int i = slot + 1;
+         i < size && i - last_change <= K_MERGE_GAP; i++) {
+      if (i >= old_size || old_data[i] != new_data[i]) {
+        last_change = i;
+      }
+    }
+
+    str << (changed ? ",[" : "[") << slot << ",[";
+    for (unsigned int i = slot; i <= last_change; i++) {
+      if (i != slot) {
+        str << ",";
+      }
+      str << static_cast<unsigned int>(new_data[i]);
+    }
+    str << "]]";
+    changed = true;
+    slot = last_change + 1;
+  }
+
+  if (!changed && size == old_size) {
+    return;
+  }
+
+  ostringstream event;
+  event << "event: dmx\ndata: {\"universe\":" << universe << ",\"length\":"
+        << size << ",\"changes\":[" << str.str() << "]}\n\n";
+  output->append(event.str());
+}
+}  // namespace ola
@@ -0,0 +1,147 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DmxStreamHTTPModule.h
+ * Pushes DMX data to web clients using Server-Sent Events.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_DMXSTREAMHTTPMODULE_H_
+#define OLAD_DMXSTREAMHTTPMODULE_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+#include "ola/client/OlaClient.h"
+#include "ola/http/HTTPServer.h"
+#include "ola/thread/SchedulerInterface.h"
+
+class DmxStreamHTTPModuleTest;
+
+namespace ola {
+
+/**
+ * @brief Streams DMX data to web clients.
+ *
+ * A GET of /stream_dmx?u=1,2 returns a text/event-stream response, which
+ * carries a 'dmx' event each time the data for one of the universes changes.
+ * Rather than the full frame, each event only carries the slots which differ
+ * from what that client was last sent:
+ * @code
+ *   event: dmx
+ *   data: {"universe":1,"length":512,"changes":[[0,[255,0]],[40,[12]]]}
+ * @endcode
+ * The first event for each universe covers every slot.
+ *
+ * olad is asked for the data for each universe once, no matter how many
+ * clients are watching it, and the registration is dropped when the last
+ * client goes away. Changes are coalesced so each client gets at most fps
+ * events per second (set with &fps=, default 10), and clients that can't keep
+ * up are skipped until their queued data has drained.
+ *
+ * All methods run on the HTTP server thread.
+ */
+class DmxStreamHTTPModule {
+ public:
+  DmxStreamHTTPModule(ola::http::HTTPServer *http_server,
+                      ola::client::OlaClient *client);
+  ~DmxStreamHTTPModule();
+
+  int StreamDmx(const ola::http::HTTPRequest *request,
+                ola::http::HTTPResponse *response);
+
+ private:
+  struct UniverseState {
+    UniverseState() : sequence(0), viewers(0) {}
+
+    DmxBuffer buffer;
+    // Incremented each time the data changes, 0 means we don't have any data
+    // yet.
+    unsigned int sequence;
+    unsigned int viewers;
+  };
+
+  struct ViewerUniverse {
+    explicit ViewerUniverse(unsigned int _universe)
+        : universe(_universe),
+          sequence(0) {
+    }
+
+    unsigned int universe;
+    // The sequence number of the data in sent.
+    unsigned int sequence;
+    DmxBuffer sent;
+  };
+
+  struct Viewer {
+    ola::http::HTTPStream *stream;
+    TimeInterval min_interval;
+    TimeStamp last_event;
+    TimeStamp last_write;
+    std::vector<ViewerUniverse> universes;
+  };
+
+  typedef std::map<unsigned int, UniverseState*> UniverseMap;
+  typedef std::set<Viewer*> ViewerSet;
+  // Events rendered during a flush, keyed by universe & the sequence the
+  // delta starts from. Viewers with the same starting point share the event.
+  typedef std::map<std::pair<unsigned int, unsigned int>, std::string>
+      EventCache;
+
+  ola::http::HTTPServer *m_server;
+  ola::client::OlaClient *m_client;
+  UniverseMap m_universes;
+  ViewerSet m_viewers;
+  ola::thread::timeout_id m_flush_timeout;
+
+  void AddUniverse(unsigned int universe);
+  void RemoveUniverse(unsigned int universe);
+  void NewDmx(const ola::client::DMXMetadata &metadata,
+              const DmxBuffer &data);
+  void InitialDmx(const ola::client::Result &result,
+                  const ola::client::DMXMetadata &metadata,
+                  const DmxBuffer &data);
+  void RegisterComplete(unsigned int universe,
+                        const ola::client::Result &result);
+  void ViewerClosed(Viewer *viewer);
+  bool Flush();
+  bool FlushViewer(Viewer *viewer, const TimeStamp &now, EventCache *cache);
+
+  static void AppendEvent(unsigned int universe,
+                          const DmxBuffer &previous,
+                          const DmxBuffer &current,
+                          std::string *output);
+
+  static const char K_UNIVERSE_PARAMETER[];
+  static const char K_FPS_PARAMETER[];
+  static const unsigned int K_DEFAULT_FPS = 10;
+  static const unsigned int K_MAX_FPS = 40;
+  static const unsigned int K_MAX_UNIVERSES = 64;
+  static const unsigned int K_MAX_QUEUED_BYTES = 64 * 1024;
+  static const unsigned int K_MERGE_GAP = 4;
+  static const TimeInterval K_FLUSH_INTERVAL;
+  static const TimeInterval K_HEARTBEAT_INTERVAL;
+
+  friend class ::DmxStreamHTTPModuleTest;
+
+  DISALLOW_COPY_AND_ASSIGN(DmxStreamHTTPModule);
+};
+}  // namespace ola
+#endif  // OLAD_DMXSTREAMHTTPMODULE_H_
@@ -0,0 +1,172 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * DmxStreamHTTPModuleTest.cpp
+ * Test fixture for the DmxStreamHTTPModule delta encoding.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+#include "ola/DmxBuffer.h"
+#include "ola/testing/TestUtils.h"
+#include "olad/DmxStreamHTTPModule.h"
+
+using ola::DmxBuffer;
+using ola::DmxStreamHTTPModule;
+using std::string;
+
+class DmxStreamHTTPModuleTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(DmxStreamHTTPModuleTest);
+  CPPUNIT_TEST(testUnchanged);
+  CPPUNIT_TEST(testFirstEvent);
+  CPPUNIT_TEST(testSingleChanges);
+  CPPUNIT_TEST(testMergedRanges);
+  CPPUNIT_TEST(testSizeChanges);
+  CPPUNIT_TEST(testAppends);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testUnchanged();
+  void testFirstEvent();
+  void testSingleChanges();
+  void testMergedRanges();
+  void testSizeChanges();
+  void testAppends();
+
+ private:
+  string Event(unsigned int universe, const DmxBuffer &previous,
+               const DmxBuffer &current) {
+    string output;
+    DmxStreamHTTPModule::AppendEvent(universe, previous, current, &output);
+    return output;
+  }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DmxStreamHTTPModuleTest);
+
+
+/*
+ * Check that nothing is sent if the data hasn't changed.
+ */
+void DmxStreamHTTPModuleTest::testUnchanged() {
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4");
+  OLA_ASSERT_EQ(string(""), Event(1, buffer, buffer));
+
+  DmxBuffer empty;
+  OLA_ASSERT_EQ(string(""), Event(1, empty, empty));
+}
+
+
+/*
+ * The first event for a universe carries all the slots.
+ */
+void DmxStreamHTTPModuleTest::testFirstEvent() {
+  DmxBuffer empty, buffer;
+  buffer.SetFromString("1,2,3,4");
+  OLA_ASSERT_EQ(
+      string("event: dmx\ndata: {\"universe\":3,\"length\":4,"
+             "\"changes\":[[0,[1,2,3,4]]]}\n\n"),
+      Event(3, empty, buffer));
+}
+
+
+/*
+ * Check changes that are far apart are sent as separate ranges.
+ */
+void DmxStreamHTTPModuleTest::testSingleChanges() {
+  DmxBuffer previous, current;
+  previous.SetFromString("0,0,0,0,0,0,0,0,0,0,0,0");
+
+  current.SetFromString("0,0,0,0,0,9,0,0,0,0,0,0");
+  OLA_ASSERT_EQ(
+      string("event: dmx\ndata: {\"universe\":1,\"length\":12,"
+             "\"changes\":[[5,[9]]]}\n\n"),
+      Event(1, previous, current));
+
+  // Four unchanged slots between the changes is enough to split them.
+  current.SetFromString("7,0,0,0,0,8,0,0,0,0,0,6");
+  OLA_ASSERT_EQ(
+      string("event: dmx\ndata: {\"universe\":1,\"length\":12,"
+             "\"changes\":[[0,[7]],[5,[8]],[11,[6]]]}\n\n"),
+      Event(1, previous, current));
+}
+
+
+/*
+ * Check changes separated by fewer than K_MERGE_GAP unchanged slots are sent
+ * as a single range.
+ */
+void DmxStreamHTTPModuleTest::testMergedRanges() {
+  DmxBuffer previous, current;
+  previous.SetFromString("0,0,0,0,0,0,0,0,0,0,0,0");
+
+  current.SetFromString("0,1,0,0,0,2,0,0,0,0,0,0");
+  OLA_ASSERT_EQ(
+      string("event: dmx\ndata: {\"universe\":1,\"length\":12,"
+             "\"changes\":[[1,[1,0,0,0,2]]]}\n\n"),
+      Event(1, previous, current));
+
+  // A run of changes, then one that's too far away to merge.
+  current.SetFromString("1,2,0,3,0,0,0,0,0,4,5,0");
+  OLA_ASSERT_EQ(
+      string("event: dmx\ndata: {\"universe\":1,\"length\":12,"
+             "\"changes\":[[0,[1,2,0,3]],[9,[4,5]]]}\n\n"),
+      Event(1, previous, current));
+}
+
+
+/*
+ * Check a universe that shrinks only sends the new length.
+ */
+void DmxStreamHTTPModuleTest::testSizeChanges() {
+  DmxBuffer previous, current;
+  previous.SetFromString("1,2,3,4,5,6");
+  current.SetFromString("1,2,3");
+  OLA_ASSERT_EQ(
+      string("event: dmx\ndata: {\"universe\":1,\"length\":3,"
+             "\"changes\":[]}\n\n"),
+      Event(1, previous, current));
+
+  // Slots beyond the old length are always sent.
+  OLA_ASSERT_EQ(
+      string("event: dmx\ndata: {\"universe\":1,\"length\":6,"
+             "\"changes\":[[3,[4,5,6]]]}\n\n"),
+      Event(1, current, previous));
+}
+
+
+/*
+ * Check events are appended to the output.
+ */
+void DmxStreamHTTPModuleTest::testAppends() {
+  DmxBuffer empty, buffer1, buffer2;
+  buffer1.SetFromString("1");
+  buffer2.SetFromString("2");
+
+  string output;
+  DmxStreamHTTPModule::AppendEvent(1, empty, buffer1, &output);
+  DmxStreamHTTPModule::AppendEvent(2, empty, buffer2, &output);
+  DmxStreamHTTPModule::AppendEvent(3, buffer2, buffer2, &output);
+  OLA_ASSERT_EQ(
+      string("event: dmx\ndata: {\"universe\":1,\"length\":1,"
+             "\"changes\":[[0,[1]]]}\n\n"
+             "event: dmx\ndata: {\"universe\":2,\"length\":1,"
+             "\"changes\":[[0,[2]]]}\n\n"),
+      output);
+}
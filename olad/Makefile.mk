@@ -13,6 +13,9 @@ ola_server_sources = \
     olad/ClientBroker.h \
     olad/DiscoveryAgent.cpp \
     olad/DiscoveryAgent.h \
+    olad/DmxInputWorker.cpp \
+    olad/DmxInputWorker.h \
+    olad/DmxStreamHTTPModule.h \
     olad/DynamicPluginLoader.cpp \
     olad/DynamicPluginLoader.h \
     olad/HttpServerActions.h \
@@ -22,7 +25,11 @@ ola_server_sources = \
     olad/PluginLoader.h \
     olad/PluginManager.cpp \
     olad/PluginManager.h \
-    olad/RDMHTTPModule.h
+    olad/RDMHTTPModule.h \
+    olad/OffloadedDmxInput.cpp \
+    olad/OffloadedDmxInput.h \
+    olad/SharedMemoryInput.cpp \
+    olad/SharedMemoryInput.h
 ola_server_additional_libs =
 
 if HAVE_DNSSD
@@ -36,7 +43,8 @@ ola_server_additional_libs += $(avahi_LIBS)
 endif
 
 if HAVE_LIBMICROHTTPD
-ola_server_sources += olad/HttpServerActions.cpp \
+ola_server_sources += olad/DmxStreamHTTPModule.cpp \
+                      olad/HttpServerActions.cpp \
                       olad/OladHTTPServer.cpp \
                       olad/RDMHTTPModule.cpp
 ola_server_additional_libs += common/http/libolahttp.la
@@ -88,8 +96,13 @@ COMMON_OLAD_TEST_LDADD = $(COMMON_TESTING_LIBS) $(libprotobuf_LIBS) \
 
 olad_OlaTester_SOURCES = \
     olad/PluginManagerTest.cpp \
-    olad/OlaServerServiceImplTest.cpp
+    olad/OlaServerServiceImplTest.cpp \
+    olad/OffloadedDmxInputTest.cpp
 olad_OlaTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 olad_OlaTester_LDADD = $(COMMON_OLAD_TEST_LDADD)
 
+if HAVE_LIBMICROHTTPD
+olad_OlaTester_SOURCES += olad/DmxStreamHTTPModuleTest.cpp
+endif
+
 CLEANFILES += olad/ola-output.conf
@@ -0,0 +1,211 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * OffloadedDmxInput.cpp
+ * Receives streaming DMX data from clients using a pool of DmxInputWorkers.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/network/Socket.h"
+#include "ola/network/TCPSocket.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/DmxSource.h"
+#include "olad/OffloadedDmxInput.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+namespace ola {
+
+using ola::network::GenericSocketAddress;
+using ola::network::IPV4SocketAddress;
+using ola::network::TCPAcceptingSocket;
+using ola::network::TCPSocket;
+using std::auto_ptr;
+using std::set;
+using std::vector;
+
+OffloadedDmxInput::OffloadedDmxInput(UniverseStore *universe_store,
+                                     const TimeStamp *wake_up_time,
+                                     const ola::rdm::UID &default_uid)
+    : m_universe_store(universe_store),
+      m_wake_up_time(wake_up_time),
+      m_default_uid(default_uid),
+      m_ss(NULL),
+      m_socket_factory(NewCallback(this, &OffloadedDmxInput::NewConnection)),
+      m_next_worker(0) {
+}
+
+OffloadedDmxInput::~OffloadedDmxInput() {
+  if (m_accepting_socket.get()) {
+    m_ss->RemoveReadDescriptor(m_accepting_socket.get());
+    m_accepting_socket->Close();
+  }
+  StopWorkers();
+}
+
+bool OffloadedDmxInput::Init(ola::io::SelectServer *ss,
+                             unsigned int worker_count,
+                             const IPV4SocketAddress &address) {
+  if (m_accepting_socket.get() || worker_count == 0) {
+    return false;
+  }
+
+  auto_ptr<TCPAcceptingSocket> accepting_socket(
+      new TCPAcceptingSocket(&m_socket_factory));
+  if (!accepting_socket->Listen(address)) {
+    OLA_WARN << "Could not listen on the DMX data port " << address;
+    return false;
+  }
+
+  m_ss = ss;
+  for (unsigned int i = 0; i < worker_count; i++) {
+    DmxInputWorker *worker = new DmxInputWorker(
+        i, m_ss, NewCallback(this, &OffloadedDmxInput::MessagesReady, i));
+    if (!worker->Start()) {
+      OLA_WARN << "Failed to start DMX input worker " << i;
+      delete worker;
+      StopWorkers();
+      return false;
+    }
+    m_workers.push_back(worker);
+  }
+
+  if (!m_ss->AddReadDescriptor(accepting_socket.get())) {
+    OLA_WARN << "Failed to add the DMX data socket to the SelectServer";
+    StopWorkers();
+    return false;
+  }
+
+  m_accepting_socket.reset(accepting_socket.release());
+  OLA_INFO << "Receiving DMX data on " << ListenAddress() << " with "
+           << worker_count << " workers";
+  return true;
+}
+
+GenericSocketAddress OffloadedDmxInput::ListenAddress() const {
+  if (m_accepting_socket.get()) {
+    return m_accepting_socket->GetLocalAddress();
+  }
+  return GenericSocketAddress();
+}
+
+void OffloadedDmxInput::NewConnection(TCPSocket *socket) {
+  if (!socket) {
+    return;
+  }
+
+  socket->SetNoDelay();
+  m_workers[m_next_worker]->AddConnection(socket);
+  m_next_worker = (m_next_worker + 1) % m_workers.size();
+}
+
+/*
+ * Called on the main thread when a worker has messages for us.
+ */
+void OffloadedDmxInput::MessagesReady(unsigned int worker_index,
+                                      DmxInputWorker *worker) {
+  vector<DmxInputMessage*> messages;
+  worker->TakeMessages(&messages);
+
+  vector<DmxInputMessage*>::const_iterator iter = messages.begin();
+  for (; iter != messages.end(); ++iter) {
+    HandleMessage(worker_index, **iter);
+  }
+  STLDeleteElements(&messages);
+}
+
+void OffloadedDmxInput::HandleMessage(unsigned int worker_index,
+                                      const DmxInputMessage &message) {
+  const SourceKey key(worker_index, message.source_id);
+  switch (message.type) {
+    case DmxInputMessage::SOURCE_ADDED:
+      STLReplaceAndDelete(&m_clients, key, new Client(NULL, m_default_uid));
+      return;
+    case DmxInputMessage::SOURCE_REMOVED:
+      {
+        Client *client = STLLookupAndRemovePtr(&m_clients, key);
+        if (client) {
+          RemoveClient(client);
+        }
+      }
+      return;
+    case DmxInputMessage::DMX_DATA:
+      break;
+  }
+
+  Client *client = STLFindOrNull(m_clients, key);
+  if (!client) {
+    return;
+  }
+
+  set<Universe*> universes;
+  vector<DmxInputMessage::Frame>::const_iterator iter =
+      message.frames.begin();
+  for (; iter != message.frames.end(); ++iter) {
+    Universe *universe = m_universe_store->GetUniverse(iter->universe);
+    if (!universe) {
+      continue;
+    }
+    DmxSource source(iter->buffer, *m_wake_up_time, iter->priority);
+    client->DMXReceived(iter->universe, source);
+    universes.insert(universe);
+  }
+
+  set<Universe*>::iterator universe_iter = universes.begin();
+  for (; universe_iter != universes.end(); ++universe_iter) {
+    (*universe_iter)->SourceClientDataChanged(client);
+  }
+}
+
+void OffloadedDmxInput::RemoveClient(Client *client) {
+  vector<Universe*> universe_list;
+  m_universe_store->GetList(&universe_list);
+  vector<Universe*>::iterator iter = universe_list.begin();
+  for (; iter != universe_list.end(); ++iter) {
+    (*iter)->RemoveSourceClient(client);
+  }
+  delete client;
+}
+
+void OffloadedDmxInput::StopWorkers() {
+  vector<DmxInputWorker*>::iterator iter = m_workers.begin();
+  for (; iter != m_workers.end(); ++iter) {
+    (*iter)->Stop();
+  }
+
+  // Run any wake ups the workers scheduled, and then collect the final
+  // messages, which remove the clients.
+  if (m_ss) {
+    m_ss->DrainCallbacks();
+  }
+  for (unsigned int i = 0; i < m_workers.size(); i++) {
+    MessagesReady(i, m_workers[i]);
+  }
+
+  ClientMap::iterator client_iter = m_clients.begin();
+  for (; client_iter != m_clients.end(); ++client_iter) {
+    RemoveClient(client_iter->second);
+  }
+  m_clients.clear();
+  STLDeleteElements(&m_workers);
+}
+}  // namespace ola
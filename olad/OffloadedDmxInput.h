@@ -0,0 +1,131 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * OffloadedDmxInput.h
+ * Receives streaming DMX data from clients using a pool of DmxInputWorkers.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_OFFLOADEDDMXINPUT_H_
+#define OLAD_OFFLOADEDDMXINPUT_H_
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/base/Macro.h"
+#include "ola/io/SelectServer.h"
+#include "ola/network/SocketAddress.h"
+#include "ola/network/TCPSocketFactory.h"
+#include "ola/rdm/UID.h"
+#include "olad/DmxInputWorker.h"
+
+namespace ola {
+
+class Client;
+class UniverseStore;
+
+namespace network {
+class TCPAcceptingSocket;
+class TCPSocket;
+}
+
+/**
+ * @brief Offloads the input side of streaming DMX to a pool of worker
+ * threads.
+ *
+ * Connections to the data port are spread across the DmxInputWorkers, which
+ * read and decode the StreamDmxData RPCs on their own threads. The decoded &
+ * coalesced frames are handed back to the main thread, where they're merged
+ * into the universes exactly as if they had arrived on the main RPC port.
+ *
+ * Only the socket reads and the protobuf decoding move off the main thread.
+ * Universes aren't owned by the workers: the merge state and the output ports
+ * remain on the main thread, since the plugins assume they're only called
+ * from there.
+ *
+ * Sharding the universes themselves across workers isn't supported. Every
+ * plugin registers its descriptors and timeouts with the main SelectServer
+ * through the PluginAdaptor, and a device's ports may be patched to
+ * universes that would land on different workers. Output per worker would
+ * need each plugin to be made thread safe first.
+ */
+class OffloadedDmxInput {
+ public:
+  /**
+   * @brief Create a new OffloadedDmxInput.
+   * @param universe_store the UniverseStore to lookup universes in.
+   * @param wake_up_time the time the main SelectServer woke up.
+   * @param default_uid the UID to use for the clients.
+   */
+  OffloadedDmxInput(UniverseStore *universe_store,
+                    const TimeStamp *wake_up_time,
+                    const ola::rdm::UID &default_uid);
+
+  /**
+   * @brief Stop the workers & remove all the clients.
+   */
+  ~OffloadedDmxInput();
+
+  /**
+   * @brief Start the workers and listen for connections.
+   * @param ss the main SelectServer.
+   * @param worker_count the number of workers to run.
+   * @param address the address to listen on.
+   * @returns true if the input is ready, false otherwise.
+   */
+  bool Init(ola::io::SelectServer *ss,
+            unsigned int worker_count,
+            const ola::network::IPV4SocketAddress &address);
+
+  /**
+   * @brief The address we're listening on.
+   */
+  ola::network::GenericSocketAddress ListenAddress() const;
+
+  /**
+   * @brief The number of clients connected to the data port.
+   */
+  unsigned int ClientCount() const { return m_clients.size(); }
+
+ private:
+  // The worker index and source id.
+  typedef std::pair<unsigned int, unsigned int> SourceKey;
+  typedef std::map<SourceKey, Client*> ClientMap;
+
+  UniverseStore *m_universe_store;
+  const TimeStamp *m_wake_up_time;
+  const ola::rdm::UID m_default_uid;
+  ola::io::SelectServer *m_ss;
+  ola::network::TCPSocketFactory m_socket_factory;
+  std::auto_ptr<ola::network::TCPAcceptingSocket> m_accepting_socket;
+  std::vector<DmxInputWorker*> m_workers;
+  unsigned int m_next_worker;
+  ClientMap m_clients;
+
+  void NewConnection(ola::network::TCPSocket *socket);
+  void MessagesReady(unsigned int worker_index, DmxInputWorker *worker);
+  void HandleMessage(unsigned int worker_index,
+                     const DmxInputMessage &message);
+  void RemoveClient(Client *client);
+  void StopWorkers();
+
+  DISALLOW_COPY_AND_ASSIGN(OffloadedDmxInput);
+};
+}  // namespace ola
+#endif  // OLAD_OFFLOADEDDMXINPUT_H_
@@ -0,0 +1,210 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * OffloadedDmxInputTest.cpp
+ * Test fixture for the OffloadedDmxInput class
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+
+#include "ola/Clock.h"
+#include "ola/Constants.h"
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "ola/client/StreamingClient.h"
+#include "ola/io/SelectServer.h"
+#include "ola/network/IPV4Address.h"
+#include "ola/network/SocketAddress.h"
+#include "ola/rdm/UID.h"
+#include "ola/testing/TestUtils.h"
+#include "olad/OffloadedDmxInput.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+using ola::DmxBuffer;
+using ola::OffloadedDmxInput;
+using ola::TimeInterval;
+using ola::Universe;
+using ola::UniverseStore;
+using ola::client::StreamingClient;
+using ola::io::SelectServer;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
+
+class OffloadedDmxInputTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(OffloadedDmxInputTest);
+  CPPUNIT_TEST(testStreamDmx);
+  CPPUNIT_TEST(testMultipleClients);
+  CPPUNIT_TEST(testPriority);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  OffloadedDmxInputTest()
+      : m_uid(ola::OPEN_LIGHTING_ESTA_CODE, 0),
+        m_store(NULL, NULL) {
+  }
+
+  void setUp();
+  void tearDown();
+
+  void testStreamDmx();
+  void testMultipleClients();
+  void testPriority();
+
+ private:
+  ola::rdm::UID m_uid;
+  SelectServer m_ss;
+  UniverseStore m_store;
+  std::auto_ptr<OffloadedDmxInput> m_input;
+  Universe *m_universe1;
+  Universe *m_universe2;
+
+  StreamingClient *NewClient();
+  bool RunUntil(Universe *universe, const DmxBuffer &expected);
+  bool RunUntilSources(Universe *universe, unsigned int count);
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(OffloadedDmxInputTest);
+
+void OffloadedDmxInputTest::setUp() {
+  ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  m_universe1 = m_store.GetUniverseOrCreate(1);
+  m_universe2 = m_store.GetUniverseOrCreate(2);
+  m_input.reset(new OffloadedDmxInput(&m_store, m_ss.WakeUpTime(), m_uid));
+  OLA_ASSERT_TRUE(m_input->Init(
+      &m_ss, 2, IPV4SocketAddress(IPV4Address::Loopback(), 0)));
+}
+
+void OffloadedDmxInputTest::tearDown() {
+  m_input.reset();
+  m_store.DeleteAll();
+}
+
+/*
+ * Create a new client connected to the data port.
+ */
+StreamingClient *OffloadedDmxInputTest::NewClient() {
+  IPV4SocketAddress address = m_input->ListenAddress().V4Addr();
+
+  StreamingClient::Options options;
+  options.auto_start = false;
+  options.server_port = address.Port();
+  StreamingClient *client = new StreamingClient(options);
+  OLA_ASSERT_TRUE(client->Setup());
+  return client;
+}
+
+/*
+ * Run the main loop until the universe has the expected data.
+ */
+bool OffloadedDmxInputTest::RunUntil(Universe *universe,
+                                     const DmxBuffer &expected) {
+  for (unsigned int i = 0; i < 200; i++) {
+    if (universe->GetDMX() == expected) {
+      return true;
+    }
+    m_ss.RunOnce(TimeInterval(0, 10000));
+  }
+  return false;
+}
+
+/*
+ * Run the main loop until the universe has the expected number of source
+ * clients.
+ */
+bool OffloadedDmxInputTest::RunUntilSources(Universe *universe,
+                                            unsigned int count) {
+  for (unsigned int i = 0; i < 200; i++) {
+    if (universe->SourceClientCount() == count) {
+      return true;
+    }
+    m_ss.RunOnce(TimeInterval(0, 10000));
+  }
+  return false;
+}
+
+/*
+ * Check that data sent to the data port ends up in the universe, and that the
+ * client is removed when it disconnects.
+ */
+void OffloadedDmxInputTest::testStreamDmx() {
+  std::auto_ptr<StreamingClient> client(NewClient());
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4");
+  OLA_ASSERT_TRUE(client->SendDmx(1, buffer));
+  OLA_ASSERT_TRUE(RunUntil(m_universe1, buffer));
+  OLA_ASSERT_EQ(1u, m_universe1->SourceClientCount());
+  OLA_ASSERT_EQ(1u, m_input->ClientCount());
+
+  // Data for a universe that doesn't exist is ignored.
+  OLA_ASSERT_TRUE(client->SendDmx(99, buffer));
+  buffer.SetFromString("5,6,7");
+  OLA_ASSERT_TRUE(client->SendDmx(1, buffer));
+  OLA_ASSERT_TRUE(RunUntil(m_universe1, buffer));
+  OLA_ASSERT_NULL(m_store.GetUniverse(99));
+
+  client->Stop();
+  OLA_ASSERT_TRUE(RunUntilSources(m_universe1, 0));
+  OLA_ASSERT_EQ(0u, m_input->ClientCount());
+}
+
+/*
+ * Check clients on different workers are merged.
+ */
+void OffloadedDmxInputTest::testMultipleClients() {
+  m_universe2->SetMergeMode(Universe::MERGE_HTP);
+  std::auto_ptr<StreamingClient> client1(NewClient());
+  std::auto_ptr<StreamingClient> client2(NewClient());
+
+  DmxBuffer buffer1, buffer2;
+  buffer1.SetFromString("10,0,30");
+  buffer2.SetFromString("0,20,5");
+  OLA_ASSERT_TRUE(client1->SendDmx(2, buffer1));
+  OLA_ASSERT_TRUE(client2->SendDmx(2, buffer2));
+
+  DmxBuffer merged;
+  merged.SetFromString("10,20,30");
+  OLA_ASSERT_TRUE(RunUntil(m_universe2, merged));
+  OLA_ASSERT_EQ(2u, m_universe2->SourceClientCount());
+  OLA_ASSERT_EQ(2u, m_input->ClientCount());
+
+  // Remove one client, only the other's data is used from now on.
+  client1->Stop();
+  OLA_ASSERT_TRUE(RunUntilSources(m_universe2, 1));
+  OLA_ASSERT_TRUE(client2->SendDmx(2, buffer2));
+  OLA_ASSERT_TRUE(RunUntil(m_universe2, buffer2));
+
+  // The remaining clients are removed when the input is deleted.
+  m_input.reset();
+  OLA_ASSERT_EQ(0u, m_universe2->SourceClientCount());
+}
+
+/*
+ * Check the priority is passed through.
+ */
+void OffloadedDmxInputTest::testPriority() {
+  std::auto_ptr<StreamingClient> client(NewClient());
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3");
+  StreamingClient::SendArgs args;
+  args.priority = 150;
+  OLA_ASSERT_TRUE(client->SendDMX(1, buffer, args));
+  OLA_ASSERT_TRUE(RunUntil(m_universe1, buffer));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(150), m_universe1->ActivePriority());
+}
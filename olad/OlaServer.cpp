@@ -38,8 +38,10 @@
 #include "ola/ExportMap.h"
 #include "ola/Logging.h"
 #include "ola/base/Flags.h"
+#include "ola/network/IPV4Address.h"
 #include "ola/network/InterfacePicker.h"
 #include "ola/network/Socket.h"
+#include "ola/network/SocketAddress.h"
 #include "ola/rdm/PidStore.h"
 #include "ola/rdm/UID.h"
 #include "ola/stl/STLUtils.h"
@@ -53,6 +55,7 @@
 #include "olad/Port.h"
 #include "olad/PortBroker.h"
 #include "olad/Preferences.h"
+#include "olad/OffloadedDmxInput.h"
 #include "olad/Universe.h"
 #include "olad/plugin_api/Client.h"
 #include "olad/plugin_api/DeviceManager.h"
@@ -65,12 +68,42 @@
 
 DEFINE_s_uint16(rpc_port, r, ola::OlaServer::DEFAULT_RPC_PORT,
                 "The port to listen for RPCs on. Defaults to 9010.");
+DEFINE_uint32(dmx_input_threads, 0,
+              "The number of threads used to read and decode streaming DMX "
+              "data on the DMX data port. Merging and output stay on the main "
+              "thread. 0 disables the data port.");
+DEFINE_uint16(dmx_port, ola::OlaServer::DEFAULT_DMX_PORT,
+              "The port to listen for streaming DMX data on, if "
+              "--dmx-input-threads is set. Defaults to 9011.");
+DEFINE_uint32(http_threads, 0,
+              "The number of threads libmicrohttpd uses to handle HTTP "
+              "connections. 0 handles them on the HTTP server thread.");
+DEFINE_uint32(rdm_max_in_flight, 1,
+              "The maximum number of RDM requests olad passes to each port "
+              "before the earlier ones complete.");
+DEFINE_uint32(rdm_min_dmx_fps, 0,
+              "While DMX is being sent to a port, only send one RDM request "
+              "per 1 / rdm-min-dmx-fps seconds so DMX frames can be sent in "
+              "between. 0 disables this.");
+DEFINE_uint32(output_max_fps, 0,
+              "The maximum rate DMX frames are written to each output port. "
+              "Newer frames replace any frame waiting to be written. 0 "
+              "disables this.");
+DEFINE_uint32(output_keepalive_fps, 0,
+              "The minimum rate DMX frames are written to each output port, "
+              "the last frame is repeated if no new frames arrive. 0 "
+              "disables this.");
+DEFINE_uint32(output_duplicate_window_ms, 0,
+              "Skip DMX frames identical to the last frame written to an "
+              "output port within this many milliseconds. 0 disables this.");
 DEFINE_default_bool(register_with_dns_sd, true,
                     "Don't register the web service using DNS-SD (Bonjour).");
 
 namespace ola {
 
 using ola::proto::OlaClientService_Stub;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
 using ola::rdm::RootPidStore;
 using ola::rpc::RpcChannel;
 using ola::rpc::RpcSession;
@@ -123,6 +156,7 @@ OlaServer::~OlaServer() {
   // Order is important during shutdown.
   // Shutdown the RPC server first since it depends on almost everything else.
   m_rpc_server.reset();
+  m_offloaded_input.reset();
 
   if (m_housekeeping_timeout != ola::thread::INVALID_TIMEOUT) {
     m_ss->RemoveTimeout(m_housekeeping_timeout);
@@ -211,6 +245,15 @@ bool OlaServer::Init() {
 
   auto_ptr<UniverseStore> universe_store(
       new UniverseStore(universe_preferences, m_export_map));
+  RDMSchedulerOptions rdm_scheduler_options;
+  rdm_scheduler_options.max_in_flight = FLAGS_rdm_max_in_flight;
+  rdm_scheduler_options.min_dmx_fps = FLAGS_rdm_min_dmx_fps;
+  universe_store->SetRDMSchedulerOptions(m_ss, rdm_scheduler_options);
+  OutputPacerOptions output_pacer_options;
+  output_pacer_options.max_fps = FLAGS_output_max_fps;
+  output_pacer_options.keepalive_fps = FLAGS_output_keepalive_fps;
+  output_pacer_options.duplicate_window_ms = FLAGS_output_duplicate_window_ms;
+  universe_store->SetOutputPacerOptions(m_ss, output_pacer_options);
 
   auto_ptr<PortBroker> port_broker(new PortBroker());
 
@@ -237,7 +280,8 @@ bool OlaServer::Init() {
       port_manager.get(),
       broker.get(),
       m_ss->WakeUpTime(),
-      NewCallback(this, &OlaServer::ReloadPluginsInternal)));
+      NewCallback(this, &OlaServer::ReloadPluginsInternal),
+      m_ss));
 
   // Initialize the RPC server.
   RpcServer::Options rpc_options;
@@ -253,6 +297,19 @@ bool OlaServer::Init() {
     return false;
   }
 
+  auto_ptr<OffloadedDmxInput> offloaded_input;
+  if (FLAGS_dmx_input_threads) {
+    offloaded_input.reset(new OffloadedDmxInput(universe_store.get(),
+                                                m_ss->WakeUpTime(),
+                                                m_default_uid));
+    if (!offloaded_input->Init(
+          m_ss, FLAGS_dmx_input_threads,
+          IPV4SocketAddress(IPV4Address::Loopback(), FLAGS_dmx_port))) {
+      OLA_WARN << "Failed to init the DMX data port";
+      return false;
+    }
+  }
+
   // Discovery
   auto_ptr<DiscoveryAgentInterface> discovery_agent;
   if (FLAGS_register_with_dns_sd) {
@@ -303,6 +360,7 @@ bool OlaServer::Init() {
   m_port_broker.reset(port_broker.release());
   m_port_manager.reset(port_manager.release());
   m_rpc_server.reset(rpc_server.release());
+  m_offloaded_input.reset(offloaded_input.release());
   m_service_impl.reset(service_impl.release());
   m_universe_store.reset(universe_store.release());
 
@@ -366,6 +424,7 @@ void OlaServer::ClientRemoved(RpcSession *session) {
   session->SetData(NULL);
 
   m_broker->RemoveClient(client.get());
+  m_service_impl->ClientRemoved(client.get());
 
   vector<Universe*> universe_list;
   m_universe_store->GetList(&universe_list);
@@ -424,6 +483,7 @@ bool OlaServer::StartHttpServer(ola::rpc::RpcServer *server,
   options.data_dir = (m_options.http_data_dir.empty() ? HTTP_DATA_DIR :
                       m_options.http_data_dir);
   options.enable_quit = m_options.http_enable_quit;
+  options.thread_pool_size = FLAGS_http_threads;
 
   auto_ptr<OladHTTPServer> httpd(
       new OladHTTPServer(m_export_map, options,
@@ -162,6 +162,8 @@ class OlaServer : public ola::rpc::RpcSessionHandlerInterface {
 
   static const unsigned int DEFAULT_RPC_PORT = OLA_DEFAULT_PORT;
 
+  static const unsigned int DEFAULT_DMX_PORT = OLA_DEFAULT_PORT + 1;
+
  private :
   struct ClientEntry {
     ola::io::ConnectedDescriptor *client_descriptor;
@@ -193,6 +195,7 @@ class OlaServer : public ola::rpc::RpcSessionHandlerInterface {
   std::auto_ptr<const ola::rdm::RootPidStore> m_pid_store;
   std::auto_ptr<class DiscoveryAgentInterface> m_discovery_agent;
   std::auto_ptr<ola::rpc::RpcServer> m_rpc_server;
+  std::auto_ptr<class OffloadedDmxInput> m_offloaded_input;
   class Preferences *m_server_preferences;
   class Preferences *m_universe_preferences;
   std::string m_instance_name;
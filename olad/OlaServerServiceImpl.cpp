@@ -20,6 +20,7 @@
  */
 
 #include <algorithm>
+#include <set>
 #include <string>
 #include <vector>
 #include "common/protocol/Ola.pb.h"
@@ -30,6 +31,7 @@
 #include "ola/Logging.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/UIDSet.h"
+#include "ola/stl/STLUtils.h"
 #include "ola/strings/Format.h"
 #include "ola/timecode/TimeCode.h"
 #include "ola/timecode/TimeCodeEnums.h"
@@ -40,6 +42,7 @@
 #include "olad/Plugin.h"
 #include "olad/PluginManager.h"
 #include "olad/Port.h"
+#include "olad/SharedMemoryInput.h"
 #include "olad/Universe.h"
 #include "olad/plugin_api/Client.h"
 #include "olad/plugin_api/DeviceManager.h"
@@ -48,6 +51,7 @@
 
 namespace ola {
 
+using google::protobuf::RepeatedPtrField;
 using ola::CallbackRunner;
 using ola::proto::Ack;
 using ola::proto::DeviceConfigReply;
@@ -66,6 +70,8 @@ using ola::proto::PluginListReply;
 using ola::proto::PluginListRequest;
 using ola::proto::PortInfo;
 using ola::proto::RegisterDmxRequest;
+using ola::proto::SharedMemoryReply;
+using ola::proto::SharedMemoryRequest;
 using ola::proto::UniverseInfo;
 using ola::proto::UniverseInfoReply;
 using ola::proto::UniverseNameRequest;
@@ -75,6 +81,7 @@ using ola::rdm::RDMResponse;
 using ola::rdm::UID;
 using ola::rdm::UIDSet;
 using ola::rpc::RpcController;
+using std::set;
 using std::string;
 using std::vector;
 
@@ -104,6 +111,12 @@ RDMRequest::OverrideOptions RDMRequestOptionsFromProto(
   if (proto_options.has_checksum()) {
     options.SetChecksum(proto_options.checksum());
   }
+  if (proto_options.has_bypass_cache()) {
+    options.bypass_cache = proto_options.bypass_cache();
+  }
+  if (proto_options.has_background()) {
+    options.background = proto_options.background();
+  }
   return options;
 }
 }  // namespace
@@ -117,14 +130,24 @@ OlaServerServiceImpl::OlaServerServiceImpl(
     PortManager *port_manager,
     ClientBroker *broker,
     const TimeStamp *wake_up_time,
-    ReloadPluginsCallback *reload_plugins_callback)
+    ReloadPluginsCallback *reload_plugins_callback,
+    ola::io::SelectServerInterface *ss)
     : m_universe_store(universe_store),
       m_device_manager(device_manager),
       m_plugin_manager(plugin_manager),
       m_port_manager(port_manager),
       m_broker(broker),
       m_wake_up_time(wake_up_time),
-      m_reload_plugins_callback(reload_plugins_callback) {
+      m_reload_plugins_callback(reload_plugins_callback),
+      m_ss(ss) {
+}
+
+OlaServerServiceImpl::~OlaServerServiceImpl() {
+  STLDeleteValues(&m_shared_memory_inputs);
+}
+
+void OlaServerServiceImpl::ClientRemoved(Client *client) {
+  STLRemoveAndDelete(&m_shared_memory_inputs, client);
 }
 
 void OlaServerServiceImpl::GetDmx(
@@ -157,6 +180,9 @@ void OlaServerServiceImpl::RegisterForDmx(
 
   Client *client = GetClient(controller);
   if (request->action() == ola::proto::REGISTER) {
+    if (client) {
+      client->SetStreamDMX(request->stream_data());
+    }
     universe->AddSinkClient(client);
   } else {
     universe->RemoveSinkClient(client);
@@ -175,19 +201,7 @@ void OlaServerServiceImpl::UpdateDmxData(
   }
 
   Client *client = GetClient(controller);
-  DmxBuffer buffer;
-  buffer.Set(request->data());
-
-  uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT;
-  if (request->has_priority()) {
-    priority = request->priority();
-    priority = std::max(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MIN),
-                        priority);
-    priority = std::min(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MAX),
-                        priority);
-  }
-  DmxSource source(buffer, *m_wake_up_time, priority);
-  client->DMXReceived(request->universe(), source);
+  DmxDataReceived(client, *request);
   universe->SourceClientDataChanged(client);
 }
 
@@ -203,20 +217,67 @@ void OlaServerServiceImpl::StreamDmxData(
   }
 
   Client *client = GetClient(controller);
-  DmxBuffer buffer;
-  buffer.Set(request->data());
+  DmxDataReceived(client, *request);
+  universe->SourceClientDataChanged(client);
+}
 
-  uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT;
-  if (request->has_priority()) {
-    priority = request->priority();
-    priority = std::max(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MIN),
-                        priority);
-    priority = std::min(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MAX),
-                        priority);
+void OlaServerServiceImpl::StreamDmxDataBatch(
+    RpcController *controller,
+    const ola::proto::DmxDataBatch* request,
+    ola::proto::STREAMING_NO_RESPONSE*,
+    ola::rpc::RpcService::CompletionCallback*) {
+  Client *client = GetClient(controller);
+  set<Universe*> universes;
+
+  RepeatedPtrField<DmxData>::const_iterator iter = request->data().begin();
+  for (; iter != request->data().end(); ++iter) {
+    Universe *universe = m_universe_store->GetUniverse(iter->universe());
+    if (!universe) {
+      continue;
+    }
+    DmxDataReceived(client, *iter);
+    universes.insert(universe);
+  }
+
+  set<Universe*>::iterator universe_iter = universes.begin();
+  for (; universe_iter != universes.end(); ++universe_iter) {
+    (*universe_iter)->SourceClientDataChanged(client);
   }
-  DmxSource source(buffer, *m_wake_up_time, priority);
-  client->DMXReceived(request->universe(), source);
-  universe->SourceClientDataChanged(client);
+}
+
+void OlaServerServiceImpl::OpenSharedMemory(
+    RpcController* controller,
+    const SharedMemoryRequest* request,
+    SharedMemoryReply* response,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  ClosureRunner runner(done);
+  Client *client = GetClient(controller);
+  if (!m_ss || !client) {
+    controller->SetFailed("Shared memory isn't available");
+    return;
+  }
+
+  if (request->universe_size() == 0 ||
+      static_cast<unsigned int>(request->universe_size()) >
+      ola::dmx::SharedDmxRegion::MAX_SLOTS) {
+    controller->SetFailed("Invalid number of universes");
+    return;
+  }
+
+  vector<unsigned int> universes(request->universe().begin(),
+                                 request->universe().end());
+  // Remove the old region first, in case the client is replacing it.
+  STLRemoveAndDelete(&m_shared_memory_inputs, client);
+  std::auto_ptr<SharedMemoryInput> input(new SharedMemoryInput(
+      client, m_universe_store, m_wake_up_time, universes));
+  if (!input->Init(m_ss)) {
+    controller->SetFailed("Failed to create the shared memory region");
+    return;
+  }
+
+  response->set_region_name(input->RegionName());
+  response->set_doorbell_path(input->DoorbellPath());
+  m_shared_memory_inputs[client] = input.release();
 }
 
 void OlaServerServiceImpl::SetUniverseName(
@@ -727,6 +788,10 @@ void OlaServerServiceImpl::RDMCommand(
                   request->uid().device_id());
 
   RDMRequest::OverrideOptions options = RDMRequestOptionsFromProto(*request);
+  if (request->include_raw_response()) {
+    // Cached responses don't have the raw frames.
+    options.bypass_cache = true;
+  }
 
   ola::rdm::RDMRequest *rdm_request = NULL;
   if (request->is_set()) {
@@ -937,6 +1002,27 @@ void OlaServerServiceImpl::RDMDiscoveryComplete(
 }
 
 
+/*
+ * Store the DMX data from a client, the universe isn't updated.
+ */
+void OlaServerServiceImpl::DmxDataReceived(Client *client,
+                                           const DmxData &request) {
+  DmxBuffer buffer;
+  buffer.Set(request.data());
+
+  uint8_t priority = ola::dmx::SOURCE_PRIORITY_DEFAULT;
+  if (request.has_priority()) {
+    priority = request.priority();
+    priority = std::max(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MIN),
+                        priority);
+    priority = std::min(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MAX),
+                        priority);
+  }
+  DmxSource source(buffer, *m_wake_up_time, priority);
+  client->DMXReceived(request.universe(), source);
+}
+
+
 void OlaServerServiceImpl::MissingUniverseError(RpcController* controller) {
   controller->SetFailed("Universe doesn't exist");
 }
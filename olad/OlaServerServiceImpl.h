@@ -18,12 +18,14 @@
  * Copyright (C) 2005 Simon Newton
  */
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 #include "common/protocol/Ola.pb.h"
 #include "common/protocol/OlaService.pb.h"
 #include "ola/Callback.h"
+#include "ola/io/SelectServerInterface.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/RDMControllerInterface.h"
 #include "ola/rdm/UID.h"
@@ -56,6 +58,8 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
 
   /**
    * @brief Create a new OlaServerServiceImpl.
+   *
+   * If ss is NULL, clients can't send DMX data via shared memory.
    */
   OlaServerServiceImpl(class UniverseStore *universe_store,
                        class DeviceManager *device_manager,
@@ -63,9 +67,17 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
                        class PortManager *port_manager,
                        class ClientBroker *broker,
                        const class TimeStamp *wake_up_time,
-                       ReloadPluginsCallback *reload_plugins_callback);
+                       ReloadPluginsCallback *reload_plugins_callback,
+                       ola::io::SelectServerInterface *ss = NULL);
 
-  ~OlaServerServiceImpl() {}
+  ~OlaServerServiceImpl();
+
+  /**
+   * @brief Called when a client disconnects.
+   *
+   * This must be called before the client is deleted.
+   */
+  void ClientRemoved(class Client *client);
 
   /**
    * @brief Returns the current DMX values for a particular universe.
@@ -98,6 +110,27 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
                      const ::ola::proto::DmxData* request,
                      ::ola::proto::STREAMING_NO_RESPONSE* response,
                      ola::rpc::RpcService::CompletionCallback* done);
+  /**
+   * @brief Handle a streaming DMX update for many universes, no response is
+   * sent.
+   *
+   * The dependants of each universe are updated once, after all the data in
+   * the batch has been applied.
+   */
+  void StreamDmxDataBatch(ola::rpc::RpcController* controller,
+                          const ::ola::proto::DmxDataBatch* request,
+                          ::ola::proto::STREAMING_NO_RESPONSE* response,
+                          ola::rpc::RpcService::CompletionCallback* done);
+
+  /**
+   * @brief Create a shared memory region the client can write DMX data to.
+   *
+   * Any previous region for the client is removed.
+   */
+  void OpenSharedMemory(ola::rpc::RpcController* controller,
+                        const ola::proto::SharedMemoryRequest* request,
+                        ola::proto::SharedMemoryReply* response,
+                        ola::rpc::RpcService::CompletionCallback* done);
 
 
   /**
@@ -269,6 +302,9 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
                             ola::proto::UIDListReply *response,
                             const ola::rdm::UIDSet &uids);
 
+  void DmxDataReceived(class Client *client,
+                       const ola::proto::DmxData &request);
+
   void MissingUniverseError(ola::rpc::RpcController* controller);
   void MissingPluginError(ola::rpc::RpcController* controller);
   void MissingDeviceError(ola::rpc::RpcController* controller);
@@ -297,6 +333,8 @@ class OlaServerServiceImpl : public ola::proto::OlaServerService {
   class ClientBroker *m_broker;
   const class TimeStamp *m_wake_up_time;
   std::auto_ptr<ReloadPluginsCallback> m_reload_plugins_callback;
+  ola::io::SelectServerInterface *m_ss;
+  std::map<class Client*, class SharedMemoryInput*> m_shared_memory_inputs;
 };
 }  // namespace ola
 #endif  // OLAD_OLASERVERSERVICEIMPL_H_
@@ -22,9 +22,22 @@
  *  series of Check objects which validate the rpc response.
  */
 
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif
+
 #include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef HAVE_SHM_OPEN
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif  // HAVE_SHM_OPEN
+#include <memory>
 #include <string>
 
+#include "common/dmx/SharedDmxRegion.h"
+
 #include "common/rpc/RpcController.h"
 #include "common/rpc/RpcSession.h"
 #include "ola/Callback.h"
@@ -33,6 +46,7 @@
 #include "ola/DmxBuffer.h"
 #include "ola/ExportMap.h"
 #include "ola/Logging.h"
+#include "ola/io/SelectServer.h"
 #include "ola/rdm/UID.h"
 #include "ola/testing/TestUtils.h"
 #include "olad/OlaServerServiceImpl.h"
@@ -58,6 +72,8 @@ class OlaServerServiceImplTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testGetDmx);
   CPPUNIT_TEST(testRegisterForDmx);
   CPPUNIT_TEST(testUpdateDmxData);
+  CPPUNIT_TEST(testStreamDmxDataBatch);
+  CPPUNIT_TEST(testOpenSharedMemory);
   CPPUNIT_TEST(testSetUniverseName);
   CPPUNIT_TEST(testSetMergeMode);
   CPPUNIT_TEST_SUITE_END();
@@ -74,6 +90,8 @@ class OlaServerServiceImplTest: public CppUnit::TestFixture {
     void testGetDmx();
     void testRegisterForDmx();
     void testUpdateDmxData();
+    void testStreamDmxDataBatch();
+    void testOpenSharedMemory();
     void testSetUniverseName();
     void testSetMergeMode();
 
@@ -422,6 +440,155 @@ void OlaServerServiceImplTest::CallUpdateDmxData(
   service->UpdateDmxData(&controller, &request, &response, closure);
 }
 
+/*
+ * Check the StreamDmxDataBatch method works
+ */
+void OlaServerServiceImplTest::testStreamDmxDataBatch() {
+  ola::ExportMap export_map;
+  UniverseStore store(NULL, &export_map);
+  ola::TimeStamp time1;
+  ola::Client client(NULL, m_uid);
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL,
+                               &time1, NULL);
+
+  DmxBuffer dmx_data("this is a test");
+  DmxBuffer dmx_data2("different data hmm");
+  Universe *universe1 = store.GetUniverseOrCreate(1);
+  Universe *universe2 = store.GetUniverseOrCreate(2);
+
+  ola::proto::DmxDataBatch request;
+  // universe 1 appears twice, the last update wins
+  const unsigned int universe_ids[] = {1, 2, 3, 1};
+  const DmxBuffer *buffers[] = {&dmx_data, &dmx_data, &dmx_data, &dmx_data2};
+  for (unsigned int i = 0; i < 4; i++) {
+    ola::proto::DmxData *data = request.add_data();
+    data->set_universe(universe_ids[i]);
+    data->set_data(buffers[i]->Get());
+  }
+
+  RpcSession session(NULL);
+  session.SetData(&client);
+  RpcController controller(&session);
+  m_clock.CurrentTime(&time1);
+  service.StreamDmxDataBatch(&controller, &request, NULL, NULL);
+
+  OLA_ASSERT_EQ(dmx_data2, universe1->GetDMX());
+  OLA_ASSERT_EQ(dmx_data, universe2->GetDMX());
+  OLA_ASSERT_FALSE(store.GetUniverse(3));
+
+  // each universe is only updated once
+  ola::UIntMap *frames = export_map.GetUIntMapVar("universe-dmx-frames");
+  OLA_ASSERT_EQ(1u, (*frames)["1"]);
+  OLA_ASSERT_EQ(1u, (*frames)["2"]);
+}
+
+
+static void OpenSharedMemoryComplete() {}
+
+#ifdef HAVE_SHM_OPEN
+/*
+ * Send a datagram to a shared memory doorbell.
+ */
+static void RingDoorbell(const string &path) {
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+  int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+  OLA_ASSERT_TRUE(fd >= 0);
+  const uint8_t ring = 0;
+  OLA_ASSERT_EQ(static_cast<ssize_t>(sizeof(ring)),
+                sendto(fd, &ring, sizeof(ring), 0,
+                       reinterpret_cast<struct sockaddr*>(&address),
+                       sizeof(address)));
+  close(fd);
+}
+#endif  // HAVE_SHM_OPEN
+
+/*
+ * Check clients can send DMX data via shared memory.
+ */
+void OlaServerServiceImplTest::testOpenSharedMemory() {
+  ola::ExportMap export_map;
+  UniverseStore store(NULL, &export_map);
+  ola::TimeStamp time1;
+  ola::Client client(NULL, m_uid);
+  ola::io::SelectServer ss;
+  RpcSession session(NULL);
+  session.SetData(&client);
+
+  ola::proto::SharedMemoryRequest request;
+  request.add_universe(1);
+  request.add_universe(2);
+
+  // Without a SelectServer, shared memory isn't available.
+  {
+    OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL,
+                                 &time1, NULL);
+    ola::proto::SharedMemoryReply reply;
+    RpcController controller(&session);
+    service.OpenSharedMemory(&controller, &request, &reply,
+                             NewSingleCallback(OpenSharedMemoryComplete));
+    OLA_ASSERT_TRUE(controller.Failed());
+  }
+
+  OlaServerServiceImpl service(&store, NULL, NULL, NULL, NULL,
+                               &time1, NULL, &ss);
+  ola::proto::SharedMemoryReply reply;
+  RpcController controller(&session);
+  service.OpenSharedMemory(&controller, &request, &reply,
+                           NewSingleCallback(OpenSharedMemoryComplete));
+#ifdef HAVE_SHM_OPEN
+  OLA_ASSERT_FALSE(controller.Failed());
+#else
+  OLA_ASSERT_TRUE(controller.Failed());
+  return;
+#endif  // HAVE_SHM_OPEN
+
+  std::auto_ptr<ola::dmx::SharedDmxRegion> region(
+      ola::dmx::SharedDmxRegion::Open(reply.region_name()));
+  OLA_ASSERT_NOT_NULL(region.get());
+  OLA_ASSERT_EQ(2u, region->SlotCount());
+
+  Universe *universe2 = store.GetUniverseOrCreate(2);
+  DmxBuffer dmx_data("this is a test");
+  OLA_ASSERT_TRUE(region->Write(1, 120, dmx_data));
+
+#ifdef HAVE_SHM_OPEN
+  RingDoorbell(reply.doorbell_path());
+
+  m_clock.CurrentTime(&time1);
+  ss.RunOnce(ola::TimeInterval(1, 0));
+  OLA_ASSERT_EQ(dmx_data, universe2->GetDMX());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(120), universe2->ActivePriority());
+
+  // Each slot alternates between two buffers, so later frames reuse the
+  // memory rather than allocating.
+  const uint8_t *first_frame = client.SourceData(2).Data().GetRaw();
+  DmxBuffer dmx_data2("more test data");
+  OLA_ASSERT_TRUE(region->Write(1, 120, dmx_data2));
+  RingDoorbell(reply.doorbell_path());
+  ss.RunOnce(ola::TimeInterval(1, 0));
+  OLA_ASSERT_EQ(dmx_data2, universe2->GetDMX());
+  OLA_ASSERT_TRUE(first_frame != client.SourceData(2).Data().GetRaw());
+
+  // Take any memory freed by the last frame so a fresh allocation can't
+  // land back on first_frame.
+  DmxBuffer placeholder;
+  placeholder.Blackout();
+  OLA_ASSERT_TRUE(region->Write(1, 120, dmx_data));
+  RingDoorbell(reply.doorbell_path());
+  ss.RunOnce(ola::TimeInterval(1, 0));
+  OLA_ASSERT_EQ(dmx_data, universe2->GetDMX());
+  OLA_ASSERT_EQ(first_frame, client.SourceData(2).Data().GetRaw());
+#endif  // HAVE_SHM_OPEN
+
+  // The region is removed when the client goes away.
+  service.ClientRemoved(&client);
+  OLA_ASSERT_NULL(ola::dmx::SharedDmxRegion::Open(reply.region_name()));
+  OLA_ASSERT_EQ(-1, access(reply.doorbell_path().c_str(), F_OK));
+}
+
 /*
  * Check the SetUniverseName method works
  */
@@ -85,7 +85,8 @@ OladHTTPServer::OladHTTPServer(ExportMap *export_map,
       m_ola_server(ola_server),
       m_enable_quit(options.enable_quit),
       m_interface(iface),
-      m_rdm_module(&m_server, &m_client) {
+      m_rdm_module(&m_server, &m_client),
+      m_dmx_stream_module(&m_server, &m_client) {
   // The main handlers
   RegisterHandler("/quit", &OladHTTPServer::DisplayQuit);
   RegisterHandler("/reload", &OladHTTPServer::ReloadPlugins);
@@ -31,6 +31,7 @@
 #include "ola/http/OlaHTTPServer.h"
 #include "ola/network/Interface.h"
 #include "ola/rdm/PidStore.h"
+#include "olad/DmxStreamHTTPModule.h"
 #include "olad/RDMHTTPModule.h"
 
 namespace ola {
@@ -157,6 +158,7 @@ class OladHTTPServer: public ola::http::OlaHTTPServer {
   bool m_enable_quit;
   ola::network::Interface m_interface;
   RDMHTTPModule m_rdm_module;
+  DmxStreamHTTPModule m_dmx_stream_module;
   time_t m_start_time_t;
 
   void HandleGetDmx(ola::http::HTTPResponse *response,
@@ -164,6 +164,8 @@ RDMHTTPModule::RDMHTTPModule(HTTPServer *http_server,
       m_client(client),
       m_shim(client),
       m_rdm_api(&m_shim),
+      m_background_shim(client, true),
+      m_background_rdm_api(&m_background_shim),
       m_pid_store(NULL) {
 
   m_server->RegisterHandler(
@@ -790,7 +792,7 @@ void RDMHTTPModule::ResolveNextUID(unsigned int universe_id) {
       uid_state->pending_uids.front();
     if (uid_action_pair.second == RESOLVE_MANUFACTURER) {
       OLA_INFO << "sending manufacturer request for " << uid_action_pair.first;
-      sent_request = m_rdm_api.GetManufacturerLabel(
+      sent_request = m_background_rdm_api.GetManufacturerLabel(
           universe_id,
           uid_action_pair.first,
           ola::rdm::ROOT_RDM_DEVICE,
@@ -802,7 +804,7 @@ void RDMHTTPModule::ResolveNextUID(unsigned int universe_id) {
       uid_state->pending_uids.pop();
     } else if (uid_action_pair.second == RESOLVE_DEVICE) {
       OLA_INFO << "sending device request for " << uid_action_pair.first;
-      sent_request = m_rdm_api.GetDeviceLabel(
+      sent_request = m_background_rdm_api.GetDeviceLabel(
           universe_id,
           uid_action_pair.first,
           ola::rdm::ROOT_RDM_DEVICE,
@@ -99,6 +99,9 @@ class RDMHTTPModule {
     ola::client::OlaClient *m_client;
     ola::client::ClientRDMAPIShim m_shim;
     ola::rdm::RDMAPI m_rdm_api;
+    // Used for the UID label lookups, which run behind the other requests.
+    ola::client::ClientRDMAPIShim m_background_shim;
+    ola::rdm::RDMAPI m_background_rdm_api;
     std::map<unsigned int, uid_resolution_state*> m_universe_uids;
 
     ola::thread::Mutex m_pid_store_mu;
@@ -0,0 +1,237 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * SharedMemoryInput.cpp
+ * Receives DMX data from a local client via shared memory.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef HAVE_SHM_OPEN
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif  // HAVE_SHM_OPEN
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/DmxBuffer.h"
+#include "ola/Logging.h"
+#include "ola/dmx/SourcePriorities.h"
+#include "olad/DmxSource.h"
+#include "olad/SharedMemoryInput.h"
+#include "olad/Universe.h"
+#include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/UniverseStore.h"
+
+namespace ola {
+
+using ola::dmx::SharedDmxRegion;
+using ola::io::UnmanagedFileDescriptor;
+using std::string;
+using std::vector;
+
+unsigned int SharedMemoryInput::s_instance_count = 0;
+
+SharedMemoryInput::SharedMemoryInput(Client *client,
+                                     UniverseStore *universe_store,
+                                     const TimeStamp *wake_up_time,
+                                     const vector<unsigned int> &universes)
+    : m_client(client),
+      m_universe_store(universe_store),
+      m_wake_up_time(wake_up_time),
+      m_universes(universes),
+      m_sequences(universes.size(), 0),
+      m_buffers(2 * universes.size()),
+      m_next_buffer(universes.size(), 0),
+      m_ss(NULL) {
+}
+
+SharedMemoryInput::~SharedMemoryInput() {
+  if (m_doorbell.get()) {
+    m_ss->RemoveReadDescriptor(m_doorbell.get());
+    close(m_doorbell->ReadDescriptor());
+    RemoveDoorbellPath();
+  }
+}
+
+bool SharedMemoryInput::Init(ola::io::SelectServerInterface *ss) {
+#ifdef HAVE_SHM_OPEN
+  if (m_region.get() || m_universes.empty()) {
+    return false;
+  }
+
+  std::ostringstream str;
+  str << "ola-dmx-" << getpid() << "-" << s_instance_count++;
+  const string name = str.str();
+
+  m_region.reset(SharedDmxRegion::Create("/" + name, m_universes.size()));
+  if (!m_region.get()) {
+    return false;
+  }
+
+  // The socket lives in a directory only we can access, so other users can't
+  // ring the doorbell or race us to create the socket. This matches the
+  // permissions on the region.
+  char dir_template[] = "/tmp/ola-dmx-XXXXXX";
+  if (!mkdtemp(dir_template)) {
+    OLA_WARN << "Failed to create the doorbell directory: "
+             << strerror(errno);
+    m_region.reset();
+    return false;
+  }
+  m_doorbell_dir = dir_template;
+  m_doorbell_path = m_doorbell_dir + "/doorbell";
+
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (m_doorbell_path.size() >= sizeof(address.sun_path)) {
+    OLA_WARN << "Doorbell path " << m_doorbell_path << " is too long";
+    RemoveDoorbellPath();
+    m_region.reset();
+    return false;
+  }
+  strncpy(address.sun_path, m_doorbell_path.c_str(),
+          sizeof(address.sun_path) - 1);
+
+  int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+  if (fd < 0) {
+    OLA_WARN << "Failed to create the doorbell socket: " << strerror(errno);
+    RemoveDoorbellPath();
+    m_region.reset();
+    return false;
+  }
+
+  if (bind(fd, reinterpret_cast<struct sockaddr*>(&address),
+           sizeof(address)) < 0) {
+    OLA_WARN << "Failed to bind to " << m_doorbell_path << ": "
+             << strerror(errno);
+    close(fd);
+    RemoveDoorbellPath();
+    m_region.reset();
+    return false;
+  }
+
+  int flags = fcntl(fd, F_GETFL);
+  if (chmod(m_doorbell_path.c_str(), S_IRUSR | S_IWUSR) < 0 ||
+      flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+    OLA_WARN << "Failed to set up the doorbell socket: " << strerror(errno);
+    close(fd);
+    RemoveDoorbellPath();
+    m_region.reset();
+    return false;
+  }
+
+  m_ss = ss;
+  m_doorbell.reset(new UnmanagedFileDescriptor(fd));
+  m_doorbell->SetOnData(NewCallback(this, &SharedMemoryInput::DoorbellRung));
+  m_ss->AddReadDescriptor(m_doorbell.get());
+  OLA_INFO << "Created shared memory input " << name << " with "
+           << m_universes.size() << " universes";
+  return true;
+#else
+  OLA_WARN << "Shared memory isn't supported on this platform";
+  (void) ss;
+  return false;
+#endif  // HAVE_SHM_OPEN
+}
+
+/*
+ * Remove the doorbell socket and the directory it's in.
+ */
+void SharedMemoryInput::RemoveDoorbellPath() {
+  if (!m_doorbell_path.empty()) {
+    unlink(m_doorbell_path.c_str());
+    m_doorbell_path.clear();
+  }
+  if (!m_doorbell_dir.empty()) {
+    rmdir(m_doorbell_dir.c_str());
+    m_doorbell_dir.clear();
+  }
+}
+
+string SharedMemoryInput::RegionName() const {
+  return m_region.get() ? m_region->Name() : "";
+}
+
+void SharedMemoryInput::ReadSlots() {
+  if (!m_region.get()) {
+    return;
+  }
+
+  m_changed_universes.clear();
+  for (unsigned int i = 0; i < m_universes.size(); i++) {
+    // Each slot alternates between two buffers. The client's DmxSource holds
+    // the last frame, so the other buffer is no longer shared and its memory
+    // is reused.
+    DmxBuffer *buffer = &m_buffers[2 * i + m_next_buffer[i]];
+    uint8_t priority;
+    if (!m_region->Read(i, &m_sequences[i], &priority, buffer)) {
+      continue;
+    }
+    m_next_buffer[i] ^= 1;
+
+    Universe *universe = m_universe_store->GetUniverse(m_universes[i]);
+    if (!universe) {
+      continue;
+    }
+
+    priority = std::max(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MIN),
+                        priority);
+    priority = std::min(static_cast<uint8_t>(ola::dmx::SOURCE_PRIORITY_MAX),
+                        priority);
+    m_client->DMXReceived(m_universes[i],
+                          DmxSource(*buffer, *m_wake_up_time, priority));
+    if (std::find(m_changed_universes.begin(), m_changed_universes.end(),
+                  universe) == m_changed_universes.end()) {
+      m_changed_universes.push_back(universe);
+    }
+  }
+
+  vector<Universe*>::iterator iter = m_changed_universes.begin();
+  for (; iter != m_changed_universes.end(); ++iter) {
+    (*iter)->SourceClientDataChanged(m_client);
+  }
+}
+
+/*
+ * Called when the doorbell socket is readable.
+ */
+void SharedMemoryInput::DoorbellRung() {
+#ifdef HAVE_SHM_OPEN
+  // Drain all the pending rings, they're handled by a single pass over the
+  // slots.
+  uint8_t buffer[64];
+  while (recv(m_doorbell->ReadDescriptor(), buffer, sizeof(buffer), 0) >= 0) {
+  }
+#endif  // HAVE_SHM_OPEN
+  ReadSlots();
+}
+}  // namespace ola
@@ -0,0 +1,113 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * SharedMemoryInput.h
+ * Receives DMX data from a local client via shared memory.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_SHAREDMEMORYINPUT_H_
+#define OLAD_SHAREDMEMORYINPUT_H_
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/dmx/SharedDmxRegion.h"
+#include "ola/DmxBuffer.h"
+#include "ola/base/Macro.h"
+#include "ola/io/Descriptor.h"
+#include "ola/io/SelectServerInterface.h"
+
+namespace ola {
+
+class Client;
+class Universe;
+class UniverseStore;
+
+/**
+ * @brief Receives DMX data from a client on the same host.
+ *
+ * The client writes frames into a SharedDmxRegion, one slot per universe, and
+ * then sends a datagram to the doorbell socket. When the doorbell rings, each
+ * slot is checked and the changed universes are updated, exactly as if the
+ * data had arrived with a StreamDmxData RPC.
+ *
+ * The region and the socket are removed when the SharedMemoryInput is
+ * deleted, which should happen when the client disconnects.
+ */
+class SharedMemoryInput {
+ public:
+  /**
+   * @brief Create a new SharedMemoryInput.
+   * @param client the client the data is from.
+   * @param universe_store the UniverseStore to lookup universes in.
+   * @param wake_up_time the time the SelectServer woke up.
+   * @param universes the universe for each slot in the region.
+   */
+  SharedMemoryInput(Client *client,
+                    UniverseStore *universe_store,
+                    const TimeStamp *wake_up_time,
+                    const std::vector<unsigned int> &universes);
+  ~SharedMemoryInput();
+
+  /**
+   * @brief Create the region and the doorbell socket.
+   * @param ss the SelectServer to register the doorbell with.
+   * @returns true if the input is ready, false otherwise.
+   */
+  bool Init(ola::io::SelectServerInterface *ss);
+
+  /**
+   * @brief The name of the shared memory region.
+   */
+  std::string RegionName() const;
+
+  /**
+   * @brief The path of the doorbell socket.
+   */
+  const std::string &DoorbellPath() const { return m_doorbell_path; }
+
+  /**
+   * @brief Check all the slots for new data.
+   */
+  void ReadSlots();
+
+ private:
+  Client *m_client;
+  UniverseStore *m_universe_store;
+  const TimeStamp *m_wake_up_time;
+  const std::vector<unsigned int> m_universes;
+  std::vector<uint32_t> m_sequences;
+  // Two buffers per slot, see ReadSlots()
+  std::vector<DmxBuffer> m_buffers;
+  std::vector<unsigned int> m_next_buffer;
+  std::vector<Universe*> m_changed_universes;
+  std::auto_ptr<ola::dmx::SharedDmxRegion> m_region;
+  std::auto_ptr<ola::io::UnmanagedFileDescriptor> m_doorbell;
+  std::string m_doorbell_dir;
+  std::string m_doorbell_path;
+  ola::io::SelectServerInterface *m_ss;
+
+  void DoorbellRung();
+  void RemoveDoorbellPath();
+
+  static unsigned int s_instance_count;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedMemoryInput);
+};
+}  // namespace ola
+#endif  // OLAD_SHAREDMEMORYINPUT_H_
@@ -19,9 +19,11 @@
  */
 
 #include <map>
+#include <string>
 #include <utility>
 #include "common/protocol/Ola.pb.h"
 #include "common/protocol/OlaService.pb.h"
+#include "common/rpc/RpcChannel.h"
 #include "ola/Callback.h"
 #include "ola/Logging.h"
 #include "ola/rdm/UID.h"
@@ -31,13 +33,34 @@
 namespace ola {
 
 using ola::rdm::UID;
+using ola::rpc::RpcChannel;
 using ola::rpc::RpcController;
 using std::map;
+using std::string;
+
+const string &ClientDmxUpdate::Encoded() const {
+  if (!m_encoded_valid) {
+    ola::proto::DmxData dmx_data;
+    dmx_data.set_priority(m_priority);
+    dmx_data.set_universe(m_universe_id);
+    dmx_data.set_data(m_buffer.Get());
+
+    RpcChannel::EncodeStreamRequest(
+        ola::proto::OlaClientService::descriptor()->FindMethodByName(
+            "StreamDmxData"),
+        dmx_data, &m_encoded);
+    m_encoded_valid = true;
+  }
+  return m_encoded;
+}
+
+const DmxSource Client::EMPTY_SOURCE;
 
 Client::Client(ola::proto::OlaClientService_Stub *client_stub,
                const ola::rdm::UID &uid)
     : m_client_stub(client_stub),
-      m_uid(uid) {
+      m_uid(uid),
+      m_stream_dmx(false) {
 }
 
 Client::~Client() {
@@ -46,18 +69,27 @@ Client::~Client() {
 
 bool Client::SendDMX(unsigned int universe, uint8_t priority,
                      const DmxBuffer &buffer) {
+  return SendDMXUpdate(ClientDmxUpdate(universe, priority, buffer));
+}
+
+bool Client::SendDMXUpdate(const ClientDmxUpdate &update) {
   if (!m_client_stub.get()) {
     OLA_FATAL << "client_stub is null";
     return false;
   }
 
+  RpcChannel *channel = m_client_stub->channel();
+  if (m_stream_dmx && channel) {
+    return channel->SendEncodedStreamRequest(update.Encoded());
+  }
+
   RpcController *controller = new RpcController();
   ola::proto::DmxData dmx_data;
   ola::proto::Ack *ack = new ola::proto::Ack();
 
-  dmx_data.set_priority(priority);
-  dmx_data.set_universe(universe);
-  dmx_data.set_data(buffer.Get());
+  dmx_data.set_priority(update.Priority());
+  dmx_data.set_universe(update.UniverseId());
+  dmx_data.set_data(update.Data().Get());
 
   m_client_stub->UpdateDmxData(
       controller,
@@ -72,15 +104,14 @@ void Client::DMXReceived(unsigned int universe, const DmxSource &source) {
   STLReplace(&m_data_map, universe, source);
 }
 
-const DmxSource Client::SourceData(unsigned int universe) const {
+const DmxSource &Client::SourceData(unsigned int universe) const {
   map<unsigned int, DmxSource>::const_iterator iter =
     m_data_map.find(universe);
 
   if (iter != m_data_map.end()) {
     return iter->second;
   } else {
-    DmxSource source;
-    return source;
+    return EMPTY_SOURCE;
   }
 }
 
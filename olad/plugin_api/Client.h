@@ -23,7 +23,9 @@
 
 #include <map>
 #include <memory>
+#include <string>
 #include "common/rpc/RpcController.h"
+#include "ola/DmxBuffer.h"
 #include "ola/base/Macro.h"
 #include "ola/rdm/UID.h"
 #include "olad/DmxSource.h"
@@ -37,6 +39,48 @@ class Ack;
 
 namespace ola {
 
+/**
+ * @brief A DMX update to push to one or more clients.
+ *
+ * Clients that stream DMX data share a single serialized copy of the update,
+ * which is created the first time it's needed.
+ */
+class ClientDmxUpdate {
+ public:
+  /**
+   * @brief Create a new update.
+   * @param universe_id the universe the DMX data belongs to
+   * @param priority the priority of the DMX data
+   * @param buffer the DMX data.
+   */
+  ClientDmxUpdate(unsigned int universe_id, uint8_t priority,
+                  const DmxBuffer &buffer)
+      : m_universe_id(universe_id),
+        m_priority(priority),
+        m_buffer(buffer),
+        m_encoded_valid(false) {
+  }
+
+  unsigned int UniverseId() const { return m_universe_id; }
+  uint8_t Priority() const { return m_priority; }
+  const DmxBuffer &Data() const { return m_buffer; }
+
+  /**
+   * @brief Return the update as an encoded StreamDmxData RPC.
+   */
+  const std::string &Encoded() const;
+
+ private:
+  unsigned int m_universe_id;
+  uint8_t m_priority;
+  DmxBuffer m_buffer;
+  mutable std::string m_encoded;
+  mutable bool m_encoded_valid;
+
+  DISALLOW_COPY_AND_ASSIGN(ClientDmxUpdate);
+};
+
+
 /**
  * @brief Represents a connected OLA client on the OLA server side.
  *
@@ -64,8 +108,24 @@ class Client {
    * @param buffer the DMX data.
    * @return true if the update was sent, false otherwise
    */
-  virtual bool SendDMX(unsigned int universe_id, uint8_t priority,
-                       const DmxBuffer &buffer);
+  bool SendDMX(unsigned int universe_id, uint8_t priority,
+               const DmxBuffer &buffer);
+
+  /**
+   * @brief Push a DMX update to this client.
+   * @param update the update to send.
+   * @return true if the update was sent, false otherwise
+   *
+   * If the client has enabled streaming, the update is sent as a one way
+   * StreamDmxData RPC, otherwise UpdateDmxData is used.
+   */
+  virtual bool SendDMXUpdate(const ClientDmxUpdate &update);
+
+  /**
+   * @brief Control if DMX updates are streamed to this client.
+   * @param stream true to use StreamDmxData, false to use UpdateDmxData.
+   */
+  void SetStreamDMX(bool stream) { m_stream_dmx = stream; }
 
   /**
    * @brief Called when this client sends us new data
@@ -77,8 +137,11 @@ class Client {
   /**
    * @brief Get the most recent DMX data received from this client.
    * @param universe the id of the universe we're interested in
+   * @returns The DmxSource for the universe. The reference remains valid
+   *   until the client is destroyed, and reflects any later calls to
+   *   DMXReceived() for the same universe.
    */
-  const DmxSource SourceData(unsigned int universe) const;
+  const DmxSource &SourceData(unsigned int universe) const;
 
   /**
    * @brief Return the UID associated with this client.
@@ -102,6 +165,9 @@ class Client {
   std::auto_ptr<class ola::proto::OlaClientService_Stub> m_client_stub;
   std::map<unsigned int, DmxSource> m_data_map;
   ola::rdm::UID m_uid;
+  bool m_stream_dmx;
+
+  static const DmxSource EMPTY_SOURCE;
 
   DISALLOW_COPY_AND_ASSIGN(Client);
 };
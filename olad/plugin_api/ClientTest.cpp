@@ -23,11 +23,14 @@
 
 #include "common/protocol/Ola.pb.h"
 #include "common/protocol/OlaService.pb.h"
+#include "common/rpc/RpcChannel.h"
 #include "common/rpc/RpcController.h"
 #include "common/rpc/RpcService.h"
 #include "ola/Clock.h"
 #include "ola/Constants.h"
 #include "ola/DmxBuffer.h"
+#include "ola/io/Descriptor.h"
+#include "ola/io/SelectServer.h"
 #include "ola/rdm/UID.h"
 #include "ola/testing/TestUtils.h"
 #include "olad/DmxSource.h"
@@ -40,18 +43,24 @@ static const char TEST_DATA[] = "this is some test data";
 static const char TEST_DATA2[] = "another set of test data";
 
 using ola::Client;
+using ola::ClientDmxUpdate;
 using ola::DmxBuffer;
+using ola::io::LoopbackDescriptor;
+using ola::io::SelectServer;
+using ola::rpc::RpcChannel;
 using std::string;
 
 class ClientTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(ClientTest);
   CPPUNIT_TEST(testSendDMX);
+  CPPUNIT_TEST(testStreamDMX);
   CPPUNIT_TEST(testGetSetDMX);
   CPPUNIT_TEST_SUITE_END();
 
  public:
   ClientTest() : m_test_uid(ola::OPEN_LIGHTING_ESTA_CODE, 0) {}
   void testSendDMX();
+  void testStreamDMX();
   void testGetSetDMX();
 
  private:
@@ -87,6 +96,28 @@ void MockClientStub::UpdateDmxData(
   done->Run();
 }
 
+/*
+ * The client end of a streaming connection.
+ */
+class StreamingClientService: public ola::proto::OlaClientService {
+ public:
+  explicit StreamingClientService(SelectServer *ss) : m_ss(ss) {}
+
+  void StreamDmxData(ola::rpc::RpcController*,
+                     const ola::proto::DmxData *request,
+                     ola::proto::STREAMING_NO_RESPONSE*,
+                     ola::rpc::RpcService::CompletionCallback *done) {
+    OLA_ASSERT_NULL(done);
+    OLA_ASSERT_EQ(TEST_UNIVERSE, (unsigned int) request->universe());
+    OLA_ASSERT_EQ(100, request->priority());
+    OLA_ASSERT(TEST_DATA == request->data());
+    m_ss->Terminate();
+  }
+
+ private:
+  SelectServer *m_ss;
+};
+
 /*
  * Check that the SendDMX method works correctly.
  */
@@ -102,6 +133,31 @@ void ClientTest::testSendDMX() {
   client2.SendDMX(TEST_UNIVERSE, priority, buffer);
 }
 
+/*
+ * Check that DMX updates can be streamed to the client.
+ */
+void ClientTest::testStreamDMX() {
+  SelectServer ss;
+  LoopbackDescriptor socket;
+  socket.Init();
+  StreamingClientService service(&ss);
+  RpcChannel channel(&service, &socket);
+  ss.AddReadDescriptor(&socket);
+
+  Client client(new ola::proto::OlaClientService_Stub(&channel), m_test_uid);
+  client.SetStreamDMX(true);
+
+  const DmxBuffer buffer(TEST_DATA);
+  ClientDmxUpdate update(TEST_UNIVERSE, 100, buffer);
+  OLA_ASSERT_TRUE(client.SendDMXUpdate(update));
+  ss.Run();
+
+  // the update is only encoded once
+  const string &encoded = update.Encoded();
+  OLA_ASSERT_EQ(&encoded, &update.Encoded());
+  ss.RemoveReadDescriptor(&socket);
+}
+
 /*
  * Check that the DMX get/set works correctly.
  */
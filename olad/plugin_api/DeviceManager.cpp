@@ -24,18 +24,24 @@
 #include <stdio.h>
 #include <errno.h>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
 
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
 #include "ola/stl/STLUtils.h"
 #include "olad/Port.h"
 #include "olad/plugin_api/PortManager.h"
 
 namespace ola {
 
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using std::auto_ptr;
 using std::map;
 using std::set;
 using std::string;
@@ -45,6 +51,7 @@ const unsigned int DeviceManager::MISSING_DEVICE_ALIAS = 0;
 const char DeviceManager::PORT_PREFERENCES[] = "port";
 const char DeviceManager::PRIORITY_VALUE_SUFFIX[] = "_priority_value";
 const char DeviceManager::PRIORITY_MODE_SUFFIX[] = "_priority_mode";
+const char DeviceManager::UIDS_SUFFIX[] = "_uids";
 
 bool operator <(const device_alias_pair& left,
                 const device_alias_pair &right) {
@@ -111,6 +118,12 @@ bool DeviceManager::RegisterDevice(AbstractDevice *device) {
 
   vector<OutputPort*> output_ports;
   device->OutputPorts(&output_ports);
+  // The UIDs need to be set before the ports are patched, since patching can
+  // trigger discovery.
+  vector<OutputPort*>::iterator port_iter = output_ports.begin();
+  for (; port_iter != output_ports.end(); ++port_iter) {
+    RestorePortUIDs(*port_iter);
+  }
   RestorePortSettings(output_ports);
 
   // look for timecode ports and add them to the set
@@ -219,6 +232,7 @@ void DeviceManager::ReleaseDevice(const AbstractDevice *device) {
   vector<OutputPort*>::const_iterator output_iter = output_ports.begin();
   for (; output_iter != output_ports.end(); ++output_iter) {
     SavePortPriority(**output_iter);
+    SavePortUIDs(**output_iter);
 
     // remove from the timecode port set
     STLRemove(&m_timecode_ports, *output_iter);
@@ -310,6 +324,68 @@ void DeviceManager::RestorePortPriority(Port *port) const {
 }
 
 
+/*
+ * Save the UIDs discovered on an output port, so discovery can verify them
+ * the next time the port is used.
+ */
+void DeviceManager::SavePortUIDs(const OutputPort &port) const {
+  if (!port.SupportsRDM()) {
+    return;
+  }
+
+  string port_id = port.UniqueId();
+  if (port_id.empty()) {
+    return;
+  }
+
+  UIDSet uids;
+  if (port.GetUniverse()) {
+    port.GetUniverse()->GetUIDs(&port, &uids);
+  }
+
+  if (uids.Size()) {
+    m_port_preferences->SetValue(port_id + UIDS_SUFFIX, uids.ToString());
+  } else {
+    m_port_preferences->RemoveValue(port_id + UIDS_SUFFIX);
+  }
+}
+
+
+/*
+ * Restore the UIDs for an output port
+ */
+void DeviceManager::RestorePortUIDs(OutputPort *port) const {
+  if (!m_port_preferences || !port->SupportsRDM()) {
+    return;
+  }
+
+  string port_id = port->UniqueId();
+  if (port_id.empty()) {
+    return;
+  }
+
+  vector<string> tokens;
+  StringSplit(m_port_preferences->GetValue(port_id + UIDS_SUFFIX), &tokens,
+              ",");
+
+  UIDSet uids;
+  vector<string>::const_iterator iter = tokens.begin();
+  for (; iter != tokens.end(); ++iter) {
+    auto_ptr<UID> uid(UID::FromString(*iter));
+    if (uid.get()) {
+      uids.AddUID(*uid);
+    } else if (!iter->empty()) {
+      OLA_WARN << "Invalid UID " << *iter << " saved for port " << port_id;
+    }
+  }
+
+  if (uids.Size()) {
+    OLA_INFO << "Restored " << uids.Size() << " UIDs for port " << port_id;
+    port->SetKnownUIDs(uids);
+  }
+}
+
+
 /*
  * Restore the patching information for a port.
  */
@@ -159,6 +159,9 @@ class DeviceManager {
   void SavePortPriority(const Port &port) const;
   void RestorePortPriority(Port *port) const;
 
+  void SavePortUIDs(const OutputPort &port) const;
+  void RestorePortUIDs(OutputPort *port) const;
+
   template <class PortClass>
   void RestorePortSettings(const std::vector<PortClass*> &ports) const;
 
@@ -166,6 +169,7 @@ class DeviceManager {
   static const unsigned int FIRST_DEVICE_ALIAS = 1;
   static const char PRIORITY_VALUE_SUFFIX[];
   static const char PRIORITY_MODE_SUFFIX[];
+  static const char UIDS_SUFFIX[];
 
   DISALLOW_COPY_AND_ASSIGN(DeviceManager);
 };
@@ -42,6 +42,8 @@ using ola::DmxBuffer;
 using ola::Port;
 using ola::PortManager;
 using ola::Universe;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
 using ola::UniverseStore;
 using std::string;
 using std::vector;
@@ -52,12 +54,14 @@ class DeviceManagerTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testDeviceManager);
   CPPUNIT_TEST(testRestorePatchings);
   CPPUNIT_TEST(testRestorePriorities);
+  CPPUNIT_TEST(testRestoreUIDs);
   CPPUNIT_TEST_SUITE_END();
 
  public:
     void testDeviceManager();
     void testRestorePatchings();
     void testRestorePriorities();
+    void testRestoreUIDs();
 };
 
 
@@ -291,3 +295,45 @@ void DeviceManagerTest::testRestorePriorities() {
   OLA_ASSERT_EQ(string("60"),
                 prefs->GetValue("2-test_device_1-O-3_priority_value"));
 }
+
+
+/*
+ * Test that the UIDs on RDM ports are saved and restored.
+ */
+void DeviceManagerTest::testRestoreUIDs() {
+  ola::MemoryPreferencesFactory prefs_factory;
+  UniverseStore uni_store(NULL, NULL);
+  ola::PortBroker broker;
+  PortManager port_manager(&uni_store, &broker);
+  DeviceManager manager(&prefs_factory, &port_manager);
+
+  ola::Preferences *prefs = prefs_factory.NewPreference("port");
+  OLA_ASSERT(prefs);
+  prefs->SetValue("2-test-device-1-O-1", "3");
+  prefs->SetValue("2-test-device-1-O-1_uids",
+                  "7a70:00000001,7a70:00000002,foo");
+
+  // one of the saved responders has gone, and there is a new one.
+  UIDSet port_uids;
+  port_uids.AddUID(UID(0x7a70, 1));
+  port_uids.AddUID(UID(0x7a70, 3));
+
+  TestMockPlugin plugin(NULL, ola::OLA_PLUGIN_ARTNET);
+  MockDevice device1(&plugin, "test-device-1");
+  TestMockRDMOutputPort output_port(&device1, 1, &port_uids, true);
+  device1.AddPort(&output_port);
+
+  OLA_ASSERT(manager.RegisterDevice(&device1));
+  UIDSet expected_uids;
+  expected_uids.AddUID(UID(0x7a70, 1));
+  expected_uids.AddUID(UID(0x7a70, 2));
+  OLA_ASSERT_EQ(expected_uids, output_port.KnownUIDs());
+
+  Universe *universe = output_port.GetUniverse();
+  OLA_ASSERT(universe);
+  OLA_ASSERT_EQ(2u, universe->UIDCount());
+
+  manager.UnregisterAllDevices();
+  OLA_ASSERT_EQ(string("7a70:00000001,7a70:00000003"),
+                prefs->GetValue("2-test-device-1-O-1_uids"));
+}
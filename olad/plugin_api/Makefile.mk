@@ -24,7 +24,14 @@ olad_plugin_api_libolaserverplugininterface_la_SOURCES = \
     olad/plugin_api/PortBroker.cpp \
     olad/plugin_api/PortManager.cpp \
     olad/plugin_api/PortManager.h \
+    olad/plugin_api/OutputPacer.cpp \
+    olad/plugin_api/OutputPacer.h \
+    olad/plugin_api/OutputSyncGroup.cpp \
     olad/plugin_api/Preferences.cpp \
+    olad/plugin_api/RDMResponseCache.cpp \
+    olad/plugin_api/RDMResponseCache.h \
+    olad/plugin_api/RDMScheduler.cpp \
+    olad/plugin_api/RDMScheduler.h \
     olad/plugin_api/Universe.cpp \
     olad/plugin_api/UniverseStore.cpp \
     olad/plugin_api/UniverseStore.h
@@ -72,6 +79,11 @@ olad_plugin_api_PreferencesTester_SOURCES = olad/plugin_api/PreferencesTest.cpp
 olad_plugin_api_PreferencesTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 olad_plugin_api_PreferencesTester_LDADD = $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
 
-olad_plugin_api_UniverseTester_SOURCES = olad/plugin_api/UniverseTest.cpp
+olad_plugin_api_UniverseTester_SOURCES = \
+    olad/plugin_api/OutputPacerTest.cpp \
+    olad/plugin_api/OutputSyncGroupTest.cpp \
+    olad/plugin_api/RDMResponseCacheTest.cpp \
+    olad/plugin_api/RDMSchedulerTest.cpp \
+    olad/plugin_api/UniverseTest.cpp
 olad_plugin_api_UniverseTester_CXXFLAGS = $(COMMON_TESTING_FLAGS)
 olad_plugin_api_UniverseTester_LDADD = $(COMMON_OLAD_PLUGIN_API_TEST_LDADD)
@@ -0,0 +1,286 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * OutputPacer.cpp
+ * Limits the rate DMX frames are written to a universe's output ports.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+
+#include "ola/Callback.h"
+#include "olad/Port.h"
+#include "olad/plugin_api/OutputPacer.h"
+
+namespace ola {
+
+using ola::thread::INVALID_TIMEOUT;
+
+const char OutputPacer::K_FRAMES_SENT_VAR[] = "output-pacer-frames-sent";
+const char OutputPacer::K_FRAMES_COALESCED_VAR[] =
+    "output-pacer-frames-coalesced";
+const char OutputPacer::K_FRAMES_DROPPED_VAR[] = "output-pacer-frames-dropped";
+
+namespace {
+const int64_t ONE_SECOND_IN_US = 1000000;
+}  // namespace
+
+OutputPacer::PortState::PortState(OutputPort *_port)
+    : port(_port),
+      id(_port->UniqueId()),
+      last_priority(0),
+      pending_priority(0),
+      has_pending(false),
+      flush_timeout(INVALID_TIMEOUT),
+      keepalive_timeout(INVALID_TIMEOUT) {
+}
+
+OutputPacer::OutputPacer(Clock *clock, ExportMap *export_map,
+                         SentCallback *sent_callback)
+    : m_clock(clock),
+      m_export_map(export_map),
+      m_sent_callback(sent_callback),
+      m_scheduler(NULL) {
+  if (m_export_map) {
+    m_export_map->GetUIntMapVar(K_FRAMES_SENT_VAR, "port");
+    m_export_map->GetUIntMapVar(K_FRAMES_COALESCED_VAR, "port");
+    m_export_map->GetUIntMapVar(K_FRAMES_DROPPED_VAR, "port");
+  }
+}
+
+OutputPacer::~OutputPacer() {
+  PortMap::iterator iter = m_ports.begin();
+  for (; iter != m_ports.end(); ++iter) {
+    CancelTimeouts(iter->second);
+    delete iter->second;
+  }
+  m_ports.clear();
+}
+
+void OutputPacer::SetOptions(ola::thread::SchedulerInterface *scheduler,
+                             const OutputPacerOptions &options) {
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+
+  // Write out any held frames before the timeouts are removed.
+  PortMap::iterator iter = m_ports.begin();
+  for (; iter != m_ports.end(); ++iter) {
+    PortState *state = iter->second;
+    if (state->has_pending) {
+      state->has_pending = false;
+      Send(state, state->pending_buffer, state->pending_priority, now);
+    }
+    CancelTimeouts(state);
+  }
+
+  m_scheduler = scheduler;
+  m_options = options;
+  m_min_interval = (m_scheduler && m_options.max_fps) ?
+      TimeInterval(ONE_SECOND_IN_US / m_options.max_fps) :
+      TimeInterval();
+  m_keepalive_interval = (m_scheduler && m_options.keepalive_fps) ?
+      TimeInterval(ONE_SECOND_IN_US / m_options.keepalive_fps) :
+      TimeInterval();
+  m_duplicate_window = TimeInterval(
+      static_cast<int64_t>(m_options.duplicate_window_ms) * 1000);
+
+  for (iter = m_ports.begin(); iter != m_ports.end(); ++iter) {
+    if (iter->second->last_sent.IsSet()) {
+      ArmKeepalive(iter->second);
+    }
+  }
+}
+
+void OutputPacer::WriteDMX(OutputPort *port, const DmxBuffer &buffer,
+                           uint8_t priority) {
+  if (!Enabled()) {
+    port->WriteDMX(buffer, priority);
+    if (m_sent_callback.get()) {
+      m_sent_callback->Run(port);
+    }
+    return;
+  }
+
+  PortMap::iterator iter = m_ports.find(port);
+  PortState *state;
+  if (iter == m_ports.end()) {
+    state = new PortState(port);
+    if (m_export_map) {
+      state->frames_sent = m_export_map->GetCounter(K_FRAMES_SENT_VAR,
+                                                    state->id);
+      state->frames_coalesced = m_export_map->GetCounter(
+          K_FRAMES_COALESCED_VAR, state->id);
+      state->frames_dropped = m_export_map->GetCounter(K_FRAMES_DROPPED_VAR,
+                                                       state->id);
+    }
+    m_ports[port] = state;
+  } else {
+    state = iter->second;
+  }
+
+  if (state->has_pending) {
+    // The held frame hasn't been written yet, this one replaces it.
+    state->pending_buffer = buffer;
+    state->pending_priority = priority;
+    state->frames_coalesced++;
+    return;
+  }
+
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+
+  if (IsDuplicate(state, buffer, priority, now)) {
+    state->frames_dropped++;
+    return;
+  }
+
+  if (!m_min_interval.IsZero() && state->last_sent.IsSet()) {
+    TimeInterval elapsed = now - state->last_sent;
+    if (elapsed < m_min_interval) {
+      state->pending_buffer = buffer;
+      state->pending_priority = priority;
+      state->has_pending = true;
+      state->flush_timeout = m_scheduler->RegisterSingleTimeout(
+          TimeInterval(m_min_interval.AsInt() - elapsed.AsInt()),
+          NewSingleCallback(this, &OutputPacer::Flush,
+                            static_cast<const OutputPort*>(port)));
+      return;
+    }
+  }
+  Send(state, buffer, priority, now);
+}
+
+void OutputPacer::RemovePort(const OutputPort *port) {
+  PortMap::iterator iter = m_ports.find(port);
+  if (iter == m_ports.end()) {
+    return;
+  }
+
+  PortState *state = iter->second;
+  m_ports.erase(iter);
+  CancelTimeouts(state);
+  if (m_export_map) {
+    m_export_map->GetUIntMapVar(K_FRAMES_SENT_VAR)->Remove(state->id);
+    m_export_map->GetUIntMapVar(K_FRAMES_COALESCED_VAR)->Remove(state->id);
+    m_export_map->GetUIntMapVar(K_FRAMES_DROPPED_VAR)->Remove(state->id);
+  }
+  delete state;
+}
+
+bool OutputPacer::Enabled() const {
+  return !(m_min_interval.IsZero() && m_keepalive_interval.IsZero() &&
+           m_duplicate_window.IsZero());
+}
+
+bool OutputPacer::IsDuplicate(const PortState *state, const DmxBuffer &buffer,
+                              uint8_t priority, const TimeStamp &now) const {
+  return (!m_duplicate_window.IsZero() &&
+          state->last_sent.IsSet() &&
+          now - state->last_sent < m_duplicate_window &&
+          priority == state->last_priority &&
+          buffer == state->last_buffer);
+}
+
+void OutputPacer::Send(PortState *state, const DmxBuffer &buffer,
+                       uint8_t priority, const TimeStamp &now) {
+  state->port->WriteDMX(buffer, priority);
+  state->last_buffer = buffer;
+  state->last_priority = priority;
+  state->last_sent = now;
+  state->frames_sent++;
+
+  ArmKeepalive(state);
+
+  if (m_sent_callback.get()) {
+    m_sent_callback->Run(state->port);
+  }
+}
+
+/*
+ * Write the held frame for a port.
+ */
+void OutputPacer::Flush(const OutputPort *port) {
+  PortMap::iterator iter = m_ports.find(port);
+  if (iter == m_ports.end()) {
+    return;
+  }
+
+  PortState *state = iter->second;
+  state->flush_timeout = INVALID_TIMEOUT;
+  if (!state->has_pending) {
+    return;
+  }
+  state->has_pending = false;
+
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  if (IsDuplicate(state, state->pending_buffer, state->pending_priority,
+                  now)) {
+    state->frames_dropped++;
+    if (state->keepalive_timeout == INVALID_TIMEOUT) {
+      ArmKeepalive(state);
+    }
+    return;
+  }
+  Send(state, state->pending_buffer, state->pending_priority, now);
+}
+
+/*
+ * Nothing has been written to a port for a while, write the last frame again.
+ */
+void OutputPacer::Keepalive(const OutputPort *port) {
+  PortMap::iterator iter = m_ports.find(port);
+  if (iter == m_ports.end()) {
+    return;
+  }
+
+  PortState *state = iter->second;
+  state->keepalive_timeout = INVALID_TIMEOUT;
+  if (state->has_pending) {
+    // Flush() will write the held frame shortly.
+    return;
+  }
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  Send(state, state->last_buffer, state->last_priority, now);
+}
+
+/*
+ * (Re)start the keepalive timer for a port.
+ */
+void OutputPacer::ArmKeepalive(PortState *state) {
+  if (m_keepalive_interval.IsZero()) {
+    return;
+  }
+  if (state->keepalive_timeout != INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(state->keepalive_timeout);
+  }
+  state->keepalive_timeout = m_scheduler->RegisterSingleTimeout(
+      m_keepalive_interval,
+      NewSingleCallback(this, &OutputPacer::Keepalive,
+                        static_cast<const OutputPort*>(state->port)));
+}
+
+void OutputPacer::CancelTimeouts(PortState *state) {
+  if (state->flush_timeout != INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(state->flush_timeout);
+    state->flush_timeout = INVALID_TIMEOUT;
+  }
+  if (state->keepalive_timeout != INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(state->keepalive_timeout);
+    state->keepalive_timeout = INVALID_TIMEOUT;
+  }
+}
+}  // namespace ola
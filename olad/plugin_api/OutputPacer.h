@@ -0,0 +1,179 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * OutputPacer.h
+ * Limits the rate DMX frames are written to a universe's output ports.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_PLUGIN_API_OUTPUTPACER_H_
+#define OLAD_PLUGIN_API_OUTPUTPACER_H_
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <string>
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/base/Macro.h"
+#include "ola/thread/SchedulerInterface.h"
+
+namespace ola {
+
+class OutputPort;
+
+/**
+ * @brief Options for the OutputPacer.
+ */
+struct OutputPacerOptions {
+  OutputPacerOptions()
+      : max_fps(0),
+        keepalive_fps(0),
+        duplicate_window_ms(0) {
+  }
+
+  /**
+   * @brief The maximum rate frames are written to each port. 0 means no
+   * limit.
+   */
+  unsigned int max_fps;
+
+  /**
+   * @brief The minimum rate frames are written to each port. If no new frame
+   * arrives within 1 / keepalive_fps seconds, the last frame is written
+   * again. 0 disables this.
+   */
+  unsigned int keepalive_fps;
+
+  /**
+   * @brief Frames identical to the last frame written to a port within this
+   * many milliseconds are skipped. 0 disables this.
+   */
+  unsigned int duplicate_window_ms;
+};
+
+
+/**
+ * @brief Limits the rate DMX frames are written to a universe's output ports.
+ *
+ * If a frame arrives less than 1 / max_fps seconds after the last frame was
+ * written to a port, it's held until the interval has passed. If newer frames
+ * arrive in the meantime, they replace the held frame, so only the latest one
+ * is written. This adds at most one frame period of latency.
+ *
+ * With the default options, frames are written to the ports as they arrive.
+ *
+ * For each port, the number of frames written, coalesced (replaced by a newer
+ * frame before being written) and dropped (identical to the last frame
+ * written) are exported, keyed by the port's unique id.
+ */
+class OutputPacer {
+ public:
+  typedef Callback1<void, const OutputPort*> SentCallback;
+
+  /**
+   * @brief Create a new OutputPacer.
+   * @param clock the Clock to use.
+   * @param export_map the ExportMap to use for stats, may be NULL.
+   * @param sent_callback run each time a frame is written to a port, may be
+   *   NULL. Ownership is transferred.
+   */
+  OutputPacer(Clock *clock, ExportMap *export_map,
+              SentCallback *sent_callback = NULL);
+
+  /**
+   * @brief Destructor.
+   *
+   * Held frames are discarded.
+   */
+  ~OutputPacer();
+
+  /**
+   * @brief Change the options.
+   * @param scheduler the scheduler used to write held frames and keepalive
+   *   frames. If this is NULL, max_fps and keepalive_fps are ignored.
+   * @param options the new options.
+   *
+   * Any held frames are written immediately.
+   */
+  void SetOptions(ola::thread::SchedulerInterface *scheduler,
+                  const OutputPacerOptions &options);
+
+  /**
+   * @brief Write a frame to a port, subject to the options.
+   * @param port the port to write to.
+   * @param buffer the DMX data.
+   * @param priority the priority of the data.
+   */
+  void WriteDMX(OutputPort *port, const DmxBuffer &buffer, uint8_t priority);
+
+  /**
+   * @brief Called when a port is removed from the universe.
+   *
+   * Any held frame for the port is discarded.
+   */
+  void RemovePort(const OutputPort *port);
+
+  static const char K_FRAMES_SENT_VAR[];
+  static const char K_FRAMES_COALESCED_VAR[];
+  static const char K_FRAMES_DROPPED_VAR[];
+
+ private:
+  struct PortState {
+    explicit PortState(OutputPort *_port);
+
+    OutputPort *port;
+    std::string id;
+    DmxBuffer last_buffer;
+    uint8_t last_priority;
+    TimeStamp last_sent;
+    DmxBuffer pending_buffer;
+    uint8_t pending_priority;
+    bool has_pending;
+    ola::thread::timeout_id flush_timeout;
+    ola::thread::timeout_id keepalive_timeout;
+    Counter frames_sent;
+    Counter frames_coalesced;
+    Counter frames_dropped;
+  };
+
+  typedef std::map<const OutputPort*, PortState*> PortMap;
+
+  Clock *m_clock;
+  ExportMap *m_export_map;
+  std::auto_ptr<SentCallback> m_sent_callback;
+  ola::thread::SchedulerInterface *m_scheduler;
+  OutputPacerOptions m_options;
+  TimeInterval m_min_interval;
+  TimeInterval m_keepalive_interval;
+  TimeInterval m_duplicate_window;
+  PortMap m_ports;
+
+  bool Enabled() const;
+  bool IsDuplicate(const PortState *state, const DmxBuffer &buffer,
+                   uint8_t priority, const TimeStamp &now) const;
+  void Send(PortState *state, const DmxBuffer &buffer, uint8_t priority,
+            const TimeStamp &now);
+  void Flush(const OutputPort *port);
+  void Keepalive(const OutputPort *port);
+  void ArmKeepalive(PortState *state);
+  void CancelTimeouts(PortState *state);
+
+  DISALLOW_COPY_AND_ASSIGN(OutputPacer);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_OUTPUTPACER_H_
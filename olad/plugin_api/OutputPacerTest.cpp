@@ -0,0 +1,246 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * OutputPacerTest.cpp
+ * Test fixture for the OutputPacer class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include <string>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
+#include "ola/io/SelectServer.h"
+#include "olad/plugin_api/OutputPacer.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxBuffer;
+using ola::ExportMap;
+using ola::MockClock;
+using ola::NewCallback;
+using ola::OutputPacer;
+using ola::OutputPacerOptions;
+using ola::TimeInterval;
+using ola::io::SelectServer;
+using std::auto_ptr;
+using std::string;
+
+class OutputPacerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(OutputPacerTest);
+  CPPUNIT_TEST(testPassThrough);
+  CPPUNIT_TEST(testMaxRate);
+  CPPUNIT_TEST(testDuplicates);
+  CPPUNIT_TEST(testKeepalive);
+  CPPUNIT_TEST(testRemovePort);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  OutputPacerTest()
+      : m_ss(NULL, &m_clock),
+        m_plugin(NULL, ola::OLA_PLUGIN_ARTNET),
+        m_device(&m_plugin, "test device"),
+        m_port1(&m_device, 1),
+        m_port2(&m_device, 2),
+        m_sent_count(0) {
+  }
+
+  void setUp();
+  void tearDown() { m_pacer.reset(); }
+
+  void testPassThrough();
+  void testMaxRate();
+  void testDuplicates();
+  void testKeepalive();
+  void testRemovePort();
+
+ private:
+  MockClock m_clock;
+  SelectServer m_ss;
+  ExportMap m_export_map;
+  auto_ptr<OutputPacer> m_pacer;
+  TestMockPlugin m_plugin;
+  MockDevice m_device;
+  TestMockOutputPort m_port1;
+  TestMockOutputPort m_port2;
+  DmxBuffer m_frame1;
+  DmxBuffer m_frame2;
+  DmxBuffer m_frame3;
+  unsigned int m_sent_count;
+
+  void FrameSent(const ola::OutputPort*) {
+    m_sent_count++;
+  }
+
+  void SetOptions(unsigned int max_fps, unsigned int keepalive_fps,
+                  unsigned int duplicate_window_ms) {
+    OutputPacerOptions options;
+    options.max_fps = max_fps;
+    options.keepalive_fps = keepalive_fps;
+    options.duplicate_window_ms = duplicate_window_ms;
+    m_pacer->SetOptions(&m_ss, options);
+  }
+
+  // Advance the clock & run any timeouts that have expired.
+  void AdvanceTime(unsigned int ms) {
+    m_clock.AdvanceTime(0, ms * 1000);
+    m_ss.RunOnce(TimeInterval(0, 0));
+  }
+
+  unsigned int Counter(const char *var_name, const ola::OutputPort &port) {
+    return (*m_export_map.GetUIntMapVar(var_name))[port.UniqueId()];
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(OutputPacerTest);
+
+
+void OutputPacerTest::setUp() {
+  m_pacer.reset(new OutputPacer(
+      &m_clock, &m_export_map,
+      NewCallback(this, &OutputPacerTest::FrameSent)));
+  m_frame1.SetFromString("1,2,3");
+  m_frame2.SetFromString("4,5,6");
+  m_frame3.SetFromString("7,8,9");
+}
+
+
+/*
+ * With the default options, frames are written as they arrive.
+ */
+void OutputPacerTest::testPassThrough() {
+  m_pacer->WriteDMX(&m_port1, m_frame1, 100);
+  m_pacer->WriteDMX(&m_port1, m_frame1, 100);
+  m_pacer->WriteDMX(&m_port2, m_frame2, 100);
+  OLA_ASSERT_EQ(2u, m_port1.WriteCount());
+  OLA_ASSERT_EQ(1u, m_port2.WriteCount());
+  OLA_ASSERT_EQ(3u, m_sent_count);
+  OLA_ASSERT_EQ(m_frame2, m_port2.ReadDMX());
+}
+
+
+/*
+ * Check frames that arrive too quickly are coalesced.
+ */
+void OutputPacerTest::testMaxRate() {
+  SetOptions(10, 0, 0);
+
+  m_pacer->WriteDMX(&m_port1, m_frame1, 100);
+  OLA_ASSERT_EQ(1u, m_port1.WriteCount());
+
+  // These arrive within 100ms, so only the last is written.
+  m_pacer->WriteDMX(&m_port1, m_frame2, 100);
+  m_pacer->WriteDMX(&m_port1, m_frame3, 100);
+  OLA_ASSERT_EQ(1u, m_port1.WriteCount());
+  OLA_ASSERT_EQ(m_frame1, m_port1.ReadDMX());
+
+  // Port 2 isn't affected by port 1.
+  m_pacer->WriteDMX(&m_port2, m_frame2, 100);
+  OLA_ASSERT_EQ(1u, m_port2.WriteCount());
+
+  AdvanceTime(150);
+  OLA_ASSERT_EQ(2u, m_port1.WriteCount());
+  OLA_ASSERT_EQ(m_frame3, m_port1.ReadDMX());
+  OLA_ASSERT_EQ(3u, m_sent_count);
+
+  OLA_ASSERT_EQ(2u, Counter(OutputPacer::K_FRAMES_SENT_VAR, m_port1));
+  OLA_ASSERT_EQ(1u, Counter(OutputPacer::K_FRAMES_COALESCED_VAR, m_port1));
+  OLA_ASSERT_EQ(0u, Counter(OutputPacer::K_FRAMES_DROPPED_VAR, m_port1));
+
+  // Nothing is held, so the next frame after the interval is written
+  // immediately.
+  AdvanceTime(150);
+  m_pacer->WriteDMX(&m_port1, m_frame1, 100);
+  OLA_ASSERT_EQ(3u, m_port1.WriteCount());
+}
+
+
+/*
+ * Check identical frames are skipped.
+ */
+void OutputPacerTest::testDuplicates() {
+  SetOptions(0, 0, 1000);
+
+  m_pacer->WriteDMX(&m_port1, m_frame1, 100);
+  m_pacer->WriteDMX(&m_port1, m_frame1, 100);
+  OLA_ASSERT_EQ(1u, m_port1.WriteCount());
+
+  // A change in priority isn't a duplicate.
+  m_pacer->WriteDMX(&m_port1, m_frame1, 101);
+  OLA_ASSERT_EQ(2u, m_port1.WriteCount());
+
+  m_pacer->WriteDMX(&m_port1, m_frame2, 101);
+  m_pacer->WriteDMX(&m_port1, m_frame2, 101);
+  OLA_ASSERT_EQ(3u, m_port1.WriteCount());
+
+  // Once the window has passed, the frame is written again.
+  AdvanceTime(1100);
+  m_pacer->WriteDMX(&m_port1, m_frame2, 101);
+  OLA_ASSERT_EQ(4u, m_port1.WriteCount());
+
+  OLA_ASSERT_EQ(4u, Counter(OutputPacer::K_FRAMES_SENT_VAR, m_port1));
+  OLA_ASSERT_EQ(2u, Counter(OutputPacer::K_FRAMES_DROPPED_VAR, m_port1));
+}
+
+
+/*
+ * Check the last frame is repeated if nothing new arrives.
+ */
+void OutputPacerTest::testKeepalive() {
+  SetOptions(0, 2, 0);
+
+  m_pacer->WriteDMX(&m_port1, m_frame1, 100);
+  OLA_ASSERT_EQ(1u, m_port1.WriteCount());
+
+  AdvanceTime(600);
+  OLA_ASSERT_EQ(2u, m_port1.WriteCount());
+  OLA_ASSERT_EQ(m_frame1, m_port1.ReadDMX());
+
+  // A new frame restarts the timer.
+  AdvanceTime(300);
+  m_pacer->WriteDMX(&m_port1, m_frame2, 100);
+  OLA_ASSERT_EQ(3u, m_port1.WriteCount());
+  AdvanceTime(300);
+  OLA_ASSERT_EQ(3u, m_port1.WriteCount());
+  AdvanceTime(300);
+  OLA_ASSERT_EQ(4u, m_port1.WriteCount());
+  OLA_ASSERT_EQ(m_frame2, m_port1.ReadDMX());
+  OLA_ASSERT_EQ(0u, m_port2.WriteCount());
+}
+
+
+/*
+ * Check held frames are discarded when a port is removed.
+ */
+void OutputPacerTest::testRemovePort() {
+  SetOptions(10, 1, 0);
+
+  m_pacer->WriteDMX(&m_port1, m_frame1, 100);
+  m_pacer->WriteDMX(&m_port1, m_frame2, 100);
+  OLA_ASSERT_EQ(1u, m_port1.WriteCount());
+
+  m_pacer->RemovePort(&m_port1);
+  OLA_ASSERT_EQ(string("map:port"),
+                m_export_map.GetUIntMapVar(
+                    OutputPacer::K_FRAMES_SENT_VAR)->Value());
+
+  AdvanceTime(1500);
+  OLA_ASSERT_EQ(1u, m_port1.WriteCount());
+  OLA_ASSERT_EQ(m_frame1, m_port1.ReadDMX());
+}
@@ -0,0 +1,138 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * OutputSyncGroup.cpp
+ * Sends the frames for a group of output ports together, followed by a sync
+ * message.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/OutputSyncGroup.h"
+
+namespace ola {
+
+using ola::thread::INVALID_TIMEOUT;
+
+OutputSyncGroup::OutputSyncGroup(ola::thread::SchedulerInterface *scheduler,
+                                 unsigned int max_wait_ms,
+                                 SyncCallback *sync_callback)
+    : m_scheduler(scheduler),
+      m_max_wait_ms(max_wait_ms),
+      m_sync_callback(sync_callback),
+      m_held_count(0),
+      m_active_count(0),
+      m_timeout(INVALID_TIMEOUT) {
+}
+
+OutputSyncGroup::~OutputSyncGroup() {
+  CancelTimeout();
+  STLDeleteValues(&m_ports);
+}
+
+void OutputSyncGroup::AddPort(const OutputPort *port,
+                              SendCallback *send_callback) {
+  RemovePort(port);
+  m_ports[port] = new PortState(send_callback);
+  m_active_count++;
+}
+
+void OutputSyncGroup::RemovePort(const OutputPort *port) {
+  PortMap::iterator iter = m_ports.find(port);
+  if (iter == m_ports.end()) {
+    return;
+  }
+
+  if (iter->second->held) {
+    m_held_count--;
+  }
+  if (iter->second->active) {
+    m_active_count--;
+  }
+  delete iter->second;
+  m_ports.erase(iter);
+
+  if (!m_held_count) {
+    CancelTimeout();
+  } else if (m_held_count == m_active_count) {
+    // The port we were waiting on has gone.
+    Flush();
+  }
+}
+
+bool OutputSyncGroup::WriteDMX(const OutputPort *port,
+                               const DmxBuffer &buffer,
+                               uint8_t priority) {
+  PortState *state = STLFindOrNull(m_ports, port);
+  if (!state) {
+    return false;
+  }
+
+  if (state->held) {
+    // The source has started the next frame, send the current one.
+    Flush();
+  }
+
+  state->buffer.Set(buffer);
+  state->priority = priority;
+  state->held = true;
+  m_held_count++;
+  if (!state->active) {
+    state->active = true;
+    m_active_count++;
+  }
+
+  if (m_held_count == m_active_count) {
+    Flush();
+  } else if (m_timeout == INVALID_TIMEOUT) {
+    m_timeout = m_scheduler->RegisterSingleTimeout(
+        m_max_wait_ms,
+        NewSingleCallback(this, &OutputSyncGroup::Flush));
+  }
+  return true;
+}
+
+void OutputSyncGroup::Flush() {
+  CancelTimeout();
+  if (!m_held_count) {
+    return;
+  }
+
+  // The ports without a frame aren't waited for next time.
+  PortMap::iterator iter = m_ports.begin();
+  for (; iter != m_ports.end(); ++iter) {
+    PortState *state = iter->second;
+    state->active = state->held;
+    if (state->held) {
+      state->held = false;
+      if (!state->send_callback->Run(state->buffer, state->priority)) {
+        OLA_INFO << "Failed to send a frame for a synchronized port";
+      }
+    }
+  }
+  m_active_count = m_held_count;
+  m_held_count = 0;
+  m_sync_callback->Run();
+}
+
+void OutputSyncGroup::CancelTimeout() {
+  if (m_timeout != INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_timeout);
+    m_timeout = INVALID_TIMEOUT;
+  }
+}
+}  // namespace ola
@@ -0,0 +1,273 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * OutputSyncGroupTest.cpp
+ * Test fixture for the OutputSyncGroup class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/io/SelectServer.h"
+#include "ola/strings/Format.h"
+#include "olad/OutputSyncGroup.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::DmxBuffer;
+using ola::MockClock;
+using ola::NewCallback;
+using ola::OutputSyncGroup;
+using ola::TimeInterval;
+using ola::io::SelectServer;
+using std::auto_ptr;
+using std::string;
+using std::vector;
+
+class OutputSyncGroupTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(OutputSyncGroupTest);
+  CPPUNIT_TEST(testAllPortsWritten);
+  CPPUNIT_TEST(testNextFrame);
+  CPPUNIT_TEST(testTimeout);
+  CPPUNIT_TEST(testIdlePort);
+  CPPUNIT_TEST(testRemovePort);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  OutputSyncGroupTest()
+      : m_ss(NULL, &m_clock),
+        m_plugin(NULL, ola::OLA_PLUGIN_E131),
+        m_device(&m_plugin, "test device"),
+        m_port1(&m_device, 1),
+        m_port2(&m_device, 2),
+        m_port3(&m_device, 3),
+        m_sync_count(0) {
+  }
+
+  void setUp();
+  void tearDown() { m_group.reset(); }
+
+  void testAllPortsWritten();
+  void testNextFrame();
+  void testTimeout();
+  void testIdlePort();
+  void testRemovePort();
+
+ private:
+  MockClock m_clock;
+  SelectServer m_ss;
+  auto_ptr<OutputSyncGroup> m_group;
+  TestMockPlugin m_plugin;
+  MockDevice m_device;
+  TestMockOutputPort m_port1;
+  TestMockOutputPort m_port2;
+  TestMockOutputPort m_port3;
+  DmxBuffer m_frame1;
+  DmxBuffer m_frame2;
+  // The ports & sync messages in the order they were sent, a sync message is
+  // recorded as "sync".
+  vector<string> m_sent;
+  std::map<unsigned int, DmxBuffer> m_last_frame;
+  unsigned int m_sync_count;
+
+  bool SendFrame(unsigned int port_id, const DmxBuffer &buffer, uint8_t) {
+    m_sent.push_back(ola::strings::IntToString(port_id));
+    m_last_frame[port_id] = buffer;
+    return true;
+  }
+
+  void SyncSent() {
+    m_sent.push_back("sync");
+    m_sync_count++;
+  }
+
+  void AddPort(TestMockOutputPort *port) {
+    m_group->AddPort(
+        port,
+        NewCallback(this, &OutputSyncGroupTest::SendFrame, port->PortId()));
+  }
+
+  string Sent() {
+    string output;
+    vector<string>::const_iterator iter = m_sent.begin();
+    for (; iter != m_sent.end(); ++iter) {
+      if (!output.empty()) {
+        output.append(",");
+      }
+      output.append(*iter);
+    }
+    m_sent.clear();
+    return output;
+  }
+
+  // Advance the clock & run any timeouts that have expired.
+  void AdvanceTime(unsigned int ms) {
+    m_clock.AdvanceTime(0, ms * 1000);
+    m_ss.RunOnce(TimeInterval(0, 0));
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(OutputSyncGroupTest);
+
+
+void OutputSyncGroupTest::setUp() {
+  m_group.reset(new OutputSyncGroup(
+      &m_ss, 50, NewCallback(this, &OutputSyncGroupTest::SyncSent)));
+  AddPort(&m_port1);
+  AddPort(&m_port2);
+  AddPort(&m_port3);
+  m_frame1.SetFromString("1,2,3");
+  m_frame2.SetFromString("4,5,6");
+}
+
+
+/*
+ * Check frames are held until every port has one.
+ */
+void OutputSyncGroupTest::testAllPortsWritten() {
+  OLA_ASSERT_EQ(3u, m_group->PortCount());
+
+  OLA_ASSERT_TRUE(m_group->WriteDMX(&m_port2, m_frame1, 100));
+  OLA_ASSERT_TRUE(m_group->WriteDMX(&m_port1, m_frame2, 100));
+  OLA_ASSERT_EQ(2u, m_group->HeldCount());
+  OLA_ASSERT_EQ(string(""), Sent());
+
+  OLA_ASSERT_TRUE(m_group->WriteDMX(&m_port3, m_frame1, 100));
+  OLA_ASSERT_EQ(0u, m_group->HeldCount());
+  OLA_ASSERT_EQ(string("1,2,3,sync"), Sent());
+  OLA_ASSERT_EQ(m_frame2, m_last_frame[1]);
+  OLA_ASSERT_EQ(m_frame1, m_last_frame[2]);
+
+  // The timeout was cancelled.
+  AdvanceTime(100);
+  OLA_ASSERT_EQ(string(""), Sent());
+  OLA_ASSERT_EQ(1u, m_sync_count);
+
+  // Ports that aren't in the group are rejected.
+  TestMockOutputPort other_port(&m_device, 4);
+  OLA_ASSERT_FALSE(m_group->WriteDMX(&other_port, m_frame1, 100));
+}
+
+
+/*
+ * Check a second write to a port sends the held frames first.
+ */
+void OutputSyncGroupTest::testNextFrame() {
+  m_group->WriteDMX(&m_port1, m_frame1, 100);
+  m_group->WriteDMX(&m_port2, m_frame1, 100);
+  m_group->WriteDMX(&m_port1, m_frame2, 100);
+  OLA_ASSERT_EQ(string("1,2,sync"), Sent());
+  OLA_ASSERT_EQ(m_frame1, m_last_frame[1]);
+
+  // The new frame is held.
+  OLA_ASSERT_EQ(1u, m_group->HeldCount());
+  m_group->Flush();
+  OLA_ASSERT_EQ(string("1,sync"), Sent());
+  OLA_ASSERT_EQ(m_frame2, m_last_frame[1]);
+
+  // Flushing with nothing held doesn't send a sync message.
+  m_group->Flush();
+  OLA_ASSERT_EQ(string(""), Sent());
+}
+
+
+/*
+ * Check held frames are sent after max_wait_ms.
+ */
+void OutputSyncGroupTest::testTimeout() {
+  m_group->WriteDMX(&m_port3, m_frame1, 100);
+  AdvanceTime(30);
+  m_group->WriteDMX(&m_port1, m_frame1, 100);
+  OLA_ASSERT_EQ(string(""), Sent());
+
+  // The wait starts at the first held frame.
+  AdvanceTime(30);
+  OLA_ASSERT_EQ(string("1,3,sync"), Sent());
+  OLA_ASSERT_EQ(0u, m_group->HeldCount());
+
+  AdvanceTime(100);
+  OLA_ASSERT_EQ(string(""), Sent());
+}
+
+
+/*
+ * Check a port that stops being written to only delays one frame.
+ */
+void OutputSyncGroupTest::testIdlePort() {
+  OLA_ASSERT_EQ(3u, m_group->ActiveCount());
+  m_group->WriteDMX(&m_port1, m_frame1, 100);
+  m_group->WriteDMX(&m_port2, m_frame1, 100);
+  AdvanceTime(50);
+  OLA_ASSERT_EQ(string("1,2,sync"), Sent());
+  OLA_ASSERT_EQ(2u, m_group->ActiveCount());
+
+  // Port 3 isn't waited for any more.
+  for (unsigned int i = 0; i < 3; i++) {
+    m_group->WriteDMX(&m_port2, m_frame2, 100);
+    m_group->WriteDMX(&m_port1, m_frame2, 100);
+    OLA_ASSERT_EQ(string("1,2,sync"), Sent());
+  }
+
+  // Once it's written to again, it's waited for.
+  m_group->WriteDMX(&m_port3, m_frame1, 100);
+  OLA_ASSERT_EQ(3u, m_group->ActiveCount());
+  m_group->WriteDMX(&m_port1, m_frame1, 100);
+  OLA_ASSERT_EQ(string(""), Sent());
+  m_group->WriteDMX(&m_port2, m_frame1, 100);
+  OLA_ASSERT_EQ(string("1,2,3,sync"), Sent());
+
+  // If port 3 misses a frame, the next one isn't held for it.
+  m_group->WriteDMX(&m_port1, m_frame2, 100);
+  m_group->WriteDMX(&m_port2, m_frame2, 100);
+  m_group->WriteDMX(&m_port1, m_frame1, 100);
+  OLA_ASSERT_EQ(string("1,2,sync"), Sent());
+  OLA_ASSERT_EQ(2u, m_group->ActiveCount());
+  m_group->WriteDMX(&m_port2, m_frame1, 100);
+  OLA_ASSERT_EQ(string("1,2,sync"), Sent());
+}
+
+
+/*
+ * Check removing ports.
+ */
+void OutputSyncGroupTest::testRemovePort() {
+  m_group->WriteDMX(&m_port1, m_frame1, 100);
+  m_group->WriteDMX(&m_port2, m_frame1, 100);
+
+  // Port 3 was the one we were waiting on.
+  m_group->RemovePort(&m_port3);
+  OLA_ASSERT_EQ(2u, m_group->PortCount());
+  OLA_ASSERT_EQ(string("1,2,sync"), Sent());
+
+  // A held frame is discarded when the port is removed.
+  m_group->WriteDMX(&m_port1, m_frame1, 100);
+  m_group->RemovePort(&m_port1);
+  OLA_ASSERT_EQ(0u, m_group->HeldCount());
+  AdvanceTime(100);
+  OLA_ASSERT_EQ(string(""), Sent());
+
+  // With one port left, each frame is sent as it arrives.
+  m_group->WriteDMX(&m_port2, m_frame2, 100);
+  OLA_ASSERT_EQ(string("2,sync"), Sent());
+  m_group->RemovePort(&m_port2);
+  OLA_ASSERT_EQ(0u, m_group->PortCount());
+}
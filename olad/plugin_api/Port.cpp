@@ -83,11 +83,18 @@ bool BasicInputPort::SetPriority(uint8_t priority) {
 void BasicInputPort::DmxChanged() {
   if (GetUniverse()) {
     const DmxBuffer &buffer = ReadDMX();
-    uint8_t priority = (PriorityCapability() == CAPABILITY_FULL &&
-                        GetPriorityMode() == PRIORITY_MODE_INHERIT ?
-                        InheritedPriority() :
-                        GetPriority());
-    m_dmx_source.UpdateData(buffer, *m_plugin_adaptor->WakeUpTime(), priority);
+    bool inherit = (PriorityCapability() == CAPABILITY_FULL &&
+                    GetPriorityMode() == PRIORITY_MODE_INHERIT);
+    uint8_t priority = inherit ? InheritedPriority() : GetPriority();
+    const DmxBuffer *slot_priorities = (
+        inherit ? InheritedSlotPriorities() : NULL);
+    if (slot_priorities && slot_priorities->Size()) {
+      m_dmx_source.UpdateData(buffer, *slot_priorities,
+                              *m_plugin_adaptor->WakeUpTime(), priority);
+    } else {
+      m_dmx_source.UpdateData(buffer, *m_plugin_adaptor->WakeUpTime(),
+                              priority);
+    }
     GetUniverse()->PortDataChanged(this);
   }
 }
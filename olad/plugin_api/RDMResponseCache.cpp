@@ -0,0 +1,256 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMResponseCache.cpp
+ * Caches the responses to RDM GETs for parameters that rarely change.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <string>
+
+#include "ola/Logging.h"
+#include "ola/base/Array.h"
+#include "ola/rdm/RDMEnums.h"
+#include "olad/plugin_api/RDMResponseCache.h"
+
+namespace ola {
+
+using ola::rdm::RDMCommand;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::RDMResponse;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using std::string;
+
+namespace {
+
+// Parameters which are fixed for the lifetime of a responder.
+const unsigned int STATIC_MAX_AGE = 600;
+// Parameters which only change when the responder is reconfigured. We'll
+// usually find out about a change from a SET or a queued message, this limits
+// how long we're wrong for if the change was made from the front panel.
+const unsigned int CONFIGURATION_MAX_AGE = 30;
+
+struct CacheablePID {
+  uint16_t pid;
+  unsigned int max_age;
+};
+
+const CacheablePID CACHEABLE_PIDS[] = {
+  {ola::rdm::PID_STATUS_ID_DESCRIPTION, STATIC_MAX_AGE},
+  {ola::rdm::PID_SUPPORTED_PARAMETERS, STATIC_MAX_AGE},
+  {ola::rdm::PID_PARAMETER_DESCRIPTION, STATIC_MAX_AGE},
+  {ola::rdm::PID_DEVICE_INFO, CONFIGURATION_MAX_AGE},
+  {ola::rdm::PID_PRODUCT_DETAIL_ID_LIST, STATIC_MAX_AGE},
+  {ola::rdm::PID_DEVICE_MODEL_DESCRIPTION, STATIC_MAX_AGE},
+  {ola::rdm::PID_MANUFACTURER_LABEL, STATIC_MAX_AGE},
+  {ola::rdm::PID_DEVICE_LABEL, CONFIGURATION_MAX_AGE},
+  {ola::rdm::PID_LANGUAGE_CAPABILITIES, STATIC_MAX_AGE},
+  {ola::rdm::PID_SOFTWARE_VERSION_LABEL, STATIC_MAX_AGE},
+  {ola::rdm::PID_BOOT_SOFTWARE_VERSION_ID, STATIC_MAX_AGE},
+  {ola::rdm::PID_BOOT_SOFTWARE_VERSION_LABEL, STATIC_MAX_AGE},
+  {ola::rdm::PID_DMX_PERSONALITY, CONFIGURATION_MAX_AGE},
+  {ola::rdm::PID_DMX_PERSONALITY_DESCRIPTION, STATIC_MAX_AGE},
+  {ola::rdm::PID_DMX_START_ADDRESS, CONFIGURATION_MAX_AGE},
+  {ola::rdm::PID_SLOT_INFO, CONFIGURATION_MAX_AGE},
+  {ola::rdm::PID_SLOT_DESCRIPTION, CONFIGURATION_MAX_AGE},
+  {ola::rdm::PID_DEFAULT_SLOT_VALUE, CONFIGURATION_MAX_AGE},
+  {ola::rdm::PID_SENSOR_DEFINITION, STATIC_MAX_AGE},
+  {ola::rdm::PID_SELF_TEST_DESCRIPTION, STATIC_MAX_AGE},
+};
+}  // namespace
+
+const unsigned int RDMResponseCache::K_MAX_ENTRIES = 50000;
+
+bool RDMResponseCache::Key::operator<(const Key &other) const {
+  if (uid != other.uid) {
+    return uid < other.uid;
+  }
+  if (sub_device != other.sub_device) {
+    return sub_device < other.sub_device;
+  }
+  if (pid != other.pid) {
+    return pid < other.pid;
+  }
+  return param_data < other.param_data;
+}
+
+RDMResponseCache::RDMResponseCache(Clock *clock)
+    : m_clock(clock) {
+}
+
+bool RDMResponseCache::IsCacheable(const RDMRequest &request) {
+  return (request.CommandClass() == RDMCommand::GET_COMMAND &&
+          !request.DestinationUID().IsBroadcast() &&
+          !request.BypassCache() &&
+          MaxAge(request.ParamId()) != 0);
+}
+
+RDMResponse *RDMResponseCache::Lookup(const RDMRequest &request) {
+  if (!IsCacheable(request)) {
+    return NULL;
+  }
+
+  EntryMap::iterator iter = m_entries.find(RequestKey(request));
+  if (iter == m_entries.end()) {
+    return NULL;
+  }
+
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  if (iter->second.expires <= now) {
+    m_entries.erase(iter);
+    return NULL;
+  }
+
+  const string &data = iter->second.param_data;
+  return new RDMResponse(
+      request.DestinationUID(),
+      request.SourceUID(),
+      request.TransactionNumber(),
+      ola::rdm::RDM_ACK,
+      0,
+      request.SubDevice(),
+      RDMCommand::GET_COMMAND_RESPONSE,
+      request.ParamId(),
+      reinterpret_cast<const uint8_t*>(data.data()),
+      data.size());
+}
+
+void RDMResponseCache::RequestSent(const RDMRequest &request) {
+  if (request.CommandClass() == RDMCommand::SET_COMMAND) {
+    RemoveUID(request.DestinationUID());
+  }
+}
+
+void RDMResponseCache::ReplyReceived(const RDMRequest &request,
+                                     const RDMReply &reply) {
+  const UID &uid = request.DestinationUID();
+  const RDMResponse *response = reply.Response();
+
+  if (request.CommandClass() == RDMCommand::SET_COMMAND ||
+      (request.CommandClass() == RDMCommand::GET_COMMAND &&
+       request.ParamId() == ola::rdm::PID_QUEUED_MESSAGE)) {
+    // A GET which was in flight when the SET was sent may have been stored,
+    // so we remove the entries again here.
+    RemoveUID(uid);
+    return;
+  }
+
+  if (!response) {
+    return;
+  }
+
+  if (response->MessageCount()) {
+    // The responder has something to tell us, which may be a change to one of
+    // the parameters we've cached.
+    RemoveUID(uid);
+    return;
+  }
+
+  if (reply.StatusCode() != ola::rdm::RDM_COMPLETED_OK ||
+      !IsCacheable(request) ||
+      response->ResponseType() != ola::rdm::RDM_ACK ||
+      response->CommandClass() != RDMCommand::GET_COMMAND_RESPONSE ||
+      response->SourceUID() != uid ||
+      response->SubDevice() != request.SubDevice() ||
+      response->ParamId() != request.ParamId()) {
+    return;
+  }
+
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+
+  if (m_entries.size() >= K_MAX_ENTRIES) {
+    RemoveExpired(now);
+    if (m_entries.size() >= K_MAX_ENTRIES) {
+      OLA_INFO << "RDM response cache is full";
+      return;
+    }
+  }
+
+  Entry &entry = m_entries[RequestKey(request)];
+  entry.param_data.clear();
+  if (response->ParamDataSize()) {
+    entry.param_data.assign(
+        reinterpret_cast<const char*>(response->ParamData()),
+        response->ParamDataSize());
+  }
+  entry.expires = now + TimeInterval(MaxAge(request.ParamId()), 0);
+}
+
+void RDMResponseCache::RetainUIDs(const UIDSet &uids) {
+  EntryMap::iterator iter = m_entries.begin();
+  while (iter != m_entries.end()) {
+    if (uids.Contains(iter->first.uid)) {
+      ++iter;
+    } else {
+      m_entries.erase(iter++);
+    }
+  }
+}
+
+void RDMResponseCache::RemoveUID(const UID &uid) {
+  if (uid.IsBroadcast()) {
+    EntryMap::iterator iter = m_entries.begin();
+    while (iter != m_entries.end()) {
+      if (uid.DirectedToUID(iter->first.uid)) {
+        m_entries.erase(iter++);
+      } else {
+        ++iter;
+      }
+    }
+    return;
+  }
+
+  // The entries are ordered by UID, so all the entries for this UID are
+  // adjacent.
+  EntryMap::iterator iter = m_entries.lower_bound(Key(uid, 0, 0, ""));
+  while (iter != m_entries.end() && iter->first.uid == uid) {
+    m_entries.erase(iter++);
+  }
+}
+
+void RDMResponseCache::RemoveExpired(const TimeStamp &now) {
+  EntryMap::iterator iter = m_entries.begin();
+  while (iter != m_entries.end()) {
+    if (iter->second.expires <= now) {
+      m_entries.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+RDMResponseCache::Key RDMResponseCache::RequestKey(const RDMRequest &request) {
+  string param_data;
+  if (request.ParamDataSize()) {
+    param_data.assign(reinterpret_cast<const char*>(request.ParamData()),
+                      request.ParamDataSize());
+  }
+  return Key(request.DestinationUID(), request.SubDevice(), request.ParamId(),
+             param_data);
+}
+
+unsigned int RDMResponseCache::MaxAge(uint16_t pid) {
+  for (unsigned int i = 0; i < arraysize(CACHEABLE_PIDS); i++) {
+    if (CACHEABLE_PIDS[i].pid == pid) {
+      return CACHEABLE_PIDS[i].max_age;
+    }
+  }
+  return 0;
+}
+}  // namespace ola
@@ -0,0 +1,155 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMResponseCache.h
+ * Caches the responses to RDM GETs for parameters that rarely change.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_PLUGIN_API_RDMRESPONSECACHE_H_
+#define OLAD_PLUGIN_API_RDMRESPONSECACHE_H_
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include "ola/Clock.h"
+#include "ola/base/Macro.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+
+namespace ola {
+
+/**
+ * @brief Caches the responses to RDM GETs for parameters that rarely change.
+ *
+ * Entries are keyed by the UID, sub device, PID and parameter data of the
+ * request. Only ACKs to GETs for the PIDs listed in RDMResponseCache.cpp are
+ * stored, which are either fixed for the lifetime of the responder (labels,
+ * descriptions, definitions) or only change when the responder is
+ * reconfigured (DEVICE_INFO, DMX_START_ADDRESS, personalities).
+ *
+ * All entries for a responder are removed when:
+ *  - A SET is sent to it, since a SET can change any other parameter.
+ *  - It reports that it has queued messages, or a QUEUED_MESSAGE is fetched.
+ *  - It's no longer present after discovery.
+ *
+ * Each entry also has a maximum age, which catches changes made from the
+ * responder's front panel if it doesn't support queued messages.
+ */
+class RDMResponseCache {
+ public:
+  /**
+   * @brief Create a new RDMResponseCache.
+   * @param clock the Clock used to expire entries.
+   */
+  explicit RDMResponseCache(Clock *clock);
+  ~RDMResponseCache() {}
+
+  /**
+   * @brief Check if the response to a request may be served from the cache.
+   * @param request the request to check.
+   * @returns true if the request is a GET, to a single responder, for a PID
+   *   that we cache.
+   */
+  static bool IsCacheable(const ola::rdm::RDMRequest &request);
+
+  /**
+   * @brief Lookup the response to a request.
+   * @param request the request to lookup.
+   * @returns a new RDMResponse, addressed to the source of the request, or
+   *   NULL if there isn't a valid entry. Ownership is transferred to the
+   *   caller.
+   */
+  ola::rdm::RDMResponse *Lookup(const ola::rdm::RDMRequest &request);
+
+  /**
+   * @brief Called before a request is sent to the responders.
+   * @param request the request that is about to be sent.
+   */
+  void RequestSent(const ola::rdm::RDMRequest &request);
+
+  /**
+   * @brief Called when the reply to a request is received.
+   * @param request the request that was sent.
+   * @param reply the reply to the request.
+   */
+  void ReplyReceived(const ola::rdm::RDMRequest &request,
+                     const ola::rdm::RDMReply &reply);
+
+  /**
+   * @brief Remove all entries for responders that aren't in a set.
+   * @param uids the responders to keep the entries for.
+   */
+  void RetainUIDs(const ola::rdm::UIDSet &uids);
+
+  /**
+   * @brief Remove all entries for a responder.
+   * @param uid the UID of the responder, this may be a broadcast or
+   *   vendorcast UID.
+   */
+  void RemoveUID(const ola::rdm::UID &uid);
+
+  /**
+   * @brief Remove all entries.
+   */
+  void Clear() { m_entries.clear(); }
+
+  /**
+   * @brief The number of entries in the cache.
+   */
+  unsigned int Size() const { return m_entries.size(); }
+
+  static const unsigned int K_MAX_ENTRIES;
+
+ private:
+  struct Key {
+    Key(const ola::rdm::UID &_uid, uint16_t _sub_device, uint16_t _pid,
+        const std::string &_param_data)
+        : uid(_uid),
+          sub_device(_sub_device),
+          pid(_pid),
+          param_data(_param_data) {
+    }
+
+    ola::rdm::UID uid;
+    uint16_t sub_device;
+    uint16_t pid;
+    std::string param_data;
+
+    bool operator<(const Key &other) const;
+  };
+
+  struct Entry {
+    std::string param_data;
+    TimeStamp expires;
+  };
+
+  typedef std::map<Key, Entry> EntryMap;
+
+  Clock *m_clock;
+  EntryMap m_entries;
+
+  void RemoveExpired(const TimeStamp &now);
+
+  static Key RequestKey(const ola::rdm::RDMRequest &request);
+  // Returns the maximum age in seconds, or 0 if the PID isn't cached.
+  static unsigned int MaxAge(uint16_t pid);
+
+  DISALLOW_COPY_AND_ASSIGN(RDMResponseCache);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_RDMRESPONSECACHE_H_
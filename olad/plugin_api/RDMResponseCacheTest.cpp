@@ -0,0 +1,323 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMResponseCacheTest.cpp
+ * Test fixture for the RDMResponseCache class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+
+#include "ola/Clock.h"
+#include "ola/base/Array.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+#include "olad/plugin_api/RDMResponseCache.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::MockClock;
+using ola::RDMResponseCache;
+using ola::rdm::GetResponseFromData;
+using ola::rdm::GetResponseWithPid;
+using ola::rdm::NackWithReason;
+using ola::rdm::RDMGetRequest;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::RDMResponse;
+using ola::rdm::RDMSetRequest;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using std::auto_ptr;
+
+class RDMResponseCacheTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RDMResponseCacheTest);
+  CPPUNIT_TEST(testCacheable);
+  CPPUNIT_TEST(testLookup);
+  CPPUNIT_TEST(testExpiry);
+  CPPUNIT_TEST(testSetInvalidates);
+  CPPUNIT_TEST(testQueuedMessagesInvalidate);
+  CPPUNIT_TEST(testRetainUIDs);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  RDMResponseCacheTest()
+      : m_controller(0x7a70, 100),
+        m_other_controller(0x7a70, 101),
+        m_uid1(0x7a70, 1),
+        m_uid2(0x7a70, 2),
+        m_uid3(0x0808, 3) {
+  }
+
+  void testCacheable();
+  void testLookup();
+  void testExpiry();
+  void testSetInvalidates();
+  void testQueuedMessagesInvalidate();
+  void testRetainUIDs();
+
+ private:
+  MockClock m_clock;
+  UID m_controller;
+  UID m_other_controller;
+  UID m_uid1, m_uid2, m_uid3;
+
+  RDMRequest *NewGet(const UID &destination, uint16_t pid,
+                     const uint8_t *data = NULL, unsigned int length = 0,
+                     const UID *source = NULL) {
+    return new RDMGetRequest(source ? *source : m_controller, destination, 0,
+                             1, 0, pid, data, length);
+  }
+
+  RDMRequest *NewSet(const UID &destination, uint16_t pid) {
+    const uint8_t data[] = {1, 2};
+    return new RDMSetRequest(m_controller, destination, 0, 1, 0, pid,
+                             data, arraysize(data));
+  }
+
+  // Send a GET and ACK it with some data.
+  void StoreResponse(RDMResponseCache *cache, const UID &destination,
+                     uint16_t pid, uint8_t message_count = 0) {
+    auto_ptr<RDMRequest> request(NewGet(destination, pid));
+    const uint8_t data[] = {'l', 'a', 'b', 'e', 'l'};
+    cache->RequestSent(*request);
+    RDMReply reply(ola::rdm::RDM_COMPLETED_OK,
+                   GetResponseFromData(request.get(), data, arraysize(data),
+                                       ola::rdm::RDM_ACK, message_count));
+    cache->ReplyReceived(*request, reply);
+  }
+
+  bool IsCached(RDMResponseCache *cache, const UID &destination,
+                uint16_t pid) {
+    auto_ptr<RDMRequest> request(NewGet(destination, pid));
+    auto_ptr<RDMResponse> response(cache->Lookup(*request));
+    return response.get() != NULL;
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RDMResponseCacheTest);
+
+
+/*
+ * Check which requests can be cached.
+ */
+void RDMResponseCacheTest::testCacheable() {
+  auto_ptr<RDMRequest> request(
+      NewGet(m_uid1, ola::rdm::PID_MANUFACTURER_LABEL));
+  OLA_ASSERT_TRUE(RDMResponseCache::IsCacheable(*request));
+
+  // Dynamic PIDs aren't cached
+  request.reset(NewGet(m_uid1, ola::rdm::PID_SENSOR_VALUE));
+  OLA_ASSERT_FALSE(RDMResponseCache::IsCacheable(*request));
+
+  // Nor are SETs or broadcasts
+  request.reset(NewSet(m_uid1, ola::rdm::PID_DEVICE_LABEL));
+  OLA_ASSERT_FALSE(RDMResponseCache::IsCacheable(*request));
+  request.reset(NewGet(UID::AllDevices(), ola::rdm::PID_MANUFACTURER_LABEL));
+  OLA_ASSERT_FALSE(RDMResponseCache::IsCacheable(*request));
+
+  // Or requests that asked to bypass the cache, or that override the frame
+  // fields.
+  RDMRequest::OverrideOptions options;
+  options.bypass_cache = true;
+  request.reset(new RDMGetRequest(m_controller, m_uid1, 0, 1, 0,
+                                  ola::rdm::PID_MANUFACTURER_LABEL, NULL, 0,
+                                  options));
+  OLA_ASSERT_FALSE(RDMResponseCache::IsCacheable(*request));
+
+  RDMRequest::OverrideOptions checksum_options;
+  checksum_options.SetChecksum(1234);
+  request.reset(new RDMGetRequest(m_controller, m_uid1, 0, 1, 0,
+                                  ola::rdm::PID_MANUFACTURER_LABEL, NULL, 0,
+                                  checksum_options));
+  OLA_ASSERT_FALSE(RDMResponseCache::IsCacheable(*request));
+
+  // The bypass flag is kept when the request is copied.
+  request.reset(request->Duplicate());
+  OLA_ASSERT_FALSE(RDMResponseCache::IsCacheable(*request));
+}
+
+
+/*
+ * Check responses are stored & returned.
+ */
+void RDMResponseCacheTest::testLookup() {
+  RDMResponseCache cache(&m_clock);
+  OLA_ASSERT_FALSE(IsCached(&cache, m_uid1, ola::rdm::PID_MANUFACTURER_LABEL));
+
+  StoreResponse(&cache, m_uid1, ola::rdm::PID_MANUFACTURER_LABEL);
+  OLA_ASSERT_EQ(1u, cache.Size());
+
+  // The response is addressed to whoever sent the request
+  const uint8_t expected_data[] = {'l', 'a', 'b', 'e', 'l'};
+  auto_ptr<RDMRequest> request(
+      NewGet(m_uid1, ola::rdm::PID_MANUFACTURER_LABEL, NULL, 0,
+             &m_other_controller));
+  request->SetTransactionNumber(42);
+  auto_ptr<RDMResponse> response(cache.Lookup(*request));
+  OLA_ASSERT_NOT_NULL(response.get());
+  OLA_ASSERT_EQ(m_uid1, response->SourceUID());
+  OLA_ASSERT_EQ(m_other_controller, response->DestinationUID());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(42), response->TransactionNumber());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(ola::rdm::RDM_ACK),
+                response->ResponseType());
+  OLA_ASSERT_EQ(ola::rdm::RDMCommand::GET_COMMAND_RESPONSE,
+                response->CommandClass());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_MANUFACTURER_LABEL),
+                response->ParamId());
+  OLA_ASSERT_DATA_EQUALS(expected_data, arraysize(expected_data),
+                         response->ParamData(), response->ParamDataSize());
+
+  // The parameter data is part of the key
+  const uint8_t personality = 1;
+  OLA_ASSERT_FALSE(
+      IsCached(&cache, m_uid1, ola::rdm::PID_DMX_PERSONALITY_DESCRIPTION));
+  request.reset(NewGet(m_uid1, ola::rdm::PID_DMX_PERSONALITY_DESCRIPTION,
+                       &personality, sizeof(personality)));
+  RDMReply reply(ola::rdm::RDM_COMPLETED_OK,
+                 GetResponseFromData(request.get(), &personality,
+                                     sizeof(personality)));
+  cache.ReplyReceived(*request, reply);
+  response.reset(cache.Lookup(*request));
+  OLA_ASSERT_NOT_NULL(response.get());
+  OLA_ASSERT_FALSE(
+      IsCached(&cache, m_uid1, ola::rdm::PID_DMX_PERSONALITY_DESCRIPTION));
+
+  // NACKs and failures aren't stored
+  request.reset(NewGet(m_uid2, ola::rdm::PID_DEVICE_LABEL));
+  RDMReply nack(ola::rdm::RDM_COMPLETED_OK,
+                NackWithReason(request.get(), ola::rdm::NR_UNKNOWN_PID));
+  cache.ReplyReceived(*request, nack);
+  RDMReply timeout(ola::rdm::RDM_TIMEOUT);
+  cache.ReplyReceived(*request, timeout);
+  OLA_ASSERT_FALSE(IsCached(&cache, m_uid2, ola::rdm::PID_DEVICE_LABEL));
+  OLA_ASSERT_EQ(2u, cache.Size());
+}
+
+
+/*
+ * Check entries expire.
+ */
+void RDMResponseCacheTest::testExpiry() {
+  RDMResponseCache cache(&m_clock);
+  StoreResponse(&cache, m_uid1, ola::rdm::PID_MANUFACTURER_LABEL);
+  StoreResponse(&cache, m_uid1, ola::rdm::PID_DMX_START_ADDRESS);
+
+  m_clock.AdvanceTime(29, 0);
+  OLA_ASSERT_TRUE(IsCached(&cache, m_uid1, ola::rdm::PID_DMX_START_ADDRESS));
+
+  m_clock.AdvanceTime(1, 0);
+  OLA_ASSERT_FALSE(IsCached(&cache, m_uid1, ola::rdm::PID_DMX_START_ADDRESS));
+  OLA_ASSERT_TRUE(IsCached(&cache, m_uid1, ola::rdm::PID_MANUFACTURER_LABEL));
+
+  m_clock.AdvanceTime(600, 0);
+  OLA_ASSERT_FALSE(IsCached(&cache, m_uid1, ola::rdm::PID_MANUFACTURER_LABEL));
+  OLA_ASSERT_EQ(0u, cache.Size());
+}
+
+
+/*
+ * Check SETs remove the entries for the responder.
+ */
+void RDMResponseCacheTest::testSetInvalidates() {
+  RDMResponseCache cache(&m_clock);
+  StoreResponse(&cache, m_uid1, ola::rdm::PID_MANUFACTURER_LABEL);
+  StoreResponse(&cache, m_uid1, ola::rdm::PID_DMX_START_ADDRESS);
+  StoreResponse(&cache, m_uid2, ola::rdm::PID_DMX_START_ADDRESS);
+  StoreResponse(&cache, m_uid3, ola::rdm::PID_DMX_START_ADDRESS);
+  OLA_ASSERT_EQ(4u, cache.Size());
+
+  auto_ptr<RDMRequest> request(NewSet(m_uid1, ola::rdm::PID_DEVICE_LABEL));
+  cache.RequestSent(*request);
+  OLA_ASSERT_FALSE(IsCached(&cache, m_uid1, ola::rdm::PID_MANUFACTURER_LABEL));
+  OLA_ASSERT_FALSE(IsCached(&cache, m_uid1, ola::rdm::PID_DMX_START_ADDRESS));
+  OLA_ASSERT_TRUE(IsCached(&cache, m_uid2, ola::rdm::PID_DMX_START_ADDRESS));
+
+  // A GET that was in flight while the SET was sent
+  StoreResponse(&cache, m_uid1, ola::rdm::PID_DMX_START_ADDRESS);
+  RDMReply reply(ola::rdm::RDM_COMPLETED_OK,
+                 GetResponseFromData(request.get()));
+  cache.ReplyReceived(*request, reply);
+  OLA_ASSERT_FALSE(IsCached(&cache, m_uid1, ola::rdm::PID_DMX_START_ADDRESS));
+
+  // Vendorcast
+  request.reset(NewSet(UID::VendorcastAddress(0x7a70),
+                       ola::rdm::PID_DMX_START_ADDRESS));
+  cache.RequestSent(*request);
+  OLA_ASSERT_FALSE(IsCached(&cache, m_uid2, ola::rdm::PID_DMX_START_ADDRESS));
+  OLA_ASSERT_TRUE(IsCached(&cache, m_uid3, ola::rdm::PID_DMX_START_ADDRESS));
+
+  // Broadcast
+  request.reset(NewSet(UID::AllDevices(), ola::rdm::PID_DMX_START_ADDRESS));
+  cache.RequestSent(*request);
+  OLA_ASSERT_EQ(0u, cache.Size());
+}
+
+
+/*
+ * Check queued messages remove the entries for the responder.
+ */
+void RDMResponseCacheTest::testQueuedMessagesInvalidate() {
+  RDMResponseCache cache(&m_clock);
+
+  // Responses with queued messages aren't stored, and remove everything else
+  // for the responder.
+  StoreResponse(&cache, m_uid1, ola::rdm::PID_MANUFACTURER_LABEL);
+  StoreResponse(&cache, m_uid2, ola::rdm::PID_MANUFACTURER_LABEL);
+  StoreResponse(&cache, m_uid1, ola::rdm::PID_DMX_START_ADDRESS, 1);
+  OLA_ASSERT_FALSE(IsCached(&cache, m_uid1, ola::rdm::PID_DMX_START_ADDRESS));
+  OLA_ASSERT_FALSE(IsCached(&cache, m_uid1, ola::rdm::PID_MANUFACTURER_LABEL));
+  OLA_ASSERT_TRUE(IsCached(&cache, m_uid2, ola::rdm::PID_MANUFACTURER_LABEL));
+
+  // As does fetching a queued message
+  const uint8_t status_type = ola::rdm::STATUS_ERROR;
+  auto_ptr<RDMRequest> request(
+      NewGet(m_uid2, ola::rdm::PID_QUEUED_MESSAGE, &status_type,
+             sizeof(status_type)));
+  RDMReply reply(ola::rdm::RDM_COMPLETED_OK,
+                 GetResponseWithPid(request.get(),
+                                    ola::rdm::PID_DMX_START_ADDRESS,
+                                    NULL, 0));
+  cache.ReplyReceived(*request, reply);
+  OLA_ASSERT_EQ(0u, cache.Size());
+}
+
+
+/*
+ * Check entries are removed when responders go away.
+ */
+void RDMResponseCacheTest::testRetainUIDs() {
+  RDMResponseCache cache(&m_clock);
+  StoreResponse(&cache, m_uid1, ola::rdm::PID_MANUFACTURER_LABEL);
+  StoreResponse(&cache, m_uid2, ola::rdm::PID_MANUFACTURER_LABEL);
+  StoreResponse(&cache, m_uid3, ola::rdm::PID_MANUFACTURER_LABEL);
+
+  UIDSet uids;
+  uids.AddUID(m_uid1);
+  uids.AddUID(m_uid3);
+  cache.RetainUIDs(uids);
+  OLA_ASSERT_EQ(2u, cache.Size());
+  OLA_ASSERT_TRUE(IsCached(&cache, m_uid1, ola::rdm::PID_MANUFACTURER_LABEL));
+  OLA_ASSERT_FALSE(IsCached(&cache, m_uid2, ola::rdm::PID_MANUFACTURER_LABEL));
+  OLA_ASSERT_TRUE(IsCached(&cache, m_uid3, ola::rdm::PID_MANUFACTURER_LABEL));
+
+  cache.RemoveUID(m_uid3);
+  OLA_ASSERT_EQ(1u, cache.Size());
+  cache.Clear();
+  OLA_ASSERT_EQ(0u, cache.Size());
+}
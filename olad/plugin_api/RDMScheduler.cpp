@@ -0,0 +1,347 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMScheduler.cpp
+ * Schedules the RDM requests a universe sends to its output ports.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <stdint.h>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/base/Array.h"
+#include "olad/Port.h"
+#include "olad/plugin_api/RDMScheduler.h"
+
+namespace ola {
+
+using ola::rdm::RDMCallback;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::RunRDMCallback;
+using ola::thread::INVALID_TIMEOUT;
+
+const char RDMScheduler::K_RDM_LATENCY_VAR[] = "rdm-scheduler-latency-ms";
+const char RDMScheduler::K_RDM_QUEUE_DEPTH_VAR[] = "rdm-scheduler-queue-depth";
+
+const unsigned int RDMScheduler::K_LATENCY_BOUNDS_MS[] = {
+  1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000
+};
+const unsigned int RDMScheduler::K_QUEUE_DEPTH_BOUNDS[] = {
+  0, 1, 2, 4, 8, 16, 32, 64, 128, 256
+};
+const unsigned int RDMScheduler::K_DMX_ACTIVE_MS = 1000;
+
+namespace {
+const int64_t ONE_SECOND_IN_US = 1000000;
+}  // namespace
+
+RDMScheduler::PortState::PortState(OutputPort *_port)
+    : port(_port),
+      id(_port->UniqueId()),
+      dispatching(false),
+      timeout(INVALID_TIMEOUT) {
+}
+
+RDMScheduler::RDMScheduler(Clock *clock, ExportMap *export_map)
+    : m_clock(clock),
+      m_export_map(export_map),
+      m_scheduler(NULL) {
+  if (m_export_map) {
+    m_export_map->GetUIntMapVar(K_RDM_LATENCY_VAR, "port:ms");
+    m_export_map->GetUIntMapVar(K_RDM_QUEUE_DEPTH_VAR, "port:depth");
+  }
+}
+
+RDMScheduler::~RDMScheduler() {
+  // Failing the requests runs callbacks, so empty m_ports first.
+  PortMap ports;
+  ports.swap(m_ports);
+  PortMap::iterator iter = ports.begin();
+  for (; iter != ports.end(); ++iter) {
+    DeletePortState(iter->second);
+  }
+}
+
+void RDMScheduler::SetOptions(ola::thread::SchedulerInterface *scheduler,
+                              const RDMSchedulerOptions &options) {
+  PortMap::iterator iter = m_ports.begin();
+  for (; iter != m_ports.end(); ++iter) {
+    CancelTimeout(iter->second);
+  }
+
+  m_scheduler = scheduler;
+  m_options = options;
+  if (m_options.max_in_flight == 0) {
+    m_options.max_in_flight = 1;
+  }
+  m_dmx_interval = m_options.min_dmx_fps ?
+      TimeInterval(ONE_SECOND_IN_US / m_options.min_dmx_fps) :
+      TimeInterval();
+
+  // The callbacks run by Dispatch() may remove ports, so take a copy first.
+  std::vector<const OutputPort*> ports;
+  for (iter = m_ports.begin(); iter != m_ports.end(); ++iter) {
+    ports.push_back(iter->first);
+  }
+  std::vector<const OutputPort*>::const_iterator port_iter = ports.begin();
+  for (; port_iter != ports.end(); ++port_iter) {
+    iter = m_ports.find(*port_iter);
+    if (iter != m_ports.end()) {
+      Dispatch(iter->second);
+    }
+  }
+}
+
+void RDMScheduler::SendRDMRequest(OutputPort *port,
+                                  RDMRequest *request,
+                                  RDMCallback *callback) {
+  PortMap::iterator iter = m_ports.find(port);
+  PortState *state;
+  if (iter == m_ports.end()) {
+    state = new PortState(port);
+    if (m_export_map) {
+      state->latency = m_export_map->GetHistogram(
+          K_RDM_LATENCY_VAR, state->id, K_LATENCY_BOUNDS_MS,
+          arraysize(K_LATENCY_BOUNDS_MS));
+      state->queue_depth = m_export_map->GetHistogram(
+          K_RDM_QUEUE_DEPTH_VAR, state->id, K_QUEUE_DEPTH_BOUNDS,
+          arraysize(K_QUEUE_DEPTH_BOUNDS));
+    }
+    m_ports[port] = state;
+  } else {
+    state = iter->second;
+  }
+
+  unsigned int queue_size = state->interactive.size() +
+                            state->background.size();
+  state->queue_depth.Observe(queue_size);
+
+  if (queue_size >= m_options.max_queue_size) {
+    OLA_WARN << "RDM queue for port " << state->id
+             << " is full, dropping request";
+    delete request;
+    RunRDMCallback(callback, ola::rdm::RDM_FAILED_TO_SEND);
+    return;
+  }
+
+  PendingRequest pending;
+  pending.request = request;
+  pending.callback = callback;
+  m_clock->CurrentTime(&pending.queued);
+
+  if (request->IsBackground()) {
+    state->background.push_back(pending);
+  } else {
+    state->interactive.push_back(pending);
+  }
+  Dispatch(state);
+}
+
+void RDMScheduler::DMXSent(const OutputPort *port) {
+  if (!m_options.min_dmx_fps || m_ports.empty()) {
+    return;
+  }
+
+  PortMap::iterator iter = m_ports.find(port);
+  if (iter != m_ports.end()) {
+    m_clock->CurrentTime(&iter->second->last_dmx);
+  }
+}
+
+void RDMScheduler::RemovePort(const OutputPort *port) {
+  PortMap::iterator iter = m_ports.find(port);
+  if (iter == m_ports.end()) {
+    return;
+  }
+
+  PortState *state = iter->second;
+  m_ports.erase(iter);
+  if (m_export_map) {
+    m_export_map->RemoveHistogram(K_RDM_LATENCY_VAR, state->id,
+                                  K_LATENCY_BOUNDS_MS,
+                                  arraysize(K_LATENCY_BOUNDS_MS));
+    m_export_map->RemoveHistogram(K_RDM_QUEUE_DEPTH_VAR, state->id,
+                                  K_QUEUE_DEPTH_BOUNDS,
+                                  arraysize(K_QUEUE_DEPTH_BOUNDS));
+  }
+  DeletePortState(state);
+}
+
+unsigned int RDMScheduler::QueueSize(const OutputPort *port) const {
+  PortMap::const_iterator iter = m_ports.find(port);
+  if (iter == m_ports.end()) {
+    return 0;
+  }
+  return iter->second->interactive.size() + iter->second->background.size();
+}
+
+unsigned int RDMScheduler::InFlight(const OutputPort *port) const {
+  PortMap::const_iterator iter = m_ports.find(port);
+  return iter == m_ports.end() ? 0 : iter->second->in_flight.size();
+}
+
+/*
+ * Pass as many requests to the port as the options allow.
+ */
+void RDMScheduler::Dispatch(PortState *state) {
+  // Ports may run the callback before SendRDMRequest returns, in which case
+  // RequestComplete() calls us again. The outer call will send the next
+  // request so we don't recurse once per queued request.
+  if (state->dispatching) {
+    return;
+  }
+
+  const OutputPort *port = state->port;
+  state->dispatching = true;
+  while (state->in_flight.size() < m_options.max_in_flight &&
+         (!state->interactive.empty() || !state->background.empty())) {
+    TimeStamp now;
+    m_clock->CurrentTime(&now);
+
+    if (m_scheduler && m_options.min_dmx_fps && state->last_dmx.IsSet() &&
+        now - state->last_dmx <
+            TimeInterval(static_cast<int64_t>(K_DMX_ACTIVE_MS) * 1000) &&
+        state->last_dispatch.IsSet()) {
+      // DMX is being sent to this port, leave the device time to send frames
+      // between the RDM requests.
+      TimeInterval elapsed = now - state->last_dispatch;
+      if (elapsed < m_dmx_interval) {
+        if (state->timeout == INVALID_TIMEOUT) {
+          state->timeout = m_scheduler->RegisterSingleTimeout(
+              TimeInterval(m_dmx_interval.AsInt() - elapsed.AsInt()),
+              NewSingleCallback(this, &RDMScheduler::DelayExpired, port));
+        }
+        break;
+      }
+    }
+
+    RequestQueue *queue = state->interactive.empty() ?
+        &state->background : &state->interactive;
+    PendingRequest pending = queue->front();
+    queue->pop_front();
+
+    state->latency.Observe(static_cast<unsigned int>(
+        (now - pending.queued).InMilliSeconds()));
+
+    InFlightRequest *in_flight = new InFlightRequest;
+    in_flight->scheduler = this;
+    in_flight->port = port;
+    in_flight->callback = pending.callback;
+    state->in_flight.insert(in_flight);
+    state->last_dispatch = now;
+    state->port->SendRDMRequest(
+        pending.request,
+        NewSingleCallback(&RDMScheduler::InFlightComplete, in_flight));
+
+    // The callback may have removed the port.
+    PortMap::iterator iter = m_ports.find(port);
+    if (iter == m_ports.end() || iter->second != state) {
+      return;
+    }
+  }
+  state->dispatching = false;
+}
+
+void RDMScheduler::RequestComplete(InFlightRequest *request,
+                                   RDMReply *reply) {
+  const OutputPort *port = request->port;
+  RDMCallback *callback = request->callback;
+  PortMap::iterator iter = m_ports.find(port);
+  if (iter != m_ports.end()) {
+    iter->second->in_flight.erase(request);
+  }
+  delete request;
+
+  callback->Run(reply);
+
+  // The callback may have removed the port, so look it up again.
+  iter = m_ports.find(port);
+  if (iter != m_ports.end()) {
+    Dispatch(iter->second);
+  }
+}
+
+/*
+ * Called by the port when a request completes. This is static since the
+ * scheduler may have been deleted by the time the port replies.
+ */
+void RDMScheduler::InFlightComplete(InFlightRequest *request,
+                                    RDMReply *reply) {
+  if (request->scheduler) {
+    request->scheduler->RequestComplete(request, reply);
+  } else {
+    // The request has already been failed.
+    delete request;
+  }
+}
+
+void RDMScheduler::DelayExpired(const OutputPort *port) {
+  PortMap::iterator iter = m_ports.find(port);
+  if (iter != m_ports.end()) {
+    iter->second->timeout = INVALID_TIMEOUT;
+    Dispatch(iter->second);
+  }
+}
+
+void RDMScheduler::CancelTimeout(PortState *state) {
+  if (state->timeout != INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(state->timeout);
+    state->timeout = INVALID_TIMEOUT;
+  }
+}
+
+void RDMScheduler::FailQueuedRequests(RequestQueue *queue) {
+  while (!queue->empty()) {
+    PendingRequest pending = queue->front();
+    queue->pop_front();
+    delete pending.request;
+    RunRDMCallback(pending.callback, ola::rdm::RDM_FAILED_TO_SEND);
+  }
+}
+
+/*
+ * Detach the requests from the scheduler, so the port's callback only frees
+ * the InFlightRequest, and fail them.
+ */
+void RDMScheduler::FailInFlightRequests(InFlightSet *requests) {
+  std::vector<RDMCallback*> callbacks;
+  InFlightSet::iterator iter = requests->begin();
+  for (; iter != requests->end(); ++iter) {
+    (*iter)->scheduler = NULL;
+    callbacks.push_back((*iter)->callback);
+    (*iter)->callback = NULL;
+  }
+  requests->clear();
+
+  std::vector<RDMCallback*>::iterator callback_iter = callbacks.begin();
+  for (; callback_iter != callbacks.end(); ++callback_iter) {
+    RunRDMCallback(*callback_iter, ola::rdm::RDM_FAILED_TO_SEND);
+  }
+}
+
+/*
+ * Delete a PortState, which must have already been removed from m_ports.
+ */
+void RDMScheduler::DeletePortState(PortState *state) {
+  CancelTimeout(state);
+  FailInFlightRequests(&state->in_flight);
+  FailQueuedRequests(&state->interactive);
+  FailQueuedRequests(&state->background);
+  delete state;
+}
+}  // namespace ola
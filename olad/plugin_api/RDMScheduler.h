@@ -0,0 +1,210 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMScheduler.h
+ * Schedules the RDM requests a universe sends to its output ports.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#ifndef OLAD_PLUGIN_API_RDMSCHEDULER_H_
+#define OLAD_PLUGIN_API_RDMSCHEDULER_H_
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/base/Macro.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMControllerInterface.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/thread/SchedulerInterface.h"
+
+namespace ola {
+
+class OutputPort;
+
+/**
+ * @brief Options for the RDMScheduler.
+ */
+struct RDMSchedulerOptions {
+  RDMSchedulerOptions()
+      : max_in_flight(1),
+        max_queue_size(1000),
+        min_dmx_fps(0) {
+  }
+
+  /**
+   * @brief The maximum number of requests sent to a port that haven't
+   * completed yet.
+   */
+  unsigned int max_in_flight;
+
+  /**
+   * @brief The maximum number of requests waiting to be sent to a port.
+   */
+  unsigned int max_queue_size;
+
+  /**
+   * @brief The DMX frame rate to maintain on ports that are outputting DMX.
+   *
+   * While DMX is being sent to a port, only one RDM request is dispatched per
+   * 1 / min_dmx_fps seconds, so the device has time to send DMX frames
+   * between the RDM transactions. 0 disables this.
+   */
+  unsigned int min_dmx_fps;
+};
+
+
+/**
+ * @brief Schedules the RDM requests a universe sends to its output ports.
+ *
+ * Each port has its own queues, so a slow responder on one port doesn't hold
+ * up requests to the other ports, and up to max_in_flight requests are
+ * passed to each port at once. Requests marked as background (see
+ * RDMRequest::IsBackground()) are only sent when there are no interactive
+ * requests waiting for the port.
+ *
+ * For each port, the time requests spend queued and the queue depth when a
+ * request arrives are exported as histograms. The keys are
+ * "<port-id>:<bucket upper bound>", with the last bucket being "inf".
+ */
+class RDMScheduler {
+ public:
+  /**
+   * @brief Create a new RDMScheduler.
+   * @param clock the Clock to use for timing requests.
+   * @param export_map the ExportMap to use for stats, may be NULL.
+   */
+  RDMScheduler(Clock *clock, ExportMap *export_map);
+
+  /**
+   * @brief Destructor.
+   *
+   * Any queued or in flight requests are failed with RDM_FAILED_TO_SEND. If a
+   * port completes an in flight request after this, the reply is dropped.
+   */
+  ~RDMScheduler();
+
+  /**
+   * @brief Change the options.
+   * @param scheduler the scheduler used to delay requests while DMX is being
+   *   sent. If this is NULL, min_dmx_fps is ignored.
+   * @param options the new options.
+   */
+  void SetOptions(ola::thread::SchedulerInterface *scheduler,
+                  const RDMSchedulerOptions &options);
+
+  /**
+   * @brief Queue a request for a port.
+   * @param port the port to send the request on.
+   * @param request the request, ownership is transferred.
+   * @param callback the callback to run when the request completes.
+   */
+  void SendRDMRequest(OutputPort *port,
+                      ola::rdm::RDMRequest *request,
+                      ola::rdm::RDMCallback *callback);
+
+  /**
+   * @brief Called when a DMX frame has been written to a port.
+   */
+  void DMXSent(const OutputPort *port);
+
+  /**
+   * @brief Called when a port is removed from the universe.
+   *
+   * Requests queued for, or in flight on, the port are failed with
+   * RDM_FAILED_TO_SEND.
+   */
+  void RemovePort(const OutputPort *port);
+
+  /**
+   * @brief The number of requests waiting to be sent to a port.
+   */
+  unsigned int QueueSize(const OutputPort *port) const;
+
+  /**
+   * @brief The number of requests sent to a port that haven't completed.
+   */
+  unsigned int InFlight(const OutputPort *port) const;
+
+  static const char K_RDM_LATENCY_VAR[];
+  static const char K_RDM_QUEUE_DEPTH_VAR[];
+
+ private:
+  struct PendingRequest {
+    ola::rdm::RDMRequest *request;
+    ola::rdm::RDMCallback *callback;
+    TimeStamp queued;
+  };
+
+  typedef std::deque<PendingRequest> RequestQueue;
+
+  // A request that has been passed to a port. The port's callback owns
+  // this, and scheduler is set to NULL if the request is failed early.
+  struct InFlightRequest {
+    RDMScheduler *scheduler;
+    const OutputPort *port;
+    ola::rdm::RDMCallback *callback;
+  };
+
+  typedef std::set<InFlightRequest*> InFlightSet;
+
+  struct PortState {
+    explicit PortState(OutputPort *_port);
+
+    OutputPort *port;
+    std::string id;
+    RequestQueue interactive;
+    RequestQueue background;
+    InFlightSet in_flight;
+    bool dispatching;
+    TimeStamp last_dmx;
+    TimeStamp last_dispatch;
+    ola::thread::timeout_id timeout;
+    Histogram latency;
+    Histogram queue_depth;
+  };
+
+  typedef std::map<const OutputPort*, PortState*> PortMap;
+
+  Clock *m_clock;
+  ExportMap *m_export_map;
+  ola::thread::SchedulerInterface *m_scheduler;
+  RDMSchedulerOptions m_options;
+  TimeInterval m_dmx_interval;
+  PortMap m_ports;
+
+  void Dispatch(PortState *state);
+  void RequestComplete(InFlightRequest *request, ola::rdm::RDMReply *reply);
+  void DelayExpired(const OutputPort *port);
+  void CancelTimeout(PortState *state);
+  void FailQueuedRequests(RequestQueue *queue);
+  void FailInFlightRequests(InFlightSet *requests);
+  void DeletePortState(PortState *state);
+
+  static void InFlightComplete(InFlightRequest *request,
+                               ola::rdm::RDMReply *reply);
+
+  static const unsigned int K_LATENCY_BOUNDS_MS[];
+  static const unsigned int K_QUEUE_DEPTH_BOUNDS[];
+  // DMX is considered to be flowing if a frame was sent within this time.
+  static const unsigned int K_DMX_ACTIVE_MS;
+
+  DISALLOW_COPY_AND_ASSIGN(RDMScheduler);
+};
+}  // namespace ola
+#endif  // OLAD_PLUGIN_API_RDMSCHEDULER_H_
@@ -0,0 +1,463 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * RDMSchedulerTest.cpp
+ * Test fixture for the RDMScheduler class.
+ * Copyright (C) 2026 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/ExportMap.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMReply.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/thread/SchedulerInterface.h"
+#include "olad/plugin_api/RDMScheduler.h"
+#include "olad/plugin_api/TestCommon.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::ExportMap;
+using ola::NewCallback;
+using ola::NewSingleCallback;
+using ola::RDMScheduler;
+using ola::RDMSchedulerOptions;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::rdm::RDMCallback;
+using ola::rdm::RDMGetRequest;
+using ola::rdm::RDMReply;
+using ola::rdm::RDMRequest;
+using ola::rdm::RDMStatusCode;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using std::auto_ptr;
+using std::string;
+using std::vector;
+
+namespace {
+
+/*
+ * A Clock that only moves when the test advances it. MockClock follows the
+ * real clock, which would make the delays depend on how fast the test runs.
+ */
+class FakeClock: public ola::Clock {
+ public:
+  FakeClock() {
+    struct timeval tv = {1000, 0};
+    m_now = tv;
+  }
+
+  void AdvanceTime(int32_t sec, int32_t usec) {
+    m_now += TimeInterval(sec, usec);
+  }
+
+  void CurrentTime(TimeStamp *timestamp) const {
+    *timestamp = m_now;
+  }
+
+ private:
+  TimeStamp m_now;
+};
+
+
+/*
+ * A SchedulerInterface that holds a single timeout until it's run by the
+ * test.
+ */
+class FakeScheduler: public ola::thread::SchedulerInterface {
+ public:
+  FakeScheduler() : m_callback(NULL) {}
+  ~FakeScheduler() { delete m_callback; }
+
+  ola::thread::timeout_id RegisterRepeatingTimeout(
+      unsigned int, ola::Callback0<bool> *callback) {
+    delete callback;
+    return ola::thread::INVALID_TIMEOUT;
+  }
+
+  ola::thread::timeout_id RegisterRepeatingTimeout(
+      const TimeInterval&, ola::Callback0<bool> *callback) {
+    delete callback;
+    return ola::thread::INVALID_TIMEOUT;
+  }
+
+  ola::thread::timeout_id RegisterSingleTimeout(
+      unsigned int delay, ola::SingleUseCallback0<void> *callback) {
+    return RegisterSingleTimeout(TimeInterval(delay * 1000), callback);
+  }
+
+  ola::thread::timeout_id RegisterSingleTimeout(
+      const TimeInterval &delay, ola::SingleUseCallback0<void> *callback) {
+    delete m_callback;
+    m_callback = callback;
+    m_delay = delay;
+    return this;
+  }
+
+  void RemoveTimeout(ola::thread::timeout_id id) {
+    if (id == this) {
+      delete m_callback;
+      m_callback = NULL;
+    }
+  }
+
+  bool Pending() const { return m_callback != NULL; }
+  const TimeInterval &Delay() const { return m_delay; }
+
+  void Run() {
+    ola::SingleUseCallback0<void> *callback = m_callback;
+    m_callback = NULL;
+    callback->Run();
+  }
+
+ private:
+  ola::SingleUseCallback0<void> *m_callback;
+  TimeInterval m_delay;
+};
+}  // namespace
+
+
+class RDMSchedulerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RDMSchedulerTest);
+  CPPUNIT_TEST(testPortsAreIndependent);
+  CPPUNIT_TEST(testMaxInFlight);
+  CPPUNIT_TEST(testPriority);
+  CPPUNIT_TEST(testQueueLimit);
+  CPPUNIT_TEST(testRemovePort);
+  CPPUNIT_TEST(testDeleteWithRequestsInFlight);
+  CPPUNIT_TEST(testDMXInterleaving);
+  CPPUNIT_TEST(testHistograms);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  RDMSchedulerTest()
+      : m_plugin(NULL, ola::OLA_PLUGIN_ARTNET),
+        m_device(&m_plugin, "test device"),
+        m_port1(&m_device, 1, &m_uids),
+        m_port2(&m_device, 2, &m_uids),
+        m_controller(0x7a70, 100),
+        m_responder(0x7a70, 1) {
+  }
+
+  void setUp();
+  void tearDown();
+
+  void testPortsAreIndependent();
+  void testMaxInFlight();
+  void testPriority();
+  void testQueueLimit();
+  void testRemovePort();
+  void testDeleteWithRequestsInFlight();
+  void testDMXInterleaving();
+  void testHistograms();
+
+ private:
+  struct SentRequest {
+    const RDMRequest *request;
+    RDMCallback *callback;
+  };
+
+  FakeClock m_clock;
+  ExportMap m_export_map;
+  auto_ptr<RDMScheduler> m_scheduler;
+  UIDSet m_uids;
+  TestMockPlugin m_plugin;
+  MockDevice m_device;
+  TestMockRDMOutputPort m_port1;
+  TestMockRDMOutputPort m_port2;
+  UID m_controller;
+  UID m_responder;
+  vector<SentRequest> m_port1_requests;
+  vector<SentRequest> m_port2_requests;
+  vector<uint16_t> m_completed;
+  vector<RDMStatusCode> m_status_codes;
+
+  void HoldRequest(vector<SentRequest> *requests,
+                   const RDMRequest *request,
+                   RDMCallback *callback) {
+    SentRequest sent = {request, callback};
+    requests->push_back(sent);
+  }
+
+  // Complete the oldest request sent to a port.
+  void CompleteRequest(vector<SentRequest> *requests) {
+    OLA_ASSERT_FALSE(requests->empty());
+    SentRequest sent = requests->front();
+    requests->erase(requests->begin());
+    delete sent.request;
+    ola::rdm::RunRDMCallback(sent.callback, ola::rdm::RDM_TIMEOUT);
+  }
+
+  void RequestComplete(uint16_t pid, RDMReply *reply) {
+    m_completed.push_back(pid);
+    m_status_codes.push_back(reply->StatusCode());
+  }
+
+  void SendRequest(ola::OutputPort *port, uint16_t pid,
+                   bool background = false) {
+    RDMRequest::OverrideOptions options;
+    options.background = background;
+    m_scheduler->SendRDMRequest(
+        port,
+        new RDMGetRequest(m_controller, m_responder, 0, 1, 0, pid, NULL, 0,
+                          options),
+        NewSingleCallback(this, &RDMSchedulerTest::RequestComplete, pid));
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RDMSchedulerTest);
+
+
+void RDMSchedulerTest::setUp() {
+  m_scheduler.reset(new RDMScheduler(&m_clock, &m_export_map));
+  m_port1.SetRDMHandler(
+      NewCallback(this, &RDMSchedulerTest::HoldRequest, &m_port1_requests));
+  m_port2.SetRDMHandler(
+      NewCallback(this, &RDMSchedulerTest::HoldRequest, &m_port2_requests));
+}
+
+
+void RDMSchedulerTest::tearDown() {
+  while (!m_port1_requests.empty()) {
+    CompleteRequest(&m_port1_requests);
+  }
+  while (!m_port2_requests.empty()) {
+    CompleteRequest(&m_port2_requests);
+  }
+  m_scheduler.reset();
+}
+
+
+/*
+ * Check a port that's busy doesn't hold up the other ports.
+ */
+void RDMSchedulerTest::testPortsAreIndependent() {
+  SendRequest(&m_port1, ola::rdm::PID_DEVICE_INFO);
+  SendRequest(&m_port1, ola::rdm::PID_DEVICE_LABEL);
+  SendRequest(&m_port2, ola::rdm::PID_DMX_START_ADDRESS);
+
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_port1_requests.size());
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_port2_requests.size());
+  OLA_ASSERT_EQ(1u, m_scheduler->QueueSize(&m_port1));
+  OLA_ASSERT_EQ(1u, m_scheduler->InFlight(&m_port1));
+  OLA_ASSERT_EQ(0u, m_scheduler->QueueSize(&m_port2));
+
+  CompleteRequest(&m_port2_requests);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_completed.size());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_DMX_START_ADDRESS),
+                m_completed[0]);
+  OLA_ASSERT_EQ(0u, m_scheduler->InFlight(&m_port2));
+
+  CompleteRequest(&m_port1_requests);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_port1_requests.size());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_DEVICE_LABEL),
+                m_port1_requests[0].request->ParamId());
+  OLA_ASSERT_EQ(0u, m_scheduler->QueueSize(&m_port1));
+}
+
+
+/*
+ * Check max_in_flight is honored.
+ */
+void RDMSchedulerTest::testMaxInFlight() {
+  RDMSchedulerOptions options;
+  options.max_in_flight = 2;
+  m_scheduler->SetOptions(NULL, options);
+
+  SendRequest(&m_port1, ola::rdm::PID_DEVICE_INFO);
+  SendRequest(&m_port1, ola::rdm::PID_DEVICE_LABEL);
+  SendRequest(&m_port1, ola::rdm::PID_DMX_START_ADDRESS);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), m_port1_requests.size());
+  OLA_ASSERT_EQ(2u, m_scheduler->InFlight(&m_port1));
+  OLA_ASSERT_EQ(1u, m_scheduler->QueueSize(&m_port1));
+
+  CompleteRequest(&m_port1_requests);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), m_port1_requests.size());
+  OLA_ASSERT_EQ(0u, m_scheduler->QueueSize(&m_port1));
+}
+
+
+/*
+ * Check interactive requests are sent before background ones.
+ */
+void RDMSchedulerTest::testPriority() {
+  SendRequest(&m_port1, ola::rdm::PID_DEVICE_INFO, true);
+  SendRequest(&m_port1, ola::rdm::PID_MANUFACTURER_LABEL, true);
+  SendRequest(&m_port1, ola::rdm::PID_DEVICE_LABEL, true);
+  SendRequest(&m_port1, ola::rdm::PID_DMX_START_ADDRESS);
+
+  // The first background request was sent before the interactive one arrived.
+  CompleteRequest(&m_port1_requests);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_DMX_START_ADDRESS),
+                m_port1_requests[0].request->ParamId());
+  CompleteRequest(&m_port1_requests);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_MANUFACTURER_LABEL),
+                m_port1_requests[0].request->ParamId());
+  CompleteRequest(&m_port1_requests);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_DEVICE_LABEL),
+                m_port1_requests[0].request->ParamId());
+}
+
+
+/*
+ * Check requests are rejected once the queue is full.
+ */
+void RDMSchedulerTest::testQueueLimit() {
+  RDMSchedulerOptions options;
+  options.max_queue_size = 1;
+  m_scheduler->SetOptions(NULL, options);
+
+  SendRequest(&m_port1, ola::rdm::PID_DEVICE_INFO);
+  SendRequest(&m_port1, ola::rdm::PID_DEVICE_LABEL);
+  OLA_ASSERT_TRUE(m_completed.empty());
+
+  SendRequest(&m_port1, ola::rdm::PID_DMX_START_ADDRESS);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_completed.size());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_DMX_START_ADDRESS),
+                m_completed[0]);
+  OLA_ASSERT_EQ(ola::rdm::RDM_FAILED_TO_SEND, m_status_codes[0]);
+}
+
+
+/*
+ * Check queued and in flight requests fail when the port is removed.
+ */
+void RDMSchedulerTest::testRemovePort() {
+  SendRequest(&m_port1, ola::rdm::PID_DEVICE_INFO);
+  SendRequest(&m_port1, ola::rdm::PID_DEVICE_LABEL);
+
+  m_scheduler->RemovePort(&m_port1);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), m_completed.size());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_DEVICE_INFO),
+                m_completed[0]);
+  OLA_ASSERT_EQ(ola::rdm::RDM_FAILED_TO_SEND, m_status_codes[0]);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_DEVICE_LABEL),
+                m_completed[1]);
+  OLA_ASSERT_EQ(ola::rdm::RDM_FAILED_TO_SEND, m_status_codes[1]);
+  OLA_ASSERT_EQ(0u, m_scheduler->QueueSize(&m_port1));
+  OLA_ASSERT_EQ(0u, m_scheduler->InFlight(&m_port1));
+
+  // The reply to the request that was in flight is dropped.
+  CompleteRequest(&m_port1_requests);
+  OLA_ASSERT_EQ(static_cast<size_t>(2), m_completed.size());
+
+  // The port can be used again.
+  SendRequest(&m_port1, ola::rdm::PID_DMX_START_ADDRESS);
+  OLA_ASSERT_EQ(1u, m_scheduler->InFlight(&m_port1));
+  CompleteRequest(&m_port1_requests);
+  OLA_ASSERT_EQ(static_cast<size_t>(3), m_completed.size());
+  OLA_ASSERT_EQ(ola::rdm::RDM_TIMEOUT, m_status_codes[2]);
+}
+
+
+/*
+ * Check the port can complete a request after the scheduler is deleted.
+ */
+void RDMSchedulerTest::testDeleteWithRequestsInFlight() {
+  SendRequest(&m_port1, ola::rdm::PID_DEVICE_INFO);
+  SendRequest(&m_port1, ola::rdm::PID_DEVICE_LABEL);
+  SendRequest(&m_port2, ola::rdm::PID_DMX_START_ADDRESS);
+
+  m_scheduler.reset();
+  OLA_ASSERT_EQ(static_cast<size_t>(3), m_completed.size());
+  for (unsigned int i = 0; i < m_status_codes.size(); i++) {
+    OLA_ASSERT_EQ(ola::rdm::RDM_FAILED_TO_SEND, m_status_codes[i]);
+  }
+
+  CompleteRequest(&m_port1_requests);
+  CompleteRequest(&m_port2_requests);
+  OLA_ASSERT_EQ(static_cast<size_t>(3), m_completed.size());
+}
+
+
+/*
+ * Check RDM requests are spaced out while DMX is being sent.
+ */
+void RDMSchedulerTest::testDMXInterleaving() {
+  FakeScheduler fake_scheduler;
+  RDMSchedulerOptions options;
+  options.min_dmx_fps = 20;
+  m_scheduler->SetOptions(&fake_scheduler, options);
+
+  // Without DMX, the requests are sent back to back.
+  SendRequest(&m_port1, ola::rdm::PID_DEVICE_INFO);
+  SendRequest(&m_port1, ola::rdm::PID_DEVICE_LABEL);
+  CompleteRequest(&m_port1_requests);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_port1_requests.size());
+  OLA_ASSERT_FALSE(fake_scheduler.Pending());
+
+  // Now send DMX, the next request has to wait until 50ms after the last one.
+  m_scheduler->DMXSent(&m_port1);
+  SendRequest(&m_port1, ola::rdm::PID_DMX_START_ADDRESS);
+  m_clock.AdvanceTime(0, 10000);
+  CompleteRequest(&m_port1_requests);
+  OLA_ASSERT_TRUE(m_port1_requests.empty());
+  OLA_ASSERT_TRUE(fake_scheduler.Pending());
+  OLA_ASSERT_EQ(TimeInterval(0, 40000), fake_scheduler.Delay());
+
+  m_clock.AdvanceTime(0, 40000);
+  fake_scheduler.Run();
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_port1_requests.size());
+
+  // Once DMX stops the requests are sent immediately.
+  SendRequest(&m_port1, ola::rdm::PID_DEVICE_INFO);
+  m_clock.AdvanceTime(2, 0);
+  CompleteRequest(&m_port1_requests);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), m_port1_requests.size());
+  OLA_ASSERT_FALSE(fake_scheduler.Pending());
+
+  m_scheduler->SetOptions(NULL, RDMSchedulerOptions());
+}
+
+
+/*
+ * Check the latency and queue depth histograms.
+ */
+void RDMSchedulerTest::testHistograms() {
+  const string port_id = m_port1.UniqueId();
+
+  // The depth doesn't include the request that is in flight.
+  SendRequest(&m_port1, ola::rdm::PID_DEVICE_INFO);
+  SendRequest(&m_port1, ola::rdm::PID_DEVICE_LABEL);
+  SendRequest(&m_port1, ola::rdm::PID_DMX_START_ADDRESS);
+
+  ola::UIntMap *depth = m_export_map.GetUIntMapVar(
+      RDMScheduler::K_RDM_QUEUE_DEPTH_VAR);
+  OLA_ASSERT_EQ(2u, (*depth)[port_id + ":0"]);
+  OLA_ASSERT_EQ(1u, (*depth)[port_id + ":1"]);
+
+  m_clock.AdvanceTime(0, 30000);
+  CompleteRequest(&m_port1_requests);
+
+  ola::UIntMap *latency = m_export_map.GetUIntMapVar(
+      RDMScheduler::K_RDM_LATENCY_VAR);
+  OLA_ASSERT_EQ(1u, (*latency)[port_id + ":1"]);
+  OLA_ASSERT_EQ(1u, (*latency)[port_id + ":50"]);
+
+  m_clock.AdvanceTime(11, 0);
+  CompleteRequest(&m_port1_requests);
+  OLA_ASSERT_EQ(1u, (*latency)[port_id + ":inf"]);
+
+  m_scheduler->RemovePort(&m_port1);
+  OLA_ASSERT_EQ(string("map:port:ms"), latency->Value());
+}
@@ -78,11 +78,20 @@ class TestMockPriorityInputPort: public TestMockInputPort {
     m_inherited_priority = priority;
   }
 
+  const ola::DmxBuffer *InheritedSlotPriorities() const {
+    return &m_slot_priorities;
+  }
+
+  void SetInheritedSlotPriorities(const ola::DmxBuffer &slot_priorities) {
+    m_slot_priorities = slot_priorities;
+  }
+
  protected:
   bool SupportsPriorities() const { return true; }
 
  private:
   uint8_t m_inherited_priority;
+  ola::DmxBuffer m_slot_priorities;
 };
 
 
@@ -96,20 +105,24 @@ class TestMockOutputPort: public ola::BasicOutputPort {
                      bool start_rdm_discovery_on_patch = false,
                      bool supports_rdm = false)
       : ola::BasicOutputPort(parent, port_id, start_rdm_discovery_on_patch,
-                             supports_rdm) {
+                             supports_rdm),
+        m_write_count(0) {
   }
   ~TestMockOutputPort() {}
 
   std::string Description() const { return ""; }
   bool WriteDMX(const ola::DmxBuffer &buffer, uint8_t priority) {
     m_buffer = buffer;
+    m_write_count++;
     (void) priority;
     return true;
   }
   const ola::DmxBuffer &ReadDMX() const { return m_buffer; }
+  unsigned int WriteCount() const { return m_write_count; }
 
  private:
   ola::DmxBuffer m_buffer;
+  unsigned int m_write_count;
 };
 
 
@@ -161,8 +174,12 @@ class TestMockRDMOutputPort: public TestMockOutputPort {
     on_complete->Run(*m_uids);
   }
 
+  void SetKnownUIDs(const ola::rdm::UIDSet &uids) { m_known_uids = uids; }
+  const ola::rdm::UIDSet &KnownUIDs() const { return m_known_uids; }
+
  private:
   ola::rdm::UIDSet *m_uids;
+  ola::rdm::UIDSet m_known_uids;
   std::auto_ptr<RDMRequestHandler> m_rdm_handler;
 };
 
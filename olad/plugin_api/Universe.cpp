@@ -30,6 +30,7 @@
  *   A list of sink clients, which we update whenever the DmxBuffer changes.
  */
 
+#include <string.h>
 #include <algorithm>
 #include <iterator>
 #include <map>
@@ -39,7 +40,9 @@
 #include <utility>
 #include <vector>
 
+#include "common/dmx/PriorityMerge.h"
 #include "ola/base/Array.h"
+#include "ola/Constants.h"
 #include "ola/Logging.h"
 #include "ola/MultiCallback.h"
 #include "ola/rdm/RDMCommand.h"
@@ -49,6 +52,9 @@
 #include "olad/Port.h"
 #include "olad/Universe.h"
 #include "olad/plugin_api/Client.h"
+#include "olad/plugin_api/OutputPacer.h"
+#include "olad/plugin_api/RDMResponseCache.h"
+#include "olad/plugin_api/RDMScheduler.h"
 #include "olad/plugin_api/UniverseStore.h"
 
 namespace ola {
@@ -56,6 +62,7 @@ namespace ola {
 using ola::rdm::RDMDiscoveryCallback;
 using ola::rdm::RDMReply;
 using ola::rdm::RDMRequest;
+using ola::rdm::RDMResponse;
 using ola::rdm::RunRDMCallback;
 using ola::rdm::UID;
 using ola::strings::ToHex;
@@ -74,6 +81,13 @@ const char Universe::K_UNIVERSE_INPUT_PORT_VAR[] = "universe-input-ports";
 const char Universe::K_UNIVERSE_MODE_VAR[] = "universe-mode";
 const char Universe::K_UNIVERSE_NAME_VAR[] = "universe-name";
 const char Universe::K_UNIVERSE_OUTPUT_PORT_VAR[] = "universe-output-ports";
+const char Universe::K_UNIVERSE_RDM_CACHE_HITS[] = "universe-rdm-cache-hits";
+const char Universe::K_UNIVERSE_RDM_CACHE_MISSES[] =
+    "universe-rdm-cache-misses";
+const char Universe::K_UNIVERSE_RDM_DISCOVERIES[] =
+    "universe-rdm-discoveries";
+const char Universe::K_UNIVERSE_RDM_DISCOVERY_TIME_VAR[] =
+    "universe-rdm-discovery-time-ms";
 const char Universe::K_UNIVERSE_RDM_REQUESTS[] = "universe-rdm-requests";
 const char Universe::K_UNIVERSE_SINK_CLIENTS_VAR[] = "universe-sink-clients";
 const char Universe::K_UNIVERSE_SOURCE_CLIENTS_VAR[] =
@@ -94,9 +108,18 @@ Universe::Universe(unsigned int universe_id, UniverseStore *store,
       m_merge_mode(Universe::MERGE_LTP),
       m_universe_store(store),
       m_export_map(export_map),
+      m_rdm_cache(new RDMResponseCache(clock)),
+      m_rdm_scheduler(new RDMScheduler(clock, export_map)),
+      m_output_pacer(new OutputPacer(
+          clock, export_map,
+          NewCallback(m_rdm_scheduler, &RDMScheduler::DMXSent))),
       m_clock(clock),
       m_rdm_discovery_interval(),
-      m_last_discovery_time() {
+      m_last_discovery_time(),
+      m_active_sources_stale(true),
+      m_slot_priority_merge(false),
+      m_slot_merge_stale(true),
+      m_slot_merge_length(0) {
   ostringstream universe_id_str, universe_name_str;
   universe_id_str << universe_id;
   m_universe_id_str = universe_id_str.str();
@@ -110,6 +133,10 @@ Universe::Universe(unsigned int universe_id, UniverseStore *store,
     K_FPS_VAR,
     K_UNIVERSE_INPUT_PORT_VAR,
     K_UNIVERSE_OUTPUT_PORT_VAR,
+    K_UNIVERSE_RDM_CACHE_HITS,
+    K_UNIVERSE_RDM_CACHE_MISSES,
+    K_UNIVERSE_RDM_DISCOVERIES,
+    K_UNIVERSE_RDM_DISCOVERY_TIME_VAR,
     K_UNIVERSE_RDM_REQUESTS,
     K_UNIVERSE_SINK_CLIENTS_VAR,
     K_UNIVERSE_SOURCE_CLIENTS_VAR,
@@ -120,6 +147,30 @@ Universe::Universe(unsigned int universe_id, UniverseStore *store,
     for (unsigned int i = 0; i < arraysize(vars); ++i) {
       (*m_export_map->GetUIntMapVar(vars[i]))[m_universe_id_str] = 0;
     }
+
+    // UpdateDependants() runs for every frame, so look the entries up once
+    // rather than by name each time.
+    m_frames_var = m_export_map->GetCounter(K_FPS_VAR, m_universe_id_str);
+    m_rdm_requests_var = m_export_map->GetCounter(K_UNIVERSE_RDM_REQUESTS,
+                                                  m_universe_id_str);
+    m_rdm_cache_hits_var = m_export_map->GetCounter(
+        K_UNIVERSE_RDM_CACHE_HITS, m_universe_id_str);
+    m_rdm_cache_misses_var = m_export_map->GetCounter(
+        K_UNIVERSE_RDM_CACHE_MISSES, m_universe_id_str);
+    m_rdm_discoveries_var = m_export_map->GetCounter(
+        K_UNIVERSE_RDM_DISCOVERIES, m_universe_id_str);
+    m_input_ports_var = m_export_map->GetGauge(K_UNIVERSE_INPUT_PORT_VAR,
+                                               m_universe_id_str);
+    m_output_ports_var = m_export_map->GetGauge(K_UNIVERSE_OUTPUT_PORT_VAR,
+                                                m_universe_id_str);
+    m_sink_clients_var = m_export_map->GetGauge(K_UNIVERSE_SINK_CLIENTS_VAR,
+                                                m_universe_id_str);
+    m_source_clients_var = m_export_map->GetGauge(
+        K_UNIVERSE_SOURCE_CLIENTS_VAR, m_universe_id_str);
+    m_rdm_discovery_time_var = m_export_map->GetGauge(
+        K_UNIVERSE_RDM_DISCOVERY_TIME_VAR, m_universe_id_str);
+    m_uid_count_var = m_export_map->GetGauge(K_UNIVERSE_UID_COUNT_VAR,
+                                             m_universe_id_str);
   }
 
   // We set the last discovery time to now, since most ports will trigger
@@ -141,6 +192,10 @@ Universe::~Universe() {
     K_FPS_VAR,
     K_UNIVERSE_INPUT_PORT_VAR,
     K_UNIVERSE_OUTPUT_PORT_VAR,
+    K_UNIVERSE_RDM_CACHE_HITS,
+    K_UNIVERSE_RDM_CACHE_MISSES,
+    K_UNIVERSE_RDM_DISCOVERIES,
+    K_UNIVERSE_RDM_DISCOVERY_TIME_VAR,
     K_UNIVERSE_RDM_REQUESTS,
     K_UNIVERSE_SINK_CLIENTS_VAR,
     K_UNIVERSE_SOURCE_CLIENTS_VAR,
@@ -155,6 +210,24 @@ Universe::~Universe() {
       m_export_map->GetUIntMapVar(uint_vars[i])->Remove(m_universe_id_str);
     }
   }
+  delete m_output_pacer;
+  // This fails any requests that are in flight, which updates the cache, so
+  // it has to happen before m_rdm_cache is deleted.
+  delete m_rdm_scheduler;
+}
+
+
+void Universe::SetRDMSchedulerOptions(
+    ola::thread::SchedulerInterface *scheduler,
+    const RDMSchedulerOptions &options) {
+  m_rdm_scheduler->SetOptions(scheduler, options);
+}
+
+
+void Universe::SetOutputPacerOptions(
+    ola::thread::SchedulerInterface *scheduler,
+    const OutputPacerOptions &options) {
+  m_output_pacer->SetOptions(scheduler, options);
 }
 
 
@@ -180,6 +253,7 @@ void Universe::SetName(const string &name) {
  */
 void Universe::SetMergeMode(enum merge_mode merge_mode) {
   m_merge_mode = merge_mode;
+  m_slot_merge_stale = true;
   UpdateMode();
 }
 
@@ -189,6 +263,8 @@ void Universe::SetMergeMode(enum merge_mode merge_mode) {
  * @param port the port to add
  */
 bool Universe::AddPort(InputPort *port) {
+  m_active_sources_stale = true;
+  m_slot_merge_stale = true;
   return GenericAddPort(port, &m_input_ports);
 }
 
@@ -208,6 +284,8 @@ bool Universe::AddPort(OutputPort *port) {
  * @return true if the port was removed, false if it didn't exist
  */
 bool Universe::RemovePort(InputPort *port) {
+  m_active_sources_stale = true;
+  m_slot_merge_stale = true;
   return GenericRemovePort(port, &m_input_ports);
 }
 
@@ -219,11 +297,9 @@ bool Universe::RemovePort(InputPort *port) {
  */
 bool Universe::RemovePort(OutputPort *port) {
   bool ret = GenericRemovePort(port, &m_output_ports, &m_output_uids);
-
-  if (m_export_map) {
-    (*m_export_map->GetUIntMapVar(K_UNIVERSE_UID_COUNT_VAR))[m_universe_id_str]
-        = m_output_uids.size();
-  }
+  m_output_pacer->RemovePort(port);
+  m_rdm_scheduler->RemovePort(port);
+  UIDsChanged();
   return ret;
 }
 
@@ -281,11 +357,13 @@ bool Universe::AddSourceClient(Client *client) {
   if (STLReplace(&m_source_clients, client, false)) {
     return true;
   }
+  m_active_sources_stale = true;
+  m_slot_merge_stale = true;
 
   OLA_INFO << "Added source client, " << client << " to universe "
            << m_universe_id;
 
-  SafeIncrement(K_UNIVERSE_SOURCE_CLIENTS_VAR);
+  m_source_clients_var.Increment();
   return true;
 }
 
@@ -301,8 +379,10 @@ bool Universe::RemoveSourceClient(Client *client) {
   if (!STLRemove(&m_source_clients, client)) {
     return false;
   }
+  m_active_sources_stale = true;
+  m_slot_merge_stale = true;
 
-  SafeDecrement(K_UNIVERSE_SOURCE_CLIENTS_VAR);
+  m_source_clients_var.Decrement();
 
   OLA_INFO << "Source client " << client << " has been removed from uni "
            << m_universe_id;
@@ -337,7 +417,7 @@ bool Universe::AddSinkClient(Client *client) {
   OLA_INFO << "Added sink client, " << client << " to universe "
            << m_universe_id;
 
-  SafeIncrement(K_UNIVERSE_SINK_CLIENTS_VAR);
+  m_sink_clients_var.Increment();
   return true;
 }
 
@@ -354,7 +434,7 @@ bool Universe::RemoveSinkClient(Client *client) {
     return false;
   }
 
-  SafeDecrement(K_UNIVERSE_SINK_CLIENTS_VAR);
+  m_sink_clients_var.Decrement();
 
   OLA_INFO << "Sink client " << client << " has been removed from uni "
            << m_universe_id;
@@ -434,7 +514,9 @@ void Universe::CleanStaleSourceClients() {
     if (iter->second) {
       // if stale remove it
       m_source_clients.erase(iter++);
-      SafeDecrement(K_UNIVERSE_SOURCE_CLIENTS_VAR);
+      m_active_sources_stale = true;
+      m_slot_merge_stale = true;
+      m_source_clients_var.Decrement();
       OLA_INFO << "Removed Stale Client";
       if (!IsActive()) {
         m_universe_store->AddUniverseGarbageCollection(this);
@@ -463,7 +545,8 @@ void Universe::SendRDMRequest(RDMRequest *request_ptr,
            << ToHex(request->ParamId()) << ", PDL: "
            << request->ParamDataSize();
 
-  SafeIncrement(K_UNIVERSE_RDM_REQUESTS);
+  m_rdm_requests_var++;
+  m_rdm_cache->RequestSent(*request);
 
   if (request->DestinationUID().IsBroadcast()) {
     if (m_output_ports.empty()) {
@@ -488,13 +571,15 @@ void Universe::SendRDMRequest(RDMRequest *request_ptr,
          ++port_iter) {
       // because each port deletes the request, we need to copy it here
       if (request->IsDUB()) {
-        (*port_iter)->SendRDMRequest(
+        m_rdm_scheduler->SendRDMRequest(
+            *port_iter,
             request->Duplicate(),
             NewSingleCallback(this,
                               &Universe::HandleBroadcastDiscovery,
                               tracker));
       } else  {
-        (*port_iter)->SendRDMRequest(
+        m_rdm_scheduler->SendRDMRequest(
+            *port_iter,
             request->Duplicate(),
             NewSingleCallback(this, &Universe::HandleBroadcastAck, tracker));
       }
@@ -507,9 +592,28 @@ void Universe::SendRDMRequest(RDMRequest *request_ptr,
       OLA_WARN << "Can't find UID " << request->DestinationUID()
                << " in the output universe map, dropping request";
       RunRDMCallback(callback, ola::rdm::RDM_UNKNOWN_UID);
-    } else {
-      iter->second->SendRDMRequest(request.release(), callback);
+      return;
+    }
+
+    RDMResponse *response = m_rdm_cache->Lookup(*request);
+    if (response) {
+      m_rdm_cache_hits_var++;
+      RDMReply reply(ola::rdm::RDM_COMPLETED_OK, response);
+      callback->Run(&reply);
+      return;
+    }
+
+    if (RDMResponseCache::IsCacheable(*request)) {
+      m_rdm_cache_misses_var++;
     }
+    // The port deletes the request, so we keep a copy to update the cache
+    // with once the reply arrives.
+    RDMRequest *cache_request = request->Duplicate();
+    m_rdm_scheduler->SendRDMRequest(
+        iter->second,
+        request.release(),
+        NewSingleCallback(this, &Universe::HandleRDMReply, cache_request,
+                          callback));
   }
 }
 
@@ -527,6 +631,11 @@ void Universe::RunRDMDiscovery(RDMDiscoveryCallback *on_complete, bool full) {
 
   m_clock->CurrentTime(&m_last_discovery_time);
 
+  if (full) {
+    // Full discovery is how users ask for everything to be refreshed.
+    m_rdm_cache->Clear();
+  }
+
   // we need to make a copy of the ports first, because the callback may run at
   // any time so we need to guard against the port list changing.
   vector<OutputPort*> output_ports(m_output_ports.size());
@@ -581,11 +690,7 @@ void Universe::NewUIDList(OutputPort *port, const ola::rdm::UIDSet &uids) {
       OLA_WARN << "UID " << *set_iter << " seen on more than one port";
     }
   }
-
-  if (m_export_map) {
-    (*m_export_map->GetUIntMapVar(K_UNIVERSE_UID_COUNT_VAR))[m_universe_id_str]
-        = m_output_uids.size();
-  }
+  UIDsChanged();
 }
 
 
@@ -600,6 +705,19 @@ void Universe::GetUIDs(ola::rdm::UIDSet *uids) const {
 }
 
 
+/*
+ * Returns the UIDs that were discovered on a port
+ */
+void Universe::GetUIDs(const OutputPort *port, ola::rdm::UIDSet *uids) const {
+  map<UID, OutputPort*>::const_iterator iter = m_output_uids.begin();
+  for (; iter != m_output_uids.end(); ++iter) {
+    if (iter->second == port) {
+      uids->AddUID(iter->first);
+    }
+  }
+}
+
+
 /**
  * Return the number of uids in the universe
  */
@@ -632,17 +750,18 @@ bool Universe::UpdateDependants() {
 
   // write to all ports assigned to this universe
   for (iter = m_output_ports.begin(); iter != m_output_ports.end(); ++iter) {
-    (*iter)->WriteDMX(m_buffer, m_active_priority);
+    m_output_pacer->WriteDMX(*iter, m_buffer, m_active_priority);
   }
 
-  // write to all clients
+  // write to all clients, streaming clients share the encoded update
+  ClientDmxUpdate update(m_universe_id, m_active_priority, m_buffer);
   for (client_iter = m_sink_clients.begin();
        client_iter != m_sink_clients.end();
        ++client_iter) {
-    (*client_iter)->SendDMX(m_universe_id, m_active_priority, m_buffer);
+    (*client_iter)->SendDMXUpdate(update);
   }
 
-  SafeIncrement(K_FPS_VAR);
+  m_frames_var++;
   return true;
 }
 
@@ -673,17 +792,19 @@ void Universe::UpdateMode() {
 
 
 /*
- * HTP Merge all sources (clients/ports)
- * @pre sources.size >= 2
- * @param sources the list of DmxSources to merge
+ * HTP Merge all active sources (clients/ports)
+ * @pre m_active_sources.size >= 2
  */
-void Universe::HTPMergeSources(const vector<DmxSource> &sources) {
-  vector<DmxSource>::const_iterator iter;
-  m_buffer.Reset();
-
-  for (iter = sources.begin(); iter != sources.end(); ++iter) {
-    m_buffer.HTPMerge(iter->Data());
+void Universe::HTPMergeSources() {
+  vector<const DmxSource*>::const_iterator iter;
+  m_merge_buffers.clear();
+  for (iter = m_active_sources.begin(); iter != m_active_sources.end();
+       ++iter) {
+    m_merge_buffers.push_back(&(*iter)->Data());
   }
+
+  m_buffer.Reset();
+  m_buffer.HTPMerge(m_merge_buffers);
 }
 
 
@@ -696,103 +817,386 @@ void Universe::HTPMergeSources(const vector<DmxSource> &sources) {
  * @returns true if the data for this universe changed, false otherwise
  */
 bool Universe::MergeAll(const InputPort *port, const Client *client) {
-  vector<DmxSource> active_sources;
-
-  vector<InputPort*>::const_iterator iter;
-  SourceClientMap::const_iterator client_iter;
+  const DmxSource &changed_source = port ?
+      port->SourceData() : client->SourceData(UniverseId());
 
-  m_active_priority = ola::dmx::SOURCE_PRIORITY_MIN;
   TimeStamp now;
   m_clock->CurrentTime(&now);
-  bool changed_source_is_active = false;
 
-  // Find the highest active ports
-  for (iter = m_input_ports.begin(); iter != m_input_ports.end(); ++iter) {
-    DmxSource source = (*iter)->SourceData();
-    if (!source.IsSet() || !source.IsActive(now) || !source.Data().Size()) {
-      continue;
+  if (changed_source.HasSlotPriorities() || m_slot_priority_merge) {
+    bool changed = false;
+    if (m_slot_priority_merge &&
+        UpdateSlotPriorityMerge(changed_source, now, &changed)) {
+      return changed;
     }
-
-    if (source.Priority() > m_active_priority) {
-      changed_source_is_active = false;
-      active_sources.clear();
-      m_active_priority = source.Priority();
+    m_slot_priority_merge = SlotPriorityMergeSources(now, &changed);
+    if (m_slot_priority_merge) {
+      return changed;
     }
+    // None of the sources have per-slot priorities any more.
+    m_active_sources_stale = true;
+  }
 
-    if (source.Priority() == m_active_priority) {
-      active_sources.push_back(source);
-      if (*iter == port) {
-        changed_source_is_active = true;
+  if (!UpdateActiveSources(&changed_source, now)) {
+    // this source didn't have any effect, skip
+    return false;
+  }
+
+  // only one source at the active priority
+  if (m_active_sources.size() == 1) {
+    m_buffer.Set(changed_source.Data());
+  } else {
+    // multi source merge
+    if (m_merge_mode == Universe::MERGE_LTP) {
+      // check that the current port/client is newer than all other active
+      // sources
+      vector<const DmxSource*>::const_iterator source_iter =
+          m_active_sources.begin();
+      for (; source_iter != m_active_sources.end(); source_iter++) {
+        if (changed_source.Timestamp() < (*source_iter)->Timestamp()) {
+          return false;
+        }
       }
+      // if we made it to here this is the newest source
+      m_buffer.Set(changed_source.Data());
+    } else {
+      HTPMergeSources();
     }
   }
+  return true;
+}
 
-  // find the highest priority active clients
+
+/*
+ * Merge all sources slot by slot, using per-slot priorities where a source has
+ * them and the source's priority otherwise.
+ * Within a slot, sources at the same priority are merged according to the
+ * merge mode.
+ * @param now the current time
+ * @param[out] changed set to true if the merged data or priority changed
+ * @returns true if the sources were merged, false if none of the sources have
+ *   per-slot priorities.
+ */
+bool Universe::SlotPriorityMergeSources(const TimeStamp &now, bool *changed) {
+  vector<const DmxSource*> &sources = m_slot_merge_candidates;
+  sources.clear();
+  bool has_slot_priorities = false;
+
+  vector<InputPort*>::const_iterator iter;
+  for (iter = m_input_ports.begin(); iter != m_input_ports.end(); ++iter) {
+    const DmxSource &source = (*iter)->SourceData();
+    if (IsMergeable(source, now)) {
+      sources.push_back(&source);
+      has_slot_priorities |= source.HasSlotPriorities();
+    }
+  }
+
+  SourceClientMap::const_iterator client_iter;
   for (client_iter = m_source_clients.begin();
        client_iter != m_source_clients.end();
        ++client_iter) {
     const DmxSource &source = client_iter->first->SourceData(UniverseId());
-
-    if (!source.IsSet() || !source.IsActive(now) || !source.Data().Size()) {
-      continue;
+    if (IsMergeable(source, now)) {
+      sources.push_back(&source);
+      has_slot_priorities |= source.HasSlotPriorities();
     }
+  }
 
-    if (source.Priority() > m_active_priority) {
-      changed_source_is_active = false;
-      active_sources.clear();
-      m_active_priority = source.Priority();
-    }
+  m_slot_merge_sources.clear();
+  m_slot_merge_stale = true;
+  if (!has_slot_priorities) {
+    return false;
+  }
 
-    if (source.Priority() == m_active_priority) {
-      active_sources.push_back(source);
-      if (client_iter->first == client) {
-        changed_source_is_active = true;
-      }
+  ola::dmx::PriorityTieBreak tie_break = ola::dmx::PRIORITY_TIE_HTP;
+  if (m_merge_mode == Universe::MERGE_LTP) {
+    // The kernel lets the last source win ties, so merge oldest first.
+    std::sort(sources.begin(), sources.end(), IsOlderSource);
+    tie_break = ola::dmx::PRIORITY_TIE_LATEST;
+  }
+  ola::dmx::PriorityMergeFunction merge =
+      ola::dmx::GetPriorityMergeFunction(tie_break);
+
+  uint8_t source_priorities[DMX_UNIVERSE_SIZE];
+  memset(m_slot_merge_data, 0, sizeof(m_slot_merge_data));
+  memset(m_slot_merge_priorities, 0, sizeof(m_slot_merge_priorities));
+  m_slot_merge_length = 0;
+
+  vector<const DmxSource*>::const_iterator source_iter;
+  for (source_iter = sources.begin(); source_iter != sources.end();
+       ++source_iter) {
+    const DmxSource *source = *source_iter;
+    const unsigned int source_length = SlotMergeLength(*source);
+    const uint8_t *slot_priorities = source_priorities;
+    if (source->HasSlotPriorities()) {
+      slot_priorities = source->SlotPriorities().GetRaw();
+    } else {
+      memset(source_priorities, SlotPriority(*source, 0), source_length);
     }
+    merge(m_slot_merge_data, m_slot_merge_priorities,
+          source->Data().GetRaw(), slot_priorities, source_length);
+    m_slot_merge_length = std::max(m_slot_merge_length, source_length);
+
+    slot_merge_source merge_source;
+    merge_source.source = source;
+    merge_source.data = source->Data();
+    merge_source.slot_priorities = source->SlotPriorities();
+    merge_source.priority = source->Priority();
+    m_slot_merge_sources.push_back(merge_source);
   }
+  m_slot_merge_stale = false;
 
-  if (active_sources.empty()) {
-    OLA_WARN << "Something changed but we didn't find any active sources "
-             << " for universe " << UniverseId();
+  uint8_t active_priority = ola::dmx::SOURCE_PRIORITY_MIN;
+  if (m_slot_merge_length) {
+    active_priority = *std::max_element(
+        m_slot_merge_priorities,
+        m_slot_merge_priorities + m_slot_merge_length);
+  }
+
+  *changed = (active_priority != m_active_priority ||
+              m_slot_merge_length != m_buffer.Size() ||
+              (m_slot_merge_length &&
+               memcmp(m_slot_merge_data, m_buffer.GetRaw(),
+                      m_slot_merge_length)));
+  if (*changed) {
+    m_active_priority = active_priority;
+    m_buffer.Set(m_slot_merge_data, m_slot_merge_length);
+  }
+  return true;
+}
+
+
+/*
+ * Update the last per-slot priority merge after a single source has changed.
+ *
+ * This only works if the same sources are merged as last time, and the
+ * changed source's priorities are the same, so the winning priority of each
+ * slot can't have changed. Only the slots where the changed source is at the
+ * winning priority are looked at.
+ * @param changed_source the source that changed
+ * @param now the current time
+ * @param[out] changed set to true if the merged data changed
+ * @returns true if the merge was updated, false if all the sources need to be
+ *   merged again.
+ */
+bool Universe::UpdateSlotPriorityMerge(const DmxSource &changed_source,
+                                       const TimeStamp &now,
+                                       bool *changed) {
+  if (m_slot_merge_stale) {
     return false;
   }
 
-  if (!changed_source_is_active) {
-    // this source didn't have any effect, skip
+  slot_merge_source *merge_source = NULL;
+  vector<slot_merge_source>::iterator iter = m_slot_merge_sources.begin();
+  for (; iter != m_slot_merge_sources.end(); ++iter) {
+    if (!IsMergeable(*iter->source, now)) {
+      return false;
+    }
+    if (iter->source == &changed_source) {
+      merge_source = &(*iter);
+    }
+  }
+
+  if (!merge_source ||
+      merge_source->priority != changed_source.Priority() ||
+      merge_source->data.Size() != changed_source.Data().Size() ||
+      merge_source->slot_priorities != changed_source.SlotPriorities()) {
     return false;
   }
 
-  // only one source at the active priority
-  if (active_sources.size() == 1) {
-    m_buffer.Set(active_sources[0].Data());
-  } else {
-    // multi source merge
-    if (m_merge_mode == Universe::MERGE_LTP) {
-      vector<DmxSource>::const_iterator source_iter = active_sources.begin();
-      DmxSource changed_source;
-      if (port) {
-        changed_source = port->SourceData();
-      } else {
-        changed_source = client->SourceData(UniverseId());
-      }
+  const bool htp = m_merge_mode == Universe::MERGE_HTP;
+  const uint8_t *data = changed_source.Data().GetRaw();
+  const uint8_t *old_data = merge_source->data.GetRaw();
+  const unsigned int length = SlotMergeLength(changed_source);
+  *changed = false;
+
+  for (unsigned int slot = 0; slot < length; slot++) {
+    // In LTP mode the changed source is now the newest, so it wins all its
+    // ties, even if the value is the same.
+    if ((htp && data[slot] == old_data[slot]) ||
+        SlotPriority(changed_source, slot) != m_slot_merge_priorities[slot]) {
+      continue;
+    }
 
-      // check that the current port/client is newer than all other active
-      // sources
-      for (; source_iter != active_sources.end(); source_iter++) {
-        if (changed_source.Timestamp() < source_iter->Timestamp()) {
-          return false;
+    uint8_t value = data[slot];
+    if (htp && value < m_slot_merge_data[slot]) {
+      if (old_data[slot] != m_slot_merge_data[slot]) {
+        // This source wasn't the highest
+        continue;
+      }
+      // Find the new highest value for this slot
+      for (iter = m_slot_merge_sources.begin();
+           iter != m_slot_merge_sources.end(); ++iter) {
+        const DmxSource *source = iter->source;
+        if (slot < SlotMergeLength(*source) &&
+            SlotPriority(*source, slot) == m_slot_merge_priorities[slot]) {
+          value = std::max(value, source->Data().Get(slot));
         }
       }
-      // if we made it to here this is the newest source
-      m_buffer.Set(changed_source.Data());
-    } else {
-      HTPMergeSources(active_sources);
+    }
+
+    if (value != m_slot_merge_data[slot]) {
+      m_slot_merge_data[slot] = value;
+      *changed = true;
     }
   }
+
+  merge_source->data = changed_source.Data();
+  if (*changed) {
+    m_buffer.Set(m_slot_merge_data, m_slot_merge_length);
+  }
   return true;
 }
 
 
+/*
+ * Update the table of active sources after a source has changed.
+ *
+ * In the common case, where the source is already one of the active sources
+ * or is below the active priority, this doesn't need to look at the other
+ * ports & clients. The table is only rebuilt if a port or client has been
+ * added or removed, or one of the active sources has timed out or dropped its
+ * priority.
+ * @param changed_source the source that changed
+ * @param now the current time
+ * @returns true if the changed source is one of the active sources.
+ */
+bool Universe::UpdateActiveSources(const DmxSource *changed_source,
+                                   const TimeStamp &now) {
+  vector<const DmxSource*>::iterator member = m_active_sources.end();
+  if (!m_active_sources_stale) {
+    vector<const DmxSource*>::iterator iter = m_active_sources.begin();
+    for (; iter != m_active_sources.end(); ++iter) {
+      if (*iter == changed_source) {
+        member = iter;
+      } else if (!IsMergeable(**iter, now) ||
+                 (*iter)->Priority() != m_active_priority) {
+        m_active_sources_stale = true;
+        break;
+      }
+    }
+  }
+
+  if (!m_active_sources_stale) {
+    bool mergeable = IsMergeable(*changed_source, now);
+    if (member != m_active_sources.end()) {
+      if (mergeable && changed_source->Priority() == m_active_priority) {
+        return true;
+      }
+      // The changed source has dropped out, we need to find what replaces it.
+      m_active_sources_stale = true;
+    } else if (!mergeable ||
+               (changed_source->Priority() < m_active_priority &&
+                !m_active_sources.empty())) {
+      return false;
+    } else {
+      if (changed_source->Priority() > m_active_priority ||
+          m_active_sources.empty()) {
+        m_active_sources.clear();
+        m_active_priority = changed_source->Priority();
+      }
+      m_active_sources.push_back(changed_source);
+      return true;
+    }
+  }
+
+  RebuildActiveSources(now);
+  return std::find(m_active_sources.begin(), m_active_sources.end(),
+                   changed_source) != m_active_sources.end();
+}
+
+
+/*
+ * Rebuild the table of active sources from the ports & clients.
+ * @param now the current time
+ */
+void Universe::RebuildActiveSources(const TimeStamp &now) {
+  m_active_sources.clear();
+  m_active_priority = ola::dmx::SOURCE_PRIORITY_MIN;
+  m_active_sources_stale = false;
+
+  // Find the highest active ports
+  vector<InputPort*>::const_iterator iter;
+  for (iter = m_input_ports.begin(); iter != m_input_ports.end(); ++iter) {
+    ConsiderSource(&(*iter)->SourceData(), now);
+  }
+
+  // find the highest priority active clients
+  SourceClientMap::const_iterator client_iter;
+  for (client_iter = m_source_clients.begin();
+       client_iter != m_source_clients.end();
+       ++client_iter) {
+    ConsiderSource(&client_iter->first->SourceData(UniverseId()), now);
+  }
+
+  if (m_active_sources.empty()) {
+    OLA_WARN << "Something changed but we didn't find any active sources "
+             << " for universe " << UniverseId();
+  }
+}
+
+
+/*
+ * Add a source to the active table if it's at or above the active priority.
+ */
+void Universe::ConsiderSource(const DmxSource *source, const TimeStamp &now) {
+  if (!IsMergeable(*source, now)) {
+    return;
+  }
+
+  if (source->Priority() > m_active_priority) {
+    m_active_sources.clear();
+    m_active_priority = source->Priority();
+  }
+
+  if (source->Priority() == m_active_priority) {
+    m_active_sources.push_back(source);
+  }
+}
+
+
+/*
+ * Used to sort sources by timestamp.
+ */
+bool Universe::IsOlderSource(const DmxSource *source1,
+                             const DmxSource *source2) {
+  return source1->Timestamp() < source2->Timestamp();
+}
+
+
+/*
+ * Return the number of slots a source contributes to a per-slot priority
+ * merge.
+ */
+unsigned int Universe::SlotMergeLength(const DmxSource &source) {
+  if (source.HasSlotPriorities()) {
+    return std::min(source.Data().Size(), source.SlotPriorities().Size());
+  }
+  return source.Data().Size();
+}
+
+
+/*
+ * Return the priority of a slot from a source.
+ */
+uint8_t Universe::SlotPriority(const DmxSource &source, unsigned int slot) {
+  if (source.HasSlotPriorities()) {
+    return source.SlotPriorities().Get(slot);
+  }
+  // A slot priority of 0 means the slot isn't sourced, so a source priority
+  // of 0 is merged as 1.
+  return std::max(source.Priority(), static_cast<uint8_t>(1));
+}
+
+
+/*
+ * Check if a source has data that should be merged.
+ */
+bool Universe::IsMergeable(const DmxSource &source, const TimeStamp &now) {
+  return source.IsSet() && source.IsActive(now) && source.Data().Size();
+}
+
+
 /**
  * Called when discovery completes on a single ports.
  */
@@ -808,6 +1212,14 @@ void Universe::PortDiscoveryComplete(BaseCallback0<void> *on_complete,
  * Called when discovery completes on all ports.
  */
 void Universe::DiscoveryComplete(RDMDiscoveryCallback *on_complete) {
+  if (m_rdm_discovery_time_var.IsValid()) {
+    TimeStamp now;
+    m_clock->CurrentTime(&now);
+    m_rdm_discovery_time_var.Set(
+        (now - m_last_discovery_time).InMilliSeconds());
+  }
+  m_rdm_discoveries_var++;
+
   ola::rdm::UIDSet uids;
   GetUIDs(&uids);
   if (on_complete) {
@@ -882,22 +1294,28 @@ void Universe::HandleBroadcastDiscovery(
 }
 
 
-/*
- * Helper function to increment an Export Map variable
+/**
+ * Update the response cache with the reply to a request sent to a single
+ * responder, then pass the reply on.
  */
-void Universe::SafeIncrement(const string &name) {
-  if (m_export_map) {
-    (*m_export_map->GetUIntMapVar(name))[m_universe_id_str]++;
-  }
+void Universe::HandleRDMReply(RDMRequest *request,
+                              ola::rdm::RDMCallback *callback,
+                              RDMReply *reply) {
+  m_rdm_cache->ReplyReceived(*request, *reply);
+  delete request;
+  callback->Run(reply);
 }
 
+
 /*
- * Helper function to decrement an Export Map variable
+ * Called when the UID : port mapping changes.
  */
-void Universe::SafeDecrement(const string &name) {
-  if (m_export_map) {
-    (*m_export_map->GetUIntMapVar(name))[m_universe_id_str]--;
-  }
+void Universe::UIDsChanged() {
+  ola::rdm::UIDSet uids;
+  GetUIDs(&uids);
+  m_rdm_cache->RetainUIDs(uids);
+
+  m_uid_count_var.Set(m_output_uids.size());
 }
 
 
@@ -913,11 +1331,10 @@ bool Universe::GenericAddPort(PortClass *port, vector<PortClass*> *ports) {
   }
 
   ports->push_back(port);
-  if (m_export_map) {
-    UIntMap *map = m_export_map->GetUIntMapVar(
-        IsInputPort<PortClass>() ? K_UNIVERSE_INPUT_PORT_VAR :
-        K_UNIVERSE_OUTPUT_PORT_VAR);
-    (*map)[m_universe_id_str]++;
+  if (IsInputPort<PortClass>()) {
+    m_input_ports_var.Increment();
+  } else {
+    m_output_ports_var.Increment();
   }
   return true;
 }
@@ -942,11 +1359,10 @@ bool Universe::GenericRemovePort(PortClass *port,
   }
 
   ports->erase(iter);
-  if (m_export_map) {
-    UIntMap *map = m_export_map->GetUIntMapVar(
-        IsInputPort<PortClass>() ? K_UNIVERSE_INPUT_PORT_VAR :
-        K_UNIVERSE_OUTPUT_PORT_VAR);
-    (*map)[m_universe_id_str]--;
+  if (IsInputPort<PortClass>()) {
+    m_input_ports_var.Decrement();
+  } else {
+    m_output_ports_var.Decrement();
   }
 
   if (!IsActive()) {
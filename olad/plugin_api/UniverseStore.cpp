@@ -47,7 +47,9 @@ const unsigned int UniverseStore::MINIMUM_RDM_DISCOVERY_INTERVAL = 30;
 UniverseStore::UniverseStore(Preferences *preferences,
                              ExportMap *export_map)
     : m_preferences(preferences),
-      m_export_map(export_map) {
+      m_export_map(export_map),
+      m_rdm_scheduler(NULL),
+      m_output_scheduler(NULL) {
   if (export_map) {
     export_map->GetStringMapVar(Universe::K_UNIVERSE_NAME_VAR, "universe");
     export_map->GetStringMapVar(Universe::K_UNIVERSE_MODE_VAR, "universe");
@@ -83,6 +85,10 @@ Universe *UniverseStore::GetUniverseOrCreate(unsigned int universe_id) {
     iter->second = new Universe(universe_id, this, m_export_map, &m_clock);
 
     if (iter->second) {
+      iter->second->SetRDMSchedulerOptions(m_rdm_scheduler,
+                                           m_rdm_scheduler_options);
+      iter->second->SetOutputPacerOptions(m_output_scheduler,
+                                          m_output_pacer_options);
       if (m_preferences) {
         RestoreUniverseSettings(iter->second);
       }
@@ -108,6 +114,30 @@ void UniverseStore::DeleteAll() {
   m_universe_map.clear();
 }
 
+void UniverseStore::SetRDMSchedulerOptions(
+    ola::thread::SchedulerInterface *scheduler,
+    const RDMSchedulerOptions &options) {
+  m_rdm_scheduler = scheduler;
+  m_rdm_scheduler_options = options;
+
+  UniverseMap::iterator iter = m_universe_map.begin();
+  for (; iter != m_universe_map.end(); ++iter) {
+    iter->second->SetRDMSchedulerOptions(scheduler, options);
+  }
+}
+
+void UniverseStore::SetOutputPacerOptions(
+    ola::thread::SchedulerInterface *scheduler,
+    const OutputPacerOptions &options) {
+  m_output_scheduler = scheduler;
+  m_output_pacer_options = options;
+
+  UniverseMap::iterator iter = m_universe_map.begin();
+  for (; iter != m_universe_map.end(); ++iter) {
+    iter->second->SetOutputPacerOptions(scheduler, options);
+  }
+}
+
 void UniverseStore::AddUniverseGarbageCollection(Universe *universe) {
   m_deletion_candiates.insert(universe);
 }
@@ -28,6 +28,9 @@
 
 #include "ola/Clock.h"
 #include "ola/base/Macro.h"
+#include "ola/thread/SchedulerInterface.h"
+#include "olad/plugin_api/OutputPacer.h"
+#include "olad/plugin_api/RDMScheduler.h"
 
 namespace ola {
 
@@ -92,6 +95,25 @@ class UniverseStore {
    */
   void GarbageCollectUniverses();
 
+  /**
+   * @brief Set how RDM requests are scheduled, for both the existing and new
+   * universes.
+   * @param scheduler the scheduler used to pace RDM requests, may be NULL.
+   * @param options the RDMSchedulerOptions.
+   */
+  void SetRDMSchedulerOptions(ola::thread::SchedulerInterface *scheduler,
+                              const RDMSchedulerOptions &options);
+
+  /**
+   * @brief Set how DMX frames are paced on the output ports, for both the
+   * existing and new universes.
+   * @param scheduler the scheduler used to write held and keepalive frames,
+   *   may be NULL.
+   * @param options the OutputPacerOptions.
+   */
+  void SetOutputPacerOptions(ola::thread::SchedulerInterface *scheduler,
+                             const OutputPacerOptions &options);
+
  private:
   typedef std::map<unsigned int, Universe*> UniverseMap;
 
@@ -101,6 +123,10 @@ class UniverseStore {
   std::set<Universe*> m_deletion_candiates;  // list of universes we may be
                                              // able to delete
   Clock m_clock;
+  ola::thread::SchedulerInterface *m_rdm_scheduler;
+  RDMSchedulerOptions m_rdm_scheduler_options;
+  ola::thread::SchedulerInterface *m_output_scheduler;
+  OutputPacerOptions m_output_pacer_options;
 
   bool RestoreUniverseSettings(Universe *universe) const;
   bool SaveUniverseSettings(Universe *universe) const;
@@ -76,6 +76,9 @@ class UniverseTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testSinkClients);
   CPPUNIT_TEST(testLtpMerging);
   CPPUNIT_TEST(testHtpMerging);
+  CPPUNIT_TEST(testActiveSources);
+  CPPUNIT_TEST(testSlotPriorityMerging);
+  CPPUNIT_TEST(testSlotPriorityUpdates);
   CPPUNIT_TEST(testRDMDiscovery);
   CPPUNIT_TEST(testRDMSend);
   CPPUNIT_TEST_SUITE_END();
@@ -91,6 +94,9 @@ class UniverseTest: public CppUnit::TestFixture {
   void testSinkClients();
   void testLtpMerging();
   void testHtpMerging();
+  void testActiveSources();
+  void testSlotPriorityMerging();
+  void testSlotPriorityUpdates();
   void testRDMDiscovery();
   void testRDMSend();
 
@@ -123,11 +129,10 @@ class MockClient: public ola::Client {
         m_dmx_set(false) {
   }
 
-  bool SendDMX(unsigned int universe_id, uint8_t priority,
-               const DmxBuffer &buffer) {
-    OLA_ASSERT_EQ(TEST_UNIVERSE, universe_id);
-    OLA_ASSERT_EQ(ola::dmx::SOURCE_PRIORITY_MIN, priority);
-    OLA_ASSERT_EQ(string(TEST_DATA), buffer.Get());
+  bool SendDMXUpdate(const ola::ClientDmxUpdate &update) {
+    OLA_ASSERT_EQ(TEST_UNIVERSE, update.UniverseId());
+    OLA_ASSERT_EQ(ola::dmx::SOURCE_PRIORITY_MIN, update.Priority());
+    OLA_ASSERT_EQ(string(TEST_DATA), update.Data().Get());
     m_dmx_set = true;
     return true;
   }
@@ -521,6 +526,296 @@ void UniverseTest::testHtpMerging() {
 }
 
 
+/**
+ * Check that the active sources are tracked as sources change priority, time
+ * out and are removed.
+ */
+void UniverseTest::testActiveSources() {
+  DmxBuffer buffer1, buffer2, htp_buffer;
+  buffer1.SetFromString("1,0,0,10");
+  buffer2.SetFromString("0,255,0,5,6,7");
+  htp_buffer.SetFromString("1,255,0,10,6,7");
+  uint8_t high_priority = 120;
+
+  ola::PortBroker broker;
+  ola::PortManager port_manager(m_store, &broker);
+
+  TimeStamp time_stamp;
+  MockSelectServer ss(&time_stamp);
+  ola::PluginAdaptor plugin_adaptor(NULL, &ss, NULL, NULL, NULL, NULL);
+  MockDevice device(NULL, "foo");
+  MockDevice device2(NULL, "bar");
+  TestMockInputPort port(&device, 1, &plugin_adaptor);  // input port
+  TestMockInputPort port2(&device2, 1, &plugin_adaptor);  // input port
+  port_manager.PatchPort(&port, TEST_UNIVERSE);
+  port_manager.PatchPort(&port2, TEST_UNIVERSE);
+
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+  universe->SetMergeMode(Universe::MERGE_HTP);
+
+  // The second port is at a higher priority
+  port2.SetPriority(high_priority);
+  m_clock.CurrentTime(&time_stamp);
+  port2.WriteDMX(buffer2);
+  port2.DmxChanged();
+  OLA_ASSERT_EQ(high_priority, universe->ActivePriority());
+  OLA_ASSERT(buffer2 == universe->GetDMX());
+
+  // so the first port is ignored
+  m_clock.CurrentTime(&time_stamp);
+  port.WriteDMX(buffer1);
+  port.DmxChanged();
+  OLA_ASSERT_EQ(high_priority, universe->ActivePriority());
+  OLA_ASSERT(buffer2 == universe->GetDMX());
+
+  // as is a client at the default priority
+  DmxBuffer client_buffer;
+  client_buffer.SetFromString("255,255,255,255");
+  ola::DmxSource source(client_buffer, time_stamp,
+                        ola::dmx::SOURCE_PRIORITY_DEFAULT);
+  MockClient input_client;
+  input_client.DMXReceived(TEST_UNIVERSE, source);
+  universe->SourceClientDataChanged(&input_client);
+  OLA_ASSERT_EQ(high_priority, universe->ActivePriority());
+  OLA_ASSERT(buffer2 == universe->GetDMX());
+  universe->RemoveSourceClient(&input_client);
+
+  // Raise the first port, both are now merged
+  port.SetPriority(high_priority);
+  m_clock.CurrentTime(&time_stamp);
+  port.DmxChanged();
+  OLA_ASSERT_EQ(high_priority, universe->ActivePriority());
+  OLA_ASSERT(htp_buffer == universe->GetDMX());
+
+  // Drop the first port again, this leaves the second port
+  port.SetPriority(ola::dmx::SOURCE_PRIORITY_DEFAULT);
+  m_clock.CurrentTime(&time_stamp);
+  port.DmxChanged();
+  OLA_ASSERT_EQ(high_priority, universe->ActivePriority());
+
+  m_clock.CurrentTime(&time_stamp);
+  port2.DmxChanged();
+  OLA_ASSERT_EQ(high_priority, universe->ActivePriority());
+  OLA_ASSERT(buffer2 == universe->GetDMX());
+
+  // Now time out the second port, the first port takes over
+  m_clock.CurrentTime(&time_stamp);
+  time_stamp -= ola::TimeInterval(3, 0);
+  port2.DmxChanged();
+  OLA_ASSERT_EQ(ola::dmx::SOURCE_PRIORITY_DEFAULT,
+                universe->ActivePriority());
+
+  m_clock.CurrentTime(&time_stamp);
+  port.DmxChanged();
+  OLA_ASSERT_EQ(ola::dmx::SOURCE_PRIORITY_DEFAULT,
+                universe->ActivePriority());
+  OLA_ASSERT(buffer1 == universe->GetDMX());
+
+  // The second port comes back
+  m_clock.CurrentTime(&time_stamp);
+  port2.DmxChanged();
+  OLA_ASSERT_EQ(high_priority, universe->ActivePriority());
+  OLA_ASSERT(buffer2 == universe->GetDMX());
+
+  // Remove the second port, the first port takes over on the next frame
+  universe->RemovePort(&port2);
+  m_clock.CurrentTime(&time_stamp);
+  port.DmxChanged();
+  OLA_ASSERT_EQ(ola::dmx::SOURCE_PRIORITY_DEFAULT,
+                universe->ActivePriority());
+  OLA_ASSERT(buffer1 == universe->GetDMX());
+
+  // clean up
+  universe->RemovePort(&port);
+  OLA_ASSERT_FALSE(universe->IsActive());
+}
+
+
+/**
+ * Check that per-slot priorities are merged correctly.
+ */
+void UniverseTest::testSlotPriorityMerging() {
+  DmxBuffer buffer1, buffer2, priorities1, priorities2;
+  buffer1.SetFromString("10,20,30,40,50");
+  priorities1.SetFromString("100,100,0,50,100");
+  buffer2.SetFromString("1,2,3,4,5,6");
+  priorities2.SetFromString("0,100,100,100,50,100");
+
+  ola::PortBroker broker;
+  ola::PortManager port_manager(m_store, &broker);
+
+  TimeStamp time_stamp;
+  MockSelectServer ss(&time_stamp);
+  ola::PluginAdaptor plugin_adaptor(NULL, &ss, NULL, NULL, NULL, NULL);
+  MockDevice device(NULL, "foo");
+  MockDevice device2(NULL, "bar");
+  TestMockPriorityInputPort port(&device, 1, &plugin_adaptor);
+  TestMockPriorityInputPort port2(&device2, 1, &plugin_adaptor);
+  port.SetPriorityMode(ola::PRIORITY_MODE_INHERIT);
+  port2.SetPriorityMode(ola::PRIORITY_MODE_INHERIT);
+  port_manager.PatchPort(&port, TEST_UNIVERSE);
+  port_manager.PatchPort(&port2, TEST_UNIVERSE);
+
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+  universe->SetMergeMode(Universe::MERGE_HTP);
+
+  // A single source with per-slot priorities, unsourced slots are 0.
+  m_clock.CurrentTime(&time_stamp);
+  port.WriteDMX(buffer1);
+  port.SetInheritedSlotPriorities(priorities1);
+  port.DmxChanged();
+  DmxBuffer expected;
+  expected.SetFromString("10,20,0,40,50");
+  OLA_ASSERT_EQ((uint8_t) 100, universe->ActivePriority());
+  OLA_ASSERT(expected == universe->GetDMX());
+
+  // Each source owns the slots it has the highest priority for, slot 2 is
+  // a HTP tie.
+  m_clock.CurrentTime(&time_stamp);
+  port2.WriteDMX(buffer2);
+  port2.SetInheritedSlotPriorities(priorities2);
+  port2.DmxChanged();
+  expected.SetFromString("10,20,3,4,50,6");
+  OLA_ASSERT_EQ((uint8_t) 100, universe->ActivePriority());
+  OLA_ASSERT(expected == universe->GetDMX());
+
+  // In LTP mode the newest source wins the tie.
+  universe->SetMergeMode(Universe::MERGE_LTP);
+  m_clock.CurrentTime(&time_stamp);
+  port2.DmxChanged();
+  expected.SetFromString("10,2,3,4,50,6");
+  OLA_ASSERT(expected == universe->GetDMX());
+
+  // A source without per-slot priorities uses its priority for all slots.
+  port2.SetInheritedSlotPriorities(DmxBuffer());
+  port2.SetInheritedPriority(75);
+  m_clock.CurrentTime(&time_stamp);
+  port2.DmxChanged();
+  expected.SetFromString("10,20,3,4,50,6");
+  OLA_ASSERT_EQ((uint8_t) 100, universe->ActivePriority());
+  OLA_ASSERT(expected == universe->GetDMX());
+
+  // Once neither source has per-slot priorities, we go back to the normal
+  // merge.
+  port.SetInheritedSlotPriorities(DmxBuffer());
+  m_clock.CurrentTime(&time_stamp);
+  port.DmxChanged();
+  OLA_ASSERT_EQ(ola::dmx::SOURCE_PRIORITY_DEFAULT,
+                universe->ActivePriority());
+  OLA_ASSERT(buffer1 == universe->GetDMX());
+
+  // clean up
+  universe->RemovePort(&port);
+  universe->RemovePort(&port2);
+  OLA_ASSERT_FALSE(universe->IsActive());
+}
+
+
+/**
+ * Check that a source that only changes its data updates the per-slot
+ * priority merge, and that frames which don't change the output aren't sent.
+ */
+void UniverseTest::testSlotPriorityUpdates() {
+  DmxBuffer buffer1, buffer2, priorities1, priorities2;
+  buffer1.SetFromString("10,20,30,40");
+  priorities1.SetFromString("100,100,100,50");
+  buffer2.SetFromString("5,25,1,1");
+  priorities2.SetFromString("100,100,50,100");
+
+  ola::PortBroker broker;
+  ola::PortManager port_manager(m_store, &broker);
+
+  TimeStamp time_stamp;
+  MockSelectServer ss(&time_stamp);
+  ola::PluginAdaptor plugin_adaptor(NULL, &ss, NULL, NULL, NULL, NULL);
+  MockDevice device(NULL, "foo");
+  MockDevice device2(NULL, "bar");
+  TestMockPriorityInputPort port(&device, 1, &plugin_adaptor);
+  TestMockPriorityInputPort port2(&device2, 1, &plugin_adaptor);
+  port.SetPriorityMode(ola::PRIORITY_MODE_INHERIT);
+  port2.SetPriorityMode(ola::PRIORITY_MODE_INHERIT);
+  port.SetInheritedSlotPriorities(priorities1);
+  port2.SetInheritedSlotPriorities(priorities2);
+  port_manager.PatchPort(&port, TEST_UNIVERSE);
+  port_manager.PatchPort(&port2, TEST_UNIVERSE);
+
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+  universe->SetMergeMode(Universe::MERGE_HTP);
+  TestMockOutputPort output_port(NULL, 1);
+  universe->AddPort(&output_port);
+
+  m_clock.CurrentTime(&time_stamp);
+  port.WriteDMX(buffer1);
+  port.DmxChanged();
+  port2.WriteDMX(buffer2);
+  port2.DmxChanged();
+  DmxBuffer expected;
+  expected.SetFromString("10,25,30,1");
+  OLA_ASSERT(expected == universe->GetDMX());
+  OLA_ASSERT_EQ(2u, output_port.WriteCount());
+
+  // The same data again doesn't change anything.
+  port2.DmxChanged();
+  OLA_ASSERT(expected == universe->GetDMX());
+  OLA_ASSERT_EQ(2u, output_port.WriteCount());
+
+  // Neither does a change to a slot the source doesn't win.
+  buffer2.SetFromString("5,25,2,1");
+  port2.WriteDMX(buffer2);
+  port2.DmxChanged();
+  OLA_ASSERT(expected == universe->GetDMX());
+  OLA_ASSERT_EQ(2u, output_port.WriteCount());
+
+  // Dropping a winning HTP value gives the slot to the next highest.
+  buffer2.SetFromString("5,15,2,0");
+  port2.WriteDMX(buffer2);
+  port2.DmxChanged();
+  expected.SetFromString("10,20,30,0");
+  OLA_ASSERT(expected == universe->GetDMX());
+  OLA_ASSERT_EQ(3u, output_port.WriteCount());
+  OLA_ASSERT(expected == output_port.ReadDMX());
+
+  // And raising it takes the slot back.
+  buffer2.SetFromString("50,15,2,0");
+  port2.WriteDMX(buffer2);
+  port2.DmxChanged();
+  expected.SetFromString("50,20,30,0");
+  OLA_ASSERT(expected == universe->GetDMX());
+  OLA_ASSERT_EQ(4u, output_port.WriteCount());
+
+  // In LTP mode the newest source wins the ties, even if its data is
+  // unchanged.
+  universe->SetMergeMode(Universe::MERGE_LTP);
+  time_stamp += ola::TimeInterval(0, 1000);
+  port.DmxChanged();
+  expected.SetFromString("10,20,30,0");
+  OLA_ASSERT(expected == universe->GetDMX());
+  time_stamp += ola::TimeInterval(0, 1000);
+  port2.DmxChanged();
+  expected.SetFromString("50,15,30,0");
+  OLA_ASSERT(expected == universe->GetDMX());
+  OLA_ASSERT_EQ(6u, output_port.WriteCount());
+
+  // Changing the priorities merges all the sources again.
+  priorities2.SetFromString("100,100,100,100");
+  port2.SetInheritedSlotPriorities(priorities2);
+  time_stamp += ola::TimeInterval(0, 1000);
+  port2.DmxChanged();
+  expected.SetFromString("50,15,2,0");
+  OLA_ASSERT(expected == universe->GetDMX());
+  OLA_ASSERT_EQ(7u, output_port.WriteCount());
+
+  // clean up
+  universe->RemovePort(&output_port);
+  universe->RemovePort(&port);
+  universe->RemovePort(&port2);
+  OLA_ASSERT_FALSE(universe->IsActive());
+}
+
+
 /**
  * Test RDM discovery for a universe/
  */
@@ -85,3 +85,34 @@ dist_bootfonts_DATA = \
     olad/www/new/libs/bootstrap/fonts/glyphicons-halflings-regular.woff2
 dist_bootcss_DATA = \
     olad/www/new/libs/bootstrap/css/bootstrap.min.css
+
+# Precompress the text files. The HTTP server sends foo.js.gz or foo.js.br
+# instead of foo.js to clients that accept those encodings. The files are
+# installed under www_datadir with the same layout as olad/www.
+www_installed_files = \
+    $(dist_www_DATA) $(dist_new_DATA) $(dist_views_DATA) $(dist_js_DATA) \
+    $(dist_css_DATA) $(dist_img_DATA) $(dist_jquery_DATA) \
+    $(dist_angularroute_DATA) $(dist_angular_DATA) $(dist_bootjs_DATA) \
+    $(dist_bootfonts_DATA) $(dist_bootcss_DATA)
+
+install-data-hook-www:
+	for file in $(www_installed_files); do \
+	  case "$$file" in \
+	    *.css|*.html|*.js|*.map|*.svg) ;; \
+	    *) continue ;; \
+	  esac; \
+	  path="$(DESTDIR)$(www_datadir)/$${file#olad/www/}"; \
+	  gzip -9 -n -c "$$path" > "$$path.gz" || exit 1; \
+	  if command -v brotli > /dev/null 2>&1; then \
+	    brotli -f -q 11 "$$path" || exit 1; \
+	  fi; \
+	done
+
+uninstall-hook-www:
+	for file in $(www_installed_files); do \
+	  path="$(DESTDIR)$(www_datadir)/$${file#olad/www/}"; \
+	  rm -f "$$path.gz" "$$path.br"; \
+	done
+
+INSTALL_DATA_HOOKS += install-data-hook-www
+UNINSTALL_HOOKS += uninstall-hook-www
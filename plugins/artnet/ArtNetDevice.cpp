@@ -57,18 +57,26 @@ using std::string;
 using std::vector;
 
 const char ArtNetDevice::K_ALWAYS_BROADCAST_KEY[] = "always_broadcast";
+const char ArtNetDevice::K_BATCH_RECEIVES_KEY[] = "batch_receives";
+const char ArtNetDevice::K_BATCH_SENDS_KEY[] = "batch_sends";
 const char ArtNetDevice::K_DEVICE_NAME[] = "ArtNet";
+const char ArtNetDevice::K_FULL_PORT_ADDRESS_KEY[] = "full_port_address";
 const char ArtNetDevice::K_IP_KEY[] = "ip";
 const char ArtNetDevice::K_LIMITED_BROADCAST_KEY[] = "use_limited_broadcast";
 const char ArtNetDevice::K_LONG_NAME_KEY[] = "long_name";
 const char ArtNetDevice::K_LOOPBACK_KEY[] = "use_loopback";
 const char ArtNetDevice::K_NET_KEY[] = "net";
 const char ArtNetDevice::K_OUTPUT_PORT_KEY[] = "output_ports";
+const char ArtNetDevice::K_RECEIVE_BUFFER_SIZE_KEY[] = "receive_buffer_size";
 const char ArtNetDevice::K_SHORT_NAME_KEY[] = "short_name";
 const char ArtNetDevice::K_SUBNET_KEY[] = "subnet";
+const char ArtNetDevice::K_SYNC_TIMEOUT_KEY[] = "sync_timeout_ms";
+const char ArtNetDevice::K_USE_ARTSYNC_KEY[] = "use_artsync";
 const unsigned int ArtNetDevice::K_ARTNET_NET = 0;
 const unsigned int ArtNetDevice::K_ARTNET_SUBNET = 0;
 const unsigned int ArtNetDevice::K_DEFAULT_OUTPUT_PORT_COUNT = 4;
+const unsigned int ArtNetDevice::K_DEFAULT_SYNC_TIMEOUT_MS = 50;
+const unsigned int ArtNetDevice::K_MAX_OUTPUT_PORT_COUNT = 1024;
 
 ArtNetDevice::ArtNetDevice(AbstractPlugin *owner,
                            ola::Preferences *preferences,
@@ -105,6 +113,12 @@ bool ArtNetDevice::StartHook() {
       K_ALWAYS_BROADCAST_KEY);
   node_options.use_limited_broadcast_address = m_preferences->GetValueAsBool(
       K_LIMITED_BROADCAST_KEY);
+  node_options.batch_sends = m_preferences->GetValueAsBool(K_BATCH_SENDS_KEY);
+  node_options.batch_receives = m_preferences->GetValueAsBool(
+      K_BATCH_RECEIVES_KEY);
+  node_options.receive_buffer_size = StringToIntOrDefault(
+      m_preferences->GetValue(K_RECEIVE_BUFFER_SIZE_KEY), 0);
+  node_options.export_map = m_plugin_adaptor->GetExportMap();
   // OLA Output ports are ArtNet input ports
   node_options.input_port_count = StringToIntOrDefault(
       m_preferences->GetValue(K_OUTPUT_PORT_KEY),
@@ -116,8 +130,19 @@ bool ArtNetDevice::StartHook() {
   m_node->SetShortName(m_preferences->GetValue(K_SHORT_NAME_KEY));
   m_node->SetLongName(m_preferences->GetValue(K_LONG_NAME_KEY));
 
+  if (m_preferences->GetValueAsBool(K_USE_ARTSYNC_KEY)) {
+    m_sync_group.reset(new OutputSyncGroup(
+        m_plugin_adaptor,
+        StringToIntOrDefault(m_preferences->GetValue(K_SYNC_TIMEOUT_KEY),
+                             K_DEFAULT_SYNC_TIMEOUT_MS),
+        NewCallback(this, &ArtNetDevice::SendSync)));
+  }
+
+  bool full_port_address = m_preferences->GetValueAsBool(
+      K_FULL_PORT_ADDRESS_KEY);
   for (unsigned int i = 0; i < node_options.input_port_count; i++) {
-    AddPort(new ArtNetOutputPort(this, i, m_node));
+    AddPort(new ArtNetOutputPort(this, i, m_node, full_port_address,
+                                 m_sync_group.get()));
   }
 
   for (unsigned int i = 0; i < ARTNET_MAX_PORTS; i++) {
@@ -126,6 +151,7 @@ bool ArtNetDevice::StartHook() {
 
   if (!m_node->Start()) {
     DeleteAllPorts();
+    m_sync_group.reset();
     delete m_node;
     m_node = NULL;
     return false;
@@ -150,10 +176,15 @@ void ArtNetDevice::PrePortStop() {
 }
 
 void ArtNetDevice::PostPortStop() {
+  m_sync_group.reset();
   delete m_node;
   m_node = NULL;
 }
 
+void ArtNetDevice::SendSync() {
+  m_node->SendSync();
+}
+
 void ArtNetDevice::Configure(RpcController *controller,
                              const string &request,
                              string *response,
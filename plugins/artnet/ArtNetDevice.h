@@ -31,9 +31,11 @@
 #ifndef PLUGINS_ARTNET_ARTNETDEVICE_H_
 #define PLUGINS_ARTNET_ARTNETDEVICE_H_
 
+#include <memory>
 #include <string>
 
 #include "olad/Device.h"
+#include "olad/OutputSyncGroup.h"
 #include "plugins/artnet/messages/ArtNetConfigMessages.pb.h"
 #include "plugins/artnet/ArtNetNode.h"
 
@@ -72,18 +74,26 @@ class ArtNetDevice: public Device {
                  ConfigureCallback *done);
 
   static const char K_ALWAYS_BROADCAST_KEY[];
+  static const char K_BATCH_RECEIVES_KEY[];
+  static const char K_BATCH_SENDS_KEY[];
   static const char K_DEVICE_NAME[];
+  static const char K_FULL_PORT_ADDRESS_KEY[];
   static const char K_IP_KEY[];
   static const char K_LIMITED_BROADCAST_KEY[];
   static const char K_LONG_NAME_KEY[];
   static const char K_LOOPBACK_KEY[];
   static const char K_NET_KEY[];
   static const char K_OUTPUT_PORT_KEY[];
+  static const char K_RECEIVE_BUFFER_SIZE_KEY[];
   static const char K_SHORT_NAME_KEY[];
   static const char K_SUBNET_KEY[];
+  static const char K_SYNC_TIMEOUT_KEY[];
+  static const char K_USE_ARTSYNC_KEY[];
   static const unsigned int K_ARTNET_NET;
   static const unsigned int K_ARTNET_SUBNET;
   static const unsigned int K_DEFAULT_OUTPUT_PORT_COUNT;
+  static const unsigned int K_DEFAULT_SYNC_TIMEOUT_MS;
+  static const unsigned int K_MAX_OUTPUT_PORT_COUNT;
   // 10s between polls when we're sending data, DMX-workshop uses 8s;
   static const unsigned int POLL_INTERVAL = 10000;
 
@@ -107,9 +117,15 @@ class ArtNetDevice: public Device {
  private:
   class Preferences *m_preferences;
   ArtNetNode *m_node;
+  std::auto_ptr<ola::OutputSyncGroup> m_sync_group;
   class PluginAdaptor *m_plugin_adaptor;
   ola::thread::timeout_id m_timeout_id;
 
+  /**
+   * Send an ArtSync after the synchronized ports have sent their frames.
+   */
+  void SendSync();
+
   /**
    * Handle an options request
    */
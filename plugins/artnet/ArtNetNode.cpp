@@ -75,6 +75,8 @@ using std::vector;
 
 
 const char ArtNetNodeImpl::ARTNET_ID[] = "Art-Net";
+const char ArtNetNodeImpl::RECEIVE_DROPS_VAR[] = "artnet-receive-drops";
+const char ArtNetNodeImpl::SEND_ERRORS_VAR[] = "artnet-send-errors";
 
 
 // UID to the IP Address it came from, and the number of times since we last
@@ -92,45 +94,61 @@ class ArtNetNodeImpl::InputPort {
         rdm_request_callback(NULL),
         pending_request(NULL),
         rdm_send_timeout(ola::thread::INVALID_TIMEOUT),
+        reply_index(0),
         m_port_address(0),
+        m_fixed_address(false),
         m_tod_callback(NULL) {
   }
   ~InputPort() {}
 
   // Returns true if the address changed.
   bool SetUniverseAddress(uint8_t universe_address) {
-    universe_address = universe_address & 0x0f;
-    if ((m_port_address & 0x0f) == universe_address)
-      return false;
-
-    m_port_address = ((m_port_address & 0xf0) | universe_address);
-    uids.clear();
-    subscribed_nodes.clear();
-    return true;
+    return UpdatePortAddress(
+        (m_port_address & 0x7ff0) | (universe_address & 0x0f));
   }
 
-  void ClearSubscribedNodes() {
-    subscribed_nodes.clear();
+  // Returns true if the address changed. This is ignored if the port was
+  // given a full port address with SetPortAddress().
+  bool SetSubNetAddress(uint8_t subnet_address) {
+    if (m_fixed_address)
+      return false;
+    return UpdatePortAddress(
+        (m_port_address & 0x7f0f) | ((subnet_address & 0x0f) << 4));
   }
 
-  // Returns true if the address changed.
-  bool SetSubNetAddress(uint8_t subnet_address) {
-    subnet_address = subnet_address << 4;
-    if (subnet_address == (m_port_address & 0xf0))
+  // Returns true if the address changed. This is ignored if the port was
+  // given a full port address with SetPortAddress().
+  bool SetNetAddress(uint8_t net_address) {
+    if (m_fixed_address)
       return false;
+    return UpdatePortAddress(
+        (m_port_address & 0x00ff) | ((net_address & 0x7f) << 8));
+  }
 
-    m_port_address = subnet_address | (m_port_address & 0x0f);
-    uids.clear();
-    subscribed_nodes.clear();
-    return true;
+  // Set the full 15 bit port address, from then on the node's net & sub-net
+  // addresses no longer apply to this port. Returns true if the address
+  // changed.
+  bool SetPortAddress(uint16_t port_address) {
+    m_fixed_address = true;
+    return UpdatePortAddress(port_address & 0x7fff);
   }
 
-  // The 8-bit port address, which is made up of the sub-net and universe
-  // address.
-  uint8_t PortAddress() const {
+  // The 15-bit port address, which is made up of the net, sub-net and
+  // universe address.
+  uint16_t PortAddress() const {
     return m_port_address;
   }
 
+  // The 8-bit universe address, which is made up of the sub-net and universe
+  // address.
+  uint8_t UniverseAddress() const {
+    return m_port_address & 0xff;
+  }
+
+  uint8_t NetAddress() const {
+    return m_port_address >> 8;
+  }
+
   void SetTodCallback(RDMDiscoveryCallback *callback) {
     m_tod_callback.reset(callback);
   }
@@ -155,7 +173,6 @@ class ArtNetNodeImpl::InputPort {
 
   bool enabled;
   uint8_t sequence_number;
-  map<IPV4Address, TimeStamp> subscribed_nodes;
   uid_map uids;  // used to keep track of the UIDs
   // NULL if discovery isn't running, otherwise the callback to run when it
   // finishes
@@ -172,12 +189,24 @@ class ArtNetNodeImpl::InputPort {
   // these control the sending of RDM requests.
   ola::thread::timeout_id rdm_send_timeout;
 
+  // The port's index within the ArtPollReply that describes it.
+  uint8_t reply_index;
+
  private:
-  uint8_t m_port_address;
+  uint16_t m_port_address;
+  bool m_fixed_address;
   // The callback to run if we receive an TOD and the discovery process
   // isn't running
   auto_ptr<RDMDiscoveryCallback> m_tod_callback;
 
+  bool UpdatePortAddress(uint16_t port_address) {
+    if (port_address == m_port_address)
+      return false;
+    m_port_address = port_address;
+    uids.clear();
+    return true;
+  }
+
   void RunRDMCallbackWithUIDs(const uid_map &uids,
                               RDMDiscoveryCallback *callback) {
     UIDSet uid_set;
@@ -202,15 +231,28 @@ ArtNetNodeImpl::ArtNetNodeImpl(const ola::network::Interface &iface,
       m_ss(ss),
       m_always_broadcast(options.always_broadcast),
       m_use_limited_broadcast_address(options.use_limited_broadcast_address),
+      m_batch_sends(options.batch_sends),
+      m_receive_buffer_size(options.receive_buffer_size),
+      m_export_map(options.export_map),
       m_in_configuration_mode(false),
       m_artpoll_required(false),
       m_artpollreply_required(false),
+      m_reply_pages_stale(true),
+      m_prune_timeout(ola::thread::INVALID_TIMEOUT),
       m_interface(iface),
-      m_socket(socket) {
+      m_socket(socket),
+      m_receive_packets(options.batch_receives ? RECEIVE_BATCH_SIZE : 1),
+      m_receive_datagrams(m_receive_packets.size()) {
 
   if (!m_socket.get())
     m_socket.reset(new UDPSocket());
 
+  for (unsigned int i = 0; i < m_receive_datagrams.size(); i++) {
+    m_receive_datagrams[i].data = reinterpret_cast<uint8_t*>(
+        &m_receive_packets[i]);
+    m_receive_datagrams[i].buffer_size = sizeof(m_receive_packets[i]);
+  }
+
   for (unsigned int i = 0; i < options.input_port_count; i++) {
     m_input_ports.push_back(new InputPort());
   }
@@ -251,6 +293,9 @@ bool ArtNetNodeImpl::Start() {
   if (m_running || !InitNetwork())
     return false;
 
+  m_prune_timeout = m_ss->RegisterRepeatingTimeout(
+      ROUTING_TABLE_PRUNE_INTERVAL_MS,
+      ola::NewCallback(this, &ArtNetNodeImpl::PruneRoutingTable));
   m_running = true;
   return true;
 }
@@ -290,6 +335,11 @@ bool ArtNetNodeImpl::Stop() {
     }
   }
 
+  if (m_prune_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_prune_timeout);
+    m_prune_timeout = ola::thread::INVALID_TIMEOUT;
+  }
+
   m_ss->RemoveReadDescriptor(m_socket.get());
 
   m_running = false;
@@ -345,12 +395,13 @@ bool ArtNetNodeImpl::SetNetAddress(uint8_t net_address) {
     return true;
 
   m_net_address = net_address;
+  m_reply_pages_stale = true;
 
   bool input_ports_enabled = false;
   vector<InputPort*>::iterator iter = m_input_ports.begin();
   for (; iter != m_input_ports.end(); ++iter) {
     input_ports_enabled |= (*iter)->enabled;
-    (*iter)->ClearSubscribedNodes();
+    (*iter)->SetNetAddress(net_address);
   }
 
   if (input_ports_enabled)
@@ -375,6 +426,7 @@ bool ArtNetNodeImpl::SetSubnetAddress(uint8_t subnet_address) {
   uint8_t old_address = m_output_ports[0].universe_address >> 4;
   if (old_address == subnet_address && !changed)
     return true;
+  m_reply_pages_stale = true;
 
   subnet_address = subnet_address << 4;
   for (unsigned int i = 0; i < ARTNET_MAX_PORTS; i++) {
@@ -385,11 +437,11 @@ bool ArtNetNodeImpl::SetSubnetAddress(uint8_t subnet_address) {
   return SendPollReplyIfRequired();
 }
 
-uint8_t ArtNetNodeImpl::InputPortCount() const {
+unsigned int ArtNetNodeImpl::InputPortCount() const {
   return m_input_ports.size();
 }
 
-bool ArtNetNodeImpl::SetInputPortUniverse(uint8_t port_id,
+bool ArtNetNodeImpl::SetInputPortUniverse(unsigned int port_id,
                                           uint8_t universe_id) {
   InputPort *port = GetInputPort(port_id);
   if (!port)
@@ -397,18 +449,39 @@ bool ArtNetNodeImpl::SetInputPortUniverse(uint8_t port_id,
 
   port->enabled = true;
   if (port->SetUniverseAddress(universe_id)) {
+    m_reply_pages_stale = true;
+    SendPollIfAllowed();
+    return SendPollReplyIfRequired();
+  }
+  return true;
+}
+
+bool ArtNetNodeImpl::SetInputPortAddress(unsigned int port_id,
+                                         uint16_t port_address) {
+  InputPort *port = GetInputPort(port_id);
+  if (!port)
+    return false;
+
+  port->enabled = true;
+  if (port->SetPortAddress(port_address)) {
+    m_reply_pages_stale = true;
     SendPollIfAllowed();
     return SendPollReplyIfRequired();
   }
   return true;
 }
 
-uint8_t ArtNetNodeImpl::GetInputPortUniverse(uint8_t port_id) const {
+uint8_t ArtNetNodeImpl::GetInputPortUniverse(unsigned int port_id) const {
+  const InputPort *port = GetInputPort(port_id);
+  return port ? port->UniverseAddress() : 0;
+}
+
+uint16_t ArtNetNodeImpl::GetInputPortAddress(unsigned int port_id) const {
   const InputPort *port = GetInputPort(port_id);
   return port ? port->PortAddress() : 0;
 }
 
-void ArtNetNodeImpl::DisableInputPort(uint8_t port_id) {
+void ArtNetNodeImpl::DisableInputPort(unsigned int port_id) {
   InputPort *port = GetInputPort(port_id);
   bool was_enabled = false;
   if (port) {
@@ -421,7 +494,7 @@ void ArtNetNodeImpl::DisableInputPort(uint8_t port_id) {
   }
 }
 
-bool ArtNetNodeImpl::InputPortState(uint8_t port_id) const {
+bool ArtNetNodeImpl::InputPortState(unsigned int port_id) const {
   const InputPort *port = GetInputPort(port_id);
   return port ? port->enabled : false;
 }
@@ -500,7 +573,7 @@ bool ArtNetNodeImpl::SendPoll() {
   return SendPacket(packet, size, m_interface.bcast_address);
 }
 
-bool ArtNetNodeImpl::SendDMX(uint8_t port_id, const DmxBuffer &buffer) {
+bool ArtNetNodeImpl::SendDMX(unsigned int port_id, const DmxBuffer &buffer) {
   InputPort *port = GetEnabledInputPort(port_id, "ArtDMX");
   if (!port)
     return false;
@@ -516,9 +589,12 @@ bool ArtNetNodeImpl::SendDMX(uint8_t port_id, const DmxBuffer &buffer) {
 
   packet.data.poll.version = HostToNetwork(ARTNET_VERSION);
   packet.data.dmx.sequence = port->sequence_number;
-  packet.data.dmx.physical = port_id;
-  packet.data.dmx.universe = port->PortAddress();
-  packet.data.dmx.net = m_net_address;
+  // physical is 8 bits, so use the port's index within the ArtPollReply that
+  // describes it.
+  UpdateReplyPages();
+  packet.data.dmx.physical = port->reply_index;
+  packet.data.dmx.universe = port->UniverseAddress();
+  packet.data.dmx.net = port->NetAddress();
 
   unsigned int buffer_size = buffer.Size();
   buffer.Get(packet.data.dmx.data, &buffer_size);
@@ -533,8 +609,11 @@ bool ArtNetNodeImpl::SendDMX(uint8_t port_id, const DmxBuffer &buffer) {
 
   unsigned int size = sizeof(packet.data.dmx) - DMX_UNIVERSE_SIZE + buffer_size;
 
+  // The packet is built once, and then sent to each of the nodes in the
+  // routing table. Inactive nodes are removed by PruneRoutingTable().
   bool sent_ok = false;
-  if (port->subscribed_nodes.size() >= m_broadcast_threshold ||
+  const SubscriberMap *subscribers = Subscribers(port->PortAddress());
+  if ((subscribers && subscribers->size() >= m_broadcast_threshold) ||
       m_always_broadcast) {
     sent_ok = SendPacket(
         packet,
@@ -543,29 +622,18 @@ bool ArtNetNodeImpl::SendDMX(uint8_t port_id, const DmxBuffer &buffer) {
         IPV4Address::Broadcast() :
         m_interface.bcast_address);
     port->sequence_number++;
-  } else {
-    map<IPV4Address, TimeStamp>::iterator iter = port->subscribed_nodes.begin();
-    TimeStamp last_heard_threshold = (
-        *m_ss->WakeUpTime() - TimeInterval(NODE_TIMEOUT, 0));
-    while (iter != port->subscribed_nodes.end()) {
-      // if this node has timed out, remove it from the set
-      if (iter->second < last_heard_threshold) {
-        port->subscribed_nodes.erase(iter++);
-        continue;
-      }
+  } else if (subscribers) {
+    SubscriberMap::const_iterator iter = subscribers->begin();
+    for (; iter != subscribers->end(); ++iter) {
       sent_ok |= SendPacket(packet, size, iter->first);
-      ++iter;
-    }
-
-    if (port->subscribed_nodes.empty()) {
-      OLA_DEBUG <<
-        "Suppressing data transmit due to no active nodes for universe " <<
-        static_cast<int>(port->PortAddress());
-      sent_ok = true;
-    } else {
-      // We sent at least one packet, increment the sequence number
-      port->sequence_number++;
     }
+    // We sent at least one packet, increment the sequence number
+    port->sequence_number++;
+  } else {
+    OLA_DEBUG <<
+      "Suppressing data transmit due to no active nodes for universe " <<
+      port->PortAddress();
+    sent_ok = true;
   }
 
   if (!sent_ok)
@@ -573,7 +641,7 @@ bool ArtNetNodeImpl::SendDMX(uint8_t port_id, const DmxBuffer &buffer) {
   return sent_ok;
 }
 
-void ArtNetNodeImpl::RunFullDiscovery(uint8_t port_id,
+void ArtNetNodeImpl::RunFullDiscovery(unsigned int port_id,
                                       RDMDiscoveryCallback *callback) {
   InputPort *port = GetEnabledInputPort(port_id, "ArtTodControl");
   if (!port) {
@@ -590,16 +658,16 @@ void ArtNetNodeImpl::RunFullDiscovery(uint8_t port_id,
   PopulatePacketHeader(&packet, ARTNET_TODCONTROL);
   memset(&packet.data.tod_control, 0, sizeof(packet.data.tod_control));
   packet.data.tod_control.version = HostToNetwork(ARTNET_VERSION);
-  packet.data.tod_control.net = m_net_address;
+  packet.data.tod_control.net = port->NetAddress();
   packet.data.tod_control.command = TOD_FLUSH_COMMAND;
-  packet.data.tod_control.address = port->PortAddress();
+  packet.data.tod_control.address = port->UniverseAddress();
   unsigned int size = sizeof(packet.data.tod_control);
   if (!SendPacket(packet, size, m_interface.bcast_address))
     port->RunDiscoveryCallback();
 }
 
 void ArtNetNodeImpl::RunIncrementalDiscovery(
-    uint8_t port_id,
+    unsigned int port_id,
     RDMDiscoveryCallback *callback) {
   InputPort *port = GetEnabledInputPort(port_id, "ArtTodRequest");
   if (!port) {
@@ -611,21 +679,20 @@ void ArtNetNodeImpl::RunIncrementalDiscovery(
   if (!StartDiscoveryProcess(port, callback))
     return;
 
-  OLA_DEBUG << "Sending ArtTodRequest for address "
-            << static_cast<int>(port->PortAddress());
+  OLA_DEBUG << "Sending ArtTodRequest for address " << port->PortAddress();
   artnet_packet packet;
   PopulatePacketHeader(&packet, ARTNET_TODREQUEST);
   memset(&packet.data.tod_request, 0, sizeof(packet.data.tod_request));
   packet.data.tod_request.version = HostToNetwork(ARTNET_VERSION);
-  packet.data.tod_request.net = m_net_address;
+  packet.data.tod_request.net = port->NetAddress();
   packet.data.tod_request.address_count = 1;  // only one universe address
-  packet.data.tod_request.addresses[0] = port->PortAddress();
+  packet.data.tod_request.addresses[0] = port->UniverseAddress();
   unsigned int size = sizeof(packet.data.tod_request);
   if (!SendPacket(packet, size, m_interface.bcast_address))
     port->RunDiscoveryCallback();
 }
 
-void ArtNetNodeImpl::SendRDMRequest(uint8_t port_id,
+void ArtNetNodeImpl::SendRDMRequest(unsigned int port_id,
                                     RDMRequest *request_ptr,
                                     RDMCallback *on_complete) {
   auto_ptr<RDMRequest> request(request_ptr);
@@ -679,7 +746,7 @@ void ArtNetNodeImpl::SendRDMRequest(uint8_t port_id,
 }
 
 bool ArtNetNodeImpl::SetUnsolicitedUIDSetHandler(
-    uint8_t port_id,
+    unsigned int port_id,
     ola::Callback1<void, const ola::rdm::UIDSet&> *tod_callback) {
   InputPort *port = GetInputPort(port_id);
   if (port)
@@ -688,17 +755,20 @@ bool ArtNetNodeImpl::SetUnsolicitedUIDSetHandler(
 }
 
 void ArtNetNodeImpl::GetSubscribedNodes(
-    uint8_t port_id,
+    unsigned int port_id,
     vector<IPV4Address> *node_addresses) {
   InputPort *port = GetInputPort(port_id);
   if (!port)
     return;
 
-  map<IPV4Address, TimeStamp> &subscribed_nodes = port->subscribed_nodes;
-  map<IPV4Address, TimeStamp>::const_iterator iter = subscribed_nodes.begin();
-  for (; iter != subscribed_nodes.end(); ++iter) {
-    TimeStamp last_heard_threshold = (
-        *m_ss->WakeUpTime() - TimeInterval(NODE_TIMEOUT, 0));
+  const SubscriberMap *subscribers = Subscribers(port->PortAddress());
+  if (!subscribers)
+    return;
+
+  TimeStamp last_heard_threshold = (
+      *m_ss->WakeUpTime() - TimeInterval(NODE_TIMEOUT, 0));
+  SubscriberMap::const_iterator iter = subscribers->begin();
+  for (; iter != subscribers->end(); ++iter) {
     if (iter->second >= last_heard_threshold) {
       node_addresses->push_back(iter->first);
     }
@@ -809,17 +879,37 @@ bool ArtNetNodeImpl::SendTimeCode(const ola::timecode::TimeCode &timecode) {
   return true;
 }
 
-void ArtNetNodeImpl::SocketReady() {
+bool ArtNetNodeImpl::SendSync() {
   artnet_packet packet;
-  ssize_t packet_size = sizeof(packet);
-  ola::network::IPV4SocketAddress source;
-
-  if (!m_socket->RecvFrom(reinterpret_cast<uint8_t*>(&packet),
-                          &packet_size,
-                          &source))
-    return;
+  PopulatePacketHeader(&packet, ARTNET_SYNC);
+  memset(&packet.data.sync, 0, sizeof(packet.data.sync));
+  packet.data.sync.version = HostToNetwork(ARTNET_VERSION);
+
+  // Use the same broadcast address as the DMX data.
+  bool sent_ok = SendPacket(
+      packet,
+      sizeof(packet.data.sync),
+      m_use_limited_broadcast_address ?
+      IPV4Address::Broadcast() :
+      m_interface.bcast_address);
+  // Don't leave the group waiting for the next loop iteration.
+  if (!m_socket->FlushSendBatch()) {
+    OLA_INFO << "Failed to send some of the queued ArtDmx packets";
+    sent_ok = false;
+  }
+  if (!sent_ok) {
+    OLA_INFO << "Failed to send ArtSync";
+  }
+  return sent_ok;
+}
 
-  HandlePacket(source.Host(), packet, packet_size);
+void ArtNetNodeImpl::SocketReady() {
+  unsigned int received = m_socket->RecvBatch(&m_receive_datagrams[0],
+                                               m_receive_datagrams.size());
+  for (unsigned int i = 0; i < received; i++) {
+    HandlePacket(m_receive_datagrams[i].source.Host(), m_receive_packets[i],
+                 m_receive_datagrams[i].size);
+  }
 }
 
 bool ArtNetNodeImpl::SendPollIfAllowed() {
@@ -853,8 +943,6 @@ bool ArtNetNodeImpl::SendPollReply(const IPV4Address &destination) {
 
   m_interface.ip_address.Get(packet.data.reply.ip);
   packet.data.reply.port = HostToLittleEndian(ARTNET_PORT);
-  packet.data.reply.net_address = m_net_address;
-  packet.data.reply.subnet_address = m_output_ports[0].universe_address >> 4;
   packet.data.reply.oem = HostToNetwork(OEM_CODE);
   packet.data.reply.status1 = 0xd2;  // normal indicators, rdm enabled
   packet.data.reply.esta_id = HostToLittleEndian(OPEN_LIGHTING_ESTA_CODE);
@@ -867,29 +955,94 @@ bool ArtNetNodeImpl::SendPollReply(const IPV4Address &destination) {
   str << "#0001 [" << m_unsolicited_replies << "] OLA";
   CopyToFixedLengthBuffer(str.str(), packet.data.reply.node_report,
                           arraysize(packet.data.reply.node_report));
-  packet.data.reply.number_ports[1] = ARTNET_MAX_PORTS;
-  for (unsigned int i = 0; i < ARTNET_MAX_PORTS; i++) {
-    InputPort *iport = GetInputPort(i, false);
-    packet.data.reply.port_types[i] = iport ? 0xc0 : 0x80;
-    packet.data.reply.good_input[i] = iport && iport->enabled ? 0x0 : 0x8;
-    packet.data.reply.sw_in[i] = iport ? iport->PortAddress() : 0;
-
-    packet.data.reply.good_output[i] = (
-        (m_output_ports[i].enabled ? 0x80 : 0x00) |
-        (m_output_ports[i].merge_mode == ARTNET_MERGE_LTP ? 0x2 : 0x0) |
-        (m_output_ports[i].is_merging ? 0x8 : 0x0));
-    packet.data.reply.sw_out[i] = m_output_ports[i].universe_address;
-  }
   packet.data.reply.style = NODE_CODE;
   m_interface.hw_address.Get(packet.data.reply.mac);
   m_interface.ip_address.Get(packet.data.reply.bind_ip);
   // maybe set status2 here if the web UI is enabled
   packet.data.reply.status2 = 0x08;  // node supports 15 bit port addresses
-  if (!SendPacket(packet, sizeof(packet.data.reply), destination)) {
-    OLA_INFO << "Failed to send ArtPollReply";
-    return false;
+
+  UpdateReplyPages();
+  const unsigned int page_count = m_reply_pages.size();
+  bool ok = true;
+  for (unsigned int page = 0; page < page_count; page++) {
+    const ReplyPage &reply_page = m_reply_pages[page];
+    packet.data.reply.bind_index = page_count == 1 ? 0 : page + 1;
+    packet.data.reply.net_address = reply_page.net_address;
+    packet.data.reply.subnet_address = reply_page.subnet_address;
+
+    for (unsigned int i = 0; i < ARTNET_MAX_PORTS; i++) {
+      InputPort *iport = (
+          i < reply_page.ports.size() ? reply_page.ports[i] : NULL);
+      packet.data.reply.good_input[i] = iport && iport->enabled ? 0x0 : 0x8;
+      packet.data.reply.sw_in[i] = iport ? iport->UniverseAddress() : 0;
+
+      if (page == 0) {
+        packet.data.reply.port_types[i] = iport ? 0xc0 : 0x80;
+        packet.data.reply.good_output[i] = (
+            (m_output_ports[i].enabled ? 0x80 : 0x00) |
+            (m_output_ports[i].merge_mode == ARTNET_MERGE_LTP ? 0x2 : 0x0) |
+            (m_output_ports[i].is_merging ? 0x8 : 0x0));
+        packet.data.reply.sw_out[i] = m_output_ports[i].universe_address;
+      } else {
+        // later pages only carry input ports
+        packet.data.reply.port_types[i] = iport ? 0x40 : 0x00;
+        packet.data.reply.good_output[i] = 0;
+        packet.data.reply.sw_out[i] = 0;
+      }
+    }
+    packet.data.reply.number_ports[1] = page == 0 ?
+        static_cast<uint8_t>(ARTNET_MAX_PORTS) :
+        static_cast<uint8_t>(reply_page.ports.size());
+
+    if (!SendPacket(packet, sizeof(packet.data.reply), destination)) {
+      OLA_INFO << "Failed to send ArtPollReply";
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+void ArtNetNodeImpl::UpdateReplyPages() {
+  if (!m_reply_pages_stale)
+    return;
+  m_reply_pages_stale = false;
+
+  // Group the ports by net & sub-net, keeping them in port id order.
+  map<uint16_t, vector<InputPort*> > groups;
+  InputPorts::iterator port_iter = m_input_ports.begin();
+  for (; port_iter != m_input_ports.end(); ++port_iter) {
+    groups[(*port_iter)->PortAddress() >> 4].push_back(*port_iter);
+  }
+
+  // The output ports are on the first page, so their net & sub-net goes
+  // first.
+  const uint16_t output_group = (
+      (m_net_address << 4) | (m_output_ports[0].universe_address >> 4));
+  vector<uint16_t> order;
+  order.push_back(output_group);
+  map<uint16_t, vector<InputPort*> >::const_iterator group_iter;
+  for (group_iter = groups.begin(); group_iter != groups.end();
+       ++group_iter) {
+    if (group_iter->first != output_group)
+      order.push_back(group_iter->first);
+  }
+
+  m_reply_pages.clear();
+  vector<uint16_t>::const_iterator order_iter = order.begin();
+  for (; order_iter != order.end(); ++order_iter) {
+    const vector<InputPort*> &ports = groups[*order_iter];
+    unsigned int i = 0;
+    do {
+      ReplyPage page;
+      page.net_address = *order_iter >> 4;
+      page.subnet_address = *order_iter & 0x0f;
+      for (; i < ports.size() && page.ports.size() < ARTNET_MAX_PORTS; i++) {
+        ports[i]->reply_index = page.ports.size();
+        page.ports.push_back(ports[i]);
+      }
+      m_reply_pages.push_back(page);
+    } while (i < ports.size());
   }
-  return true;
 }
 
 bool ArtNetNodeImpl::SendIPReply(const IPV4Address &destination) {
@@ -966,6 +1119,9 @@ void ArtNetNodeImpl::HandlePacket(const IPV4Address &source_address,
     case ARTNET_TIME_CODE:
       // Not implemented
       break;
+    case ARTNET_SYNC:
+      // We don't hold the data from input ports, so there's nothing to do.
+      break;
     default:
       OLA_INFO << "ArtNet got unknown packet " << std::hex
                << LittleEndianToHost(packet.op_code);
@@ -1005,28 +1161,18 @@ void ArtNetNodeImpl::HandleReplyPacket(const IPV4Address &source_address,
                        minimum_reply_size))
     return;
 
-  if (packet.net_address != m_net_address) {
-    OLA_DEBUG << "Received ArtPollReply for net "
-              << static_cast<int>(packet.net_address)
-              << " which doesn't match our net address "
-              << static_cast<int>(m_net_address) << ", discarding";
-    return;
-  }
-
-  // Update the subscribed nodes list
+  // Update the routing table. Nodes with more than ARTNET_MAX_PORTS ports
+  // send one ArtPollReply for each group of ports, so we see them all.
   unsigned int port_limit = std::min((uint8_t) ARTNET_MAX_PORTS,
                                      packet.number_ports[1]);
   for (unsigned int i = 0; i < port_limit; i++) {
     if (packet.port_types[i] & 0x80) {
-      // port is of type output
-      uint8_t universe_id = packet.sw_out[i];
-      InputPorts::iterator iter = m_input_ports.begin();
-      for (; iter != m_input_ports.end(); ++iter) {
-        if ((*iter)->enabled && (*iter)->PortAddress() == universe_id) {
-          STLReplace(&(*iter)->subscribed_nodes, source_address,
-                     *m_ss->WakeUpTime());
-        }
-      }
+      // port is of type output, the low nibble of sw_out is the universe
+      uint16_t port_address = ((packet.net_address & 0x7f) << 8) |
+                              ((packet.subnet_address & 0x0f) << 4) |
+                              (packet.sw_out[i] & 0x0f);
+      STLReplace(&m_routing_table[port_address], source_address,
+                 *m_ss->WakeUpTime());
     }
   }
 }
@@ -1135,22 +1281,16 @@ void ArtNetNodeImpl::HandleTodData(const IPV4Address &source_address,
     return;
   }
 
-  if (packet.net != m_net_address) {
-    OLA_DEBUG << "Received ArtTodData for net " << static_cast<int>(packet.net)
-              << " which doesn't match our net address "
-              << static_cast<int>(m_net_address) << ", discarding";
-    return;
-  }
-
   if (packet.command_response) {
     OLA_WARN << "Command response 0x" << std::hex << packet.command_response
              << " != 0x0";
     return;
   }
 
+  uint16_t port_address = ((packet.net & 0x7f) << 8) | packet.address;
   InputPorts::iterator iter = m_input_ports.begin();
   for (; iter != m_input_ports.end(); ++iter) {
-    if ((*iter)->enabled && (*iter)->PortAddress() == packet.address) {
+    if ((*iter)->enabled && (*iter)->PortAddress() == port_address) {
       UpdatePortFromTodPacket(*iter, source_address, packet, packet_size);
     }
   }
@@ -1207,20 +1347,15 @@ void ArtNetNodeImpl::HandleRdm(const IPV4Address &source_address,
     return;
   }
 
-  if (packet.net != m_net_address) {
-    OLA_DEBUG << "Received ArtRDM for net " << static_cast<int>(packet.net)
-              << " which doesn't match our net address "
-              << static_cast<int>(m_net_address) << ", discarding";
-    return;
-  }
-
   unsigned int rdm_length = packet_size - header_size;
   if (!rdm_length)
     return;
 
   // look for the port that this was sent to, once we know the port we can try
-  // to parse the message
-  for (uint8_t port_id = 0; port_id < ARTNET_MAX_PORTS; port_id++) {
+  // to parse the message. Output ports use the node's net address.
+  for (uint8_t port_id = 0;
+       packet.net == m_net_address && port_id < ARTNET_MAX_PORTS;
+       port_id++) {
     if (m_output_ports[port_id].enabled &&
         m_output_ports[port_id].universe_address == packet.address &&
         m_output_ports[port_id].on_rdm_request) {
@@ -1242,9 +1377,10 @@ void ArtNetNodeImpl::HandleRdm(const IPV4Address &source_address,
   // The ArtNet packet does not include the RDM start code. Prepend that.
   RDMFrame rdm_response(packet.data, rdm_length, RDMFrame::Options(true));
 
+  uint16_t port_address = ((packet.net & 0x7f) << 8) | packet.address;
   InputPorts::iterator iter = m_input_ports.begin();
   for (; iter != m_input_ports.end(); ++iter) {
-    if ((*iter)->enabled && (*iter)->PortAddress() == packet.address) {
+    if ((*iter)->enabled && (*iter)->PortAddress() == port_address) {
       HandleRDMResponse(*iter, rdm_response, source_address);
     }
   }
@@ -1262,7 +1398,8 @@ void ArtNetNodeImpl::RDMRequestCompletion(
   if (port->universe_address == universe_address) {
     if (reply->StatusCode() == ola::rdm::RDM_COMPLETED_OK) {
       // TODO(simon): handle fragmenation here
-      SendRDMCommand(*reply->Response(), destination, universe_address);
+      SendRDMCommand(*reply->Response(), destination,
+                     (m_net_address << 8) | universe_address);
     } else if (reply->StatusCode() == ola::rdm::RDM_UNKNOWN_UID) {
       // call the on discovery handler, which will send a new TOD and
       // hopefully update the remote controller
@@ -1403,14 +1540,14 @@ void ArtNetNodeImpl::TimeoutRDMRequest(InputPort *port) {
 
 bool ArtNetNodeImpl::SendRDMCommand(const RDMCommand &command,
                                     const IPV4Address &destination,
-                                    uint8_t universe) {
+                                    uint16_t port_address) {
   artnet_packet packet;
   PopulatePacketHeader(&packet, ARTNET_RDM);
   memset(&packet.data.rdm, 0, sizeof(packet.data.rdm));
   packet.data.rdm.version = HostToNetwork(ARTNET_VERSION);
   packet.data.rdm.rdm_version = RDM_VERSION;
-  packet.data.rdm.net = m_net_address;
-  packet.data.rdm.address = universe;
+  packet.data.rdm.net = port_address >> 8;
+  packet.data.rdm.address = port_address & 0xff;
   unsigned int rdm_size = ARTNET_MAX_RDM_DATA;
   if (!RDMCommandSerializer::Pack(command, packet.data.rdm.data, &rdm_size)) {
     OLA_WARN << "Failed to construct RDM command";
@@ -1518,7 +1655,7 @@ bool ArtNetNodeImpl::CheckPacketSize(const IPV4Address &source_address,
   return true;
 }
 
-ArtNetNodeImpl::InputPort *ArtNetNodeImpl::GetInputPort(uint8_t port_id,
+ArtNetNodeImpl::InputPort *ArtNetNodeImpl::GetInputPort(unsigned int port_id,
                                                         bool warn) {
   if (port_id >= m_input_ports.size()) {
     if (warn) {
@@ -1531,7 +1668,7 @@ ArtNetNodeImpl::InputPort *ArtNetNodeImpl::GetInputPort(uint8_t port_id,
 }
 
 const ArtNetNodeImpl::InputPort *ArtNetNodeImpl::GetInputPort(
-    uint8_t port_id) const {
+    unsigned int port_id) const {
   if (port_id >= m_input_ports.size()) {
     OLA_WARN << "Port index of out bounds: " <<
       static_cast<int>(port_id) << " >= " << m_input_ports.size();
@@ -1541,7 +1678,7 @@ const ArtNetNodeImpl::InputPort *ArtNetNodeImpl::GetInputPort(
 }
 
 ArtNetNodeImpl::InputPort *ArtNetNodeImpl::GetEnabledInputPort(
-    uint8_t port_id,
+    unsigned int port_id,
     const string &action) {
   if (!m_running)
     return NULL;
@@ -1553,6 +1690,43 @@ ArtNetNodeImpl::InputPort *ArtNetNodeImpl::GetEnabledInputPort(
   return ok ? port : NULL;
 }
 
+/*
+ * Remove nodes we haven't heard from in NODE_TIMEOUT seconds from the routing
+ * table.
+ */
+bool ArtNetNodeImpl::PruneRoutingTable() {
+  TimeStamp last_heard_threshold = (
+      *m_ss->WakeUpTime() - TimeInterval(NODE_TIMEOUT, 0));
+
+  RoutingTable::iterator iter = m_routing_table.begin();
+  while (iter != m_routing_table.end()) {
+    SubscriberMap::iterator node_iter = iter->second.begin();
+    while (node_iter != iter->second.end()) {
+      if (node_iter->second < last_heard_threshold) {
+        iter->second.erase(node_iter++);
+      } else {
+        ++node_iter;
+      }
+    }
+
+    if (iter->second.empty()) {
+      m_routing_table.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+  return true;
+}
+
+const ArtNetNodeImpl::SubscriberMap *ArtNetNodeImpl::Subscribers(
+    uint16_t port_address) const {
+  RoutingTable::const_iterator iter = m_routing_table.find(port_address);
+  if (iter == m_routing_table.end() || iter->second.empty()) {
+    return NULL;
+  }
+  return &iter->second;
+}
+
 ArtNetNodeImpl::OutputPort *ArtNetNodeImpl::GetOutputPort(uint8_t port_id) {
   if (port_id >= ARTNET_MAX_PORTS) {
     OLA_WARN << "Port index of out bounds: " <<
@@ -1601,6 +1775,26 @@ bool ArtNetNodeImpl::InitNetwork() {
     return false;
   }
 
+  if (m_export_map) {
+    m_socket->EnableSendErrorCounting(
+        m_export_map->GetUIntMapVar(SEND_ERRORS_VAR, "interface"),
+        m_interface.ip_address.ToString());
+  }
+
+  if (m_batch_sends && !m_socket->EnableSendBatching(m_ss)) {
+    OLA_INFO << "Send batching isn't supported, sending packets one by one";
+  }
+
+  if (m_receive_buffer_size) {
+    m_socket->SetReceiveBufferSize(m_receive_buffer_size);
+  }
+
+  if (m_export_map) {
+    m_socket->EnableDropCounting(
+        m_export_map->GetUIntMapVar(RECEIVE_DROPS_VAR, "interface"),
+        m_interface.ip_address.ToString());
+  }
+
   m_socket->SetOnData(NewCallback(this, &ArtNetNodeImpl::SocketReady));
   m_ss->AddReadDescriptor(m_socket.get());
   return true;
@@ -1689,10 +1883,12 @@ bool ArtNetNodeImpl::StartDiscoveryProcess(InputPort *port,
   // these nodes. If ArtTod packets arrive after discovery completes, we'll
   // call the unsolicited handler
   port->discovery_node_set.clear();
-  map<IPV4Address, TimeStamp>::const_iterator node_iter =
-      port->subscribed_nodes.begin();
-  for (; node_iter != port->subscribed_nodes.end(); node_iter++)
-    port->discovery_node_set.insert(node_iter->first);
+  const SubscriberMap *subscribers = Subscribers(port->PortAddress());
+  if (subscribers) {
+    SubscriberMap::const_iterator node_iter = subscribers->begin();
+    for (; node_iter != subscribers->end(); node_iter++)
+      port->discovery_node_set.insert(node_iter->first);
+  }
 
   port->discovery_timeout = m_ss->RegisterSingleTimeout(
       RDM_TOD_TIMEOUT_MS,
@@ -1739,7 +1935,7 @@ ArtNetNode::~ArtNetNode() {
   STLDeleteElements(&m_wrappers);
 }
 
-void ArtNetNode::RunFullDiscovery(uint8_t port_id,
+void ArtNetNode::RunFullDiscovery(unsigned int port_id,
                                   RDMDiscoveryCallback *callback) {
   if (!CheckInputPortId(port_id)) {
     ola::rdm::UIDSet uids;
@@ -1749,7 +1945,7 @@ void ArtNetNode::RunFullDiscovery(uint8_t port_id,
   }
 }
 
-void ArtNetNode::RunIncrementalDiscovery(uint8_t port_id,
+void ArtNetNode::RunIncrementalDiscovery(unsigned int port_id,
                                          RDMDiscoveryCallback *callback) {
   if (!CheckInputPortId(port_id)) {
     ola::rdm::UIDSet uids;
@@ -1759,7 +1955,7 @@ void ArtNetNode::RunIncrementalDiscovery(uint8_t port_id,
   }
 }
 
-void ArtNetNode::SendRDMRequest(uint8_t port_id, RDMRequest *request,
+void ArtNetNode::SendRDMRequest(unsigned int port_id, RDMRequest *request,
                                 RDMCallback *on_complete) {
   if (!CheckInputPortId(port_id)) {
   RunRDMCallback(on_complete, ola::rdm::RDM_FAILED_TO_SEND);
@@ -1769,7 +1965,7 @@ void ArtNetNode::SendRDMRequest(uint8_t port_id, RDMRequest *request,
   }
 }
 
-bool ArtNetNode::CheckInputPortId(uint8_t port_id) {
+bool ArtNetNode::CheckInputPortId(unsigned int port_id) {
   if (port_id >= m_controllers.size()) {
     OLA_WARN << "Port index of out bounds: " << static_cast<int>(port_id)
              << " >= " << m_controllers.size();
@@ -30,6 +30,7 @@
 #include "ola/Callback.h"
 #include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/Interface.h"
 #include "ola/io/SelectServerInterface.h"
@@ -69,14 +70,24 @@ class ArtNetNodeOptions {
         use_limited_broadcast_address(false),
         rdm_queue_size(20),
         broadcast_threshold(30),
-        input_port_count(4) {
+        input_port_count(4),
+        batch_sends(false),
+        batch_receives(false),
+        receive_buffer_size(0),
+        export_map(NULL) {
   }
 
   bool always_broadcast;
   bool use_limited_broadcast_address;
   unsigned int rdm_queue_size;
   unsigned int broadcast_threshold;
-  uint8_t input_port_count;
+  // The number of ports that send ArtNet data, this isn't limited to
+  // ARTNET_MAX_PORTS.
+  unsigned int input_port_count;
+  bool batch_sends;
+  bool batch_receives;
+  unsigned int receive_buffer_size;
+  ola::ExportMap *export_map;
 };
 
 
@@ -170,36 +181,54 @@ class ArtNetNodeImpl {
    * Get the number of input ports
    * @returns the number of input ports
    */
-  uint8_t InputPortCount() const;
+  unsigned int InputPortCount() const;
 
   /**
    * Set the universe address of an input port
    */
-  bool SetInputPortUniverse(uint8_t port_id, uint8_t universe_id);
+  bool SetInputPortUniverse(unsigned int port_id, uint8_t universe_id);
+
+  /**
+   * @brief Set the full 15 bit port address of an input port.
+   *
+   * Once this is called, changes to the node's net & sub-net addresses no
+   * longer apply to the port. This allows a single node to send to any
+   * number of universes across different nets, as in ArtNet 4.
+   * @param port_id a port id between 0 and InputPortCount() - 1
+   * @param port_address the 15 bit port address.
+   */
+  bool SetInputPortAddress(unsigned int port_id, uint16_t port_address);
 
   /**
    * @brief Get an input port universe address
    *
    * Return the 8bit universe address for a port. This does not include the
    * ArtNet III net-address.
-   * @param port_id a port id between 0 and ARTNET_MAX_PORTS - 1
+   * @param port_id a port id between 0 and InputPortCount() - 1
    * @return The universe address for the port. Invalid port_ids return 0.
    */
-  uint8_t GetInputPortUniverse(uint8_t port_id) const;
+  uint8_t GetInputPortUniverse(unsigned int port_id) const;
+
+  /**
+   * @brief Get the 15 bit port address of an input port.
+   * @param port_id a port id between 0 and InputPortCount() - 1
+   * @return The port address for the port. Invalid port_ids return 0.
+   */
+  uint16_t GetInputPortAddress(unsigned int port_id) const;
 
   /**
    * @brief Disable an input port.
-   * @param port_id a port id between 0 and ARTNET_MAX_PORTS - 1
+   * @param port_id a port id between 0 and InputPortCount() - 1
    */
-  void DisableInputPort(uint8_t port_id);
+  void DisableInputPort(unsigned int port_id);
 
   /**
    * @brief Check the state of an input port
-   * @param port_id a port id between 0 and ARTNET_MAX_PORTS - 1
+   * @param port_id a port id between 0 and InputPortCount() - 1
    * @return the state (enabled or disabled) of an input port. An invalid
    * port_id returns false.
    */
-  bool InputPortState(uint8_t port_id) const;
+  bool InputPortState(unsigned int port_id) const;
 
   /**
    * @brief Set the universe for an output port.
@@ -254,7 +283,7 @@ class ArtNetNodeImpl {
    * @param buffer the DMX data
    * @return true if it was send successfully, false otherwise
    */
-  bool SendDMX(uint8_t port_id, const ola::DmxBuffer &buffer);
+  bool SendDMX(unsigned int port_id, const ola::DmxBuffer &buffer);
 
   /**
    * @brief Flush the TOD and force a full discovery.
@@ -264,7 +293,7 @@ class ArtNetNodeImpl {
    * @param port_id port to discover on
    * @param callback the RDMDiscoveryCallback to run when discovery completes
    */
-  void RunFullDiscovery(uint8_t port_id,
+  void RunFullDiscovery(unsigned int port_id,
                         ola::rdm::RDMDiscoveryCallback *callback);
 
   /**
@@ -276,7 +305,7 @@ class ArtNetNodeImpl {
    * @param port_id port to send on
    * @param callback the RDMDiscoveryCallback to run when discovery completes
    */
-  void RunIncrementalDiscovery(uint8_t port_id,
+  void RunIncrementalDiscovery(unsigned int port_id,
                                ola::rdm::RDMDiscoveryCallback *callback);
 
   /**
@@ -291,7 +320,7 @@ class ArtNetNodeImpl {
    * Because this is wrapped in the QueueingRDMController this will only be
    * called one-at-a-time (per port)
    */
-  void SendRDMRequest(uint8_t port_id,
+  void SendRDMRequest(unsigned int port_id,
                       ola::rdm::RDMRequest *request,
                       ola::rdm::RDMCallback *on_complete);
 
@@ -302,7 +331,7 @@ class ArtNetNodeImpl {
    * received, and the RDM process isn't running.
    */
   bool SetUnsolicitedUIDSetHandler(
-      uint8_t port_id,
+      unsigned int port_id,
       ola::Callback1<void, const ola::rdm::UIDSet&> *on_tod);
 
   /**
@@ -314,9 +343,14 @@ class ArtNetNodeImpl {
    * @param[out] node_addresses a vector of nodes listening to the port
    */
   void GetSubscribedNodes(
-      uint8_t port_id,
+      unsigned int port_id,
       std::vector<ola::network::IPV4Address> *node_addresses);
 
+  /**
+   * @brief The number of port addresses in the routing table.
+   */
+  unsigned int RoutingTableSize() const { return m_routing_table.size(); }
+
   // The following apply to Output Ports (those which receive data);
   /**
    * @brief Set the closure to be called when we receive data for this universe.
@@ -352,10 +386,31 @@ class ArtNetNodeImpl {
    */
   bool SendTimeCode(const ola::timecode::TimeCode &timecode);
 
+  /**
+   * @brief Send an ArtSync packet.
+   *
+   * Receivers that support ArtSync hold the DMX data they've received until
+   * the ArtSync arrives, so all their outputs update together.
+   */
+  bool SendSync();
+
  private:
   class InputPort;
   typedef std::vector<InputPort*> InputPorts;
 
+  // The input ports described by one ArtPollReply. These all share the same
+  // net & sub-net.
+  struct ReplyPage {
+    uint8_t net_address;
+    uint8_t subnet_address;
+    std::vector<InputPort*> ports;
+  };
+
+  // The nodes listening to a port address, and when we last heard from them.
+  typedef std::map<ola::network::IPV4Address, TimeStamp> SubscriberMap;
+  // Maps a 15 bit port address to the nodes listening to it.
+  typedef std::map<uint16_t, SubscriberMap> RoutingTable;
+
   // map a uid to a IP address and the number of times we've missed a
   // response.
   typedef std::map<ola::rdm::UID,
@@ -397,6 +452,9 @@ class ArtNetNodeImpl {
   ola::io::SelectServerInterface *m_ss;
   bool m_always_broadcast;
   bool m_use_limited_broadcast_address;
+  bool m_batch_sends;
+  unsigned int m_receive_buffer_size;
+  ola::ExportMap *m_export_map;
 
   // The following keep track of "Configuration mode"
   bool m_in_configuration_mode;
@@ -405,8 +463,17 @@ class ArtNetNodeImpl {
 
   InputPorts m_input_ports;
   OutputPort m_output_ports[ARTNET_MAX_PORTS];
+  // The ArtPollReplies are rebuilt when the port addresses change.
+  std::vector<ReplyPage> m_reply_pages;
+  bool m_reply_pages_stale;
+  // Built from the ArtPollReplies we receive.
+  RoutingTable m_routing_table;
+  ola::thread::timeout_id m_prune_timeout;
   ola::network::Interface m_interface;
   std::auto_ptr<ola::network::UDPSocketInterface> m_socket;
+  // The ring of buffers used to receive packets.
+  std::vector<artnet_packet> m_receive_packets;
+  std::vector<ola::network::UDPDatagram> m_receive_datagrams;
 
   /**
    * @brief Called when there is data on this socket
@@ -430,10 +497,35 @@ class ArtNetNodeImpl {
   bool SendPollReplyIfRequired();
 
   /**
-   * @brief Send an ArtPollReply message
+   * @brief Send the ArtPollReply messages.
+   *
+   * An ArtPollReply has a single net & sub-net, and describes up to
+   * ARTNET_MAX_PORTS ports. If the input ports don't fit in one reply, one
+   * is sent per page, each with it's own bind index.
    */
   bool SendPollReply(const ola::network::IPV4Address &destination);
 
+  /**
+   * @brief Group the input ports into pages if the addresses have changed.
+   *
+   * The first page has the output ports, and the input ports that share
+   * their net & sub-net. The remaining input ports are grouped by net &
+   * sub-net, up to ARTNET_MAX_PORTS per page.
+   */
+  void UpdateReplyPages();
+
+  /**
+   * @brief Remove nodes we haven't heard from in NODE_TIMEOUT seconds from
+   * the routing table.
+   */
+  bool PruneRoutingTable();
+
+  /**
+   * @brief Return the nodes listening to a port address, or NULL if there
+   * aren't any.
+   */
+  const SubscriberMap *Subscribers(uint16_t port_address) const;
+
   /**
    * @brief Send an IPProgReply
    */
@@ -549,7 +641,7 @@ class ArtNetNodeImpl {
    */
   bool SendRDMCommand(const ola::rdm::RDMCommand &command,
                       const ola::network::IPV4Address &destination,
-                      uint8_t universe);
+                      uint16_t port_address);
 
   /**
    * @brief Update a port from a source, merging if necessary
@@ -575,17 +667,18 @@ class ArtNetNodeImpl {
   /**
    * @brief Lookup an InputPort by id, if the id is invalid, we return NULL.
    */
-  InputPort *GetInputPort(uint8_t port_id, bool warn = true);
+  InputPort *GetInputPort(unsigned int port_id, bool warn = true);
 
   /**
    * @brief A const version of GetInputPort();
    */
-  const InputPort *GetInputPort(uint8_t port_id) const;
+  const InputPort *GetInputPort(unsigned int port_id) const;
 
   /**
    * @brief Similar to GetInputPort, but this also confirms the port is enabled.
    */
-  InputPort *GetEnabledInputPort(uint8_t port_id, const std::string &action);
+  InputPort *GetEnabledInputPort(unsigned int port_id,
+                                 const std::string &action);
 
   /**
    * @brief Lookup an OutputPort by id, if the id is invalid, we return NULL.
@@ -630,6 +723,9 @@ class ArtNetNodeImpl {
   bool InitNetwork();
 
   static const char ARTNET_ID[];
+  static const char RECEIVE_DROPS_VAR[];
+  static const char SEND_ERRORS_VAR[];
+  static const unsigned int RECEIVE_BATCH_SIZE = 16;
   static const uint16_t ARTNET_PORT = 6454;
   static const uint16_t OEM_CODE = 0x0431;
   static const uint16_t ARTNET_VERSION = 14;
@@ -642,6 +738,8 @@ class ArtNetNodeImpl {
   static const unsigned int MERGE_TIMEOUT = 10;  // As per the spec
   // seconds after which a node is marked as inactive for the dmx merging
   static const unsigned int NODE_TIMEOUT = 31;
+  // How often we remove inactive nodes from the routing table.
+  static const unsigned int ROUTING_TABLE_PRUNE_INTERVAL_MS = 5000;
   // mseconds we wait for a TodData packet before declaring a node missing
   static const unsigned int RDM_TOD_TIMEOUT_MS = 4000;
   // Number of missed TODs before we decide a UID has gone
@@ -663,7 +761,7 @@ class ArtNetNodeImpl {
 class ArtNetNodeImplRDMWrapper
     : public ola::rdm::DiscoverableRDMControllerInterface {
  public:
-  ArtNetNodeImplRDMWrapper(ArtNetNodeImpl *impl, uint8_t port_id):
+  ArtNetNodeImplRDMWrapper(ArtNetNodeImpl *impl, unsigned int port_id):
       m_impl(impl),
       m_port_id(port_id) {
   }
@@ -684,7 +782,7 @@ class ArtNetNodeImplRDMWrapper
 
  private:
   ArtNetNodeImpl *m_impl;
-  uint8_t m_port_id;
+  unsigned int m_port_id;
 
   DISALLOW_COPY_AND_ASSIGN(ArtNetNodeImplRDMWrapper);
 };
@@ -734,20 +832,26 @@ class ArtNetNode {
     return m_impl.SubnetAddress();
   }
 
-  uint8_t InputPortCount() const {
+  unsigned int InputPortCount() const {
     return m_impl.InputPortCount();
   }
 
-  bool SetInputPortUniverse(uint8_t port_id, uint8_t universe_id) {
+  bool SetInputPortUniverse(unsigned int port_id, uint8_t universe_id) {
     return m_impl.SetInputPortUniverse(port_id, universe_id);
   }
-  uint8_t GetInputPortUniverse(uint8_t port_id) const {
+  bool SetInputPortAddress(unsigned int port_id, uint16_t port_address) {
+    return m_impl.SetInputPortAddress(port_id, port_address);
+  }
+  uint8_t GetInputPortUniverse(unsigned int port_id) const {
     return m_impl.GetInputPortUniverse(port_id);
   }
-  void DisableInputPort(uint8_t port_id) {
+  uint16_t GetInputPortAddress(unsigned int port_id) const {
+    return m_impl.GetInputPortAddress(port_id);
+  }
+  void DisableInputPort(unsigned int port_id) {
     m_impl.DisableInputPort(port_id);
   }
-  bool InputPortState(uint8_t port_id) const {
+  bool InputPortState(unsigned int port_id) const {
     return m_impl.InputPortState(port_id);
   }
 
@@ -778,26 +882,26 @@ class ArtNetNode {
   }
 
   // The following apply to Input Ports (those which send data)
-  bool SendDMX(uint8_t port_id, const ola::DmxBuffer &buffer) {
+  bool SendDMX(unsigned int port_id, const ola::DmxBuffer &buffer) {
     return m_impl.SendDMX(port_id, buffer);
   }
 
   /**
    * @brief Trigger full discovery for a port
    */
-  void RunFullDiscovery(uint8_t port_id,
+  void RunFullDiscovery(unsigned int port_id,
                         ola::rdm::RDMDiscoveryCallback *callback);
 
   /**
    * @brief Trigger incremental discovery for a port.
    */
-  void RunIncrementalDiscovery(uint8_t port_id,
+  void RunIncrementalDiscovery(unsigned int port_id,
                                ola::rdm::RDMDiscoveryCallback *callback);
 
   /**
    * @brief Send a RDM request by passing it though the Queuing Controller
    */
-  void SendRDMRequest(uint8_t port_id,
+  void SendRDMRequest(unsigned int port_id,
                       ola::rdm::RDMRequest *request,
                       ola::rdm::RDMCallback *on_complete);
 
@@ -806,15 +910,18 @@ class ArtNetNode {
    * process isn't running.
    */
   bool SetUnsolicitedUIDSetHandler(
-      uint8_t port_id,
+      unsigned int port_id,
       ola::Callback1<void, const ola::rdm::UIDSet&> *on_tod) {
     return m_impl.SetUnsolicitedUIDSetHandler(port_id, on_tod);
   }
   void GetSubscribedNodes(
-      uint8_t port_id,
+      unsigned int port_id,
       std::vector<ola::network::IPV4Address> *node_addresses) {
     m_impl.GetSubscribedNodes(port_id, node_addresses);
   }
+  unsigned int RoutingTableSize() const {
+    return m_impl.RoutingTableSize();
+  }
 
   // The following apply to Output Ports (those which receive data);
   bool SetDMXHandler(uint8_t port_id,
@@ -843,6 +950,8 @@ class ArtNetNode {
     return m_impl.SendTimeCode(timecode);
   }
 
+  bool SendSync() { return m_impl.SendSync(); }
+
  private:
   ArtNetNodeImpl m_impl;
   std::vector<ArtNetNodeImplRDMWrapper*> m_wrappers;
@@ -852,7 +961,7 @@ class ArtNetNode {
    * @brief Check that the port_id is a valid input port.
    * @return true if the port id is valid, false otherwise
    */
-  bool CheckInputPortId(uint8_t port_id);
+  bool CheckInputPortId(unsigned int port_id);
 
   DISALLOW_COPY_AND_ASSIGN(ArtNetNode);
 };
@@ -27,6 +27,7 @@
 #include "ola/Callback.h"
 #include "ola/DmxBuffer.h"
 #include "ola/Logging.h"
+#include "ola/base/Array.h"
 #include "ola/io/SelectServer.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/Interface.h"
@@ -73,6 +74,8 @@ class ArtNetNodeTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testBasicBehaviour);
   CPPUNIT_TEST(testConfigurationMode);
   CPPUNIT_TEST(testExtendedInputPorts);
+  CPPUNIT_TEST(testFullPortAddresses);
+  CPPUNIT_TEST(testMixedNetPortAddresses);
   CPPUNIT_TEST(testBroadcastSendDMX);
   CPPUNIT_TEST(testBroadcastSendDMXZeroUniverse);
   CPPUNIT_TEST(testLimitedBroadcastDMX);
@@ -91,6 +94,7 @@ class ArtNetNodeTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testRDMRequestIPMismatch);
   CPPUNIT_TEST(testRDMRequestUIDMismatch);
   CPPUNIT_TEST(testTimeCode);
+  CPPUNIT_TEST(testSync);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -114,6 +118,8 @@ class ArtNetNodeTest: public CppUnit::TestFixture {
   void testBasicBehaviour();
   void testConfigurationMode();
   void testExtendedInputPorts();
+  void testFullPortAddresses();
+  void testMixedNetPortAddresses();
   void testBroadcastSendDMX();
   void testBroadcastSendDMXZeroUniverse();
   void testLimitedBroadcastDMX();
@@ -132,6 +138,7 @@ class ArtNetNodeTest: public CppUnit::TestFixture {
   void testRDMRequestIPMismatch();
   void testRDMRequestUIDMismatch();
   void testTimeCode();
+  void testSync();
 
  private:
   ola::MockClock m_clock;
@@ -378,7 +385,7 @@ void ArtNetNodeTest::testBasicBehaviour() {
   OLA_ASSERT(m_socket->CheckNetworkParamsMatch(true, true, 6454, true));
 
   // check port states
-  OLA_ASSERT_EQ((uint8_t) 4, node.InputPortCount());
+  OLA_ASSERT_EQ(4u, node.InputPortCount());
   OLA_ASSERT_FALSE(node.InputPortState(0));
   OLA_ASSERT_FALSE(node.InputPortState(1));
   OLA_ASSERT_FALSE(node.InputPortState(2));
@@ -602,7 +609,7 @@ void ArtNetNodeTest::testExtendedInputPorts() {
   ss.RemoveReadDescriptor(m_socket);
   m_socket->Verify();
 
-  OLA_ASSERT_EQ((uint8_t) 8, node.InputPortCount());
+  OLA_ASSERT_EQ(8u, node.InputPortCount());
   OLA_ASSERT_FALSE(node.InputPortState(0));
   OLA_ASSERT_FALSE(node.InputPortState(1));
   OLA_ASSERT_FALSE(node.InputPortState(2));
@@ -628,6 +635,246 @@ void ArtNetNodeTest::testExtendedInputPorts() {
 }
 
 
+/**
+ * Check input ports with full 15 bit port addresses.
+ */
+void ArtNetNodeTest::testFullPortAddresses() {
+  m_socket->SetDiscardMode(true);
+  ArtNetNodeOptions node_options;
+  node_options.input_port_count = 6;
+  ArtNetNode node(iface, &ss, node_options, m_socket);
+  node.SetShortName("Short Name");
+  node.SetLongName("This is the very long name");
+  node.SetNetAddress(4);
+  node.SetSubnetAddress(2);
+  node.SetOutputPortUniverse(0, 3);
+  node.SetInputPortUniverse(1, 2);
+
+  OLA_ASSERT(node.SetInputPortAddress(4, 0x512));
+  OLA_ASSERT(node.SetInputPortAddress(5, 0x513));
+  OLA_ASSERT(!node.SetInputPortAddress(6, 0x514));
+  OLA_ASSERT_EQ((uint16_t) 0x422, node.GetInputPortAddress(1));
+  OLA_ASSERT_EQ((uint16_t) 0x513, node.GetInputPortAddress(5));
+  OLA_ASSERT_EQ((uint8_t) 0x13, node.GetInputPortUniverse(5));
+
+  // ports with a full address don't follow the node's net & subnet
+  node.SetNetAddress(4);
+  OLA_ASSERT_EQ((uint16_t) 0x513, node.GetInputPortAddress(5));
+
+  OLA_ASSERT(node.Start());
+  ss.RemoveReadDescriptor(m_socket);
+  m_socket->Verify();
+  m_socket->SetDiscardMode(false);
+
+  // An ArtPoll should trigger one ArtPollReply for each group of 4 ports.
+  {
+    SocketVerifier verifer(m_socket);
+    uint8_t first_reply[sizeof(POLL_REPLY_MESSAGE)];
+    memcpy(first_reply, POLL_REPLY_MESSAGE, sizeof(POLL_REPLY_MESSAGE));
+    first_reply[179] = 0;  // good input
+    first_reply[187] = 0x22;  // swin
+    first_reply[211] = 1;  // bind index
+    ExpectedBroadcast(first_reply, sizeof(first_reply));
+
+    uint8_t second_reply[sizeof(POLL_REPLY_MESSAGE)];
+    memcpy(second_reply, POLL_REPLY_MESSAGE, sizeof(POLL_REPLY_MESSAGE));
+    second_reply[18] = 5;  // net
+    second_reply[19] = 1;  // subnet
+    second_reply[173] = 2;  // num ports
+    const uint8_t port_info[] = {
+      0x40, 0x40, 0, 0,  // port types
+      0, 0, 8, 8,  // good input
+      0, 0, 0, 0,  // good output
+      0x12, 0x13, 0, 0,  // swin
+      0, 0, 0, 0,  // swout
+    };
+    memcpy(second_reply + 174, port_info, sizeof(port_info));
+    second_reply[211] = 2;  // bind index
+    ExpectedBroadcast(second_reply, sizeof(second_reply));
+
+    ReceiveFromPeer(POLL_MESSAGE, sizeof(POLL_MESSAGE), peer_ip);
+  }
+
+  // A reply from a node with an output port on 5:1:3
+  {
+    SocketVerifier verifer(m_socket);
+    uint8_t poll_reply[sizeof(POLL_REPLY_MESSAGE)];
+    memcpy(poll_reply, POLL_REPLY_MESSAGE, sizeof(POLL_REPLY_MESSAGE));
+    poll_reply[18] = 5;  // net
+    poll_reply[19] = 1;  // subnet
+    poll_reply[190] = 0x03;  // swout
+    ReceiveFromPeer(poll_reply, sizeof(poll_reply), peer_ip);
+  }
+  OLA_ASSERT_EQ(2u, node.RoutingTableSize());
+
+  vector<IPV4Address> node_addresses;
+  node.GetSubscribedNodes(5, &node_addresses);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), node_addresses.size());
+  OLA_ASSERT_EQ(peer_ip, node_addresses[0]);
+  node_addresses.clear();
+  node.GetSubscribedNodes(4, &node_addresses);
+  OLA_ASSERT_EMPTY(node_addresses);
+
+  DmxBuffer dmx;
+  dmx.SetFromString("0,1,2,3,4,5");
+  {
+    SocketVerifier verifer(m_socket);
+    const uint8_t dmx_message[] = {
+      'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+      0x00, 0x50,
+      0x0, 14,
+      0,  // seq #
+      1,  // physical port, the second port in the second ArtPollReply
+      0x13, 5,  // subnet & net address
+      0, 6,  // dmx length
+      0, 1, 2, 3, 4, 5
+    };
+    ExpectedSend(dmx_message, sizeof(dmx_message), peer_ip);
+    OLA_ASSERT(node.SendDMX(5, dmx));
+
+    // no one is listening to port 4
+    OLA_ASSERT(node.SendDMX(4, dmx));
+  }
+
+  // Once the node times out, it's pruned from the routing table. Timeouts run
+  // before the wake up time is updated, so it takes two passes.
+  m_clock.AdvanceTime(31, 0);
+  ss.RunOnce();
+  OLA_ASSERT_EQ(2u, node.RoutingTableSize());
+  m_clock.AdvanceTime(5, 0);
+  ss.RunOnce();
+  OLA_ASSERT_EQ(0u, node.RoutingTableSize());
+  {
+    SocketVerifier verifer(m_socket);
+    OLA_ASSERT(node.SendDMX(5, dmx));
+  }
+}
+
+
+/**
+ * Check input ports on different nets & sub-nets are described by separate
+ * ArtPollReplies.
+ */
+void ArtNetNodeTest::testMixedNetPortAddresses() {
+  m_socket->SetDiscardMode(true);
+  ArtNetNodeOptions node_options;
+  node_options.input_port_count = 6;
+  node_options.always_broadcast = true;
+  ArtNetNode node(iface, &ss, node_options, m_socket);
+  node.SetShortName("Short Name");
+  node.SetLongName("This is the very long name");
+  node.SetNetAddress(4);
+  node.SetSubnetAddress(2);
+  node.SetOutputPortUniverse(0, 3);
+  node.SetInputPortUniverse(1, 2);
+  OLA_ASSERT(node.SetInputPortAddress(2, 0x512));
+  OLA_ASSERT(node.SetInputPortAddress(3, 0x42a));
+  OLA_ASSERT(node.SetInputPortAddress(4, 0x601));
+  OLA_ASSERT(node.SetInputPortAddress(5, 0x513));
+
+  OLA_ASSERT(node.Start());
+  ss.RemoveReadDescriptor(m_socket);
+  m_socket->Verify();
+  m_socket->SetDiscardMode(false);
+
+  // Ports 0, 1 & 3 share the output ports' net & sub-net, ports 2 & 5 are on
+  // 5:1 and port 4 is on 6:0.
+  {
+    SocketVerifier verifer(m_socket);
+    uint8_t first_reply[sizeof(POLL_REPLY_MESSAGE)];
+    memcpy(first_reply, POLL_REPLY_MESSAGE, sizeof(POLL_REPLY_MESSAGE));
+    first_reply[177] = 0x80;  // port type
+    first_reply[179] = 0;  // good input
+    first_reply[180] = 0;
+    first_reply[187] = 0x22;  // swin
+    first_reply[188] = 0x2a;
+    first_reply[189] = 0;
+    first_reply[211] = 1;  // bind index
+    ExpectedBroadcast(first_reply, sizeof(first_reply));
+
+    uint8_t second_reply[sizeof(POLL_REPLY_MESSAGE)];
+    memcpy(second_reply, POLL_REPLY_MESSAGE, sizeof(POLL_REPLY_MESSAGE));
+    second_reply[18] = 5;  // net
+    second_reply[19] = 1;  // subnet
+    second_reply[173] = 2;  // num ports
+    const uint8_t second_port_info[] = {
+      0x40, 0x40, 0, 0,  // port types
+      0, 0, 8, 8,  // good input
+      0, 0, 0, 0,  // good output
+      0x12, 0x13, 0, 0,  // swin
+      0, 0, 0, 0,  // swout
+    };
+    memcpy(second_reply + 174, second_port_info, sizeof(second_port_info));
+    second_reply[211] = 2;  // bind index
+    ExpectedBroadcast(second_reply, sizeof(second_reply));
+
+    uint8_t third_reply[sizeof(POLL_REPLY_MESSAGE)];
+    memcpy(third_reply, POLL_REPLY_MESSAGE, sizeof(POLL_REPLY_MESSAGE));
+    third_reply[18] = 6;  // net
+    third_reply[19] = 0;  // subnet
+    third_reply[173] = 1;  // num ports
+    const uint8_t third_port_info[] = {
+      0x40, 0, 0, 0,  // port types
+      0, 8, 8, 8,  // good input
+      0, 0, 0, 0,  // good output
+      0x01, 0, 0, 0,  // swin
+      0, 0, 0, 0,  // swout
+    };
+    memcpy(third_reply + 174, third_port_info, sizeof(third_port_info));
+    third_reply[211] = 3;  // bind index
+    ExpectedBroadcast(third_reply, sizeof(third_reply));
+
+    ReceiveFromPeer(POLL_MESSAGE, sizeof(POLL_MESSAGE), peer_ip);
+  }
+
+  // The physical port is the port's index within its ArtPollReply.
+  DmxBuffer dmx;
+  dmx.SetFromString("0,1");
+  const unsigned int ports[] = {3, 5, 4};
+  const uint8_t physical[] = {2, 1, 0};
+  const uint8_t universe[] = {0x2a, 0x13, 0x01};
+  const uint8_t net[] = {4, 5, 6};
+  for (unsigned int i = 0; i < arraysize(ports); i++) {
+    SocketVerifier verifer(m_socket);
+    const uint8_t dmx_message[] = {
+      'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+      0x00, 0x50,
+      0x0, 14,
+      0,  // seq #
+      physical[i],
+      universe[i], net[i],  // subnet & net address
+      0, 2,  // dmx length
+      0, 1
+    };
+    ExpectedBroadcast(dmx_message, sizeof(dmx_message));
+    OLA_ASSERT(node.SendDMX(ports[i], dmx));
+  }
+
+  // Moving the node to 6:0 puts port 4 on the first page, after ports 0 & 1
+  // which follow the node's address.
+  m_socket->SetDiscardMode(true);
+  node.SetNetAddress(6);
+  node.SetSubnetAddress(0);
+  m_socket->Verify();
+  m_socket->SetDiscardMode(false);
+  {
+    SocketVerifier verifer(m_socket);
+    const uint8_t dmx_message[] = {
+      'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+      0x00, 0x50,
+      0x0, 14,
+      1,  // seq #
+      2,  // physical port
+      0x01, 6,  // subnet & net address
+      0, 2,  // dmx length
+      0, 1
+    };
+    ExpectedBroadcast(dmx_message, sizeof(dmx_message));
+    OLA_ASSERT(node.SendDMX(4, dmx));
+  }
+}
+
+
 /**
  * Check sending DMX using broadcast works.
  */
@@ -2286,3 +2533,37 @@ void ArtNetNodeTest::testTimeCode() {
     OLA_ASSERT(node.SendTimeCode(t1));
   }
 }
+
+
+/**
+ * Check ArtSync sending works
+ */
+void ArtNetNodeTest::testSync() {
+  m_socket->SetDiscardMode(true);
+  ArtNetNodeOptions node_options;
+  ArtNetNode node(iface, &ss, node_options, m_socket);
+
+  OLA_ASSERT(node.Start());
+  ss.RemoveReadDescriptor(m_socket);
+  m_socket->Verify();
+  m_socket->SetDiscardMode(false);
+
+  const uint8_t sync_message[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x52,
+    0x0, 14,
+    0, 0
+  };
+
+  {
+    SocketVerifier verifer(m_socket);
+    ExpectedBroadcast(sync_message, sizeof(sync_message));
+    OLA_ASSERT(node.SendSync());
+  }
+
+  // An ArtSync from another controller is ignored.
+  {
+    SocketVerifier verifer(m_socket);
+    ReceiveFromPeer(sync_message, sizeof(sync_message), peer_ip);
+  }
+}
@@ -75,8 +75,9 @@ string ArtNetPlugin::Description() const {
       "ArtNet Plugin\n"
       "----------------------------\n"
       "\n"
-      "This plugin creates a single device with four input and four output \n"
-      "ports and supports ArtNet, ArtNet 2 and ArtNet 3.\n"
+      "This plugin creates a single device with four input and, by default,\n"
+      "four output ports and supports ArtNet, ArtNet 2, ArtNet 3 and\n"
+      "ArtNet 4.\n"
       "\n"
       "ArtNet limits a single device (identified by a unique IP) to four\n"
       "input and four output ports, each bound to a separate ArtNet Port\n"
@@ -114,6 +115,21 @@ string ArtNetPlugin::Description() const {
       "Use ArtNet v1 and always broadcast the DMX data. Turn this on if\n"
       "you have devices that don't respond to ArtPoll messages.\n"
       "\n"
+      "batch_receives = [true|false]\n"
+      "Read all waiting packets each time the socket is readable, with a\n"
+      "single system call where supported.\n"
+      "\n"
+      "batch_sends = [true|false]\n"
+      "Send the packets generated in each loop with a single system call,\n"
+      "where supported. This is off by default, packets that fail to send\n"
+      "are counted in the artnet-send-errors variable either way.\n"
+      "\n"
+      "full_port_address = [true|false]\n"
+      "Use the OLA universe number as the full 15 bit port address for the\n"
+      "output ports, rather than combining the net and subnet with the\n"
+      "universe number modulo 16. This allows the output ports to send to\n"
+      "different nets and subnets.\n"
+      "\n"
       "ip = [a.b.c.d|<interface_name>]\n"
       "The ip address or interface name to bind to. If not specified it will\n"
       "use the first non-loopback interface.\n"
@@ -125,8 +141,14 @@ string ArtNetPlugin::Description() const {
       "The ArtNet Net to use (0-127).\n"
       "\n"
       "output_ports = 4\n"
-      "The number of output ports (Send ArtNet) to create. Only the first 4\n"
-      "will appear in ArtPoll messages\n"
+      "The number of output ports (Send ArtNet) to create, up to 1024. Each\n"
+      "ArtPollReply describes up to 4 ports on a single net and subnet, so\n"
+      "nodes with more ports, or ports on different nets and subnets, send\n"
+      "more than one ArtPollReply.\n"
+      "\n"
+      "receive_buffer_size = 0\n"
+      "The size of the socket receive buffer in bytes, 0 uses the system\n"
+      "default. Increase this if packets are dropped under load.\n"
       "\n"
       "short_name = ola - ArtNet node\n"
       "The short name of the node (first 17 chars will be used).\n"
@@ -134,6 +156,16 @@ string ArtNetPlugin::Description() const {
       "subnet = 0\n"
       "The ArtNet subnet to use (0-15).\n"
       "\n"
+      "sync_timeout_ms = 50\n"
+      "The longest to wait for the other output ports before sending a\n"
+      "synchronized frame. Ports that didn't have a frame in the last\n"
+      "synchronized frame aren't waited for, so an idle universe only\n"
+      "delays one frame.\n"
+      "\n"
+      "use_artsync = [true|false]\n"
+      "Send the frames for all the output ports together, followed by an\n"
+      "ArtSync, so nodes that support ArtSync update their outputs at once.\n"
+      "\n"
       "use_limited_broadcast = [true|false]\n"
       "When broadcasting, use the limited broadcast address (255.255.255.255)\n"
       "rather than the subnet directed broadcast address. Some devices which \n"
@@ -168,17 +200,37 @@ bool ArtNetPlugin::SetDefaultPreferences() {
                                          ArtNetDevice::K_ARTNET_SUBNET);
   save |= m_preferences->SetDefaultValue(
       ArtNetDevice::K_OUTPUT_PORT_KEY,
-      UIntValidator(0, 16),
+      UIntValidator(0, ArtNetDevice::K_MAX_OUTPUT_PORT_COUNT),
       ArtNetDevice::K_DEFAULT_OUTPUT_PORT_COUNT);
+  save |= m_preferences->SetDefaultValue(ArtNetDevice::K_FULL_PORT_ADDRESS_KEY,
+                                         BoolValidator(),
+                                         false);
   save |= m_preferences->SetDefaultValue(ArtNetDevice::K_ALWAYS_BROADCAST_KEY,
                                          BoolValidator(),
                                          false);
+  save |= m_preferences->SetDefaultValue(ArtNetDevice::K_BATCH_RECEIVES_KEY,
+                                         BoolValidator(),
+                                         true);
+  save |= m_preferences->SetDefaultValue(ArtNetDevice::K_BATCH_SENDS_KEY,
+                                         BoolValidator(),
+                                         false);
   save |= m_preferences->SetDefaultValue(ArtNetDevice::K_LIMITED_BROADCAST_KEY,
                                          BoolValidator(),
                                          false);
   save |= m_preferences->SetDefaultValue(ArtNetDevice::K_LOOPBACK_KEY,
                                          BoolValidator(),
                                          false);
+  save |= m_preferences->SetDefaultValue(
+      ArtNetDevice::K_SYNC_TIMEOUT_KEY,
+      UIntValidator(1, 1000),
+      ArtNetDevice::K_DEFAULT_SYNC_TIMEOUT_MS);
+  save |= m_preferences->SetDefaultValue(ArtNetDevice::K_USE_ARTSYNC_KEY,
+                                         BoolValidator(),
+                                         false);
+  save |= m_preferences->SetDefaultValue(
+      ArtNetDevice::K_RECEIVE_BUFFER_SIZE_KEY,
+      UIntValidator(0, 64 * 1024 * 1024),
+      0);
 
   if (save) {
     m_preferences->Save();
@@ -37,6 +37,7 @@ using std::vector;
 
 namespace {
 static const uint8_t ARTNET_UNIVERSE_COUNT = 16;
+static const uint16_t ARTNET_PORT_ADDRESS_MASK = 0x7fff;
 };  // namespace
 
 void ArtNetInputPort::PostSetUniverse(Universe *old_universe,
@@ -108,13 +109,16 @@ void ArtNetInputPort::TriggerDiscovery() {
       NewSingleCallback(this, &ArtNetInputPort::SendTODWithUIDs));
 }
 
-bool ArtNetOutputPort::WriteDMX(const DmxBuffer &buffer,
-                                OLA_UNUSED uint8_t priority) {
-  if (PortId() >= ARTNET_MAX_PORTS) {
-    OLA_WARN << "Invalid artnet port id " << PortId();
-    return false;
+ArtNetOutputPort::~ArtNetOutputPort() {
+  if (m_sync_group) {
+    m_sync_group->RemovePort(this);
   }
+}
 
+bool ArtNetOutputPort::WriteDMX(const DmxBuffer &buffer, uint8_t priority) {
+  if (m_sync_group) {
+    return m_sync_group->WriteDMX(this, buffer, priority);
+  }
   return m_node->SendDMX(PortId(), buffer);
 }
 
@@ -146,7 +150,10 @@ void ArtNetOutputPort::RunIncrementalDiscovery(
 
 void ArtNetOutputPort::PostSetUniverse(Universe *old_universe,
                                        Universe *new_universe) {
-  if (new_universe) {
+  if (new_universe && m_full_port_address) {
+    m_node->SetInputPortAddress(
+        PortId(), new_universe->UniverseId() & ARTNET_PORT_ADDRESS_MASK);
+  } else if (new_universe) {
     m_node->SetInputPortUniverse(
         PortId(), new_universe->UniverseId() % ARTNET_UNIVERSE_COUNT);
   } else {
@@ -162,6 +169,23 @@ void ArtNetOutputPort::PostSetUniverse(Universe *old_universe,
   } else if (!new_universe) {
     m_node->SetUnsolicitedUIDSetHandler(PortId(), NULL);
   }
+
+  if (m_sync_group) {
+    if (new_universe && !old_universe) {
+      m_sync_group->AddPort(this,
+                            NewCallback(this, &ArtNetOutputPort::SendDMX));
+    } else if (!new_universe) {
+      m_sync_group->RemovePort(this);
+    }
+  }
+}
+
+/*
+ * Send a frame, this is called by the OutputSyncGroup when ArtSync is enabled.
+ */
+bool ArtNetOutputPort::SendDMX(const DmxBuffer &buffer,
+                               OLA_UNUSED uint8_t priority) {
+  return m_node->SendDMX(PortId(), buffer);
 }
 
 string ArtNetOutputPort::Description() const {
@@ -169,11 +193,12 @@ string ArtNetOutputPort::Description() const {
     return "";
   }
 
+  uint16_t port_address = m_node->GetInputPortAddress(PortId());
   std::ostringstream str;
   str << "ArtNet Universe "
-      << static_cast<int>(m_node->NetAddress()) << ":"
-      << static_cast<int>(m_node->SubnetAddress()) << ":"
-      << static_cast<int>(m_node->GetInputPortUniverse(PortId()));
+      << (port_address >> 8) << ":"
+      << ((port_address >> 4) & 0x0f) << ":"
+      << (port_address & 0x0f);
   return str.str();
 }
 }  // namespace artnet
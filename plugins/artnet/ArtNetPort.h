@@ -23,6 +23,7 @@
 
 #include <string>
 #include "ola/rdm/RDMControllerInterface.h"
+#include "olad/OutputSyncGroup.h"
 #include "olad/Port.h"
 #include "plugins/artnet/ArtNetDevice.h"
 #include "plugins/artnet/ArtNetNode.h"
@@ -73,9 +74,15 @@ class ArtNetOutputPort: public BasicOutputPort {
  public:
   ArtNetOutputPort(ArtNetDevice *device,
                    unsigned int port_id,
-                   ArtNetNode *node)
+                   ArtNetNode *node,
+                   bool full_port_address = false,
+                   ola::OutputSyncGroup *sync_group = NULL)
       : BasicOutputPort(device, port_id, true, true),
-        m_node(node) {}
+        m_node(node),
+        m_full_port_address(full_port_address),
+        m_sync_group(sync_group) {}
+
+  ~ArtNetOutputPort();
 
   bool WriteDMX(const DmxBuffer &buffer, uint8_t priority);
 
@@ -114,6 +121,12 @@ class ArtNetOutputPort: public BasicOutputPort {
 
  private:
   ArtNetNode *m_node;
+  // Use the universe id as the full 15 bit port address, rather than just
+  // the low 4 bits.
+  bool m_full_port_address;
+  ola::OutputSyncGroup *m_sync_group;
+
+  bool SendDMX(const DmxBuffer &buffer, uint8_t priority);
 };
 }  // namespace artnet
 }  // namespace plugin
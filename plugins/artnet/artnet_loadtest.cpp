@@ -19,33 +19,68 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
 #include <algorithm>
+#include <iostream>
 #include <memory>
 #include <string>
+#include <vector>
 #include "ola/Callback.h"
+#include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
 #include "ola/Logging.h"
 #include "ola/base/Flags.h"
 #include "ola/base/Init.h"
 #include "ola/io/SelectServer.h"
+#include "ola/network/IPV4Address.h"
 #include "ola/network/InterfacePicker.h"
+#include "ola/network/NetworkUtils.h"
+#include "ola/network/Socket.h"
+#include "ola/network/SocketAddress.h"
+#include "ola/stl/STLUtils.h"
 #include "plugins/artnet/ArtNetNode.h"
+#include "plugins/artnet/ArtNetPackets.h"
 
+using ola::Clock;
 using ola::DmxBuffer;
 using ola::NewCallback;
+using ola::TimeInterval;
+using ola::TimeStamp;
 using ola::io::SelectServer;
+using ola::network::HostToLittleEndian;
+using ola::network::HostToNetwork;
+using ola::network::IPV4Address;
+using ola::network::IPV4SocketAddress;
 using ola::network::Interface;
 using ola::network::InterfacePicker;
+using ola::network::UDPSocket;
 using ola::plugin::artnet::ArtNetNode;
 using ola::plugin::artnet::ArtNetNodeOptions;
+using ola::plugin::artnet::artnet_packet;
 using std::auto_ptr;
 using std::cout;
 using std::endl;
 using std::min;
+using std::vector;
 
 DEFINE_s_uint32(fps, f, 10, "Frames per second per universe [1 - 1000]");
-DEFINE_s_uint16(universes, u, 1, "Number of universes to send");
+DEFINE_s_uint16(universes, u, 1, "Number of universes to send [1 - 32768]");
 DEFINE_string(iface, "", "The interface to send from");
+DEFINE_default_bool(batch_sends, false,
+                    "Send the packets for each frame with a single system "
+                    "call, where supported");
+DEFINE_default_bool(benchmark, false,
+                    "Send frames as fast as possible and report the "
+                    "packets/s");
+DEFINE_uint32(frames, 1000,
+              "The number of frames per universe to send in benchmark mode");
+DEFINE_uint8(subscribers, 0,
+             "Rather than broadcasting, unicast each universe to this many "
+             "nodes, on 127.0.0.2 and up [0 - 200]");
+
+static const uint16_t ARTNET_PORT = 6454;
+static const unsigned int REPLY_INTERVAL_MS = 10000;
 
 /**
  * Send N DMX frames using ArtNet, where N is given by number_of_universes.
@@ -58,10 +93,110 @@ bool SendFrames(ArtNetNode *node, DmxBuffer *buffer,
   return true;
 }
 
+/**
+ * Bind a socket for each of the subscribing nodes. Each one is on its own
+ * loopback address, and the Art-Net port, so it gets the unicast frames
+ * rather than the node we're testing.
+ */
+bool SetupSubscribers(unsigned int count, vector<UDPSocket*> *sockets) {
+  for (unsigned int i = 0; i < count; i++) {
+    const IPV4Address address(HostToNetwork(0x7f000002 + i));
+    UDPSocket *socket = new UDPSocket();
+    sockets->push_back(socket);
+    if (!socket->Init() ||
+        !socket->Bind(IPV4SocketAddress(address, ARTNET_PORT))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Send ArtPollReplies from each subscriber, with an output port for every
+ * universe, so the node adds them to its routing table. The node forgets
+ * them after 30s, so this repeats.
+ */
+bool SendPollReplies(const vector<UDPSocket*> *sockets,
+                     IPV4Address node_address,
+                     uint16_t number_of_universes) {
+  artnet_packet packet;
+  memset(&packet, 0, sizeof(packet));
+  strncpy(reinterpret_cast<char*>(packet.id), "Art-Net",
+          sizeof(packet.id));
+  packet.op_code = HostToLittleEndian(
+      static_cast<uint16_t>(ola::plugin::artnet::ARTNET_REPLY));
+
+  const IPV4SocketAddress destination(node_address, ARTNET_PORT);
+  for (uint16_t first = 0; first < number_of_universes;
+       first += ola::plugin::artnet::ARTNET_MAX_PORTS) {
+    // The universes in a reply share the net & sub-net.
+    packet.data.reply.net_address = first >> 8;
+    packet.data.reply.subnet_address = (first >> 4) & 0x0f;
+    const unsigned int ports = min(
+        static_cast<unsigned int>(ola::plugin::artnet::ARTNET_MAX_PORTS),
+        static_cast<unsigned int>(number_of_universes - first));
+    packet.data.reply.number_ports[1] = ports;
+    for (unsigned int i = 0; i < ports; i++) {
+      packet.data.reply.port_types[i] = 0x80;
+      packet.data.reply.sw_out[i] = (first + i) & 0x0f;
+    }
+
+    vector<UDPSocket*>::const_iterator iter = sockets->begin();
+    for (; iter != sockets->end(); ++iter) {
+      (*iter)->SendTo(reinterpret_cast<const uint8_t*>(&packet),
+                      sizeof(packet.id) + sizeof(packet.op_code) +
+                      sizeof(packet.data.reply),
+                      destination);
+    }
+  }
+  return true;
+}
+
+/**
+ * Return the user CPU time used by this process, this excludes the time spent
+ * in the kernel sending the packets.
+ */
+int64_t UserTime() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return TimeInterval(usage.ru_utime.tv_sec, usage.ru_utime.tv_usec).AsInt();
+}
+
+/**
+ * Send frames for all universes as fast as possible & print the packets/s.
+ * Each frame is sent to copies_per_frame nodes.
+ */
+void RunBenchmark(SelectServer *ss, ArtNetNode *node, const DmxBuffer &buffer,
+                  uint16_t number_of_universes, unsigned int frames,
+                  unsigned int copies_per_frame) {
+  Clock clock;
+  TimeStamp start, end;
+  int64_t user_start = UserTime();
+  clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < frames; i++) {
+    for (uint16_t j = 0; j < number_of_universes; j++) {
+      node->SendDMX(j, buffer);
+    }
+    // flush the send batch, if there is one
+    ss->RunOnce();
+  }
+  clock.CurrentTime(&end);
+  int64_t user_time = UserTime() - user_start;
+
+  int64_t duration = std::max((end - start).AsInt(), static_cast<int64_t>(1));
+  uint64_t packets = (static_cast<uint64_t>(frames) * number_of_universes *
+                      copies_per_frame);
+  cout << number_of_universes << " universe(s): "
+       << static_cast<uint64_t>(packets * 1000000.0 / duration)
+       << " packets/s, " << user_time * 1000.0 / packets
+       << " ns user CPU/packet" << endl;
+}
+
 int main(int argc, char* argv[]) {
-  ola::AppInit(&argc, argv, "", "Run the E1.31 load test.");
+  ola::AppInit(&argc, argv, "", "Run the ArtNet load test.");
 
-  if (FLAGS_universes == 0 || FLAGS_fps == 0)
+  if (FLAGS_universes == 0 || FLAGS_universes > 32768 || FLAGS_fps == 0 ||
+      FLAGS_subscribers > 200)
     return -1;
 
   unsigned int fps = min(1000u, static_cast<unsigned int>(FLAGS_fps));
@@ -80,13 +215,17 @@ int main(int argc, char* argv[]) {
   }
 
   ArtNetNodeOptions options;
-  options.always_broadcast = true;
+  options.always_broadcast = FLAGS_subscribers == 0;
+  options.broadcast_threshold = FLAGS_subscribers + 1;
+  options.batch_sends = FLAGS_batch_sends;
+  options.input_port_count = universes;
 
   SelectServer ss;
   ArtNetNode node(iface, &ss, options);
 
+  // Each port gets its own 15 bit port address.
   for (uint16_t i = 0; i < universes; i++) {
-    if (!node.SetInputPortUniverse(i, i)) {
+    if (!node.SetInputPortAddress(i, i)) {
       OLA_WARN << "Failed to set port";
     }
   }
@@ -94,10 +233,42 @@ int main(int argc, char* argv[]) {
   if (!node.Start())
     return -1;
 
+  vector<UDPSocket*> subscribers;
+  if (FLAGS_subscribers) {
+    if (!SetupSubscribers(FLAGS_subscribers, &subscribers)) {
+      OLA_WARN << "Failed to bind the subscriber sockets";
+      ola::STLDeleteElements(&subscribers);
+      return -1;
+    }
+    SendPollReplies(&subscribers, iface.ip_address, universes);
+    ss.RegisterRepeatingTimeout(
+        REPLY_INTERVAL_MS,
+        NewCallback(&SendPollReplies,
+                    static_cast<const vector<UDPSocket*>*>(&subscribers),
+                    iface.ip_address, universes));
+
+    // Wait for the node to process the replies.
+    for (unsigned int i = 0; i < 100 && node.RoutingTableSize() < universes;
+         i++) {
+      ss.RunOnce(TimeInterval(0, 10000));
+    }
+    cout << "Sending to " << static_cast<int>(FLAGS_subscribers)
+         << " node(s), " << node.RoutingTableSize() << " of " << universes
+         << " universe(s) are subscribed" << endl;
+  }
+
+  if (FLAGS_benchmark) {
+    RunBenchmark(&ss, &node, output, universes, FLAGS_frames,
+                 std::max(1u, static_cast<unsigned int>(FLAGS_subscribers)));
+    ola::STLDeleteElements(&subscribers);
+    return 0;
+  }
+
   ss.RegisterRepeatingTimeout(
       1000 / fps,
       NewCallback(&SendFrames, &node, &output, universes));
   cout << "Starting loadtester: " << universes << " universe(s), " << fps
        << " fps" << endl;
   ss.Run();
+  ola::STLDeleteElements(&subscribers);
 }
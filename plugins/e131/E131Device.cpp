@@ -29,6 +29,7 @@
 #include <vector>
 
 #include "common/rpc/RpcController.h"
+#include "ola/Callback.h"
 #include "ola/CallbackRunner.h"
 #include "ola/Logging.h"
 #include "ola/network/NetworkUtils.h"
@@ -91,9 +92,19 @@ bool E131Device::StartHook() {
     m_input_ports.push_back(input_port);
   }
 
+  if (m_options.sync_universe) {
+    if (m_options.use_rev2) {
+      OLA_WARN << "E1.31 synchronization isn't supported by revision 0.2";
+    } else {
+      m_sync_group.reset(new OutputSyncGroup(
+          m_plugin_adaptor, m_options.sync_timeout_ms,
+          NewCallback(this, &E131Device::SendSynchronization)));
+    }
+  }
+
   for (unsigned int i = 0; i < m_options.output_ports; i++) {
     E131OutputPort *output_port = new E131OutputPort(
-        this, i, m_node.get());
+        this, i, m_node.get(), m_sync_group.get(), m_options.sync_universe);
     AddPort(output_port);
     m_output_ports.push_back(output_port);
   }
@@ -115,6 +126,7 @@ void E131Device::PrePortStop() {
  * Stop this device
  */
 void E131Device::PostPortStop() {
+  m_sync_group.reset();
   m_node->Stop();
   m_node.reset();
 }
@@ -241,6 +253,10 @@ void E131Device::HandleSourceListRequest(const Request *request,
   reply.SerializeToString(response);
 }
 
+void E131Device::SendSynchronization() {
+  m_node->SendSynchronization(m_options.sync_universe);
+}
+
 E131InputPort *E131Device::GetE131InputPort(unsigned int port_id) {
   return (port_id < m_input_ports.size()) ? m_input_ports[port_id] : NULL;
 }
@@ -27,6 +27,7 @@
 #include "libs/acn/E131Node.h"
 #include "ola/acn/CID.h"
 #include "olad/Device.h"
+#include "olad/OutputSyncGroup.h"
 #include "olad/Plugin.h"
 #include "plugins/e131/messages/E131ConfigMessages.pb.h"
 
@@ -44,10 +45,15 @@ class E131Device: public ola::Device {
     E131DeviceOptions()
       : ola::acn::E131Node::Options(),
         input_ports(0),
-        output_ports(0) {
+        output_ports(0),
+        sync_universe(0),
+        sync_timeout_ms(50) {
     }
     unsigned int input_ports;
     unsigned int output_ports;
+    // If non-0, output is synchronized using this universe.
+    unsigned int sync_universe;
+    unsigned int sync_timeout_ms;
   };
 
   E131Device(ola::Plugin *owner,
@@ -71,6 +77,7 @@ class E131Device: public ola::Device {
  private:
   class PluginAdaptor *m_plugin_adaptor;
   std::auto_ptr<ola::acn::E131Node> m_node;
+  std::auto_ptr<ola::OutputSyncGroup> m_sync_group;
   const E131DeviceOptions m_options;
   std::vector<E131InputPort*> m_input_ports;
   std::vector<E131OutputPort*> m_output_ports;
@@ -83,6 +90,8 @@ class E131Device: public ola::Device {
   void HandleSourceListRequest(const ola::plugin::e131::Request *request,
                                std::string *response);
 
+  void SendSynchronization();
+
   E131InputPort *GetE131InputPort(unsigned int port_id);
   E131OutputPort *GetE131OutputPort(unsigned int port_id);
 
@@ -37,6 +37,8 @@ namespace e131 {
 using ola::acn::CID;
 using std::string;
 
+const char E131Plugin::BATCH_RECEIVES_KEY[] = "batch_receives";
+const char E131Plugin::BATCH_SENDS_KEY[] = "batch_sends";
 const char E131Plugin::CID_KEY[] = "cid";
 const unsigned int E131Plugin::DEFAULT_DSCP_VALUE = 0;
 const char E131Plugin::DSCP_KEY[] = "dscp";
@@ -48,10 +50,15 @@ const char E131Plugin::OUTPUT_PORT_COUNT_KEY[] = "output_ports";
 const char E131Plugin::PLUGIN_NAME[] = "E1.31 (sACN)";
 const char E131Plugin::PLUGIN_PREFIX[] = "e131";
 const char E131Plugin::PREPEND_HOSTNAME_KEY[] = "prepend_hostname";
+const char E131Plugin::RECEIVE_BUFFER_SIZE_KEY[] = "receive_buffer_size";
 const char E131Plugin::REVISION_0_2[] = "0.2";
 const char E131Plugin::REVISION_0_46[] = "0.46";
 const char E131Plugin::REVISION_KEY[] = "revision";
+const char E131Plugin::SYNC_TIMEOUT_KEY[] = "sync_timeout_ms";
+const char E131Plugin::SYNC_UNIVERSE_KEY[] = "sync_universe";
 const unsigned int E131Plugin::DEFAULT_PORT_COUNT = 5;
+const unsigned int E131Plugin::DEFAULT_SYNC_TIMEOUT_MS = 50;
+const unsigned int E131Plugin::MAX_RECEIVE_BUFFER_SIZE = 64 * 1024 * 1024;
 
 
 /*
@@ -67,6 +74,13 @@ bool E131Plugin::StartHook() {
       IGNORE_PREVIEW_DATA_KEY);
   options.enable_draft_discovery = m_preferences->GetValueAsBool(
       DRAFT_DISCOVERY_KEY);
+  options.batch_sends = m_preferences->GetValueAsBool(BATCH_SENDS_KEY);
+  options.batch_receives = m_preferences->GetValueAsBool(BATCH_RECEIVES_KEY);
+  if (!StringToInt(m_preferences->GetValue(RECEIVE_BUFFER_SIZE_KEY),
+                   &options.receive_buffer_size)) {
+    options.receive_buffer_size = 0;
+  }
+  options.export_map = m_plugin_adaptor->GetExportMap();
   if (m_preferences->GetValueAsBool(PREPEND_HOSTNAME_KEY)) {
     std::ostringstream str;
     str << ola::network::Hostname() << "-" << m_plugin_adaptor->InstanceName();
@@ -95,6 +109,17 @@ bool E131Plugin::StartHook() {
     OLA_WARN << "Invalid value for input_ports";
   }
 
+  if (!StringToInt(m_preferences->GetValue(SYNC_UNIVERSE_KEY),
+                   &options.sync_universe)) {
+    OLA_WARN << "Invalid value for sync_universe";
+    options.sync_universe = 0;
+  }
+
+  if (!StringToInt(m_preferences->GetValue(SYNC_TIMEOUT_KEY),
+                   &options.sync_timeout_ms)) {
+    options.sync_timeout_ms = DEFAULT_SYNC_TIMEOUT_MS;
+  }
+
   m_device = new E131Device(this, cid, ip_addr, m_plugin_adaptor, options);
 
   if (!m_device->Start()) {
@@ -137,6 +162,15 @@ string E131Plugin::Description() const {
 "\n"
 "--- Config file : ola-e131.conf ---\n"
 "\n"
+"batch_receives = [true|false]\n"
+"Read all waiting packets each time the socket is readable, with a single\n"
+"system call where supported.\n"
+"\n"
+"batch_sends = [true|false]\n"
+"Send the packets generated in each loop with a single system call, where\n"
+"supported. This is off by default, packets that fail to send are counted\n"
+"in the e131-send-errors variable either way.\n"
+"\n"
 "cid = 00010203-0405-0607-0809-0A0B0C0D0E0F\n"
 "The CID to use for this device.\n"
 "\n"
@@ -162,9 +196,25 @@ string E131Plugin::Description() const {
 "prepend_hostname = [true|false]\n"
 "Prepend the hostname to the source name when sending packets.\n"
 "\n"
+"receive_buffer_size = [int]\n"
+"The size of the socket receive buffer in bytes, 0 uses the system default.\n"
+"Increase this if packets are dropped under load.\n"
+"\n"
 "revision = [0.2|0.46]\n"
 "Select which revision of the standard to use when sending data. 0.2 is the\n"
 " standardized revision, 0.46 (default) is the ANSI standard version.\n"
+"\n"
+"sync_timeout_ms = [int]\n"
+"The longest to wait for the other output ports before sending a\n"
+"synchronized frame. Ports that didn't have a frame in the last\n"
+"synchronized frame aren't waited for, so an idle universe only\n"
+"delays one frame.\n"
+"\n"
+"sync_universe = [int]\n"
+"If non-0, the output ports send their frames together, followed by an\n"
+"E1.31 synchronization packet on this universe. Receivers that support\n"
+"synchronization then update all their universes at once. Not supported\n"
+"with revision 0.2.\n"
 "\n";
 }
 
@@ -186,6 +236,16 @@ bool E131Plugin::SetDefaultPreferences() {
     save = true;
   }
 
+  save |= m_preferences->SetDefaultValue(
+      BATCH_RECEIVES_KEY,
+      BoolValidator(),
+      true);
+
+  save |= m_preferences->SetDefaultValue(
+      BATCH_SENDS_KEY,
+      BoolValidator(),
+      false);
+
   save |= m_preferences->SetDefaultValue(
       DSCP_KEY,
       UIntValidator(0, 63),
@@ -218,6 +278,11 @@ bool E131Plugin::SetDefaultPreferences() {
       BoolValidator(),
       true);
 
+  save |= m_preferences->SetDefaultValue(
+      RECEIVE_BUFFER_SIZE_KEY,
+      UIntValidator(0, MAX_RECEIVE_BUFFER_SIZE),
+      0);
+
   std::set<string> revision_values;
   revision_values.insert(REVISION_0_2);
   revision_values.insert(REVISION_0_46);
@@ -227,6 +292,16 @@ bool E131Plugin::SetDefaultPreferences() {
       SetValidator<string>(revision_values),
       REVISION_0_46);
 
+  save |= m_preferences->SetDefaultValue(
+      SYNC_TIMEOUT_KEY,
+      UIntValidator(1, 1000),
+      DEFAULT_SYNC_TIMEOUT_MS);
+
+  save |= m_preferences->SetDefaultValue(
+      SYNC_UNIVERSE_KEY,
+      UIntValidator(0, 63999),
+      0);
+
   if (save) {
     m_preferences->Save();
   }
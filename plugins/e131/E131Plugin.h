@@ -49,9 +49,13 @@ class E131Plugin: public ola::Plugin {
     bool SetDefaultPreferences();
 
     E131Device *m_device;
+    static const char BATCH_RECEIVES_KEY[];
+    static const char BATCH_SENDS_KEY[];
     static const char CID_KEY[];
     static const unsigned int DEFAULT_DSCP_VALUE;
     static const unsigned int DEFAULT_PORT_COUNT;
+    static const unsigned int DEFAULT_SYNC_TIMEOUT_MS;
+    static const unsigned int MAX_RECEIVE_BUFFER_SIZE;
     static const char DRAFT_DISCOVERY_KEY[];
     static const char DSCP_KEY[];
     static const char IGNORE_PREVIEW_DATA_KEY[];
@@ -61,9 +65,12 @@ class E131Plugin: public ola::Plugin {
     static const char PLUGIN_NAME[];
     static const char PLUGIN_PREFIX[];
     static const char PREPEND_HOSTNAME_KEY[];
+    static const char RECEIVE_BUFFER_SIZE_KEY[];
     static const char REVISION_0_2[];
     static const char REVISION_0_46[];
     static const char REVISION_KEY[];
+    static const char SYNC_TIMEOUT_KEY[];
+    static const char SYNC_UNIVERSE_KEY[];
 };
 }  // namespace e131
 }  // namespace plugin
@@ -64,11 +64,15 @@ void E131InputPort::PostSetUniverse(Universe *old_universe,
     m_node->SetHandler(
         new_universe->UniverseId(),
         &m_buffer,
+        &m_slot_priorities,
         &m_priority,
         NewCallback<E131InputPort, void>(this, &E131InputPort::DmxChanged));
 }
 
 E131OutputPort::~E131OutputPort() {
+  if (m_sync_group) {
+    m_sync_group->RemovePort(this);
+  }
   Universe *universe = GetUniverse();
   if (universe) {
     m_node->TerminateStream(universe->UniverseId(), m_last_priority);
@@ -81,10 +85,18 @@ E131OutputPort::~E131OutputPort() {
 void E131OutputPort::PostSetUniverse(Universe *old_universe,
                                      Universe *new_universe) {
   if (old_universe) {
+    if (m_sync_group) {
+      m_sync_group->RemovePort(this);
+    }
     m_node->TerminateStream(old_universe->UniverseId(), m_last_priority);
   }
   if (new_universe) {
     m_node->StartStream(new_universe->UniverseId());
+    if (m_sync_group) {
+      m_node->SetSyncAddress(new_universe->UniverseId(), m_sync_universe);
+      m_sync_group->AddPort(
+          this, NewCallback(this, &E131OutputPort::SendDMX));
+    }
   }
 }
 
@@ -99,7 +111,22 @@ bool E131OutputPort::WriteDMX(const DmxBuffer &buffer, uint8_t priority) {
 
   m_last_priority = (GetPriorityMode() == PRIORITY_MODE_STATIC) ?
       GetPriority() : priority;
-  return m_node->SendDMX(universe->UniverseId(), buffer, m_last_priority,
+  if (m_sync_group) {
+    return m_sync_group->WriteDMX(this, buffer, m_last_priority);
+  }
+  return SendDMX(buffer, m_last_priority);
+}
+
+
+/*
+ * Send a frame, this is called by the OutputSyncGroup for synchronized
+ * output.
+ */
+bool E131OutputPort::SendDMX(const DmxBuffer &buffer, uint8_t priority) {
+  Universe *universe = GetUniverse();
+  if (!universe)
+    return false;
+  return m_node->SendDMX(universe->UniverseId(), buffer, priority,
                          m_preview_on);
 }
 }  // namespace e131
@@ -22,6 +22,7 @@
 #define PLUGINS_E131_E131PORT_H_
 
 #include <string>
+#include "olad/OutputSyncGroup.h"
 #include "olad/Port.h"
 #include "plugins/e131/E131Device.h"
 #include "libs/acn/E131Node.h"
@@ -59,9 +60,13 @@ class E131InputPort: public BasicInputPort {
   const ola::DmxBuffer &ReadDMX() const { return m_buffer; }
   bool SupportsPriorities() const { return true; }
   uint8_t InheritedPriority() const { return m_priority; }
+  const ola::DmxBuffer *InheritedSlotPriorities() const {
+    return &m_slot_priorities;
+  }
 
  private:
   ola::DmxBuffer m_buffer;
+  ola::DmxBuffer m_slot_priorities;
   ola::acn::E131Node *m_node;
   E131PortHelper m_helper;
   uint8_t m_priority;
@@ -70,10 +75,14 @@ class E131InputPort: public BasicInputPort {
 
 class E131OutputPort: public BasicOutputPort {
  public:
-  E131OutputPort(E131Device *parent, int id, ola::acn::E131Node *node)
+  E131OutputPort(E131Device *parent, int id, ola::acn::E131Node *node,
+                 ola::OutputSyncGroup *sync_group = NULL,
+                 uint16_t sync_universe = 0)
       : BasicOutputPort(parent, id),
         m_preview_on(false),
-        m_node(node) {
+        m_node(node),
+        m_sync_group(sync_group),
+        m_sync_universe(sync_universe) {
     m_last_priority = GetPriority();
   }
 
@@ -98,7 +107,11 @@ class E131OutputPort: public BasicOutputPort {
   uint8_t m_last_priority;
   ola::DmxBuffer m_buffer;
   ola::acn::E131Node *m_node;
+  ola::OutputSyncGroup *m_sync_group;
+  uint16_t m_sync_universe;
   E131PortHelper m_helper;
+
+  bool SendDMX(const ola::DmxBuffer &buffer, uint8_t priority);
 };
 }  // namespace e131
 }  // namespace plugin
@@ -41,6 +41,7 @@ using std::string;
 using std::vector;
 
 const char FtdiDmxPlugin::K_FREQUENCY[] = "frequency";
+const char FtdiDmxPlugin::K_REALTIME_PRIORITY[] = "realtime_priority";
 const char FtdiDmxPlugin::PLUGIN_NAME[] = "FTDI USB DMX";
 const char FtdiDmxPlugin::PLUGIN_PREFIX[] = "ftdidmx";
 
@@ -71,10 +72,13 @@ bool FtdiDmxPlugin::StartHook() {
   unsigned int frequency = StringToIntOrDefault(
       m_preferences->GetValue(K_FREQUENCY),
       DEFAULT_FREQUENCY);
+  unsigned int realtime_priority = StringToIntOrDefault(
+      m_preferences->GetValue(K_REALTIME_PRIORITY),
+      DEFAULT_REALTIME_PRIORITY);
 
   FtdiWidgetInfoVector::const_iterator iter;
   for (iter = widgets.begin(); iter != widgets.end(); ++iter) {
-    AddDevice(new FtdiDmxDevice(this, *iter, frequency));
+    AddDevice(new FtdiDmxDevice(this, *iter, frequency, realtime_priority));
   }
   return true;
 }
@@ -112,6 +116,10 @@ string FtdiDmxPlugin::Description() const {
 "\n"
 "frequency = 30\n"
 "The DMX stream frequency (30 to 44 Hz max are the usual).\n"
+"\n"
+"realtime_priority = 0\n"
+"If non-0, run the output threads with this SCHED_FIFO priority (1 - 99).\n"
+"This usually requires extra privileges.\n"
 "\n";
 }
 
@@ -130,6 +138,12 @@ bool FtdiDmxPlugin::SetDefaultPreferences() {
     m_preferences->Save();
   }
 
+  if (m_preferences->SetDefaultValue(FtdiDmxPlugin::K_REALTIME_PRIORITY,
+                                     UIntValidator(0, 99),
+                                     DEFAULT_REALTIME_PRIORITY)) {
+    m_preferences->Save();
+  }
+
   if (m_preferences->GetValue(FtdiDmxPlugin::K_FREQUENCY).empty()) {
     return false;
   }
@@ -64,8 +64,10 @@ class FtdiDmxPlugin : public Plugin {
   bool SetDefaultPreferences();
 
   static const uint8_t DEFAULT_FREQUENCY = 30;
+  static const uint8_t DEFAULT_REALTIME_PRIORITY = 0;
 
   static const char K_FREQUENCY[];
+  static const char K_REALTIME_PRIORITY[];
   static const char PLUGIN_NAME[];
   static const char PLUGIN_PREFIX[];
 };
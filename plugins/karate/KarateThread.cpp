@@ -35,6 +35,7 @@
 #include "ola/Clock.h"
 #include "ola/Constants.h"
 #include "ola/Logging.h"
+#include "ola/thread/FramePacer.h"
 #include "plugins/karate/KarateLight.h"
 #include "plugins/karate/KarateThread.h"
 
@@ -42,6 +43,7 @@ namespace ola {
 namespace plugin {
 namespace karate {
 
+using ola::thread::FramePacer;
 using ola::thread::Mutex;
 using ola::thread::MutexLocker;
 using std::string;
@@ -62,6 +64,7 @@ KarateThread::KarateThread(const string &path)
 void *KarateThread::Run() {
   bool write_success;
   Clock clock;
+  FramePacer pacer(TimeInterval(0, FRAME_INTERVAL));
 
   KarateLight k(m_path);
   k.Init();
@@ -97,7 +100,7 @@ void *KarateThread::Run() {
       if (!write_success) {
         OLA_WARN << "Failed to write color data";
       }  else {
-        usleep(20000);  // 50Hz
+        pacer.WaitForNextFrame();
       }
     }  // port is okay
   }
@@ -44,6 +44,8 @@ class KarateThread: public ola::thread::Thread {
     ola::thread::Mutex m_mutex;
     ola::thread::Mutex m_term_mutex;
     ola::thread::ConditionVariable m_term_cond;
+
+    static const int32_t FRAME_INTERVAL = 20000;  // 50Hz
 };
 }  // namespace karate
 }  // namespace plugin
@@ -702,6 +702,17 @@ void EnttecPort::RunIncrementalDiscovery(
   }
 }
 
+void EnttecPort::SetKnownUIDs(const ola::rdm::UIDSet &uids) {
+  if (m_enable_rdm) {
+    m_impl->SetKnownUIDs(uids);
+  }
+}
+
+const ola::rdm::DiscoveryAgent::DiscoveryStats &
+    EnttecPort::GetDiscoveryStats() const {
+  return m_impl->GetDiscoveryStats();
+}
+
 
 // EnttecUsbProWidgetImpl
 // ----------------------------------------------------------------------------
@@ -67,6 +67,11 @@ class EnttecPort
     void RunFullDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
     void RunIncrementalDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
 
+    void SetKnownUIDs(const ola::rdm::UIDSet &uids);
+
+    // The counters for the most recent discovery operation.
+    const ola::rdm::DiscoveryAgent::DiscoveryStats &GetDiscoveryStats() const;
+
     // the tests access the implementation directly.
     friend class ::EnttecUsbProWidgetTest;
 
@@ -103,6 +103,12 @@ class EnttecPortImpl
                         ola::rdm::RDMCallback *on_complete);
     void RunFullDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
     void RunIncrementalDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
+    void SetKnownUIDs(const ola::rdm::UIDSet &uids) {
+      m_discovery_agent.SetKnownUIDs(uids);
+    }
+    const ola::rdm::DiscoveryAgent::DiscoveryStats &GetDiscoveryStats() const {
+      return m_discovery_agent.Stats();
+    }
 
     // The following are the implementation of DiscoveryTargetInterface
     void MuteDevice(const ola::rdm::UID &target,
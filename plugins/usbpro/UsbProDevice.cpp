@@ -43,6 +43,17 @@ using ola::rpc::RpcController;
 using std::ostringstream;
 using std::string;
 
+const char UsbProOutputPort::K_DISCOVERY_BRANCHES_VAR[] =
+    "usbpro-rdm-discovery-branches";
+const char UsbProOutputPort::K_DISCOVERY_COLLISIONS_VAR[] =
+    "usbpro-rdm-discovery-collisions";
+const char UsbProOutputPort::K_DISCOVERY_MUTES_VAR[] =
+    "usbpro-rdm-discovery-mutes";
+const char UsbProOutputPort::K_DISCOVERY_VERIFIED_UIDS_VAR[] =
+    "usbpro-rdm-discovery-verified-uids";
+const char UsbProOutputPort::K_DISCOVERY_LOST_UIDS_VAR[] =
+    "usbpro-rdm-discovery-lost-uids";
+
 /*
  * Create a new device
  * @param owner  the plugin that owns this device
@@ -81,7 +92,8 @@ UsbProDevice::UsbProDevice(ola::PluginAdaptor *plugin_adaptor,
         this, enttec_port, i, str.str(),
         plugin_adaptor->WakeUpTime(),
         5,  // allow up to 5 burst frames
-        fps_limit);  // 200 frames per second seems to be the limit
+        fps_limit,  // 200 frames per second seems to be the limit
+        plugin_adaptor->GetExportMap());
     AddPort(output_port);
 
     PortParams port_params = {false, 0, 0, 0};
@@ -309,6 +321,40 @@ string UsbProDevice::SerialToString(uint32_t serial) {
   }
   return str.str();
 }
+
+
+/*
+ * Export the DiscoveryAgent counters, then pass the UIDs on.
+ */
+void UsbProOutputPort::DiscoveryComplete(
+    ola::rdm::RDMDiscoveryCallback *callback,
+    const ola::rdm::UIDSet &uids) {
+  if (m_export_map && m_port->SupportsRDM()) {
+    if (!m_branches_var.IsValid()) {
+      // The port id isn't known until the device is registered, so the
+      // handles are fetched the first time discovery completes.
+      const string port_id = UniqueId();
+      m_branches_var = m_export_map->GetCounter(K_DISCOVERY_BRANCHES_VAR,
+                                                port_id);
+      m_collisions_var = m_export_map->GetCounter(K_DISCOVERY_COLLISIONS_VAR,
+                                                  port_id);
+      m_mutes_var = m_export_map->GetCounter(K_DISCOVERY_MUTES_VAR, port_id);
+      m_verified_uids_var = m_export_map->GetGauge(
+          K_DISCOVERY_VERIFIED_UIDS_VAR, port_id);
+      m_lost_uids_var = m_export_map->GetGauge(K_DISCOVERY_LOST_UIDS_VAR,
+                                               port_id);
+    }
+
+    const ola::rdm::DiscoveryAgent::DiscoveryStats &stats =
+        m_port->GetDiscoveryStats();
+    m_branches_var.Increment(stats.branches);
+    m_collisions_var.Increment(stats.collisions);
+    m_mutes_var.Increment(stats.mutes);
+    m_verified_uids_var.Set(stats.verified_uids);
+    m_lost_uids_var.Set(stats.lost_uids);
+  }
+  callback->Run(uids);
+}
 }  // namespace usbpro
 }  // namespace plugin
 }  // namespace ola
@@ -24,6 +24,7 @@
 #include <string>
 #include <vector>
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
 #include "olad/TokenBucket.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/Port.h"
@@ -138,6 +139,10 @@ class UsbProInputPort: public BasicInputPort {
 
 /*
  * The output port
+ *
+ * The DiscoveryAgent counters are exported after each discovery operation,
+ * keyed by the port id. Branches, collisions and mutes are totals, the
+ * verified and lost UIDs are from the most recent discovery.
  */
 class UsbProOutputPort: public BasicOutputPort {
  public:
@@ -148,12 +153,14 @@ class UsbProOutputPort: public BasicOutputPort {
                    const std::string &description,
                    const TimeStamp *wake_time,
                    unsigned int max_burst,
-                   unsigned int rate)
+                   unsigned int rate,
+                   ExportMap *export_map = NULL)
       : BasicOutputPort(parent, id, port->SupportsRDM(), port->SupportsRDM()),
         m_description(description),
         m_port(port),
         m_bucket(max_burst, rate, max_burst, *wake_time),
-        m_wake_time(wake_time) {}
+        m_wake_time(wake_time),
+        m_export_map(export_map) {}
 
   bool WriteDMX(const DmxBuffer &buffer, uint8_t) {
     if (m_bucket.GetToken(*m_wake_time))
@@ -174,20 +181,43 @@ class UsbProOutputPort: public BasicOutputPort {
   }
 
   void RunFullDiscovery(ola::rdm::RDMDiscoveryCallback *callback) {
-    m_port->RunFullDiscovery(callback);
+    m_port->RunFullDiscovery(
+        NewSingleCallback(this, &UsbProOutputPort::DiscoveryComplete,
+                          callback));
   }
 
   void RunIncrementalDiscovery(ola::rdm::RDMDiscoveryCallback *callback) {
-    m_port->RunIncrementalDiscovery(callback);
+    m_port->RunIncrementalDiscovery(
+        NewSingleCallback(this, &UsbProOutputPort::DiscoveryComplete,
+                          callback));
+  }
+
+  void SetKnownUIDs(const ola::rdm::UIDSet &uids) {
+    m_port->SetKnownUIDs(uids);
   }
 
   std::string Description() const { return m_description; }
 
+  static const char K_DISCOVERY_BRANCHES_VAR[];
+  static const char K_DISCOVERY_COLLISIONS_VAR[];
+  static const char K_DISCOVERY_MUTES_VAR[];
+  static const char K_DISCOVERY_VERIFIED_UIDS_VAR[];
+  static const char K_DISCOVERY_LOST_UIDS_VAR[];
+
  private:
   const std::string m_description;
   EnttecPort *m_port;
   TokenBucket m_bucket;
   const TimeStamp *m_wake_time;
+  ExportMap *m_export_map;
+  Counter m_branches_var;
+  Counter m_collisions_var;
+  Counter m_mutes_var;
+  Gauge m_verified_uids_var;
+  Gauge m_lost_uids_var;
+
+  void DiscoveryComplete(ola::rdm::RDMDiscoveryCallback *callback,
+                         const ola::rdm::UIDSet &uids);
 };
 }  // namespace usbpro
 }  // namespace plugin